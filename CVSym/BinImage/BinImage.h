@@ -9,5 +9,6 @@
 
 
 #include "BinImagePublic.h"
+#include "MappedFile.h"
 #include "ImageFile.h"
 #include "DbgFile.h"
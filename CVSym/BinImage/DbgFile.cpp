@@ -6,6 +6,7 @@
 */
 
 #include "Common.h"
+#include "MappedFile.h"
 #include "DbgFile.h"
 
 
@@ -24,43 +25,18 @@ namespace BinImage
 
     HRESULT DbgFile::LoadFile( const wchar_t* filename )
     {
-        FileHandlePtr   hFile;
-        HandlePtr       hMapping;
-        DWORD           loSize = 0;
-        DWORD           hiSize = 0;
-        BOOL            bRet = FALSE;
-        DWORD           bytesRead = 0;
-
-        hFile = CreateFile(
-            filename,
-            GENERIC_READ,
-            FILE_SHARE_READ,
-            NULL,
-            OPEN_EXISTING,
-            0,
-            NULL );
-        if ( hFile.IsEmpty() )
-            return GetLastHr();
-
-        loSize = GetFileSize( hFile, &hiSize );
-        if ( loSize == INVALID_FILE_SIZE )
-            return GetLastHr();
-        if ( (loSize == 0) && (hiSize == 0) )
-            return E_BAD_FORMAT;
+        HRESULT         hr = S_OK;
+        uint32_t        fileSize = 0;
+
+        hr = mFile.Open( filename );
+        if ( FAILED( hr ) )
+            return hr;
 
-        hMapping = CreateFileMapping(
-            hFile, 
-            NULL,
-            PAGE_READONLY,
-            0,
-            loSize,
-            NULL );
-        if ( hMapping.IsEmpty() )
-            return GetLastHr();
+        fileSize = mFile.GetSize();
 
-        bRet = ReadFile( hFile, &mHeader, sizeof mHeader, &bytesRead, NULL );
-        if ( !bRet )
-            return GetLastHr();
+        hr = mFile.ReadAt( 0, &mHeader, sizeof mHeader );
+        if ( FAILED( hr ) )
+            return hr;
 
         if ( mHeader.NumberOfSections > MaxSectionCount )
             return E_BAD_FORMAT;
@@ -69,19 +45,16 @@ namespace BinImage
         DWORD   allHeaderSize = sizeof mHeader + mHeader.DebugDirectorySize + allSecSize;
         DWORD   secAndDirSize = allSecSize + mHeader.DebugDirectorySize;
 
-        if ( (allHeaderSize > loSize) || (allHeaderSize < sizeof mHeader) )
+        if ( (allHeaderSize > fileSize) || (allHeaderSize < sizeof mHeader) )
             return E_BAD_FORMAT;
 
         mSecHeaderBuf = new BYTE[ secAndDirSize ];
         if ( mSecHeaderBuf == NULL )
             return E_OUTOFMEMORY;
 
-        bRet = ReadFile( hFile, mSecHeaderBuf, secAndDirSize, &bytesRead, NULL );
-        if ( !bRet )
-            return GetLastHr();
-
-        mHFile.Attach( hFile.Detach() );
-        mHMapping.Attach( hMapping.Detach() );
+        hr = mFile.ReadAt( sizeof mHeader, mSecHeaderBuf, secAndDirSize );
+        if ( FAILED( hr ) )
+            return hr;
 
         return S_OK;
     }
@@ -110,43 +83,8 @@ namespace BinImage
         return (IMAGE_DEBUG_DIRECTORY*) secLimit;
     }
 
-    HRESULT DbgFile::GetFileHandle( HANDLE& handle )
-    {
-        BOOL            bRet = FALSE;
-        FileHandlePtr   hFile;
-
-        bRet = DuplicateHandle( 
-            GetCurrentProcess(), 
-            mHFile, 
-            GetCurrentProcess(), 
-            &hFile.Ref(), 
-            0, 
-            FALSE, 
-            DUPLICATE_SAME_ACCESS );
-        if ( !bRet )
-            return GetLastHr();
-
-        handle = hFile.Detach();
-        return S_OK;
-    }
-
-    HRESULT DbgFile::GetMappingHandle( HANDLE& handle )
+    HRESULT DbgFile::MapView( uint32_t offset, uint32_t size, FileView& view )
     {
-        BOOL            bRet = FALSE;
-        HandlePtr       hMapping;
-
-        bRet = DuplicateHandle( 
-            GetCurrentProcess(), 
-            mHMapping, 
-            GetCurrentProcess(), 
-            &hMapping.Ref(), 
-            0, 
-            FALSE, 
-            DUPLICATE_SAME_ACCESS );
-        if ( !bRet )
-            return GetLastHr();
-
-        handle = hMapping.Detach();
-        return S_OK;
+        return mFile.MapView( offset, size, view );
     }
 }
@@ -12,8 +12,7 @@ namespace BinImage
 {
     class DbgFile
     {
-        FileHandlePtr   mHFile;
-        HandlePtr       mHMapping;
+        MappedFile      mFile;
 
         IMAGE_SEPARATE_DEBUG_HEADER mHeader;
         BYTE*                       mSecHeaderBuf;
@@ -30,7 +29,6 @@ namespace BinImage
         const IMAGE_SECTION_HEADER* GetSectionHeaders();
         const IMAGE_DEBUG_DIRECTORY* GetDebugDirs();
 
-        HRESULT GetFileHandle( HANDLE& handle );
-        HRESULT GetMappingHandle( HANDLE& handle );
+        HRESULT MapView( uint32_t offset, uint32_t size, FileView& view );
     };
 }
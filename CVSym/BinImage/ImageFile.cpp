@@ -6,6 +6,7 @@
 */
 
 #include "Common.h"
+#include "MappedFile.h"
 #include "ImageFile.h"
 #include "BinUtil.h"
 
@@ -14,14 +15,6 @@ const DWORD NtHeaderBufSize = 1024;
 
 namespace BinImage
 {
-    void ImageFile::LoadedImage::TransferTo( LoadedImage& other )
-    {
-        other.HFile.Attach( HFile.Detach() );
-        other.HMapping.Attach( HMapping.Detach() );
-        other.Size = Size;
-    }
-
-
     ImageFile::ImageFile()
         :   mNtHeaderBuf( NULL ),
             mNtHeaderAddr( 0 ),
@@ -43,41 +36,43 @@ namespace BinImage
     HRESULT ImageFile::LoadFile( const wchar_t* filename )
     {
         HRESULT     hr = S_OK;
-        LoadedImage image;
-        DWORD       bytesRead = 0;
-        BOOL        bRet = FALSE;
-        DWORD       newFilePtr = 0;
+        uint32_t    readSize = 0;
 
         mNtHeaderBuf = new BYTE[ NtHeaderBufSize ];
         if ( mNtHeaderBuf == NULL )
             return E_OUTOFMEMORY;
 
-        hr = OpenAndMapImage( filename, image );
+        // parts of the buffer past the end of a small file stay zero
+        memset( mNtHeaderBuf, 0, NtHeaderBufSize );
+
+        hr = mFile.Open( filename );
         if ( FAILED( hr ) )
             return hr;
 
-        bRet = ReadFile( image.HFile, mNtHeaderBuf, NtHeaderBufSize, &bytesRead, NULL );
-        if ( !bRet )
-            return GetLastHr();
+        readSize = min( NtHeaderBufSize, mFile.GetSize() );
+
+        hr = mFile.ReadAt( 0, mNtHeaderBuf, readSize );
+        if ( FAILED( hr ) )
+            return hr;
 
         IMAGE_DOS_HEADER*   dosHeader = (IMAGE_DOS_HEADER*) mNtHeaderBuf;
 
         if ( (dosHeader->e_magic != IMAGE_DOS_SIGNATURE) || (dosHeader->e_lfanew < 0) )
             return E_BAD_FORMAT;
-        if ( image.Size <= (DWORD) dosHeader->e_lfanew )
+        if ( mFile.GetSize() <= (DWORD) dosHeader->e_lfanew )
             return E_BAD_FORMAT;
 
         // has to be saved before overwriting buffer
         mNtHeaderAddr = dosHeader->e_lfanew;
 
-        newFilePtr = SetFilePointer( image.HFile, dosHeader->e_lfanew, NULL, FILE_BEGIN );
-        if ( newFilePtr == INVALID_SET_FILE_POINTER )
-            return GetLastHr();
+        memset( mNtHeaderBuf, 0, NtHeaderBufSize );
 
         // should be enough to read NT headers, including all data dirs
-        bRet = ReadFile( image.HFile, mNtHeaderBuf, NtHeaderBufSize, &bytesRead, NULL );
-        if ( !bRet )
-            return GetLastHr();
+        readSize = min( NtHeaderBufSize, mFile.GetSize() - mNtHeaderAddr );
+
+        hr = mFile.ReadAt( mNtHeaderAddr, mNtHeaderBuf, readSize );
+        if ( FAILED( hr ) )
+            return hr;
 
         IMAGE_NT_HEADERS32* ntHeaders32 = (IMAGE_NT_HEADERS32*) mNtHeaderBuf;
 
@@ -107,7 +102,6 @@ namespace BinImage
             return E_BAD_FORMAT;
 
         mSecHeaderAddr = mNtHeaderAddr + ((BYTE*) (mDataDirs + mDataDirCount) - mNtHeaderBuf);
-        image.TransferTo( mImage );
 
         return S_OK;
     }
@@ -151,85 +145,9 @@ namespace BinImage
         return (IMAGE_SECTION_HEADER*) mSecHeaderBuf;
     }
 
-    HRESULT ImageFile::GetFileHandle( HANDLE& handle )
-    {
-        BOOL            bRet = FALSE;
-        FileHandlePtr   hFile;
-
-        bRet = DuplicateHandle( 
-            GetCurrentProcess(), 
-            mImage.HFile, 
-            GetCurrentProcess(), 
-            &hFile.Ref(), 
-            0, 
-            FALSE, 
-            DUPLICATE_SAME_ACCESS );
-        if ( !bRet )
-            return GetLastHr();
-
-        handle = hFile.Detach();
-        return S_OK;
-    }
-
-    HRESULT ImageFile::GetMappingHandle( HANDLE& handle )
+    HRESULT ImageFile::MapView( uint32_t offset, uint32_t size, FileView& view )
     {
-        BOOL            bRet = FALSE;
-        HandlePtr       hMapping;
-
-        bRet = DuplicateHandle( 
-            GetCurrentProcess(), 
-            mImage.HMapping, 
-            GetCurrentProcess(), 
-            &hMapping.Ref(), 
-            0, 
-            FALSE, 
-            DUPLICATE_SAME_ACCESS );
-        if ( !bRet )
-            return GetLastHr();
-
-        handle = hMapping.Detach();
-        return S_OK;
-    }
-
-    HRESULT ImageFile::OpenAndMapImage( 
-        const wchar_t* filename,
-        LoadedImage& loadedImage )
-    {
-        LoadedImage image;
-        DWORD       hiSize = 0;
-
-        image.HFile = CreateFile(
-            filename,
-            GENERIC_READ,
-            FILE_SHARE_READ,
-            NULL,
-            OPEN_EXISTING,
-            FILE_FLAG_RANDOM_ACCESS,
-            NULL );
-        if ( image.HFile.IsEmpty() )
-            return GetLastHr();
-
-        image.Size = GetFileSize( image.HFile, &hiSize );
-        if ( image.Size == INVALID_FILE_SIZE )
-            return GetLastHr();
-
-        if ( (image.Size == 0) && (hiSize == 0) )
-            return E_BAD_FORMAT;
-        if ( hiSize > 0 )                       // we don't support huge files
-            return E_BAD_FORMAT;
-
-        image.HMapping = CreateFileMapping( 
-            image.HFile, 
-            NULL,
-            PAGE_READONLY,
-            0,
-            0,
-            NULL );
-        if ( image.HMapping.IsEmpty() )
-            return GetLastHr();
-
-        image.TransferTo( loadedImage );
-        return S_OK;
+        return mFile.MapView( offset, size, view );
     }
 
     HRESULT ImageFile::EnsureSectionsLoaded()
@@ -241,9 +159,7 @@ namespace BinImage
 
         IMAGE_NT_HEADERS32* ntHeaders32 = (IMAGE_NT_HEADERS32*) mNtHeaderBuf;
 
-        BOOL        bRet = FALSE;
-        DWORD       bytesRead = 0;
-        DWORD       newFilePtr = 0;
+        HRESULT     hr = S_OK;
         DWORD       totalSecSize = 0;
 
         totalSecSize = ntHeaders32->FileHeader.NumberOfSections * sizeof( IMAGE_SECTION_HEADER );
@@ -253,13 +169,13 @@ namespace BinImage
             return E_OUTOFMEMORY;
 
         _ASSERT( mSecHeaderAddr != 0 );
-        newFilePtr = SetFilePointer( mImage.HFile, mSecHeaderAddr, NULL, FILE_BEGIN );
-        if ( newFilePtr == INVALID_SET_FILE_POINTER )
-            return GetLastHr();
-
-        bRet = ReadFile( mImage.HFile, mSecHeaderBuf, totalSecSize, &bytesRead, NULL );
-        if ( !bRet )
-            return GetLastHr();
+        hr = mFile.ReadAt( mSecHeaderAddr, mSecHeaderBuf, totalSecSize );
+        if ( FAILED( hr ) )
+        {
+            delete [] mSecHeaderBuf;
+            mSecHeaderBuf = NULL;
+            return hr;
+        }
 
         return S_OK;
     }
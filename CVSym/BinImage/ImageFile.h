@@ -12,25 +12,7 @@ namespace BinImage
 {
     class ImageFile
     {
-        struct LoadedImage
-        {
-            FileHandlePtr   HFile;
-            HandlePtr       HMapping;
-            DWORD           Size;
-
-            LoadedImage()
-                :   Size( 0 )
-            {
-            }
-
-            void TransferTo( LoadedImage& other );
-
-        private:
-            LoadedImage( const LoadedImage& other );
-            LoadedImage& operator=( LoadedImage& other );
-        };
-
-        LoadedImage             mImage;
+        MappedFile              mFile;
         BYTE*                   mNtHeaderBuf;
         DWORD                   mNtHeaderAddr;
         BYTE*                   mSecHeaderBuf;
@@ -50,14 +32,9 @@ namespace BinImage
         IMAGE_DATA_DIRECTORY* GetDataDirs();
         IMAGE_SECTION_HEADER* GetSectionHeaders();
 
-        HRESULT GetFileHandle( HANDLE& handle );
-        HRESULT GetMappingHandle( HANDLE& handle );
+        HRESULT MapView( uint32_t offset, uint32_t size, FileView& view );
 
     private:
         HRESULT EnsureSectionsLoaded();
-
-        static HRESULT OpenAndMapImage( 
-            const wchar_t* filename,
-            LoadedImage& loadedImage );
     };
 }
@@ -0,0 +1,320 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#include "Common.h"
+#include "MappedFile.h"
+
+#if !defined( _WIN32 )
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace BinImage
+{
+#if !defined( _WIN32 )
+    static HRESULT HResultFromErrno( int err )
+    {
+        switch ( err )
+        {
+        case ENOENT:    return HRESULT_FROM_WIN32( ERROR_FILE_NOT_FOUND );
+        case ENOTDIR:   return HRESULT_FROM_WIN32( ERROR_PATH_NOT_FOUND );
+        case EACCES:    return HRESULT_FROM_WIN32( ERROR_ACCESS_DENIED );
+        case ENOMEM:    return E_OUTOFMEMORY;
+        default:        return E_FAIL;
+        }
+    }
+
+    // file names are UTF-8 outside of Windows
+    static HRESULT MakeUtf8Path( const wchar_t* filename, UniquePtr<char[]>& path )
+    {
+        size_t  len = wcslen( filename );
+        char*   p = NULL;
+
+        path.Attach( new char[ (len * 4) + 1 ] );
+        if ( path.Get() == NULL )
+            return E_OUTOFMEMORY;
+
+        p = path.Get();
+
+        for ( size_t i = 0; i < len; i++ )
+        {
+            uint32_t    c = (uint32_t) filename[i];
+
+            if ( c < 0x80 )
+            {
+                *p++ = (char) c;
+            }
+            else if ( c < 0x800 )
+            {
+                *p++ = (char) (0xC0 | (c >> 6));
+                *p++ = (char) (0x80 | (c & 0x3F));
+            }
+            else if ( c < 0x10000 )
+            {
+                *p++ = (char) (0xE0 | (c >> 12));
+                *p++ = (char) (0x80 | ((c >> 6) & 0x3F));
+                *p++ = (char) (0x80 | (c & 0x3F));
+            }
+            else
+            {
+                *p++ = (char) (0xF0 | (c >> 18));
+                *p++ = (char) (0x80 | ((c >> 12) & 0x3F));
+                *p++ = (char) (0x80 | ((c >> 6) & 0x3F));
+                *p++ = (char) (0x80 | (c & 0x3F));
+            }
+        }
+
+        *p = '\0';
+        return S_OK;
+    }
+#endif
+
+
+    FileView::FileView()
+        :   mBase( NULL ),
+            mSize( 0 ),
+            mData( NULL )
+    {
+    }
+
+    FileView::~FileView()
+    {
+        Unmap();
+    }
+
+    bool FileView::IsEmpty()
+    {
+        return mBase == NULL;
+    }
+
+    BYTE* FileView::GetData()
+    {
+        return mData;
+    }
+
+    void FileView::Unmap()
+    {
+        if ( mBase == NULL )
+            return;
+
+#if defined( _WIN32 )
+        UnmapViewOfFile( mBase );
+#else
+        munmap( mBase, mSize );
+#endif
+
+        mBase = NULL;
+        mSize = 0;
+        mData = NULL;
+    }
+
+    void FileView::TransferTo( FileView& other )
+    {
+        other.Unmap();
+
+        other.mBase = mBase;
+        other.mSize = mSize;
+        other.mData = mData;
+
+        mBase = NULL;
+        mSize = 0;
+        mData = NULL;
+    }
+
+
+    MappedFile::MappedFile()
+        :
+#if !defined( _WIN32 )
+            mFd( -1 ),
+#endif
+            mSize( 0 )
+    {
+    }
+
+    MappedFile::~MappedFile()
+    {
+#if !defined( _WIN32 )
+        if ( mFd >= 0 )
+            close( mFd );
+#endif
+    }
+
+    HRESULT MappedFile::Open( const wchar_t* filename )
+    {
+        _ASSERT( filename != NULL );
+
+#if defined( _WIN32 )
+        FileHandlePtr   hFile;
+        HandlePtr       hMapping;
+        DWORD           loSize = 0;
+        DWORD           hiSize = 0;
+
+        hFile = CreateFile(
+            filename,
+            GENERIC_READ,
+            FILE_SHARE_READ,
+            NULL,
+            OPEN_EXISTING,
+            FILE_FLAG_RANDOM_ACCESS,
+            NULL );
+        if ( hFile.IsEmpty() )
+            return GetLastHr();
+
+        loSize = GetFileSize( hFile, &hiSize );
+        if ( loSize == INVALID_FILE_SIZE )
+            return GetLastHr();
+
+        if ( (loSize == 0) && (hiSize == 0) )
+            return E_BAD_FORMAT;
+        if ( hiSize > 0 )                       // we don't support huge files
+            return E_BAD_FORMAT;
+
+        hMapping = CreateFileMapping(
+            hFile,
+            NULL,
+            PAGE_READONLY,
+            0,
+            0,
+            NULL );
+        if ( hMapping.IsEmpty() )
+            return GetLastHr();
+
+        mHFile.Attach( hFile.Detach() );
+        mHMapping.Attach( hMapping.Detach() );
+        mSize = loSize;
+#else
+        UniquePtr<char[]>   path;
+        struct stat         fileStat = { 0 };
+        int                 fd = -1;
+        HRESULT             hr = S_OK;
+
+        hr = MakeUtf8Path( filename, path );
+        if ( FAILED( hr ) )
+            return hr;
+
+        fd = open( path.Get(), O_RDONLY );
+        if ( fd < 0 )
+            return HResultFromErrno( errno );
+
+        if ( fstat( fd, &fileStat ) != 0 )
+        {
+            hr = HResultFromErrno( errno );
+            close( fd );
+            return hr;
+        }
+
+        // we don't support huge files
+        if ( (fileStat.st_size == 0) || ((uint64_t) fileStat.st_size > UINT_MAX) )
+        {
+            close( fd );
+            return E_BAD_FORMAT;
+        }
+
+        mFd = fd;
+        mSize = (uint32_t) fileStat.st_size;
+#endif
+
+        return S_OK;
+    }
+
+    uint32_t MappedFile::GetSize()
+    {
+        return mSize;
+    }
+
+    HRESULT MappedFile::ReadAt( uint32_t offset, void* buffer, uint32_t size )
+    {
+        _ASSERT( buffer != NULL );
+
+        if ( (offset > mSize) || (size > mSize - offset) )
+            return E_BAD_FORMAT;
+
+#if defined( _WIN32 )
+        OVERLAPPED  overlapped = { 0 };
+        DWORD       bytesRead = 0;
+
+        overlapped.Offset = offset;
+
+        if ( !ReadFile( mHFile, buffer, size, &bytesRead, &overlapped ) )
+            return GetLastHr();
+
+        if ( bytesRead != size )
+            return E_BAD_FORMAT;
+#else
+        BYTE*       p = (BYTE*) buffer;
+        uint32_t    sizeLeft = size;
+
+        while ( sizeLeft > 0 )
+        {
+            ssize_t n = pread( mFd, p, sizeLeft, offset );
+
+            if ( n < 0 )
+            {
+                if ( errno == EINTR )
+                    continue;
+                return HResultFromErrno( errno );
+            }
+            if ( n == 0 )
+                return E_BAD_FORMAT;
+
+            p += n;
+            offset += (uint32_t) n;
+            sizeLeft -= (uint32_t) n;
+        }
+#endif
+
+        return S_OK;
+    }
+
+    HRESULT MappedFile::MapView( uint32_t offset, uint32_t size, FileView& view )
+    {
+        if ( (offset > mSize) || (size > mSize - offset) || (size == 0) )
+            return E_BAD_FORMAT;
+
+        uint32_t    alignment = GetViewAlignment();
+        uint32_t    alignedOffset = (offset / alignment) * alignment;
+        uint32_t    diff = offset - alignedOffset;
+        size_t      viewSize = size + diff;
+        BYTE*       base = NULL;
+
+#if defined( _WIN32 )
+        base = (BYTE*) MapViewOfFile( mHMapping, FILE_MAP_READ, 0, alignedOffset, viewSize );
+        if ( base == NULL )
+            return GetLastHr();
+#else
+        void*   addr = mmap( NULL, viewSize, PROT_READ, MAP_PRIVATE, mFd, alignedOffset );
+        if ( addr == MAP_FAILED )
+            return HResultFromErrno( errno );
+
+        base = (BYTE*) addr;
+#endif
+
+        view.Unmap();
+        view.mBase = base;
+        view.mSize = viewSize;
+        view.mData = base + diff;
+
+        return S_OK;
+    }
+
+    uint32_t MappedFile::GetViewAlignment()
+    {
+#if defined( _WIN32 )
+        SYSTEM_INFO sysInfo = { 0 };
+
+        GetSystemInfo( &sysInfo );
+
+        return sysInfo.dwAllocationGranularity;
+#else
+        return (uint32_t) sysconf( _SC_PAGESIZE );
+#endif
+    }
+}
@@ -0,0 +1,72 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+
+namespace BinImage
+{
+    // A read-only view of a range of a file. Views start on an allocation
+    // boundary, so the data asked for can start after the base of the view.
+
+    class FileView
+    {
+        friend class MappedFile;
+
+        BYTE*   mBase;
+        size_t  mSize;
+        BYTE*   mData;
+
+    public:
+        FileView();
+        ~FileView();
+
+        bool IsEmpty();
+        BYTE* GetData();
+
+        void Unmap();
+        void TransferTo( FileView& other );
+
+    private:
+        FileView( const FileView& other );
+        FileView& operator=( const FileView& other );
+    };
+
+
+    // An image or DBG file opened for reading. Only the ranges that are
+    // asked for are read or mapped. Built on file mappings in Windows, and
+    // on pread and mmap elsewhere.
+
+    class MappedFile
+    {
+#if defined( _WIN32 )
+        FileHandlePtr   mHFile;
+        HandlePtr       mHMapping;
+#else
+        int             mFd;
+#endif
+        uint32_t        mSize;
+
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        HRESULT Open( const wchar_t* filename );
+
+        uint32_t GetSize();
+
+        // reads exactly size bytes, or fails
+        HRESULT ReadAt( uint32_t offset, void* buffer, uint32_t size );
+        HRESULT MapView( uint32_t offset, uint32_t size, FileView& view );
+
+    private:
+        MappedFile( const MappedFile& other );
+        MappedFile& operator=( const MappedFile& other );
+
+        static uint32_t GetViewAlignment();
+    };
+}
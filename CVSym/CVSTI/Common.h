@@ -21,7 +21,10 @@
 #include <inttypes.h>
 
 // STL
+#include <algorithm>
 #include <list>
+#include <map>
+#include <string>
 #include <vector>
 #include <limits>
 
@@ -30,10 +33,12 @@
 
 // Magus
 #include <SmartPtr.h>
+#include <Guard.h>
 
 // CVSym project
 #include "..\CVSym\Error.h"
 #include "..\CVSym\CVSym.h"
+#include "..\CVSym\Util.h"
 
 // BinImage project
 #include "..\BinImage\BinImage.h"
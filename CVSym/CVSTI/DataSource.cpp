@@ -22,8 +22,10 @@ namespace MagoST
         :   mRefCount( 0 ),
             mDebugView( NULL ),
             mDebugSize( 0 ),
-            mStore( NULL )
+            mStore( NULL ),
+            mHasImageId( false )
     {
+        memset( &mImageId, 0, sizeof mImageId );
     }
 
     DataSource::~DataSource()
@@ -75,17 +77,33 @@ namespace MagoST
         if ( FAILED( hr ) )
             return hr;
 
+        mHasImageId = SUCCEEDED( container->GetImageId( mImageId ) );
+
         mAddrMap.Attach( addrMap.Detach() );
         mDebugContainer.reset( container.release() );
 
         return S_OK;
     }
 
+    HRESULT DataSource::SetIndexCache( const wchar_t* dir, uint64_t maxSize )
+    {
+        if ( dir == NULL )
+            return E_INVALIDARG;
+
+        mIndexCache.reset( new IndexCache( dir, maxSize ) );
+        if ( mIndexCache.get() == NULL )
+            return E_OUTOFMEMORY;
+
+        return S_OK;
+    }
+
     HRESULT DataSource::InitDebugInfo( const wchar_t* filename, const wchar_t* searchPath )
     {
         HRESULT hr;
 
         delete mStore;
+        mStore = NULL;
+        mIndexView = NULL;
         if( mDebugView && memcmp( mDebugView, "RSDS", 4 ) == 0 )
         {
             PDBDebugStore* pdbStore = new PDBDebugStore;
@@ -95,18 +113,55 @@ namespace MagoST
         else
         {
             DebugStore* store = new DebugStore;
+            const BYTE* savedIndex = NULL;
+            uint32_t    savedIndexSize = 0;
+            bool        useCache = (mIndexCache.get() != NULL) && mHasImageId && (filename != NULL);
+
             if( mAddrMap )
             {
                 store->SetTLSSegment( mAddrMap->FindSection( ".tls" ) );
                 store->SetTextSegment( mAddrMap->FindSection( "_TEXT" ) );
             }
-            hr = store->InitDebugInfo( mDebugView, mDebugSize );
+
+            // without a good saved index, the store builds its own
+            if ( useCache )
+                mIndexCache->OpenIndex( filename, mImageId, mIndexView, savedIndex, savedIndexSize );
+
+            hr = store->InitDebugInfo( mDebugView, mDebugSize, savedIndex, savedIndexSize );
             mStore = store;
+
+            if ( SUCCEEDED( hr ) && useCache && !store->UsedSavedIndex() )
+            {
+                mIndexView = NULL;
+
+                // not being able to save only costs time on the next load
+                SaveIndex( store, filename );
+            }
         }
 
         return hr;
     }
 
+    HRESULT DataSource::SaveIndex( DebugStore* store, const wchar_t* filename )
+    {
+        _ASSERT( store != NULL );
+        _ASSERT( mIndexCache.get() != NULL );
+
+        HRESULT             hr = S_OK;
+        uint32_t            size = store->GetSavedIndexSize();
+        UniquePtr<BYTE[]>   buffer;
+
+        buffer.Attach( new BYTE[ size ] );
+        if ( buffer.Get() == NULL )
+            return E_OUTOFMEMORY;
+
+        hr = store->WriteSavedIndex( buffer.Get(), size );
+        if ( FAILED( hr ) )
+            return hr;
+
+        return mIndexCache->SaveIndex( filename, mImageId, buffer.Get(), size );
+    }
+
     HRESULT DataSource::OpenSession( ISession*& session )
     {
         RefPtr<Session> newSession = new Session( this );
@@ -8,12 +8,15 @@
 #pragma once
 
 #include "IDataSource.h"
+#include "STIUtil.h"
+#include "IndexCache.h"
 
 
 namespace MagoST
 {
     class IDebugContainer;
     class IAddressMap;
+    class DebugStore;
 
 
     class DataSource : public IDataSource
@@ -27,6 +30,11 @@ namespace MagoST
 
         RefPtr<IAddressMap>             mAddrMap;
 
+        std::auto_ptr<IndexCache>       mIndexCache;
+        ImageId                         mImageId;
+        bool                            mHasImageId;
+        MappedPtr                       mIndexView;     // used by mStore
+
     public:
         DataSource();
         ~DataSource();
@@ -38,11 +46,16 @@ namespace MagoST
             const wchar_t* filename,
             ILoadCallback* callback );
 
+        virtual HRESULT SetIndexCache( const wchar_t* dir, uint64_t maxSize );
+
         virtual HRESULT InitDebugInfo( const wchar_t* filename, const wchar_t* searchPath );
 
         virtual HRESULT OpenSession( ISession*& session );
 
         IDebugStore* GetDebugStore();
         RefPtr<IAddressMap> GetAddressMap();
+
+    private:
+        HRESULT SaveIndex( DebugStore* store, const wchar_t* filename );
     };
 }
@@ -24,6 +24,11 @@ namespace MagoST
             const wchar_t* filename,
             ILoadCallback* callback ) = 0;
 
+        // Index files built from the CodeView data of an image are kept in 
+        // this directory, and reused when the same image is loaded again. 
+        // Set it before InitDebugInfo.
+        virtual HRESULT SetIndexCache( const wchar_t* dir, uint64_t maxSize ) = 0;
+
         virtual HRESULT InitDebugInfo( const wchar_t* filename, const wchar_t* searchPath ) = 0;
 
         virtual HRESULT OpenSession( ISession*& session ) = 0;
@@ -24,6 +24,21 @@ namespace MagoST
     struct LineInfo;
     struct FileSegmentInfo;
 
+
+    // What ISession::FindAddresses found for one address
+
+    struct AddressInfo
+    {
+        uint16_t                Section;        // 0 if the address isn't in the module
+        uint32_t                Offset;
+        bool                    HasFunction;
+        SymHandle               FuncHandle;
+        std::vector<SymHandle>  Blocks;         // starts with the function, ends with the innermost block
+        bool                    HasLine;
+        LineNumber              Line;
+    };
+
+
     class ISession
     {
     public:
@@ -54,6 +69,28 @@ namespace MagoST
         virtual HRESULT FindNextSymbol( EnumNamedSymbolsData& handle ) = 0;
         virtual HRESULT GetCurrentSymbol( const EnumNamedSymbolsData& searchHandle, SymHandle& handle ) = 0;
 
+        // Looks for a name in the global, static, and public symbols, in that
+        // order. Returns S_FALSE if it isn't found.
+        virtual HRESULT FindGlobalSymbol( const char* nameChars, size_t nameLen, SymHandle& handle ) = 0;
+
+        // Looks for a name as is, and then qualified by the scope, or by one
+        // of its outer scopes, innermost first. For example, in scope "a.b.c",
+        // "x" can be "x", "a.b.c.x", "a.b.x", or "a.x".
+        virtual HRESULT FindScopedGlobalSymbol( 
+            const char* scopeChars, 
+            size_t scopeLen, 
+            const char* nameChars, 
+            size_t nameLen, 
+            SymHandle& handle ) = 0;
+
+        // Finds up to maxCount global, static, and public symbols whose names
+        // start with the prefix, in name order.
+        virtual HRESULT FindGlobalSymbolsByPrefix( 
+            const char* prefixChars, 
+            size_t prefixLen, 
+            uint32_t maxCount, 
+            std::vector<SymHandle>& handles ) = 0;
+
         virtual HRESULT FindChildSymbol( 
             SymHandle parentHandle, 
             const char* nameChars, 
@@ -65,6 +102,19 @@ namespace MagoST
         virtual HRESULT FindOuterSymbolByVA( SymbolHeapId heapId, DWORD64 va, SymHandle& handle ) = 0;
         virtual HRESULT FindInnermostSymbol( SymHandle parentHandle, WORD segment, DWORD offset, std::vector<SymHandle>& handle ) = 0;
 
+        // For each VA, finds the function in the global, static, or public 
+        // symbols, its innermost block, and the line. The VAs can be in any order.
+        //
+        // The VAs are sorted and resolved in order. A VA in the same function 
+        // or line as the one before it reuses what was found, so a run of 
+        // frames or instructions in one function costs one search of the 
+        // symbols and lines. Each new function or line is a binary search of 
+        // the store's sorted tables rather than a step of one merged sweep 
+        // through them: a batch is hundreds of addresses and the tables hold 
+        // up to millions of entries, so a sweep would read far more than the 
+        // searches do.
+        virtual HRESULT FindAddresses( const uint64_t* vas, uint32_t count, AddressInfo* infos ) = 0;
+
         virtual HRESULT SetChildSymbolScope( SymHandle handle, SymbolScope& scope ) = 0;
 
         virtual bool NextSymbol( SymbolScope& scope, SymHandle& handle ) = 0;
@@ -85,6 +135,16 @@ namespace MagoST
             size_t nameLen, 
             TypeHandle& handle ) = 0;
 
+        // Finds a member by name in a field list, and then in the field lists of 
+        // the first base classes up the chain. baseOffset is the offset of the 
+        // base class that holds the member, or 0 for the class's own members.
+        virtual HRESULT FindMemberType( 
+            TypeIndex fieldListIndex, 
+            const char* nameChars, 
+            size_t nameLen, 
+            TypeHandle& handle, 
+            int32_t& baseOffset ) = 0;
+
         // source files
 
         virtual HRESULT GetCompilandCount( uint32_t& count ) = 0;
@@ -101,7 +161,7 @@ namespace MagoST
         virtual bool FindNextLineByNum( uint16_t compIndex, uint16_t fileIndex, uint16_t line, LineNumber& lineNumber ) = 0;
 
         virtual bool FindLines( bool exactMatch, const char* fileName, size_t fileNameLen, uint16_t reqLineStart, uint16_t reqLineEnd, 
-                                std::list<LineNumber>& lines ) = 0;
+                                std::vector<LineNumber>& lines ) = 0;
 
     };
 }
@@ -13,7 +13,9 @@ namespace MagoST
 {
     ImageAddrMap::ImageAddrMap()
         :   mRefCount( 0 ),
-            mSecCount( 0 )
+            mSecCount( 0 ),
+            mStartCount( 0 ),
+            mLastStart( 0 )
     {
     }
 
@@ -42,32 +44,59 @@ namespace MagoST
         return mSections[zSec].RVA + offset;
     }
 
+    // The section of an RVA is the one that starts closest before it. Lookups
+    // tend to repeat in the same section, so try the last one found first.
+    // Threads can race on the last one found, but any value is only a guess 
+    // that gets checked.
+
     uint16_t ImageAddrMap::MapRVAToSecOffset( uint32_t rva, uint32_t& offset )
     {
-        uint16_t    closestSec = USHRT_MAX;
-        uint32_t    closestOff = ULONG_MAX;
+        uint16_t    startIndex = mLastStart;
 
-        for ( uint16_t i = 0; i < mSecCount; i++ )
+        if ( !IsInStart( startIndex, rva ) )
         {
-            if ( rva >= mSections[i].RVA )
-            {
-                uint32_t    curOff = rva - mSections[i].RVA;
-
-                if ( curOff < closestOff )
-                {
-                    closestOff = curOff;
-                    closestSec = i;
-                }
-            }
-        }
+            SectionStart*   begin = mStarts.Get();
+            SectionStart*   end = begin + mStartCount;
+            SectionStart*   it = std::upper_bound( begin, end, rva, RVALessThanStart );
 
-        if ( closestSec < USHRT_MAX )
-        {
-            offset = closestOff;
-            return closestSec + 1;      // remember it's 1-based
+            if ( it == begin )
+                return 0;
+
+            startIndex = (uint16_t) (it - begin) - 1;
+            mLastStart = startIndex;
         }
 
-        return 0;
+        const SectionStart& start = mStarts[startIndex];
+
+        offset = rva - start.RVA;
+        return start.SecIndex + 1;      // remember it's 1-based
+    }
+
+    bool ImageAddrMap::IsInStart( uint16_t startIndex, uint32_t rva )
+    {
+        if ( startIndex >= mStartCount )
+            return false;
+
+        if ( rva < mStarts[startIndex].RVA )
+            return false;
+
+        if ( (startIndex + 1 < mStartCount) && (rva >= mStarts[startIndex + 1].RVA) )
+            return false;
+
+        return true;
+    }
+
+    bool ImageAddrMap::SectionStartLess( const SectionStart& left, const SectionStart& right )
+    {
+        if ( left.RVA != right.RVA )
+            return left.RVA < right.RVA;
+
+        return left.SecIndex < right.SecIndex;
+    }
+
+    bool ImageAddrMap::RVALessThanStart( uint32_t rva, const SectionStart& start )
+    {
+        return rva < start.RVA;
     }
 
     uint16_t ImageAddrMap::FindSection( const char* name )
@@ -106,6 +135,27 @@ namespace MagoST
             memcpy( mSections[i].Name, (const char*) secHeaders[i].Name, sizeof( mSections[i].Name ) );
         }
 
+        mStarts.Attach( new SectionStart[ count ] );
+        if ( mStarts.Get() == NULL )
+            return E_OUTOFMEMORY;
+
+        for ( uint16_t i = 0; i < count; i++ )
+        {
+            mStarts[i].RVA = mSections[i].RVA;
+            mStarts[i].SecIndex = i;
+        }
+
+        std::sort( mStarts.Get(), mStarts.Get() + count, SectionStartLess );
+
+        // when sections start at the same RVA, the first one wins
+        mStartCount = 0;
+
+        for ( uint16_t i = 0; i < count; i++ )
+        {
+            if ( (mStartCount == 0) || (mStarts[mStartCount - 1].RVA != mStarts[i].RVA) )
+                mStarts[mStartCount++] = mStarts[i];
+        }
+
         return S_OK;
     }
 }
@@ -21,9 +21,19 @@ namespace MagoST
             char        Name[8];
         };
 
+        // section starts sorted by RVA, for finding the section of an RVA
+        struct SectionStart
+        {
+            uint32_t    RVA;
+            uint16_t    SecIndex;
+        };
+
         long    mRefCount;
         UniquePtr<Section[]>    mSections;
         uint16_t    mSecCount;
+        UniquePtr<SectionStart[]>   mStarts;
+        uint16_t    mStartCount;
+        uint16_t    mLastStart;
 
     public:
         ImageAddrMap();
@@ -36,5 +46,10 @@ namespace MagoST
         virtual uint16_t FindSection( const char* name );
 
         HRESULT LoadFromSections( uint16_t count, const IMAGE_SECTION_HEADER* secHeaders );
+
+    private:
+        bool IsInStart( uint16_t startIndex, uint32_t rva );
+        static bool SectionStartLess( const SectionStart& left, const SectionStart& right );
+        static bool RVALessThanStart( uint32_t rva, const SectionStart& start );
     };
 }
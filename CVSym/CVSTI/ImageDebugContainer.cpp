@@ -9,6 +9,7 @@
 #include "ImageDebugContainer.h"
 #include "ImageAddrMap.h"
 #include "STIUtil.h"
+#include "IndexCache.h"
 #include "ILoadCallback.h"
 
 using namespace std;
@@ -22,10 +23,7 @@ namespace MagoST
         HRESULT     hr = S_OK;
         auto_ptr<ImageFile>   image( new ImageFile() );
         DataDirInfo dirInfo = { 0 };
-        HandlePtr   hMapping;
-        DWORD       viewAlignedAddr = 0;
-        DWORD       viewDiff = 0;
-        MappedPtr   view;
+        FileView    view;
         DWORD       debugDirCount = 0;
         IMAGE_DEBUG_DIRECTORY*  debugDir = NULL;
 
@@ -39,17 +37,11 @@ namespace MagoST
         if ( !image->FindDataDirectoryData( IMAGE_DIRECTORY_ENTRY_DEBUG, dirInfo ) )
             return E_FAIL;
 
-        hr = image->GetMappingHandle( hMapping.Ref() );
+        hr = image->MapView( dirInfo.FileOffset, dirInfo.Size, view );
         if ( FAILED( hr ) )
             return hr;
 
-        AlignAddress( dirInfo.FileOffset, viewAlignedAddr, viewDiff );
-
-        view = MapViewOfFile( hMapping, FILE_MAP_READ, 0, viewAlignedAddr, dirInfo.Size + viewDiff );
-        if ( view.IsEmpty() )
-            return GetLastHr();
-
-        debugDir = (IMAGE_DEBUG_DIRECTORY*) ((BYTE*) view.Get() + viewDiff);
+        debugDir = (IMAGE_DEBUG_DIRECTORY*) view.GetData();
 
         if ( callback != NULL )
             callback->NotifyDebugDir( true, dirInfo.Size, (BYTE*) debugDir );
@@ -73,16 +65,6 @@ namespace MagoST
         return S_OK;
     }
 
-    void ImageDebugContainer::AlignAddress( DWORD unalignedAddr, DWORD& alignedAddr, DWORD& diff )
-    {
-        SYSTEM_INFO sysInfo = { 0 };
-
-        GetSystemInfo( &sysInfo );
-
-        alignedAddr = (unalignedAddr / sysInfo.dwAllocationGranularity) * sysInfo.dwAllocationGranularity;
-        diff = unalignedAddr - alignedAddr;
-    }
-
     HRESULT ImageDebugContainer::LoadDbg( 
         BinImage::ImageFile* image, 
         const IMAGE_DEBUG_DIRECTORY* miscDebugDir, 
@@ -92,10 +74,7 @@ namespace MagoST
         _ASSERT( miscDebugDir != NULL );
 
         HRESULT     hr = S_OK;
-        HandlePtr   hMapping;
-        DWORD       viewAlignedAddr = 0;
-        DWORD       viewDiff = 0;
-        MappedPtr   view;
+        FileView    view;
         IMAGE_DEBUG_MISC*       misc = NULL;
         UniquePtr<wchar_t[]>    strBuf;
         DWORD       dataLen = 0;
@@ -103,17 +82,11 @@ namespace MagoST
         if ( miscDebugDir->SizeOfData < sizeof( IMAGE_DEBUG_MISC ) )
             return E_FAIL;
 
-        hr = image->GetMappingHandle( hMapping.Ref() );
+        hr = image->MapView( miscDebugDir->PointerToRawData, miscDebugDir->SizeOfData, view );
         if ( FAILED( hr ) )
             return hr;
 
-        AlignAddress( miscDebugDir->PointerToRawData, viewAlignedAddr, viewDiff );
-
-        view = MapViewOfFile( hMapping, FILE_MAP_READ, 0, viewAlignedAddr, miscDebugDir->SizeOfData + viewDiff );
-        if ( view.IsEmpty() )
-            return GetLastHr();
-
-        misc = (IMAGE_DEBUG_MISC*) view.Get();
+        misc = (IMAGE_DEBUG_MISC*) view.GetData();
         dataLen = misc->Length - offsetof( IMAGE_DEBUG_MISC, Data );
 
         if ( misc->DataType != IMAGE_DEBUG_MISC_EXENAME )
@@ -212,18 +185,19 @@ namespace MagoST
     HRESULT ImageDebugContainer::LockDebugSection( BYTE*& bytes, DWORD& size )
     {
         HRESULT     hr = S_OK;
-        HandlePtr   hMapping;
-        DWORD       viewAlignedAddr = 0;
-        DWORD       viewDiff = 0;
-        MappedPtr   view;
+        FileView    view;
+
+        // the section stays mapped until it's unlocked
+        if ( !mDebugView.IsEmpty() )
+            return E_FAIL;
 
         if ( mImage.get() != NULL )
         {
-            hr = mImage->GetMappingHandle( hMapping.Ref() );
+            hr = mImage->MapView( mDebugDir.PointerToRawData, mDebugDir.SizeOfData, view );
         }
         else if ( mDbg.get() != NULL )
         {
-            hr = mDbg->GetMappingHandle( hMapping.Ref() );
+            hr = mDbg->MapView( mDebugDir.PointerToRawData, mDebugDir.SizeOfData, view );
         }
         else
             hr = E_FAIL;
@@ -231,23 +205,19 @@ namespace MagoST
         if ( FAILED( hr ) )
             return hr;
 
-        AlignAddress( mDebugDir.PointerToRawData, viewAlignedAddr, viewDiff );
-
-        view = MapViewOfFile( hMapping, FILE_MAP_READ, 0, viewAlignedAddr, mDebugDir.SizeOfData + viewDiff );
-        if ( view.IsEmpty() )
-            return GetLastHr();
-
-        bytes = (BYTE*) view.Detach() + viewDiff;
+        bytes = view.GetData();
         size = mDebugDir.SizeOfData;
+        view.TransferTo( mDebugView );
 
         return S_OK;
     }
 
     HRESULT ImageDebugContainer::UnlockDebugSection( BYTE* bytes )
     {
-        BOOL    bRet = UnmapViewOfFile( bytes );
-        if ( !bRet )
-            return GetLastHr();
+        if ( mDebugView.IsEmpty() || (bytes != mDebugView.GetData()) )
+            return E_INVALIDARG;
+
+        mDebugView.Unmap();
 
         return S_OK;
     }
@@ -291,4 +261,34 @@ namespace MagoST
 
         return S_OK;
     }
+
+    HRESULT ImageDebugContainer::GetImageId( ImageId& id )
+    {
+        if ( mImage.get() != NULL )
+        {
+            // these fields are at the same offsets in 32 and 64-bit headers
+            IMAGE_NT_HEADERS32* ntHeaders = (IMAGE_NT_HEADERS32*) mImage->GetNtHeadersBase();
+
+            C_ASSERT( offsetof( IMAGE_NT_HEADERS32, OptionalHeader.SizeOfImage ) 
+                == offsetof( IMAGE_NT_HEADERS64, OptionalHeader.SizeOfImage ) );
+            C_ASSERT( offsetof( IMAGE_NT_HEADERS32, OptionalHeader.CheckSum ) 
+                == offsetof( IMAGE_NT_HEADERS64, OptionalHeader.CheckSum ) );
+
+            id.TimeDateStamp = ntHeaders->FileHeader.TimeDateStamp;
+            id.SizeOfImage = ntHeaders->OptionalHeader.SizeOfImage;
+            id.CheckSum = ntHeaders->OptionalHeader.CheckSum;
+        }
+        else if ( mDbg.get() != NULL )
+        {
+            const IMAGE_SEPARATE_DEBUG_HEADER*  header = mDbg->GetHeader();
+
+            id.TimeDateStamp = header->TimeDateStamp;
+            id.SizeOfImage = header->SizeOfImage;
+            id.CheckSum = header->CheckSum;
+        }
+        else
+            return E_FAIL;
+
+        return S_OK;
+    }
 }
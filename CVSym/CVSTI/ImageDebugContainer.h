@@ -13,6 +13,7 @@
 namespace MagoST
 {
     class ILoadCallback;
+    struct ImageId;
 
 
     class ImageDebugContainer : public IDebugContainer
@@ -20,6 +21,7 @@ namespace MagoST
         std::auto_ptr<BinImage::ImageFile>  mImage;
         std::auto_ptr<BinImage::DbgFile>    mDbg;
         IMAGE_DEBUG_DIRECTORY               mDebugDir;
+        BinImage::FileView                  mDebugView;
 
     public:
         HRESULT LoadExe( const wchar_t* filename, ILoadCallback* callback );
@@ -31,12 +33,12 @@ namespace MagoST
         virtual bool HasAddressMap();
         virtual HRESULT GetAddressMap( IAddressMap*& map );
 
+        HRESULT GetImageId( ImageId& id );
+
     private:
         HRESULT LoadDbg( 
             BinImage::ImageFile* image, 
             const IMAGE_DEBUG_DIRECTORY* miscDebugDir, 
             ILoadCallback* callback );
-
-        static void AlignAddress( DWORD unalignedAddr, DWORD& alignedAddr, DWORD& diff );
     };
 }
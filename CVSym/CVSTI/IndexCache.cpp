@@ -0,0 +1,253 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#include "Common.h"
+#include "STIUtil.h"
+#include "IndexCache.h"
+
+using namespace std;
+
+
+namespace MagoST
+{
+    // 2: the checksum is FNV-1a over each byte
+    const uint32_t  IndexFileVersion = 2;
+
+    IndexCache::IndexCache( const wchar_t* dir, uint64_t maxSize )
+        :   mDir( dir ),
+            mMaxSize( maxSize )
+    {
+        _ASSERT( dir != NULL );
+    }
+
+    HRESULT IndexCache::OpenIndex(
+        const wchar_t* imagePath,
+        const ImageId& id,
+        MappedPtr& view,
+        const BYTE*& data,
+        uint32_t& dataSize )
+    {
+        wstring         path;
+        FileHandlePtr   hFile;
+        HandlePtr       hMapping;
+        MappedPtr       newView;
+        DWORD           size = 0;
+        DWORD           hiSize = 0;
+
+        GetIndexPath( imagePath, id, path );
+
+        // write attributes to mark the file as recently used below
+        hFile = CreateFile(
+            path.c_str(),
+            GENERIC_READ | FILE_WRITE_ATTRIBUTES,
+            FILE_SHARE_READ,
+            NULL,
+            OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL,
+            NULL );
+        if ( hFile.IsEmpty() )
+            return GetLastHr();
+
+        size = GetFileSize( hFile, &hiSize );
+        if ( size == INVALID_FILE_SIZE )
+            return GetLastHr();
+
+        if ( (hiSize > 0) || (size < sizeof( FileHeader )) )
+            return E_BAD_FORMAT;
+
+        hMapping = CreateFileMapping( hFile, NULL, PAGE_READONLY, 0, 0, NULL );
+        if ( hMapping.IsEmpty() )
+            return GetLastHr();
+
+        newView = MapViewOfFile( hMapping, FILE_MAP_READ, 0, 0, 0 );
+        if ( newView.IsEmpty() )
+            return GetLastHr();
+
+        const FileHeader*   header = (const FileHeader*) newView.Get();
+        const BYTE*         fileData = (const BYTE*) newView.Get() + sizeof( FileHeader );
+
+        if ( (header->Signature != SavedIndexSignature)
+            || (header->Version != IndexFileVersion)
+            || (header->Id.TimeDateStamp != id.TimeDateStamp)
+            || (header->Id.SizeOfImage != id.SizeOfImage)
+            || (header->Id.CheckSum != id.CheckSum)
+            || (header->DataSize != size - sizeof( FileHeader )) )
+            return E_BAD_FORMAT;
+
+        if ( header->DataChecksum != ComputeChecksum( fileData, header->DataSize ) )
+            return E_BAD_FORMAT;
+
+        FILETIME    now = { 0 };
+
+        GetSystemTimeAsFileTime( &now );
+        SetFileTime( hFile, NULL, NULL, &now );
+
+        data = fileData;
+        dataSize = header->DataSize;
+        view.Attach( newView.Detach() );
+
+        return S_OK;
+    }
+
+    HRESULT IndexCache::SaveIndex(
+        const wchar_t* imagePath,
+        const ImageId& id,
+        const BYTE* data,
+        uint32_t dataSize )
+    {
+        if ( data == NULL )
+            return E_INVALIDARG;
+
+        HRESULT         hr = S_OK;
+        wstring         path;
+        wstring         tempPath;
+        FileHandlePtr   hFile;
+        FileHeader      header = { 0 };
+        DWORD           written = 0;
+
+        if ( !CreateDirectory( mDir.c_str(), NULL )
+            && (GetLastError() != ERROR_ALREADY_EXISTS) )
+            return GetLastHr();
+
+        GetIndexPath( imagePath, id, path );
+
+        // write the whole file under another name first, so that a reader
+        // never sees a partial one
+        tempPath = path;
+        tempPath.append( L".tmp" );
+
+        hFile = CreateFile(
+            tempPath.c_str(),
+            GENERIC_WRITE,
+            0,
+            NULL,
+            CREATE_ALWAYS,
+            FILE_ATTRIBUTE_NORMAL,
+            NULL );
+        if ( hFile.IsEmpty() )
+            return GetLastHr();
+
+        header.Signature = SavedIndexSignature;
+        header.Version = IndexFileVersion;
+        header.Id = id;
+        header.DataSize = dataSize;
+        header.DataChecksum = ComputeChecksum( data, dataSize );
+
+        if ( !WriteFile( hFile, &header, sizeof header, &written, NULL )
+            || (written != sizeof header)
+            || !WriteFile( hFile, data, dataSize, &written, NULL )
+            || (written != dataSize) )
+        {
+            hr = GetLastHr();
+            if ( SUCCEEDED( hr ) )
+                hr = E_FAIL;
+        }
+
+        hFile = INVALID_HANDLE_VALUE;
+
+        if ( SUCCEEDED( hr )
+            && !MoveFileEx( tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING ) )
+            hr = GetLastHr();
+
+        if ( FAILED( hr ) )
+        {
+            DeleteFile( tempPath.c_str() );
+            return hr;
+        }
+
+        Trim();
+
+        return S_OK;
+    }
+
+    void IndexCache::Trim()
+    {
+        wstring             pattern( mDir );
+        WIN32_FIND_DATA     findData = { 0 };
+        HANDLE              hFind = INVALID_HANDLE_VALUE;
+        vector<CacheFile>   files;
+        uint64_t            totalSize = 0;
+
+        // also finds temporary files left behind by a debugger that exited
+        // while saving
+        pattern.append( L"\\*.mgx*" );
+
+        hFind = FindFirstFile( pattern.c_str(), &findData );
+        if ( hFind == INVALID_HANDLE_VALUE )
+            return;
+
+        do
+        {
+            if ( (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0 )
+                continue;
+
+            CacheFile   file;
+
+            file.LastWriteTime = findData.ftLastWriteTime;
+            file.Size = ((uint64_t) findData.nFileSizeHigh << 32) | findData.nFileSizeLow;
+            file.Name = findData.cFileName;
+
+            totalSize += file.Size;
+            files.push_back( file );
+
+        } while ( FindNextFile( hFind, &findData ) );
+
+        FindClose( hFind );
+
+        if ( totalSize <= mMaxSize )
+            return;
+
+        std::sort( files.begin(), files.end(), CacheFileOlder );
+
+        for ( vector<CacheFile>::iterator it = files.begin();
+            (it != files.end()) && (totalSize > mMaxSize);
+            it++ )
+        {
+            wstring     path( mDir );
+
+            path.append( L"\\" );
+            path.append( it->Name );
+
+            // files that are in use can't be deleted, they stay
+            if ( DeleteFile( path.c_str() ) )
+                totalSize -= it->Size;
+        }
+    }
+
+    void IndexCache::GetIndexPath( const wchar_t* imagePath, const ImageId& id, wstring& path )
+    {
+        _ASSERT( imagePath != NULL );
+
+        const wchar_t*  fileName = imagePath;
+        wchar_t         idStr[3 * 8 + 1] = L"";
+
+        for ( const wchar_t* p = imagePath; *p != L'\0'; p++ )
+        {
+            if ( (*p == L'\\') || (*p == L'/') || (*p == L':') )
+                fileName = p + 1;
+        }
+
+        swprintf_s( idStr, L"%08X%08X%08X", id.TimeDateStamp, id.SizeOfImage, id.CheckSum );
+
+        path = mDir;
+        path.append( L"\\" );
+        path.append( fileName );
+        path.append( L"." );
+        path.append( idStr );
+        path.append( L".mgx" );
+    }
+
+    uint32_t IndexCache::ComputeChecksum( const BYTE* data, uint32_t size )
+    {
+        return HashFnv1a( data, size );
+    }
+
+    bool IndexCache::CacheFileOlder( const CacheFile& left, const CacheFile& right )
+    {
+        return CompareFileTime( &left.LastWriteTime, &right.LastWriteTime ) < 0;
+    }
+}
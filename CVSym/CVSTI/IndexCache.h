@@ -0,0 +1,78 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+
+namespace MagoST
+{
+    // identifies a build of an image, from its PE headers
+    struct ImageId
+    {
+        uint32_t    TimeDateStamp;
+        uint32_t    SizeOfImage;
+        uint32_t    CheckSum;
+    };
+
+
+    // A directory of index files that a debug store built for an image, so
+    // that the next load of the same image can map them instead of building
+    // them again. A file is named after the image and its ID, and checked
+    // against both when it's opened. The least recently used files are
+    // deleted when the directory grows past its size limit.
+
+    class IndexCache
+    {
+        struct FileHeader
+        {
+            uint32_t    Signature;
+            uint32_t    Version;
+            ImageId     Id;
+            uint32_t    DataSize;
+            uint32_t    DataChecksum;
+            uint32_t    Reserved;
+        };
+
+        struct CacheFile
+        {
+            FILETIME        LastWriteTime;
+            uint64_t        Size;
+            std::wstring    Name;
+        };
+
+        std::wstring    mDir;
+        uint64_t        mMaxSize;
+
+    public:
+        IndexCache( const wchar_t* dir, uint64_t maxSize );
+
+        // On success, data points into the view, and stays valid until the
+        // view is unmapped.
+        HRESULT OpenIndex(
+            const wchar_t* imagePath,
+            const ImageId& id,
+            MappedPtr& view,
+            const BYTE*& data,
+            uint32_t& dataSize );
+
+        HRESULT SaveIndex(
+            const wchar_t* imagePath,
+            const ImageId& id,
+            const BYTE* data,
+            uint32_t dataSize );
+
+        // deletes the least recently used files until the directory fits
+        // in the maximum size
+        void Trim();
+
+    private:
+        void GetIndexPath( const wchar_t* imagePath, const ImageId& id, std::wstring& path );
+
+        static uint32_t ComputeChecksum( const BYTE* data, uint32_t size );
+        static bool CacheFileOlder( const CacheFile& left, const CacheFile& right );
+    };
+}
@@ -109,6 +109,322 @@ namespace MagoST
         return mStore->GetCurrentSymbol( searchHandle, handle );
     }
 
+    HRESULT Session::FindGlobalSymbol( const char* nameChars, size_t nameLen, SymHandle& handle )
+    {
+        const GlobalNameIndex*  index = GetGlobalNameIndex();
+
+        if ( (index == NULL) || !index->Usable )
+            return FindGlobalSymbolInHeaps( nameChars, nameLen, handle );
+
+        GlobalNameEntry key = { 0 };
+
+        key.Name = nameChars;
+        key.NameLen = (uint32_t) nameLen;
+
+        std::vector<GlobalNameEntry>::const_iterator it =
+            std::lower_bound( index->Entries.begin(), index->Entries.end(), key, GlobalNameEntryLess );
+
+        if ( (it == index->Entries.end())
+            || (CompareNames( it->Name, it->NameLen, nameChars, nameLen ) != 0) )
+            return S_FALSE;
+
+        handle = it->Handle;
+        return S_OK;
+    }
+
+    // All the names that can match end with the same part after the last dot.
+    // They're next to each other in the index, so we only need to go through
+    // those, and keep the one with the innermost scope.
+
+    HRESULT Session::FindScopedGlobalSymbol(
+        const char* scopeChars,
+        size_t scopeLen,
+        const char* nameChars,
+        size_t nameLen,
+        SymHandle& handle )
+    {
+        const GlobalNameIndex*  index = GetGlobalNameIndex();
+
+        if ( (index == NULL) || !index->Usable )
+        {
+            // look for it unqualified first, then take off one scope at a time
+            HRESULT     hr = FindGlobalSymbolInHeaps( nameChars, nameLen, handle );
+            std::string qualName;
+
+            for ( size_t len = scopeLen; (hr != S_OK) && (len > 0); )
+            {
+                qualName.assign( scopeChars, len );
+                qualName.append( 1, '.' );
+                qualName.append( nameChars, nameLen );
+
+                hr = FindGlobalSymbolInHeaps( qualName.c_str(), qualName.length(), handle );
+
+                for ( len--; (len > 0) && (scopeChars[len] != '.'); len-- )
+                {
+                }
+            }
+
+            return hr;
+        }
+
+        const char* lastPart = nameChars;
+
+        for ( size_t i = nameLen; i > 0; i-- )
+        {
+            if ( nameChars[i - 1] == '.' )
+            {
+                lastPart = nameChars + i;
+                break;
+            }
+        }
+
+        LastPartEntry   key = { 0 };
+        const GlobalNameEntry*  bestEntry = NULL;
+        size_t                  bestQualLen = 0;
+
+        key.LastPart = lastPart;
+        key.LastPartLen = (uint32_t) (nameLen - (lastPart - nameChars));
+
+        std::vector<LastPartEntry>::const_iterator it =
+            std::lower_bound( index->LastParts.begin(), index->LastParts.end(), key, LastPartEntryLess );
+
+        for ( ; it != index->LastParts.end(); it++ )
+        {
+            if ( CompareNames( it->LastPart, it->LastPartLen, key.LastPart, key.LastPartLen ) != 0 )
+                break;
+
+            const GlobalNameEntry&  entry = index->Entries[it->EntryIndex];
+
+            if ( entry.NameLen == nameLen )
+            {
+                if ( memcmp( entry.Name, nameChars, nameLen ) == 0 )
+                {
+                    // an unqualified match beats everything else
+                    handle = entry.Handle;
+                    return S_OK;
+                }
+                continue;
+            }
+
+            // it has to be "qualifier.name", where the qualifier is an
+            // inner scope than the best one so far
+
+            if ( entry.NameLen < nameLen + 2 )
+                continue;
+
+            size_t  qualLen = entry.NameLen - nameLen - 1;
+
+            if ( (bestEntry != NULL) && (qualLen <= bestQualLen) )
+                continue;
+
+            if ( (entry.Name[qualLen] != '.')
+                || (memcmp( entry.Name + qualLen + 1, nameChars, nameLen ) != 0)
+                || !IsScopeOf( entry.Name, qualLen, scopeChars, scopeLen ) )
+                continue;
+
+            bestEntry = &entry;
+            bestQualLen = qualLen;
+        }
+
+        if ( bestEntry == NULL )
+            return S_FALSE;
+
+        handle = bestEntry->Handle;
+        return S_OK;
+    }
+
+    HRESULT Session::FindGlobalSymbolsByPrefix(
+        const char* prefixChars,
+        size_t prefixLen,
+        uint32_t maxCount,
+        std::vector<SymHandle>& handles )
+    {
+        const GlobalNameIndex*  index = GetGlobalNameIndex();
+
+        if ( (index == NULL) || !index->Usable )
+            return E_NOTIMPL;
+
+        GlobalNameEntry key = { 0 };
+        uint32_t        count = 0;
+
+        key.Name = prefixChars;
+        key.NameLen = (uint32_t) prefixLen;
+
+        std::vector<GlobalNameEntry>::const_iterator it =
+            std::lower_bound( index->Entries.begin(), index->Entries.end(), key, GlobalNameEntryLess );
+
+        for ( ; (it != index->Entries.end()) && (count < maxCount); it++, count++ )
+        {
+            if ( (it->NameLen < prefixLen) || (memcmp( it->Name, prefixChars, prefixLen ) != 0) )
+                break;
+
+            handles.push_back( it->Handle );
+        }
+
+        return (count > 0) ? S_OK : S_FALSE;
+    }
+
+    HRESULT Session::FindGlobalSymbolInHeaps( const char* nameChars, size_t nameLen, SymHandle& handle )
+    {
+        HRESULT                 hr = S_OK;
+        EnumNamedSymbolsData    enumData = { 0 };
+
+        for ( int i = 0; i < SymHeap_Count; i++ )
+        {
+            hr = mStore->FindFirstSymbol( (SymbolHeapId) i, nameChars, nameLen, enumData );
+            if ( hr == S_OK )
+                break;
+        }
+
+        if ( hr != S_OK )
+            return S_FALSE;
+
+        // for now we only care about the first one
+        hr = mStore->GetCurrentSymbol( enumData, handle );
+        if ( FAILED( hr ) )
+            return hr;
+
+        return S_OK;
+    }
+
+    const Session::GlobalNameIndex* Session::GetGlobalNameIndex()
+    {
+        {
+            GuardedArea guard( mCacheGuard );
+
+            if ( mNameIndex.Get() != NULL )
+                return mNameIndex.Get();
+        }
+
+        // built outside the lock, like scope trees
+        UniquePtr<GlobalNameIndex>  index( new GlobalNameIndex() );
+
+        if ( index.Get() == NULL )
+            return NULL;
+
+        BuildGlobalNameIndex( *index.Get() );
+
+        GuardedArea guard( mCacheGuard );
+
+        if ( mNameIndex.Get() == NULL )
+            mNameIndex.Swap( index );
+
+        return mNameIndex.Get();
+    }
+
+    // Names are copied, because a store doesn't have to keep them in one
+    // place for as long as we need them.
+
+    void Session::BuildGlobalNameIndex( GlobalNameIndex& index )
+    {
+        SymInfoData     infoData = { 0 };
+        std::vector<uint32_t>   nameOffsets;
+
+        index.Usable = false;
+
+        for ( int i = 0; i < SymHeap_Count; i++ )
+        {
+            SymbolScope scope = { 0 };
+            SymHandle   handle = { 0 };
+
+            if ( mStore->SetSymbolScope( (SymbolHeapId) i, scope ) != S_OK )
+                continue;
+
+            index.Usable = true;
+
+            while ( mStore->NextSymbol( scope, handle ) )
+            {
+                ISymbolInfo*    symInfo = NULL;
+                SymString       pstrName;
+                GlobalNameEntry entry = { 0 };
+
+                if ( mStore->GetSymbolInfo( handle, infoData, symInfo ) != S_OK )
+                    continue;
+
+                if ( !symInfo->GetName( pstrName ) || (pstrName.GetLength() == 0) )
+                    continue;
+
+                entry.NameLen = (uint32_t) pstrName.GetLength();
+                entry.Handle = handle;
+
+                nameOffsets.push_back( (uint32_t) index.Chars.size() );
+                index.Chars.insert( index.Chars.end(), pstrName.GetName(), pstrName.GetName() + pstrName.GetLength() );
+                index.Entries.push_back( entry );
+            }
+        }
+
+        // the characters don't move anymore
+        for ( size_t i = 0; i < index.Entries.size(); i++ )
+        {
+            index.Entries[i].Name = &index.Chars[0] + nameOffsets[i];
+        }
+
+        // keep the heap order for the same names
+        std::stable_sort( index.Entries.begin(), index.Entries.end(), GlobalNameEntryLess );
+
+        index.LastParts.resize( index.Entries.size() );
+
+        for ( size_t i = 0; i < index.Entries.size(); i++ )
+        {
+            const GlobalNameEntry&  entry = index.Entries[i];
+            LastPartEntry&          part = index.LastParts[i];
+            uint32_t                start = entry.NameLen;
+
+            for ( ; (start > 0) && (entry.Name[start - 1] != '.'); start-- )
+            {
+            }
+
+            part.LastPart = entry.Name + start;
+            part.LastPartLen = entry.NameLen - start;
+            part.EntryIndex = (uint32_t) i;
+        }
+
+        std::sort( index.LastParts.begin(), index.LastParts.end(), LastPartEntryLess );
+    }
+
+    // The qualifier has to be the whole scope or one of its outer scopes,
+    // which end at a dot.
+
+    bool Session::IsScopeOf( const char* qualChars, size_t qualLen, const char* scopeChars, size_t scopeLen )
+    {
+        if ( qualLen > scopeLen )
+            return false;
+
+        if ( (qualLen < scopeLen) && (scopeChars[qualLen] != '.') )
+            return false;
+
+        return memcmp( qualChars, scopeChars, qualLen ) == 0;
+    }
+
+    int Session::CompareNames( const char* left, size_t leftLen, const char* right, size_t rightLen )
+    {
+        int result = memcmp( left, right, std::min( leftLen, rightLen ) );
+
+        if ( result != 0 )
+            return result;
+
+        if ( leftLen < rightLen )
+            return -1;
+        if ( leftLen > rightLen )
+            return 1;
+        return 0;
+    }
+
+    bool Session::GlobalNameEntryLess( const GlobalNameEntry& left, const GlobalNameEntry& right )
+    {
+        return CompareNames( left.Name, left.NameLen, right.Name, right.NameLen ) < 0;
+    }
+
+    bool Session::LastPartEntryLess( const LastPartEntry& left, const LastPartEntry& right )
+    {
+        int result = CompareNames( left.LastPart, left.LastPartLen, right.LastPart, right.LastPartLen );
+
+        if ( result != 0 )
+            return result < 0;
+
+        return left.EntryIndex < right.EntryIndex;
+    }
+
     HRESULT Session::FindChildSymbol( SymHandle parentHandle, const char* nameChars, size_t nameLen, SymHandle& handle )
     {
         HRESULT     hr = S_OK;
@@ -183,23 +499,89 @@ namespace MagoST
         if ( !symInfo->GetAddressSegment( funcSeg ) || (funcSeg != segment) )
             return E_FAIL;
 
+        const ScopeTree&    tree = GetScopeTree( parentHandle );
+        uint32_t            nodeIndex = 0;
+
         handles.resize( 0 );
 
         // recursing down the block children has to stop somewhere
         for ( int i = 0; i < USHRT_MAX; i++ )
+        {
+            const ScopeNode&    node = tree[nodeIndex];
+
+            handles.push_back( node.Handle );
+
+            if ( FAILED( node.ChildResult ) )
+                return node.ChildResult;
+
+            if ( !FindScopeChild( tree, node, offset, nodeIndex ) )
+                // didn't find a good child, return what we have
+                break;
+        }
+
+        return S_OK;
+    }
+
+    const Session::ScopeTree& Session::GetScopeTree( SymHandle handle )
+    {
+        ScopeKey                key( handle.unused1, handle.unused2 );
+        ScopeTree               tree;
+
+        {
+            GuardedArea guard( mCacheGuard );
+            ScopeTreeMap::iterator  it = mScopeTrees.find( key );
+
+            if ( it != mScopeTrees.end() )
+                return it->second;
+        }
+
+        // Build it without holding the lock. If another thread built it in 
+        // the meantime, then keep the one that's already in the map. Nodes in 
+        // a map don't move, and a tree isn't changed once it's in there.
+
+        BuildScopeTree( handle, tree );
+
+        GuardedArea guard( mCacheGuard );
+        std::pair<ScopeTreeMap::iterator, bool> result = 
+            mScopeTrees.insert( ScopeTreeMap::value_type( key, ScopeTree() ) );
+
+        if ( result.second )
+            result.first->second.swap( tree );
+
+        return result.first->second;
+    }
+
+    // Reads all the scopes under a symbol once, breadth first, so that the 
+    // children of each scope end up next to each other.
+
+    void Session::BuildScopeTree( SymHandle handle, ScopeTree& tree )
+    {
+        HRESULT         hr = S_OK;
+        SymInfoData     infoData = { 0 };
+        ISymbolInfo*    symInfo = NULL;
+        ScopeNode       root = { 0 };
+        // bad scope ends in the symbols could make the tree grow forever
+        const size_t    MaxNodes = USHRT_MAX * 16;
+
+        root.Handle = handle;
+        tree.push_back( root );
+
+        for ( size_t i = 0; (i < tree.size()) && (tree.size() < MaxNodes); i++ )
         {
             SymbolScope scope = { 0 };
-            // in case there are no children
-            SymHandle   curHandle = parentHandle;
-            bool        foundChild = false;
+            SymHandle   curHandle = { 0 };
+            uint32_t    childStart = (uint32_t) tree.size();
 
-            handles.push_back( parentHandle );
+            tree[i].ChildStart = childStart;
 
-            hr = mStore->SetChildSymbolScope( parentHandle, scope );
+            hr = mStore->SetChildSymbolScope( tree[i].Handle, scope );
             if ( FAILED( hr ) )
-                return hr;
+            {
+                tree[i].ChildResult = hr;
+                continue;
+            }
 
-            for ( int j = 0; (j < USHRT_MAX) && !foundChild && mStore->NextSymbol( scope, curHandle ); j++ )
+            for ( int j = 0; (j < USHRT_MAX) && mStore->NextSymbol( scope, curHandle ); j++ )
             {
                 SymTag          tag = SymTagNull;
                 uint32_t        childOffset = 0;
@@ -216,27 +598,209 @@ namespace MagoST
                 case SymTagBlock:
                 case SymTagFunction:
                 case SymTagThunk:
-                // TODO: With
                     if ( !symInfo->GetAddressOffset( childOffset ) )
                         continue;
                     if ( !symInfo->GetLength( childLen ) )
                         continue;
-                    if ( (offset >= childOffset) && (offset < (childOffset + childLen)) )
-                        foundChild = true;
+                    if ( childLen == 0 )
+                        continue;
                     break;
+
+                default:
+                    continue;
                 }
+
+                ScopeNode   child = { 0 };
+
+                child.Handle = curHandle;
+                child.Offset = childOffset;
+                child.End = childOffset + childLen;
+                child.Order = j;
+                tree.push_back( child );
             }
 
-            if ( foundChild )
-                parentHandle = curHandle;
-            else
-                // didn't find a good child, return what we have
-                break;
+            uint32_t    childEnd = (uint32_t) tree.size();
+            uint32_t    maxEnd = 0;
+
+            std::sort( tree.begin() + childStart, tree.begin() + childEnd, ScopeNodeLess );
+
+            for ( uint32_t k = childStart; k < childEnd; k++ )
+            {
+                if ( tree[k].End > maxEnd )
+                    maxEnd = tree[k].End;
+                tree[k].MaxEnd = maxEnd;
+            }
+
+            tree[i].ChildCount = childEnd - childStart;
+        }
+
+        // trim the excess capacity
+        ScopeTree( tree ).swap( tree );
+    }
+
+    // Finds the first child in symbol order that contains the offset.
+
+    bool Session::FindScopeChild( const ScopeTree& tree, const ScopeNode& parent, uint32_t offset, uint32_t& childIndex )
+    {
+        if ( parent.ChildCount == 0 )
+            return false;
+
+        ScopeTree::const_iterator   begin = tree.begin() + parent.ChildStart;
+        ScopeTree::const_iterator   end = begin + parent.ChildCount;
+        ScopeTree::const_iterator   it = std::upper_bound( begin, end, offset, OffsetLessThanScope );
+        bool                        found = false;
+
+        // children before this one start at or before the offset; go back 
+        // until none of the rest reach past the offset
+        while ( (it != begin) && ((it - 1)->MaxEnd > offset) )
+        {
+            --it;
+
+            if ( (offset < it->End) 
+                && (!found || (it->Order < tree[childIndex].Order)) )
+            {
+                childIndex = (uint32_t) (it - tree.begin());
+                found = true;
+            }
+        }
+
+        return found;
+    }
+
+    bool Session::ScopeNodeLess( const ScopeNode& left, const ScopeNode& right )
+    {
+        if ( left.Offset != right.Offset )
+            return left.Offset < right.Offset;
+
+        return left.Order < right.Order;
+    }
+
+    bool Session::OffsetLessThanScope( uint32_t offset, const ScopeNode& node )
+    {
+        return offset < node.Offset;
+    }
+
+    // The addresses are resolved in order, so that neighbors can reuse what 
+    // was found for the one before: the same function and the same line. 
+    // Otherwise the store's own searches are used; they're binary searches 
+    // of sorted tables, which cost less than walking the tables alongside 
+    // the addresses unless there are nearly as many addresses as entries.
+
+    HRESULT Session::FindAddresses( const uint64_t* vas, uint32_t count, AddressInfo* infos )
+    {
+        if ( count == 0 )
+            return S_OK;
+        if ( (vas == NULL) || (infos == NULL) )
+            return E_INVALIDARG;
+
+        typedef std::pair<uint64_t, uint32_t> VAIndex;
+
+        std::vector<VAIndex>    order( count );
+        const AddressInfo*      prevInfo = NULL;
+
+        for ( uint32_t i = 0; i < count; i++ )
+        {
+            order[i].first = vas[i];
+            order[i].second = i;
+        }
+
+        std::sort( order.begin(), order.end() );
+
+        for ( uint32_t i = 0; i < count; i++ )
+        {
+            AddressInfo&    info = infos[order[i].second];
+
+            info.Section = GetSecOffsetFromVA( order[i].first, info.Offset );
+            info.HasFunction = false;
+            memset( &info.FuncHandle, 0, sizeof info.FuncHandle );
+            info.Blocks.resize( 0 );
+            info.HasLine = false;
+
+            if ( info.Section == 0 )
+                continue;
+
+            if ( (prevInfo != NULL) 
+                && (prevInfo->Section == info.Section) 
+                && (prevInfo->Offset == info.Offset) )
+            {
+                info = *prevInfo;
+                continue;
+            }
+
+            FindAddressFunction( info, prevInfo );
+            FindAddressLine( info, prevInfo );
+
+            prevInfo = &info;
         }
 
         return S_OK;
     }
 
+    void Session::FindAddressFunction( AddressInfo& info, const AddressInfo* prevInfo )
+    {
+        HRESULT     hr = S_OK;
+        uint32_t    funcOffset = 0;
+        uint32_t    funcLen = 0;
+
+        if ( (prevInfo != NULL) 
+            && prevInfo->HasFunction 
+            && (prevInfo->Section == info.Section) 
+            && GetSymbolRange( prevInfo->FuncHandle, funcOffset, funcLen ) 
+            && (info.Offset >= funcOffset) 
+            && (info.Offset < (funcOffset + funcLen)) )
+        {
+            info.FuncHandle = prevInfo->FuncHandle;
+        }
+        else
+        {
+            hr = mStore->FindSymbol( SymHeap_GlobalSymbols, info.Section, info.Offset, info.FuncHandle );
+            if ( FAILED( hr ) )
+            {
+                hr = mStore->FindSymbol( SymHeap_StaticSymbols, info.Section, info.Offset, info.FuncHandle );
+                if ( FAILED( hr ) )
+                {
+                    hr = mStore->FindSymbol( SymHeap_PublicSymbols, info.Section, info.Offset, info.FuncHandle );
+                    if ( FAILED( hr ) )
+                        return;
+                }
+            }
+        }
+
+        info.HasFunction = true;
+
+        hr = FindInnermostSymbol( info.FuncHandle, info.Section, info.Offset, info.Blocks );
+        // it might be a public symbol, which doesn't have any blocks
+        if ( FAILED( hr ) )
+            info.Blocks.resize( 0 );
+    }
+
+    void Session::FindAddressLine( AddressInfo& info, const AddressInfo* prevInfo )
+    {
+        if ( (prevInfo != NULL) 
+            && prevInfo->HasLine 
+            && (prevInfo->Line.Section == info.Section) 
+            && (info.Offset >= prevInfo->Line.Offset) 
+            && (info.Offset < (prevInfo->Line.Offset + prevInfo->Line.Length)) )
+        {
+            info.HasLine = true;
+            info.Line = prevInfo->Line;
+            return;
+        }
+
+        info.HasLine = mStore->FindLine( info.Section, info.Offset, info.Line );
+    }
+
+    bool Session::GetSymbolRange( SymHandle handle, uint32_t& offset, uint32_t& length )
+    {
+        SymInfoData     infoData = { 0 };
+        ISymbolInfo*    symInfo = NULL;
+
+        if ( FAILED( mStore->GetSymbolInfo( handle, infoData, symInfo ) ) )
+            return false;
+
+        return symInfo->GetAddressOffset( offset ) && symInfo->GetLength( length );
+    }
+
     HRESULT Session::SetChildSymbolScope( SymHandle handle, SymbolScope& scope )
     {
         return mStore->SetChildSymbolScope( handle, scope );
@@ -309,6 +873,173 @@ namespace MagoST
         return S_FALSE;
     }
 
+    HRESULT Session::FindMemberType( 
+        TypeIndex fieldListIndex, 
+        const char* nameChars, 
+        size_t nameLen, 
+        TypeHandle& handle, 
+        int32_t& baseOffset )
+    {
+        const MemberIndex&  index = GetMemberIndex( fieldListIndex );
+        uint32_t            hash = GetMemberNameHash( nameChars, nameLen );
+        SymInfoData         infoData = { 0 };
+
+        MemberIndex::const_iterator it = std::lower_bound( index.begin(), index.end(), hash, MemberHashLess );
+
+        // entries with the same hash are in lookup order
+        for ( ; (it != index.end()) && (it->Hash == hash); it++ )
+        {
+            ISymbolInfo*    symInfo = NULL;
+            SymString       pstrName;
+
+            if ( mStore->GetTypeInfo( it->Handle, infoData, symInfo ) != S_OK )
+                continue;
+
+            if ( !symInfo->GetName( pstrName ) )
+                continue;
+
+            if ( (nameLen == pstrName.GetLength()) && (memcmp( nameChars, pstrName.GetName(), nameLen ) == 0) )
+            {
+                handle = it->Handle;
+                baseOffset = it->BaseOffset;
+                return S_OK;
+            }
+        }
+
+        return S_FALSE;
+    }
+
+    const Session::MemberIndex& Session::GetMemberIndex( TypeIndex fieldListIndex )
+    {
+        MemberIndex     index;
+
+        {
+            GuardedArea guard( mCacheGuard );
+            MemberIndexMap::iterator    it = mMemberIndexes.find( fieldListIndex );
+
+            if ( it != mMemberIndexes.end() )
+                return it->second;
+        }
+
+        // built outside the lock, like scope trees
+        BuildMemberIndex( fieldListIndex, index );
+
+        GuardedArea guard( mCacheGuard );
+        std::pair<MemberIndexMap::iterator, bool> result = 
+            mMemberIndexes.insert( MemberIndexMap::value_type( fieldListIndex, MemberIndex() ) );
+
+        if ( result.second )
+            result.first->second.swap( index );
+
+        return result.first->second;
+    }
+
+    // Reads the members of the field list, then the members of the base class 
+    // that is first in it, and so on, so that a derived class's member hides a 
+    // base class's member with the same name.
+
+    void Session::BuildMemberIndex( TypeIndex fieldListIndex, MemberIndex& index )
+    {
+        HRESULT     hr = S_OK;
+        TypeIndex   flistIndex = fieldListIndex;
+        int32_t     baseOffset = 0;
+        uint32_t    order = 0;
+        // a bad base class chain could loop forever
+        const int   MaxBaseDepth = 256;
+
+        for ( int depth = 0; depth < MaxBaseDepth; depth++ )
+        {
+            TypeScope   scope = { 0 };
+            TypeHandle  flistHandle = { 0 };
+            TypeHandle  childHandle = { 0 };
+            SymInfoData infoData = { 0 };
+            bool        isFirst = true;
+            bool        hasBase = false;
+            TypeIndex   baseClassTI = 0;
+            int32_t     baseClassOffset = 0;
+
+            if ( !mStore->GetTypeFromTypeIndex( flistIndex, flistHandle ) )
+                break;
+
+            hr = mStore->SetChildTypeScope( flistHandle, scope );
+            if ( hr != S_OK )
+                break;
+
+            for ( ; mStore->NextType( scope, childHandle ); )
+            {
+                ISymbolInfo*    symInfo = NULL;
+                SymString       pstrName;
+                bool            wasFirst = isFirst;
+
+                isFirst = false;
+
+                hr = mStore->GetTypeInfo( childHandle, infoData, symInfo );
+                if ( hr != S_OK )
+                    continue;
+
+                // base classes are first in the field list
+                if ( wasFirst && (symInfo->GetSymTag() == SymTagBaseClass) )
+                {
+                    hasBase = symInfo->GetType( baseClassTI );
+                    if ( !symInfo->GetOffset( baseClassOffset ) )
+                        baseClassOffset = 0;
+                }
+
+                if ( !symInfo->GetName( pstrName ) )
+                    continue;
+
+                MemberEntry entry = { 0 };
+
+                entry.Hash = GetMemberNameHash( pstrName.GetName(), pstrName.GetLength() );
+                entry.Order = order++;
+                entry.BaseOffset = baseOffset;
+                entry.Handle = childHandle;
+                index.push_back( entry );
+            }
+
+            if ( !hasBase )
+                break;
+
+            TypeHandle      baseClassTH = { 0 };
+            ISymbolInfo*    baseClassInfo = NULL;
+
+            if ( !mStore->GetTypeFromTypeIndex( baseClassTI, baseClassTH ) )
+                break;
+
+            hr = mStore->GetTypeInfo( baseClassTH, infoData, baseClassInfo );
+            if ( hr != S_OK )
+                break;
+
+            if ( !baseClassInfo->GetFieldList( flistIndex ) )
+                break;
+
+            baseOffset += baseClassOffset;
+        }
+
+        std::sort( index.begin(), index.end(), MemberEntryLess );
+
+        // trim the excess capacity
+        MemberIndex( index ).swap( index );
+    }
+
+    uint32_t Session::GetMemberNameHash( const char* nameChars, size_t nameLen )
+    {
+        return HashFnv1a( nameChars, nameLen );
+    }
+
+    bool Session::MemberEntryLess( const MemberEntry& left, const MemberEntry& right )
+    {
+        if ( left.Hash != right.Hash )
+            return left.Hash < right.Hash;
+
+        return left.Order < right.Order;
+    }
+
+    bool Session::MemberHashLess( const MemberEntry& entry, uint32_t hash )
+    {
+        return entry.Hash < hash;
+    }
+
     // source files
 
     HRESULT Session::GetCompilandCount( uint32_t& count )
@@ -351,7 +1082,7 @@ namespace MagoST
         return mStore->FindLine( seg, offset, lineNumber );
     }
     bool Session::FindLines( bool exactMatch, const char* fileName, size_t fileNameLen, uint16_t reqLineStart, uint16_t reqLineEnd, 
-                             std::list<LineNumber>& lines )
+                             std::vector<LineNumber>& lines )
     {
         return mStore->FindLines( exactMatch, fileName, fileNameLen, reqLineStart, reqLineEnd, lines );
     }
@@ -19,12 +19,74 @@ namespace MagoST
 
     class Session : public ISession
     {
+        // A scope with an address range, found under a function. The children 
+        // of a scope are contiguous and sorted by offset, with a running 
+        // maximum of their ends.
+        struct ScopeNode
+        {
+            SymHandle   Handle;
+            uint32_t    Offset;
+            uint32_t    End;
+            uint32_t    MaxEnd;
+            uint32_t    Order;              // position among its siblings in the symbols
+            uint32_t    ChildStart;
+            uint32_t    ChildCount;
+            HRESULT     ChildResult;        // result of opening the scope's children
+        };
+
+        typedef std::vector<ScopeNode>  ScopeTree;
+        typedef std::pair<intptr_t, intptr_t>   ScopeKey;
+        typedef std::map<ScopeKey, ScopeTree>   ScopeTreeMap;
+
+        // A named member of a class or one of its base classes, sorted by the 
+        // hash of its name, and then by the order the lookup would find it.
+        struct MemberEntry
+        {
+            uint32_t    Hash;
+            uint32_t    Order;
+            int32_t     BaseOffset;
+            TypeHandle  Handle;
+        };
+
+        typedef std::vector<MemberEntry>            MemberIndex;
+        typedef std::map<TypeIndex, MemberIndex>    MemberIndexMap;
+
+        // The names of the global, static, and public symbols, read once.
+        // Names are sorted, and the same names are in the order that searching
+        // the heaps one after the other would find them.
+        struct GlobalNameEntry
+        {
+            const char* Name;               // in GlobalNameIndex::Chars
+            uint32_t    NameLen;
+            SymHandle   Handle;
+        };
+
+        // The part of a name after the last dot, for finding qualified names
+        struct LastPartEntry
+        {
+            const char* LastPart;
+            uint32_t    LastPartLen;
+            uint32_t    EntryIndex;
+        };
+
+        struct GlobalNameIndex
+        {
+            bool                            Usable;     // false if the store can't walk its heaps
+            std::vector<char>               Chars;
+            std::vector<GlobalNameEntry>    Entries;
+            std::vector<LastPartEntry>      LastParts;  // sorted by last part, then entry
+        };
+
         long        mRefCount;
 
         uint64_t            mLoadAddr;
         RefPtr<DataSource>  mDataSource;
         IDebugStore*        mStore;         // valid while we hold onto data source
         RefPtr<IAddressMap> mAddrMap;
+        ScopeTreeMap        mScopeTrees;
+        MemberIndexMap      mMemberIndexes;
+        UniquePtr<GlobalNameIndex>  mNameIndex;
+        Guard               mCacheGuard;    // for the caches above, not their values
 
     public:
         Session( DataSource* dataSource );
@@ -56,6 +118,19 @@ namespace MagoST
         virtual HRESULT FindNextSymbol( EnumNamedSymbolsData& handle );
         virtual HRESULT GetCurrentSymbol( const EnumNamedSymbolsData& searchHandle, SymHandle& handle );
 
+        virtual HRESULT FindGlobalSymbol( const char* nameChars, size_t nameLen, SymHandle& handle );
+        virtual HRESULT FindScopedGlobalSymbol( 
+            const char* scopeChars, 
+            size_t scopeLen, 
+            const char* nameChars, 
+            size_t nameLen, 
+            SymHandle& handle );
+        virtual HRESULT FindGlobalSymbolsByPrefix( 
+            const char* prefixChars, 
+            size_t prefixLen, 
+            uint32_t maxCount, 
+            std::vector<SymHandle>& handles );
+
         virtual HRESULT FindChildSymbol(
             SymHandle parentHandle, 
             const char* nameChars, 
@@ -66,6 +141,7 @@ namespace MagoST
         virtual HRESULT FindOuterSymbolByRVA( SymbolHeapId heapId, DWORD rva, SymHandle& handle );
         virtual HRESULT FindOuterSymbolByVA( SymbolHeapId heapId, DWORD64 va, SymHandle& handle );
         virtual HRESULT FindInnermostSymbol( SymHandle parentHandle, WORD segment, DWORD offset, std::vector<SymHandle>& handles );
+        virtual HRESULT FindAddresses( const uint64_t* vas, uint32_t count, AddressInfo* infos );
 
         virtual HRESULT SetChildSymbolScope( SymHandle handle, SymbolScope& scope );
 
@@ -87,6 +163,13 @@ namespace MagoST
             size_t nameLen, 
             TypeHandle& handle );
 
+        virtual HRESULT FindMemberType( 
+            TypeIndex fieldListIndex, 
+            const char* nameChars, 
+            size_t nameLen, 
+            TypeHandle& handle, 
+            int32_t& baseOffset );
+
         // source files
 
         virtual HRESULT GetCompilandCount( uint32_t& count );
@@ -103,6 +186,28 @@ namespace MagoST
         virtual bool FindNextLineByNum( uint16_t compIndex, uint16_t fileIndex, uint16_t line, LineNumber& lineNumber );
 
         virtual bool FindLines( bool exactMatch, const char* fileName, size_t fileNameLen, uint16_t reqLineStart, uint16_t reqLineEnd, 
-                                std::list<LineNumber>& lines );
+                                std::vector<LineNumber>& lines );
+
+    private:
+        const ScopeTree& GetScopeTree( SymHandle handle );
+        void BuildScopeTree( SymHandle handle, ScopeTree& tree );
+        bool FindScopeChild( const ScopeTree& tree, const ScopeNode& parent, uint32_t offset, uint32_t& childIndex );
+        static bool ScopeNodeLess( const ScopeNode& left, const ScopeNode& right );
+        static bool OffsetLessThanScope( uint32_t offset, const ScopeNode& node );
+        const MemberIndex& GetMemberIndex( TypeIndex fieldListIndex );
+        void BuildMemberIndex( TypeIndex fieldListIndex, MemberIndex& index );
+        static uint32_t GetMemberNameHash( const char* nameChars, size_t nameLen );
+        static bool MemberEntryLess( const MemberEntry& left, const MemberEntry& right );
+        static bool MemberHashLess( const MemberEntry& entry, uint32_t hash );
+        const GlobalNameIndex* GetGlobalNameIndex();
+        void BuildGlobalNameIndex( GlobalNameIndex& index );
+        HRESULT FindGlobalSymbolInHeaps( const char* nameChars, size_t nameLen, SymHandle& handle );
+        static bool IsScopeOf( const char* qualChars, size_t qualLen, const char* scopeChars, size_t scopeLen );
+        static int CompareNames( const char* left, size_t leftLen, const char* right, size_t rightLen );
+        static bool GlobalNameEntryLess( const GlobalNameEntry& left, const GlobalNameEntry& right );
+        static bool LastPartEntryLess( const LastPartEntry& left, const LastPartEntry& right );
+        bool GetSymbolRange( SymHandle handle, uint32_t& offset, uint32_t& length );
+        void FindAddressFunction( AddressInfo& info, const AddressInfo* prevInfo );
+        void FindAddressLine( AddressInfo& info, const AddressInfo* prevInfo );
     };
 }
@@ -0,0 +1,1608 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#include "Common.h"
+#include "C13SymbolInfo.h"
+#include "TypeInfo.h"
+#include "cvconst.h"
+#include "cvinfo.h"
+#include "Util.h"
+
+
+namespace MagoST
+{
+    // Names in CodeView 8 records are zero-terminated, and they have to end 
+    // before the record does.
+
+    static bool AssignName( SymString& name, const char* chars, const void* record )
+    {
+        const BYTE* limit = (const BYTE*) record + *(const uint16_t*) record + 2;
+        const BYTE* start = (const BYTE*) chars;
+
+        if ( start >= limit )
+            return false;
+
+        const BYTE* end = (const BYTE*) memchr( start, 0, limit - start );
+
+        if ( end == NULL )
+            return false;
+
+        name.set( end - start, chars, false );
+        return true;
+    }
+
+    // Fields don't have a length of their own. Going through the field list 
+    // to get to one already made sure that its name ends inside the list.
+
+    static bool AssignFieldName( SymString& name, const char* chars )
+    {
+        name.set( strlen( chars ), chars, false );
+        return true;
+    }
+
+    static uint16_t* GetNumLeaf( const unsigned short* numLeaf )
+    {
+        return (uint16_t*) numLeaf;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13NonTypeSymbol
+    //------------------------------------------------------------------------
+
+    C13NonTypeSymbol::C13NonTypeSymbol( const BYTE* sym )
+    {
+        mData.C13Symbol.Sym = sym;
+        mData.C13Symbol.FuncType = 0;
+        mData.C13Symbol.FrameReg = 0;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13RegSymbol
+    //------------------------------------------------------------------------
+
+    C13RegSymbol::C13RegSymbol( const BYTE* sym )
+        :   C13NonTypeSymbol( sym )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13RegSymbol::GetSymTag()
+    {
+        return SymTagData;
+    }
+
+    bool C13RegSymbol::GetType( TypeIndex& index )
+    {
+        index = GetSym()->reg.type;
+        return true;
+    }
+
+    bool C13RegSymbol::GetName( SymString& name )
+    {
+        return AssignName( name, GetSym()->reg.name, GetSym() );
+    }
+
+    bool C13RegSymbol::GetLocation( LocationType& loc )
+    {
+        loc = LocIsEnregistered;
+        return true;
+    }
+
+    bool C13RegSymbol::GetDataKind( DataKind& dataKind )
+    {
+        dataKind = DataIsLocal;
+        return true;
+    }
+
+    bool C13RegSymbol::GetRegister( uint32_t& reg )
+    {
+        reg = GetSym()->reg.reg;
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13ConstSymbol
+    //------------------------------------------------------------------------
+
+    C13ConstSymbol::C13ConstSymbol( const BYTE* sym )
+        :   C13NonTypeSymbol( sym )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13ConstSymbol::GetSymTag()
+    {
+        return SymTagData;
+    }
+
+    bool C13ConstSymbol::GetType( TypeIndex& index )
+    {
+        index = GetSym()->constant.type;
+        return true;
+    }
+
+    bool C13ConstSymbol::GetName( SymString& name )
+    {
+        // value is variable size and it comes before name, so work it out
+        uint16_t*   value = GetNumLeaf( &GetSym()->constant.value );
+        uint32_t    offset = GetNumLeafSize( value );
+
+        return AssignName( name, (const char*) value + offset, GetSym() );
+    }
+
+    bool C13ConstSymbol::GetLocation( LocationType& loc )
+    {
+        loc = LocIsConstant;
+        return true;
+    }
+
+    bool C13ConstSymbol::GetDataKind( DataKind& dataKind )
+    {
+        dataKind = DataIsConstant;
+        return true;
+    }
+
+    bool C13ConstSymbol::GetValue( Variant& val )
+    {
+        GetNumLeafValue( GetNumLeaf( &GetSym()->constant.value ), val );
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13BPRelSymbol
+    //------------------------------------------------------------------------
+
+    C13BPRelSymbol::C13BPRelSymbol( const BYTE* sym, uint32_t frameReg )
+        :   C13NonTypeSymbol( sym )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+        
+        mData.C13Symbol.FrameReg = frameReg;
+    }
+
+    SymTag C13BPRelSymbol::GetSymTag()
+    {
+        return SymTagData;
+    }
+
+    bool C13BPRelSymbol::GetType( TypeIndex& index )
+    {
+        index = GetSym()->bprel.type;
+        return true;
+    }
+
+    bool C13BPRelSymbol::GetName( SymString& name )
+    {
+        return AssignName( name, GetSym()->bprel.name, GetSym() );
+    }
+
+    bool C13BPRelSymbol::GetLocation( LocationType& loc )
+    {
+        loc = LocIsRegRel;
+        return true;
+    }
+
+    bool C13BPRelSymbol::GetDataKind( DataKind& dataKind )
+    {
+        dataKind = GetSym()->bprel.offset < 0 ? DataIsParam : DataIsLocal;
+        return true;
+    }
+
+    bool C13BPRelSymbol::GetRegister( uint32_t& reg )
+    {
+        reg = mData.C13Symbol.FrameReg;
+        return true;
+    }
+
+    bool C13BPRelSymbol::GetOffset( int32_t& offset )
+    {
+        offset = GetSym()->bprel.offset;
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13DataSymbol
+    //------------------------------------------------------------------------
+
+    C13DataSymbol::C13DataSymbol( const BYTE* sym )
+        :   C13NonTypeSymbol( sym )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13DataSymbol::GetSymTag()
+    {
+        return SymTagData;
+    }
+
+    bool C13DataSymbol::GetType( TypeIndex& index )
+    {
+        index = GetSym()->data.type;
+        return true;
+    }
+
+    bool C13DataSymbol::GetName( SymString& name )
+    {
+        return AssignName( name, GetSym()->data.name, GetSym() );
+    }
+
+    bool C13DataSymbol::GetLocation( LocationType& loc )
+    {
+        loc = LocIsStatic;
+        return true;
+    }
+
+    bool C13DataSymbol::GetDataKind( DataKind& dataKind )
+    {
+        // if it's in a function and is LDATA/LTHREAD, then it's DataIsStaticLocal, 
+        // but we'll leave that up to the user
+        if ( GetSym()->Generic.id == S_LDATA32_V3 )
+            dataKind = DataIsFileStatic;
+        else
+            dataKind = DataIsGlobal;
+        return true;
+    }
+
+    bool C13DataSymbol::GetAddressOffset( uint32_t& offset )
+    {
+        offset = GetSym()->data.offset;
+        return true;
+    }
+
+    bool C13DataSymbol::GetAddressSegment( uint16_t& segment )
+    {
+        segment = GetSym()->data.segment;
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13PublicSymbol
+    //------------------------------------------------------------------------
+
+    C13PublicSymbol::C13PublicSymbol( const BYTE* sym )
+        :   C13NonTypeSymbol( sym )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13PublicSymbol::GetSymTag()
+    {
+        return SymTagPublicSymbol;
+    }
+
+    bool C13PublicSymbol::GetName( SymString& name )
+    {
+        return AssignName( name, GetSym()->pub.name, GetSym() );
+    }
+
+    bool C13PublicSymbol::GetLocation( LocationType& loc )
+    {
+        loc = LocIsStatic;
+        return true;
+    }
+
+    bool C13PublicSymbol::GetDataKind( DataKind& dataKind )
+    {
+        dataKind = DataIsGlobal;
+        return true;
+    }
+
+    bool C13PublicSymbol::GetAddressOffset( uint32_t& offset )
+    {
+        offset = GetSym()->pub.offset;
+        return true;
+    }
+
+    bool C13PublicSymbol::GetAddressSegment( uint16_t& segment )
+    {
+        segment = GetSym()->pub.segment;
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13ProcSymbol
+    //------------------------------------------------------------------------
+
+    C13ProcSymbol::C13ProcSymbol( const BYTE* sym, TypeIndex funcType )
+        :   C13NonTypeSymbol( sym )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+        
+        mData.C13Symbol.FuncType = funcType;
+    }
+
+    SymTag C13ProcSymbol::GetSymTag()
+    {
+        return SymTagFunction;
+    }
+
+    bool C13ProcSymbol::GetType( TypeIndex& index )
+    {
+        const CodeViewSymbolV3*    sym = GetSym();
+
+        // the type of these is a function ID, which the store looked up
+        if ( (sym->Generic.id == S_GPROC32_ID) || (sym->Generic.id == S_LPROC32_ID) )
+            index = mData.C13Symbol.FuncType;
+        else
+            index = sym->proc.type;
+        return true;
+    }
+
+    bool C13ProcSymbol::GetName( SymString& name )
+    {
+        return AssignName( name, GetSym()->proc.name, GetSym() );
+    }
+
+    bool C13ProcSymbol::GetLocation( LocationType& loc )
+    {
+        loc = LocIsStatic;
+        return true;
+    }
+
+    bool C13ProcSymbol::GetAddressOffset( uint32_t& offset )
+    {
+        offset = GetSym()->proc.offset;
+        return true;
+    }
+
+    bool C13ProcSymbol::GetAddressSegment( uint16_t& segment )
+    {
+        segment = GetSym()->proc.segment;
+        return true;
+    }
+
+    bool C13ProcSymbol::GetLength( uint32_t& length )
+    {
+        length = GetSym()->proc.length;
+        return true;
+    }
+
+    bool C13ProcSymbol::GetDebugStart( uint32_t& start )
+    {
+        start = GetSym()->proc.debug_start;
+        return true;
+    }
+
+    bool C13ProcSymbol::GetDebugEnd( uint32_t& end )
+    {
+        end = GetSym()->proc.debug_end;
+        return true;
+    }
+
+    bool C13ProcSymbol::GetProcFlags( uint8_t& flags )
+    {
+        flags = GetSym()->proc.flags;
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13ThunkSymbol
+    //------------------------------------------------------------------------
+
+    C13ThunkSymbol::C13ThunkSymbol( const BYTE* sym )
+        :   C13NonTypeSymbol( sym )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13ThunkSymbol::GetSymTag()
+    {
+        return SymTagThunk;
+    }
+
+    bool C13ThunkSymbol::GetName( SymString& name )
+    {
+        return AssignName( name, GetSym()->thunk.name, GetSym() );
+    }
+
+    bool C13ThunkSymbol::GetLocation( LocationType& loc )
+    {
+        loc = LocIsStatic;
+        return true;
+    }
+
+    bool C13ThunkSymbol::GetAddressOffset( uint32_t& offset )
+    {
+        offset = GetSym()->thunk.offset;
+        return true;
+    }
+
+    bool C13ThunkSymbol::GetAddressSegment( uint16_t& segment )
+    {
+        segment = GetSym()->thunk.segment;
+        return true;
+    }
+
+    bool C13ThunkSymbol::GetLength( uint32_t& length )
+    {
+        length = GetSym()->thunk.length;
+        return true;
+    }
+
+    bool C13ThunkSymbol::GetThunkOrdinal( uint8_t& ordinal )
+    {
+        ordinal = GetSym()->thunk.ord;
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13BlockSymbol
+    //------------------------------------------------------------------------
+
+    C13BlockSymbol::C13BlockSymbol( const BYTE* sym )
+        :   C13NonTypeSymbol( sym )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13BlockSymbol::GetSymTag()
+    {
+        return SymTagBlock;
+    }
+
+    bool C13BlockSymbol::GetName( SymString& name )
+    {
+        return AssignName( name, GetSym()->block.name, GetSym() );
+    }
+
+    bool C13BlockSymbol::GetLocation( LocationType& loc )
+    {
+        loc = LocIsStatic;
+        return true;
+    }
+
+    bool C13BlockSymbol::GetAddressOffset( uint32_t& offset )
+    {
+        offset = GetSym()->block.offset;
+        return true;
+    }
+
+    bool C13BlockSymbol::GetAddressSegment( uint16_t& segment )
+    {
+        segment = GetSym()->block.segment;
+        return true;
+    }
+
+    bool C13BlockSymbol::GetLength( uint32_t& length )
+    {
+        length = GetSym()->block.length;
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13LabelSymbol
+    //------------------------------------------------------------------------
+
+    C13LabelSymbol::C13LabelSymbol( const BYTE* sym )
+        :   C13NonTypeSymbol( sym )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13LabelSymbol::GetSymTag()
+    {
+        return SymTagLabel;
+    }
+
+    bool C13LabelSymbol::GetName( SymString& name )
+    {
+        return AssignName( name, GetSym()->label.name, GetSym() );
+    }
+
+    bool C13LabelSymbol::GetLocation( LocationType& loc )
+    {
+        loc = LocIsStatic;
+        return true;
+    }
+
+    bool C13LabelSymbol::GetAddressOffset( uint32_t& offset )
+    {
+        offset = GetSym()->label.offset;
+        return true;
+    }
+
+    bool C13LabelSymbol::GetAddressSegment( uint16_t& segment )
+    {
+        segment = GetSym()->label.segment;
+        return true;
+    }
+
+    bool C13LabelSymbol::GetProcFlags( uint8_t& flags )
+    {
+        flags = GetSym()->label.flags;
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13RegRelSymbol
+    //------------------------------------------------------------------------
+
+    C13RegRelSymbol::C13RegRelSymbol( const BYTE* sym )
+        :   C13NonTypeSymbol( sym )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13RegRelSymbol::GetSymTag()
+    {
+        return SymTagData;
+    }
+
+    bool C13RegRelSymbol::GetType( TypeIndex& index )
+    {
+        index = GetSym()->regrel.type;
+        return true;
+    }
+
+    bool C13RegRelSymbol::GetName( SymString& name )
+    {
+        return AssignName( name, GetSym()->regrel.name, GetSym() );
+    }
+
+    bool C13RegRelSymbol::GetLocation( LocationType& loc )
+    {
+        loc = LocIsRegRel;
+        return true;
+    }
+
+    bool C13RegRelSymbol::GetDataKind( DataKind& dataKind )
+    {
+        dataKind = DataIsLocal;
+        return true;
+    }
+
+    bool C13RegRelSymbol::GetRegister( uint32_t& reg )
+    {
+        reg = GetSym()->regrel.reg;
+        return true;
+    }
+
+    bool C13RegRelSymbol::GetOffset( int32_t& offset )
+    {
+        offset = GetSym()->regrel.offset;
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13LocalSymbol
+    //------------------------------------------------------------------------
+
+    C13LocalSymbol::C13LocalSymbol( const BYTE* sym, const BYTE* defRange, uint32_t frameReg )
+        :   C13NonTypeSymbol( sym )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+
+        mData.C13Local.DefRange = defRange;
+        mData.C13Local.FrameReg = frameReg;
+    }
+
+    SymTag C13LocalSymbol::GetSymTag()
+    {
+        return SymTagData;
+    }
+
+    bool C13LocalSymbol::GetType( TypeIndex& index )
+    {
+        index = GetSym()->local.type;
+        return true;
+    }
+
+    bool C13LocalSymbol::GetName( SymString& name )
+    {
+        return AssignName( name, GetSym()->local.name, GetSym() );
+    }
+
+    bool C13LocalSymbol::GetLocation( LocationType& loc )
+    {
+        if ( (GetDefRange() == NULL) || ((GetSym()->local.flags & CV_LVAR_OPTIMIZEDOUT_V3) != 0) )
+            loc = LocIsNull;
+        else if ( GetDefRange()->Generic.id == S_DEFRANGE_REGISTER_V3 )
+            loc = LocIsEnregistered;
+        else
+            loc = LocIsRegRel;
+        return true;
+    }
+
+    bool C13LocalSymbol::GetDataKind( DataKind& dataKind )
+    {
+        dataKind = (GetSym()->local.flags & CV_LVAR_ISPARAM_V3) != 0 ? DataIsParam : DataIsLocal;
+        return true;
+    }
+
+    bool C13LocalSymbol::GetRegister( uint32_t& reg )
+    {
+        if ( GetDefRange() == NULL )
+            return false;
+
+        switch ( GetDefRange()->Generic.id )
+        {
+        case S_DEFRANGE_REGISTER_V3:
+            reg = GetDefRange()->defRangeReg.reg;
+            return true;
+
+        case S_DEFRANGE_FRAMEPOINTER_REL_V3:
+        case S_DEFRANGE_FRAMEPOINTER_REL_FULL_SCOPE_V3:
+            reg = mData.C13Local.FrameReg;
+            return true;
+
+        case S_DEFRANGE_REGISTER_REL_V3:
+            reg = GetDefRange()->defRangeRegRel.reg;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool C13LocalSymbol::GetOffset( int32_t& offset )
+    {
+        if ( GetDefRange() == NULL )
+            return false;
+
+        switch ( GetDefRange()->Generic.id )
+        {
+        case S_DEFRANGE_FRAMEPOINTER_REL_V3:
+            offset = GetDefRange()->defRangeFrameRel.offset;
+            return true;
+
+        case S_DEFRANGE_FRAMEPOINTER_REL_FULL_SCOPE_V3:
+            offset = GetDefRange()->defRangeFrameRelFullScope.offset;
+            return true;
+
+        case S_DEFRANGE_REGISTER_REL_V3:
+            offset = GetDefRange()->defRangeRegRel.offset;
+            return true;
+        }
+
+        return false;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13TLSSymbol
+    //------------------------------------------------------------------------
+
+    C13TLSSymbol::C13TLSSymbol( const BYTE* sym )
+        :   C13DataSymbol( sym )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    bool C13TLSSymbol::GetLocation( LocationType& loc )
+    {
+        loc = LocIsTLS;
+        return true;
+    }
+
+    bool C13TLSSymbol::GetDataKind( DataKind& dataKind )
+    {
+        // if it's in a function and is LDATA/LTHREAD, then it's DataIsStaticLocal
+        // but we'll leave that up to the user
+        if ( GetSym()->Generic.id == S_LTHREAD32_V3 )
+            dataKind = DataIsFileStatic;
+        else
+            dataKind = DataIsGlobal;
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13UdtSymbol
+    //------------------------------------------------------------------------
+
+    C13UdtSymbol::C13UdtSymbol( const BYTE* sym )
+        :   C13NonTypeSymbol( sym )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13UdtSymbol::GetSymTag()
+    {
+        return SymTagTypedef;
+    }
+
+    bool C13UdtSymbol::GetType( TypeIndex& index )
+    {
+        index = GetSym()->udt.type;
+        return true;
+    }
+
+    bool C13UdtSymbol::GetName( SymString& name )
+    {
+        return AssignName( name, GetSym()->udt.name, GetSym() );
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13EndOfArgsSymbol
+    //------------------------------------------------------------------------
+
+    C13EndOfArgsSymbol::C13EndOfArgsSymbol( const BYTE* sym )
+        :   C13NonTypeSymbol( sym )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13EndOfArgsSymbol::GetSymTag()
+    {
+        return SymTagEndOfArgs;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13TypeSymbol
+    //------------------------------------------------------------------------
+
+    C13TypeSymbol::C13TypeSymbol( const BYTE* type )
+        :   SymbolInfo()
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+
+        mData.C13Type.Type = type;
+        mData.C13Type.Mod = 0;
+    }
+
+    void C13TypeSymbol::SetMod( uint16_t mod )
+    {
+        mData.C13Type.Mod = mod;
+    }
+
+    bool C13TypeSymbol::GetMod( uint16_t& mod )
+    {
+        mod = mData.C13Type.Mod;
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13PointerTypeSymbol
+    //------------------------------------------------------------------------
+
+    C13PointerTypeSymbol::C13PointerTypeSymbol( const BYTE* type )
+        :   C13TypeSymbol( type )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13PointerTypeSymbol::GetSymTag()
+    {
+        return SymTagPointerType;
+    }
+
+    bool C13PointerTypeSymbol::GetType( TypeIndex& index )
+    {
+        index = GetTypeRec()->pointer.type;
+        return true;
+    }
+
+    bool C13PointerTypeSymbol::GetMod( uint16_t& mod )
+    {
+        uint16_t        attribute = (uint16_t) GetTypeRec()->pointer.attribute;
+        lfPointerAttr*  ptrAttr = (lfPointerAttr*) &attribute;
+        CV_modifier_t   extraMod = { 0 };
+
+        extraMod.MOD_const = ptrAttr->isconst;
+        extraMod.MOD_volatile = ptrAttr->isvolatile;
+        extraMod.MOD_unaligned = ptrAttr->isunaligned;
+
+        mod = mData.C13Type.Mod | *(uint16_t*) &extraMod;
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13ArrayTypeSymbol
+    //------------------------------------------------------------------------
+
+    C13ArrayTypeSymbol::C13ArrayTypeSymbol( const BYTE* type )
+        :   C13TypeSymbol( type )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13ArrayTypeSymbol::GetSymTag()
+    {
+        return SymTagArrayType;
+    }
+
+    bool C13ArrayTypeSymbol::GetType( TypeIndex& index )
+    {
+        index = GetTypeRec()->array.elemtype;
+        return true;
+    }
+
+    bool C13ArrayTypeSymbol::GetName( SymString& name )
+    {
+        uint16_t*   arrayLen = GetNumLeaf( &GetTypeRec()->array.arraylen );
+        uint32_t    offset = GetNumLeafSize( arrayLen );
+
+        return AssignName( name, (const char*) arrayLen + offset, GetTypeRec() );
+    }
+
+    bool C13ArrayTypeSymbol::GetLength( uint32_t& length )
+    {
+        length = GetUIntValue( GetNumLeaf( &GetTypeRec()->array.arraylen ) );
+        return true;
+    }
+
+    bool C13ArrayTypeSymbol::GetIndexType( TypeIndex& index )
+    {
+        index = GetTypeRec()->array.idxtype;
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13StructOrClassTypeSymbol
+    //------------------------------------------------------------------------
+
+    C13StructOrClassTypeSymbol::C13StructOrClassTypeSymbol( const BYTE* type )
+        :   C13TypeSymbol( type )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13StructOrClassTypeSymbol::GetSymTag()
+    {
+        return SymTagUDT;
+    }
+
+    bool C13StructOrClassTypeSymbol::GetName( SymString& name )
+    {
+        uint16_t*   structLen = GetNumLeaf( &GetTypeRec()->_struct.structlen );
+        uint32_t    offset = GetNumLeafSize( structLen );
+
+        return AssignName( name, (const char*) structLen + offset, GetTypeRec() );
+    }
+
+    bool C13StructOrClassTypeSymbol::GetLength( uint32_t& length )
+    {
+        length = GetUIntValue( GetNumLeaf( &GetTypeRec()->_struct.structlen ) );
+        return true;
+    }
+
+    bool C13StructOrClassTypeSymbol::GetUdtKind( UdtKind& udtKind )
+    {
+        if ( GetTypeRec()->Generic.id == LF_CLASS_V2 )
+            udtKind = UdtClass;
+        else
+            udtKind = UdtStruct;
+        return true;
+    }
+
+    bool C13StructOrClassTypeSymbol::GetFieldCount( uint16_t& count )
+    {
+        count = GetTypeRec()->_struct.count;
+        return true;
+    }
+
+    bool C13StructOrClassTypeSymbol::GetFieldList( TypeIndex& index )
+    {
+        index = GetTypeRec()->_struct.fieldlist;
+        return true;
+    }
+
+    bool C13StructOrClassTypeSymbol::GetProperties( uint16_t& props )
+    {
+        props = GetTypeRec()->_struct.property;
+        return true;
+    }
+
+    bool C13StructOrClassTypeSymbol::GetDerivedList( TypeIndex& index )
+    {
+        index = GetTypeRec()->_struct.derived;
+        return true;
+    }
+
+    bool C13StructOrClassTypeSymbol::GetVShape( TypeIndex& index )
+    {
+        index = GetTypeRec()->_struct.vshape;
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13UnionTypeSymbol
+    //------------------------------------------------------------------------
+
+    C13UnionTypeSymbol::C13UnionTypeSymbol( const BYTE* type )
+        :   C13TypeSymbol( type )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13UnionTypeSymbol::GetSymTag()
+    {
+        return SymTagUDT;
+    }
+
+    bool C13UnionTypeSymbol::GetName( SymString& name )
+    {
+        uint16_t*   unionLen = GetNumLeaf( &GetTypeRec()->_union.unionlen );
+        uint32_t    offset = GetNumLeafSize( unionLen );
+
+        return AssignName( name, (const char*) unionLen + offset, GetTypeRec() );
+    }
+
+    bool C13UnionTypeSymbol::GetLength( uint32_t& length )
+    {
+        length = GetUIntValue( GetNumLeaf( &GetTypeRec()->_union.unionlen ) );
+        return true;
+    }
+
+    bool C13UnionTypeSymbol::GetUdtKind( UdtKind& udtKind )
+    {
+        udtKind = UdtUnion;
+        return true;
+    }
+
+    bool C13UnionTypeSymbol::GetFieldCount( uint16_t& count )
+    {
+        count = GetTypeRec()->_union.count;
+        return true;
+    }
+
+    bool C13UnionTypeSymbol::GetFieldList( TypeIndex& index )
+    {
+        index = GetTypeRec()->_union.fieldlist;
+        return true;
+    }
+
+    bool C13UnionTypeSymbol::GetProperties( uint16_t& props )
+    {
+        props = GetTypeRec()->_union.property;
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13EnumTypeSymbol
+    //------------------------------------------------------------------------
+
+    C13EnumTypeSymbol::C13EnumTypeSymbol( const BYTE* type )
+        :   C13TypeSymbol( type )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13EnumTypeSymbol::GetSymTag()
+    {
+        return SymTagEnum;
+    }
+
+    bool C13EnumTypeSymbol::GetType( TypeIndex& index )
+    {
+        index = GetTypeRec()->_enum.type;
+        return true;
+    }
+
+    bool C13EnumTypeSymbol::GetName( SymString& name )
+    {
+        return AssignName( name, GetTypeRec()->_enum.name, GetTypeRec() );
+    }
+
+    bool C13EnumTypeSymbol::GetLength( uint32_t& length )
+    {
+        DWORD   basic = 0;
+        return BaseTypeSymbol::GetBasicLengthAndType( 
+            GetTypeRec()->_enum.type, basic, length );
+    }
+
+    bool C13EnumTypeSymbol::GetFieldCount( uint16_t& count )
+    {
+        count = GetTypeRec()->_enum.count;
+        return true;
+    }
+
+    bool C13EnumTypeSymbol::GetFieldList( TypeIndex& index )
+    {
+        index = GetTypeRec()->_enum.fieldlist;
+        return true;
+    }
+
+    bool C13EnumTypeSymbol::GetProperties( uint16_t& props )
+    {
+        props = GetTypeRec()->_enum.property;
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13ProcTypeSymbol
+    //------------------------------------------------------------------------
+
+    C13ProcTypeSymbol::C13ProcTypeSymbol( const BYTE* type )
+        :   C13TypeSymbol( type )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13ProcTypeSymbol::GetSymTag()
+    {
+        return SymTagFunctionType;
+    }
+
+    bool C13ProcTypeSymbol::GetType( TypeIndex& index )
+    {
+        index = GetTypeRec()->procedure.rvtype;
+        return true;
+    }
+
+    bool C13ProcTypeSymbol::GetCallConv( uint8_t& callConv )
+    {
+        callConv = GetTypeRec()->procedure.callconv;
+        return true;
+    }
+
+    bool C13ProcTypeSymbol::GetParamCount( uint16_t& count )
+    {
+        count = GetTypeRec()->procedure.paramcount;
+        return true;
+    }
+
+    bool C13ProcTypeSymbol::GetParamList( TypeIndex& index )
+    {
+        index = GetTypeRec()->procedure.arglist;
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13MProcTypeSymbol
+    //------------------------------------------------------------------------
+
+    C13MProcTypeSymbol::C13MProcTypeSymbol( const BYTE* type )
+        :   C13TypeSymbol( type )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13MProcTypeSymbol::GetSymTag()
+    {
+        return SymTagFunctionType;
+    }
+
+    bool C13MProcTypeSymbol::GetType( TypeIndex& index )
+    {
+        index = GetTypeRec()->mfunction.rvtype;
+        return true;
+    }
+
+    bool C13MProcTypeSymbol::GetCallConv( uint8_t& callConv )
+    {
+        callConv = GetTypeRec()->mfunction.callconv;
+        return true;
+    }
+
+    bool C13MProcTypeSymbol::GetParamCount( uint16_t& count )
+    {
+        count = GetTypeRec()->mfunction.paramcount;
+        return true;
+    }
+
+    bool C13MProcTypeSymbol::GetParamList( TypeIndex& index )
+    {
+        index = GetTypeRec()->mfunction.arglist;
+        return true;
+    }
+
+    bool C13MProcTypeSymbol::GetClass( TypeIndex& index )
+    {
+        index = GetTypeRec()->mfunction.class_type;
+        return true;
+    }
+
+    bool C13MProcTypeSymbol::GetThis( TypeIndex& index )
+    {
+        index = GetTypeRec()->mfunction.this_type;
+        return true;
+    }
+
+    bool C13MProcTypeSymbol::GetThisAdjust( int32_t& adjust )
+    {
+        adjust = GetTypeRec()->mfunction.this_adjust;
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13FieldListTypeSymbol
+    //------------------------------------------------------------------------
+
+    C13FieldListTypeSymbol::C13FieldListTypeSymbol( const BYTE* type )
+        :   C13TypeSymbol( type )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13FieldListTypeSymbol::GetSymTag()
+    {
+        return SymTagFieldList;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13TypeListTypeSymbol
+    //------------------------------------------------------------------------
+
+    C13TypeListTypeSymbol::C13TypeListTypeSymbol( const BYTE* type )
+        :   C13TypeSymbol( type )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+        _ASSERT( (GetTypeRec()->Generic.id == LF_ARGLIST_V2) || (GetTypeRec()->Generic.id == LF_DERIVED_V2) );
+    }
+
+    SymTag C13TypeListTypeSymbol::GetSymTag()
+    {
+        return SymTagTypeList;
+    }
+
+    bool C13TypeListTypeSymbol::GetCount( uint32_t& count )
+    {
+        // LF_ARGLIST_V2 and LF_DERIVED_V2 are laid out the same
+        count = GetTypeRec()->arglist.count;
+        return true;
+    }
+
+    bool C13TypeListTypeSymbol::GetTypes( std::vector<TypeIndex>& indexes )
+    {
+        const CodeViewTypeV2*  type = GetTypeRec();
+        uint32_t               maxCount = (type->Generic.len - 6) / sizeof( CV_typ32_t );
+
+        // the count can't be trusted to stay inside the record
+        if ( (type->Generic.len < 6) || (type->arglist.count > maxCount) )
+            return false;
+
+        indexes.resize( type->arglist.count );
+
+        for( uint32_t i = 0; i < type->arglist.count; i++ )
+            indexes[i] = type->arglist.args[i];
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13BaseClassTypeSymbol
+    //------------------------------------------------------------------------
+
+    C13BaseClassTypeSymbol::C13BaseClassTypeSymbol( const BYTE* type )
+        :   C13TypeSymbol( type )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13BaseClassTypeSymbol::GetSymTag()
+    {
+        return SymTagBaseClass;
+    }
+
+    bool C13BaseClassTypeSymbol::GetType( TypeIndex& index )
+    {
+        index = GetField()->bclass.type;
+        return true;
+    }
+
+    bool C13BaseClassTypeSymbol::GetOffset( int32_t& offset )
+    {
+        offset = GetUIntValue( GetNumLeaf( &GetField()->bclass.offset ) );
+        return true;
+    }
+
+    bool C13BaseClassTypeSymbol::GetAttribute( uint16_t& attr )
+    {
+        attr = GetField()->bclass.attr;
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13EnumMemberTypeSymbol
+    //------------------------------------------------------------------------
+
+    C13EnumMemberTypeSymbol::C13EnumMemberTypeSymbol( const BYTE* type )
+        :   C13TypeSymbol( type )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13EnumMemberTypeSymbol::GetSymTag()
+    {
+        return SymTagData;
+    }
+
+    bool C13EnumMemberTypeSymbol::GetName( SymString& name )
+    {
+        uint16_t*   value = GetNumLeaf( &GetField()->enumerate.value );
+        uint32_t    offset = GetNumLeafSize( value );
+
+        return AssignFieldName( name, (const char*) value + offset );
+    }
+
+    bool C13EnumMemberTypeSymbol::GetLocation( LocationType& loc )
+    {
+        loc = LocIsConstant;
+        return true;
+    }
+
+    bool C13EnumMemberTypeSymbol::GetDataKind( DataKind& dataKind )
+    {
+        dataKind = DataIsConstant;
+        return true;
+    }
+
+    bool C13EnumMemberTypeSymbol::GetAttribute( uint16_t& attr )
+    {
+        attr = GetField()->enumerate.attr;
+        return true;
+    }
+
+    bool C13EnumMemberTypeSymbol::GetValue( Variant& value )
+    {
+        GetNumLeafValue( GetNumLeaf( &GetField()->enumerate.value ), value );
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13DataMemberTypeSymbol
+    //------------------------------------------------------------------------
+
+    C13DataMemberTypeSymbol::C13DataMemberTypeSymbol( const BYTE* type )
+        :   C13TypeSymbol( type )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13DataMemberTypeSymbol::GetSymTag()
+    {
+        return SymTagData;
+    }
+
+    bool C13DataMemberTypeSymbol::GetType( TypeIndex& index )
+    {
+        index = GetField()->member.type;
+        return true;
+    }
+
+    bool C13DataMemberTypeSymbol::GetName( SymString& name )
+    {
+        uint16_t*   memberOffset = GetNumLeaf( &GetField()->member.offset );
+        uint32_t    offset = GetNumLeafSize( memberOffset );
+
+        return AssignFieldName( name, (const char*) memberOffset + offset );
+    }
+
+    bool C13DataMemberTypeSymbol::GetLocation( LocationType& loc )
+    {
+        loc = LocIsThisRel;
+        return true;
+    }
+
+    bool C13DataMemberTypeSymbol::GetDataKind( DataKind& dataKind )
+    {
+        dataKind = DataIsMember;
+        return true;
+    }
+
+    bool C13DataMemberTypeSymbol::GetOffset( int32_t& offset )
+    {
+        offset = GetUIntValue( GetNumLeaf( &GetField()->member.offset ) );
+        return true;
+    }
+
+    bool C13DataMemberTypeSymbol::GetAttribute( uint16_t& attr )
+    {
+        attr = GetField()->member.attr;
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13StaticMemberTypeSymbol
+    //------------------------------------------------------------------------
+
+    C13StaticMemberTypeSymbol::C13StaticMemberTypeSymbol( const BYTE* type )
+        :   C13TypeSymbol( type )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13StaticMemberTypeSymbol::GetSymTag()
+    {
+        return SymTagData;
+    }
+
+    bool C13StaticMemberTypeSymbol::GetType( TypeIndex& index )
+    {
+        index = GetField()->stmember.type;
+        return true;
+    }
+
+    bool C13StaticMemberTypeSymbol::GetName( SymString& name )
+    {
+        return AssignFieldName( name, GetField()->stmember.name );
+    }
+
+    bool C13StaticMemberTypeSymbol::GetLocation( LocationType& loc )
+    {
+        loc = LocIsStatic;
+        return true;
+    }
+
+    bool C13StaticMemberTypeSymbol::GetDataKind( DataKind& dataKind )
+    {
+        dataKind = DataIsStaticMember;
+        return true;
+    }
+
+    bool C13StaticMemberTypeSymbol::GetAttribute( uint16_t& attr )
+    {
+        attr = GetField()->stmember.attr;
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13MethodOverloadsTypeSymbol
+    //------------------------------------------------------------------------
+
+    C13MethodOverloadsTypeSymbol::C13MethodOverloadsTypeSymbol( const BYTE* type )
+        :   C13TypeSymbol( type )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13MethodOverloadsTypeSymbol::GetSymTag()
+    {
+        return SymTagMethodOverloads;
+    }
+
+    bool C13MethodOverloadsTypeSymbol::GetName( SymString& name )
+    {
+        return AssignFieldName( name, GetField()->method.name );
+    }
+
+    bool C13MethodOverloadsTypeSymbol::GetCount( uint32_t& count )
+    {
+        count = GetField()->method.count;
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13MethodTypeSymbol
+    //------------------------------------------------------------------------
+
+    C13MethodTypeSymbol::C13MethodTypeSymbol( const BYTE* type )
+        :   C13TypeSymbol( type )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13MethodTypeSymbol::GetSymTag()
+    {
+        return SymTagMethod;
+    }
+
+    bool C13MethodTypeSymbol::GetType( TypeIndex& index )
+    {
+        index = GetField()->onemethod.type;
+        return true;
+    }
+
+    bool C13MethodTypeSymbol::GetName( SymString& name )
+    {
+        const CodeViewFieldTypeV2* field = GetField();
+        CV_fldattr_t*              attr = (CV_fldattr_t*) &field->onemethod.attr;
+
+        if ( (attr->mprop == CV_MTintro) || (attr->mprop == CV_MTpureintro) )
+            return AssignFieldName( name, field->onemethod_virt.name );
+
+        return AssignFieldName( name, field->onemethod.name );
+    }
+
+    bool C13MethodTypeSymbol::GetAttribute( uint16_t& attr )
+    {
+        attr = GetField()->onemethod.attr;
+        return true;
+    }
+
+    bool C13MethodTypeSymbol::GetVBaseOffset( uint32_t& offset )
+    {
+        const CodeViewFieldTypeV2* field = GetField();
+        CV_fldattr_t*              attr = (CV_fldattr_t*) &field->onemethod.attr;
+
+        if ( (attr->mprop == CV_MTintro) || (attr->mprop == CV_MTpureintro) )
+        {
+            offset = field->onemethod_virt.vtaboff;
+            return true;
+        }
+
+        return false;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13MListMethodTypeSymbol
+    //------------------------------------------------------------------------
+
+    C13MListMethodTypeSymbol::C13MListMethodTypeSymbol( const BYTE* type )
+        :   C13TypeSymbol( type )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13MListMethodTypeSymbol::GetSymTag()
+    {
+        return SymTagMethod;
+    }
+
+    bool C13MListMethodTypeSymbol::GetType( TypeIndex& index )
+    {
+        const MListMethodV2*    method = (const MListMethodV2*) mData.C13Type.Type;
+        index = method->OneMethod.Type;
+        return true;
+    }
+
+    bool C13MListMethodTypeSymbol::GetAttribute( uint16_t& attr )
+    {
+        const MListMethodV2*    method = (const MListMethodV2*) mData.C13Type.Type;
+        attr = method->OneMethod.Attr;
+        return true;
+    }
+
+    bool C13MListMethodTypeSymbol::GetVBaseOffset( uint32_t& offset )
+    {
+        const MListMethodV2*    method = (const MListMethodV2*) mData.C13Type.Type;
+        CV_fldattr_t*           attr = (CV_fldattr_t*) &method->OneMethod.Attr;
+
+        if ( (attr->mprop == CV_MTintro) || (attr->mprop == CV_MTpureintro) )
+        {
+            offset = method->OneMethodVirt.VTabOffset;
+            return true;
+        }
+
+        return false;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13VFTablePtrTypeSymbol
+    //------------------------------------------------------------------------
+
+    C13VFTablePtrTypeSymbol::C13VFTablePtrTypeSymbol( const BYTE* type )
+        :   C13TypeSymbol( type )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13VFTablePtrTypeSymbol::GetSymTag()
+    {
+        return SymTagVTable;
+    }
+
+    bool C13VFTablePtrTypeSymbol::GetType( TypeIndex& index )
+    {
+        index = GetField()->vfunctab.type;
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13VFOffsetTypeSymbol
+    //------------------------------------------------------------------------
+
+    C13VFOffsetTypeSymbol::C13VFOffsetTypeSymbol( const BYTE* type )
+        :   C13TypeSymbol( type )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13VFOffsetTypeSymbol::GetSymTag()
+    {
+        return SymTagVTable;
+    }
+
+    bool C13VFOffsetTypeSymbol::GetType( TypeIndex& index )
+    {
+        index = GetField()->vfuncoff.type;
+        return true;
+    }
+
+    bool C13VFOffsetTypeSymbol::GetOffset( int32_t& offset )
+    {
+        offset = GetField()->vfuncoff.offset;
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13NestedTypeSymbol
+    //------------------------------------------------------------------------
+
+    C13NestedTypeSymbol::C13NestedTypeSymbol( const BYTE* type )
+        :   C13TypeSymbol( type )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13NestedTypeSymbol::GetSymTag()
+    {
+        return SymTagNestedType;
+    }
+
+    bool C13NestedTypeSymbol::GetType( TypeIndex& index )
+    {
+        index = GetField()->nesttype.type;
+        return true;
+    }
+
+    bool C13NestedTypeSymbol::GetName( SymString& name )
+    {
+        return AssignFieldName( name, GetField()->nesttype.name );
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13FriendClassTypeSymbol
+    //------------------------------------------------------------------------
+
+    C13FriendClassTypeSymbol::C13FriendClassTypeSymbol( const BYTE* type )
+        :   C13TypeSymbol( type )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13FriendClassTypeSymbol::GetSymTag()
+    {
+        return SymTagFriend;
+    }
+
+    bool C13FriendClassTypeSymbol::GetType( TypeIndex& index )
+    {
+        index = GetField()->friendcls.type;
+        return true;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  C13FriendFunctionTypeSymbol
+    //------------------------------------------------------------------------
+
+    C13FriendFunctionTypeSymbol::C13FriendFunctionTypeSymbol( const BYTE* type )
+        :   C13TypeSymbol( type )
+    {
+        C_ASSERT( sizeof( *this ) == sizeof( SymbolInfo ) );
+    }
+
+    SymTag C13FriendFunctionTypeSymbol::GetSymTag()
+    {
+        return SymTagFriend;
+    }
+
+    bool C13FriendFunctionTypeSymbol::GetType( TypeIndex& index )
+    {
+        index = GetField()->friendfcn.type;
+        return true;
+    }
+
+    bool C13FriendFunctionTypeSymbol::GetName( SymString& name )
+    {
+        return AssignFieldName( name, GetField()->friendfcn.name );
+    }
+}
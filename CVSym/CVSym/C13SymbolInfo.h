@@ -0,0 +1,557 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+#include "SymbolInfoBase.h"
+
+
+namespace MagoST
+{
+    // Symbol and type info for the CodeView 8 records of the C13 symbol
+    // store. They answer the same way as the classes for the older records
+    // in SymbolInfo.h and TypeInfo.h do.
+
+    class C13NonTypeSymbol : public SymbolInfo
+    {
+    public:
+        C13NonTypeSymbol( const BYTE* sym );
+
+    protected:
+        const CodeViewSymbolV3* GetSym()
+        {
+            return (const CodeViewSymbolV3*) mData.C13Symbol.Sym;
+        }
+    };
+
+
+    class C13RegSymbol : public C13NonTypeSymbol
+    {
+    public:
+        C13RegSymbol( const BYTE* sym );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetType( TypeIndex& index );
+        virtual bool GetName( SymString& name );
+
+        virtual bool GetLocation( LocationType& locType );
+        virtual bool GetDataKind( DataKind& dataKind );
+        virtual bool GetRegister( uint32_t& reg );
+    };
+
+
+    class C13ConstSymbol : public C13NonTypeSymbol
+    {
+    public:
+        C13ConstSymbol( const BYTE* sym );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetType( TypeIndex& index );
+        virtual bool GetName( SymString& name );
+
+        virtual bool GetLocation( LocationType& locType );
+        virtual bool GetDataKind( DataKind& dataKind );
+        virtual bool GetValue( Variant& value );
+    };
+
+
+    class C13BPRelSymbol : public C13NonTypeSymbol
+    {
+    public:
+        C13BPRelSymbol( const BYTE* sym, uint32_t frameReg );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetType( TypeIndex& index );
+        virtual bool GetName( SymString& name );
+
+        virtual bool GetLocation( LocationType& locType );
+        virtual bool GetDataKind( DataKind& dataKind );
+        virtual bool GetRegister( uint32_t& reg );
+        virtual bool GetOffset( int32_t& offset );
+    };
+
+
+    class C13DataSymbol : public C13NonTypeSymbol
+    {
+    public:
+        C13DataSymbol( const BYTE* sym );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetType( TypeIndex& index );
+        virtual bool GetName( SymString& name );
+
+        virtual bool GetLocation( LocationType& locType );
+        virtual bool GetDataKind( DataKind& dataKind );
+        virtual bool GetAddressOffset( uint32_t& offset );
+        virtual bool GetAddressSegment( uint16_t& segment );
+    };
+
+
+    class C13PublicSymbol : public C13NonTypeSymbol
+    {
+    public:
+        C13PublicSymbol( const BYTE* sym );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetName( SymString& name );
+
+        virtual bool GetLocation( LocationType& locType );
+        virtual bool GetDataKind( DataKind& dataKind );
+        virtual bool GetAddressOffset( uint32_t& offset );
+        virtual bool GetAddressSegment( uint16_t& segment );
+    };
+
+
+    class C13ProcSymbol : public C13NonTypeSymbol
+    {
+    public:
+        // funcType is the type of a procedure whose record has a function ID
+        C13ProcSymbol( const BYTE* sym, TypeIndex funcType );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetType( TypeIndex& index );
+        virtual bool GetName( SymString& name );
+
+        virtual bool GetLocation( LocationType& locType );
+        virtual bool GetAddressOffset( uint32_t& offset );
+        virtual bool GetAddressSegment( uint16_t& segment );
+        virtual bool GetLength( uint32_t& length );
+
+        virtual bool GetDebugStart( uint32_t& start );
+        virtual bool GetDebugEnd( uint32_t& end );
+        virtual bool GetProcFlags( uint8_t& flags );
+    };
+
+
+    class C13ThunkSymbol : public C13NonTypeSymbol
+    {
+    public:
+        C13ThunkSymbol( const BYTE* sym );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetName( SymString& name );
+
+        virtual bool GetLocation( LocationType& locType );
+        virtual bool GetAddressOffset( uint32_t& offset );
+        virtual bool GetAddressSegment( uint16_t& segment );
+        virtual bool GetLength( uint32_t& length );
+
+        virtual bool GetThunkOrdinal( uint8_t& ordinal );
+    };
+
+
+    class C13BlockSymbol : public C13NonTypeSymbol
+    {
+    public:
+        C13BlockSymbol( const BYTE* sym );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetName( SymString& name );
+
+        virtual bool GetLocation( LocationType& locType );
+        virtual bool GetAddressOffset( uint32_t& offset );
+        virtual bool GetAddressSegment( uint16_t& segment );
+        virtual bool GetLength( uint32_t& length );
+    };
+
+
+    class C13LabelSymbol : public C13NonTypeSymbol
+    {
+    public:
+        C13LabelSymbol( const BYTE* sym );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetName( SymString& name );
+
+        virtual bool GetLocation( LocationType& locType );
+        virtual bool GetAddressOffset( uint32_t& offset );
+        virtual bool GetAddressSegment( uint16_t& segment );
+
+        virtual bool GetProcFlags( uint8_t& flags );
+    };
+
+
+    class C13RegRelSymbol : public C13NonTypeSymbol
+    {
+    public:
+        C13RegRelSymbol( const BYTE* sym );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetType( TypeIndex& index );
+        virtual bool GetName( SymString& name );
+
+        virtual bool GetLocation( LocationType& locType );
+        virtual bool GetDataKind( DataKind& dataKind );
+        virtual bool GetRegister( uint32_t& reg );
+        virtual bool GetOffset( int32_t& offset );
+    };
+
+
+    // An S_LOCAL_V3 is located by the S_DEFRANGE records after it, each for
+    // a range of code. The store picks the first one that holds the whole
+    // local, and the local is said to be there in all of its scope. A local
+    // that's optimized out, or that's only kept in pieces, has no location.
+
+    class C13LocalSymbol : public C13NonTypeSymbol
+    {
+    public:
+        C13LocalSymbol( const BYTE* sym, const BYTE* defRange, uint32_t frameReg );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetType( TypeIndex& index );
+        virtual bool GetName( SymString& name );
+
+        virtual bool GetLocation( LocationType& locType );
+        virtual bool GetDataKind( DataKind& dataKind );
+        virtual bool GetRegister( uint32_t& reg );
+        virtual bool GetOffset( int32_t& offset );
+
+    private:
+        const CodeViewSymbolV3* GetDefRange()
+        {
+            return (const CodeViewSymbolV3*) mData.C13Local.DefRange;
+        }
+    };
+
+
+    // S_LTHREAD32_V3 and S_GTHREAD32_V3 records look the same as the data ones
+
+    class C13TLSSymbol : public C13DataSymbol
+    {
+    public:
+        C13TLSSymbol( const BYTE* sym );
+
+        virtual bool GetLocation( LocationType& locType );
+        virtual bool GetDataKind( DataKind& dataKind );
+    };
+
+
+    class C13UdtSymbol : public C13NonTypeSymbol
+    {
+    public:
+        C13UdtSymbol( const BYTE* sym );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetType( TypeIndex& index );
+        virtual bool GetName( SymString& name );
+    };
+
+
+    class C13EndOfArgsSymbol : public C13NonTypeSymbol
+    {
+    public:
+        C13EndOfArgsSymbol( const BYTE* sym );
+
+        virtual SymTag GetSymTag();
+    };
+
+
+    //------------------------------------------------------------------------
+    //  Types
+    //------------------------------------------------------------------------
+
+    class C13TypeSymbol : public SymbolInfo
+    {
+    public:
+        C13TypeSymbol( const BYTE* type );
+
+        void SetMod( uint16_t mod );
+
+        virtual bool GetMod( uint16_t& mod );
+
+    protected:
+        const CodeViewTypeV2* GetTypeRec()
+        {
+            return (const CodeViewTypeV2*) mData.C13Type.Type;
+        }
+
+        const CodeViewFieldTypeV2* GetField()
+        {
+            return (const CodeViewFieldTypeV2*) mData.C13Type.Type;
+        }
+    };
+
+
+    class C13PointerTypeSymbol : public C13TypeSymbol
+    {
+    public:
+        C13PointerTypeSymbol( const BYTE* type );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetType( TypeIndex& index );
+
+        virtual bool GetMod( uint16_t& mod );
+    };
+
+
+    class C13ArrayTypeSymbol : public C13TypeSymbol
+    {
+    public:
+        C13ArrayTypeSymbol( const BYTE* type );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetType( TypeIndex& index );
+        virtual bool GetName( SymString& name );
+
+        virtual bool GetLength( uint32_t& length );
+        virtual bool GetIndexType( TypeIndex& index );
+    };
+
+
+    class C13StructOrClassTypeSymbol : public C13TypeSymbol
+    {
+    public:
+        C13StructOrClassTypeSymbol( const BYTE* type );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetName( SymString& name );
+
+        virtual bool GetLength( uint32_t& length );
+        virtual bool GetUdtKind( UdtKind& udtKind );
+        virtual bool GetFieldCount( uint16_t& count );
+        virtual bool GetFieldList( TypeIndex& index );
+        virtual bool GetProperties( uint16_t& props );
+        virtual bool GetDerivedList( TypeIndex& index );
+        virtual bool GetVShape( TypeIndex& index );
+    };
+
+
+    class C13UnionTypeSymbol : public C13TypeSymbol
+    {
+    public:
+        C13UnionTypeSymbol( const BYTE* type );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetName( SymString& name );
+
+        virtual bool GetLength( uint32_t& length );
+        virtual bool GetUdtKind( UdtKind& udtKind );
+        virtual bool GetFieldCount( uint16_t& count );
+        virtual bool GetFieldList( TypeIndex& index );
+        virtual bool GetProperties( uint16_t& props );
+    };
+
+
+    class C13EnumTypeSymbol : public C13TypeSymbol
+    {
+    public:
+        C13EnumTypeSymbol( const BYTE* type );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetType( TypeIndex& index );
+        virtual bool GetName( SymString& name );
+
+        virtual bool GetLength( uint32_t& length );
+        virtual bool GetFieldCount( uint16_t& count );
+        virtual bool GetFieldList( TypeIndex& index );
+        virtual bool GetProperties( uint16_t& props );
+    };
+
+
+    class C13ProcTypeSymbol : public C13TypeSymbol
+    {
+    public:
+        C13ProcTypeSymbol( const BYTE* type );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetType( TypeIndex& index );
+
+        virtual bool GetCallConv( uint8_t& callConv );
+        virtual bool GetParamCount( uint16_t& count );
+        virtual bool GetParamList( TypeIndex& index );
+    };
+
+
+    class C13MProcTypeSymbol : public C13TypeSymbol
+    {
+    public:
+        C13MProcTypeSymbol( const BYTE* type );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetType( TypeIndex& index );
+
+        virtual bool GetCallConv( uint8_t& callConv );
+        virtual bool GetParamCount( uint16_t& count );
+        virtual bool GetParamList( TypeIndex& index );
+
+        virtual bool GetClass( TypeIndex& index );
+        virtual bool GetThis( TypeIndex& index );
+        virtual bool GetThisAdjust( int32_t& adjust );
+    };
+
+
+    class C13FieldListTypeSymbol : public C13TypeSymbol
+    {
+    public:
+        C13FieldListTypeSymbol( const BYTE* type );
+
+        virtual SymTag GetSymTag();
+    };
+
+
+    class C13TypeListTypeSymbol : public C13TypeSymbol
+    {
+    public:
+        C13TypeListTypeSymbol( const BYTE* type );
+
+        virtual SymTag GetSymTag();
+
+        virtual bool GetCount( uint32_t& count );
+        virtual bool GetTypes( std::vector<TypeIndex>& indexes );
+    };
+
+
+    class C13BaseClassTypeSymbol : public C13TypeSymbol
+    {
+    public:
+        C13BaseClassTypeSymbol( const BYTE* type );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetType( TypeIndex& index );
+
+        virtual bool GetOffset( int32_t& offset );
+        virtual bool GetAttribute( uint16_t& attr );
+    };
+
+
+    class C13EnumMemberTypeSymbol : public C13TypeSymbol
+    {
+    public:
+        C13EnumMemberTypeSymbol( const BYTE* type );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetName( SymString& name );
+
+        virtual bool GetLocation( LocationType& loc );
+        virtual bool GetDataKind( DataKind& dataKind );
+        virtual bool GetAttribute( uint16_t& attr );
+        virtual bool GetValue( Variant& value );
+    };
+
+
+    class C13DataMemberTypeSymbol : public C13TypeSymbol
+    {
+    public:
+        C13DataMemberTypeSymbol( const BYTE* type );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetType( TypeIndex& index );
+        virtual bool GetName( SymString& name );
+
+        virtual bool GetLocation( LocationType& loc );
+        virtual bool GetDataKind( DataKind& dataKind );
+        virtual bool GetOffset( int32_t& offset );
+        virtual bool GetAttribute( uint16_t& attr );
+    };
+
+
+    class C13StaticMemberTypeSymbol : public C13TypeSymbol
+    {
+    public:
+        C13StaticMemberTypeSymbol( const BYTE* type );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetType( TypeIndex& index );
+        virtual bool GetName( SymString& name );
+
+        virtual bool GetLocation( LocationType& loc );
+        virtual bool GetDataKind( DataKind& dataKind );
+        virtual bool GetAttribute( uint16_t& attr );
+    };
+
+
+    class C13MethodOverloadsTypeSymbol : public C13TypeSymbol
+    {
+    public:
+        C13MethodOverloadsTypeSymbol( const BYTE* type );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetName( SymString& name );
+
+        virtual bool GetCount( uint32_t& count );
+    };
+
+
+    class C13MethodTypeSymbol : public C13TypeSymbol
+    {
+    public:
+        C13MethodTypeSymbol( const BYTE* type );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetType( TypeIndex& index );
+        virtual bool GetName( SymString& name );
+
+        virtual bool GetAttribute( uint16_t& attr );
+        virtual bool GetVBaseOffset( uint32_t& offset );
+    };
+
+
+    class C13MListMethodTypeSymbol : public C13TypeSymbol
+    {
+    public:
+        C13MListMethodTypeSymbol( const BYTE* type );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetType( TypeIndex& index );
+
+        virtual bool GetAttribute( uint16_t& attr );
+        virtual bool GetVBaseOffset( uint32_t& offset );
+    };
+
+
+    class C13VFTablePtrTypeSymbol : public C13TypeSymbol
+    {
+    public:
+        C13VFTablePtrTypeSymbol( const BYTE* type );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetType( TypeIndex& index );
+    };
+
+
+    class C13VFOffsetTypeSymbol : public C13TypeSymbol
+    {
+    public:
+        C13VFOffsetTypeSymbol( const BYTE* type );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetType( TypeIndex& index );
+        virtual bool GetOffset( int32_t& offset );
+    };
+
+
+    class C13NestedTypeSymbol : public C13TypeSymbol
+    {
+    public:
+        C13NestedTypeSymbol( const BYTE* type );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetType( TypeIndex& index );
+        virtual bool GetName( SymString& name );
+    };
+
+
+    class C13FriendClassTypeSymbol : public C13TypeSymbol
+    {
+    public:
+        C13FriendClassTypeSymbol( const BYTE* type );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetType( TypeIndex& index );
+    };
+
+
+    class C13FriendFunctionTypeSymbol : public C13TypeSymbol
+    {
+    public:
+        C13FriendFunctionTypeSymbol( const BYTE* type );
+
+        virtual SymTag GetSymTag();
+        virtual bool GetType( TypeIndex& index );
+        virtual bool GetName( SymString& name );
+    };
+}
@@ -0,0 +1,1407 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#include "Common.h"
+#include "C13SymbolStore.h"
+#include "C13SymbolInfo.h"
+#include "PDBReader.h"
+#include "TypeInfo.h"
+#include "cvconst.h"
+#include "cvinfo.h"
+#include "Util.h"
+
+
+namespace MagoST
+{
+    enum PDBTypeStreams
+    {
+        PDBStream_Tpi = 2,
+        PDBStream_Ipi = 4,
+    };
+
+    const uint32_t  GsiSignature = 0xFFFFFFFF;
+    const uint32_t  GsiVersion = 0xEFFE0000 + 19990810;
+    const uint32_t  GsiBucketCount = 4096;
+    // the bit map has a bit for each bucket, and one more
+    const uint32_t  GsiBitmapWordCount = (GsiBucketCount + 1 + 31) / 32;
+    // buckets say where they start as offsets into an array of 12-byte
+    // entries, which is how the linker keeps the hash records in memory
+    const uint32_t  GsiBucketEntrySize = 12;
+    const uint32_t  FirstNonPrimitiveType = 0x1000;
+
+    struct TypeStreamHeader
+    {
+        uint32_t    Version;
+        uint32_t    HeaderSize;
+        uint32_t    TypeIndexBegin;
+        uint32_t    TypeIndexEnd;
+        uint32_t    TypeRecordBytes;
+        // followed by where the hashes are, which we don't need
+    };
+
+    struct GsiHashHeader
+    {
+        uint32_t    Signature;
+        uint32_t    Version;
+        uint32_t    HashRecordsSize;
+        uint32_t    BucketsSize;
+    };
+
+    struct PublicsHeader
+    {
+        uint32_t    SymHashSize;
+        uint32_t    AddrMapSize;
+        uint32_t    ThunkCount;
+        uint32_t    ThunkSize;
+        uint16_t    ThunkTableSection;
+        uint16_t    Padding;
+        uint32_t    ThunkTableOffset;
+        uint32_t    SectionCount;
+    };
+
+
+    // a numeric leaf can be longer than its tag, so it's checked on its own
+    static bool IsNumLeafInRecord( const unsigned short* leaf, const void* record )
+    {
+        const BYTE* limit = (const BYTE*) record + *(const uint16_t*) record + 2;
+        const BYTE* leafPtr = (const BYTE*) leaf;
+
+        if ( (limit - leafPtr) < 2 )
+            return false;
+
+        // a variable length string needs its length field
+        if ( (*leaf == LF_VARSTRING) && ((limit - leafPtr) < 4) )
+            return false;
+
+        return GetNumLeafSize( (uint16_t*) leaf ) <= (uint32_t) (limit - leafPtr);
+    }
+
+
+    C13SymbolStore::C13SymbolStore()
+        :   mSymRecords( NULL ),
+            mSymRecordsSize( 0 ),
+            mFrameReg( CV_REG_EBP )
+    {
+        C_ASSERT( sizeof( SymbolScopeIn ) <= sizeof( SymbolScope ) );
+        C_ASSERT( sizeof( TypeScopeIn ) <= sizeof( TypeScope ) );
+        C_ASSERT( sizeof( EnumNamedSymbolsDataIn ) <= sizeof( EnumNamedSymbolsData ) );
+        C_ASSERT( sizeof( TypeHandleIn ) <= sizeof( TypeHandle ) );
+        C_ASSERT( sizeof( SymHandleIn ) <= sizeof( SymHandle ) );
+
+        mTypes.Records = NULL;
+        mTypes.Begin = 0;
+        mTypes.End = 0;
+        mIds.Records = NULL;
+        mIds.Begin = 0;
+        mIds.End = 0;
+        mGlobalHash.Records = NULL;
+        mPublicHash.Records = NULL;
+    }
+
+    HRESULT C13SymbolStore::Init( PDBReader& reader )
+    {
+        HRESULT         hr = S_OK;
+        const BYTE*     data = NULL;
+        uint32_t        size = 0;
+
+        hr = ReadTypeStream( reader, PDBStream_Tpi, mTypes );
+        if ( FAILED( hr ) )
+            return hr;
+
+        // Older PDBs don't have the ID stream. Their procedures don't refer
+        // to it, and the ones that do will end up without a type.
+        hr = ReadTypeStream( reader, PDBStream_Ipi, mIds );
+        if ( FAILED( hr ) )
+        {
+            mIds.Records = NULL;
+            mIds.Begin = 0;
+            mIds.End = 0;
+            mIds.Offsets.clear();
+        }
+
+        if ( reader.GetMachine() == IMAGE_FILE_MACHINE_AMD64 )
+            mFrameReg = CV_AMD64_RBP;
+        else
+            mFrameReg = CV_REG_EBP;
+
+        uint32_t    modCount = reader.GetModuleCount();
+        std::vector< std::vector<uint32_t> >    moduleRecords( modCount );
+
+        mModules.resize( modCount );
+
+        for ( uint32_t i = 0; i < modCount; i++ )
+        {
+            mModules[i].Data = NULL;
+            mModules[i].Size = 0;
+
+            // a module whose symbols can't be read acts like one without symbols
+            if ( !reader.GetModuleSymbols( i, data, size ) || (size == 0) )
+                continue;
+
+            hr = ReadModule( data, size, (uint16_t) (i + 1), moduleRecords[i], mModules[i].Frames );
+            if ( FAILED( hr ) )
+            {
+                moduleRecords[i].clear();
+                mModules[i].Frames.clear();
+                continue;
+            }
+
+            mModules[i].Data = data;
+            mModules[i].Size = size;
+        }
+
+        // without the symbol record stream, there are no heaps
+        if ( reader.GetStream( reader.GetSymRecordStream(), data, size ) )
+        {
+            std::vector<uint32_t>   recordOffsets;
+
+            hr = ReadSymRecords( data, size, moduleRecords, recordOffsets );
+            if ( FAILED( hr ) )
+                return hr;
+
+            // without a hash table, symbols can still be found by going through the heaps
+            if ( reader.GetStream( reader.GetGlobalStream(), data, size ) )
+                ReadHashTable( data, size, recordOffsets, mGlobalHash );
+
+            if ( reader.GetStream( reader.GetPublicStream(), data, size )
+                && (size >= sizeof( PublicsHeader )) )
+            {
+                const PublicsHeader*    header = (const PublicsHeader*) data;
+
+                if ( header->SymHashSize <= size - sizeof( PublicsHeader ) )
+                    ReadHashTable( data + sizeof( PublicsHeader ), header->SymHashSize, recordOffsets, mPublicHash );
+            }
+        }
+
+        for ( int i = 0; i < SymHeap_Count; i++ )
+        {
+            std::sort( mAddrs[i].begin(), mAddrs[i].end(), AddrEntryLess );
+        }
+
+        return S_OK;
+    }
+
+    HRESULT C13SymbolStore::ReadTypeStream( PDBReader& reader, uint32_t streamIndex, TypeStream& types )
+    {
+        const BYTE*     data = NULL;
+        uint32_t        size = 0;
+
+        if ( !reader.GetStream( streamIndex, data, size ) )
+            return E_BAD_FORMAT;
+
+        if ( size < sizeof( TypeStreamHeader ) )
+            return E_BAD_FORMAT;
+
+        const TypeStreamHeader* header = (const TypeStreamHeader*) data;
+
+        if ( (header->HeaderSize < sizeof( TypeStreamHeader ))
+            || (header->HeaderSize > size)
+            || (header->TypeRecordBytes > size - header->HeaderSize)
+            || (header->TypeIndexBegin < FirstNonPrimitiveType)
+            || (header->TypeIndexEnd < header->TypeIndexBegin) )
+            return E_BAD_FORMAT;
+
+        uint32_t        typeCount = header->TypeIndexEnd - header->TypeIndexBegin;
+        const BYTE*     records = data + header->HeaderSize;
+        uint32_t        offset = 0;
+
+        // every record takes at least 4 bytes
+        if ( typeCount > header->TypeRecordBytes / 4 )
+            return E_BAD_FORMAT;
+
+        types.Offsets.resize( typeCount );
+
+        for ( uint32_t i = 0; i < typeCount; i++ )
+        {
+            if ( header->TypeRecordBytes - offset < 4 )
+                return E_BAD_FORMAT;
+
+            const CodeViewTypeV2*   type = (const CodeViewTypeV2*) (records + offset);
+            uint32_t                recSize = type->Generic.len + 2;
+
+            if ( (type->Generic.len < 2) || (recSize > header->TypeRecordBytes - offset) )
+                return E_BAD_FORMAT;
+
+            types.Offsets[i] = offset;
+            offset += recSize;
+        }
+
+        types.Records = records;
+        types.Begin = header->TypeIndexBegin;
+        types.End = header->TypeIndexEnd;
+
+        return S_OK;
+    }
+
+    HRESULT C13SymbolStore::ReadModule( 
+        const BYTE* data, 
+        uint32_t size, 
+        uint16_t modIndex, 
+        std::vector<uint32_t>& recordOffsets, 
+        std::vector<ProcFrame>& frames )
+    {
+        const BYTE*             p = data + sizeof( uint32_t );     // skip the signature
+        const BYTE*             limit = data + size;
+        // the ends of the scopes that the current record is in
+        std::vector<uint32_t>   scopeEnds;
+        std::vector<AddrEntry>  procs[SymHeap_Count];
+
+        while ( (limit - p) >= 4 )
+        {
+            const CodeViewSymbolV3* sym = (const CodeViewSymbolV3*) p;
+            uint32_t                offset = (uint32_t) (p - data);
+            uint32_t                recSize = sym->Generic.len + 2;
+            uint16_t                id = sym->Generic.id;
+
+            if ( (sym->Generic.len < 2) || (recSize > (uint32_t) (limit - p)) )
+                return E_BAD_FORMAT;
+
+            // Records that the store doesn't read, like S_FILESTATIC and the
+            // S_DEFRANGE records in the debugger's own terms, are stepped
+            // over. The scopes that they could be in are known, so they
+            // can't be taken for a function's own.
+            if ( (GetSymbolMinSize( id ) != 0) && !IsValidSymbol( p, recSize ) )
+                return E_BAD_FORMAT;
+
+            if ( IsScopeSymbol( id ) )
+            {
+                // pEnd is at the same offset in all of these
+                uint32_t    end = sym->block.end;
+
+                if ( (end <= offset) || (end > size - 4) )
+                    return E_BAD_FORMAT;
+
+                if ( scopeEnds.empty() && IsProcSymbol( id ) )
+                {
+                    AddrEntry   entry = { 0 };
+                    bool        isGlobal = (id == S_GPROC32_V3) || (id == S_GPROC32_ID);
+
+                    entry.Segment = sym->proc.segment;
+                    entry.Module = modIndex;
+                    entry.Offset = sym->proc.offset;
+                    entry.Sym = p;
+
+                    procs[isGlobal ? SymHeap_GlobalSymbols : SymHeap_StaticSymbols].push_back( entry );
+
+                    ProcFrame   frame = { 0 };
+
+                    frame.Offset = offset;
+                    frame.End = end;
+                    frame.LocalReg = mFrameReg;
+                    frame.ParamReg = mFrameReg;
+                    frames.push_back( frame );
+                }
+
+                scopeEnds.push_back( end );
+            }
+            else if ( (id == S_FRAMEPROC_V3) 
+                && (scopeEnds.size() == 1) 
+                && !frames.empty() 
+                && (frames.back().End == scopeEnds.back()) )
+            {
+                frames.back().LocalReg = DecodeFrameReg( (sym->frameProc.flags >> 14) & 3 );
+                frames.back().ParamReg = DecodeFrameReg( (sym->frameProc.flags >> 16) & 3 );
+            }
+            else if ( IsScopeEndSymbol( id ) )
+            {
+                // a scope has to end exactly where it says
+                if ( scopeEnds.empty() || (scopeEnds.back() != offset) )
+                    return E_BAD_FORMAT;
+
+                scopeEnds.pop_back();
+            }
+
+            recordOffsets.push_back( offset );
+            p += recSize;
+        }
+
+        if ( !scopeEnds.empty() )
+            return E_BAD_FORMAT;
+
+        for ( int i = 0; i < SymHeap_Count; i++ )
+        {
+            mAddrs[i].insert( mAddrs[i].end(), procs[i].begin(), procs[i].end() );
+        }
+
+        return S_OK;
+    }
+
+    HRESULT C13SymbolStore::ReadSymRecords(
+        const BYTE* data,
+        uint32_t size,
+        const std::vector< std::vector<uint32_t> >& moduleRecords,
+        std::vector<uint32_t>& recordOffsets )
+    {
+        const BYTE* p = data;
+        const BYTE* limit = data + size;
+
+        while ( (limit - p) >= 4 )
+        {
+            const CodeViewSymbolV3* sym = (const CodeViewSymbolV3*) p;
+            uint32_t                recSize = sym->Generic.len + 2;
+            uint16_t                id = sym->Generic.id;
+            SymbolHeapId            heapId = GetHeapOfRecord( id );
+
+            if ( (sym->Generic.len < 2) || (recSize > (uint32_t) (limit - p)) )
+                return E_BAD_FORMAT;
+
+            recordOffsets.push_back( (uint32_t) (p - data) );
+            p += recSize;
+
+            // records that aren't in a heap are never looked at
+            if ( heapId == SymHeap_Max )
+                continue;
+
+            if ( !IsValidSymbol( (const BYTE*) sym, recSize ) )
+                return E_BAD_FORMAT;
+
+            if ( (id == S_PROCREF_V3) || (id == S_LPROCREF_V3) || (id == S_DATAREF_V3) )
+            {
+                uint32_t    modIndex = sym->symref.imod;
+
+                if ( (modIndex < 1) || (modIndex > mModules.size()) )
+                    return E_BAD_FORMAT;
+
+                const std::vector<uint32_t>&    modRecords = moduleRecords[modIndex - 1];
+
+                // references into a module without symbols aren't followed
+                if ( (mModules[modIndex - 1].Size != 0)
+                    && !std::binary_search( modRecords.begin(), modRecords.end(), sym->symref.ibSym ) )
+                    return E_BAD_FORMAT;
+            }
+            else if ( id != S_UDT_V3 && id != S_CONSTANT_V3 )
+            {
+                AddrEntry   entry = { 0 };
+
+                // public symbols are laid out like data up to the name
+                entry.Segment = sym->data.segment;
+                entry.Offset = sym->data.offset;
+                entry.Sym = (const BYTE*) sym;
+
+                mAddrs[heapId].push_back( entry );
+            }
+        }
+
+        mSymRecords = data;
+        mSymRecordsSize = size;
+
+        return S_OK;
+    }
+
+    void C13SymbolStore::ReadHashTable( const BYTE* data, uint32_t size, const std::vector<uint32_t>& recordOffsets, HashTable& table )
+    {
+        if ( size < sizeof( GsiHashHeader ) )
+            return;
+
+        const GsiHashHeader*    header = (const GsiHashHeader*) data;
+        uint32_t                sizeLeft = size - sizeof( GsiHashHeader );
+
+        if ( (header->Signature != GsiSignature) || (header->Version != GsiVersion) )
+            return;
+
+        if ( (header->HashRecordsSize > sizeLeft)
+            || ((header->HashRecordsSize % sizeof( HashRecord )) != 0)
+            || (header->BucketsSize > sizeLeft - header->HashRecordsSize)
+            || (header->BucketsSize < GsiBitmapWordCount * sizeof( uint32_t )) )
+            return;
+
+        const HashRecord*   records = (const HashRecord*) (header + 1);
+        uint32_t            recordCount = header->HashRecordsSize / sizeof( HashRecord );
+        const uint32_t*     bitmap = (const uint32_t*) (data + sizeof( GsiHashHeader ) + header->HashRecordsSize);
+        const uint32_t*     bucketOffsets = bitmap + GsiBitmapWordCount;
+        uint32_t            bucketOffsetCount = (header->BucketsSize / sizeof( uint32_t )) - GsiBitmapWordCount;
+        uint32_t            presentIndex = 0;
+        std::vector<uint32_t>   bucketStarts( GsiBucketCount + 1 );
+
+        for ( uint32_t i = 0; i < recordCount; i++ )
+        {
+            // every record has to be the start of one in the symbol record stream
+            if ( (records[i].Offset == 0)
+                || !std::binary_search( recordOffsets.begin(), recordOffsets.end(), records[i].Offset - 1 ) )
+                return;
+        }
+
+        // an empty bucket starts where the next one does
+        for ( uint32_t i = 0; i < GsiBucketCount; i++ )
+        {
+            if ( (bitmap[i / 32] & (1 << (i % 32))) == 0 )
+            {
+                bucketStarts[i] = UINT_MAX;
+                continue;
+            }
+
+            if ( presentIndex >= bucketOffsetCount )
+                return;
+
+            uint32_t    start = bucketOffsets[presentIndex] / GsiBucketEntrySize;
+
+            if ( start > recordCount )
+                return;
+
+            bucketStarts[i] = start;
+            presentIndex++;
+        }
+
+        bucketStarts[GsiBucketCount] = recordCount;
+
+        for ( uint32_t i = GsiBucketCount; i > 0; i-- )
+        {
+            if ( bucketStarts[i - 1] == UINT_MAX )
+                bucketStarts[i - 1] = bucketStarts[i];
+            else if ( bucketStarts[i - 1] > bucketStarts[i] )
+                return;
+        }
+
+        table.Records = records;
+        table.BucketStarts.swap( bucketStarts );
+    }
+
+    HRESULT C13SymbolStore::SetCompilandSymbolScope( DWORD compilandIndex, SymbolScope& scope )
+    {
+        if ( (compilandIndex < 1) || (compilandIndex > mModules.size()) )
+            return E_INVALIDARG;
+
+        SymbolScopeIn*  scopeIn = (SymbolScopeIn*) &scope;
+        const Module&   mod = mModules[compilandIndex - 1];
+
+        if ( mod.Size == 0 )
+            return E_FAIL;
+
+        scopeIn->Base = mod.Data;
+        scopeIn->CurPtr = mod.Data + sizeof( uint32_t );  // skip the signature
+        scopeIn->Limit = mod.Data + mod.Size;
+        scopeIn->Module = compilandIndex;
+        scopeIn->HeapId = SymHeap_Max;
+
+        return S_OK;
+    }
+
+    HRESULT C13SymbolStore::SetSymbolScope( SymbolHeapId heapId, SymbolScope& scope )
+    {
+        if ( heapId >= SymHeap_Max )
+            return E_INVALIDARG;
+        if ( mSymRecords == NULL )
+            return E_FAIL;
+
+        SymbolScopeIn*  scopeIn = (SymbolScopeIn*) &scope;
+
+        // all the heaps are in the one stream, so each scope only stops at its own
+        scopeIn->Base = mSymRecords;
+        scopeIn->CurPtr = mSymRecords;
+        scopeIn->Limit = mSymRecords + mSymRecordsSize;
+        scopeIn->Module = 0;
+        scopeIn->HeapId = heapId;
+
+        return S_OK;
+    }
+
+    HRESULT C13SymbolStore::SetChildSymbolScope( SymHandle handle, SymbolScope& scope )
+    {
+        SymHandleIn*    internalHandle = (SymHandleIn*) &handle;
+        SymbolScopeIn*  scopeIn = (SymbolScopeIn*) &scope;
+
+        if ( internalHandle->Sym == NULL )
+            return E_INVALIDARG;
+
+        // only the modules have scopes
+        if ( (internalHandle->Module < 1) || ((size_t) internalHandle->Module > mModules.size()) )
+            return E_FAIL;
+
+        const CodeViewSymbolV3* sym = (const CodeViewSymbolV3*) internalHandle->Sym;
+        const Module&           mod = mModules[internalHandle->Module - 1];
+
+        if ( !IsScopeSymbol( sym->Generic.id ) )
+            return E_FAIL;
+
+        // the module was read at init, so the end is known to be a scope's end
+        scopeIn->Base = mod.Data;
+        scopeIn->CurPtr = internalHandle->Sym + sym->Generic.len + 2;
+            // pEnd is at the same offset in all of these
+        scopeIn->Limit = mod.Data + sym->block.end;
+        scopeIn->Module = internalHandle->Module;
+        scopeIn->HeapId = SymHeap_Max;
+
+        return S_OK;
+    }
+
+    bool C13SymbolStore::NextSymbol( SymbolScope& scope, SymHandle& handle )
+    {
+        SymbolScopeIn*  scopeIn = (SymbolScopeIn*) &scope;
+        SymHandleIn*    internalHandle = (SymHandleIn*) &handle;
+
+        // do we have at least a length and tag field?
+        while ( (scopeIn->Limit - scopeIn->CurPtr) >= 4 )
+        {
+            // every record was found to be in bounds at init
+            const CodeViewSymbolV3* sym = (const CodeViewSymbolV3*) scopeIn->CurPtr;
+
+            if ( scopeIn->HeapId != SymHeap_Max )
+            {
+                scopeIn->CurPtr += sym->Generic.len + 2;
+
+                if ( GetHeapOfRecord( sym->Generic.id ) != scopeIn->HeapId )
+                    continue;
+
+                if ( !FollowReference( (const BYTE*) sym, *internalHandle ) )
+                {
+                    internalHandle->Sym = (const BYTE*) sym;
+                    internalHandle->Module = 0;
+                }
+
+                return true;
+            }
+
+            internalHandle->Sym = (const BYTE*) sym;
+            internalHandle->Module = scopeIn->Module;
+
+            // move to the next one for next time
+
+            if ( IsScopeSymbol( sym->Generic.id ) )
+            {
+                // pEnd is at the same offset in all of these
+                scopeIn->CurPtr = scopeIn->Base + sym->block.end;
+
+                // we're pointing at the scope's end
+            }
+            else
+            {
+                scopeIn->CurPtr += sym->Generic.len + 2;
+            }
+
+            return true;
+        }
+
+        return false;
+    }
+
+    bool C13SymbolStore::FollowReference( const BYTE* symPtr, SymHandleIn& internalHandle )
+    {
+        const CodeViewSymbolV3* sym = (const CodeViewSymbolV3*) symPtr;
+
+        if ( (sym->Generic.id != S_PROCREF_V3)
+            && (sym->Generic.id != S_LPROCREF_V3)
+            && (sym->Generic.id != S_DATAREF_V3) )
+            return false;
+
+        // the module index and offset were checked at init
+        const Module&   mod = mModules[sym->symref.imod - 1];
+
+        if ( mod.Size == 0 )
+            return false;
+
+        internalHandle.Sym = mod.Data + sym->symref.ibSym;
+        internalHandle.Module = sym->symref.imod;
+        return true;
+    }
+
+    HRESULT C13SymbolStore::FindFirstSymbol( SymbolHeapId heapId, const char* nameChars, size_t nameLen, EnumNamedSymbolsData& data )
+    {
+        if ( heapId >= SymHeap_Max )
+            return E_INVALIDARG;
+
+        EnumNamedSymbolsDataIn* internalData = (EnumNamedSymbolsDataIn*) &data;
+        const HashTable&        table = (heapId == SymHeap_PublicSymbols) ? mPublicHash : mGlobalHash;
+
+        if ( table.Records == NULL )
+            return E_FAIL;
+
+        uint32_t    bucket = HashName( nameChars, nameLen ) % GsiBucketCount;
+
+        internalData->CurRecord = table.Records + table.BucketStarts[bucket];
+        internalData->LimitRecord = table.Records + table.BucketStarts[bucket + 1];
+        internalData->NameChars = nameChars;
+        internalData->NameLen = nameLen;
+        internalData->HeapId = heapId;
+        internalData->Sym = NULL;
+        internalData->SymModule = 0;
+
+        for ( ; internalData->CurRecord < internalData->LimitRecord; internalData->CurRecord++ )
+        {
+            if ( IsNamedSymbol( internalData->CurRecord, *internalData ) )
+                return S_OK;
+        }
+
+        return S_FALSE;
+    }
+
+    HRESULT C13SymbolStore::FindNextSymbol( EnumNamedSymbolsData& handle )
+    {
+        EnumNamedSymbolsDataIn* internalData = (EnumNamedSymbolsDataIn*) &handle;
+
+        if ( (internalData->CurRecord == NULL) || (internalData->LimitRecord == NULL) )
+            return E_INVALIDARG;
+
+        while ( internalData->CurRecord < internalData->LimitRecord )
+        {
+            internalData->CurRecord++;
+
+            if ( (internalData->CurRecord < internalData->LimitRecord)
+                && IsNamedSymbol( internalData->CurRecord, *internalData ) )
+                return S_OK;
+        }
+
+        return S_FALSE;
+    }
+
+    bool C13SymbolStore::IsNamedSymbol( const HashRecord* record, EnumNamedSymbolsDataIn& data )
+    {
+        // the offset was checked at init
+        const BYTE*             symPtr = mSymRecords + record->Offset - 1;
+        const CodeViewSymbolV3* sym = (const CodeViewSymbolV3*) symPtr;
+        SymHandleIn             internalHandle = { 0 };
+
+        // the global hash table has the static symbols too
+        if ( GetHeapOfRecord( sym->Generic.id ) != data.HeapId )
+            return false;
+
+        if ( !FollowReference( symPtr, internalHandle ) )
+        {
+            internalHandle.Sym = symPtr;
+            internalHandle.Module = 0;
+        }
+
+        SymInfoData     infoData = { 0 };
+        ISymbolInfo*    symInfo = NULL;
+        SymString       pstrName;
+
+        if ( GetSymbolInfo( *(SymHandle*) &internalHandle, infoData, symInfo ) != S_OK )
+            return false;
+        if ( !symInfo->GetName( pstrName ) )
+            return false;
+        if ( data.NameLen != pstrName.GetLength() )
+            return false;
+        if ( memcmp( data.NameChars, pstrName.GetName(), data.NameLen ) != 0 )
+            return false;
+
+        data.Sym = internalHandle.Sym;
+        data.SymModule = internalHandle.Module;
+        return true;
+    }
+
+    HRESULT C13SymbolStore::GetCurrentSymbol( const EnumNamedSymbolsData& searchData, SymHandle& handle )
+    {
+        const EnumNamedSymbolsDataIn*   internalSearchData = (const EnumNamedSymbolsDataIn*) &searchData;
+        SymHandleIn*                    internalHandle = (SymHandleIn*) &handle;
+
+        if ( internalSearchData->Sym == NULL )
+            return E_FAIL;
+
+        internalHandle->Sym = internalSearchData->Sym;
+        internalHandle->Module = internalSearchData->SymModule;
+
+        return S_OK;
+    }
+
+    HRESULT C13SymbolStore::FindSymbol( SymbolHeapId heapId, WORD segment, DWORD offset, SymHandle& handle )
+    {
+        if ( heapId >= SymHeap_Max )
+            return E_INVALIDARG;
+
+        SymHandleIn*                    internalHandle = (SymHandleIn*) &handle;
+        const std::vector<AddrEntry>&   addrs = mAddrs[heapId];
+        AddrEntry                       key = { 0 };
+
+        key.Segment = segment;
+        key.Offset = offset;
+
+        // the closest symbol at or before the address
+        std::vector<AddrEntry>::const_iterator  it =
+            std::upper_bound( addrs.begin(), addrs.end(), key, AddrEntryLess );
+
+        if ( it == addrs.begin() )
+            return E_FAIL;
+
+        it--;
+
+        if ( it->Segment != segment )
+            return E_FAIL;
+
+        const CodeViewSymbolV3* sym = (const CodeViewSymbolV3*) it->Sym;
+
+        // if it's a procedure, then validate the offset is inside it
+        if ( IsProcSymbol( sym->Generic.id ) && (offset - it->Offset >= sym->proc.length) )
+            return E_FAIL;
+
+        internalHandle->Sym = it->Sym;
+        internalHandle->Module = it->Module;
+
+        return S_OK;
+    }
+
+    TypeIndex C13SymbolStore::GetFunctionType( TypeIndex funcId )
+    {
+        const CodeViewTypeV2*   id = (const CodeViewTypeV2*) GetTypeRecord( mIds, funcId );
+
+        if ( (id == NULL) || (id->Generic.len + 2 < offsetof( CodeViewTypeV2, funcid.name )) )
+            return 0;
+
+        if ( id->Generic.id == LF_FUNC_ID )
+            return id->funcid.type;
+        if ( id->Generic.id == LF_MFUNC_ID )
+            return id->mfuncid.type;
+
+        return 0;
+    }
+
+    HRESULT C13SymbolStore::GetSymbolInfo( SymHandle handle, SymInfoData& privateData, ISymbolInfo*& symInfo )
+    {
+        SymHandleIn*    internalHandle = (SymHandleIn*) &handle;
+
+        if ( internalHandle->Sym == NULL )
+            return E_INVALIDARG;
+
+        // the records that handles can point at were all checked at init
+        const CodeViewSymbolV3* sym = (const CodeViewSymbolV3*) internalHandle->Sym;
+        const BYTE*             symPtr = internalHandle->Sym;
+
+        switch ( sym->Generic.id )
+        {
+        case S_REGISTER_V3: symInfo = new (&privateData) C13RegSymbol( symPtr ); break;
+        case S_CONSTANT_V3: symInfo = new (&privateData) C13ConstSymbol( symPtr ); break;
+        case S_BPREL32_V3:  symInfo = new (&privateData) C13BPRelSymbol( symPtr, mFrameReg ); break;
+        case S_LDATA32_V3:
+        case S_GDATA32_V3:  symInfo = new (&privateData) C13DataSymbol( symPtr ); break;
+        case S_PUB32_V3:    symInfo = new (&privateData) C13PublicSymbol( symPtr ); break;
+        case S_LPROC32_V3:
+        case S_GPROC32_V3:  symInfo = new (&privateData) C13ProcSymbol( symPtr, 0 ); break;
+        case S_LPROC32_ID:
+        case S_GPROC32_ID:
+            symInfo = new (&privateData) C13ProcSymbol( symPtr, GetFunctionType( sym->proc.type ) );
+            break;
+        case S_THUNK32_V3:  symInfo = new (&privateData) C13ThunkSymbol( symPtr ); break;
+        case S_BLOCK32_V3:  symInfo = new (&privateData) C13BlockSymbol( symPtr ); break;
+        case S_LABEL32_V3:  symInfo = new (&privateData) C13LabelSymbol( symPtr ); break;
+        case S_REGREL32_V3: symInfo = new (&privateData) C13RegRelSymbol( symPtr ); break;
+        case S_LOCAL_V3:
+            symInfo = new (&privateData) C13LocalSymbol( 
+                symPtr, 
+                FindDefRange( *internalHandle ), 
+                GetLocalFrameReg( *internalHandle ) );
+            break;
+        case S_LTHREAD32_V3:
+        case S_GTHREAD32_V3: symInfo = new (&privateData) C13TLSSymbol( symPtr ); break;
+        case S_UDT_V3:      symInfo = new (&privateData) C13UdtSymbol( symPtr ); break;
+        case S_ENDARG:      symInfo = new (&privateData) C13EndOfArgsSymbol( symPtr ); break;
+        default:
+            return E_FAIL;
+        }
+
+        return S_OK;
+    }
+
+    // The first of the S_DEFRANGE records after an S_LOCAL that says where
+    // the whole local is. The ones for parts of it, and the ones in the
+    // debugger's own terms, are stepped over.
+
+    const BYTE* C13SymbolStore::FindDefRange( const SymHandleIn& handle )
+    {
+        const BYTE* p = handle.Sym;
+        const BYTE* limit = NULL;
+
+        if ( handle.Module == 0 )
+            limit = mSymRecords + mSymRecordsSize;
+        else
+            limit = mModules[handle.Module - 1].Data + mModules[handle.Module - 1].Size;
+
+        // every record was found to be in bounds at init
+        p += ((const CodeViewSymbolV3*) p)->Generic.len + 2;
+
+        while ( (limit - p) >= 4 )
+        {
+            const CodeViewSymbolV3* sym = (const CodeViewSymbolV3*) p;
+
+            switch ( sym->Generic.id )
+            {
+            case S_DEFRANGE_REGISTER_V3:
+            case S_DEFRANGE_FRAMEPOINTER_REL_V3:
+            case S_DEFRANGE_FRAMEPOINTER_REL_FULL_SCOPE_V3:
+                return p;
+
+            case S_DEFRANGE_REGISTER_REL_V3:
+                // not a member spilled on its own, and not at an offset in the local
+                if ( (sym->defRangeRegRel.flags & 0xFFF1) == 0 )
+                    return p;
+                break;
+
+            case S_DEFRANGE_V3:
+            case S_DEFRANGE_SUBFIELD_V3:
+            case S_DEFRANGE_SUBFIELD_REGISTER_V3:
+                break;
+
+            default:
+                return NULL;
+            }
+
+            p += sym->Generic.len + 2;
+        }
+
+        return NULL;
+    }
+
+    // The frame pointer that the S_FRAMEPROC of the procedure around an
+    // S_LOCAL names, for parameters or for other locals.
+
+    uint32_t C13SymbolStore::GetLocalFrameReg( const SymHandleIn& handle )
+    {
+        if ( handle.Module == 0 )
+            return mFrameReg;
+
+        const CodeViewSymbolV3*         sym = (const CodeViewSymbolV3*) handle.Sym;
+        const std::vector<ProcFrame>&   frames = mModules[handle.Module - 1].Frames;
+        uint32_t                        offset = (uint32_t) (handle.Sym - mModules[handle.Module - 1].Data);
+
+        // the last procedure that starts before the local
+        std::vector<ProcFrame>::const_iterator  it =
+            std::upper_bound( frames.begin(), frames.end(), offset, ProcFrameLess );
+
+        if ( it == frames.begin() )
+            return mFrameReg;
+
+        it--;
+
+        if ( offset >= it->End )
+            return mFrameReg;
+
+        return (sym->local.flags & CV_LVAR_ISPARAM_V3) != 0 ? it->ParamReg : it->LocalReg;
+    }
+
+    // S_FRAMEPROC encodes a frame pointer in 2 bits: none, the stack pointer,
+    // the frame pointer, or the one that a frame realigned with the stack
+    // pointer is kept in
+
+    uint32_t C13SymbolStore::DecodeFrameReg( uint32_t encodedReg )
+    {
+        bool    isAmd64 = (mFrameReg == CV_AMD64_RBP);
+
+        switch ( encodedReg )
+        {
+        case 1: return isAmd64 ? (uint32_t) CV_AMD64_RSP : (uint32_t) CV_REG_ESP;
+        case 2: return isAmd64 ? (uint32_t) CV_AMD64_RBP : (uint32_t) CV_REG_EBP;
+        case 3: return isAmd64 ? (uint32_t) CV_AMD64_R13 : (uint32_t) CV_REG_EBX;
+        }
+
+        return mFrameReg;
+    }
+
+    const BYTE* C13SymbolStore::GetTypeRecord( const TypeStream& types, TypeIndex index )
+    {
+        if ( (index < types.Begin) || (index >= types.End) )
+            return NULL;
+
+        return types.Records + types.Offsets[index - types.Begin];
+    }
+
+    HRESULT C13SymbolStore::SetGlobalTypeScope( TypeScope& scope )
+    {
+        TypeScopeIn*    scopeIn = (TypeScopeIn*) &scope;
+
+        if ( mTypes.Begin == mTypes.End )
+            return E_FAIL;
+
+        scopeIn->CurPtr = NULL;
+        scopeIn->Limit = NULL;
+        scopeIn->CurIndex = mTypes.Begin;
+        scopeIn->Count = 0;
+        scopeIn->Kind = TypeScope_Global;
+
+        return S_OK;
+    }
+
+    bool C13SymbolStore::GetTypeFromTypeIndex( TypeIndex typeIndex, TypeHandle& handle )
+    {
+        TypeHandleIn*   internalHandle = (TypeHandleIn*) &handle;
+
+        if ( typeIndex == 0 )
+            return false;
+
+        if ( typeIndex < FirstNonPrimitiveType )
+        {
+            internalHandle->Type = NULL;
+            internalHandle->Index = typeIndex;
+            return true;
+        }
+
+        const BYTE*     type = GetTypeRecord( mTypes, typeIndex );
+
+        if ( type == NULL )
+            return false;
+
+        internalHandle->Type = type;
+        internalHandle->Index = typeIndex;
+
+        return true;
+    }
+
+    HRESULT C13SymbolStore::SetChildTypeScope( TypeHandle handle, TypeScope& scope )
+    {
+        TypeScopeIn*    scopeIn = (TypeScopeIn*) &scope;
+        TypeHandleIn*   internalHandle = (TypeHandleIn*) &handle;
+
+        if ( internalHandle->Type == NULL )
+            return E_INVALIDARG;
+
+        if ( internalHandle->Index == MListMethodIndex )
+            return E_FAIL;
+
+        if ( internalHandle->Index == FieldIndex )
+        {
+            const CodeViewFieldTypeV2*  field = (const CodeViewFieldTypeV2*) internalHandle->Type;
+
+            if ( field->Generic.id != LF_METHOD_V3 )
+                return E_FAIL;
+
+            const CodeViewTypeV2*   mlist = (const CodeViewTypeV2*) GetTypeRecord( mTypes, field->method.mlist );
+
+            if ( (mlist == NULL) || (mlist->Generic.id != LF_METHODLIST_V2) )
+                return E_FAIL;
+
+            scopeIn->CurPtr = (const BYTE*) mlist + 4;            // after len and id
+            scopeIn->Limit = (const BYTE*) mlist + mlist->Generic.len + 2;
+            scopeIn->CurIndex = 0;
+            scopeIn->Count = field->method.count;
+            scopeIn->Kind = TypeScope_MethodList;
+            return S_OK;
+        }
+
+        if ( !SetFieldListScope( internalHandle->Type, internalHandle->Index, *scopeIn ) )
+            return E_FAIL;
+
+        return S_OK;
+    }
+
+    bool C13SymbolStore::SetFieldListScope( const BYTE* fieldList, TypeIndex index, TypeScopeIn& scopeIn )
+    {
+        const CodeViewTypeV2*   type = (const CodeViewTypeV2*) fieldList;
+
+        if ( type->Generic.id != LF_FIELDLIST_V2 )
+            return false;
+
+        scopeIn.CurPtr = fieldList + 4;
+        scopeIn.Limit = fieldList + type->Generic.len + 2;
+        scopeIn.CurIndex = index;
+        scopeIn.Count = 0;
+        scopeIn.Kind = TypeScope_FieldList;
+        return true;
+    }
+
+    bool C13SymbolStore::NextType( TypeScope& scope, TypeHandle& handle )
+    {
+        TypeScopeIn*    scopeIn = (TypeScopeIn*) &scope;
+        TypeHandleIn*   internalHandle = (TypeHandleIn*) &handle;
+
+        switch ( scopeIn->Kind )
+        {
+        case TypeScope_Global:      return NextTypeGlobal( *scopeIn, *internalHandle );
+        case TypeScope_FieldList:   return NextField( *scopeIn, *internalHandle );
+        case TypeScope_MethodList:  return NextTypeMList( *scopeIn, *internalHandle );
+        }
+
+        return false;
+    }
+
+    bool C13SymbolStore::NextTypeGlobal( TypeScopeIn& scopeIn, TypeHandleIn& handleIn )
+    {
+        if ( scopeIn.CurIndex >= mTypes.End )
+            return false;
+
+        handleIn.Type = GetTypeRecord( mTypes, scopeIn.CurIndex );
+        handleIn.Index = scopeIn.CurIndex;
+
+        scopeIn.CurIndex++;
+
+        return true;
+    }
+
+    bool C13SymbolStore::NextField( TypeScopeIn& scopeIn, TypeHandleIn& handleIn )
+    {
+        if ( (scopeIn.Limit - scopeIn.CurPtr) < 2 )
+            return false;
+
+        const CodeViewFieldTypeV2*  field = (const CodeViewFieldTypeV2*) scopeIn.CurPtr;
+
+        if ( field->Generic.id == LF_INDEX_V2 )
+        {
+            TypeIndex   contIndex = 0;
+
+            if ( (scopeIn.Limit - scopeIn.CurPtr) < (int) sizeof( field->index ) )
+            {
+                scopeIn.Limit = scopeIn.CurPtr;
+                return false;
+            }
+
+            contIndex = field->index.type;
+
+            // a list can only go on to one before it, so it can't go around forever
+            if ( contIndex >= scopeIn.CurIndex )
+                return false;
+
+            const BYTE* contList = GetTypeRecord( mTypes, contIndex );
+
+            if ( (contList == NULL) || !SetFieldListScope( contList, contIndex, scopeIn ) )
+                return false;
+
+            if ( (scopeIn.Limit - scopeIn.CurPtr) < 2 )
+                return false;
+
+            field = (const CodeViewFieldTypeV2*) scopeIn.CurPtr;
+
+            if ( field->Generic.id == LF_INDEX_V2 )
+            {
+                // there's no reason to jump to an empty continuation record that jumps to another
+                // cut the list short, so we only say we can't succeed if user calls us again
+                scopeIn.Limit = scopeIn.CurPtr;
+                return false;
+            }
+        }
+
+        DWORD   len = 0;
+
+        if ( !GetFieldLengthV2( (CodeViewFieldTypeV2*) field, (DWORD) (scopeIn.Limit - scopeIn.CurPtr), len ) )
+        {
+            // the field runs off the end of the list, so end it here
+            scopeIn.Limit = scopeIn.CurPtr;
+            return false;
+        }
+
+        handleIn.Type = scopeIn.CurPtr;
+        handleIn.Index = FieldIndex;
+
+        // move to the next one for next time
+        scopeIn.CurPtr += len;
+
+        return true;
+    }
+
+    bool C13SymbolStore::NextTypeMList( TypeScopeIn& scopeIn, TypeHandleIn& handleIn )
+    {
+        if ( scopeIn.Count == 0 )
+            return false;
+
+        const MListMethodV2*    method = (const MListMethodV2*) scopeIn.CurPtr;
+        int                     size = sizeof( method->OneMethod );
+
+        if ( (scopeIn.Limit - scopeIn.CurPtr) < size )
+            return false;
+
+        CV_fldattr_t*   attr = (CV_fldattr_t*) &method->OneMethod.Attr;
+        if ( (attr->mprop == CV_MTintro) || (attr->mprop == CV_MTpureintro) )
+            size = sizeof( method->OneMethodVirt );   // the optional vtab offset
+
+        if ( (scopeIn.Limit - scopeIn.CurPtr) < size )
+            return false;
+
+        handleIn.Type = scopeIn.CurPtr;
+        handleIn.Index = MListMethodIndex;
+
+        scopeIn.CurPtr += size;
+        scopeIn.Count--;
+
+        return true;
+    }
+
+    HRESULT C13SymbolStore::GetTypeInfo( TypeHandle handle, SymInfoData& privateData, ISymbolInfo*& symInfo )
+    {
+        TypeHandleIn*   internalHandle = (TypeHandleIn*) &handle;
+        const BYTE*     typePtr = internalHandle->Type;
+        TypeIndex       index = internalHandle->Index;
+        uint16_t        mod = 0;
+
+        if ( (typePtr == NULL) && (index >= FirstNonPrimitiveType) )
+            return E_INVALIDARG;
+
+        // fields were checked when they were found in their lists
+        if ( index == FieldIndex )
+        {
+            switch ( ((const CodeViewFieldTypeV2*) typePtr)->Generic.id )
+            {
+            case LF_BCLASS_V2:      symInfo = new (&privateData) C13BaseClassTypeSymbol( typePtr ); break;
+            case LF_ENUMERATE_V3:   symInfo = new (&privateData) C13EnumMemberTypeSymbol( typePtr ); break;
+            case LF_FRIENDFCN_V3:   symInfo = new (&privateData) C13FriendFunctionTypeSymbol( typePtr ); break;
+            case LF_MEMBER_V3:      symInfo = new (&privateData) C13DataMemberTypeSymbol( typePtr ); break;
+            case LF_STMEMBER_V3:    symInfo = new (&privateData) C13StaticMemberTypeSymbol( typePtr ); break;
+            case LF_METHOD_V3:      symInfo = new (&privateData) C13MethodOverloadsTypeSymbol( typePtr ); break;
+            case LF_NESTTYPE_V3:    symInfo = new (&privateData) C13NestedTypeSymbol( typePtr ); break;
+            case LF_VFUNCTAB_V2:    symInfo = new (&privateData) C13VFTablePtrTypeSymbol( typePtr ); break;
+            case LF_FRIENDCLS_V2:   symInfo = new (&privateData) C13FriendClassTypeSymbol( typePtr ); break;
+            case LF_ONEMETHOD_V3:   symInfo = new (&privateData) C13MethodTypeSymbol( typePtr ); break;
+            case LF_VFUNCOFF_V2:    symInfo = new (&privateData) C13VFOffsetTypeSymbol( typePtr ); break;
+            default:
+                return E_FAIL;
+            }
+
+            return S_OK;
+        }
+
+        if ( index == MListMethodIndex )
+        {
+            symInfo = new (&privateData) C13MListMethodTypeSymbol( typePtr );
+            return S_OK;
+        }
+
+        while ( (typePtr != NULL) && (((const CodeViewTypeV2*) typePtr)->Generic.id == LF_MODIFIER_V2) )
+        {
+            const CodeViewTypeV2*   type = (const CodeViewTypeV2*) typePtr;
+            TypeIndex               newIndex = type->modifier.type;
+
+            if ( (uint32_t) type->Generic.len + 2 < GetTypeMinSize( LF_MODIFIER_V2 ) )
+                return E_FAIL;
+
+            // a record only refers to the ones before it, so this can't go around forever
+            if ( newIndex >= index )
+                return E_FAIL;
+
+            mod |= type->modifier.attr;
+
+            if ( newIndex >= FirstNonPrimitiveType )
+            {
+                typePtr = GetTypeRecord( mTypes, newIndex );
+
+                if ( typePtr == NULL )
+                    return E_FAIL;
+            }
+            else
+                typePtr = NULL;
+
+            index = newIndex;
+        }
+
+        if ( typePtr == NULL )
+        {
+            // the basic types are the same as in CodeView 4
+            MagoST::TypeHandleIn    baseHandle = { NULL, (WORD) index, 0 };
+            uint32_t                mode = CV_MODE( index );
+            TypeSymbol*             typeSym = NULL;
+
+            if ( mode == 0 )
+                typeSym = new (&privateData) BaseTypeSymbol( baseHandle );
+            else
+                typeSym = new (&privateData) BasePointerTypeSymbol( baseHandle );
+
+            typeSym->SetMod( mod );
+            symInfo = typeSym;
+            return S_OK;
+        }
+
+        const CodeViewTypeV2*   type = (const CodeViewTypeV2*) typePtr;
+        uint32_t                minSize = GetTypeMinSize( type->Generic.id );
+
+        if ( (minSize == 0) || ((uint32_t) type->Generic.len + 2 < minSize) )
+            return E_FAIL;
+
+        switch ( type->Generic.id )
+        {
+        case LF_POINTER_V2:     symInfo = new (&privateData) C13PointerTypeSymbol( typePtr ); break;
+        case LF_ARRAY_V2:
+            if ( !IsNumLeafInRecord( &type->array.arraylen, type ) )
+                return E_FAIL;
+            symInfo = new (&privateData) C13ArrayTypeSymbol( typePtr );
+            break;
+        case LF_CLASS_V2:
+        case LF_STRUCTURE_V2:
+            if ( !IsNumLeafInRecord( &type->_struct.structlen, type ) )
+                return E_FAIL;
+            symInfo = new (&privateData) C13StructOrClassTypeSymbol( typePtr );
+            break;
+        case LF_UNION_V2:
+            if ( !IsNumLeafInRecord( &type->_union.unionlen, type ) )
+                return E_FAIL;
+            symInfo = new (&privateData) C13UnionTypeSymbol( typePtr );
+            break;
+        case LF_ENUM_V2:        symInfo = new (&privateData) C13EnumTypeSymbol( typePtr ); break;
+        case LF_PROCEDURE_V2:   symInfo = new (&privateData) C13ProcTypeSymbol( typePtr ); break;
+        case LF_MFUNCTION_V2:   symInfo = new (&privateData) C13MProcTypeSymbol( typePtr ); break;
+        case LF_FIELDLIST_V2:   symInfo = new (&privateData) C13FieldListTypeSymbol( typePtr ); break;
+        case LF_ARGLIST_V2:
+        case LF_DERIVED_V2:     symInfo = new (&privateData) C13TypeListTypeSymbol( typePtr ); break;
+        default:
+            return E_FAIL;
+        }
+
+        C13TypeSymbol*  typeSym = (C13TypeSymbol*) symInfo;
+
+        typeSym->SetMod( mod );
+
+        return S_OK;
+    }
+
+    bool C13SymbolStore::IsValidSymbol( const BYTE* symPtr, uint32_t size )
+    {
+        const CodeViewSymbolV3* sym = (const CodeViewSymbolV3*) symPtr;
+
+        if ( size < GetSymbolMinSize( sym->Generic.id ) )
+            return false;
+
+        if ( (sym->Generic.id == S_CONSTANT_V3) && !IsNumLeafInRecord( &sym->constant.value, sym ) )
+            return false;
+
+        return true;
+    }
+
+    // The size of the parts of a record that are read without looking at
+    // the record's length; names are checked when they're read. Zero if the
+    // record isn't one that the store reads.
+
+    uint32_t C13SymbolStore::GetSymbolMinSize( uint16_t id )
+    {
+        const CodeViewSymbolV3* sym = NULL;
+
+        switch ( id )
+        {
+        case S_REGISTER_V3:     return offsetof( CodeViewSymbolV3, reg.name );
+        case S_CONSTANT_V3:     return offsetof( CodeViewSymbolV3, constant.value ) + 2;
+        case S_UDT_V3:          return offsetof( CodeViewSymbolV3, udt.name );
+        case S_BPREL32_V3:      return offsetof( CodeViewSymbolV3, bprel.name );
+        case S_LDATA32_V3:
+        case S_GDATA32_V3:
+        case S_LTHREAD32_V3:
+        case S_GTHREAD32_V3:    return offsetof( CodeViewSymbolV3, data.name );
+        case S_PUB32_V3:        return offsetof( CodeViewSymbolV3, pub.name );
+        case S_LPROC32_V3:
+        case S_GPROC32_V3:
+        case S_LPROC32_ID:
+        case S_GPROC32_ID:      return offsetof( CodeViewSymbolV3, proc.name );
+        case S_THUNK32_V3:      return offsetof( CodeViewSymbolV3, thunk.name );
+        case S_BLOCK32_V3:      return offsetof( CodeViewSymbolV3, block.name );
+        case S_LABEL32_V3:      return offsetof( CodeViewSymbolV3, label.name );
+        case S_REGREL32_V3:     return offsetof( CodeViewSymbolV3, regrel.name );
+        case S_PROCREF_V3:
+        case S_LPROCREF_V3:
+        case S_DATAREF_V3:      return offsetof( CodeViewSymbolV3, symref.name );
+        case S_INLINESITE_V3:
+        case S_INLINESITE2_V3:  return offsetof( CodeViewSymbolV3, inlineSite.inlinee ) + sizeof( CV_typ32_t );
+        case S_SEPCODE_V3:      return sizeof( sym->sepcode );
+        case S_FRAMEPROC_V3:    return sizeof( sym->frameProc );
+        case S_LOCAL_V3:        return offsetof( CodeViewSymbolV3, local.name );
+        case S_DEFRANGE_REGISTER_V3:
+            return sizeof( sym->defRangeReg );
+        case S_DEFRANGE_FRAMEPOINTER_REL_V3:
+            return sizeof( sym->defRangeFrameRel );
+        case S_DEFRANGE_FRAMEPOINTER_REL_FULL_SCOPE_V3:
+            return sizeof( sym->defRangeFrameRelFullScope );
+        case S_DEFRANGE_REGISTER_REL_V3:
+            return sizeof( sym->defRangeRegRel );
+        case S_END:
+        case S_PROC_ID_END:
+        case S_INLINESITE_END_V3:
+        case S_ENDARG:          return 4;
+        }
+
+        return 0;
+    }
+
+    // Inline sites and separated code aren't read, but they're scopes, so
+    // that their locals stay out of the function's.
+
+    bool C13SymbolStore::IsScopeSymbol( uint16_t id )
+    {
+        return IsProcSymbol( id )
+            || (id == S_THUNK32_V3)
+            || (id == S_BLOCK32_V3)
+            || (id == S_INLINESITE_V3)
+            || (id == S_INLINESITE2_V3)
+            || (id == S_SEPCODE_V3);
+    }
+
+    bool C13SymbolStore::IsScopeEndSymbol( uint16_t id )
+    {
+        return (id == S_END) || (id == S_PROC_ID_END) || (id == S_INLINESITE_END_V3);
+    }
+
+    bool C13SymbolStore::IsProcSymbol( uint16_t id )
+    {
+        return (id == S_LPROC32_V3)
+            || (id == S_GPROC32_V3)
+            || (id == S_LPROC32_ID)
+            || (id == S_GPROC32_ID);
+    }
+
+    uint32_t C13SymbolStore::GetTypeMinSize( uint16_t id )
+    {
+        const CodeViewTypeV2*   type = NULL;
+
+        switch ( id )
+        {
+        case LF_MODIFIER_V2:    return sizeof( type->modifier );
+        case LF_POINTER_V2:     return sizeof( type->pointer );
+        case LF_ARRAY_V2:       return sizeof( type->array );
+        case LF_CLASS_V2:
+        case LF_STRUCTURE_V2:   return sizeof( type->_struct );
+        case LF_UNION_V2:       return sizeof( type->_union );
+        case LF_ENUM_V2:        return offsetof( CodeViewTypeV2, _enum.name );
+        case LF_PROCEDURE_V2:   return sizeof( type->procedure );
+        case LF_MFUNCTION_V2:   return sizeof( type->mfunction );
+        case LF_FIELDLIST_V2:   return offsetof( CodeViewTypeV2, fieldlist.data );
+        case LF_ARGLIST_V2:     return offsetof( CodeViewTypeV2, arglist.args );
+        case LF_DERIVED_V2:     return offsetof( CodeViewTypeV2, derived.drvdcls );
+        }
+
+        return 0;
+    }
+
+    SymbolHeapId C13SymbolStore::GetHeapOfRecord( uint16_t id )
+    {
+        switch ( id )
+        {
+        case S_PROCREF_V3:
+        case S_DATAREF_V3:
+        case S_GDATA32_V3:
+        case S_GTHREAD32_V3:
+        case S_UDT_V3:
+        case S_CONSTANT_V3:
+            return SymHeap_GlobalSymbols;
+
+        case S_LPROCREF_V3:
+        case S_LDATA32_V3:
+        case S_LTHREAD32_V3:
+            return SymHeap_StaticSymbols;
+
+        case S_PUB32_V3:
+            return SymHeap_PublicSymbols;
+        }
+
+        return SymHeap_Max;
+    }
+
+    // the hash that the linker uses for the name tables of the PDB
+    uint32_t C13SymbolStore::HashName( const char* nameChars, size_t nameLen )
+    {
+        const BYTE* bytes = (const BYTE*) nameChars;
+        uint32_t    hash = 0;
+        size_t      i = 0;
+
+        for ( ; nameLen - i >= 4; i += 4 )
+            hash ^= *(const uint32_t*) (bytes + i);
+
+        if ( nameLen - i >= 2 )
+        {
+            hash ^= *(const uint16_t*) (bytes + i);
+            i += 2;
+        }
+
+        if ( nameLen - i >= 1 )
+            hash ^= bytes[i];
+
+        hash |= 0x20202020;
+        hash ^= (hash >> 11);
+        hash ^= (hash >> 16);
+
+        return hash;
+    }
+
+    bool C13SymbolStore::AddrEntryLess( const AddrEntry& left, const AddrEntry& right )
+    {
+        if ( left.Segment != right.Segment )
+            return left.Segment < right.Segment;
+
+        return left.Offset < right.Offset;
+    }
+
+    bool C13SymbolStore::ProcFrameLess( uint32_t offset, const ProcFrame& frame )
+    {
+        return offset < frame.Offset;
+    }
+}
@@ -0,0 +1,218 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+#include "DebugStore.h"
+
+
+namespace MagoST
+{
+    class PDBReader;
+
+    // Reads the C13 symbols and the 32-bit type records of a PDB straight
+    // from its streams. It answers the symbol and type calls of IDebugStore
+    // the same way that DebugStore does for CodeView 4 debug info, so the
+    // PDB store can hand them over when it has a reader for the PDB.
+    //
+    // Handles point at records in the streams, which stay where they are as
+    // long as the PDBReader that Init was given. Type indexes are the ones
+    // in the PDB. The type stream is indexed by an offset table, built once.
+    //
+    // Init reads and checks everything, so that after it the store is only
+    // read, and any number of threads can use it. An S_LOCAL is read with
+    // the S_DEFRANGE records after it. Those, and the records that the
+    // store doesn't know, like S_FILESTATIC, are still enumerated, but
+    // GetSymbolInfo fails for them. Inline sites and
+    // separated code are scopes like blocks are. A module whose records
+    // are damaged, or whose scopes don't nest, acts as if it had no symbols.
+
+    class C13SymbolStore
+    {
+        // the frame pointers of a procedure at the top of a module, that
+        // S_DEFRANGE_FRAMEPOINTER_REL offsets are from
+        struct ProcFrame
+        {
+            uint32_t        Offset;
+            uint32_t        End;
+            uint32_t        LocalReg;
+            uint32_t        ParamReg;
+        };
+
+        // the record offsets in a module's stream count the C13 signature
+        struct Module
+        {
+            const BYTE*     Data;
+            uint32_t        Size;
+            std::vector<ProcFrame>  Frames;     // in the order of their offsets
+        };
+
+        struct AddrEntry
+        {
+            uint16_t        Segment;
+            uint16_t        Module;
+            uint32_t        Offset;
+            const BYTE*     Sym;
+        };
+
+        struct HashRecord
+        {
+            uint32_t        Offset;     // 1 more than the record's in the symbol record stream
+            uint32_t        RefCount;
+        };
+
+        struct HashTable
+        {
+            const HashRecord*       Records;
+            // where each bucket starts in Records; one more to end the last one
+            std::vector<uint32_t>   BucketStarts;
+        };
+
+        struct TypeStream
+        {
+            const BYTE*             Records;
+            TypeIndex               Begin;
+            TypeIndex               End;
+            std::vector<uint32_t>   Offsets;
+        };
+
+        struct SymHandleIn
+        {
+            const BYTE*     Sym;
+            intptr_t        Module;     // 1-based, or 0 for the symbol record stream
+        };
+
+        struct TypeHandleIn
+        {
+            const BYTE*     Type;
+            TypeIndex       Index;
+        };
+
+        struct SymbolScopeIn
+        {
+            const BYTE*     Base;
+            const BYTE*     CurPtr;
+            const BYTE*     Limit;
+            intptr_t        Module;
+            // the heap whose records to stop at, or SymHeap_Max for all of them
+            intptr_t        HeapId;
+        };
+
+        struct TypeScopeIn
+        {
+            const BYTE*     CurPtr;
+            const BYTE*     Limit;
+            TypeIndex       CurIndex;   // of the field list, in a field list scope
+            uint32_t        Count;
+            uint8_t         Kind;
+        };
+
+        struct EnumNamedSymbolsDataIn
+        {
+            const HashRecord*   CurRecord;
+            const HashRecord*   LimitRecord;
+            const char*         NameChars;
+            size_t              NameLen;
+            intptr_t            HeapId;
+            const BYTE*         Sym;
+            intptr_t            SymModule;
+        };
+
+        enum TypeScopeKind
+        {
+            TypeScope_None,
+            TypeScope_Global,
+            TypeScope_FieldList,
+            TypeScope_MethodList,
+        };
+
+        // fields and method list entries don't have indexes of their own
+        static const TypeIndex  FieldIndex = 0xFFFFFFFF;
+        static const TypeIndex  MListMethodIndex = 0xFFFFFFFE;
+
+        std::vector<Module>     mModules;
+        const BYTE*             mSymRecords;
+        uint32_t                mSymRecordsSize;
+        TypeStream              mTypes;
+        TypeStream              mIds;
+        HashTable               mGlobalHash;    // global and static symbols
+        HashTable               mPublicHash;
+        std::vector<AddrEntry>  mAddrs[SymHeap_Count];
+        uint32_t                mFrameReg;
+
+    public:
+        C13SymbolStore();
+
+        HRESULT Init( PDBReader& reader );
+
+        // symbols
+
+        HRESULT SetSymbolScope( SymbolHeapId heapId, SymbolScope& scope );
+        HRESULT SetCompilandSymbolScope( DWORD compilandIndex, SymbolScope& scope );
+        HRESULT SetChildSymbolScope( SymHandle handle, SymbolScope& scope );
+
+        bool NextSymbol( SymbolScope& scope, SymHandle& handle );
+
+        HRESULT FindFirstSymbol( SymbolHeapId heapId, const char* nameChars, size_t nameLen, EnumNamedSymbolsData& data );
+        HRESULT FindNextSymbol( EnumNamedSymbolsData& handle );
+        HRESULT GetCurrentSymbol( const EnumNamedSymbolsData& searchHandle, SymHandle& handle );
+
+        HRESULT FindSymbol( SymbolHeapId heapId, WORD segment, DWORD offset, SymHandle& handle );
+
+        HRESULT GetSymbolInfo( SymHandle handle, SymInfoData& privateData, ISymbolInfo*& symInfo );
+
+        // types
+
+        HRESULT SetGlobalTypeScope( TypeScope& scope );
+        HRESULT SetChildTypeScope( TypeHandle handle, TypeScope& scope );
+
+        bool NextType( TypeScope& scope, TypeHandle& handle );
+
+        bool GetTypeFromTypeIndex( TypeIndex typeIndex, TypeHandle& handle );
+
+        HRESULT GetTypeInfo( TypeHandle handle, SymInfoData& privateData, ISymbolInfo*& symInfo );
+
+    private:
+        HRESULT ReadTypeStream( PDBReader& reader, uint32_t streamIndex, TypeStream& types );
+        HRESULT ReadModule( 
+            const BYTE* data, 
+            uint32_t size, 
+            uint16_t modIndex, 
+            std::vector<uint32_t>& recordOffsets, 
+            std::vector<ProcFrame>& frames );
+        HRESULT ReadSymRecords( 
+            const BYTE* data, 
+            uint32_t size, 
+            const std::vector< std::vector<uint32_t> >& moduleRecords, 
+            std::vector<uint32_t>& recordOffsets );
+        void ReadHashTable( const BYTE* data, uint32_t size, const std::vector<uint32_t>& recordOffsets, HashTable& table );
+
+        bool FollowReference( const BYTE* sym, SymHandleIn& internalHandle );
+        bool IsNamedSymbol( const HashRecord* record, EnumNamedSymbolsDataIn& data );
+        const BYTE* GetTypeRecord( const TypeStream& types, TypeIndex index );
+        TypeIndex GetFunctionType( TypeIndex funcId );
+        const BYTE* FindDefRange( const SymHandleIn& handle );
+        uint32_t GetLocalFrameReg( const SymHandleIn& handle );
+        uint32_t DecodeFrameReg( uint32_t encodedReg );
+
+        bool NextTypeGlobal( TypeScopeIn& scopeIn, TypeHandleIn& handleIn );
+        bool NextField( TypeScopeIn& scopeIn, TypeHandleIn& handleIn );
+        bool NextTypeMList( TypeScopeIn& scopeIn, TypeHandleIn& handleIn );
+        bool SetFieldListScope( const BYTE* fieldList, TypeIndex index, TypeScopeIn& scopeIn );
+
+        static bool IsValidSymbol( const BYTE* sym, uint32_t size );
+        static uint32_t GetSymbolMinSize( uint16_t id );
+        static bool IsScopeSymbol( uint16_t id );
+        static bool IsScopeEndSymbol( uint16_t id );
+        static bool IsProcSymbol( uint16_t id );
+        static uint32_t GetTypeMinSize( uint16_t id );
+        static SymbolHeapId GetHeapOfRecord( uint16_t id );
+        static uint32_t HashName( const char* nameChars, size_t nameLen );
+        static bool AddrEntryLess( const AddrEntry& left, const AddrEntry& right );
+        static bool ProcFrameLess( uint32_t offset, const ProcFrame& frame );
+    };
+}
@@ -0,0 +1,655 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+
+   Purpose: structures and constants for the CodeView 8 records that C13
+            debug info is made of, as found in PDBs. Unlike the records in
+            CVRec.h, type indexes are 32 bits wide, and names are zero-
+            terminated instead of length-prefixed.
+            Only the records that the C13 symbol store reads are here.
+*/
+
+#pragma once
+
+#include <pshpack1.h>
+
+
+typedef uint32_t CV_typ32_t;
+
+
+// leaf indices starting records but referenced from symbol records
+
+#define LF_MODIFIER_V2 0x1001
+#define LF_POINTER_V2 0x1002
+#define LF_PROCEDURE_V2 0x1008
+#define LF_MFUNCTION_V2 0x1009
+#define LF_ARRAY_V2 0x1503
+#define LF_CLASS_V2 0x1504
+#define LF_STRUCTURE_V2 0x1505
+#define LF_UNION_V2 0x1506
+#define LF_ENUM_V2 0x1507
+
+// leaf indices starting records but referenced only from type records
+
+#define LF_ARGLIST_V2 0x1201
+#define LF_FIELDLIST_V2 0x1203
+#define LF_DERIVED_V2 0x1204
+#define LF_METHODLIST_V2 0x1206
+
+// leaf indices for fields of complex lists
+
+#define LF_BCLASS_V2 0x1400
+#define LF_VBCLASS_V2 0x1401
+#define LF_IVBCLASS_V2 0x1402
+#define LF_INDEX_V2 0x1404
+#define LF_VFUNCTAB_V2 0x1409
+#define LF_FRIENDCLS_V2 0x140a
+#define LF_VFUNCOFF_V2 0x140c
+#define LF_ENUMERATE_V3 0x1502
+#define LF_FRIENDFCN_V3 0x150c
+#define LF_MEMBER_V3 0x150d
+#define LF_STMEMBER_V3 0x150e
+#define LF_METHOD_V3 0x150f
+#define LF_NESTTYPE_V3 0x1510
+#define LF_ONEMETHOD_V3 0x1511
+
+// leaf indices of the records in the ID stream
+
+#define LF_FUNC_ID 0x1601
+#define LF_MFUNC_ID 0x1602
+
+
+//----------------------------------------------------------------------------
+//  Type records - top level, referenced from symbols or other types
+//----------------------------------------------------------------------------
+
+union CodeViewTypeV2
+{
+    struct
+    {
+        unsigned short  len;
+        unsigned short  id;
+    } Generic;
+
+    struct
+    {
+        unsigned short  len;
+        unsigned short  id;         // LF_MODIFIER_V2
+        CV_typ32_t      type;       // modified type
+        unsigned short  attr;
+    } modifier;
+
+    struct
+    {
+        unsigned short  len;
+        unsigned short  id;         // LF_POINTER_V2
+        CV_typ32_t      type;       // type index of the underlying type
+        uint32_t        attribute;  // the low 16 bits are laid out like lfPointerAttr
+        // variant part, depending on pointer type
+    } pointer;
+
+    struct
+    {
+        unsigned short  len;
+        unsigned short  id;         // LF_ARRAY_V2
+        CV_typ32_t      elemtype;   // type index of element type
+        CV_typ32_t      idxtype;    // type index of indexing type
+        unsigned short  arraylen;   // numeric leaf with array length
+        // char             name[]
+    } array;
+
+    struct
+    {
+        unsigned short  len;
+        unsigned short  id;         // LF_CLASS_V2, LF_STRUCTURE_V2
+        unsigned short  count;      // count of number of elements in class
+        unsigned short  property;
+        CV_typ32_t      fieldlist;  // type index of LF_FIELDLIST_V2 descriptor list
+        CV_typ32_t      derived;    // type index of derived from list if not zero
+        CV_typ32_t      vshape;     // type index of vshape table for this class
+        unsigned short  structlen;  // numeric leaf with length of struct
+        // char             name[]
+    } _struct;
+
+    struct
+    {
+        unsigned short  len;
+        unsigned short  id;         // LF_UNION_V2
+        unsigned short  count;      // count of number of elements in union
+        unsigned short  property;
+        CV_typ32_t      fieldlist;  // type index of LF_FIELDLIST_V2 descriptor list
+        unsigned short  unionlen;   // numeric leaf with length of union
+        // char             name[]
+    } _union;
+
+    struct
+    {
+        unsigned short  len;
+        unsigned short  id;         // LF_ENUM_V2
+        unsigned short  count;      // count of number of elements in enum
+        unsigned short  property;
+        CV_typ32_t      type;       // underlying type of the enum
+        CV_typ32_t      fieldlist;  // type index of LF_FIELDLIST_V2 descriptor list
+        char            name[1];
+    } _enum;
+
+    struct
+    {
+        unsigned short  len;
+        unsigned short  id;         // LF_PROCEDURE_V2
+        CV_typ32_t      rvtype;     // type index of return value
+        unsigned char   callconv;   // calling convention (CV_call_t)
+        unsigned char   reserved;
+        unsigned short  paramcount; // number of parameters
+        CV_typ32_t      arglist;    // type index of argument list
+    } procedure;
+
+    struct
+    {
+        unsigned short  len;
+        unsigned short  id;         // LF_MFUNCTION_V2
+        CV_typ32_t      rvtype;     // type index of return value
+        CV_typ32_t      class_type; // type index of containing class
+        CV_typ32_t      this_type;  // type index of this pointer (model specific)
+        unsigned char   callconv;   // calling convention (CV_call_t)
+        unsigned char   reserved;
+        unsigned short  paramcount; // number of parameters
+        CV_typ32_t      arglist;    // type index of argument list
+        int32_t         this_adjust;// this adjuster
+    } mfunction;
+
+    struct
+    {
+        unsigned short  len;
+        unsigned short  id;         // LF_ARGLIST_V2
+        uint32_t        count;      // number of arguments
+        CV_typ32_t      args[1];
+    } arglist;
+
+    struct
+    {
+        unsigned short  len;
+        unsigned short  id;         // LF_DERIVED_V2
+        uint32_t        count;      // number of derived classes
+        CV_typ32_t      drvdcls[1]; // type indices of derived classes
+    } derived;
+
+    struct
+    {
+        unsigned short  len;
+        unsigned short  id;         // LF_FIELDLIST_V2
+        char            data[1];    // field list sub lists
+    } fieldlist;
+
+    struct
+    {
+        unsigned short  len;
+        unsigned short  id;         // LF_FUNC_ID
+        CV_typ32_t      scope;      // parent scope of the function, or 0
+        CV_typ32_t      type;       // function type
+        char            name[1];
+    } funcid;
+
+    struct
+    {
+        unsigned short  len;
+        unsigned short  id;         // LF_MFUNC_ID
+        CV_typ32_t      parent;     // type index of the containing class
+        CV_typ32_t      type;       // function type
+        char            name[1];
+    } mfuncid;
+};
+
+
+//----------------------------------------------------------------------------
+//  Type records - used for fields of complex lists
+//----------------------------------------------------------------------------
+
+union CodeViewFieldTypeV2
+{
+    struct
+    {
+        unsigned short  id;
+    } Generic;
+
+    struct
+    {
+        unsigned short  id;     // LF_INDEX_V2
+        unsigned short  pad;
+        CV_typ32_t      type;   // type index of the continuation field list
+    } index;
+
+    struct
+    {
+        unsigned short  id;     // LF_BCLASS_V2
+        unsigned short  attr;
+        CV_typ32_t      type;   // type index of base class
+        unsigned short  offset; // numeric leaf with offset of base within class
+    } bclass;
+
+    struct
+    {
+        unsigned short  id;     // LF_VBCLASS_V2 | LF_IVBCLASS_V2
+        unsigned short  attr;
+        CV_typ32_t      vbtype; // type index of direct virtual base class
+        CV_typ32_t      vbptr;  // type index of virtual base pointer
+        unsigned short  vbpoff; // numeric leaf with virtual base pointer offset from address point
+        // followed by virtual base offset from vbtable
+    } vbclass;
+
+    struct
+    {
+        unsigned short  id;     // LF_FRIENDCLS_V2
+        unsigned short  pad;
+        CV_typ32_t      type;   // index to type record of friend class
+    } friendcls;
+
+    struct
+    {
+        unsigned short  id;     // LF_FRIENDFCN_V3
+        unsigned short  pad;
+        CV_typ32_t      type;   // index to type record of friend function
+        char            name[1];
+    } friendfcn;
+
+    struct
+    {
+        unsigned short  id;     // LF_MEMBER_V3
+        unsigned short  attr;
+        CV_typ32_t      type;   // index of type record for field
+        unsigned short  offset; // numeric leaf with offset of field
+        // char             name[]
+    } member;
+
+    struct
+    {
+        unsigned short  id;     // LF_STMEMBER_V3
+        unsigned short  attr;
+        CV_typ32_t      type;   // index of type record for field
+        char            name[1];
+    } stmember;
+
+    struct
+    {
+        unsigned short  id;     // LF_VFUNCTAB_V2
+        unsigned short  pad;
+        CV_typ32_t      type;   // type index of pointer
+    } vfunctab;
+
+    struct
+    {
+        unsigned short  id;     // LF_VFUNCOFF_V2
+        unsigned short  pad;
+        CV_typ32_t      type;   // type index of pointer
+        int32_t         offset; // offset of virtual function table pointer
+    } vfuncoff;
+
+    struct
+    {
+        unsigned short  id;     // LF_METHOD_V3
+        unsigned short  count;  // number of occurances of function
+        CV_typ32_t      mlist;  // index to LF_METHODLIST_V2 record
+        char            name[1];
+    } method;
+
+    struct
+    {
+        unsigned short  id;     // LF_ONEMETHOD_V3
+        unsigned short  attr;
+        CV_typ32_t      type;   // index to type record for procedure
+        char            name[1];
+    } onemethod;
+
+    struct
+    {
+        unsigned short  id;         // LF_ONEMETHOD_V3
+        unsigned short  attr;
+        CV_typ32_t      type;       // index to type record for procedure
+        uint32_t        vtaboff;    // offset in vfunctable if intro virtual
+        char            name[1];
+    } onemethod_virt;
+
+    struct
+    {
+        unsigned short  id;     // LF_NESTTYPE_V3
+        unsigned short  pad;
+        CV_typ32_t      type;   // index of nested type definition
+        char            name[1];
+    } nesttype;
+
+    struct
+    {
+        unsigned short  id;     // LF_ENUMERATE_V3
+        unsigned short  attr;
+        unsigned short  value;  // numeric leaf with the value
+        // char             name[]
+    } enumerate;
+};
+
+
+// an entry in a LF_METHODLIST_V2 record
+
+union MListMethodV2
+{
+    struct
+    {
+        unsigned short  Attr;
+        unsigned short  Pad;
+        CV_typ32_t      Type;
+    } OneMethod;
+
+    struct
+    {
+        unsigned short  Attr;
+        unsigned short  Pad;
+        CV_typ32_t      Type;
+        uint32_t        VTabOffset;
+    } OneMethodVirt;
+};
+
+
+//----------------------------------------------------------------------------
+//  Symbol records
+//----------------------------------------------------------------------------
+
+typedef enum SYM_ENUM_V3_e
+{
+    S_FRAMEPROC_V3 = 0x1012,        // extra frame and proc information
+    S_ANNOTATION_V3 = 0x1019,       // annotation string literals
+    S_OBJNAME_V3 = 0x1101,          // path to object file name
+    S_THUNK32_V3 = 0x1102,          // thunk start
+    S_BLOCK32_V3 = 0x1103,          // block start
+    S_LABEL32_V3 = 0x1105,          // code label
+    S_REGISTER_V3 = 0x1106,         // register variable
+    S_CONSTANT_V3 = 0x1107,         // constant symbol
+    S_UDT_V3 = 0x1108,              // user defined type
+    S_BPREL32_V3 = 0x110b,          // BP-relative
+    S_LDATA32_V3 = 0x110c,          // module-local symbol
+    S_GDATA32_V3 = 0x110d,          // global data symbol
+    S_PUB32_V3 = 0x110e,            // a public symbol
+    S_LPROC32_V3 = 0x110f,          // local procedure start
+    S_GPROC32_V3 = 0x1110,          // global procedure start
+    S_REGREL32_V3 = 0x1111,         // register relative address
+    S_LTHREAD32_V3 = 0x1112,        // local thread storage
+    S_GTHREAD32_V3 = 0x1113,        // global thread storage
+    S_COMPILE2_V3 = 0x1116,         // compile flags symbol
+    S_UNAMESPACE_V3 = 0x1124,       // using namespace
+    S_PROCREF_V3 = 0x1125,          // reference to a procedure
+    S_DATAREF_V3 = 0x1126,          // reference to data
+    S_LPROCREF_V3 = 0x1127,         // local reference to a procedure
+    S_TRAMPOLINE_V3 = 0x112c,       // incremental linking trampoline
+    S_SEPCODE_V3 = 0x1132,          // separated code, split off from a procedure
+    S_SECTION_V3 = 0x1136,          // a COFF section in a PE executable
+    S_COFFGROUP_V3 = 0x1137,        // a COFF group
+    S_EXPORT_V3 = 0x1138,           // a export
+    S_CALLSITEINFO_V3 = 0x1139,     // indirect call site information
+    S_FRAMECOOKIE_V3 = 0x113a,      // security cookie information
+    S_COMPILE3_V3 = 0x113c,         // compile flags symbol
+    S_ENVBLOCK_V3 = 0x113d,         // environment block split off from S_COMPILE2
+    S_LOCAL_V3 = 0x113e,            // local variable, located by the S_DEFRANGE records after it
+    S_DEFRANGE_V3 = 0x113f,         // where a local is, in the debugger's own terms
+    S_DEFRANGE_SUBFIELD_V3 = 0x1140,    // part of a local, in the debugger's own terms
+    S_DEFRANGE_REGISTER_V3 = 0x1141,    // local in a register
+    S_DEFRANGE_FRAMEPOINTER_REL_V3 = 0x1142,    // local relative to the frame pointer
+    S_DEFRANGE_SUBFIELD_REGISTER_V3 = 0x1143,   // part of a local in a register
+    S_DEFRANGE_FRAMEPOINTER_REL_FULL_SCOPE_V3 = 0x1144, // frame relative, in all of its scope
+    S_DEFRANGE_REGISTER_REL_V3 = 0x1145,    // local relative to a register
+    S_BUILDINFO_V3 = 0x114c,        // build information
+    S_INLINESITE_V3 = 0x114d,       // start of an inlined function's code
+    S_INLINESITE_END_V3 = 0x114e,   // end of an S_INLINESITE or S_INLINESITE2
+    S_LPROC32_ID = 0x1146,          // local procedure start, with a function ID
+    S_GPROC32_ID = 0x1147,          // global procedure start, with a function ID
+    S_PROC_ID_END = 0x114f,         // end of an S_*PROC32_ID
+    S_FILESTATIC_V3 = 0x1153,       // static variable of a file, located like an S_LOCAL
+    S_CALLEES_V3 = 0x115a,          // functions that a function calls
+    S_CALLERS_V3 = 0x115b,          // functions that call a function
+    S_POGODATA_V3 = 0x115c,         // profile guided optimization data
+    S_INLINESITE2_V3 = 0x115d,      // S_INLINESITE with an invocation count
+    S_HEAPALLOCSITE_V3 = 0x115e     // heap allocation site
+} SYM_ENUM_V3_e;
+
+
+// the code that an S_DEFRANGE record holds for
+struct CV_LVAR_ADDR_RANGE_V3
+{
+    uint32_t        offStart;
+    unsigned short  isectStart;
+    unsigned short  cbRange;
+};
+
+// bits of the S_LOCAL_V3 flags
+typedef enum CV_LVARFLAGS_V3_e
+{
+    CV_LVAR_ISPARAM_V3 = 0x0001,        // a parameter
+    CV_LVAR_OPTIMIZEDOUT_V3 = 0x0100    // stored nowhere
+} CV_LVARFLAGS_V3_e;
+
+union CodeViewSymbolV3
+{
+    struct
+    {
+        unsigned short  len;    // Record length
+        unsigned short  id;     // Record type
+    } Generic;
+
+    struct
+    {
+        unsigned short  len;    // Record length
+        unsigned short  id;     // S_REGISTER_V3
+        CV_typ32_t      type;   // Type index
+        unsigned short  reg;    // register enumerate
+        char            name[1];
+    } reg;
+
+    struct
+    {
+        unsigned short  len;    // Record length
+        unsigned short  id;     // S_CONSTANT_V3
+        CV_typ32_t      type;   // Type index (containing enum if enumerate)
+        unsigned short  value;  // numeric leaf containing value
+        // char             name[]
+    } constant;
+
+    struct
+    {
+        unsigned short  len;    // Record length
+        unsigned short  id;     // S_UDT_V3
+        CV_typ32_t      type;   // Type index
+        char            name[1];
+    } udt;
+
+    struct
+    {
+        unsigned short  len;    // Record length
+        unsigned short  id;     // S_BPREL32_V3
+        int32_t         offset; // BP-relative offset
+        CV_typ32_t      type;   // Type index
+        char            name[1];
+    } bprel;
+
+    // also includes S_LTHREAD32_V3 and S_GTHREAD32_V3
+
+    struct
+    {
+        unsigned short  len;        // Record length
+        unsigned short  id;         // S_LDATA32_V3 or S_GDATA32_V3
+        CV_typ32_t      type;       // Type index
+        uint32_t        offset;
+        unsigned short  segment;
+        char            name[1];
+    } data;
+
+    struct
+    {
+        unsigned short  len;        // Record length
+        unsigned short  id;         // S_PUB32_V3
+        uint32_t        flags;      // code, function, managed, MSIL
+        uint32_t        offset;
+        unsigned short  segment;
+        char            name[1];
+    } pub;
+
+    struct
+    {
+        unsigned short  len;            // Record length
+        unsigned short  id;             // S_GPROC32_V3, S_LPROC32_V3, or their _ID forms
+        uint32_t        parent;         // pointer to the parent
+        uint32_t        end;            // pointer to this blocks end
+        uint32_t        next;           // pointer to next symbol
+        uint32_t        length;         // Proc length
+        uint32_t        debug_start;    // Debug start offset
+        uint32_t        debug_end;      // Debug end offset
+        CV_typ32_t      type;           // Type index, or function ID for the _ID forms
+        uint32_t        offset;
+        unsigned short  segment;
+        unsigned char   flags;
+        char            name[1];
+    } proc;
+
+    struct
+    {
+        unsigned short  len;        // Record length
+        unsigned short  id;         // S_THUNK32_V3
+        uint32_t        parent;     // pointer to the parent
+        uint32_t        end;        // pointer to this blocks end
+        uint32_t        next;       // pointer to next symbol
+        uint32_t        offset;
+        unsigned short  segment;
+        unsigned short  length;     // length of thunk
+        unsigned char   ord;        // ordinal specifying type of thunk
+        char            name[1];
+        //unsigned char variant[CV_ZEROLEN]; // variant portion of thunk
+    } thunk;
+
+    struct
+    {
+        unsigned short  len;        // Record length
+        unsigned short  id;         // S_LABEL32_V3
+        uint32_t        offset;
+        unsigned short  segment;
+        unsigned char   flags;
+        char            name[1];
+    } label;
+
+    struct
+    {
+        unsigned short  len;        // Record length
+        unsigned short  id;         // S_BLOCK32_V3
+        uint32_t        parent;     // pointer to the parent
+        uint32_t        end;        // pointer to this blocks end
+        uint32_t        length;     // Block length
+        uint32_t        offset;     // Offset in code segment
+        unsigned short  segment;    // segment of label
+        char            name[1];
+    } block;
+
+    struct
+    {
+        unsigned short  len;        // Record length
+        unsigned short  id;         // S_INLINESITE_V3 or S_INLINESITE2_V3
+        uint32_t        parent;     // pointer to the parent
+        uint32_t        end;        // pointer to the S_INLINESITE_END
+        CV_typ32_t      inlinee;    // function ID of the inlined function
+        // binary annotations follow, after an invocation count in S_INLINESITE2
+    } inlineSite;
+
+    struct
+    {
+        unsigned short  len;        // Record length
+        unsigned short  id;         // S_SEPCODE_V3
+        uint32_t        parent;     // pointer to the parent
+        uint32_t        end;        // pointer to this block's end
+        uint32_t        length;     // count of bytes of this block
+        uint32_t        flags;
+        uint32_t        offset;     // address of the separated code
+        uint32_t        parentOffset;
+        unsigned short  segment;
+        unsigned short  parentSegment;
+    } sepcode;
+
+    struct
+    {
+        unsigned short  len;            // Record length
+        unsigned short  id;             // S_FRAMEPROC_V3
+        uint32_t        frameSize;      // count of bytes of the frame
+        uint32_t        padSize;        // count of bytes of padding
+        uint32_t        padOffset;      // offset of the padding from the frame
+        uint32_t        saveRegsSize;   // count of bytes of saved registers
+        uint32_t        exHandlerOffset;
+        unsigned short  exHandlerSection;
+        uint32_t        flags;          // frame pointer of locals: bits 14-15, of params: bits 16-17
+    } frameProc;
+
+    struct
+    {
+        unsigned short  len;    // Record length
+        unsigned short  id;     // S_REGREL32_V3
+        int32_t         offset; // offset of symbol
+        CV_typ32_t      type;   // Type index
+        unsigned short  reg;    // register index for symbol
+        char            name[1];
+    } regrel;
+
+    struct
+    {
+        unsigned short  len;        // Record length
+        unsigned short  id;         // S_LOCAL_V3
+        CV_typ32_t      type;       // Type index
+        unsigned short  flags;      // CV_LVARFLAGS
+        char            name[1];
+    } local;
+
+    // the S_DEFRANGE records that say where the S_LOCAL before them is
+
+    struct
+    {
+        unsigned short  len;        // Record length
+        unsigned short  id;         // S_DEFRANGE_REGISTER_V3
+        unsigned short  reg;        // register that holds the local
+        unsigned short  attr;       // CV_RANGEATTR
+        CV_LVAR_ADDR_RANGE_V3 range;
+        // gaps in the range follow, each an offset and a length of 16 bits
+    } defRangeReg;
+
+    struct
+    {
+        unsigned short  len;        // Record length
+        unsigned short  id;         // S_DEFRANGE_FRAMEPOINTER_REL_V3
+        int32_t         offset;     // offset from the frame pointer
+        CV_LVAR_ADDR_RANGE_V3 range;
+        // gaps in the range follow, each an offset and a length of 16 bits
+    } defRangeFrameRel;
+
+    struct
+    {
+        unsigned short  len;        // Record length
+        unsigned short  id;         // S_DEFRANGE_FRAMEPOINTER_REL_FULL_SCOPE_V3
+        int32_t         offset;     // offset from the frame pointer
+    } defRangeFrameRelFullScope;
+
+    struct
+    {
+        unsigned short  len;        // Record length
+        unsigned short  id;         // S_DEFRANGE_REGISTER_REL_V3
+        unsigned short  reg;        // register that the offset is from
+        unsigned short  flags;      // spilled member: bit 0, offset in parent: bits 4-15
+        int32_t         offset;     // offset from the register
+        CV_LVAR_ADDR_RANGE_V3 range;
+        // gaps in the range follow, each an offset and a length of 16 bits
+    } defRangeRegRel;
+
+    struct
+    {
+        unsigned short  len;        // Record length
+        unsigned short  id;         // S_PROCREF_V3, S_DATAREF_V3, or S_LPROCREF_V3
+        uint32_t        sumName;    // SUC of the name
+        uint32_t        ibSym;      // Offset of actual symbol in the module's symbols
+        unsigned short  imod;       // Module containing the actual symbol
+        char            name[1];
+    } symref;
+};
+
+
+#include <poppack.h>
@@ -64,7 +64,7 @@ typedef enum OMFHash
 typedef struct OMFSignature
 {
     char            Signature[4];  // "NBxx"
-    long            filepos;       // offset in file
+    LONG            filepos;       // offset in file
 } OMFSignature;
 
 
@@ -78,9 +78,9 @@ typedef struct OMFDirHeader
 {
     unsigned short  cbDirHeader;    // length of this structure
     unsigned short  cbDirEntry;     // number of bytes in each directory entry
-    unsigned long   cDir;           // number of directorie entries
-    long            lfoNextDir;     // offset from base of next directory
-    unsigned long flags;            // status flags
+    ULONG           cDir;           // number of directorie entries
+    LONG            lfoNextDir;     // offset from base of next directory
+    ULONG         flags;            // status flags
 } OMFDirHeader;
 
 
@@ -95,8 +95,8 @@ typedef struct OMFDirEntry
 {
     unsigned short  SubSection; // subsection type (sst...)
     unsigned short  iMod;       // module index
-    long            lfo;        // large file offset of subsection
-    unsigned long   cb;         // number of bytes in subsection
+    LONG            lfo;        // large file offset of subsection
+    ULONG           cb;         // number of bytes in subsection
 } OMFDirEntry;
 
 
@@ -109,8 +109,8 @@ typedef struct OMFSegDesc
 {
     unsigned short Seg; // segment index
     unsigned short pad; // pad to maintain alignment
-    unsigned long Off; // offset of code in segment
-    unsigned long cbSeg; // number of bytes in segment
+    ULONG         Off; // offset of code in segment
+    ULONG         cbSeg; // number of bytes in segment
 } OMFSegDesc;
 
 
@@ -143,9 +143,9 @@ typedef struct OMFSymHash
 {
     unsigned short  symhash;    // symbol hash function index
     unsigned short  addrhash;   // address hash function index
-    unsigned long   cbSymbol;   // length of symbol information
-    unsigned long   cbHSym;     // length of symbol hash data
-    unsigned long   cbHAddr;    // length of address hashdata
+    ULONG           cbSymbol;   // length of symbol information
+    ULONG           cbHSym;     // length of symbol hash data
+    ULONG           cbHAddr;    // length of address hashdata
 } OMFSymHash;
 
 
@@ -160,9 +160,9 @@ typedef struct OMFSymHash
 
 typedef struct OMFGlobalTypes
 {
-    unsigned long   flags;
+    ULONG           flags;
     //OMFTypeFlags flags;
-    unsigned long   cTypes; // number of types
+    ULONG           cTypes; // number of types
     //unsigned long   typeOffset[1]; // array of offsets to types
 } OMFGlobalTypes;
 
@@ -179,7 +179,7 @@ typedef struct OMFSourceLine
 {
     unsigned short  Seg;            // linker segment index
     unsigned short  cLnOff;         // count of line/offset pairs
-    unsigned long   offset[1];      // array of offsets in segment
+    ULONG           offset[1];      // array of offsets in segment
     unsigned short  lineNbr[1];     // array of line lumber in source
 } OMFSourceLine;
 
@@ -191,7 +191,7 @@ typedef struct OMFSourceFile
 {
     unsigned short  cSeg;           // number of segments from source file
     unsigned short  reserved;
-    unsigned long   baseSrcLn[1];   // base of OMFSourceLine tables
+    ULONG           baseSrcLn[1];   // base of OMFSourceLine tables
     // this array is followed by array
     // of segment start/end pairs followed by
     // an array of linker indices
@@ -210,7 +210,7 @@ typedef struct OMFSourceModule
 {
     unsigned short  cFile;          // number of OMFSourceTables
     unsigned short  cSeg;           // number of segments in module
-    unsigned long   baseSrcFile[1]; // base of OMFSourceFile table
+    ULONG           baseSrcFile[1]; // base of OMFSourceFile table
     // this array is followed by array
     // of segment start/end pairs followed
     // by an array of linker indices
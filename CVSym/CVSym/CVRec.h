@@ -14,8 +14,8 @@
 #include <pshpack1.h>
 
 
-typedef unsigned long CV_uoff32_t;
-typedef long CV_off32_t;
+typedef ULONG         CV_uoff32_t;
+typedef LONG CV_off32_t;
 typedef unsigned short CV_uoff16_t;
 typedef short CV_off16_t;
 typedef unsigned short CV_typ_t;
@@ -245,7 +245,7 @@ union CodeViewType
         unsigned char   reserved;   // reserved for future use
         unsigned short  paramcount; // number of parameters
         CV_typ_t        arglist;    // type index of argument list
-        long            this_adjust; // this adjuster (long because pad required anyway)
+        LONG            this_adjust; // this adjuster (long because pad required anyway)
     } mfunction;
 
     // type record for virtual function table shape
@@ -474,7 +474,7 @@ union CodeViewFieldType
         unsigned short  attr;
         //CV_fldattr_t    attr;     // method attribute
         CV_typ_t        type;       // index to type record for procedure
-        unsigned long   vtaboff;    // offset in vfunctable if
+        ULONG           vtaboff;    // offset in vfunctable if
                                     // intro virtual followed by
                                     // length prefixed name of method
         PasString       p_name;
@@ -628,7 +628,7 @@ union CodeViewSymbol
     {
         unsigned short  len;        // Record length
         unsigned short  id;         // S_SSEARCH
-        unsigned long   startsym;   // offset of the procedure
+        ULONG           startsym;   // offset of the procedure
         unsigned short  segment;    // segment of symbol
     } search;
 
@@ -655,7 +655,7 @@ union CodeViewSymbol
     {
         unsigned short  len;        // Record length
         unsigned short  id;         // S_OBJNAME
-        unsigned long   signature;  // signature
+        ULONG           signature;  // signature
         PasString       p_name;     // Length-prefixed name
     } objname;
 
@@ -686,12 +686,12 @@ union CodeViewSymbol
     {
         unsigned short  len;            // Record length
         unsigned short  id;             // S_GPROC32 or S_LPROC32
-        unsigned long   parent;         // pointer to the parent
-        unsigned long   end;            // pointer to this blocks end
-        unsigned long   next;           // pointer to next symbol
-        unsigned long   length;         // Proc length
-        unsigned long   debug_start;    // Debug start offset
-        unsigned long   debug_end;      // Debug end offset
+        ULONG           parent;         // pointer to the parent
+        ULONG           end;            // pointer to this blocks end
+        ULONG           next;           // pointer to next symbol
+        ULONG           length;         // Proc length
+        ULONG           debug_start;    // Debug start offset
+        ULONG           debug_end;      // Debug end offset
         CV_uoff32_t     offset;
         unsigned short  segment;
         CV_typ_t        type;           // Type index
@@ -704,9 +704,9 @@ union CodeViewSymbol
     {
         unsigned short  len;        // Record length
         unsigned short  id;         // S_THUNK32
-        unsigned long   parent;     // pointer to the parent
-        unsigned long   end;        // pointer to this blocks end
-        unsigned long   next;       // pointer to next symbol
+        ULONG           parent;     // pointer to the parent
+        ULONG           end;        // pointer to this blocks end
+        ULONG           next;       // pointer to next symbol
         CV_uoff32_t     offset;
         unsigned short  segment;
         unsigned short  length;     // length of thunk
@@ -730,9 +730,9 @@ union CodeViewSymbol
     {
         unsigned short  len;        // Record length
         unsigned short  id;         // S_BLOCK32
-        unsigned long   parent;     // pointer to the parent
-        unsigned long   end;        // pointer to this blocks end
-        unsigned long   length;     // Block length
+        ULONG           parent;     // pointer to the parent
+        ULONG           end;        // pointer to this blocks end
+        ULONG           length;     // Block length
         CV_uoff32_t     offset;     // Offset in code segment
         unsigned short  segment;    // segment of label
         PasString       p_name;     // Length-prefixed name
@@ -742,9 +742,9 @@ union CodeViewSymbol
     {
         unsigned short  len;        // Record length
         unsigned short  id;         // S_WITH32
-        unsigned long   parent;     // pointer to the parent
-        unsigned long   end;        // pointer to this blocks end
-        unsigned long   length;     // Block length
+        ULONG           parent;     // pointer to the parent
+        ULONG           end;        // pointer to this blocks end
+        ULONG           length;     // Block length
         CV_uoff32_t     offset;     // Offset in code segment
         unsigned short  segment;    // segment of label
         PasString       p_expr;     // Length-prefixed expression string
@@ -775,8 +775,8 @@ union CodeViewSymbol
     {
         unsigned short  len;        // Record length
         unsigned short  id;         // S_PROCREF or S_DATAREF
-        unsigned long   sumName;    // SUC of the name
-        unsigned long   ibSym;      // Offset of actual symbol in $$Symbols
+        ULONG           sumName;    // SUC of the name
+        ULONG           ibSym;      // Offset of actual symbol in $$Symbols
         unsigned short  imod;       // Module containing the actual symbol
         unsigned short  usFill;     // align this record
     } symref;
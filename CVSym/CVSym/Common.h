@@ -21,7 +21,9 @@
 #include <inttypes.h>
 
 // STL
+#include <algorithm>
 #include <list>
+#include <map>
 #include <vector>
 
 // Windows
@@ -29,10 +31,16 @@
 
 // Magus
 #include <SmartPtr.h>
+#include <Guard.h>
 
 // This project
 #include "Error.h"
 #include "CVSymPublic.h"
 #include "CVSymInternal.h"
 #include "CVRec.h"
+#include "CV8Rec.h"
 #include "CVExeFmt.h"
+
+// Windows declarations that I don't want
+#undef max
+#undef min
@@ -30,7 +30,17 @@ namespace MagoST
             mGlobalTypesDir( NULL ),
             mCompilandCount( 0 ),
             mTLSSegment( 0 ),
-            mTextSegment( 2 )
+            mTextSegment( 2 ),
+            mMarkBits( NULL ),
+            mMarkBitCount( 0 ),
+            mLineIntervals( NULL ),
+            mLineIntervalMaxEnd( NULL ),
+            mLineIntervalCount( 0 ),
+            mFileNameIndex( NULL ),
+            mFileNameCount( 0 ),
+            mUsedSavedIndex( false ),
+            mTypeBase( NULL ),
+            mTypeOffsets( NULL )
     {
         memset( mSymsDir, 0, sizeof mSymsDir );
 
@@ -43,6 +53,10 @@ namespace MagoST
 
     DebugStore::~DebugStore()
     {
+        for ( size_t i = 0; i < mFileLineIndexes.size(); i++ )
+        {
+            delete mFileLineIndexes[i];
+        }
     }
 
     HRESULT DebugStore::SetCVBuffer( BYTE* buffer, DWORD size )
@@ -63,6 +77,11 @@ namespace MagoST
     }
 
     HRESULT DebugStore::InitDebugInfo( BYTE* buffer, DWORD size )
+    {
+        return InitDebugInfo( buffer, size, NULL, 0 );
+    }
+
+    HRESULT DebugStore::InitDebugInfo( BYTE* buffer, DWORD size, const BYTE* savedIndex, uint32_t savedIndexSize )
     {
         HRESULT hr = S_OK;
 
@@ -70,7 +89,7 @@ namespace MagoST
         if ( FAILED( hr ) )
             return hr;
 
-        hr = InitDebugInfo();
+        hr = LoadDebugInfo( savedIndex, savedIndexSize );
         if ( FAILED( hr ) )
             return hr;
 
@@ -78,6 +97,11 @@ namespace MagoST
     }
 
     HRESULT DebugStore::InitDebugInfo()
+    {
+        return LoadDebugInfo( NULL, 0 );
+    }
+
+    HRESULT DebugStore::LoadDebugInfo( const BYTE* savedIndex, uint32_t savedIndexSize )
     {
         if ( (mCVBuf == NULL) || (mCVBufSize == 0) )
             return E_INVALIDARG;
@@ -120,6 +144,10 @@ namespace MagoST
             return E_OUTOFMEMORY;
         memset( mCompilandDetails.Get(), 0, mCompilandCount * sizeof( CompilandDetails ) );
 
+        // a saved index that matches replaces marking the line numbers and 
+        // building the line and file name indexes below
+        mUsedSavedIndex = LoadSavedIndex( savedIndex, savedIndexSize );
+
         dir = dirStart;
         for ( DWORD i = 0; i < dirHeader->cDir; i++ )
         {
@@ -135,6 +163,30 @@ namespace MagoST
         mDirHeader = (OMFDirHeader*) dirHeader;
         mDirs = (OMFDirEntry*) dirStart;
 
+        ValidateDebugInfo();
+        SetFileLineIndexSlots();
+
+        if ( !mUsedSavedIndex )
+        {
+            SetMarkBitsView();
+
+            hr = BuildLineIndex();
+            if ( FAILED( hr ) )
+                return hr;
+
+            hr = BuildFileNameIndex();
+            if ( FAILED( hr ) )
+                return hr;
+
+            SetLineIndexViews();
+        }
+
+        LineIndexStats  stats = { 0 };
+        GetLineIndexStats( stats );
+        _RPT4( _CRT_WARN, "DebugStore line index: %u intervals, %u file names, %u bytes%s\n", 
+            stats.IntervalCount, stats.FileNameCount, stats.MemoryBytes, 
+            mUsedSavedIndex ? " (saved)" : "" );
+
         return S_OK;
     }
 
@@ -159,7 +211,8 @@ namespace MagoST
         {
         case sstModule:
             
-            MarkLineNumbers( entry );
+            if ( !mUsedSavedIndex )
+                MarkLineNumbers( entry );
             break;
 
         case sstAlignSym:
@@ -167,6 +220,11 @@ namespace MagoST
             if ( (entry->iMod == 0) || (entry->iMod > mCompilandCount) )
                 return E_BAD_FORMAT;
 
+            // the source accessors don't check bounds, so leave out the whole 
+            // module if any part of it is bad
+            if ( (entry->SubSection == sstSrcModule) && !ValidateSourceModule( entry ) )
+                return S_OK;
+
             // modules are 1 based
             if ( entry->SubSection == sstAlignSym )
                 mCompilandDetails[ entry->iMod - 1 ].SymbolEntry = entry;
@@ -175,7 +233,8 @@ namespace MagoST
             else
                 _ASSERT( false );
 
-            MarkLineNumbers( entry );
+            if ( !mUsedSavedIndex )
+                MarkLineNumbers( entry );
             break;
 
         case sstGlobalTypes:
@@ -252,10 +311,14 @@ namespace MagoST
             return hr;
         // now HeapDir and HeapBase are set
 
-        scopeIn->StartPtr = firstChildPtr;
-        scopeIn->CurPtr = scopeIn->StartPtr;
+        scopeIn->CurPtr = firstChildPtr;
             // pEnd is at the same offset in all of these
         scopeIn->Limit = scopeIn->HeapBase + sym->block.end;
+        scopeIn->Validated = IsValidScope( internalHandle );
+
+        // the validation pass already found the S_END
+        if ( scopeIn->Validated )
+            return S_OK;
 
         // Limit is supposed to point at an S_END, so make sure it's in bounds
         if ( !ValidateCVPtr( scopeIn->Limit, 4 ) )
@@ -288,9 +351,9 @@ namespace MagoST
 
         scopeIn->Dir = entry;
         scopeIn->HeapBase = symStart;
-        scopeIn->StartPtr = symStart;
         scopeIn->CurPtr = symStart;
         scopeIn->Limit = symStart + symHash->cbSymbol;
+        scopeIn->Validated = IsValidSymHeap( entry );
 
         return S_OK;
     }
@@ -301,9 +364,9 @@ namespace MagoST
 
         scopeIn->Dir = entry;
         scopeIn->HeapBase = GetCVPtr<BYTE>( entry->lfo );
-        scopeIn->StartPtr = scopeIn->HeapBase + 4;        // +4 to skip the signature
-        scopeIn->CurPtr = scopeIn->StartPtr;
+        scopeIn->CurPtr = scopeIn->HeapBase + 4;          // +4 to skip the signature
         scopeIn->Limit = GetCVPtr<BYTE>( entry->lfo ) + entry->cb;
+        scopeIn->Validated = IsValidSymHeap( entry );
 
         return S_OK;
     }
@@ -349,7 +412,8 @@ namespace MagoST
 
         if ( sym->Generic.id == 0 )
             return false;
-        if ( !ValidateCVPtr( sym, sym->Generic.len + 2 ) )
+        // every record of a validated scope is in bounds, and so is the next one
+        if ( !scopeIn->Validated && !ValidateCVPtr( sym, sym->Generic.len + 2 ) )
             return false;
         // at this point we assume that the rest of the record is in bounds
 
@@ -368,7 +432,13 @@ namespace MagoST
             || (sym->Generic.id == S_WITH32) )
         {
             // pEnd is at the same offset in all of these
-            scopeIn->CurPtr = scopeIn->HeapBase + sym->block.end;
+            BYTE*   endPtr = scopeIn->HeapBase + sym->block.end;
+
+            // a bad end that points back would make us loop forever
+            if ( !scopeIn->Validated && (endPtr <= scopeIn->CurPtr) )
+                endPtr = scopeIn->Limit;
+
+            scopeIn->CurPtr = endPtr;
 
             // we're pointing at the S_END
         }
@@ -658,7 +728,9 @@ namespace MagoST
         case S_LPROC32:
         case S_GPROC32:     symInfo = new (&privateData) ProcSymbol( *internalHandle ); break;
         case S_THUNK32:     symInfo = new (&privateData) ThunkSymbol( *internalHandle ); break;
-        case S_BLOCK32:     symInfo = new (&privateData) BlockSymbol( *internalHandle ); break;
+        case S_BLOCK32:
+        case S_WITH32:      // a with scope has the same layout as a block
+                            symInfo = new (&privateData) BlockSymbol( *internalHandle ); break;
         case S_LABEL32:     symInfo = new (&privateData) LabelSymbol( *internalHandle ); break;
         case S_REGREL32:    symInfo = new (&privateData) RegRelSymbol( *internalHandle ); break;
         case S_LTHREAD32:
@@ -704,6 +776,10 @@ namespace MagoST
 
         scopeIn->Limit = GetCVPtr<BYTE>( lastTypeOffset + 2 + ((CodeViewType*) lastTypePtr)->Generic.len );
 
+        // a bad offset table can leave either end out of bounds
+        if ( (scopeIn->StartPtr == NULL) || (scopeIn->Limit == NULL) )
+            return E_FAIL;
+
         return S_OK;
     }
 
@@ -782,8 +858,12 @@ namespace MagoST
                 scopeIn->StartPtr = internalHandle->Type + 4;
                 scopeIn->CurPtr = scopeIn->StartPtr;
                 scopeIn->CurZIndex = 0;
-                scopeIn->NextType = &DebugStore::NextTypeFList;
                 scopeIn->Limit = internalHandle->Type + type->Generic.len + 2;
+
+                if ( IsValidType( internalHandle ) )
+                    scopeIn->NextType = &DebugStore::NextTypeFList;
+                else
+                    scopeIn->NextType = &DebugStore::NextTypeCheckedFList;
             }
             break;
 
@@ -867,6 +947,16 @@ namespace MagoST
     }
 
     bool DebugStore::NextTypeFList( TypeScope& scope, TypeHandle& handle )
+    {
+        return NextField( scope, handle, false );
+    }
+
+    bool DebugStore::NextTypeCheckedFList( TypeScope& scope, TypeHandle& handle )
+    {
+        return NextField( scope, handle, true );
+    }
+
+    bool DebugStore::NextField( TypeScope& scope, TypeHandle& handle, bool checked )
     {
         TypeScopeIn*    scopeIn = (TypeScopeIn*) &scope;
         TypeHandleIn*   internalHandle = (TypeHandleIn*) &handle;
@@ -881,6 +971,9 @@ namespace MagoST
             if ( !SetFListContinuationScope( type->index.type, scopeIn ) )
                 return false;
 
+            // the continuation might not have been validated
+            checked = (scopeIn->NextType != &DebugStore::NextTypeFList);
+
             // our internal scope pointer is still pointing at the user's scope arg
             _ASSERT( (void*) scopeIn == (void*) &scope );
 
@@ -904,7 +997,18 @@ namespace MagoST
 
         // move to the next one for next time
 
-        DWORD   len = GetFieldLength( type );
+        DWORD   len = 0;
+
+        if ( !checked )
+        {
+            len = GetFieldLength( type );
+        }
+        else if ( !GetFieldLength( type, (DWORD) (scopeIn->Limit - scopeIn->CurPtr), len ) )
+        {
+            // the field runs off the end of the list, so end it here
+            scopeIn->Limit = scopeIn->CurPtr;
+            return false;
+        }
 
         scopeIn->CurPtr += len;
         scopeIn->CurZIndex++;
@@ -1236,10 +1340,7 @@ namespace MagoST
             return false;
 
         const uint16_t      zCompIx = compIndex - 1;
-        OMFSourceModule*    srcMod = NULL;
-
-        if ( mCompilandDetails[zCompIx].SourceEntry != NULL )
-            srcMod = GetCVPtr<OMFSourceModule>( mCompilandDetails[zCompIx].SourceEntry->lfo );
+        OMFSourceModule*    srcMod = GetSourceModule( zCompIx );
 
         if ( srcMod == NULL )
             return false;
@@ -1270,103 +1371,8 @@ namespace MagoST
         segInfo.Offsets = offsetTable;
         segInfo.LineNumbers = numberTable;
 
-        FixEndOffset( segInfo.Offsets[segInfo.LineCount - 1], segInfo.End );
-        return true;
-    }
-
-    bool    DebugStore::FindCompilandFileSegmentByLine( uint16_t line, uint16_t compIndex, uint16_t fileIndex, uint16_t firstSegIndex, FileSegmentInfo& segInfo )
-    {
-        if ( (compIndex < 1) || (compIndex > mCompilandCount) )
-            return false;
-
-        const uint16_t      zCompIx = compIndex - 1;
-        OMFSourceModule*    srcMod = NULL;
-
-        if ( mCompilandDetails[zCompIx].SourceEntry != NULL )
-            srcMod = GetCVPtr<OMFSourceModule>( mCompilandDetails[zCompIx].SourceEntry->lfo );
-
-        if ( srcMod == NULL )
-            return false;
-
-        DWORD*      filePtrTable = (DWORD*) (((BYTE*) srcMod) + 4);
-
-        if ( fileIndex >= srcMod->cFile )
-            return false;
-
-        OMFSourceFile*  file = (OMFSourceFile*) ((BYTE*) srcMod + filePtrTable[fileIndex]);
-
-        DWORD*          srcLinePtrTable = (DWORD*) ((BYTE*) file + 4);
-        OffsetPair*     startEndTable = (OffsetPair*) (srcLinePtrTable + file->cSeg);
-
-        uint16_t    zClosestAboveSegIx = 0xFFFF;
-        uint16_t    zClosestBelowSegIx = 0xFFFF;
-        int         closestDistAbove = INT_MAX;
-        int         closestDistBelow = INT_MAX;
-
-        for ( uint16_t zSegIx = firstSegIndex; zSegIx < file->cSeg && closestDistAbove > 0; zSegIx++ )
-        {
-            OMFSourceLine*  srcLine = (OMFSourceLine*) ((BYTE*) srcMod + srcLinePtrTable[zSegIx]);
-
-            DWORD*  offsetTable = (DWORD*) ((BYTE*) srcLine + 4);
-            WORD*   numberTable = (WORD*) (offsetTable + srcLine->cLnOff);
-
-            // line numbers don't have to be ascending 
-            for ( uint16_t zLn = 0; zLn < srcLine->cLnOff; zLn++ )
-            {
-                if ( numberTable[ zLn ] <= line )
-                {
-                    int dist = line - numberTable[ zLn ];
-
-                    if ( dist < closestDistAbove )
-                    {
-                        closestDistAbove = dist;
-                        zClosestAboveSegIx = zSegIx;
-                        if( dist == 0 )
-                            break;
-                    }
-                }
-                else if ( numberTable[ zLn ] > line )
-                {
-                    int dist = numberTable[ zLn ] - line;
-
-                    if ( dist < closestDistBelow )
-                    {
-                        closestDistBelow = dist;
-                        zClosestBelowSegIx = zSegIx;
-                    }
-                }
-            }
-        }
-
-        if ( (closestDistAbove == INT_MAX) && (closestDistBelow == INT_MAX) )
-            return false;
-
-        // at this point we know we didn't have a perfect match, 
-        // so pick the best one above or below our target line
-
-        uint16_t    zClosestSegIx = 0;
-
-        if ( closestDistAbove < closestDistBelow )
-            zClosestSegIx = zClosestAboveSegIx;
-        else
-            zClosestSegIx = zClosestBelowSegIx;
-
-        {
-            OMFSourceLine*  srcLine = (OMFSourceLine*) ((BYTE*) srcMod + srcLinePtrTable[zClosestSegIx]);
-
-            DWORD*  offsetTable = (DWORD*) ((BYTE*) srcLine + 4);
-            WORD*   numberTable = (WORD*) (offsetTable + srcLine->cLnOff);
-
-            segInfo.SegmentIndex = srcLine->Seg;
-            segInfo.SegmentInstance = zClosestSegIx;
-            segInfo.LineCount = srcLine->cLnOff;
-            segInfo.LineNumbers = numberTable;
-            segInfo.Offsets = offsetTable;
-            segInfo.Start = startEndTable[zClosestSegIx].first;
-            segInfo.End = startEndTable[zClosestSegIx].second;
+        if ( segInfo.LineCount > 0 )
             FixEndOffset( segInfo.Offsets[segInfo.LineCount - 1], segInfo.End );
-        }
-
         return true;
     }
 
@@ -1396,18 +1402,20 @@ namespace MagoST
 
     bool DebugStore::FindLine( WORD seg, uint32_t offset, LineNumber& lineNumber )
     {
-        uint16_t        compIx = 0;
-        uint16_t        fileIx = 0;
-        FileSegmentInfo fileSegInfo = { 0 };
-        int             i = 0;
+        const LineInterval* interval = NULL;
+        FileSegmentInfo     fileSegInfo = { 0 };
+        int                 i = 0;
+
+        if ( !FindLineInterval( seg, offset, interval ) )
+            return false;
 
-        if ( !FindCompilandFileSegmentByOffset( seg, offset, compIx, fileIx, fileSegInfo ) )
+        if ( !GetFileSegment( interval->CompilandIndex, interval->FileIndex, interval->SegmentInstance, fileSegInfo ) )
             return false;
 
         if ( !BinarySearch<DWORD>( offset, fileSegInfo.Offsets, fileSegInfo.LineCount, i ) )
             return false;
 
-        SetLineNumberFromSegment( compIx, fileIx, fileSegInfo, (uint16_t) i, lineNumber );
+        SetLineNumberFromSegment( interval->CompilandIndex, interval->FileIndex, fileSegInfo, (uint16_t) i, lineNumber );
         return true;
     }
 
@@ -1445,271 +1453,846 @@ namespace MagoST
 
     bool DebugStore::FindLineByNum( uint16_t compIndex, uint16_t fileIndex, uint16_t line, LineNumber& lineNumber )
     {
-        FileSegmentInfo fileSegInfo = { 0 };
-
-        if ( !FindCompilandFileSegmentByLine( line, compIndex, fileIndex, 0, fileSegInfo ) )
-            return false;
+        const LineNumber*   lines = NULL;
+        uint32_t            lineCount = 0;
 
-        if ( fileSegInfo.LineCount == 0 )
+        if ( !FindLineSpanByNum( compIndex, fileIndex, line, lines, lineCount ) )
             return false;
 
-        #undef max
-        int     lastLine = 0;
-        int     closestDist = std::numeric_limits<int>::max();
-        int     lastLineIndex = -1;
-        int     closestLineIndex = -1;
-
-        for ( int i = 0; i < fileSegInfo.LineCount; i++ )
-        {
-            int curLine = fileSegInfo.LineNumbers[i];
+        lineNumber = lines[0];
+        return true;
+    }
 
-            if ( curLine > lastLine )
-            {
-                lastLine = curLine;
-                lastLineIndex = i;
-            }
+    bool DebugStore::FindNextLineByNum( uint16_t compIndex, uint16_t fileIndex, uint16_t line, LineNumber& lineNumber )
+    {
+        UNREFERENCED_PARAMETER( line );
 
-            if ( (curLine >= line) && ((curLine - line) < closestDist) )
-            {
-                closestDist = curLine - line;
-                closestLineIndex = i;
-            }
-        }
+        FileLineIndex*  index = GetFileLineIndex( compIndex, fileIndex );
 
-        // a line was found after or at the target line
-        // it's the closest one, so use it
+        if ( index == NULL )
+            return false;
 
-        if ( closestLineIndex >= 0 )
-        {
-            SetLineNumberFromSegment( compIndex, fileIndex, fileSegInfo, (uint16_t) closestLineIndex, lineNumber );
-        }
-        else
-        {
-            // there are lines, so one of them has to be the last one
-            _ASSERT( lastLineIndex >= 0 );
+        // continue from the previous result, which is in the index
+        std::vector<LineNumber>::const_iterator it = 
+            std::upper_bound( index->Lines.begin(), index->Lines.end(), lineNumber, LineNumberLess );
 
-            SetLineNumberFromSegment( compIndex, fileIndex, fileSegInfo, (uint16_t) lastLineIndex, lineNumber );
-        }
+        if ( (it == index->Lines.end()) || (it->Number != lineNumber.Number) )
+            return false;
 
+        lineNumber = *it;
         return true;
     }
 
-    bool DebugStore::FindNextLineByNum( uint16_t compIndex, uint16_t fileIndex, uint16_t line, LineNumber& lineNumber )
+    bool DebugStore::FindLineSpanByNum( 
+        uint16_t compIndex, 
+        uint16_t fileIndex, 
+        uint16_t line, 
+        const LineNumber*& lines, 
+        uint32_t& lineCount )
     {
-        FileSegmentInfo fileSegInfo = { 0 };
+        FileLineIndex*  index = GetFileLineIndex( compIndex, fileIndex );
 
-        lineNumber.LineIndex++; // continue from previous result
-        while( FindCompilandFileSegmentByLine( line, compIndex, fileIndex, lineNumber.SegmentInstanceIndex, fileSegInfo ) )
-        {
-            for ( int i = lineNumber.LineIndex; i < fileSegInfo.LineCount; i++ )
-            {
-                int curLine = fileSegInfo.LineNumbers[i];
-                if ( curLine == lineNumber.Number )
-                {
-                    SetLineNumberFromSegment( compIndex, fileIndex, fileSegInfo, (uint16_t) i, lineNumber );
-                    return true;
-                }
-            }
-            lineNumber.SegmentInstanceIndex++;
-            lineNumber.LineIndex = 0;
-        }
-        return false;
+        if ( index == NULL )
+            return false;
+
+        const LineNumber*   first = FindClosestLineByNum( *index, line );
+
+        if ( first == NULL )
+            return false;
+
+        // the rest of the addresses of the same line follow it
+        const LineNumber*   limit = &index->Lines[0] + index->Lines.size();
+        const LineNumber*   last = first + 1;
+
+        while ( (last < limit) && (last->Number == first->Number) )
+            last++;
+
+        lines = first;
+        lineCount = (uint32_t) (last - first);
+        return true;
     }
 
     bool DebugStore::FindLines( bool exactMatch, const char* fileName, size_t fileNameLen, uint16_t reqLineStart, uint16_t reqLineEnd, 
-                                std::list<LineNumber>& lines )
+                                std::vector<LineNumber>& lines )
     {
-        for ( uint16_t compIx = 1; compIx <= mCompilandCount; compIx++ )
+        FileNameEntry   key = { 0 };
+
+        key.Hash = GetFileNameHash( fileName, fileNameLen );
+
+        // the entries are sorted by compiland and file for each hash, 
+        // so lines come out in the same order as a walk of all files
+        std::pair<const FileNameEntry*, const FileNameEntry*> range =
+            std::equal_range( mFileNameIndex, mFileNameIndex + mFileNameCount, key, FileNameHashLess );
+
+        for ( const FileNameEntry* it = range.first; it != range.second; it++ )
         {
-            MagoST::CompilandInfo   compInfo = { 0 };
+            uint16_t            compIx = it->CompilandIndex;
+            uint16_t            fileIx = it->FileIndex;
+            MagoST::FileInfo    fileInfo = { 0 };
+            bool                matches = false;
 
-            HRESULT hr = GetCompilandInfo( compIx, compInfo );
+            HRESULT hr = GetFileInfo( compIx, fileIx, fileInfo );
             if ( FAILED( hr ) )
                 continue;
 
-            for ( uint16_t fileIx = 0; fileIx < compInfo.FileCount; fileIx++ )
-            {
-                MagoST::FileInfo    fileInfo = { 0 };
-                bool                matches = false;
-
-                hr = GetFileInfo( compIx, fileIx, fileInfo );
-                if ( FAILED( hr ) )
-                    continue;
+            if ( exactMatch )
+                matches = ExactFileNameMatch( fileName, fileNameLen, fileInfo.Name.ptr, fileInfo.Name.length );
+            else
+                matches = PartialFileNameMatch( fileName, fileNameLen, fileInfo.Name.ptr, fileInfo.Name.length );
 
-                if ( exactMatch )
-                    matches = ExactFileNameMatch( fileName, fileNameLen, fileInfo.Name.ptr, fileInfo.Name.length );
-                else
-                    matches = PartialFileNameMatch( fileName, fileNameLen, fileInfo.Name.ptr, fileInfo.Name.length );
+            if ( !matches )
+                continue;
 
-                if ( !matches )
-                    continue;
+            const LineNumber*   fileLines = NULL;
+            uint32_t            fileLineCount = 0;
 
-                MagoST::LineNumber  line = { 0 };
-                if ( !FindLineByNum( compIx, fileIx, (uint16_t) reqLineStart, line ) )
-                    continue;
+            if ( !FindLineSpanByNum( compIx, fileIx, reqLineStart, fileLines, fileLineCount ) )
+                continue;
 
-                // do the line ranges overlap?
-                if ( ((line.Number <= reqLineEnd) && (line.NumberEnd >= reqLineStart)) )
-                {
-                    do
-                    {
-                        lines.push_back (line);
-                    }
-                    while( FindNextLineByNum( compIx, fileIx, (uint16_t) reqLineStart, line ) );
-                }
+            // do the line ranges overlap?
+            if ( ((fileLines[0].Number <= reqLineEnd) && (fileLines[0].NumberEnd >= reqLineStart)) )
+            {
+                lines.insert( lines.end(), fileLines, fileLines + fileLineCount );
             }
         }
         return lines.size() > 0;
     }
 
-    bool DebugStore::FindCompilandFileSegmentByOffset( WORD seg, DWORD offset, uint16_t& compIndex, uint16_t& fileIndex, FileSegmentInfo& fileSegInfo )
-    {
-        uint32_t    compCount = 0;
+    ///////////////////////////////////////////////////////////////////////////
+    // Address to line index
+    //
+    // FindLine used to walk every compiland, segment contribution, source 
+    // file and file segment instance to find the one that holds an address.
+    // Now all of those ranges are flattened once into a table sorted by 
+    // segment and start offset, so that a lookup is a binary search.
+    //
+    // Ranges can overlap. When more than one contains an address, the one 
+    // that the old walk would have found first wins: lowest compiland, 
+    // then file, then segment instance.
 
-        GetCompilandCount( compCount );
+    HRESULT DebugStore::BuildLineIndex()
+    {
+        mLineIntervalStore.clear();
+        mLineIntervalMaxEndStore.clear();
 
-        for ( uint16_t zCompIx = 0; zCompIx < compCount; zCompIx++ )
+        for ( uint16_t zCompIx = 0; zCompIx < mCompilandCount; zCompIx++ )
         {
+            OMFDirEntry*    srcEntry = mCompilandDetails[zCompIx].SourceEntry;
+
             // no source, no files
-            if ( mCompilandDetails[ zCompIx ].SourceEntry == NULL )
+            if ( srcEntry == NULL )
                 continue;
 
-            OMFDirEntry*        entry = &mDirs[zCompIx];
-            OMFModule*          mod = GetCVPtr<OMFModule>( entry->lfo );
-            OMFSegDesc*         segDescTable = NULL;
+            OMFDirEntry*    entry = &mDirs[zCompIx];
+            OMFModule*      mod = GetCVPtr<OMFModule>( entry->lfo );
 
             if ( mod == NULL )
                 continue;
 
-            segDescTable = (OMFSegDesc*) (mod + 1);
+            OMFSegDesc*     segDescTable = GetCVPtr<OMFSegDesc>( 
+                entry->lfo + sizeof( OMFModule ), 
+                mod->cSeg * sizeof( OMFSegDesc ) );
+
+            if ( segDescTable == NULL )
+                continue;
 
             for ( uint16_t modSegIx = 0; modSegIx < mod->cSeg; modSegIx++ )
             {
-                if ( (segDescTable[modSegIx].Seg == seg) 
-                    && (offset >= segDescTable[modSegIx].Off)
-                    && ((offset - segDescTable[modSegIx].Off + 1) <= segDescTable[modSegIx].cbSeg) )
-                {
-                    if ( FindFileSegment( seg, offset, zCompIx + 1, fileIndex, fileSegInfo ) )
-                    {
-                        compIndex = zCompIx + 1;
-                        return true;
-                    }
-                    break;
-                }
+                const OMFSegDesc&   segDesc = segDescTable[modSegIx];
+
+                if ( segDesc.cbSeg == 0 )
+                    continue;
+
+                AddLineIntervals( 
+                    zCompIx + 1, 
+                    srcEntry, 
+                    segDesc.Seg, 
+                    segDesc.Off, 
+                    segDesc.Off + segDesc.cbSeg - 1 );
             }
         }
 
-        return false;
+        std::sort( mLineIntervalStore.begin(), mLineIntervalStore.end(), LineIntervalLess );
+
+        // trim the excess capacity, the table lives as long as the store
+        std::vector<LineInterval>( mLineIntervalStore ).swap( mLineIntervalStore );
+
+        mLineIntervalMaxEndStore.resize( mLineIntervalStore.size() );
+
+        for ( size_t i = 0; i < mLineIntervalStore.size(); i++ )
+        {
+            DWORD   maxEnd = mLineIntervalStore[i].End;
+
+            if ( (i > 0) 
+                && (mLineIntervalStore[i - 1].Segment == mLineIntervalStore[i].Segment)
+                && (mLineIntervalMaxEndStore[i - 1] > maxEnd) )
+                maxEnd = mLineIntervalMaxEndStore[i - 1];
+
+            mLineIntervalMaxEndStore[i] = maxEnd;
+        }
+
+        return S_OK;
     }
 
-    bool    DebugStore::FindFileSegment( WORD seg, DWORD offset, uint16_t compIndex, uint16_t& fileIndex, FileSegmentInfo& fileSegInfo )
+    void DebugStore::AddLineIntervals( 
+        uint16_t compIndex, 
+        OMFDirEntry* srcEntry, 
+        WORD seg, 
+        DWORD modStart, 
+        DWORD modEnd )
     {
-        if ( (compIndex < 1) || (compIndex > mCompilandCount) )
-            return false;
+        OMFSourceModule*    srcMod = GetCVPtr<OMFSourceModule>( srcEntry->lfo );
 
-        const uint16_t      zCompIx = compIndex - 1;
-        OMFSourceModule*    srcMod = NULL;
+        if ( srcMod == NULL )
+            return;
 
-        if ( mCompilandDetails[zCompIx].SourceEntry != NULL )
-            srcMod = GetCVPtr<OMFSourceModule>( mCompilandDetails[zCompIx].SourceEntry->lfo );
+        DWORD*      filePtrTable = GetCVPtr<DWORD>( 
+            srcEntry->lfo + 4, 
+            (srcMod->cFile * 4) + (srcMod->cSeg * (sizeof( OffsetPair ) + 2)) );
 
-        if ( srcMod == NULL )
-            return false;
+        if ( filePtrTable == NULL )
+            return;
 
-        DWORD*      filePtrTable = (DWORD*) (((BYTE*) srcMod) + 4);
         OffsetPair* offsetTable = (OffsetPair*) (filePtrTable + srcMod->cFile);
         WORD*       segTable = (WORD*) (offsetTable + srcMod->cSeg);
 
-        for ( uint16_t zModSegIx = 0; zModSegIx < srcMod->cSeg; zModSegIx++ )
+        // only the first source module range for the segment is considered
+        uint16_t    zModSegIx = 0;
+
+        for ( ; zModSegIx < srcMod->cSeg; zModSegIx++ )
         {
-            if ( segTable[zModSegIx] != seg )
-                continue;
+            if ( segTable[zModSegIx] == seg )
+                break;
+        }
 
-            if ( ((offsetTable[zModSegIx].first == 0) && (offsetTable[zModSegIx].second == 0))
-                || ((offset >= offsetTable[zModSegIx].first) && (offset <= offsetTable[zModSegIx].second)) )
-            {
-                for ( uint16_t zFileIx = 0; zFileIx < srcMod->cFile; zFileIx++ )
-                {
-                    OMFSourceFile*  file = (OMFSourceFile*) ((BYTE*) srcMod + filePtrTable[zFileIx]);
+        if ( zModSegIx == srcMod->cSeg )
+            return;
 
-                    if ( FindFileSegment( seg, offset, srcMod, file, fileSegInfo ) )
-                    {
-                        fileIndex = zFileIx;
-                        return true;
-                    }
-                }
-            }
-            break;
-        }
+        const OffsetPair&   modRange = offsetTable[zModSegIx];
 
-        return false;
-    }
+        if ( (modRange.first != 0) || (modRange.second != 0) )
+        {
+            modStart = std::max( modStart, modRange.first );
+            modEnd = std::min( modEnd, modRange.second );
 
-    bool DebugStore::FindFileSegment( 
-        WORD seg, 
-        DWORD offset, 
-        OMFSourceModule* srcMod, 
-        OMFSourceFile* file, 
-        FileSegmentInfo& fileSegInfo )
-    {
-        DWORD*          srcLinePtrTable = (DWORD*) ((BYTE*) file + 4);
-        OffsetPair*     startEndTable = (OffsetPair*) (srcLinePtrTable + file->cSeg);
+            if ( modStart > modEnd )
+                return;
+        }
 
-        for ( uint16_t zSegIx = 0; zSegIx < file->cSeg; zSegIx++ )
+        for ( uint16_t zFileIx = 0; zFileIx < srcMod->cFile; zFileIx++ )
         {
-            OMFSourceLine*  line = (OMFSourceLine*) ((BYTE*) srcMod + srcLinePtrTable[zSegIx]);
+            offset_t        fileOffset = srcEntry->lfo + filePtrTable[zFileIx];
+            OMFSourceFile*  file = GetCVPtr<OMFSourceFile>( fileOffset );
 
-            if ( line->Seg != seg )
+            if ( file == NULL )
                 continue;
 
-            DWORD*  offsetTable = (DWORD*) ((BYTE*) line + 4);
-            WORD*   numberTable = (WORD*) (offsetTable + line->cLnOff);
+            DWORD*      srcLinePtrTable = GetCVPtr<DWORD>( 
+                fileOffset + 4, 
+                file->cSeg * (4 + sizeof( OffsetPair )) );
 
-            DWORD end = startEndTable[zSegIx].second;
-            FixEndOffset( offsetTable[line->cLnOff - 1], end );
+            if ( srcLinePtrTable == NULL )
+                continue;
+
+            OffsetPair* startEndTable = (OffsetPair*) (srcLinePtrTable + file->cSeg);
 
-            if ( ((startEndTable[zSegIx].first == 0) && (startEndTable[zSegIx].second == 0))
-                || ((startEndTable[zSegIx].first <= offset) && (end >= offset)) )
+            for ( uint16_t zSegIx = 0; zSegIx < file->cSeg; zSegIx++ )
             {
-                fileSegInfo.SegmentIndex = line->Seg;
-                fileSegInfo.SegmentInstance = zSegIx;
-                fileSegInfo.Start = startEndTable[zSegIx].first;
-                fileSegInfo.End = end;
-                fileSegInfo.LineCount = line->cLnOff;
-                fileSegInfo.LineNumbers = numberTable;
-                fileSegInfo.Offsets = offsetTable;
-                return true;
+                offset_t        lineOffset = srcEntry->lfo + srcLinePtrTable[zSegIx];
+                OMFSourceLine*  srcLine = GetCVPtr<OMFSourceLine>( lineOffset, 4 );
+
+                if ( (srcLine == NULL) || (srcLine->Seg != seg) || (srcLine->cLnOff == 0) )
+                    continue;
+
+                DWORD*  lineOffsets = GetCVPtr<DWORD>( lineOffset + 4, srcLine->cLnOff * (4 + 2) );
+
+                if ( lineOffsets == NULL )
+                    continue;
+
+                LineInterval    interval = { 0 };
+
+                interval.Segment = seg;
+                interval.CompilandIndex = compIndex;
+                interval.FileIndex = zFileIx;
+                interval.SegmentInstance = zSegIx;
+                interval.Start = modStart;
+                interval.End = modEnd;
+
+                if ( (startEndTable[zSegIx].first != 0) || (startEndTable[zSegIx].second != 0) )
+                {
+                    DWORD   end = startEndTable[zSegIx].second;
+                    FixEndOffset( lineOffsets[srcLine->cLnOff - 1], end );
+
+                    interval.Start = std::max( modStart, startEndTable[zSegIx].first );
+                    interval.End = std::min( modEnd, end );
+
+                    if ( interval.Start > interval.End )
+                        continue;
+                }
+
+                mLineIntervalStore.push_back( interval );
             }
-            // don't leave yet, because the addr might be in another file/segment instance
         }
-
-        return false;
     }
 
-    HRESULT DebugStore::GetSymbolBytePtr( SymHandle handle, BYTE* bytes, DWORD& size )
+    bool DebugStore::FindLineInterval( WORD seg, DWORD offset, const LineInterval*& interval )
     {
-        SymHandleIn*    internalHandle = (SymHandleIn*) &handle;
+        LineInterval    key = { 0 };
 
-        // 4 bytes, at least as much as the generic symbol node: length and tag
-        if ( !ValidateSymbol( internalHandle, 4 ) )
-            return E_INVALIDARG;
+        key.Segment = seg;
+        key.Start = offset;
 
-        CodeViewSymbol*   sym = internalHandle->Sym;
-        BYTE*             symBytes = (BYTE*) internalHandle->Sym;
-        DWORD             len = sym->Generic.len + 2;
+        const LineInterval* it = 
+            std::upper_bound( mLineIntervals, mLineIntervals + mLineIntervalCount, key, LineIntervalLess );
 
-        if ( (bytes == NULL) || (size == 0) )
+        interval = NULL;
+
+        // walk back over the intervals starting at or before the offset, 
+        // until none of the remaining ones can reach it
+        for ( size_t i = it - mLineIntervals; i > 0; i-- )
         {
-            size = len;
-            return E_INSUFFICIENT_BUFFER;
-        }
+            const LineInterval& cur = mLineIntervals[i - 1];
 
-        if ( size > len )
-            size = len;
+            if ( (cur.Segment != seg) || (mLineIntervalMaxEnd[i - 1] < offset) )
+                break;
 
-        for ( DWORD i = 0; i < size; i++ )
-        {
-            bytes[i] = symBytes[i];
+            if ( (cur.End >= offset) 
+                && ((interval == NULL) || LineIntervalPrecedes( cur, *interval )) )
+                interval = &cur;
+        }
+
+        return interval != NULL;
+    }
+
+    bool DebugStore::LineIntervalLess( const LineInterval& left, const LineInterval& right )
+    {
+        if ( left.Segment != right.Segment )
+            return left.Segment < right.Segment;
+
+        return left.Start < right.Start;
+    }
+
+    bool DebugStore::LineIntervalPrecedes( const LineInterval& left, const LineInterval& right )
+    {
+        if ( left.CompilandIndex != right.CompilandIndex )
+            return left.CompilandIndex < right.CompilandIndex;
+        if ( left.FileIndex != right.FileIndex )
+            return left.FileIndex < right.FileIndex;
+
+        return left.SegmentInstance < right.SegmentInstance;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Line number index
+    //
+    // The lines of a file are spread over its segment instances, and the line 
+    // numbers of an instance don't have to be ascending. The first time a file 
+    // is searched by line number, all of its lines are gathered and sorted, so 
+    // that searches and the addresses of one line are contiguous.
+
+    void DebugStore::SetFileLineIndexSlots()
+    {
+        uint32_t    slotCount = 0;
+
+        mFileSlotStart.resize( mCompilandCount + 1 );
+
+        for ( uint16_t zCompIx = 0; zCompIx < mCompilandCount; zCompIx++ )
+        {
+            OMFSourceModule*    srcMod = GetSourceModule( zCompIx );
+
+            mFileSlotStart[zCompIx] = slotCount;
+
+            if ( srcMod != NULL )
+                slotCount += srcMod->cFile;
+        }
+
+        mFileSlotStart[mCompilandCount] = slotCount;
+        mFileLineIndexes.resize( slotCount, NULL );
+    }
+
+    DebugStore::FileLineIndex* DebugStore::GetFileLineIndex( uint16_t compIndex, uint16_t fileIndex )
+    {
+        if ( (compIndex < 1) || (compIndex > mCompilandCount) )
+            return NULL;
+
+        const uint16_t  zCompIx = compIndex - 1;
+        uint32_t        slot = mFileSlotStart[zCompIx] + fileIndex;
+
+        if ( slot >= mFileSlotStart[zCompIx + 1] )
+            return NULL;
+
+        // with VC++, reading through volatile has acquire semantics, so the 
+        // index it points to is seen whole
+        FileLineIndex* volatile*    slotPtr = (FileLineIndex* volatile*) &mFileLineIndexes[slot];
+        FileLineIndex*              index = *slotPtr;
+
+        if ( index == NULL )
+        {
+            UniquePtr<FileLineIndex>    newIndex( new FileLineIndex() );
+
+            if ( newIndex.Get() == NULL )
+                return NULL;
+
+            if ( !BuildFileLineIndex( compIndex, fileIndex, *newIndex.Get() ) )
+                return NULL;
+
+            // another thread could have built the same one in the meantime, 
+            // then use the one that got there first
+            index = (FileLineIndex*) InterlockedCompareExchangePointer( 
+                (PVOID volatile*) slotPtr, newIndex.Get(), NULL );
+
+            if ( index == NULL )
+                index = newIndex.Detach();
+        }
+
+        if ( index->Lines.size() == 0 )
+            return NULL;
+
+        return index;
+    }
+
+    bool DebugStore::BuildFileLineIndex( uint16_t compIndex, uint16_t fileIndex, FileLineIndex& index )
+    {
+        FileInfo    fileInfo = { 0 };
+
+        if ( FAILED( GetFileInfo( compIndex, fileIndex, fileInfo ) ) )
+            return false;
+
+        for ( uint16_t zSegIx = 0; zSegIx < fileInfo.SegmentCount; zSegIx++ )
+        {
+            FileSegmentInfo segInfo = { 0 };
+
+            if ( !GetFileSegment( compIndex, fileIndex, zSegIx, segInfo ) )
+                continue;
+
+            for ( uint16_t zLn = 0; zLn < segInfo.LineCount; zLn++ )
+            {
+                LineNumber  lineNumber = { 0 };
+
+                SetLineNumberFromSegment( compIndex, fileIndex, segInfo, zLn, lineNumber );
+                index.Lines.push_back( lineNumber );
+            }
+        }
+
+        std::sort( index.Lines.begin(), index.Lines.end(), LineNumberLess );
+
+        index.BySegment.resize( index.Lines.size() );
+
+        for ( uint32_t i = 0; i < index.Lines.size(); i++ )
+        {
+            index.BySegment[i].SegmentInstance = index.Lines[i].SegmentInstanceIndex;
+            index.BySegment[i].Number = index.Lines[i].Number;
+            index.BySegment[i].LineIndex = index.Lines[i].LineIndex;
+            index.BySegment[i].Position = i;
+        }
+
+        std::sort( index.BySegment.begin(), index.BySegment.end(), SegmentLineLess );
+
+        return true;
+    }
+
+    // Finds the line that FindLineByNum has always returned: look for the 
+    // segment instance with the line closest to the target, on either side; 
+    // then in that instance, the closest line at or after the target, else 
+    // the last line. The last line can be the start of a statement that 
+    // spans the target.
+
+    const LineNumber* DebugStore::FindClosestLineByNum( const FileLineIndex& index, uint16_t line )
+    {
+        const std::vector<LineNumber>&  lines = index.Lines;
+        LineNumber                      key = { 0 };
+
+        key.Number = line;
+
+        std::vector<LineNumber>::const_iterator itAfter = 
+            std::upper_bound( lines.begin(), lines.end(), key, LineNumberNumLess );
+
+        const LineNumber*   closestAtOrBefore = NULL;
+        const LineNumber*   closestAfter = NULL;
+
+        if ( itAfter != lines.begin() )
+        {
+            // the first instance that holds the highest line at or before the target
+            key.Number = (itAfter - 1)->Number;
+            closestAtOrBefore = &*std::lower_bound( lines.begin(), itAfter, key, LineNumberNumLess );
+        }
+
+        if ( itAfter != lines.end() )
+            closestAfter = &*itAfter;
+
+        uint16_t    segInstance = 0;
+
+        if ( (closestAtOrBefore != NULL) 
+            && ((closestAfter == NULL) 
+                || ((line - closestAtOrBefore->Number) < (closestAfter->Number - line))) )
+            segInstance = closestAtOrBefore->SegmentInstanceIndex;
+        else
+            segInstance = closestAfter->SegmentInstanceIndex;
+
+        SegmentLine     segKey = { 0 };
+
+        segKey.SegmentInstance = segInstance;
+
+        std::vector<SegmentLine>::const_iterator    segBegin = 
+            std::lower_bound( index.BySegment.begin(), index.BySegment.end(), segKey, SegmentLineLess );
+
+        segKey.SegmentInstance = segInstance + 1;
+
+        std::vector<SegmentLine>::const_iterator    segEnd = 
+            std::lower_bound( segBegin, index.BySegment.end(), segKey, SegmentLineLess );
+
+        _ASSERT( segBegin != segEnd );
+
+        segKey.SegmentInstance = segInstance;
+        segKey.Number = line;
+
+        std::vector<SegmentLine>::const_iterator    itLine = 
+            std::lower_bound( segBegin, segEnd, segKey, SegmentLineLess );
+
+        if ( itLine == segEnd )
+        {
+            // no line at or after the target in this instance, so take the first of the last line
+            segKey.Number = (segEnd - 1)->Number;
+
+            itLine = std::lower_bound( segBegin, segEnd, segKey, SegmentLineLess );
+        }
+
+        return &lines[itLine->Position];
+    }
+
+    bool DebugStore::LineNumberLess( const LineNumber& left, const LineNumber& right )
+    {
+        if ( left.Number != right.Number )
+            return left.Number < right.Number;
+        if ( left.SegmentInstanceIndex != right.SegmentInstanceIndex )
+            return left.SegmentInstanceIndex < right.SegmentInstanceIndex;
+
+        return left.LineIndex < right.LineIndex;
+    }
+
+    bool DebugStore::LineNumberNumLess( const LineNumber& left, const LineNumber& right )
+    {
+        return left.Number < right.Number;
+    }
+
+    bool DebugStore::SegmentLineLess( const SegmentLine& left, const SegmentLine& right )
+    {
+        if ( left.SegmentInstance != right.SegmentInstance )
+            return left.SegmentInstance < right.SegmentInstance;
+        if ( left.Number != right.Number )
+            return left.Number < right.Number;
+
+        return left.LineIndex < right.LineIndex;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // File name index
+    //
+    // Binding a breakpoint looks for a file by name in every compiland. 
+    // Instead of matching the name against every file, only the files whose 
+    // last path component hashes the same are checked.
+
+    HRESULT DebugStore::BuildFileNameIndex()
+    {
+        mFileNameStore.clear();
+
+        for ( uint16_t compIx = 1; compIx <= mCompilandCount; compIx++ )
+        {
+            MagoST::CompilandInfo   compInfo = { 0 };
+
+            HRESULT hr = GetCompilandInfo( compIx, compInfo );
+            if ( FAILED( hr ) )
+                continue;
+
+            for ( uint16_t fileIx = 0; fileIx < compInfo.FileCount; fileIx++ )
+            {
+                MagoST::FileInfo    fileInfo = { 0 };
+                FileNameEntry       entry = { 0 };
+
+                hr = GetFileInfo( compIx, fileIx, fileInfo );
+                if ( FAILED( hr ) )
+                    continue;
+
+                entry.Hash = GetFileNameHash( fileInfo.Name.ptr, fileInfo.Name.length );
+                entry.CompilandIndex = compIx;
+                entry.FileIndex = fileIx;
+
+                mFileNameStore.push_back( entry );
+            }
+        }
+
+        std::sort( mFileNameStore.begin(), mFileNameStore.end(), FileNameEntryLess );
+        std::vector<FileNameEntry>( mFileNameStore ).swap( mFileNameStore );
+
+        return S_OK;
+    }
+
+    bool DebugStore::FileNameEntryLess( const FileNameEntry& left, const FileNameEntry& right )
+    {
+        if ( left.Hash != right.Hash )
+            return left.Hash < right.Hash;
+        if ( left.CompilandIndex != right.CompilandIndex )
+            return left.CompilandIndex < right.CompilandIndex;
+
+        return left.FileIndex < right.FileIndex;
+    }
+
+    bool DebugStore::FileNameHashLess( const FileNameEntry& left, const FileNameEntry& right )
+    {
+        return left.Hash < right.Hash;
+    }
+
+    void DebugStore::GetLineIndexStats( LineIndexStats& stats )
+    {
+        // a saved index is mapped, not allocated, so it doesn't count here
+        size_t  bytes = (mMarkBitStore.capacity() * sizeof( uint32_t ))
+            + (mLineIntervalStore.capacity() * sizeof( LineInterval ))
+            + (mLineIntervalMaxEndStore.capacity() * sizeof( DWORD ))
+            + (mFileNameStore.capacity() * sizeof( FileNameEntry ));
+
+        for ( size_t i = 0; i < mFileLineIndexes.size(); i++ )
+        {
+            FileLineIndex*  index = *(FileLineIndex* volatile*) &mFileLineIndexes[i];
+
+            if ( index != NULL )
+            {
+                bytes += (index->Lines.capacity() * sizeof( LineNumber ))
+                    + (index->BySegment.capacity() * sizeof( SegmentLine ));
+            }
+        }
+
+        stats.IntervalCount = mLineIntervalCount;
+        stats.FileNameCount = mFileNameCount;
+        stats.MemoryBytes = (uint32_t) bytes;
+    }
+
+    void DebugStore::SetMarkBitsView()
+    {
+        mMarkBits = mMarkBitStore.empty() ? NULL : &mMarkBitStore[0];
+    }
+
+    void DebugStore::SetLineIndexViews()
+    {
+        mLineIntervals = mLineIntervalStore.empty() ? NULL : &mLineIntervalStore[0];
+        mLineIntervalMaxEnd = mLineIntervalMaxEndStore.empty() ? NULL : &mLineIntervalMaxEndStore[0];
+        mLineIntervalCount = (uint32_t) mLineIntervalStore.size();
+        mFileNameIndex = mFileNameStore.empty() ? NULL : &mFileNameStore[0];
+        mFileNameCount = (uint32_t) mFileNameStore.size();
+    }
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Saved index
+    //
+    // The mark bitmap, line intervals and file name index only depend on the 
+    // CodeView data and the text segment, so they can be written out once 
+    // and used in place the next time the image is loaded. Whoever keeps the 
+    // saved index is in charge of matching it to the image; the header only 
+    // guards against using it with a different layout or debug section.
+
+    const uint32_t  SavedIndexVersion = 2;
+
+    static uint32_t GetMarkWordCount( size_t bitCount )
+    {
+        return (uint32_t) ((bitCount + 31) / 32);
+    }
+
+    bool DebugStore::UsedSavedIndex()
+    {
+        return mUsedSavedIndex;
+    }
+
+    uint32_t DebugStore::GetSavedIndexSize()
+    {
+        return sizeof( SavedIndexHeader )
+            + (GetMarkWordCount( mMarkBitCount ) * sizeof( uint32_t ))
+            + (mLineIntervalCount * (sizeof( LineInterval ) + sizeof( DWORD )))
+            + (mFileNameCount * sizeof( FileNameEntry ));
+    }
+
+    HRESULT DebugStore::WriteSavedIndex( BYTE* buffer, uint32_t size )
+    {
+        C_ASSERT( (sizeof( SavedIndexHeader ) % 4) == 0 );
+        C_ASSERT( (sizeof( LineInterval ) % 4) == 0 );
+        C_ASSERT( (sizeof( FileNameEntry ) % 4) == 0 );
+
+        if ( !mInit )
+            return E_FAIL;
+        if ( buffer == NULL )
+            return E_INVALIDARG;
+        if ( mMarkBitCount > UINT_MAX )
+            return E_FAIL;
+        if ( size < GetSavedIndexSize() )
+            return E_INSUFFICIENT_BUFFER;
+
+        SavedIndexHeader*   header = (SavedIndexHeader*) buffer;
+        BYTE*               p = buffer + sizeof( SavedIndexHeader );
+        uint32_t            markWordCount = GetMarkWordCount( mMarkBitCount );
+
+        header->Signature = SavedIndexSignature;
+        header->Version = SavedIndexVersion;
+        header->CVSize = mCVBufSize;
+        header->TextSegment = mTextSegment;
+        header->CompilandCount = mCompilandCount;
+        header->MarkBitCount = (uint32_t) mMarkBitCount;
+        header->IntervalCount = mLineIntervalCount;
+        header->FileNameCount = mFileNameCount;
+
+        memcpy( p, mMarkBits, markWordCount * sizeof( uint32_t ) );
+        p += markWordCount * sizeof( uint32_t );
+        memcpy( p, mLineIntervals, mLineIntervalCount * sizeof( LineInterval ) );
+        p += mLineIntervalCount * sizeof( LineInterval );
+        memcpy( p, mLineIntervalMaxEnd, mLineIntervalCount * sizeof( DWORD ) );
+        p += mLineIntervalCount * sizeof( DWORD );
+        memcpy( p, mFileNameIndex, mFileNameCount * sizeof( FileNameEntry ) );
+
+        return S_OK;
+    }
+
+    // Takes the next array of a saved index, if it fits in what's left.
+
+    static bool TakeSavedArray( const BYTE*& p, uint32_t& remaining, uint64_t size, const BYTE*& array )
+    {
+        if ( size > remaining )
+            return false;
+
+        array = (size > 0) ? p : NULL;
+        p += (size_t) size;
+        remaining -= (uint32_t) size;
+        return true;
+    }
+
+    bool DebugStore::LoadSavedIndex( const BYTE* savedIndex, uint32_t savedIndexSize )
+    {
+        if ( (savedIndex == NULL) || (savedIndexSize < sizeof( SavedIndexHeader )) )
+            return false;
+        // the arrays are used in place
+        if ( ((uintptr_t) savedIndex % 4) != 0 )
+            return false;
+
+        const SavedIndexHeader* header = (const SavedIndexHeader*) savedIndex;
+
+        if ( (header->Signature != SavedIndexSignature)
+            || (header->Version != SavedIndexVersion)
+            || (header->CVSize != mCVBufSize)
+            || (header->TextSegment != mTextSegment)
+            || (header->CompilandCount != mCompilandCount) )
+            return false;
+
+        // 64-bit sizes, so that bad counts can't wrap around
+        uint64_t    markSize = (uint64_t) GetMarkWordCount( header->MarkBitCount ) * sizeof( uint32_t );
+        uint64_t    intervalSize = (uint64_t) header->IntervalCount * sizeof( LineInterval );
+        uint64_t    maxEndSize = (uint64_t) header->IntervalCount * sizeof( DWORD );
+        uint64_t    fileNameSize = (uint64_t) header->FileNameCount * sizeof( FileNameEntry );
+
+        const BYTE* p = savedIndex + sizeof( SavedIndexHeader );
+        uint32_t    remaining = savedIndexSize - sizeof( SavedIndexHeader );
+        const BYTE* markBits = NULL;
+        const BYTE* intervals = NULL;
+        const BYTE* maxEnds = NULL;
+        const BYTE* fileNames = NULL;
+
+        // each array has to be inside the blob, and nothing can be left over
+        if ( !TakeSavedArray( p, remaining, markSize, markBits )
+            || !TakeSavedArray( p, remaining, intervalSize, intervals )
+            || !TakeSavedArray( p, remaining, maxEndSize, maxEnds )
+            || !TakeSavedArray( p, remaining, fileNameSize, fileNames )
+            || (remaining != 0) )
+            return false;
+
+        if ( !ValidateSavedLineIntervals( 
+                (const LineInterval*) intervals, 
+                (const DWORD*) maxEnds, 
+                header->IntervalCount ) )
+            return false;
+
+        if ( !ValidateSavedFileNames( (const FileNameEntry*) fileNames, header->FileNameCount ) )
+            return false;
+
+        mMarkBits = (const uint32_t*) markBits;
+        mMarkBitCount = header->MarkBitCount;
+
+        mLineIntervalCount = header->IntervalCount;
+        mLineIntervals = (const LineInterval*) intervals;
+        mLineIntervalMaxEnd = (const DWORD*) maxEnds;
+
+        mFileNameCount = header->FileNameCount;
+        mFileNameIndex = (const FileNameEntry*) fileNames;
+
+        return true;
+    }
+
+    // The intervals have to be in the order that the searches expect, with 
+    // the max ends that go with them, and point at compilands that exist. 
+    // The file and segment indexes are checked by the source accessors when 
+    // they're used, because the source modules aren't known yet.
+
+    bool DebugStore::ValidateSavedLineIntervals( const LineInterval* intervals, const DWORD* maxEnds, uint32_t count )
+    {
+        for ( uint32_t i = 0; i < count; i++ )
+        {
+            const LineInterval& cur = intervals[i];
+            DWORD               maxEnd = cur.End;
+
+            if ( (cur.CompilandIndex < 1) || (cur.CompilandIndex > mCompilandCount) )
+                return false;
+            if ( cur.Start > cur.End )
+                return false;
+
+            if ( (i > 0) && (intervals[i - 1].Segment == cur.Segment) )
+            {
+                if ( LineIntervalLess( cur, intervals[i - 1] ) )
+                    return false;
+                if ( maxEnds[i - 1] > maxEnd )
+                    maxEnd = maxEnds[i - 1];
+            }
+            else if ( (i > 0) && (intervals[i - 1].Segment > cur.Segment) )
+                return false;
+
+            if ( maxEnds[i] != maxEnd )
+                return false;
+        }
+
+        return true;
+    }
+
+    bool DebugStore::ValidateSavedFileNames( const FileNameEntry* entries, uint32_t count )
+    {
+        for ( uint32_t i = 0; i < count; i++ )
+        {
+            if ( (entries[i].CompilandIndex < 1) || (entries[i].CompilandIndex > mCompilandCount) )
+                return false;
+            if ( (i > 0) && FileNameEntryLess( entries[i], entries[i - 1] ) )
+                return false;
+        }
+
+        return true;
+    }
+
+    HRESULT DebugStore::GetSymbolBytePtr( SymHandle handle, BYTE* bytes, DWORD& size )
+    {
+        SymHandleIn*    internalHandle = (SymHandleIn*) &handle;
+
+        // 4 bytes, at least as much as the generic symbol node: length and tag
+        if ( !ValidateSymbol( internalHandle, 4 ) )
+            return E_INVALIDARG;
+
+        CodeViewSymbol*   sym = internalHandle->Sym;
+        BYTE*             symBytes = (BYTE*) internalHandle->Sym;
+        DWORD             len = sym->Generic.len + 2;
+
+        if ( (bytes == NULL) || (size == 0) )
+        {
+            size = len;
+            return E_INSUFFICIENT_BUFFER;
+        }
+
+        if ( size > len )
+            size = len;
+
+        for ( DWORD i = 0; i < size; i++ )
+        {
+            bytes[i] = symBytes[i];
         }
 
         return S_OK;
@@ -1765,6 +2348,298 @@ namespace MagoST
         return S_OK;
     }
 
+    ///////////////////////////////////////////////////////////////////////////
+    // Structural validation
+    //
+    // The symbol heaps, type records, and source modules are checked once 
+    // when the debug info is loaded. The traversals skip the bounds checks 
+    // for the records that passed, and keep checking the rest. A bad source 
+    // module is left out entirely, because the source accessors never check.
+
+    void DebugStore::ValidateDebugInfo()
+    {
+        for ( DWORD i = 0; i < mCompilandCount; i++ )
+        {
+            if ( mCompilandDetails[i].SymbolEntry != NULL )
+                ValidateSymbolHeap( mCompilandDetails[i].SymbolEntry );
+        }
+
+        for ( int i = 0; i < SymHeap_Count; i++ )
+        {
+            if ( mSymsDir[i] != NULL )
+                ValidateSymbolHeap( mSymsDir[i] );
+        }
+
+        sort( mValidSymHeaps.begin(), mValidSymHeaps.end() );
+        sort( mValidScopes.begin(), mValidScopes.end(), ValidScopeLess );
+
+        if ( mGlobalTypesDir != NULL )
+            ValidateGlobalTypes();
+
+        _RPT4( _CRT_WARN, "DebugStore validation: %u symbol heaps, %u scopes, %u of %u types\n", 
+            (unsigned int) mValidSymHeaps.size(), 
+            (unsigned int) mValidScopes.size(), 
+            (unsigned int) count( mValidTypes.begin(), mValidTypes.end(), true ), 
+            (unsigned int) mValidTypes.size() );
+    }
+
+    bool DebugStore::ValidateSourceModule( OMFDirEntry* entry )
+    {
+        // the directory entry itself is already known to be in bounds
+        BYTE*               base = mCVBuf + entry->lfo;
+        DWORD               size = entry->cb;
+        OMFSourceModule*    srcMod = (OMFSourceModule*) base;
+
+        if ( size < 4 )
+            return false;
+
+        // the file table, the segment start/end pairs, and the segment indexes
+        if ( size - 4 < (srcMod->cFile * 4U) + (srcMod->cSeg * (8U + 2U)) )
+            return false;
+
+        for ( uint16_t f = 0; f < srcMod->cFile; f++ )
+        {
+            DWORD   fileOffset = srcMod->baseSrcFile[f];
+
+            if ( (fileOffset > size) || (size - fileOffset < 4) )
+                return false;
+
+            OMFSourceFile*  srcFile = (OMFSourceFile*) (base + fileOffset);
+            // the line table offsets, the start/end pairs, and the name length
+            DWORD           fileSize = 4 + (srcFile->cSeg * (4U + 8U)) + 1;
+
+            if ( size - fileOffset < fileSize )
+                return false;
+
+            BYTE    nameLen = base[fileOffset + fileSize - 1];
+
+            if ( size - fileOffset - fileSize < nameLen )
+                return false;
+
+            for ( uint16_t s = 0; s < srcFile->cSeg; s++ )
+            {
+                DWORD   lineOffset = srcFile->baseSrcLn[s];
+
+                if ( (lineOffset > size) || (size - lineOffset < 4) )
+                    return false;
+
+                OMFSourceLine*  srcLine = (OMFSourceLine*) (base + lineOffset);
+
+                // the offsets and the line numbers
+                if ( size - lineOffset - 4 < srcLine->cLnOff * (4U + 2U) )
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    void DebugStore::ValidateSymbolHeap( OMFDirEntry* entry )
+    {
+        BYTE*   heapBase = NULL;
+        BYTE*   start = NULL;
+        BYTE*   limit = NULL;
+
+        if ( FAILED( GetSymbolHeapBaseForDirEntry( entry, heapBase ) ) || (heapBase == NULL) )
+            return;
+
+        if ( entry->SubSection == sstAlignSym )
+        {
+            if ( entry->cb < 4 )
+                return;
+
+            start = heapBase + 4;       // skip the signature
+            limit = heapBase + entry->cb;
+        }
+        else
+        {
+            OMFSymHash* symHash = (OMFSymHash*) heapBase - 1;
+
+            if ( (entry->cb < sizeof( OMFSymHash )) 
+                || (symHash->cbSymbol > entry->cb - sizeof( OMFSymHash )) )
+                return;
+
+            start = heapBase;
+            limit = heapBase + symHash->cbSymbol;
+        }
+
+        // the offsets of all records that a walk from the start reaches
+        vector<BYTE*>       records;
+        vector<ValidScope>  scopes;
+        BYTE*               p = start;
+
+        while ( p + 3 < limit )
+        {
+            CodeViewSymbol* sym = (CodeViewSymbol*) p;
+            DWORD           len = sym->Generic.len + 2;
+
+            // NextSymbol stops here
+            if ( sym->Generic.id == 0 )
+                break;
+
+            if ( len > (DWORD) (limit - p) )
+                return;
+
+            if ( (sym->Generic.id == S_LPROC32) 
+                || (sym->Generic.id == S_GPROC32) 
+                || (sym->Generic.id == S_THUNK32) 
+                || (sym->Generic.id == S_BLOCK32) 
+                || (sym->Generic.id == S_WITH32) )
+            {
+                // the parent and end fields
+                if ( len < 12 )
+                    return;
+
+                ValidScope  scope = { p, entry };
+                scopes.push_back( scope );
+            }
+
+            records.push_back( p );
+            p += len;
+        }
+
+        // Every scope has to end on an S_END that comes after it. Then a walk 
+        // that starts on a record can only ever land on another record.
+
+        for ( vector<ValidScope>::iterator it = scopes.begin(); it != scopes.end(); it++ )
+        {
+            CodeViewSymbol* sym = (CodeViewSymbol*) it->Sym;
+            BYTE*           endPtr = heapBase + sym->block.end;
+
+            if ( endPtr <= it->Sym )
+                return;
+            if ( !binary_search( records.begin(), records.end(), endPtr ) )
+                return;
+            if ( ((CodeViewSymbol*) endPtr)->Generic.id != S_END )
+                return;
+        }
+
+        mValidSymHeaps.push_back( entry );
+        mValidScopes.insert( mValidScopes.end(), scopes.begin(), scopes.end() );
+    }
+
+    void DebugStore::ValidateGlobalTypes()
+    {
+        OMFGlobalTypes* globalTypes = GetCVPtr<OMFGlobalTypes>( mGlobalTypesDir->lfo );
+        DWORD           size = mGlobalTypesDir->cb;
+
+        if ( (globalTypes == NULL) || (size < sizeof( OMFGlobalTypes )) )
+            return;
+
+        size -= sizeof( OMFGlobalTypes );
+
+        if ( globalTypes->cTypes > size / sizeof( DWORD ) )
+            return;
+
+        DWORD*  offsetTable = (DWORD*) (globalTypes + 1);
+        BYTE*   typeBase = (BYTE*) (offsetTable + globalTypes->cTypes);
+        DWORD   typeSize = size - (globalTypes->cTypes * sizeof( DWORD ));
+        // the rest can't be reached with a 16-bit type index
+        DWORD   typeCount = globalTypes->cTypes;
+
+        if ( typeCount > 0x10000 - 0x1000 )
+            typeCount = 0x10000 - 0x1000;
+
+        mValidTypes.resize( typeCount, false );
+
+        for ( DWORD i = 0; i < typeCount; i++ )
+        {
+            DWORD   offset = offsetTable[i];
+
+            if ( (offset > typeSize) || (typeSize - offset < 4) )
+                continue;
+
+            CodeViewType*   type = (CodeViewType*) (typeBase + offset);
+            DWORD           len = type->Generic.len + 2;
+
+            if ( (len < 4) || (len > typeSize - offset) )
+                continue;
+
+            if ( (type->Generic.id == LF_FIELDLIST) 
+                && !ValidateFieldList( (BYTE*) type + 4, (BYTE*) type + len ) )
+                continue;
+
+            mValidTypes[i] = true;
+        }
+
+        mTypeBase = typeBase;
+        mTypeOffsets = offsetTable;
+    }
+
+    bool DebugStore::ValidateFieldList( BYTE* start, BYTE* limit )
+    {
+        TypeScopeIn scopeIn = { 0 };
+
+        scopeIn.CurPtr = start;
+        scopeIn.Limit = limit;
+
+        // walk it the same way that NextField does
+        while ( ValidateField( &scopeIn ) )
+        {
+            CodeViewFieldType*  type = (CodeViewFieldType*) scopeIn.CurPtr;
+            DWORD               len = 0;
+
+            if ( !GetFieldLength( type, (DWORD) (limit - scopeIn.CurPtr), len ) )
+                return false;
+
+            // the traversal moves to the continuation from here
+            if ( type->Generic.id == LF_INDEX )
+                break;
+
+            scopeIn.CurPtr += len;
+        }
+
+        return true;
+    }
+
+    bool DebugStore::IsValidType( TypeHandleIn* internalHandle )
+    {
+        if ( internalHandle->Index < 0x1000 )
+            return false;
+
+        DWORD   zIndex = internalHandle->Index - 0x1000;
+
+        if ( zIndex >= mValidTypes.size() )
+            return false;
+
+        // a handle made from a field doesn't hold the index of its own record
+        return mValidTypes[zIndex] 
+            && (internalHandle->Type == mTypeBase + mTypeOffsets[zIndex]);
+    }
+
+    bool DebugStore::IsValidScope( SymHandleIn* internalHandle )
+    {
+        ValidScope  key = { (BYTE*) internalHandle->Sym, internalHandle->HeapDir };
+
+        vector<ValidScope>::iterator it = 
+            lower_bound( mValidScopes.begin(), mValidScopes.end(), key, ValidScopeLess );
+
+        return (it != mValidScopes.end()) 
+            && (it->Sym == key.Sym) 
+            && (it->HeapDir == key.HeapDir);
+    }
+
+    bool DebugStore::IsValidSymHeap( OMFDirEntry* entry )
+    {
+        return binary_search( mValidSymHeaps.begin(), mValidSymHeaps.end(), entry );
+    }
+
+    bool DebugStore::ValidScopeLess( const ValidScope& left, const ValidScope& right )
+    {
+        return left.Sym < right.Sym;
+    }
+
+    OMFSourceModule* DebugStore::GetSourceModule( uint16_t zCompIx )
+    {
+        OMFDirEntry*    entry = mCompilandDetails[zCompIx].SourceEntry;
+
+        if ( entry == NULL )
+            return NULL;
+
+        // it was validated when the directory was read
+        return (OMFSourceModule*) (mCVBuf + entry->lfo);
+    }
+
     bool DebugStore::ValidateField( TypeScopeIn* scopeIn )
     {
         // we might be padding, so see if have enough for that
@@ -1851,13 +2726,22 @@ namespace MagoST
 
     bool DebugStore::MarkLineOffsetInBitmap( size_t adr )
     {
-        if ( adr >= mMarkOffsets.size() )
-            mMarkOffsets.resize( adr + 10000 );
+        if ( adr >= mMarkBitCount )
+        {
+            mMarkBitCount = adr + 10000;
+            mMarkBitStore.resize( GetMarkWordCount( mMarkBitCount ) );
+        }
 
-        mMarkOffsets[adr] = true;
+        mMarkBitStore[adr / 32] |= 1U << (adr % 32);
         return true;
     }
 
+    bool DebugStore::IsLineOffsetMarked( size_t adr )
+    {
+        _ASSERT( adr < mMarkBitCount );
+        return (mMarkBits[adr / 32] & (1U << (adr % 32))) != 0;
+    }
+
     bool DebugStore::MarkLineNumbers( OMFDirEntry* entry )
     {
         if ( entry->SubSection == sstAlignSym )
@@ -1899,7 +2783,12 @@ namespace MagoST
         {
             // mark the beginning/end of each section
             OMFModule* module   = GetCVPtr<OMFModule>( entry->lfo );
-            OMFSegDesc* segDesc = GetCVPtr<OMFSegDesc>( entry->lfo + sizeof( OMFModule ) );
+            if ( module == NULL )
+                return false;
+
+            OMFSegDesc* segDesc = GetCVPtr<OMFSegDesc>( entry->lfo + sizeof( OMFModule ), module->cSeg * sizeof( OMFSegDesc ) );
+            if ( segDesc == NULL )
+                return false;
 
             for (uint16_t s = 0; s < module->cSeg; s++)
                 if( segDesc[s].Seg == mTextSegment )
@@ -1916,8 +2805,8 @@ namespace MagoST
         if( lastLineOffset != off )
             return false;
 
-        for ( ; off + 1 < mMarkOffsets.size(); off++ )
-            if( mMarkOffsets[off + 1] )
+        for ( ; off + 1 < mMarkBitCount; off++ )
+            if( IsLineOffsetMarked( off + 1 ) )
                 return true;
         return false;
     }
@@ -21,8 +21,13 @@ namespace MagoST
 {
     typedef off_t offset_t;
     struct SymHandleIn;
+    struct TypeHandleIn;
     class ISymbolInfo;
 
+    // starts a saved index that a debug store writes, and the cache file 
+    // that IndexCache keeps one in
+    const uint32_t  SavedIndexSignature = 0x4958474D;   // "MGXI"
+
     class IDebugStore
     {
     public:
@@ -71,7 +76,14 @@ namespace MagoST
         virtual bool    FindNextLineByNum( uint16_t compIndex, uint16_t fileIndex, uint16_t line, LineNumber& lineNumber ) = 0;
 
         virtual bool    FindLines( bool exactMatch, const char* fileName, size_t fileNameLen, uint16_t reqLineStart, uint16_t reqLineEnd, 
-                                   std::list<LineNumber>& lines ) = 0;
+                                   std::vector<LineNumber>& lines ) = 0;
+    };
+
+    struct LineIndexStats
+    {
+        uint32_t        IntervalCount;
+        uint32_t        FileNameCount;
+        uint32_t        MemoryBytes;
     };
 
     class DebugStore : public IDebugStore
@@ -84,13 +96,73 @@ namespace MagoST
             OMFDirEntry*    SourceEntry;
         };
 
+        // one address range of a file segment instance, already clipped to 
+        // the compiland's segment contributions; sorted by segment and start
+        struct LineInterval
+        {
+            WORD            Segment;
+            uint16_t        CompilandIndex;
+            uint16_t        FileIndex;
+            uint16_t        SegmentInstance;
+            DWORD           Start;
+            DWORD           End;        // inclusive
+        };
+
+        // a source file of a compiland, keyed by the hash of its file name
+        struct FileNameEntry
+        {
+            uint32_t        Hash;
+            uint16_t        CompilandIndex;
+            uint16_t        FileIndex;
+        };
+
+        struct SegmentLine
+        {
+            uint16_t        SegmentInstance;
+            uint16_t        Number;
+            uint16_t        LineIndex;
+            uint32_t        Position;   // in FileLineIndex::Lines
+        };
+
+        // the lines of one source file of a compiland, built the first time 
+        // the file is searched by line number, and not changed after that
+        struct FileLineIndex
+        {
+            // sorted by line number, then segment instance and line index
+            std::vector<LineNumber>     Lines;
+            // sorted by segment instance, then line number and line index
+            std::vector<SegmentLine>    BySegment;
+        };
+
+        // a scope symbol in a validated heap, whose end points at an S_END
+        struct ValidScope
+        {
+            BYTE*           Sym;
+            OMFDirEntry*    HeapDir;
+        };
+
+        // followed by the mark bits, line intervals, their max ends, and 
+        // file name entries; each array is a multiple of 4 bytes long
+        struct SavedIndexHeader
+        {
+            uint32_t        Signature;
+            uint32_t        Version;
+            uint32_t        CVSize;
+            uint32_t        TextSegment;
+            uint32_t        CompilandCount;
+            uint32_t        MarkBitCount;
+            uint32_t        IntervalCount;
+            uint32_t        FileNameCount;
+        };
+
         struct SymbolScopeIn
         {
             OMFDirEntry*        Dir;
             BYTE*               HeapBase;
-            BYTE*               StartPtr;
             BYTE*               CurPtr;
             BYTE*               Limit;
+            // nonzero if the scope starts on a record of a heap validated at init
+            intptr_t            Validated;
         };
 
         struct TypeScopeIn
@@ -117,13 +189,43 @@ namespace MagoST
         UniquePtr<CompilandDetails[]>   mCompilandDetails;
 
         uint16_t mTextSegment;
-        std::vector<bool> mMarkOffsets;
+
+        // The line indexes are read through these pointers. They point either 
+        // into the vectors below, or into a saved index passed to InitDebugInfo.
+        const uint32_t*         mMarkBits;
+        size_t                  mMarkBitCount;
+        const LineInterval*     mLineIntervals;
+        // highest end offset of all intervals up to and including this one in the same segment
+        const DWORD*            mLineIntervalMaxEnd;
+        uint32_t                mLineIntervalCount;
+        const FileNameEntry*    mFileNameIndex;
+        uint32_t                mFileNameCount;
+        bool                    mUsedSavedIndex;
+
+        std::vector<uint32_t>       mMarkBitStore;
+        std::vector<LineInterval>   mLineIntervalStore;
+        std::vector<DWORD>          mLineIntervalMaxEndStore;
+        std::vector<FileNameEntry>  mFileNameStore;
+        // One slot for each source file of each compiland, starting at the 
+        // compiland's entry in mFileSlotStart. Readers on any thread can find 
+        // a file's index without locking, because a slot is only set once.
+        std::vector<FileLineIndex*> mFileLineIndexes;
+        std::vector<uint32_t>       mFileSlotStart;
+
+        // What the validation pass at init found well formed. Traversals of 
+        // these records skip the bounds checks; the rest is still checked.
+        std::vector<OMFDirEntry*>   mValidSymHeaps;     // sorted
+        std::vector<ValidScope>     mValidScopes;       // sorted by symbol
+        std::vector<bool>           mValidTypes;        // by zero-based type index
+        BYTE*                       mTypeBase;
+        DWORD*                      mTypeOffsets;
 
     public:
         DebugStore();
         virtual ~DebugStore();
 
         HRESULT InitDebugInfo( BYTE* buffer, DWORD size );
+        HRESULT InitDebugInfo( BYTE* buffer, DWORD size, const BYTE* savedIndex, uint32_t savedIndexSize );
         HRESULT InitDebugInfo();
         void CloseDebugInfo();
 
@@ -175,7 +277,24 @@ namespace MagoST
         virtual bool    FindNextLineByNum( uint16_t compIndex, uint16_t fileIndex, uint16_t line, LineNumber& lineNumber );
 
         virtual bool    FindLines( bool exactMatch, const char* fileName, size_t fileNameLen, uint16_t reqLineStart, uint16_t reqLineEnd, 
-                                   std::list<LineNumber>& lines );
+                                   std::vector<LineNumber>& lines );
+
+        bool    FindLineSpanByNum( 
+            uint16_t compIndex, 
+            uint16_t fileIndex, 
+            uint16_t line, 
+            const LineNumber*& lines, 
+            uint32_t& lineCount );
+
+        void GetLineIndexStats( LineIndexStats& stats );
+
+        // The line indexes can be saved, and passed back to InitDebugInfo 
+        // the next time the same image is loaded. The saved index must stay 
+        // valid as long as the store, because it's used in place.
+
+        bool UsedSavedIndex();
+        uint32_t GetSavedIndexSize();
+        HRESULT WriteSavedIndex( BYTE* buffer, uint32_t size );
 
         // for debugging
         HRESULT GetSymbolBytePtr( SymHandle handle, BYTE* bytes, DWORD& size );
@@ -210,6 +329,8 @@ namespace MagoST
 
         bool NextTypeGlobal( TypeScope& scope, TypeHandle& handle );
         bool NextTypeFList( TypeScope& scope, TypeHandle& handle );
+        bool NextTypeCheckedFList( TypeScope& scope, TypeHandle& handle );
+        bool NextField( TypeScope& scope, TypeHandle& handle, bool checked );
         bool NextTypeAList( TypeScope& scope, TypeHandle& handle );
         bool NextTypeMList( TypeScope& scope, TypeHandle& handle );
         bool NextTypeDList( TypeScope& scope, TypeHandle& handle );
@@ -228,21 +349,47 @@ namespace MagoST
             CodeViewSymbol*& newSymbol, 
             OMFDirEntry*& newHeapDir );
 
-        bool FindFileSegment( 
-            WORD seg, 
-            DWORD offset, 
+        HRESULT LoadDebugInfo( const BYTE* savedIndex, uint32_t savedIndexSize );
+
+        // structural validation
+        void ValidateDebugInfo();
+        bool ValidateSourceModule( OMFDirEntry* entry );
+        void ValidateSymbolHeap( OMFDirEntry* entry );
+        void ValidateGlobalTypes();
+        bool ValidateFieldList( BYTE* start, BYTE* limit );
+        bool IsValidType( TypeHandleIn* internalHandle );
+        bool IsValidScope( SymHandleIn* internalHandle );
+        bool IsValidSymHeap( OMFDirEntry* entry );
+        OMFSourceModule* GetSourceModule( uint16_t zCompIx );
+        static bool ValidScopeLess( const ValidScope& left, const ValidScope& right );
+        bool LoadSavedIndex( const BYTE* savedIndex, uint32_t savedIndexSize );
+        bool ValidateSavedLineIntervals( const LineInterval* intervals, const DWORD* maxEnds, uint32_t count );
+        bool ValidateSavedFileNames( const FileNameEntry* entries, uint32_t count );
+        void SetMarkBitsView();
+        void SetLineIndexViews();
+
+        HRESULT BuildLineIndex();
+        void AddLineIntervals( 
             uint16_t compIndex, 
-            uint16_t& fileIndex, 
-            FileSegmentInfo& segInfo );
-        bool FindFileSegment( 
+            OMFDirEntry* srcEntry, 
             WORD seg, 
-            DWORD offset, 
-            OMFSourceModule* srcMod, 
-            OMFSourceFile* file, 
-            FileSegmentInfo& segInfo );
-
-        bool FindCompilandFileSegmentByOffset( WORD seg, DWORD offset, uint16_t& compIndex, uint16_t& fileIndex, FileSegmentInfo& segInfo );
-        bool FindCompilandFileSegmentByLine( uint16_t line, uint16_t compIndex, uint16_t fileIndex, uint16_t firstSegIndex, FileSegmentInfo& segInfo );
+            DWORD modStart, 
+            DWORD modEnd );
+        bool FindLineInterval( WORD seg, DWORD offset, const LineInterval*& interval );
+        static bool LineIntervalLess( const LineInterval& left, const LineInterval& right );
+        static bool LineIntervalPrecedes( const LineInterval& left, const LineInterval& right );
+
+        HRESULT BuildFileNameIndex();
+        static bool FileNameEntryLess( const FileNameEntry& left, const FileNameEntry& right );
+        static bool FileNameHashLess( const FileNameEntry& left, const FileNameEntry& right );
+
+        void SetFileLineIndexSlots();
+        FileLineIndex* GetFileLineIndex( uint16_t compIndex, uint16_t fileIndex );
+        bool BuildFileLineIndex( uint16_t compIndex, uint16_t fileIndex, FileLineIndex& index );
+        const LineNumber* FindClosestLineByNum( const FileLineIndex& index, uint16_t line );
+        static bool LineNumberLess( const LineNumber& left, const LineNumber& right );
+        static bool LineNumberNumLess( const LineNumber& left, const LineNumber& right );
+        static bool SegmentLineLess( const SegmentLine& left, const SegmentLine& right );
         void SetLineNumberFromSegment( uint16_t compIx, uint16_t fileIx, const FileSegmentInfo& segInfo, uint16_t lineIndex, LineNumber& lineNumber );
 
         template <class TElem>
@@ -251,6 +398,7 @@ namespace MagoST
         // patching line info
         bool MarkLineNumbers( OMFDirEntry* entry );
         bool MarkLineOffsetInBitmap( size_t adr );
+        bool IsLineOffsetMarked( size_t adr );
         bool FixEndOffset( DWORD lastLineOffset, DWORD& off );
         bool PatchLineNumberInfo();
     };
@@ -0,0 +1,230 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#include "Common.h"
+#include "MSFFile.h"
+
+
+namespace MagoST
+{
+    const char      MSFMagic[] = "Microsoft C/C++ MSF 7.00\r\n\x1a" "DS\0\0";
+
+    struct MSFSuperBlock
+    {
+        char        Magic[32];
+        uint32_t    BlockSize;
+        uint32_t    FreeBlockMapBlock;
+        uint32_t    BlockCount;
+        uint32_t    DirectorySize;
+        uint32_t    Unknown;
+        uint32_t    BlockMapBlock;
+    };
+
+
+    MSFFile::MSFFile()
+        :   mBase( NULL ),
+            mSize( 0 ),
+            mBlockSize( 0 ),
+            mStreamCount( 0 ),
+            mStreamSizes( NULL )
+    {
+        C_ASSERT( sizeof MSFMagic == 32 );
+    }
+
+    HRESULT MSFFile::Init( const BYTE* base, uint32_t size )
+    {
+        if ( base == NULL )
+            return E_INVALIDARG;
+        if ( mBase != NULL )
+            return E_ALREADY_INIT;
+
+        if ( size < sizeof( MSFSuperBlock ) )
+            return E_BAD_FORMAT;
+
+        const MSFSuperBlock*    super = (const MSFSuperBlock*) base;
+
+        if ( memcmp( super->Magic, MSFMagic, sizeof MSFMagic ) != 0 )
+            return E_BAD_FORMAT;
+
+        switch ( super->BlockSize )
+        {
+        case 512:
+        case 1024:
+        case 2048:
+        case 4096:
+            break;
+        default:
+            return E_BAD_FORMAT;
+        }
+
+        if ( (uint64_t) super->BlockCount * super->BlockSize > size )
+            return E_BAD_FORMAT;
+
+        mBase = base;
+        mSize = size;
+        mBlockSize = super->BlockSize;
+
+        if ( !ReadDirectory( super->BlockMapBlock, super->DirectorySize ) )
+        {
+            mBase = NULL;
+            mSize = 0;
+            mStreamCount = 0;
+            mStreamSizes = NULL;
+            mStreamBlocks.clear();
+            mDirCopy.clear();
+            return E_BAD_FORMAT;
+        }
+
+        // sized once here, so that the copies never move once made
+        mStreamCopies.resize( mStreamCount );
+
+        return S_OK;
+    }
+
+    bool MSFFile::ReadDirectory( uint32_t blockMapBlock, uint32_t dirSize )
+    {
+        if ( dirSize < sizeof( uint32_t ) )
+            return false;
+
+        uint32_t    dirBlockCount = GetBlockCount( dirSize );
+        uint64_t    blockMapOffset = (uint64_t) blockMapBlock * mBlockSize;
+
+        if ( blockMapOffset + (uint64_t) dirBlockCount * sizeof( uint32_t ) > mSize )
+            return false;
+
+        // the block map lists the blocks of the directory
+        const uint32_t* dirBlocks = (const uint32_t*) (mBase + blockMapOffset);
+
+        if ( !IsValidBlockList( dirBlocks, dirBlockCount ) )
+            return false;
+
+        const BYTE*     dir = GetContiguousData( dirBlocks, dirSize );
+
+        if ( dir == NULL )
+        {
+            CopyBlocks( dirBlocks, dirSize, mDirCopy );
+            dir = &mDirCopy[0];
+        }
+
+        const uint32_t* dirWords = (const uint32_t*) dir;
+        uint32_t        dirWordCount = dirSize / sizeof( uint32_t );
+
+        mStreamCount = dirWords[0];
+
+        if ( mStreamCount > dirWordCount - 1 )
+            return false;
+
+        mStreamSizes = dirWords + 1;
+
+        const uint32_t* blocks = mStreamSizes + mStreamCount;
+        const uint32_t* dirLimit = dirWords + dirWordCount;
+
+        mStreamBlocks.resize( mStreamCount );
+
+        for ( uint32_t i = 0; i < mStreamCount; i++ )
+        {
+            uint32_t    blockCount = 0;
+
+            if ( mStreamSizes[i] != NilStreamSize )
+                blockCount = GetBlockCount( mStreamSizes[i] );
+
+            if ( blockCount > (uint32_t) (dirLimit - blocks) )
+                return false;
+
+            if ( !IsValidBlockList( blocks, blockCount ) )
+                return false;
+
+            mStreamBlocks[i] = blocks;
+            blocks += blockCount;
+        }
+
+        return true;
+    }
+
+    uint32_t MSFFile::GetStreamCount()
+    {
+        return mStreamCount;
+    }
+
+    bool MSFFile::GetStream( uint32_t index, const BYTE*& data, uint32_t& size )
+    {
+        if ( index >= mStreamCount )
+            return false;
+
+        if ( mStreamSizes[index] == NilStreamSize )
+            return false;
+
+        size = mStreamSizes[index];
+
+        if ( size == 0 )
+        {
+            data = mBase;
+            return true;
+        }
+
+        std::vector<BYTE>&  copy = mStreamCopies[index];
+
+        if ( !copy.empty() )
+        {
+            data = &copy[0];
+            return true;
+        }
+
+        data = GetContiguousData( mStreamBlocks[index], size );
+
+        if ( data == NULL )
+        {
+            CopyBlocks( mStreamBlocks[index], size, copy );
+            data = &copy[0];
+        }
+
+        return true;
+    }
+
+    bool MSFFile::IsValidBlockList( const uint32_t* blocks, uint32_t blockCount )
+    {
+        uint32_t    fileBlockCount = mSize / mBlockSize;
+
+        for ( uint32_t i = 0; i < blockCount; i++ )
+        {
+            if ( blocks[i] >= fileBlockCount )
+                return false;
+        }
+
+        return true;
+    }
+
+    const BYTE* MSFFile::GetContiguousData( const uint32_t* blocks, uint32_t size )
+    {
+        uint32_t    blockCount = GetBlockCount( size );
+
+        for ( uint32_t i = 1; i < blockCount; i++ )
+        {
+            if ( blocks[i] != blocks[0] + i )
+                return NULL;
+        }
+
+        return mBase + (blocks[0] * mBlockSize);
+    }
+
+    void MSFFile::CopyBlocks( const uint32_t* blocks, uint32_t size, std::vector<BYTE>& buffer )
+    {
+        uint32_t    blockCount = GetBlockCount( size );
+
+        buffer.resize( size );
+
+        for ( uint32_t i = 0; i < blockCount; i++ )
+        {
+            uint32_t    copySize = mBlockSize;
+
+            if ( i == blockCount - 1 )
+                copySize = size - (i * mBlockSize);
+
+            memcpy( &buffer[i * mBlockSize], mBase + (blocks[i] * mBlockSize), copySize );
+        }
+    }
+}
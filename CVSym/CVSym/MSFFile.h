@@ -0,0 +1,53 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+
+namespace MagoST
+{
+    // Reads the streams of a multi-stream file (the container format of a
+    // PDB) that is already in memory, usually a mapped view of the file.
+    //
+    // A stream whose blocks follow each other is returned in place. Any other
+    // stream is copied together once, the first time it's asked for. That 
+    // makes GetStream unsafe to call from more than one thread at a time.
+
+    class MSFFile
+    {
+        const BYTE*             mBase;
+        uint32_t                mSize;
+        uint32_t                mBlockSize;
+        uint32_t                mStreamCount;
+        const uint32_t*         mStreamSizes;
+        // the block list of each stream, in the directory
+        std::vector<const uint32_t*>    mStreamBlocks;
+        std::vector<BYTE>               mDirCopy;
+        std::vector< std::vector<BYTE> >    mStreamCopies;
+
+    public:
+        static const uint32_t   NilStreamSize = 0xFFFFFFFF;
+
+        MSFFile();
+
+        HRESULT Init( const BYTE* base, uint32_t size );
+
+        uint32_t GetStreamCount();
+        bool GetStream( uint32_t index, const BYTE*& data, uint32_t& size );
+
+    private:
+        bool ReadDirectory( uint32_t blockMapBlock, uint32_t dirSize );
+        bool IsValidBlockList( const uint32_t* blocks, uint32_t blockCount );
+        const BYTE* GetContiguousData( const uint32_t* blocks, uint32_t size );
+        void CopyBlocks( const uint32_t* blocks, uint32_t size, std::vector<BYTE>& buffer );
+
+        uint32_t GetBlockCount( uint32_t size )
+        {
+            return (uint32_t) (((uint64_t) size + mBlockSize - 1) / mBlockSize);
+        }
+    };
+}
@@ -51,10 +51,12 @@ public:
         return (Pair*) (mTable + mOffsets[bucket]);
     }
 
+    // The pairs in each group are sorted by offset. Finds the symbol at the
+    // offset, or else the closest one that starts before it.
+
     bool GetSymbolOffset( WORD segment, DWORD offset, uint32_t& symOffset )
     {
         WORD    bucket = 0;
-        DWORD   i = 0;
 
         Pair*   offsets = NULL;
         DWORD   numOffsets = 0;
@@ -70,32 +72,25 @@ public:
         if ( numOffsets == 0xFFFFFFFF )
             return false;
 
-        bool        found = false;
-        DWORD       last = 0;
+        Pair*   end = offsets + numOffsets;
+        Pair*   it = std::lower_bound( offsets, end, offset, PairOffsetLess );
 
-        for ( i = 0; i < numOffsets; i++ )
+        if ( (it != end) && (it->second == offset) )
         {
-            if ( offset == offsets[i].second )
-            {
-                symOffset = offsets[i].first;
-                return true;
-            }
-            else if ( offset > offsets[i].second )
-            {
-                found = true;
-                last = i;
-            }
-            else if ( offset < offsets[i].second )
-            {
-                if ( found )
-                {
-                    symOffset = offsets[last].first;
-                    return true;
-                }
-            }
+            symOffset = it->first;
+            return true;
         }
-        if( found )
-            symOffset = offsets[last].first;
-        return found;
+
+        if ( it == offsets )
+            return false;
+
+        symOffset = (it - 1)->first;
+        return true;
+    }
+
+private:
+    static bool PairOffsetLess( const Pair& pair, DWORD offset )
+    {
+        return pair.second < offset;
     }
 };
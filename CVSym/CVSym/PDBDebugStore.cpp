@@ -449,9 +449,9 @@ namespace MagoST
         :   mSource( NULL ),
             mSession( NULL ),
             mGlobal( NULL ),
-            mFindLineEnumLineNumbers( NULL ),
             mInit( false ),
-            mCompilandCount( -1 )
+            mCompilandCount( -1 ),
+            mPdbView( NULL )
     {
         mMachineType = CV_CFL_80386;
 
@@ -552,15 +552,117 @@ namespace MagoST
             }
         }
 
+        // without the native reader, lines still come from DIA
+        openPdbReader( buffer, size );
+
+        return S_OK;
+    }
+
+    HRESULT PDBDebugStore::openPdbReader( BYTE* buffer, DWORD size )
+    {
+        // the debug info of the image: "RSDS", GUID, age, PDB path
+        if ( (size < 24) || (memcmp( buffer, "RSDS", 4 ) != 0) )
+            return E_BAD_FORMAT;
+
+        GUID    guid = { 0 };
+        DWORD   age = 0;
+
+        memcpy( &guid, buffer + 4, sizeof guid );
+        memcpy( &age, buffer + 20, sizeof age );
+
+        // open the same PDB that DIA found
+        BSTR bstrPath = NULL;
+        HRESULT hr = mGlobal->get_symbolsFileName( &bstrPath );
+        if ( hr != S_OK )
+            return E_FAIL;
+
+        PVOID OldValue = NULL;
+        BOOL redir = Wow64DisableWow64FsRedirection( &OldValue );
+
+        FileHandlePtr   hFile;
+        hFile = CreateFile( bstrPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+
+        if( redir )
+            Wow64RevertWow64FsRedirection( OldValue );
+
+        SysFreeString( bstrPath );
+
+        if ( hFile.IsEmpty() )
+            return GetLastHr();
+
+        DWORD   hiSize = 0;
+        DWORD   fileSize = GetFileSize( hFile, &hiSize );
+        if ( fileSize == INVALID_FILE_SIZE )
+            return GetLastHr();
+        if ( hiSize > 0 )
+            return E_BAD_FORMAT;
+
+        HandlePtr   hMapping;
+        hMapping = CreateFileMapping( hFile, NULL, PAGE_READONLY, 0, 0, NULL );
+        if ( hMapping.IsEmpty() )
+            return GetLastHr();
+
+        // the view stays mapped after the handles are closed
+        mPdbView = (BYTE*) MapViewOfFile( hMapping, FILE_MAP_READ, 0, 0, 0 );
+        if ( mPdbView == NULL )
+            return GetLastHr();
+
+        std::auto_ptr<PDBReader>    reader( new PDBReader() );
+        if ( reader.get() == NULL )
+            hr = E_OUTOFMEMORY;
+
+        if ( !FAILED( hr ) )
+            hr = reader->Init( mPdbView, fileSize );
+
+        if ( !FAILED( hr ) && !reader->Matches( guid, age ) )
+            hr = E_BAD_FORMAT;
+
+        if ( FAILED( hr ) )
+        {
+            closePdbReader();
+            return hr;
+        }
+
+        mPdbReader = reader;
+
+        // without the native symbols, symbols and types still come from DIA
+        std::auto_ptr<C13SymbolStore>   symbols( new C13SymbolStore() );
+
+        if ( (symbols.get() != NULL) && (symbols->Init( *mPdbReader ) == S_OK) )
+            mNativeSymbols = symbols;
+
         return S_OK;
     }
 
+    void PDBDebugStore::closePdbReader()
+    {
+        mNativeSymbols.reset();
+        mPdbReader.reset();
+
+        if ( mPdbView != NULL )
+        {
+            UnmapViewOfFile( mPdbView );
+            mPdbView = NULL;
+        }
+    }
+
+    void PDBDebugStore::CloseNativeReaders()
+    {
+        closePdbReader();
+    }
+
     void PDBDebugStore::CloseDebugInfo()
     {
         if( !mInit )
             return;
 
-        releaseFindLineEnumLineNumbers();
+        for ( DiaThreadStateMap::iterator it = mDiaThreadStates.begin(); it != mDiaThreadStates.end(); it++ )
+        {
+            releaseFindLineEnumLineNumbers( it->second );
+        }
+        mDiaThreadStates.clear();
+
+        closePdbReader();
 
         if ( mGlobal ) 
         {
@@ -584,18 +686,29 @@ namespace MagoST
         mInit = false;
     }
 
-    void PDBDebugStore::releaseFindLineEnumLineNumbers()
+    PDBDebugStore::DiaThreadState& PDBDebugStore::getDiaThreadState()
+    {
+        GuardedArea guard( mDiaThreadStateGuard );
+
+        // a new one starts out zeroed; entries never move, so the thread can 
+        // keep using its own after the lock is gone
+        return mDiaThreadStates[GetCurrentThreadId()];
+    }
+
+    void PDBDebugStore::releaseFindLineEnumLineNumbers( DiaThreadState& state )
     {
-        if( mFindLineEnumLineNumbers )
+        if( state.FindLineEnum )
         {
-            mFindLineEnumLineNumbers->Release();
-            mFindLineEnumLineNumbers = NULL;
+            state.FindLineEnum->Release();
+            state.FindLineEnum = NULL;
         }
-        
     }
 
     HRESULT PDBDebugStore::SetCompilandSymbolScope( DWORD compilandIndex, SymbolScope& scope )
     {
+        if ( mNativeSymbols.get() != NULL )
+            return mNativeSymbols->SetCompilandSymbolScope( compilandIndex, scope );
+
         UNREFERENCED_PARAMETER( compilandIndex );
         UNREFERENCED_PARAMETER( scope );
         // not used
@@ -605,15 +718,20 @@ namespace MagoST
 
     HRESULT PDBDebugStore::SetSymbolScope( SymbolHeapId heapId, SymbolScope& scope )
     {
+        if ( mNativeSymbols.get() != NULL )
+            return mNativeSymbols->SetSymbolScope( heapId, scope );
+
         UNREFERENCED_PARAMETER( heapId );
         UNREFERENCED_PARAMETER( scope );
-        // not used
-        assert(false);
+        // DIA doesn't have the heaps; the session falls back to searching by name
         return E_NOTIMPL;
     }
 
     HRESULT PDBDebugStore::SetChildSymbolScope( SymHandle handle, SymbolScope& scope )
     {
+        if ( mNativeSymbols.get() != NULL )
+            return mNativeSymbols->SetChildSymbolScope( handle, scope );
+
         PDBStore::SymHandleIn& symIn = (PDBStore::SymHandleIn&) handle;
         PDBStore::SymbolScopeIn& scopeIn = (PDBStore::SymbolScopeIn&) scope;
 
@@ -624,6 +742,9 @@ namespace MagoST
 
     bool PDBDebugStore::NextSymbol( SymbolScope& scope, SymHandle& handle )
     {
+        if ( mNativeSymbols.get() != NULL )
+            return mNativeSymbols->NextSymbol( scope, handle );
+
         PDBStore::SymHandleIn& symIn = (PDBStore::SymHandleIn&) handle;
         PDBStore::SymbolScopeIn& scopeIn = (PDBStore::SymbolScopeIn&) scope;
 
@@ -651,6 +772,9 @@ namespace MagoST
 
     HRESULT PDBDebugStore::FindFirstSymbol( SymbolHeapId heapId, const char* nameChars, size_t nameLen, EnumNamedSymbolsData& data )
     {
+        if ( mNativeSymbols.get() != NULL )
+            return mNativeSymbols->FindFirstSymbol( heapId, nameChars, nameLen, data );
+
         PDBStore::EnumNamedSymbolsDataIn& dataIn = (PDBStore::EnumNamedSymbolsDataIn&) data;
         if ( heapId == SymHeap_GlobalSymbols )
         {
@@ -684,6 +808,9 @@ namespace MagoST
 
     HRESULT PDBDebugStore::FindNextSymbol( EnumNamedSymbolsData& handle )
     {
+        if ( mNativeSymbols.get() != NULL )
+            return mNativeSymbols->FindNextSymbol( handle );
+
         UNREFERENCED_PARAMETER( handle );
         // not used
         assert(false);
@@ -692,6 +819,9 @@ namespace MagoST
 
     HRESULT PDBDebugStore::GetCurrentSymbol( const EnumNamedSymbolsData& searchData, SymHandle& handle )
     {
+        if ( mNativeSymbols.get() != NULL )
+            return mNativeSymbols->GetCurrentSymbol( searchData, handle );
+
         const PDBStore::EnumNamedSymbolsDataIn& dataIn = (const PDBStore::EnumNamedSymbolsDataIn&) searchData;
         PDBStore::SymHandleIn& symIn = (PDBStore::SymHandleIn&) handle;
         symIn.id = dataIn.id;
@@ -700,6 +830,9 @@ namespace MagoST
 
     HRESULT PDBDebugStore::FindSymbol( SymbolHeapId heapId, WORD segment, DWORD offset, SymHandle& handle )
     {
+        if ( mNativeSymbols.get() != NULL )
+            return mNativeSymbols->FindSymbol( heapId, segment, offset, handle );
+
         UNREFERENCED_PARAMETER( heapId );
 
         PDBStore::SymHandleIn& handleIn = (PDBStore::SymHandleIn&) handle;
@@ -739,6 +872,9 @@ namespace MagoST
 
     HRESULT PDBDebugStore::GetSymbolInfo( SymHandle handle, SymInfoData& privateData, ISymbolInfo*& symInfo )
     {
+        if ( mNativeSymbols.get() != NULL )
+            return mNativeSymbols->GetSymbolInfo( handle, privateData, symInfo );
+
         PDBStore::SymHandleIn& handleIn = (PDBStore::SymHandleIn&) handle;
 
         symInfo = new (&privateData) PDBSymbolInfo( this, handleIn.id );
@@ -747,6 +883,9 @@ namespace MagoST
 
     HRESULT PDBDebugStore::SetGlobalTypeScope( TypeScope& scope )
     {
+        if ( mNativeSymbols.get() != NULL )
+            return mNativeSymbols->SetGlobalTypeScope( scope );
+
         PDBStore::TypeScopeIn& scopeIn = (PDBStore::TypeScopeIn&) scope;
 
         scopeIn.current = 0;
@@ -755,6 +894,9 @@ namespace MagoST
 
     bool PDBDebugStore::GetTypeFromTypeIndex( TypeIndex typeIndex, TypeHandle& handle )
     {
+        if ( mNativeSymbols.get() != NULL )
+            return mNativeSymbols->GetTypeFromTypeIndex( typeIndex, handle );
+
         PDBStore::TypeHandleIn& handleIn = (PDBStore::TypeHandleIn&) handle;
         handleIn.id = typeIndex;
         return true;
@@ -762,6 +904,9 @@ namespace MagoST
 
     HRESULT PDBDebugStore::SetChildTypeScope( TypeHandle handle, TypeScope& scope )
     {
+        if ( mNativeSymbols.get() != NULL )
+            return mNativeSymbols->SetChildTypeScope( handle, scope );
+
         PDBStore::TypeHandleIn& typeIn = (PDBStore::TypeHandleIn&) handle;
         PDBStore::TypeScopeIn& scopeIn = (PDBStore::TypeScopeIn&) scope;
 
@@ -773,6 +918,9 @@ namespace MagoST
 
     bool PDBDebugStore::NextType( TypeScope& scope, TypeHandle& handle )
     {
+        if ( mNativeSymbols.get() != NULL )
+            return mNativeSymbols->NextType( scope, handle );
+
         PDBStore::TypeHandleIn& typeIn = (PDBStore::TypeHandleIn&) handle;
         PDBStore::TypeScopeIn& scopeIn = (PDBStore::TypeScopeIn&) scope;
 
@@ -801,6 +949,9 @@ namespace MagoST
 
     HRESULT PDBDebugStore::GetTypeInfo( TypeHandle handle, SymInfoData& privateData, ISymbolInfo*& symInfo )
     {
+        if ( mNativeSymbols.get() != NULL )
+            return mNativeSymbols->GetTypeInfo( handle, privateData, symInfo );
+
         PDBStore::TypeHandleIn& handleIn = (PDBStore::TypeHandleIn&) handle;
 
         symInfo = new (&privateData) PDBSymbolInfo( this, handleIn.id );
@@ -812,27 +963,49 @@ namespace MagoST
         if( mCompilandCount < 0 )
         {
             IDiaEnumSymbols *pEnumSymbols;
+            long            count = 0;
 
-            if ( FAILED( mGlobal->findChildren( SymTagCompiland, NULL, nsNone, &pEnumSymbols ) ) )
-                mCompilandCount = 0;
-            else
+            // other threads can read it as soon as it's stored, so store it once
+            if ( !FAILED( mGlobal->findChildren( SymTagCompiland, NULL, nsNone, &pEnumSymbols ) ) )
             {
-                if( FAILED( pEnumSymbols->get_Count( &mCompilandCount ) ) )
-                    mCompilandCount = 0;
+                if( FAILED( pEnumSymbols->get_Count( &count ) ) )
+                    count = 0;
                 pEnumSymbols->Release();
             }
+
+            mCompilandCount = count;
         }
         return mCompilandCount;
     }
 
     HRESULT PDBDebugStore::GetCompilandCount( uint32_t& count )
     {
+        if ( mPdbReader.get() != NULL )
+        {
+            count = mPdbReader->GetModuleCount();
+            return S_OK;
+        }
+
         count = getCompilandCount();
         return S_OK;
     }
 
     HRESULT PDBDebugStore::GetCompilandInfo( uint16_t index, CompilandInfo& info )
     {
+        if ( mPdbReader.get() != NULL )
+        {
+            uint16_t    fileCount = 0;
+
+            if ( (index < 1) 
+                || !mPdbReader->GetModuleName( index - 1, info.Name ) 
+                || !mPdbReader->GetFileCount( index - 1, fileCount ) )
+                return E_INVALIDARG;
+
+            info.FileCount = fileCount;
+            info.SegmentCount = 1;
+            return S_OK;
+        }
+
         if ( (index < 1) || (index > getCompilandCount()) )
             return E_INVALIDARG;
 
@@ -886,6 +1059,18 @@ namespace MagoST
 
     HRESULT PDBDebugStore::GetFileInfo( uint16_t compilandIndex, uint16_t fileIndex, FileInfo& info )
     {
+        if ( mPdbReader.get() != NULL )
+        {
+            uint16_t    segmentCount = 0;
+
+            if ( (compilandIndex < 1) 
+                || !mPdbReader->GetFileInfo( compilandIndex - 1, fileIndex, info.Name, segmentCount ) )
+                return E_INVALIDARG;
+
+            info.SegmentCount = segmentCount;
+            return S_OK;
+        }
+
         if ( (compilandIndex < 1) || (compilandIndex > getCompilandCount()) )
             return E_INVALIDARG;
 
@@ -959,6 +1144,13 @@ namespace MagoST
 
     bool PDBDebugStore::GetFileSegment( uint16_t compIndex, uint16_t fileIndex, uint16_t segInstanceIndex, FileSegmentInfo& segInfo )
     {
+        if ( mPdbReader.get() != NULL )
+        {
+            if ( compIndex < 1 )
+                return false;
+            return mPdbReader->GetFileSegment( compIndex - 1, fileIndex, segInstanceIndex, segInfo );
+        }
+
         if ( (compIndex < 1) || (compIndex > getCompilandCount()) )
             return false;
         if( segInstanceIndex > 0 )
@@ -992,7 +1184,7 @@ namespace MagoST
             hr = mSession->findLines( pCompiland, pSourceFile, &pEnumLineNumbers );
 
         if( !FAILED( hr ) )
-            hr = fillFileSegmentInfo( pEnumLineNumbers, segInfo );
+            hr = fillFileSegmentInfo( pEnumLineNumbers, getDiaThreadState(), segInfo );
 
         if( pEnumLineNumbers )
             pEnumLineNumbers->Release();
@@ -1008,7 +1200,7 @@ namespace MagoST
         return !FAILED( hr );
     }
 
-    HRESULT PDBDebugStore::fillFileSegmentInfo( IDiaEnumLineNumbers *pEnumLineNumbers, FileSegmentInfo& segInfo )
+    HRESULT PDBDebugStore::fillFileSegmentInfo( IDiaEnumLineNumbers *pEnumLineNumbers, DiaThreadState& state, FileSegmentInfo& segInfo )
     {
         HRESULT hr = S_OK;
         LONG lineNumbers = 0;
@@ -1021,10 +1213,9 @@ namespace MagoST
 
         if( !FAILED( hr ) )
         {
-            mLastSegInfoLineNumbers.reset( new WORD[lineNumbers] );
-            mLastSegInfoOffsets.reset( new DWORD[lineNumbers] );
-            if ( mLastSegInfoLineNumbers.get() == NULL || mLastSegInfoOffsets.get() == NULL )
-                hr = E_OUTOFMEMORY;
+            // the segment info points here until the thread's next call
+            state.SegInfoLineNumbers.resize( lineNumbers );
+            state.SegInfoOffsets.resize( lineNumbers );
         }
         LONG lineIndex = 0;
         DWORD section = 0;
@@ -1057,16 +1248,16 @@ namespace MagoST
                     segInfo.End += length - 1;
             }
 
-            mLastSegInfoOffsets.get()[lineIndex] = off;
-            mLastSegInfoLineNumbers.get()[lineIndex] = (WORD) line;
+            state.SegInfoOffsets[lineIndex] = off;
+            state.SegInfoLineNumbers[lineIndex] = (WORD) line;
 
             lineIndex++;
             pLineNumber->Release();
         }
         segInfo.SegmentIndex = (WORD) section;
         segInfo.LineCount = (WORD) lineIndex;
-        segInfo.Offsets = mLastSegInfoOffsets.get ();
-        segInfo.LineNumbers = mLastSegInfoLineNumbers.get ();
+        segInfo.Offsets = (lineIndex > 0) ? &state.SegInfoOffsets[0] : NULL;
+        segInfo.LineNumbers = (lineIndex > 0) ? &state.SegInfoLineNumbers[0] : NULL;
         return hr;
     }
 
@@ -1176,6 +1367,9 @@ namespace MagoST
 
     bool PDBDebugStore::FindLine( WORD seg, uint32_t offset, LineNumber& lineNumber )
     {
+        if ( mPdbReader.get() != NULL )
+            return mPdbReader->FindLine( seg, offset, lineNumber );
+
         HRESULT hr = S_OK;
         IDiaEnumLineNumbers *pEnumLineNumbers = NULL;
         if( !FAILED( hr ) )
@@ -1204,10 +1398,19 @@ namespace MagoST
 
     bool PDBDebugStore::FindLineByNum( uint16_t compIndex, uint16_t fileIndex, uint16_t line, LineNumber& lineNumber )
     {
+        if ( mPdbReader.get() != NULL )
+        {
+            if ( compIndex < 1 )
+                return false;
+            return mPdbReader->FindLineByNum( compIndex - 1, fileIndex, line, lineNumber );
+        }
+
         if ( (compIndex < 1) || (compIndex > getCompilandCount()) )
             return false;
 
-        releaseFindLineEnumLineNumbers();
+        DiaThreadState& state = getDiaThreadState();
+
+        releaseFindLineEnumLineNumbers( state );
 
         IDiaEnumSymbols *pEnumSymbols = NULL;
         HRESULT hr = mGlobal->findChildren( SymTagCompiland, NULL, nsNone, &pEnumSymbols );
@@ -1232,10 +1435,10 @@ namespace MagoST
             hr = pFiles->Item( fileIndex, &pSourceFile );
 
         if( !FAILED( hr ) )
-            hr = mSession->findLinesByLinenum( pCompiland, pSourceFile, line, 0, &mFindLineEnumLineNumbers );
+            hr = mSession->findLinesByLinenum( pCompiland, pSourceFile, line, 0, &state.FindLineEnum );
 
         if( !FAILED( hr ) )
-            hr = mFindLineEnumLineNumbers->Reset();
+            hr = state.FindLineEnum->Reset();
 
         if( pSourceFile )
             pSourceFile->Release();
@@ -1254,23 +1457,33 @@ namespace MagoST
 
     bool PDBDebugStore::FindNextLineByNum( uint16_t compIndex, uint16_t fileIndex, uint16_t line, LineNumber& lineNumber )
     {
+        if ( mPdbReader.get() != NULL )
+        {
+            // continues from the previous result, in lineNumber
+            if ( compIndex < 1 )
+                return false;
+            return mPdbReader->FindNextLineByNum( compIndex - 1, fileIndex, lineNumber );
+        }
+
         // assume arguments are the same as last call to FindLineByNum
         UNREFERENCED_PARAMETER( compIndex );
         UNREFERENCED_PARAMETER( fileIndex );
         UNREFERENCED_PARAMETER( line );
 
-        if( !mFindLineEnumLineNumbers )
+        DiaThreadState& state = getDiaThreadState();
+
+        if( !state.FindLineEnum )
             return false;
 
         HRESULT hr = S_OK;
         IDiaLineNumber* pLineNumber = NULL;
         ULONG fetched = 0;
         if( !FAILED( hr ) )
-            hr = mFindLineEnumLineNumbers->Next( 1, &pLineNumber, &fetched );
+            hr = state.FindLineEnum->Next( 1, &pLineNumber, &fetched );
         if( hr == S_OK )
             hr = setLineNumber( pLineNumber, 0, lineNumber );
         else
-            releaseFindLineEnumLineNumbers();
+            releaseFindLineEnumLineNumbers( state );
 
         if( pLineNumber )
             pLineNumber->Release();
@@ -1279,8 +1492,11 @@ namespace MagoST
     }
 
     bool PDBDebugStore::FindLines( bool exactMatch, const char* fileName, size_t fileNameLen, uint16_t reqLineStart, uint16_t reqLineEnd, 
-                                   std::list<LineNumber>& lines )
+                                   std::vector<LineNumber>& lines )
     {
+        if ( mPdbReader.get() != NULL )
+            return findLinesNative( exactMatch, fileName, fileNameLen, reqLineStart, reqLineEnd, lines );
+
         IDiaEnumSymbols *pEnumSymbols = NULL;
         HRESULT hr = mGlobal->findChildren( SymTagCompiland, NULL, nsNone, &pEnumSymbols );
         if( !FAILED( hr ) )
@@ -1345,5 +1561,38 @@ namespace MagoST
             pEnumSymbols->Release();
         return lines.size() > 0;
     }
+
+    bool PDBDebugStore::findLinesNative( bool exactMatch, const char* fileName, size_t fileNameLen, uint16_t reqLineStart, uint16_t reqLineEnd, 
+                                         std::vector<LineNumber>& lines )
+    {
+        uint32_t    modCount = mPdbReader->GetModuleCount();
+
+        for ( uint32_t modIndex = 0; modIndex < modCount; modIndex++ )
+        {
+            uint16_t    fileCount = 0;
+
+            if ( !mPdbReader->GetFileCount( modIndex, fileCount ) )
+                continue;
+
+            for ( uint16_t fileIndex = 0; fileIndex < fileCount; fileIndex++ )
+            {
+                SymString   srcFileName;
+                uint16_t    segmentCount = 0;
+                bool        matches = false;
+
+                if ( !mPdbReader->GetFileInfo( modIndex, fileIndex, srcFileName, segmentCount ) )
+                    continue;
+
+                if ( exactMatch )
+                    matches = ExactFileNameMatch( fileName, fileNameLen, srcFileName.GetName(), srcFileName.GetLength() );
+                else
+                    matches = PartialFileNameMatch( fileName, fileNameLen, srcFileName.GetName(), srcFileName.GetLength() );
+
+                if ( matches )
+                    mPdbReader->FindLines( modIndex, fileIndex, reqLineStart, reqLineEnd, lines );
+            }
+        }
+        return lines.size() > 0;
+    }
 }
 
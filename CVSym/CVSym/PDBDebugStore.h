@@ -8,6 +8,8 @@
 #pragma once
 
 #include "DebugStore.h"
+#include "PDBReader.h"
+#include "C13SymbolStore.h"
 
 struct IDiaDataSource;
 struct IDiaSession;
@@ -20,6 +22,17 @@ namespace MagoST
 {
     class PDBDebugStore : public IDebugStore
     {
+        // What the DIA calls remember from one call to the next. Each thread 
+        // has its own, so that line searches on different threads don't 
+        // disturb each other.
+        struct DiaThreadState
+        {
+            IDiaEnumLineNumbers*    FindLineEnum;
+            std::vector<DWORD>      SegInfoOffsets;
+            std::vector<WORD>       SegInfoLineNumbers;
+        };
+
+        typedef std::map<DWORD, DiaThreadState> DiaThreadStateMap;
 
     public:
         PDBDebugStore();
@@ -29,6 +42,13 @@ namespace MagoST
         void CloseDebugInfo();
         IDiaSession* getSession() const { return mSession; }
 
+        // Closes PDBReader and C13SymbolStore, so that lines, symbols, and 
+        // types come from DIA after this. CVSymBench uses it to time and 
+        // check DIA against the native readers on the same PDB.
+        void CloseNativeReaders();
+        bool HasNativeLines() const { return mPdbReader.get() != NULL; }
+        bool HasNativeSymbols() const { return mNativeSymbols.get() != NULL; }
+
         // symbols
 
         virtual HRESULT SetSymbolScope( SymbolHeapId heapId, SymbolScope& scope );
@@ -74,11 +94,16 @@ namespace MagoST
         virtual bool    FindNextLineByNum( uint16_t compIndex, uint16_t fileIndex, uint16_t line, LineNumber& lineNumber );
 
         virtual bool    FindLines( bool exactMatch, const char* fileName, size_t fileNameLen, uint16_t reqLineStart, uint16_t reqLineEnd, 
-                                   std::list<LineNumber>& );
+                                   std::vector<LineNumber>& );
 
     private:
-        void releaseFindLineEnumLineNumbers();
-        HRESULT fillFileSegmentInfo( IDiaEnumLineNumbers *pEnumLineNumbers, FileSegmentInfo& segInfo );
+        HRESULT openPdbReader( BYTE* buffer, DWORD size );
+        void closePdbReader();
+        bool findLinesNative( bool exactMatch, const char* fileName, size_t fileNameLen, uint16_t reqLineStart, uint16_t reqLineEnd, 
+                              std::vector<LineNumber>& lines );
+        DiaThreadState& getDiaThreadState();
+        void releaseFindLineEnumLineNumbers( DiaThreadState& state );
+        HRESULT fillFileSegmentInfo( IDiaEnumLineNumbers *pEnumLineNumbers, DiaThreadState& state, FileSegmentInfo& segInfo );
         HRESULT findCompilandAndFile( IDiaSymbol *pCompiland, IDiaSourceFile *pSourceFile, uint16_t& compIndex, uint16_t& fileIndex );
         HRESULT setLineNumber( IDiaLineNumber* pLineNumber, uint16_t lineIndex, LineNumber& lineNumber );
         uint32_t getCompilandCount();
@@ -87,14 +112,19 @@ namespace MagoST
         IDiaDataSource  *mSource;
         IDiaSession     *mSession;
         IDiaSymbol      *mGlobal;
-        IDiaEnumLineNumbers *mFindLineEnumLineNumbers;
 
         DWORD            mMachineType;
         long             mCompilandCount;
 
-        std::auto_ptr<char>  mLastCompilandName;
-        std::auto_ptr<char>  mLastFileInfoName;
-        std::auto_ptr<DWORD> mLastSegInfoOffsets;
-        std::auto_ptr<WORD>  mLastSegInfoLineNumbers;
+        DiaThreadStateMap   mDiaThreadStates;
+        Guard               mDiaThreadStateGuard;
+
+        // Source lines are read straight from the PDB, when it can be opened
+        // and it matches the image. Otherwise they come from DIA.
+        std::auto_ptr<PDBReader> mPdbReader;
+        BYTE*            mPdbView;
+        // Symbols and types are too, when the PDB's type and symbol record
+        // streams can be read.
+        std::auto_ptr<C13SymbolStore> mNativeSymbols;
     };
 }
@@ -0,0 +1,1029 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#include "Common.h"
+#include "PDBReader.h"
+
+
+namespace MagoST
+{
+    enum PDBStreams
+    {
+        PDBStream_Info = 1,
+        PDBStream_Dbi = 3,
+    };
+
+    const uint32_t  NamesSignature = 0xEFFEEFFE;
+    const uint32_t  SectionContribV60 = 0xEFFE0000 + 19970605;
+    const uint32_t  SectionContribV2 = 0xEFFE0000 + 20140516;
+    const uint32_t  ModuleSymSignatureC13 = 4;
+    const uint32_t  NilModuleStream = 0xFFFF;
+
+    // C13 debug subsections
+    const uint32_t  DebugSubsectionIgnore = 0x80000000;
+    const uint32_t  DebugSubsectionLines = 0xF2;
+    const uint32_t  DebugSubsectionFileChecksums = 0xF4;
+
+    const uint16_t  LinesHaveColumns = 1;
+    // compilers mark lines that the debugger should step over with these
+    const uint32_t  HiddenLineStart = 0xF00000;
+
+    struct InfoStreamHeader
+    {
+        uint32_t    Version;
+        uint32_t    Signature;
+        uint32_t    Age;
+        GUID        Guid;
+    };
+
+    struct DbiStreamHeader
+    {
+        int32_t     VersionSignature;
+        uint32_t    VersionHeader;
+        uint32_t    Age;
+        uint16_t    GlobalStreamIndex;
+        uint16_t    BuildNumber;
+        uint16_t    PublicStreamIndex;
+        uint16_t    PdbDllVersion;
+        uint16_t    SymRecordStream;
+        uint16_t    PdbDllRbld;
+        uint32_t    ModInfoSize;
+        uint32_t    SectionContributionSize;
+        uint32_t    SectionMapSize;
+        uint32_t    SourceInfoSize;
+        uint32_t    TypeServerMapSize;
+        uint32_t    MFCTypeServerIndex;
+        uint32_t    OptionalDbgHeaderSize;
+        uint32_t    ECSubstreamSize;
+        uint16_t    Flags;
+        uint16_t    Machine;
+        uint32_t    Padding;
+    };
+
+    struct DbiSectionContrib
+    {
+        uint16_t    Section;
+        uint16_t    Padding1;
+        int32_t     Offset;
+        int32_t     Size;
+        uint32_t    Characteristics;
+        uint16_t    ModuleIndex;
+        uint16_t    Padding2;
+        uint32_t    DataCrc;
+        uint32_t    RelocCrc;
+    };
+
+    struct DbiModInfo
+    {
+        uint32_t            Unused1;
+        DbiSectionContrib   SectionContrib;
+        uint16_t            Flags;
+        uint16_t            ModuleSymStream;
+        uint32_t            SymByteSize;
+        uint32_t            C11ByteSize;
+        uint32_t            C13ByteSize;
+        uint16_t            SourceFileCount;
+        uint16_t            Padding;
+        uint32_t            Unused2;
+        uint32_t            SourceFileNameIndex;
+        uint32_t            PdbFilePathNameIndex;
+        // followed by the module name and the object file name
+    };
+
+    struct DebugSubsectionHeader
+    {
+        uint32_t    Kind;
+        uint32_t    Length;
+    };
+
+    struct LinesHeader
+    {
+        uint32_t    Offset;
+        uint16_t    Segment;
+        uint16_t    Flags;
+        uint32_t    CodeSize;
+    };
+
+    struct LineBlockHeader
+    {
+        uint32_t    ChecksumOffset;
+        uint32_t    LineCount;
+        uint32_t    BlockSize;
+    };
+
+    struct LineEntry
+    {
+        uint32_t    Offset;
+        uint32_t    LineStart : 24;
+        uint32_t    DeltaLineEnd : 7;
+        uint32_t    IsStatement : 1;
+    };
+
+    struct ChecksumEntry
+    {
+        uint32_t    FileNameOffset;
+        uint8_t     ChecksumSize;
+        uint8_t     ChecksumKind;
+        // followed by the checksum
+    };
+
+
+    static uint32_t AlignTo4( uint32_t n )
+    {
+        return (n + 3) & ~3U;
+    }
+
+    // returns the length of a null-terminated string that must end before limit
+    static bool GetStringLength( const BYTE* str, const BYTE* limit, uint32_t& length )
+    {
+        const BYTE* end = (const BYTE*) memchr( str, 0, limit - str );
+
+        if ( end == NULL )
+            return false;
+
+        length = (uint32_t) (end - str);
+        return true;
+    }
+
+
+    PDBReader::PDBReader()
+        :   mAge( 0 ),
+            mNames( NULL ),
+            mNamesSize( 0 ),
+            mGlobalStream( NilModuleStream ),
+            mPublicStream( NilModuleStream ),
+            mSymRecordStream( NilModuleStream ),
+            mMachine( 0 )
+    {
+        memset( &mGuid, 0, sizeof mGuid );
+    }
+
+    HRESULT PDBReader::Init( const BYTE* base, uint32_t size )
+    {
+        HRESULT     hr = S_OK;
+        uint32_t    namesStream = 0;
+
+        hr = mMSF.Init( base, size );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = ReadInfoStream( namesStream );
+        if ( FAILED( hr ) )
+            return hr;
+
+        if ( namesStream != 0 )
+        {
+            hr = ReadNames( namesStream );
+            if ( FAILED( hr ) )
+                return hr;
+        }
+
+        hr = ReadDbiStream();
+        if ( FAILED( hr ) )
+            return hr;
+
+        return S_OK;
+    }
+
+    bool PDBReader::Matches( const GUID& guid, uint32_t age )
+    {
+        return (memcmp( &guid, &mGuid, sizeof guid ) == 0) && (age == mAge);
+    }
+
+    HRESULT PDBReader::ReadInfoStream( uint32_t& namesStream )
+    {
+        const BYTE*     data = NULL;
+        uint32_t        size = 0;
+
+        if ( !mMSF.GetStream( PDBStream_Info, data, size ) )
+            return E_BAD_FORMAT;
+
+        if ( size < sizeof( InfoStreamHeader ) + sizeof( uint32_t ) )
+            return E_BAD_FORMAT;
+
+        const InfoStreamHeader* header = (const InfoStreamHeader*) data;
+        const BYTE*             limit = data + size;
+
+        mGuid = header->Guid;
+
+        // The named stream map: a buffer of names, then a hash table of
+        // (name offset, stream) pairs, whose present buckets are marked in a
+        // bit vector.
+
+        const BYTE*     p = data + sizeof( InfoStreamHeader );
+        uint32_t        namesSize = *(const uint32_t*) p;
+        const BYTE*     streamNames = p + sizeof( uint32_t );
+
+        if ( namesSize > (uint32_t) (limit - streamNames) )
+            return E_BAD_FORMAT;
+
+        p = streamNames + namesSize;
+
+        if ( (limit - p) < 3 * (int) sizeof( uint32_t ) )
+            return E_BAD_FORMAT;
+
+        uint32_t        entryCount = ((const uint32_t*) p)[0];
+        uint32_t        presentWordCount = ((const uint32_t*) p)[2];
+
+        p += 3 * sizeof( uint32_t );
+
+        if ( presentWordCount > (uint32_t) (limit - p) / sizeof( uint32_t ) )
+            return E_BAD_FORMAT;
+
+        p += presentWordCount * sizeof( uint32_t );
+
+        if ( (limit - p) < (int) sizeof( uint32_t ) )
+            return E_BAD_FORMAT;
+
+        uint32_t        deletedWordCount = *(const uint32_t*) p;
+
+        p += sizeof( uint32_t );
+
+        if ( deletedWordCount > (uint32_t) (limit - p) / sizeof( uint32_t ) )
+            return E_BAD_FORMAT;
+
+        p += deletedWordCount * sizeof( uint32_t );
+
+        if ( entryCount > (uint32_t) (limit - p) / (2 * sizeof( uint32_t )) )
+            return E_BAD_FORMAT;
+
+        const uint32_t* entries = (const uint32_t*) p;
+
+        namesStream = 0;
+
+        for ( uint32_t i = 0; i < entryCount; i++ )
+        {
+            uint32_t    nameOffset = entries[i * 2];
+            uint32_t    stream = entries[(i * 2) + 1];
+            uint32_t    nameLen = 0;
+
+            if ( nameOffset >= namesSize )
+                return E_BAD_FORMAT;
+
+            if ( !GetStringLength( streamNames + nameOffset, streamNames + namesSize, nameLen ) )
+                return E_BAD_FORMAT;
+
+            if ( strcmp( (const char*) streamNames + nameOffset, "/names" ) == 0 )
+                namesStream = stream;
+        }
+
+        return S_OK;
+    }
+
+    HRESULT PDBReader::ReadNames( uint32_t namesStream )
+    {
+        const BYTE*     data = NULL;
+        uint32_t        size = 0;
+
+        if ( !mMSF.GetStream( namesStream, data, size ) )
+            return E_BAD_FORMAT;
+
+        if ( size < 3 * sizeof( uint32_t ) )
+            return E_BAD_FORMAT;
+
+        const uint32_t* header = (const uint32_t*) data;
+
+        if ( header[0] != NamesSignature )
+            return E_BAD_FORMAT;
+
+        if ( header[2] > size - 3 * sizeof( uint32_t ) )
+            return E_BAD_FORMAT;
+
+        mNames = data + 3 * sizeof( uint32_t );
+        mNamesSize = header[2];
+
+        return S_OK;
+    }
+
+    HRESULT PDBReader::ReadDbiStream()
+    {
+        HRESULT         hr = S_OK;
+        const BYTE*     data = NULL;
+        uint32_t        size = 0;
+
+        if ( !mMSF.GetStream( PDBStream_Dbi, data, size ) )
+            return E_BAD_FORMAT;
+
+        if ( size < sizeof( DbiStreamHeader ) )
+            return E_BAD_FORMAT;
+
+        const DbiStreamHeader*  header = (const DbiStreamHeader*) data;
+        const BYTE*             p = data + sizeof( DbiStreamHeader );
+        uint32_t                sizeLeft = size - sizeof( DbiStreamHeader );
+
+        mAge = header->Age;
+        mGlobalStream = header->GlobalStreamIndex;
+        mPublicStream = header->PublicStreamIndex;
+        mSymRecordStream = header->SymRecordStream;
+        mMachine = header->Machine;
+
+        if ( (header->ModInfoSize > sizeLeft)
+            || (header->SectionContributionSize > sizeLeft - header->ModInfoSize) )
+            return E_BAD_FORMAT;
+
+        hr = ReadModules( p, header->ModInfoSize );
+        if ( FAILED( hr ) )
+            return hr;
+
+        p += header->ModInfoSize;
+
+        hr = ReadSectionContribs( p, header->SectionContributionSize );
+        if ( FAILED( hr ) )
+            return hr;
+
+        return S_OK;
+    }
+
+    HRESULT PDBReader::ReadModules( const BYTE* data, uint32_t size )
+    {
+        const BYTE* p = data;
+        const BYTE* limit = data + size;
+
+        while ( (uint32_t) (limit - p) >= sizeof( DbiModInfo ) )
+        {
+            const DbiModInfo*   modInfo = (const DbiModInfo*) p;
+            const BYTE*         modName = p + sizeof( DbiModInfo );
+            uint32_t            modNameLen = 0;
+            uint32_t            objNameLen = 0;
+
+            if ( !GetStringLength( modName, limit, modNameLen ) )
+                return E_BAD_FORMAT;
+
+            if ( !GetStringLength( modName + modNameLen + 1, limit, objNameLen ) )
+                return E_BAD_FORMAT;
+
+            Module  mod;
+
+            mod.Name = (const char*) modName;
+            mod.NameLen = modNameLen;
+            mod.SymStream = modInfo->ModuleSymStream;
+            mod.SymByteSize = modInfo->SymByteSize;
+            mod.C11ByteSize = modInfo->C11ByteSize;
+            mod.C13ByteSize = modInfo->C13ByteSize;
+            mod.LinesLoaded = false;
+
+            mModules.push_back( mod );
+
+            uint32_t    recSize = sizeof( DbiModInfo ) + modNameLen + 1 + objNameLen + 1;
+
+            recSize = AlignTo4( recSize );
+
+            if ( recSize >= (uint32_t) (limit - p) )
+                break;
+
+            p += recSize;
+        }
+
+        // compiland indexes are 16 bits
+        if ( mModules.size() > 0xFFFF )
+            return E_BAD_FORMAT;
+
+        return S_OK;
+    }
+
+    HRESULT PDBReader::ReadSectionContribs( const BYTE* data, uint32_t size )
+    {
+        if ( size < sizeof( uint32_t ) )
+            return S_OK;
+
+        uint32_t    version = *(const uint32_t*) data;
+        uint32_t    entrySize = 0;
+
+        if ( version == SectionContribV60 )
+            entrySize = sizeof( DbiSectionContrib );
+        else if ( version == SectionContribV2 )
+            entrySize = sizeof( DbiSectionContrib ) + sizeof( uint32_t );
+        else
+            return S_OK;
+
+        uint32_t    count = (size - sizeof( uint32_t )) / entrySize;
+        const BYTE* p = data + sizeof( uint32_t );
+
+        mContribs.reserve( count );
+
+        for ( uint32_t i = 0; i < count; i++, p += entrySize )
+        {
+            const DbiSectionContrib*    entry = (const DbiSectionContrib*) p;
+            SectionContrib              contrib;
+
+            if ( (entry->Size <= 0) || (entry->ModuleIndex >= mModules.size()) )
+                continue;
+
+            contrib.Section = entry->Section;
+            contrib.Offset = (uint32_t) entry->Offset;
+            contrib.Size = (uint32_t) entry->Size;
+            contrib.Module = entry->ModuleIndex;
+
+            mContribs.push_back( contrib );
+        }
+
+        std::sort( mContribs.begin(), mContribs.end(), SectionContribLess );
+
+        return S_OK;
+    }
+
+    uint32_t PDBReader::GetModuleCount()
+    {
+        return (uint32_t) mModules.size();
+    }
+
+    bool PDBReader::GetModuleName( uint32_t modIndex, SymString& name )
+    {
+        if ( modIndex >= mModules.size() )
+            return false;
+
+        name.set( mModules[modIndex].NameLen, mModules[modIndex].Name, false );
+        return true;
+    }
+
+    bool PDBReader::GetStream( uint32_t index, const BYTE*& data, uint32_t& size )
+    {
+        return mMSF.GetStream( index, data, size );
+    }
+
+    bool PDBReader::GetModuleSymbols( uint32_t modIndex, const BYTE*& data, uint32_t& size )
+    {
+        if ( modIndex >= mModules.size() )
+            return false;
+
+        const Module&   mod = mModules[modIndex];
+        const BYTE*     streamData = NULL;
+        uint32_t        streamSize = 0;
+
+        data = NULL;
+        size = 0;
+
+        if ( (mod.SymStream == NilModuleStream) || (mod.SymByteSize == 0) )
+            return true;
+
+        if ( !mMSF.GetStream( mod.SymStream, streamData, streamSize ) )
+            return false;
+
+        if ( (mod.SymByteSize < sizeof( uint32_t )) || (mod.SymByteSize > streamSize) )
+            return false;
+
+        if ( *(const uint32_t*) streamData != ModuleSymSignatureC13 )
+            return false;
+
+        data = streamData;
+        size = mod.SymByteSize;
+        return true;
+    }
+
+    uint32_t PDBReader::GetGlobalStream()
+    {
+        return mGlobalStream;
+    }
+
+    uint32_t PDBReader::GetPublicStream()
+    {
+        return mPublicStream;
+    }
+
+    uint32_t PDBReader::GetSymRecordStream()
+    {
+        return mSymRecordStream;
+    }
+
+    uint16_t PDBReader::GetMachine()
+    {
+        return mMachine;
+    }
+
+    bool PDBReader::GetFileCount( uint32_t modIndex, uint16_t& fileCount )
+    {
+        Module* mod = GetLoadedModule( modIndex );
+
+        if ( mod == NULL )
+            return false;
+
+        fileCount = (uint16_t) mod->Files.size();
+        return true;
+    }
+
+    bool PDBReader::GetFileInfo( uint32_t modIndex, uint16_t fileIndex, SymString& name, uint16_t& segmentCount )
+    {
+        Module* mod = GetLoadedModule( modIndex );
+
+        if ( (mod == NULL) || (fileIndex >= mod->Files.size()) )
+            return false;
+
+        const ModuleFile&   file = mod->Files[fileIndex];
+
+        name.set( file.NameLen, file.Name, false );
+        segmentCount = (uint16_t) file.Blocks.size();
+        return true;
+    }
+
+    bool PDBReader::GetFileSegment( uint32_t modIndex, uint16_t fileIndex, uint16_t segInstanceIndex, FileSegmentInfo& segInfo )
+    {
+        Module* mod = GetLoadedModule( modIndex );
+
+        if ( (mod == NULL) || (fileIndex >= mod->Files.size()) )
+            return false;
+
+        const ModuleFile&   file = mod->Files[fileIndex];
+
+        if ( segInstanceIndex >= file.Blocks.size() )
+            return false;
+
+        const LineBlock&    block = mod->Blocks[file.Blocks[segInstanceIndex]];
+
+        segInfo.SegmentIndex = block.Section;
+        segInfo.SegmentInstance = segInstanceIndex;
+        segInfo.Start = block.Start;
+        segInfo.End = block.End;
+        segInfo.LineCount = block.LineCount;
+
+        if ( block.LineCount > 0 )
+        {
+            segInfo.Offsets = &mod->Offsets[block.FirstLine];
+            segInfo.LineNumbers = &mod->Numbers[block.FirstLine];
+        }
+        else
+        {
+            segInfo.Offsets = NULL;
+            segInfo.LineNumbers = NULL;
+        }
+        return true;
+    }
+
+    bool PDBReader::FindLine( WORD seg, uint32_t offset, LineNumber& lineNumber )
+    {
+        if ( mContribs.empty() )
+        {
+            for ( uint32_t i = 0; i < mModules.size(); i++ )
+            {
+                Module* mod = GetLoadedModule( i );
+
+                if ( (mod != NULL) && FindLineInModule( *mod, i, seg, offset, lineNumber ) )
+                    return true;
+            }
+            return false;
+        }
+
+        SectionContrib  key = { 0 };
+
+        key.Section = seg;
+        key.Offset = offset;
+
+        std::vector<SectionContrib>::const_iterator it =
+            std::upper_bound( mContribs.begin(), mContribs.end(), key, SectionContribLess );
+
+        if ( it == mContribs.begin() )
+            return false;
+
+        it--;
+
+        if ( (it->Section != seg) || (offset - it->Offset >= it->Size) )
+            return false;
+
+        Module* mod = GetLoadedModule( it->Module );
+
+        if ( mod == NULL )
+            return false;
+
+        return FindLineInModule( *mod, it->Module, seg, offset, lineNumber );
+    }
+
+    bool PDBReader::FindLineInModule( Module& mod, uint32_t modIndex, WORD seg, uint32_t offset, LineNumber& lineNumber )
+    {
+        LineAddress key = { 0 };
+
+        key.Section = seg;
+        key.Offset = offset;
+        key.Line = UINT_MAX;
+
+        std::vector<LineAddress>::const_iterator it =
+            std::upper_bound( mod.ByAddress.begin(), mod.ByAddress.end(), key, LineAddressLess );
+
+        if ( it == mod.ByAddress.begin() )
+            return false;
+
+        it--;
+
+        if ( (it->Section != seg) || (offset - it->Offset >= mod.Lengths[it->Line]) )
+            return false;
+
+        // the first line at that address
+        key.Offset = it->Offset;
+        key.Line = 0;
+
+        std::vector<LineAddress>::const_iterator    itBegin = mod.ByAddress.begin();
+
+        it = std::lower_bound( itBegin, it, key, LineAddressLess );
+
+        SetLineNumber( mod, modIndex, it->Line, lineNumber );
+        return true;
+    }
+
+    // Like DIA, finds the lines with the closest number at or after the one
+    // asked for. The rest of them come from FindNextLineByNum.
+
+    bool PDBReader::FindLineByNum( uint32_t modIndex, uint16_t fileIndex, uint16_t line, LineNumber& lineNumber )
+    {
+        Module* mod = GetLoadedModule( modIndex );
+
+        if ( (mod == NULL) || (fileIndex >= mod->Files.size()) )
+            return false;
+
+        LineNum     key = { 0 };
+
+        key.FileIndex = fileIndex;
+        key.Number = line;
+
+        std::vector<LineNum>::const_iterator it =
+            std::lower_bound( mod->ByNumber.begin(), mod->ByNumber.end(), key, LineNumLess );
+
+        if ( (it == mod->ByNumber.end()) || (it->FileIndex != fileIndex) )
+            return false;
+
+        SetLineNumber( *mod, modIndex, it->Line, lineNumber );
+        return true;
+    }
+
+    bool PDBReader::FindNextLineByNum( uint32_t modIndex, uint16_t fileIndex, LineNumber& lineNumber )
+    {
+        Module* mod = GetLoadedModule( modIndex );
+
+        if ( (mod == NULL) || (fileIndex >= mod->Files.size()) )
+            return false;
+
+        const ModuleFile&   file = mod->Files[fileIndex];
+
+        if ( lineNumber.SegmentInstanceIndex >= file.Blocks.size() )
+            return false;
+
+        // continue from the previous result
+        LineNum     key = { 0 };
+
+        key.FileIndex = fileIndex;
+        key.Number = lineNumber.Number;
+        key.Line = mod->Blocks[file.Blocks[lineNumber.SegmentInstanceIndex]].FirstLine + lineNumber.LineIndex;
+
+        std::vector<LineNum>::const_iterator it =
+            std::upper_bound( mod->ByNumber.begin(), mod->ByNumber.end(), key, LineNumLess );
+
+        if ( (it == mod->ByNumber.end())
+            || (it->FileIndex != fileIndex)
+            || (it->Number != lineNumber.Number) )
+            return false;
+
+        SetLineNumber( *mod, modIndex, it->Line, lineNumber );
+        return true;
+    }
+
+    void PDBReader::FindLines( uint32_t modIndex, uint16_t fileIndex, uint16_t reqLineStart, uint16_t reqLineEnd,
+                               std::vector<LineNumber>& lines )
+    {
+        LineNumber  lineNumber = { 0 };
+
+        if ( !FindLineByNum( modIndex, fileIndex, reqLineStart, lineNumber ) )
+            return;
+
+        // do the line ranges overlap?
+        if ( (lineNumber.Number > reqLineEnd) || (lineNumber.NumberEnd < reqLineStart) )
+            return;
+
+        do
+        {
+            lines.push_back( lineNumber );
+        }
+        while ( FindNextLineByNum( modIndex, fileIndex, lineNumber ) );
+    }
+
+    void PDBReader::SetLineNumber( const Module& mod, uint32_t modIndex, uint32_t line, LineNumber& lineNumber )
+    {
+        const LineBlock&    block = mod.Blocks[mod.LineBlocks[line]];
+
+        lineNumber.CompilandIndex = (uint16_t) (modIndex + 1);
+        lineNumber.FileIndex = block.FileIndex;
+        lineNumber.SegmentInstanceIndex = block.SegmentInstance;
+        lineNumber.LineIndex = (uint16_t) (line - block.FirstLine);
+        lineNumber.Number = mod.Numbers[line];
+        lineNumber.NumberEnd = mod.NumberEnds[line];
+        lineNumber.Section = block.Section;
+        lineNumber.Offset = mod.Offsets[line];
+        lineNumber.Length = mod.Lengths[line];
+    }
+
+    PDBReader::Module* PDBReader::GetLoadedModule( uint32_t modIndex )
+    {
+        if ( modIndex >= mModules.size() )
+            return NULL;
+
+        Module& mod = mModules[modIndex];
+
+        if ( mod.LinesLoaded )
+            return &mod;
+
+        // Only loading takes the lock. Once a module's lines are loaded, 
+        // they're only read, so any number of threads can search them.
+        GuardedArea guard( mLoadGuard );
+
+        if ( !mod.LinesLoaded )
+        {
+            // a module whose lines can't be read acts like one without lines
+            if ( FAILED( LoadLines( mod ) ) )
+            {
+                mod.Files.clear();
+                mod.Blocks.clear();
+                mod.Offsets.clear();
+                mod.Numbers.clear();
+                mod.NumberEnds.clear();
+                mod.Lengths.clear();
+                mod.LineBlocks.clear();
+                mod.ByAddress.clear();
+                mod.ByNumber.clear();
+            }
+
+            mod.LinesLoaded = true;
+        }
+
+        return &mod;
+    }
+
+    HRESULT PDBReader::LoadLines( Module& mod )
+    {
+        HRESULT     hr = S_OK;
+        const BYTE* data = NULL;
+        uint32_t    size = 0;
+
+        if ( (mod.SymStream == NilModuleStream) || (mod.C13ByteSize == 0) )
+            return S_OK;
+
+        if ( !mMSF.GetStream( mod.SymStream, data, size ) )
+            return E_BAD_FORMAT;
+
+        if ( (mod.SymByteSize < sizeof( uint32_t ))
+            || (mod.SymByteSize > size)
+            || (mod.C11ByteSize > size - mod.SymByteSize)
+            || (mod.C13ByteSize > size - mod.SymByteSize - mod.C11ByteSize) )
+            return E_BAD_FORMAT;
+
+        if ( *(const uint32_t*) data != ModuleSymSignatureC13 )
+            return E_BAD_FORMAT;
+
+        const BYTE* c13 = data + mod.SymByteSize + mod.C11ByteSize;
+        const BYTE* limit = c13 + mod.C13ByteSize;
+
+        // line blocks refer to files by their checksum entries, which can
+        // come after them, so the checksums are read in a first pass
+        for ( int pass = 0; pass < 2; pass++ )
+        {
+            const BYTE* p = c13;
+
+            while ( (uint32_t) (limit - p) >= sizeof( DebugSubsectionHeader ) )
+            {
+                const DebugSubsectionHeader*    header = (const DebugSubsectionHeader*) p;
+                const BYTE*                     subData = p + sizeof( DebugSubsectionHeader );
+
+                if ( header->Length > (uint32_t) (limit - subData) )
+                    return E_BAD_FORMAT;
+
+                uint32_t    kind = header->Kind & ~DebugSubsectionIgnore;
+
+                if ( (header->Kind & DebugSubsectionIgnore) != 0 )
+                    kind = 0;
+
+                if ( (pass == 0) && (kind == DebugSubsectionFileChecksums) )
+                    hr = ReadChecksums( mod, subData, header->Length );
+                else if ( (pass == 1) && (kind == DebugSubsectionLines) )
+                    hr = ReadLines( mod, subData, header->Length );
+
+                if ( FAILED( hr ) )
+                    return hr;
+
+                uint32_t    advance = AlignTo4( header->Length );
+
+                if ( advance > (uint32_t) (limit - subData) )
+                    break;
+
+                p = subData + advance;
+            }
+        }
+
+        mod.ByAddress.reserve( mod.Offsets.size() );
+        mod.ByNumber.reserve( mod.Offsets.size() );
+
+        for ( uint32_t i = 0; i < mod.Offsets.size(); i++ )
+        {
+            const LineBlock&    block = mod.Blocks[mod.LineBlocks[i]];
+            LineAddress         addr;
+            LineNum             num;
+
+            addr.Section = block.Section;
+            addr.Offset = mod.Offsets[i];
+            addr.Line = i;
+            mod.ByAddress.push_back( addr );
+
+            num.FileIndex = block.FileIndex;
+            num.Number = mod.Numbers[i];
+            num.Line = i;
+            mod.ByNumber.push_back( num );
+        }
+
+        std::sort( mod.ByAddress.begin(), mod.ByAddress.end(), LineAddressLess );
+        std::sort( mod.ByNumber.begin(), mod.ByNumber.end(), LineNumLess );
+
+        return S_OK;
+    }
+
+    HRESULT PDBReader::ReadChecksums( Module& mod, const BYTE* data, uint32_t size )
+    {
+        const BYTE* p = data;
+        const BYTE* limit = data + size;
+
+        while ( (uint32_t) (limit - p) >= sizeof( ChecksumEntry ) )
+        {
+            const ChecksumEntry*    entry = (const ChecksumEntry*) p;
+            ModuleFile              file;
+
+            file.ChecksumOffset = (uint32_t) (p - data);
+            file.Name = "";
+            file.NameLen = 0;
+
+            if ( (mNames != NULL) && (entry->FileNameOffset < mNamesSize) )
+            {
+                uint32_t    nameLen = 0;
+
+                if ( GetStringLength( mNames + entry->FileNameOffset, mNames + mNamesSize, nameLen ) )
+                {
+                    file.Name = (const char*) mNames + entry->FileNameOffset;
+                    file.NameLen = nameLen;
+                }
+            }
+
+            if ( mod.Files.size() >= 0xFFFF )
+                return E_BAD_FORMAT;
+
+            mod.Files.push_back( file );
+
+            uint32_t    entrySize = AlignTo4( sizeof( ChecksumEntry ) + entry->ChecksumSize );
+
+            if ( entrySize >= (uint32_t) (limit - p) )
+                break;
+
+            p += entrySize;
+        }
+
+        return S_OK;
+    }
+
+    HRESULT PDBReader::ReadLines( Module& mod, const BYTE* data, uint32_t size )
+    {
+        if ( size < sizeof( LinesHeader ) )
+            return E_BAD_FORMAT;
+
+        const LinesHeader*  header = (const LinesHeader*) data;
+        const BYTE*         p = data + sizeof( LinesHeader );
+        const BYTE*         limit = data + size;
+        uint32_t            columnSize = 0;
+        uint32_t            codeEnd = header->Offset + header->CodeSize;
+        std::vector<uint32_t>   subsectionOffsets;
+
+        if ( (header->Flags & LinesHaveColumns) != 0 )
+            columnSize = 2 * sizeof( uint16_t );
+
+        // Hidden lines aren't kept, but they still end the lines before them.
+        // So collect every address in the subsection to find line lengths.
+
+        for ( const BYTE* blockPtr = p; (uint32_t) (limit - blockPtr) >= sizeof( LineBlockHeader ); )
+        {
+            const LineBlockHeader*  blockHeader = (const LineBlockHeader*) blockPtr;
+
+            if ( (blockHeader->BlockSize < sizeof( LineBlockHeader ))
+                || (blockHeader->BlockSize > (uint32_t) (limit - blockPtr))
+                || (blockHeader->LineCount > (blockHeader->BlockSize - sizeof( LineBlockHeader )) / (sizeof( LineEntry ) + columnSize)) )
+                return E_BAD_FORMAT;
+
+            const LineEntry*    entries = (const LineEntry*) (blockPtr + sizeof( LineBlockHeader ));
+
+            for ( uint32_t i = 0; i < blockHeader->LineCount; i++ )
+                subsectionOffsets.push_back( header->Offset + entries[i].Offset );
+
+            blockPtr += blockHeader->BlockSize;
+        }
+
+        std::sort( subsectionOffsets.begin(), subsectionOffsets.end() );
+
+        while ( (uint32_t) (limit - p) >= sizeof( LineBlockHeader ) )
+        {
+            const LineBlockHeader*  blockHeader = (const LineBlockHeader*) p;
+            const LineEntry*        entries = (const LineEntry*) (p + sizeof( LineBlockHeader ));
+            int                     fileIndex = FindFileByChecksum( mod, blockHeader->ChecksumOffset );
+
+            p += blockHeader->BlockSize;
+
+            if ( fileIndex < 0 )
+                return E_BAD_FORMAT;
+
+            ModuleFile& file = mod.Files[fileIndex];
+            LineBlock   block = { 0 };
+
+            if ( (mod.Blocks.size() >= 0xFFFF) || (file.Blocks.size() >= 0xFFFF) )
+                return E_BAD_FORMAT;
+
+            block.FileIndex = (uint16_t) fileIndex;
+            block.Section = header->Segment;
+            block.SegmentInstance = (uint16_t) file.Blocks.size();
+            block.FirstLine = (uint32_t) mod.Offsets.size();
+            block.Start = UINT_MAX;
+            block.End = 0;
+
+            for ( uint32_t i = 0; i < blockHeader->LineCount; i++ )
+            {
+                if ( entries[i].LineStart >= HiddenLineStart )
+                    continue;
+
+                uint32_t    offset = header->Offset + entries[i].Offset;
+                uint32_t    end = codeEnd;
+
+                std::vector<uint32_t>::const_iterator   itNext =
+                    std::upper_bound( subsectionOffsets.begin(), subsectionOffsets.end(), offset );
+
+                if ( itNext != subsectionOffsets.end() )
+                    end = *itNext;
+
+                if ( end < offset )
+                    end = offset;
+
+                mod.Offsets.push_back( offset );
+                mod.Numbers.push_back( (WORD) entries[i].LineStart );
+                mod.NumberEnds.push_back( (WORD) (entries[i].LineStart + entries[i].DeltaLineEnd) );
+                mod.Lengths.push_back( end - offset );
+                mod.LineBlocks.push_back( (uint16_t) mod.Blocks.size() );
+
+                if ( offset < block.Start )
+                    block.Start = offset;
+                if ( (end > offset) && (end - 1 > block.End) )
+                    block.End = end - 1;
+            }
+
+            block.LineCount = (uint16_t) (mod.Offsets.size() - block.FirstLine);
+
+            // a block of nothing but hidden lines isn't a segment instance
+            if ( block.LineCount == 0 )
+                continue;
+
+            if ( block.End < block.Start )
+                block.End = block.Start;
+
+            file.Blocks.push_back( (uint16_t) mod.Blocks.size() );
+            mod.Blocks.push_back( block );
+        }
+
+        return S_OK;
+    }
+
+    // the entries were read in order, so their offsets are sorted
+    int PDBReader::FindFileByChecksum( Module& mod, uint32_t checksumOffset )
+    {
+        size_t  lo = 0;
+        size_t  hi = mod.Files.size();
+
+        while ( lo < hi )
+        {
+            size_t  mid = lo + (hi - lo) / 2;
+
+            if ( mod.Files[mid].ChecksumOffset < checksumOffset )
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        if ( (lo == mod.Files.size()) || (mod.Files[lo].ChecksumOffset != checksumOffset) )
+            return -1;
+
+        return (int) lo;
+    }
+
+    bool PDBReader::LineAddressLess( const LineAddress& left, const LineAddress& right )
+    {
+        if ( left.Section != right.Section )
+            return left.Section < right.Section;
+        if ( left.Offset != right.Offset )
+            return left.Offset < right.Offset;
+        return left.Line < right.Line;
+    }
+
+    bool PDBReader::LineNumLess( const LineNum& left, const LineNum& right )
+    {
+        if ( left.FileIndex != right.FileIndex )
+            return left.FileIndex < right.FileIndex;
+        if ( left.Number != right.Number )
+            return left.Number < right.Number;
+        return left.Line < right.Line;
+    }
+
+    bool PDBReader::SectionContribLess( const SectionContrib& left, const SectionContrib& right )
+    {
+        if ( left.Section != right.Section )
+            return left.Section < right.Section;
+        return left.Offset < right.Offset;
+    }
+}
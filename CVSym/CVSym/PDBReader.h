@@ -0,0 +1,158 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+#include "MSFFile.h"
+
+
+namespace MagoST
+{
+    // Reads the modules and source lines of a PDB straight from its streams,
+    // without going through DIA.
+    //
+    // The module list and section contributions are read when the PDB is
+    // opened. The C13 line tables of a module are parsed the first time it's
+    // asked about. Names point into the streams, so they stay valid as long
+    // as the memory passed to Init.
+    //
+    // Files of a module are its file checksum entries, in order. Each block
+    // of lines is one segment instance of its file.
+
+    class PDBReader
+    {
+        struct ModuleFile
+        {
+            uint32_t                ChecksumOffset;
+            const char*             Name;
+            uint32_t                NameLen;
+            std::vector<uint16_t>   Blocks;
+        };
+
+        struct LineBlock
+        {
+            uint16_t    FileIndex;
+            uint16_t    Section;
+            uint16_t    SegmentInstance;
+            uint16_t    LineCount;
+            uint32_t    FirstLine;
+            DWORD       Start;
+            DWORD       End;
+        };
+
+        struct LineAddress
+        {
+            uint16_t    Section;
+            uint32_t    Offset;
+            uint32_t    Line;
+        };
+
+        struct LineNum
+        {
+            uint16_t    FileIndex;
+            uint16_t    Number;
+            uint32_t    Line;
+        };
+
+        struct Module
+        {
+            const char*     Name;
+            uint32_t        NameLen;
+            uint16_t        SymStream;
+            uint32_t        SymByteSize;
+            uint32_t        C11ByteSize;
+            uint32_t        C13ByteSize;
+
+            // set last, after the lines it guards are in place
+            volatile bool   LinesLoaded;
+            std::vector<ModuleFile>     Files;
+            std::vector<LineBlock>      Blocks;
+            // line columns, indexed by LineBlock::FirstLine + index in block
+            std::vector<DWORD>          Offsets;
+            std::vector<WORD>           Numbers;
+            std::vector<WORD>           NumberEnds;
+            std::vector<uint32_t>       Lengths;
+            std::vector<uint16_t>       LineBlocks;
+            std::vector<LineAddress>    ByAddress;
+            std::vector<LineNum>        ByNumber;
+        };
+
+        struct SectionContrib
+        {
+            uint16_t    Section;
+            uint32_t    Offset;
+            uint32_t    Size;
+            uint16_t    Module;
+        };
+
+        MSFFile                     mMSF;
+        GUID                        mGuid;
+        uint32_t                    mAge;
+        const BYTE*                 mNames;
+        uint32_t                    mNamesSize;
+        std::vector<Module>         mModules;
+        std::vector<SectionContrib> mContribs;
+        uint16_t                    mGlobalStream;
+        uint16_t                    mPublicStream;
+        uint16_t                    mSymRecordStream;
+        uint16_t                    mMachine;
+        Guard                       mLoadGuard;
+
+    public:
+        PDBReader();
+
+        HRESULT Init( const BYTE* base, uint32_t size );
+
+        // checks the PDB against the ID that an image's debug directory has
+        bool Matches( const GUID& guid, uint32_t age );
+
+        uint32_t GetModuleCount();
+        bool GetModuleName( uint32_t modIndex, SymString& name );
+        bool GetFileCount( uint32_t modIndex, uint16_t& fileCount );
+        bool GetFileInfo( uint32_t modIndex, uint16_t fileIndex, SymString& name, uint16_t& segmentCount );
+        bool GetFileSegment( uint32_t modIndex, uint16_t fileIndex, uint16_t segInstanceIndex, FileSegmentInfo& segInfo );
+
+        // Module indexes in the LineNumbers returned are 1-based, like
+        // compiland indexes.
+        bool FindLine( WORD seg, uint32_t offset, LineNumber& lineNumber );
+        bool FindLineByNum( uint32_t modIndex, uint16_t fileIndex, uint16_t line, LineNumber& lineNumber );
+        bool FindNextLineByNum( uint32_t modIndex, uint16_t fileIndex, LineNumber& lineNumber );
+        void FindLines( uint32_t modIndex, uint16_t fileIndex, uint16_t reqLineStart, uint16_t reqLineEnd,
+                        std::vector<LineNumber>& lines );
+
+        // For the symbol store. The streams of the symbols are only asked for
+        // while the symbol store is being set up, because getting a stream
+        // for the first time isn't safe with other threads.
+        bool GetStream( uint32_t index, const BYTE*& data, uint32_t& size );
+        // the symbol records of a module, starting at the C13 signature;
+        // a module without symbols gets a size of 0
+        bool GetModuleSymbols( uint32_t modIndex, const BYTE*& data, uint32_t& size );
+        uint32_t GetGlobalStream();
+        uint32_t GetPublicStream();
+        uint32_t GetSymRecordStream();
+        uint16_t GetMachine();
+
+    private:
+        HRESULT ReadInfoStream( uint32_t& namesStream );
+        HRESULT ReadNames( uint32_t namesStream );
+        HRESULT ReadDbiStream();
+        HRESULT ReadModules( const BYTE* data, uint32_t size );
+        HRESULT ReadSectionContribs( const BYTE* data, uint32_t size );
+
+        Module* GetLoadedModule( uint32_t modIndex );
+        HRESULT LoadLines( Module& mod );
+        HRESULT ReadChecksums( Module& mod, const BYTE* data, uint32_t size );
+        HRESULT ReadLines( Module& mod, const BYTE* data, uint32_t size );
+        int FindFileByChecksum( Module& mod, uint32_t checksumOffset );
+        bool FindLineInModule( Module& mod, uint32_t modIndex, WORD seg, uint32_t offset, LineNumber& lineNumber );
+        void SetLineNumber( const Module& mod, uint32_t modIndex, uint32_t line, LineNumber& lineNumber );
+
+        static bool LineAddressLess( const LineAddress& left, const LineAddress& right );
+        static bool LineNumLess( const LineNum& left, const LineNum& right );
+        static bool SectionContribLess( const SectionContrib& left, const SectionContrib& right );
+    };
+}
@@ -27,6 +27,28 @@ namespace MagoST
                 TypeHandleIn    Handle;
                 uint16_t        Mod;
             } Type;
+
+            // records of the C13 symbol store
+            struct
+            {
+                const BYTE*     Sym;
+                TypeIndex       FuncType;   // for a procedure with a function ID
+                uint32_t        FrameReg;   // what S_BPREL32_V3 offsets are from
+            } C13Symbol;
+
+            // an S_LOCAL_V3, which starts like C13Symbol
+            struct
+            {
+                const BYTE*     Sym;
+                const BYTE*     DefRange;   // the S_DEFRANGE record it's read from, or NULL
+                uint32_t        FrameReg;   // what frame pointer offsets are from
+            } C13Local;
+
+            struct
+            {
+                const BYTE*     Type;
+                uint16_t        Mod;
+            } C13Type;
         } mData;
 
     public:
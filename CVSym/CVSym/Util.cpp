@@ -7,6 +7,7 @@
 
 #include "Common.h"
 #include "Util.h"
+#include "cvinfo.h"
 
 
 // from cvinfo.h:
@@ -183,6 +184,162 @@ DWORD GetFieldLength( CodeViewFieldType* type )
 }
 
 
+// Like the one above, but the field can't go past maxLen bytes. This is for 
+// field lists that haven't been validated.
+
+static bool GetBoundedNumLeafSize( BYTE* numLeafPtr, DWORD maxLen, DWORD& size )
+{
+    if ( maxLen < 2 )
+        return false;
+
+    uint16_t*   numLeaf = (uint16_t*) numLeafPtr;
+
+    // a variable length string needs its length field
+    if ( (*numLeaf == LF_VARSTRING) && (maxLen < 4) )
+        return false;
+
+    size = GetNumLeafSize( numLeaf );
+    return size <= maxLen;
+}
+
+bool GetFieldLength( CodeViewFieldType* type, DWORD maxLen, DWORD& length )
+{
+    _ASSERT( type != NULL );
+    BYTE*   bytes = (BYTE*) type;
+    DWORD   len = 2;            // for the tag
+    DWORD   fixedLen = 0;
+    int     numLeafCount = 0;
+    bool    hasName = false;
+
+    if ( maxLen < len )
+        return false;
+
+    switch ( type->Generic.id )
+    {
+    case LF_BCLASS:     fixedLen = 4;   numLeafCount = 1;   break;
+    case LF_VBCLASS:
+    case LF_IVBCLASS:   fixedLen = 6;   numLeafCount = 2;   break;
+    case LF_ENUMERATE:  fixedLen = 2;   numLeafCount = 1;   hasName = true; break;
+    case LF_FRIENDFCN:  fixedLen = 2;   hasName = true;     break;
+    case LF_INDEX:      fixedLen = 2;   break;
+    case LF_MEMBER:     fixedLen = 4;   numLeafCount = 1;   hasName = true; break;
+    case LF_STMEMBER:   fixedLen = 4;   hasName = true;     break;
+    case LF_METHOD:     fixedLen = 4;   hasName = true;     break;
+    case LF_NESTTYPE:   fixedLen = 2;   hasName = true;     break;
+    case LF_VFUNCTAB:   fixedLen = 2;   break;
+    case LF_FRIENDCLS:  fixedLen = 2;   break;
+    case LF_ONEMETHOD:  fixedLen = 8;   hasName = true;     break;
+    case LF_VFUNCOFF:   fixedLen = 6;   break;
+    }
+
+    if ( fixedLen > maxLen - len )
+        return false;
+    len += fixedLen;
+
+    for ( int i = 0; i < numLeafCount; i++ )
+    {
+        DWORD   leafSize = 0;
+
+        if ( !GetBoundedNumLeafSize( bytes + len, maxLen - len, leafSize ) )
+            return false;
+        len += leafSize;
+    }
+
+    if ( hasName )
+    {
+        if ( len >= maxLen )
+            return false;
+        if ( bytes[len] >= maxLen - len )
+            return false;
+        len += 1 + bytes[len];
+    }
+
+    length = len;
+    return true;
+}
+
+// Like the one above, for the fields of CodeView 8 field lists. Names are 
+// zero-terminated, and the padding after a field is counted in its length.
+
+bool GetFieldLengthV2( CodeViewFieldTypeV2* type, DWORD maxLen, DWORD& length )
+{
+    _ASSERT( type != NULL );
+    BYTE*   bytes = (BYTE*) type;
+    DWORD   len = 2;            // for the tag
+    DWORD   fixedLen = 0;
+    int     numLeafCount = 0;
+    bool    hasName = false;
+
+    if ( maxLen < len )
+        return false;
+
+    switch ( type->Generic.id )
+    {
+    case LF_BCLASS_V2:      fixedLen = 6;   numLeafCount = 1;   break;
+    case LF_VBCLASS_V2:
+    case LF_IVBCLASS_V2:    fixedLen = 10;  numLeafCount = 2;   break;
+    case LF_ENUMERATE_V3:   fixedLen = 2;   numLeafCount = 1;   hasName = true; break;
+    case LF_FRIENDFCN_V3:   fixedLen = 6;   hasName = true;     break;
+    case LF_INDEX_V2:       fixedLen = 6;   break;
+    case LF_MEMBER_V3:      fixedLen = 6;   numLeafCount = 1;   hasName = true; break;
+    case LF_STMEMBER_V3:    fixedLen = 6;   hasName = true;     break;
+    case LF_METHOD_V3:      fixedLen = 6;   hasName = true;     break;
+    case LF_NESTTYPE_V3:    fixedLen = 6;   hasName = true;     break;
+    case LF_VFUNCTAB_V2:    fixedLen = 6;   break;
+    case LF_FRIENDCLS_V2:   fixedLen = 6;   break;
+    case LF_ONEMETHOD_V3:   fixedLen = 6;   hasName = true;     break;
+    case LF_VFUNCOFF_V2:    fixedLen = 10;  break;
+    default:
+        // we can't tell where an unknown field ends
+        return false;
+    }
+
+    if ( type->Generic.id == LF_ONEMETHOD_V3 )
+    {
+        CV_fldattr_t*   attr = (CV_fldattr_t*) &type->onemethod.attr;
+
+        if ( maxLen < 4 )
+            return false;
+        if ( (attr->mprop == CV_MTintro) || (attr->mprop == CV_MTpureintro) )
+            fixedLen += 4;  // the vtab offset
+    }
+
+    if ( fixedLen > maxLen - len )
+        return false;
+    len += fixedLen;
+
+    for ( int i = 0; i < numLeafCount; i++ )
+    {
+        DWORD   leafSize = 0;
+
+        if ( !GetBoundedNumLeafSize( bytes + len, maxLen - len, leafSize ) )
+            return false;
+        len += leafSize;
+    }
+
+    if ( hasName )
+    {
+        BYTE*   end = (BYTE*) memchr( bytes + len, 0, maxLen - len );
+
+        if ( end == NULL )
+            return false;
+        len = (DWORD) (end - bytes) + 1;
+    }
+
+    // LF_PADn bytes say how far it is to the next field
+    if ( (len < maxLen) && (bytes[len] > LF_PAD0) )
+    {
+        DWORD   padLen = bytes[len] & 0x0F;
+
+        if ( padLen > maxLen - len )
+            return false;
+        len += padLen;
+    }
+
+    length = len;
+    return true;
+}
+
 bool     QuickGetAddrOffset( CodeViewSymbol* sym, uint32_t& offset )
 {
     _ASSERT( sym != NULL );
@@ -369,7 +526,7 @@ bool ExactFileNameMatch( const char* pathA, size_t pathALen, const char* pathB,
         {
             // empty, mixed slash and back slash count as the same character
         }
-        else if ( tolower( pathA[i] ) != tolower( pathB[i] ) )
+        else if ( tolower( (unsigned char) pathA[i] ) != tolower( (unsigned char) pathB[i] ) )
             return false;
     }
 
@@ -394,7 +551,7 @@ bool PartialFileNameMatch( const char* pathA, size_t pathALen, const char* pathB
         {
             // empty, mixed slash and back slash count as the same character
         }
-        else if ( tolower( *pca ) != tolower( *pcb ) )
+        else if ( tolower( (unsigned char) *pca ) != tolower( (unsigned char) *pcb ) )
             return false;
 
         if ( (*pca == '\\') || (*pca == '/') )
@@ -411,3 +568,44 @@ bool PartialFileNameMatch( const char* pathA, size_t pathALen, const char* pathB
     return true;
 }
 
+// Hashes the last component of a path, ignoring case. Any two paths that 
+// ExactFileNameMatch or PartialFileNameMatch consider the same share a 
+// last component, so they also share this hash.
+//
+// Path bytes past ASCII are negative chars where char is signed, which
+// tolower doesn't take, so they're passed as unsigned chars here and in the
+// comparisons. HashFnv1aIgnoreCase does the same.
+
+uint32_t GetFileNameHash( const char* path, size_t pathLen )
+{
+    const char* nameStart = path + pathLen;
+
+    while ( (nameStart != path) && (nameStart[-1] != '\\') && (nameStart[-1] != '/') )
+        nameStart--;
+
+    return HashFnv1aIgnoreCase( nameStart, (path + pathLen) - nameStart );
+}
+
+uint32_t HashFnv1a( const void* data, size_t size, uint32_t hash )
+{
+    const uint8_t*  bytes = (const uint8_t*) data;
+
+    for ( size_t i = 0; i < size; i++ )
+    {
+        hash ^= bytes[i];
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+uint32_t HashFnv1aIgnoreCase( const char* chars, size_t len, uint32_t hash )
+{
+    for ( size_t i = 0; i < len; i++ )
+    {
+        hash ^= (uint8_t) tolower( (unsigned char) chars[i] );
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
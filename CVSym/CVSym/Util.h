@@ -9,6 +9,7 @@
 
 
 union CodeViewFieldType;
+union CodeViewFieldTypeV2;
 union CodeViewSymbol;
 
 namespace MagoST
@@ -21,6 +22,8 @@ uint16_t GetNumLeafSize( uint16_t* numLeaf );
 void     GetNumLeafValue( uint16_t* numLeaf, MagoST::Variant& value );
 uint32_t GetUIntValue( uint16_t* numericLeaf );
 DWORD    GetFieldLength( CodeViewFieldType* type );
+bool     GetFieldLength( CodeViewFieldType* type, DWORD maxLen, DWORD& length );
+bool     GetFieldLengthV2( CodeViewFieldTypeV2* type, DWORD maxLen, DWORD& length );
 bool     QuickGetAddrOffset( CodeViewSymbol* sym, uint32_t& offset );
 bool     QuickGetName( CodeViewSymbol* sym, SymString& name );
 bool     QuickGetAddrSegment( CodeViewSymbol* sym, uint16_t& segment );
@@ -28,4 +31,12 @@ bool     QuickGetLength( CodeViewSymbol* sym, uint32_t& length );
 
 bool ExactFileNameMatch( const char* pathA, size_t pathALen, const char* pathB, size_t pathBLen );
 bool PartialFileNameMatch( const char* pathA, size_t pathALen, const char* pathB, size_t pathBLen );
+uint32_t GetFileNameHash( const char* path, size_t pathLen );
+
+// FNV-1a. To hash several pieces as one, pass the hash of the ones before.
+const uint32_t Fnv1aOffsetBasis = 2166136261U;
+
+uint32_t HashFnv1a( const void* data, size_t size, uint32_t hash = Fnv1aOffsetBasis );
+// folds case the way the file name comparisons do
+uint32_t HashFnv1aIgnoreCase( const char* chars, size_t len, uint32_t hash = Fnv1aOffsetBasis );
 
@@ -0,0 +1,2370 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+// CVSymBench : times the symbol store over synthetic or real CodeView data,
+// and prints one JSON object per line for each result.
+//
+//  CVSymBench gen <small|medium|large> <image> [options]
+//  CVSymBench run <image> [options]
+//  CVSymBench sweep [options]
+//  CVSymBench pdb <pdb> [options]
+//  CVSymBench dia <image> [options]
+//  CVSymBench stress <image> [options]
+//  CVSymBench startup <image> [options]
+//
+// Options:
+//  -queries N      queries in each lookup scenario (10000)
+//  -iterations N   runs of each load and enumeration scenario, and stress
+//                  and startup rounds (5)
+//  -threads N      most threads in the line lookup scaling scenario, the
+//                  threads of the stress rounds, and the startup threads,
+//                  up to 4
+//  -seed N         for the generated debug info and the queries (1)
+//  -modules N      modules loaded by startup (150)
+//  -compilands N, -procs N, -lines N, -files N, -locals N, -publics N,
+//  -structs N, -fields N
+//                  override the generated debug info of the scale
+
+#include "Common.h"
+#include "SynthCV.h"
+#include <BenchCommon.h>
+
+using namespace MagoST;
+using namespace MagoBench;
+using namespace CVSymBench;
+
+
+namespace CVSymBench
+{
+    const uint64_t  IndexCacheMaxSize = 256 * 1024 * 1024;
+
+    struct Options
+    {
+        uint32_t        QueryCount;
+        uint32_t        Iterations;
+        uint32_t        MaxThreads;
+        uint32_t        Seed;
+        uint32_t        ModuleCount;
+        // fields that aren't 0 replace the ones of the scale
+        SynthParams     Overrides;
+    };
+
+    struct LineQuery
+    {
+        WORD        Segment;
+        DWORD       Offset;
+    };
+
+    struct LineNumQuery
+    {
+        uint32_t    CompIndex;
+        uint16_t    FileIndex;
+        uint16_t    Line;
+    };
+
+    struct FileLinesQuery
+    {
+        std::string FileName;
+        uint16_t    LineStart;
+        uint16_t    LineEnd;
+    };
+
+    struct SymbolQuery
+    {
+        std::string Name;
+        WORD        Segment;
+        DWORD       Offset;
+        uint32_t    RVA;
+    };
+
+    struct MemberQuery
+    {
+        TypeIndex   FieldListIndex;
+        std::string Name;
+    };
+
+    struct QuerySet
+    {
+        std::vector<LineQuery>      Lines;
+        std::vector<LineNumQuery>   LineNums;
+        std::vector<FileLinesQuery> FileLines;
+        std::vector<SymbolQuery>    Publics;
+        std::vector<MemberQuery>    Members;
+    };
+
+    // Keeps a uniform random sample of at most limit items from a stream of
+    // items, without holding on to all of them.
+    template <class T>
+    class Reservoir
+    {
+        std::vector<T>&     mItems;
+        size_t              mLimit;
+        uint32_t            mSeen;
+        SynthRandom&        mRandom;
+
+    public:
+        Reservoir( std::vector<T>& items, size_t limit, SynthRandom& random )
+            :   mItems( items ),
+                mLimit( limit ),
+                mSeen( 0 ),
+                mRandom( random )
+        {
+            mItems.clear();
+            mItems.reserve( limit );
+        }
+
+        // returns the slot to fill, or NULL if the item isn't kept
+        T* Offer()
+        {
+            mSeen++;
+
+            if ( mItems.size() < mLimit )
+            {
+                mItems.push_back( T() );
+                return &mItems.back();
+            }
+
+            uint32_t    slot = mRandom.Next( mSeen );
+
+            if ( slot < mLimit )
+                return &mItems[slot];
+
+            return NULL;
+        }
+    };
+
+
+    //------------------------------------------------------------------------
+    //  Loading
+    //------------------------------------------------------------------------
+
+    // The CodeView data of an image, found and mapped the way that the data
+    // source does it, so that a DebugStore can be built over it directly. 
+    // For an image with a PDB, it's the PDB's signature that PDBDebugStore 
+    // is built over.
+    class ImageCodeView
+    {
+        BinImage::ImageFile     mImage;
+        BinImage::FileView      mView;
+        DWORD                   mSize;
+        RefPtr<ImageAddrMap>    mAddrMap;
+
+    public:
+        ImageCodeView()
+            :   mSize( 0 )
+        {
+        }
+
+        HRESULT Load( const wchar_t* filename, bool pdb )
+        {
+            HRESULT                 hr = S_OK;
+            DataDirInfo             dirInfo = { 0 };
+            BinImage::FileView      dirView;
+            IMAGE_DEBUG_DIRECTORY*  debugDir = NULL;
+            DWORD                   debugDirCount = 0;
+
+            hr = mImage.LoadFile( filename );
+            if ( FAILED( hr ) )
+                return hr;
+
+            if ( !mImage.FindDataDirectoryData( IMAGE_DIRECTORY_ENTRY_DEBUG, dirInfo ) )
+                return E_FAIL;
+
+            hr = mImage.MapView( dirInfo.FileOffset, dirInfo.Size, dirView );
+            if ( FAILED( hr ) )
+                return hr;
+
+            debugDir = (IMAGE_DEBUG_DIRECTORY*) dirView.GetData();
+
+            for ( debugDirCount = dirInfo.Size / sizeof *debugDir; debugDirCount > 0; debugDirCount--, debugDir++ )
+            {
+                if ( debugDir->Type == IMAGE_DEBUG_TYPE_CODEVIEW )
+                    break;
+            }
+
+            if ( debugDirCount == 0 )
+                return HRESULT_FROM_WIN32( ERROR_NOT_FOUND );
+
+            hr = mImage.MapView( debugDir->PointerToRawData, debugDir->SizeOfData, mView );
+            if ( FAILED( hr ) )
+                return hr;
+
+            mSize = debugDir->SizeOfData;
+
+            if ( (mSize < 4) || ((memcmp( mView.GetData(), "RSDS", 4 ) == 0) != pdb) )
+                return E_BAD_FORMAT;
+
+            IMAGE_NT_HEADERS32* ntHeaders = (IMAGE_NT_HEADERS32*) mImage.GetNtHeadersBase();
+
+            mAddrMap = new ImageAddrMap();
+            if ( mAddrMap == NULL )
+                return E_OUTOFMEMORY;
+
+            return mAddrMap->LoadFromSections( ntHeaders->FileHeader.NumberOfSections, mImage.GetSectionHeaders() );
+        }
+
+        BYTE* GetData()
+        {
+            return mView.GetData();
+        }
+
+        DWORD GetSize()
+        {
+            return mSize;
+        }
+
+        ImageAddrMap* GetAddrMap()
+        {
+            return mAddrMap.Get();
+        }
+    };
+
+    static HRESULT InitStore( ImageCodeView& codeView, DebugStore& store, const BYTE* savedIndex, uint32_t savedIndexSize )
+    {
+        // the same segments that the data source sets
+        store.SetTLSSegment( codeView.GetAddrMap()->FindSection( ".tls" ) );
+        store.SetTextSegment( codeView.GetAddrMap()->FindSection( "_TEXT" ) );
+
+        return store.InitDebugInfo( codeView.GetData(), codeView.GetSize(), savedIndex, savedIndexSize );
+    }
+
+    static HRESULT OpenSession(
+        const wchar_t* filename,
+        const wchar_t* cacheDir,
+        RefPtr<IDataSource>& source,
+        RefPtr<ISession>& session )
+    {
+        HRESULT hr = S_OK;
+
+        source.Release();
+        session.Release();
+
+        hr = MakeDataSource( source.Ref() );
+        if ( FAILED( hr ) )
+            return hr;
+
+        if ( cacheDir != NULL )
+        {
+            hr = source->SetIndexCache( cacheDir, IndexCacheMaxSize );
+            if ( FAILED( hr ) )
+                return hr;
+        }
+
+        hr = source->LoadDataForExe( filename, NULL );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = source->InitDebugInfo( filename, NULL );
+        if ( FAILED( hr ) )
+            return hr;
+
+        return source->OpenSession( session.Ref() );
+    }
+
+    static std::wstring GetBenchTempDir()
+    {
+        wchar_t     tempPath[MAX_PATH] = L"";
+        DWORD       len = GetTempPath( _countof( tempPath ), tempPath );
+        std::wstring    dir;
+
+        if ( (len == 0) || (len >= _countof( tempPath )) )
+            wcscpy_s( tempPath, L".\\" );
+
+        dir = tempPath;
+        dir += L"CVSymBench";
+        CreateDirectory( dir.c_str(), NULL );
+        dir += L"\\";
+
+        return dir;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  Queries
+    //------------------------------------------------------------------------
+
+    // Picks lines at random from all of the line tables. The lookups by
+    // number and by file name start at the line picked.
+    template <class TStore>
+    void GatherFileQueries(
+        TStore& store,
+        uint32_t compIndex,
+        uint16_t fileIndex,
+        uint16_t segCount,
+        const SymString& fileName,
+        Reservoir<LineQuery>& lines,
+        Reservoir<LineNumQuery>& lineNums,
+        Reservoir<FileLinesQuery>& fileLines,
+        SynthRandom& random )
+    {
+        for ( uint16_t s = 0; s < segCount; s++ )
+        {
+            FileSegmentInfo segInfo = { 0 };
+
+            if ( !store.GetFileSegment( compIndex, fileIndex, s, segInfo ) || (segInfo.LineCount == 0) )
+                continue;
+
+            for ( uint16_t l = 0; l < segInfo.LineCount; l++ )
+            {
+                LineQuery*      lineQuery = lines.Offer();
+                LineNumQuery*   numQuery = lineNums.Offer();
+
+                if ( lineQuery != NULL )
+                {
+                    lineQuery->Segment = segInfo.SegmentIndex;
+                    lineQuery->Offset = segInfo.Offsets[l];
+                }
+
+                if ( numQuery != NULL )
+                {
+                    numQuery->CompIndex = compIndex;
+                    numQuery->FileIndex = fileIndex;
+                    numQuery->Line = segInfo.LineNumbers[l];
+                }
+            }
+
+            FileLinesQuery* fileQuery = fileLines.Offer();
+
+            if ( fileQuery != NULL )
+            {
+                uint16_t    line = segInfo.LineNumbers[random.Next( segInfo.LineCount )];
+
+                fileQuery->FileName.assign( fileName.GetName(), fileName.GetLength() );
+                fileQuery->LineStart = line;
+                fileQuery->LineEnd = (uint16_t) std::min( line + 10, 0xFFFF );
+            }
+        }
+    }
+
+    static void GatherLineQueries( IDebugStore& store, uint32_t limit, SynthRandom& random, QuerySet& queries )
+    {
+        Reservoir<LineQuery>        lines( queries.Lines, limit, random );
+        Reservoir<LineNumQuery>     lineNums( queries.LineNums, limit, random );
+        Reservoir<FileLinesQuery>   fileLines( queries.FileLines, limit, random );
+        uint32_t                    compCount = 0;
+
+        if ( FAILED( store.GetCompilandCount( compCount ) ) )
+            return;
+
+        for ( uint32_t c = 1; (c <= compCount) && (c <= 0xFFFF); c++ )
+        {
+            CompilandInfo   compInfo;
+
+            if ( store.GetCompilandInfo( (uint16_t) c, compInfo ) != S_OK )
+                continue;
+
+            for ( uint16_t f = 0; f < compInfo.FileCount; f++ )
+            {
+                FileInfo    fileInfo;
+
+                if ( store.GetFileInfo( (uint16_t) c, f, fileInfo ) != S_OK )
+                    continue;
+
+                GatherFileQueries( store, c, f, fileInfo.SegmentCount, fileInfo.Name, lines, lineNums, fileLines, random );
+            }
+        }
+    }
+
+    static void GatherLineQueries( PDBReader& reader, uint32_t limit, SynthRandom& random, QuerySet& queries )
+    {
+        Reservoir<LineQuery>        lines( queries.Lines, limit, random );
+        Reservoir<LineNumQuery>     lineNums( queries.LineNums, limit, random );
+        Reservoir<FileLinesQuery>   fileLines( queries.FileLines, limit, random );
+
+        for ( uint32_t m = 0; m < reader.GetModuleCount(); m++ )
+        {
+            uint16_t    fileCount = 0;
+
+            if ( !reader.GetFileCount( m, fileCount ) )
+                continue;
+
+            for ( uint16_t f = 0; f < fileCount; f++ )
+            {
+                SymString   name;
+                uint16_t    segCount = 0;
+
+                if ( !reader.GetFileInfo( m, f, name, segCount ) )
+                    continue;
+
+                GatherFileQueries( reader, m, f, segCount, name, lines, lineNums, fileLines, random );
+            }
+        }
+    }
+
+    template <class TStore>
+    void GatherSymbolQueries( TStore& store, ImageAddrMap* addrMap, uint32_t limit, SynthRandom& random, QuerySet& queries )
+    {
+        Reservoir<SymbolQuery>  publics( queries.Publics, limit, random );
+        SymbolScope             scope = { 0 };
+        SymHandle               handle = { 0 };
+
+        if ( store.SetSymbolScope( SymHeap_PublicSymbols, scope ) != S_OK )
+            return;
+
+        while ( store.NextSymbol( scope, handle ) )
+        {
+            SymInfoData     infoData = { 0 };
+            ISymbolInfo*    symInfo = NULL;
+            SymString       name;
+            uint16_t        segment = 0;
+            uint32_t        offset = 0;
+
+            if ( store.GetSymbolInfo( handle, infoData, symInfo ) != S_OK )
+                continue;
+            if ( !symInfo->GetName( name ) || (name.GetLength() == 0)
+                || !symInfo->GetAddressSegment( segment ) || !symInfo->GetAddressOffset( offset ) )
+                continue;
+
+            SymbolQuery*    query = publics.Offer();
+
+            if ( query != NULL )
+            {
+                query->Name.assign( name.GetName(), name.GetLength() );
+                query->Segment = segment;
+                query->Offset = offset;
+                query->RVA = (addrMap != NULL) ? addrMap->MapSecOffsetToRVA( segment, offset ) : 0;
+            }
+        }
+    }
+
+    // a member of each structure, for looking up by name in its field list
+    template <class TStore>
+    void GatherMemberQueries( TStore& store, uint32_t limit, SynthRandom& random, QuerySet& queries )
+    {
+        Reservoir<MemberQuery>  members( queries.Members, limit, random );
+        TypeScope               scope = { 0 };
+        TypeHandle              handle = { 0 };
+
+        if ( store.SetGlobalTypeScope( scope ) != S_OK )
+            return;
+
+        while ( store.NextType( scope, handle ) )
+        {
+            SymInfoData     infoData = { 0 };
+            ISymbolInfo*    typeInfo = NULL;
+            TypeIndex       fieldListIndex = 0;
+            TypeHandle      fieldList = { 0 };
+            TypeScope       fieldScope = { 0 };
+            TypeHandle      field = { 0 };
+            std::vector<std::string>    names;
+
+            if ( (store.GetTypeInfo( handle, infoData, typeInfo ) != S_OK)
+                || (typeInfo->GetSymTag() != SymTagUDT)
+                || !typeInfo->GetFieldList( fieldListIndex )
+                || !store.GetTypeFromTypeIndex( fieldListIndex, fieldList )
+                || (store.SetChildTypeScope( fieldList, fieldScope ) != S_OK) )
+                continue;
+
+            while ( store.NextType( fieldScope, field ) )
+            {
+                SymInfoData     fieldData = { 0 };
+                ISymbolInfo*    fieldInfo = NULL;
+                SymString       name;
+
+                if ( (store.GetTypeInfo( field, fieldData, fieldInfo ) == S_OK) && fieldInfo->GetName( name ) )
+                    names.push_back( std::string( name.GetName(), name.GetLength() ) );
+            }
+
+            if ( names.size() == 0 )
+                continue;
+
+            MemberQuery*    query = members.Offer();
+
+            if ( query != NULL )
+            {
+                query->FieldListIndex = fieldListIndex;
+                query->Name = names[random.Next( names.size() )];
+            }
+        }
+    }
+
+
+    //------------------------------------------------------------------------
+    //  Scenarios
+    //------------------------------------------------------------------------
+
+    // One kind of query, run over a list of inputs. Run has to be safe to
+    // call from more than one thread at a time.
+    class QueryScenario
+    {
+    public:
+        virtual ~QueryScenario() {}
+        virtual size_t GetCount() = 0;
+        // returns true if the query found something
+        virtual bool Run( size_t index ) = 0;
+    };
+
+    class SessionFindLine : public QueryScenario
+    {
+        ISession*                       mSession;
+        const std::vector<LineQuery>&   mQueries;
+
+    public:
+        SessionFindLine( ISession* session, const std::vector<LineQuery>& queries )
+            :   mSession( session ), mQueries( queries ) {}
+
+        size_t GetCount() { return mQueries.size(); }
+
+        bool Run( size_t index )
+        {
+            LineNumber  line = { 0 };
+            return mSession->FindLine( mQueries[index].Segment, mQueries[index].Offset, line );
+        }
+    };
+
+    class SessionFindLineByNum : public QueryScenario
+    {
+        ISession*                           mSession;
+        const std::vector<LineNumQuery>&    mQueries;
+
+    public:
+        SessionFindLineByNum( ISession* session, const std::vector<LineNumQuery>& queries )
+            :   mSession( session ), mQueries( queries ) {}
+
+        size_t GetCount() { return mQueries.size(); }
+
+        bool Run( size_t index )
+        {
+            const LineNumQuery& query = mQueries[index];
+            LineNumber          line = { 0 };
+            return mSession->FindLineByNum( (uint16_t) query.CompIndex, query.FileIndex, query.Line, line );
+        }
+    };
+
+    class SessionFindLines : public QueryScenario
+    {
+        ISession*                           mSession;
+        const std::vector<FileLinesQuery>&  mQueries;
+
+    public:
+        SessionFindLines( ISession* session, const std::vector<FileLinesQuery>& queries )
+            :   mSession( session ), mQueries( queries ) {}
+
+        size_t GetCount() { return mQueries.size(); }
+
+        bool Run( size_t index )
+        {
+            const FileLinesQuery&   query = mQueries[index];
+            std::vector<LineNumber> lines;
+
+            return mSession->FindLines(
+                false,
+                query.FileName.c_str(),
+                query.FileName.size(),
+                query.LineStart,
+                query.LineEnd,
+                lines ) && (lines.size() > 0);
+        }
+    };
+
+    class SessionFindGlobalSymbol : public QueryScenario
+    {
+        ISession*                           mSession;
+        const std::vector<SymbolQuery>&     mQueries;
+
+    public:
+        SessionFindGlobalSymbol( ISession* session, const std::vector<SymbolQuery>& queries )
+            :   mSession( session ), mQueries( queries ) {}
+
+        size_t GetCount() { return mQueries.size(); }
+
+        bool Run( size_t index )
+        {
+            SymHandle   handle = { 0 };
+            return mSession->FindGlobalSymbol( mQueries[index].Name.c_str(), mQueries[index].Name.size(), handle ) == S_OK;
+        }
+    };
+
+    // The field lists were found in another store, so their handles are
+    // looked up again in the session's store before timing.
+    class SessionFindChildType : public QueryScenario
+    {
+        ISession*                           mSession;
+        const std::vector<MemberQuery>&     mQueries;
+        std::vector<TypeHandle>             mFieldLists;
+
+    public:
+        SessionFindChildType( ISession* session, const std::vector<MemberQuery>& queries )
+            :   mSession( session ), mQueries( queries ), mFieldLists( queries.size() )
+        {
+            for ( size_t i = 0; i < queries.size(); i++ )
+                mSession->GetTypeFromTypeIndex( queries[i].FieldListIndex, mFieldLists[i] );
+        }
+
+        size_t GetCount() { return mQueries.size(); }
+
+        bool Run( size_t index )
+        {
+            const MemberQuery&  query = mQueries[index];
+            TypeHandle          handle = { 0 };
+            return mSession->FindChildType( mFieldLists[index], query.Name.c_str(), query.Name.size(), handle ) == S_OK;
+        }
+    };
+
+    class SessionSecOffsetFromRVA : public QueryScenario
+    {
+        ISession*                           mSession;
+        const std::vector<SymbolQuery>&     mQueries;
+
+    public:
+        SessionSecOffsetFromRVA( ISession* session, const std::vector<SymbolQuery>& queries )
+            :   mSession( session ), mQueries( queries ) {}
+
+        size_t GetCount() { return mQueries.size(); }
+
+        bool Run( size_t index )
+        {
+            uint32_t    offset = 0;
+            return mSession->GetSecOffsetFromRVA( mQueries[index].RVA, offset ) != 0;
+        }
+    };
+
+    template <class TStore>
+    class StoreFindFirstSymbol : public QueryScenario
+    {
+        TStore&                             mStore;
+        SymbolHeapId                        mHeapId;
+        const std::vector<SymbolQuery>&     mQueries;
+
+    public:
+        StoreFindFirstSymbol( TStore& store, SymbolHeapId heapId, const std::vector<SymbolQuery>& queries )
+            :   mStore( store ), mHeapId( heapId ), mQueries( queries ) {}
+
+        size_t GetCount() { return mQueries.size(); }
+
+        bool Run( size_t index )
+        {
+            EnumNamedSymbolsData    data = { 0 };
+            const std::string&      name = mQueries[index].Name;
+
+            return mStore.FindFirstSymbol( mHeapId, name.c_str(), name.size(), data ) == S_OK;
+        }
+    };
+
+    // Looks a few bytes into each symbol, as if for an address in the
+    // middle of a function.
+    template <class TStore>
+    class StoreFindSymbol : public QueryScenario
+    {
+        TStore&                             mStore;
+        SymbolHeapId                        mHeapId;
+        const std::vector<SymbolQuery>&     mQueries;
+
+    public:
+        StoreFindSymbol( TStore& store, SymbolHeapId heapId, const std::vector<SymbolQuery>& queries )
+            :   mStore( store ), mHeapId( heapId ), mQueries( queries ) {}
+
+        size_t GetCount() { return mQueries.size(); }
+
+        bool Run( size_t index )
+        {
+            const SymbolQuery&  query = mQueries[index];
+            SymHandle           handle = { 0 };
+
+            return mStore.FindSymbol( mHeapId, query.Segment, query.Offset + (index % 3), handle ) == S_OK;
+        }
+    };
+
+    template <class TStore>
+    class StoreFindLine : public QueryScenario
+    {
+        TStore&                         mStore;
+        const std::vector<LineQuery>&   mQueries;
+
+    public:
+        StoreFindLine( TStore& store, const std::vector<LineQuery>& queries )
+            :   mStore( store ), mQueries( queries ) {}
+
+        size_t GetCount() { return mQueries.size(); }
+
+        bool Run( size_t index )
+        {
+            LineNumber  line = { 0 };
+            return mStore.FindLine( mQueries[index].Segment, mQueries[index].Offset, line );
+        }
+    };
+
+    template <class TStore>
+    class StoreFindLineByNum : public QueryScenario
+    {
+        TStore&                             mStore;
+        const std::vector<LineNumQuery>&    mQueries;
+
+    public:
+        StoreFindLineByNum( TStore& store, const std::vector<LineNumQuery>& queries )
+            :   mStore( store ), mQueries( queries ) {}
+
+        size_t GetCount() { return mQueries.size(); }
+
+        bool Run( size_t index )
+        {
+            const LineNumQuery& query = mQueries[index];
+            LineNumber          line = { 0 };
+            return mStore.FindLineByNum( (uint16_t) query.CompIndex, query.FileIndex, query.Line, line );
+        }
+    };
+
+    template <class TStore>
+    class StoreFindLines : public QueryScenario
+    {
+        TStore&                             mStore;
+        const std::vector<FileLinesQuery>&  mQueries;
+
+    public:
+        StoreFindLines( TStore& store, const std::vector<FileLinesQuery>& queries )
+            :   mStore( store ), mQueries( queries ) {}
+
+        size_t GetCount() { return mQueries.size(); }
+
+        bool Run( size_t index )
+        {
+            const FileLinesQuery&   query = mQueries[index];
+            std::vector<LineNumber> lines;
+
+            return mStore.FindLines(
+                false,
+                query.FileName.c_str(),
+                query.FileName.size(),
+                query.LineStart,
+                query.LineEnd,
+                lines ) && (lines.size() > 0);
+        }
+    };
+
+    class ReaderFindLine : public QueryScenario
+    {
+        PDBReader&                      mReader;
+        const std::vector<LineQuery>&   mQueries;
+
+    public:
+        ReaderFindLine( PDBReader& reader, const std::vector<LineQuery>& queries )
+            :   mReader( reader ), mQueries( queries ) {}
+
+        size_t GetCount() { return mQueries.size(); }
+
+        bool Run( size_t index )
+        {
+            LineNumber  line = { 0 };
+            return mReader.FindLine( mQueries[index].Segment, mQueries[index].Offset, line );
+        }
+    };
+
+    class ReaderFindLineByNum : public QueryScenario
+    {
+        PDBReader&                          mReader;
+        const std::vector<LineNumQuery>&    mQueries;
+
+    public:
+        ReaderFindLineByNum( PDBReader& reader, const std::vector<LineNumQuery>& queries )
+            :   mReader( reader ), mQueries( queries ) {}
+
+        size_t GetCount() { return mQueries.size(); }
+
+        bool Run( size_t index )
+        {
+            const LineNumQuery& query = mQueries[index];
+            LineNumber          line = { 0 };
+            return mReader.FindLineByNum( query.CompIndex, query.FileIndex, query.Line, line );
+        }
+    };
+
+    static void RunQueries( const std::string& fixture, const char* name, QueryScenario& scenario )
+    {
+        Samples     samples;
+        uint64_t    hits = 0;
+        size_t      count = scenario.GetCount();
+
+        if ( count == 0 )
+            return;
+
+        samples.Reserve( count );
+
+        uint64_t    wallStart = GetTicks();
+
+        for ( size_t i = 0; i < count; i++ )
+        {
+            uint64_t    start = GetTicks();
+            bool        found = scenario.Run( i );
+
+            samples.Add( GetTicks() - start );
+            if ( found )
+                hits++;
+        }
+
+        PrintResult( fixture.c_str(), name, 1, samples, GetTicks() - wallStart, hits );
+    }
+
+    struct QueryThread
+    {
+        QueryScenario*  Scenario;
+        size_t          First;
+        HANDLE          StartEvent;
+        Samples         Times;
+        uint64_t        Hits;
+    };
+
+    // Each thread runs all of the queries, starting at its own place in the
+    // list, so that the threads don't move through the data in lock step.
+    static unsigned int __stdcall QueryThreadProc( void* param )
+    {
+        QueryThread*    thread = (QueryThread*) param;
+        size_t          count = thread->Scenario->GetCount();
+
+        WaitForSingleObject( thread->StartEvent, INFINITE );
+
+        for ( size_t i = 0; i < count; i++ )
+        {
+            size_t      index = (thread->First + i) % count;
+            uint64_t    start = GetTicks();
+            bool        found = thread->Scenario->Run( index );
+
+            thread->Times.Add( GetTicks() - start );
+            if ( found )
+                thread->Hits++;
+        }
+
+        return 0;
+    }
+
+    static void RunQueriesOnThreads( const std::string& fixture, const char* name, QueryScenario& scenario, uint32_t threadCount )
+    {
+        size_t                      count = scenario.GetCount();
+        std::vector<QueryThread>    threads( threadCount );
+        std::vector<HANDLE>         handles;
+        HandlePtr                   startEvent;
+
+        if ( count == 0 )
+            return;
+
+        startEvent.Attach( CreateEvent( NULL, TRUE, FALSE, NULL ) );
+        if ( startEvent.IsEmpty() )
+            return;
+
+        for ( uint32_t t = 0; t < threadCount; t++ )
+        {
+            threads[t].Scenario = &scenario;
+            threads[t].First = (t * count) / threadCount;
+            threads[t].StartEvent = startEvent.Get();
+            threads[t].Hits = 0;
+            threads[t].Times.Reserve( count );
+
+            HANDLE  hThread = (HANDLE) _beginthreadex( NULL, 0, QueryThreadProc, &threads[t], 0, NULL );
+
+            if ( hThread == NULL )
+                break;
+
+            handles.push_back( hThread );
+        }
+
+        if ( handles.size() == 0 )
+            return;
+
+        uint64_t    wallStart = GetTicks();
+
+        SetEvent( startEvent.Get() );
+        WaitForMultipleObjects( handles.size(), &handles[0], TRUE, INFINITE );
+
+        uint64_t    wallTicks = GetTicks() - wallStart;
+        Samples     samples;
+        uint64_t    hits = 0;
+
+        for ( size_t t = 0; t < handles.size(); t++ )
+        {
+            CloseHandle( handles[t] );
+            samples.Append( threads[t].Times );
+            hits += threads[t].Hits;
+        }
+
+        PrintResult( fixture.c_str(), name, handles.size(), samples, wallTicks, hits );
+    }
+
+    static void RunThreadScaling( const std::string& fixture, const char* name, QueryScenario& scenario, uint32_t maxThreads )
+    {
+        for ( uint32_t threadCount = 1; threadCount <= maxThreads; threadCount *= 2 )
+        {
+            RunQueriesOnThreads( fixture, name, scenario, threadCount );
+
+            if ( (threadCount < maxThreads) && ((threadCount * 2) > maxThreads) )
+                RunQueriesOnThreads( fixture, name, scenario, maxThreads );
+        }
+    }
+
+    // Walks every global type, and the fields of each one with a field list.
+    template <class TStore>
+    uint64_t EnumerateTypes( TStore& store )
+    {
+        TypeScope       scope = { 0 };
+        TypeHandle      handle = { 0 };
+        uint64_t        count = 0;
+
+        if ( store.SetGlobalTypeScope( scope ) != S_OK )
+            return 0;
+
+        while ( store.NextType( scope, handle ) )
+        {
+            SymInfoData     infoData = { 0 };
+            ISymbolInfo*    typeInfo = NULL;
+            TypeIndex       fieldListIndex = 0;
+            TypeHandle      fieldList = { 0 };
+            TypeScope       fieldScope = { 0 };
+            TypeHandle      field = { 0 };
+
+            count++;
+
+            if ( (store.GetTypeInfo( handle, infoData, typeInfo ) != S_OK)
+                || !typeInfo->GetFieldList( fieldListIndex )
+                || !store.GetTypeFromTypeIndex( fieldListIndex, fieldList )
+                || (store.SetChildTypeScope( fieldList, fieldScope ) != S_OK) )
+                continue;
+
+            while ( store.NextType( fieldScope, field ) )
+            {
+                SymInfoData     fieldData = { 0 };
+                ISymbolInfo*    fieldInfo = NULL;
+                SymString       name;
+
+                if ( store.GetTypeInfo( field, fieldData, fieldInfo ) == S_OK )
+                    fieldInfo->GetName( name );
+                count++;
+            }
+        }
+
+        return count;
+    }
+
+    template <class TStore>
+    uint64_t EnumerateScope( TStore& store, SymbolScope& scope )
+    {
+        SymHandle       handle = { 0 };
+        uint64_t        count = 0;
+
+        while ( store.NextSymbol( scope, handle ) )
+        {
+            SymInfoData     infoData = { 0 };
+            ISymbolInfo*    symInfo = NULL;
+            SymString       name;
+            SymbolScope     childScope = { 0 };
+
+            count++;
+
+            if ( store.GetSymbolInfo( handle, infoData, symInfo ) != S_OK )
+                continue;
+
+            symInfo->GetName( name );
+
+            SymTag  tag = symInfo->GetSymTag();
+
+            if ( ((tag == SymTagFunction) || (tag == SymTagBlock))
+                && (store.SetChildSymbolScope( handle, childScope ) == S_OK) )
+                count += EnumerateScope( store, childScope );
+        }
+
+        return count;
+    }
+
+    // Walks the symbols of every compiland, down into every function and block.
+    template <class TStore>
+    uint64_t EnumerateCompilandSymbols( TStore& store, uint32_t compCount )
+    {
+        uint64_t    count = 0;
+
+        for ( uint32_t c = 1; c <= compCount; c++ )
+        {
+            SymbolScope scope = { 0 };
+
+            if ( store.SetCompilandSymbolScope( c, scope ) == S_OK )
+                count += EnumerateScope( store, scope );
+        }
+
+        return count;
+    }
+
+    template <class TStore>
+    uint64_t EnumerateHeap( TStore& store, SymbolHeapId heapId )
+    {
+        SymbolScope scope = { 0 };
+
+        if ( store.SetSymbolScope( heapId, scope ) != S_OK )
+            return 0;
+
+        return EnumerateScope( store, scope );
+    }
+
+    static uint64_t GetTimerOverhead()
+    {
+        Samples samples;
+
+        for ( int i = 0; i < 1000; i++ )
+        {
+            uint64_t    start = GetTicks();
+            samples.Add( GetTicks() - start );
+        }
+
+        return samples.GetPercentile( 50 );
+    }
+
+    static void PrintError( const std::string& fixture, const char* scenario, HRESULT hr )
+    {
+        JsonLine    line( "error" );
+
+        line.Add( "fixture", fixture.c_str() );
+        line.Add( "scenario", scenario );
+        line.Add( "hresult", (uint32_t) hr );
+        line.Print();
+    }
+
+
+    //------------------------------------------------------------------------
+    //  Runs
+    //------------------------------------------------------------------------
+
+    // Loads a store over and over, from scratch, and then from a saved index.
+    static void RunStoreLoad( const std::string& fixture, ImageCodeView& codeView, const Options& options )
+    {
+        Samples             cold;
+        Samples             warm;
+        uint64_t            coldTotal = 0;
+        uint64_t            warmTotal = 0;
+        std::vector<BYTE>   savedIndex;
+        uint64_t            workingSetBefore = GetWorkingSet();
+        uint64_t            workingSetAfter = 0;
+        LineIndexStats      stats = { 0 };
+
+        for ( uint32_t i = 0; i < options.Iterations; i++ )
+        {
+            std::auto_ptr<DebugStore>   store( new DebugStore() );
+            uint64_t                    start = GetTicks();
+            HRESULT                     hr = InitStore( codeView, *store, NULL, 0 );
+            uint64_t                    ticks = GetTicks() - start;
+
+            if ( FAILED( hr ) )
+            {
+                PrintError( fixture, "load_store_cold", hr );
+                return;
+            }
+
+            cold.Add( ticks );
+            coldTotal += ticks;
+
+            if ( i == 0 )
+            {
+                workingSetAfter = GetWorkingSet();
+                store->GetLineIndexStats( stats );
+
+                savedIndex.resize( store->GetSavedIndexSize() );
+                if ( (savedIndex.size() == 0)
+                    || FAILED( store->WriteSavedIndex( &savedIndex[0], savedIndex.size() ) ) )
+                    savedIndex.clear();
+            }
+        }
+
+        PrintResult( fixture.c_str(), "load_store_cold", 1, cold, coldTotal, cold.GetCount() );
+
+        JsonLine    memLine( "memory" );
+
+        memLine.Add( "fixture", fixture.c_str() );
+        memLine.Add( "store_working_set_bytes", (workingSetAfter > workingSetBefore) ? workingSetAfter - workingSetBefore : 0 );
+        memLine.Add( "line_index_bytes", stats.MemoryBytes );
+        memLine.Add( "line_intervals", stats.IntervalCount );
+        memLine.Add( "file_names", stats.FileNameCount );
+        memLine.Add( "saved_index_bytes", (uint64_t) savedIndex.size() );
+        memLine.Print();
+
+        if ( savedIndex.size() == 0 )
+            return;
+
+        uint64_t    usedCount = 0;
+
+        for ( uint32_t i = 0; i < options.Iterations; i++ )
+        {
+            std::auto_ptr<DebugStore>   store( new DebugStore() );
+            uint64_t                    start = GetTicks();
+            HRESULT                     hr = InitStore( codeView, *store, &savedIndex[0], savedIndex.size() );
+            uint64_t                    ticks = GetTicks() - start;
+
+            if ( FAILED( hr ) )
+            {
+                PrintError( fixture, "load_store_warm", hr );
+                return;
+            }
+
+            warm.Add( ticks );
+            warmTotal += ticks;
+            if ( store->UsedSavedIndex() )
+                usedCount++;
+        }
+
+        // hits counts the loads that took the saved index
+        PrintResult( fixture.c_str(), "load_store_warm", 1, warm, warmTotal, usedCount );
+    }
+
+    // The whole load that the debug engine does for a module: the image,
+    // the address map, the store, and a session. The cached run keeps the
+    // line index in the index cache, like the engine does when it's set up.
+    static void RunSessionLoad( const std::string& fixture, const wchar_t* imagePath, const Options& options, bool cached )
+    {
+        const char*     name = cached ? "load_session_cached" : "load_session";
+        std::wstring    cacheDir = GetBenchTempDir() + L"cache";
+        Samples         samples;
+        uint64_t        total = 0;
+
+        if ( cached )
+        {
+            RefPtr<IDataSource> source;
+            RefPtr<ISession>    session;
+
+            CreateDirectory( cacheDir.c_str(), NULL );
+
+            // fills the cache
+            HRESULT hr = OpenSession( imagePath, cacheDir.c_str(), source, session );
+            if ( FAILED( hr ) )
+            {
+                PrintError( fixture, name, hr );
+                return;
+            }
+        }
+
+        for ( uint32_t i = 0; i < options.Iterations; i++ )
+        {
+            RefPtr<IDataSource> source;
+            RefPtr<ISession>    session;
+            uint64_t            start = GetTicks();
+            HRESULT             hr = OpenSession( imagePath, cached ? cacheDir.c_str() : NULL, source, session );
+            uint64_t            ticks = GetTicks() - start;
+
+            if ( FAILED( hr ) )
+            {
+                PrintError( fixture, name, hr );
+                return;
+            }
+
+            samples.Add( ticks );
+            total += ticks;
+        }
+
+        PrintResult( fixture.c_str(), name, 1, samples, total, samples.GetCount() );
+    }
+
+    template <class TEnum>
+    void RunEnumeration( const std::string& fixture, const char* name, uint32_t iterations, TEnum enumerate )
+    {
+        Samples     samples;
+        uint64_t    total = 0;
+        uint64_t    count = 0;
+
+        for ( uint32_t i = 0; i < iterations; i++ )
+        {
+            uint64_t    start = GetTicks();
+
+            count = enumerate();
+
+            uint64_t    ticks = GetTicks() - start;
+
+            samples.Add( ticks );
+            total += ticks;
+        }
+
+        // hits is how many symbols or types one walk visits
+        PrintResult( fixture.c_str(), name, 1, samples, total, count );
+    }
+
+    template <class TStore>
+    class TypeWalk
+    {
+        TStore&     mStore;
+    public:
+        TypeWalk( TStore& store ) : mStore( store ) {}
+        uint64_t operator()() { return EnumerateTypes( mStore ); }
+    };
+
+    template <class TStore>
+    class CompilandWalk
+    {
+        TStore&     mStore;
+        uint32_t    mCompCount;
+    public:
+        CompilandWalk( TStore& store, uint32_t compCount ) : mStore( store ), mCompCount( compCount ) {}
+        uint64_t operator()() { return EnumerateCompilandSymbols( mStore, mCompCount ); }
+    };
+
+    template <class TStore>
+    class HeapWalk
+    {
+        TStore&         mStore;
+        SymbolHeapId    mHeapId;
+    public:
+        HeapWalk( TStore& store, SymbolHeapId heapId ) : mStore( store ), mHeapId( heapId ) {}
+        uint64_t operator()() { return EnumerateHeap( mStore, mHeapId ); }
+    };
+
+    static HRESULT RunImage( const std::string& fixture, const wchar_t* imagePath, const Options& options )
+    {
+        HRESULT             hr = S_OK;
+        ImageCodeView       codeView;
+        DebugStore          store;
+        RefPtr<IDataSource> source;
+        RefPtr<ISession>    session;
+        QuerySet            queries;
+        SynthRandom         random( options.Seed );
+        uint32_t            compCount = 0;
+
+        hr = codeView.Load( imagePath, false );
+        if ( FAILED( hr ) )
+            return hr;
+
+        JsonLine    fixtureLine( "fixture" );
+
+        fixtureLine.Add( "fixture", fixture.c_str() );
+        fixtureLine.Add( "image", imagePath );
+        fixtureLine.Add( "cv_bytes", codeView.GetSize() );
+        fixtureLine.Add( "timer_overhead_ns", TicksToNanoseconds( GetTimerOverhead() ) );
+        fixtureLine.Print();
+
+        RunStoreLoad( fixture, codeView, options );
+        RunSessionLoad( fixture, imagePath, options, false );
+        RunSessionLoad( fixture, imagePath, options, true );
+
+        hr = InitStore( codeView, store, NULL, 0 );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = OpenSession( imagePath, NULL, source, session );
+        if ( FAILED( hr ) )
+            return hr;
+
+        store.GetCompilandCount( compCount );
+
+        GatherLineQueries( store, options.QueryCount, random, queries );
+        GatherSymbolQueries( store, codeView.GetAddrMap(), options.QueryCount, random, queries );
+        GatherMemberQueries( store, options.QueryCount, random, queries );
+
+        SessionFindLine         findLine( session.Get(), queries.Lines );
+        SessionFindLineByNum    findLineByNum( session.Get(), queries.LineNums );
+        SessionFindLines        findLines( session.Get(), queries.FileLines );
+        SessionFindGlobalSymbol findGlobal( session.Get(), queries.Publics );
+        SessionFindChildType    findChildType( session.Get(), queries.Members );
+        SessionSecOffsetFromRVA secOffset( session.Get(), queries.Publics );
+
+        StoreFindSymbol<DebugStore>         findPublicByAddr( store, SymHeap_PublicSymbols, queries.Publics );
+        StoreFindSymbol<DebugStore>         findGlobalByAddr( store, SymHeap_GlobalSymbols, queries.Publics );
+        StoreFindFirstSymbol<DebugStore>    findFirstPublic( store, SymHeap_PublicSymbols, queries.Publics );
+        StoreFindFirstSymbol<DebugStore>    findFirstGlobal( store, SymHeap_GlobalSymbols, queries.Publics );
+
+        RunQueries( fixture, "find_line", findLine );
+        RunQueries( fixture, "find_line_by_num", findLineByNum );
+        RunQueries( fixture, "find_lines", findLines );
+        RunQueries( fixture, "find_symbol_public", findPublicByAddr );
+        RunQueries( fixture, "find_symbol_global", findGlobalByAddr );
+        RunQueries( fixture, "find_first_symbol_public", findFirstPublic );
+        RunQueries( fixture, "find_first_symbol_global", findFirstGlobal );
+        RunQueries( fixture, "find_global_symbol", findGlobal );
+        RunQueries( fixture, "find_child_type", findChildType );
+        RunQueries( fixture, "sec_offset_from_rva", secOffset );
+
+        RunEnumeration( fixture, "enum_types", options.Iterations, TypeWalk<DebugStore>( store ) );
+        RunEnumeration( fixture, "enum_compiland_symbols", options.Iterations, CompilandWalk<DebugStore>( store, compCount ) );
+        RunEnumeration( fixture, "enum_public_symbols", options.Iterations, HeapWalk<DebugStore>( store, SymHeap_PublicSymbols ) );
+
+        RunThreadScaling( fixture, "find_line_threads", findLine, options.MaxThreads );
+
+        return S_OK;
+    }
+
+    static HRESULT ReadWholeFile( const wchar_t* filename, std::vector<BYTE>& data )
+    {
+        FileHandlePtr   hFile;
+        DWORD           sizeHigh = 0;
+        DWORD           size = 0;
+        DWORD           read = 0;
+
+        hFile.Attach( CreateFile( filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL ) );
+        if ( hFile.IsEmpty() )
+            return GetLastHr();
+
+        size = GetFileSize( hFile.Get(), &sizeHigh );
+        if ( (size == INVALID_FILE_SIZE) && (GetLastError() != NO_ERROR) )
+            return GetLastHr();
+        if ( (sizeHigh != 0) || (size == 0) )
+            return E_BAD_FORMAT;
+
+        data.resize( size );
+
+        if ( !ReadFile( hFile.Get(), &data[0], size, &read, NULL ) )
+            return GetLastHr();
+        if ( read != size )
+            return E_FAIL;
+
+        return S_OK;
+    }
+
+    // The native PDB readers: PDBReader for the lines, and C13SymbolStore
+    // for the symbols and types. RunDia times them against DIA.
+    static HRESULT RunPdb( const std::string& fixture, const wchar_t* pdbPath, const Options& options )
+    {
+        HRESULT             hr = S_OK;
+        std::vector<BYTE>   pdb;
+        PDBReader           reader;
+        C13SymbolStore      symbols;
+        QuerySet            queries;
+        SynthRandom         random( options.Seed );
+        bool                hasSymbols = false;
+
+        hr = ReadWholeFile( pdbPath, pdb );
+        if ( FAILED( hr ) )
+            return hr;
+
+        JsonLine    fixtureLine( "fixture" );
+
+        fixtureLine.Add( "fixture", fixture.c_str() );
+        fixtureLine.Add( "pdb", pdbPath );
+        fixtureLine.Add( "pdb_bytes", (uint64_t) pdb.size() );
+        fixtureLine.Add( "timer_overhead_ns", TicksToNanoseconds( GetTimerOverhead() ) );
+        fixtureLine.Print();
+
+        Samples     readerInit;
+        Samples     symbolsInit;
+        uint64_t    readerTotal = 0;
+        uint64_t    symbolsTotal = 0;
+
+        for ( uint32_t i = 0; i < options.Iterations; i++ )
+        {
+            std::auto_ptr<PDBReader>        newReader( new PDBReader() );
+            std::auto_ptr<C13SymbolStore>   newSymbols( new C13SymbolStore() );
+            uint64_t                        start = GetTicks();
+
+            hr = newReader->Init( &pdb[0], pdb.size() );
+
+            uint64_t    ticks = GetTicks() - start;
+
+            if ( FAILED( hr ) )
+                return hr;
+
+            readerInit.Add( ticks );
+            readerTotal += ticks;
+
+            start = GetTicks();
+            hr = newSymbols->Init( *newReader );
+            ticks = GetTicks() - start;
+
+            // a PDB whose symbol streams can't be read goes to DIA
+            if ( hr == S_OK )
+            {
+                symbolsInit.Add( ticks );
+                symbolsTotal += ticks;
+            }
+        }
+
+        PrintResult( fixture.c_str(), "pdb_reader_init", 1, readerInit, readerTotal, readerInit.GetCount() );
+        PrintResult( fixture.c_str(), "c13_symbols_init", 1, symbolsInit, symbolsTotal, symbolsInit.GetCount() );
+
+        hr = reader.Init( &pdb[0], pdb.size() );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hasSymbols = symbols.Init( reader ) == S_OK;
+
+        GatherLineQueries( reader, options.QueryCount, random, queries );
+
+        ReaderFindLine      findLine( reader, queries.Lines );
+        ReaderFindLineByNum findLineByNum( reader, queries.LineNums );
+
+        RunQueries( fixture, "pdb_find_line", findLine );
+        RunQueries( fixture, "pdb_find_line_by_num", findLineByNum );
+
+        if ( hasSymbols )
+        {
+            GatherSymbolQueries( symbols, NULL, options.QueryCount, random, queries );
+
+            StoreFindSymbol<C13SymbolStore>         findPublicByAddr( symbols, SymHeap_PublicSymbols, queries.Publics );
+            StoreFindFirstSymbol<C13SymbolStore>    findFirstPublic( symbols, SymHeap_PublicSymbols, queries.Publics );
+            StoreFindFirstSymbol<C13SymbolStore>    findFirstGlobal( symbols, SymHeap_GlobalSymbols, queries.Publics );
+
+            RunQueries( fixture, "c13_find_symbol_public", findPublicByAddr );
+            RunQueries( fixture, "c13_find_first_symbol_public", findFirstPublic );
+            RunQueries( fixture, "c13_find_first_symbol_global", findFirstGlobal );
+
+            RunEnumeration( fixture, "c13_enum_types", options.Iterations, TypeWalk<C13SymbolStore>( symbols ) );
+            RunEnumeration(
+                fixture,
+                "c13_enum_compiland_symbols",
+                options.Iterations,
+                CompilandWalk<C13SymbolStore>( symbols, reader.GetModuleCount() ) );
+        }
+
+        RunThreadScaling( fixture, "pdb_find_line_threads", findLine, options.MaxThreads );
+
+        return S_OK;
+    }
+
+    // What a line lookup found, reduced to what both sides of PDBDebugStore
+    // agree on. The indexes of the line within its tables aren't kept.
+    static uint64_t GetLineKey( const LineNumber& line )
+    {
+        return ((uint64_t) line.Section << 48) | ((uint64_t) line.Number << 32) | line.Offset;
+    }
+
+    static void GetLineKeys( const std::vector<LineNumber>& lines, std::vector<uint64_t>& keys )
+    {
+        keys.resize( lines.size() );
+
+        for ( size_t i = 0; i < lines.size(); i++ )
+            keys[i] = GetLineKey( lines[i] );
+
+        std::sort( keys.begin(), keys.end() );
+    }
+
+    static bool GetSymbolName( PDBDebugStore& store, SymHandle handle, std::string& name )
+    {
+        SymInfoData     infoData = { 0 };
+        ISymbolInfo*    symInfo = NULL;
+        SymString       symName;
+
+        if ( (store.GetSymbolInfo( handle, infoData, symInfo ) != S_OK) || !symInfo->GetName( symName ) )
+            return false;
+
+        name.assign( symName.GetName(), symName.GetLength() );
+        return true;
+    }
+
+    // Asks both stores every query, and counts the ones where they answer
+    // differently. Lines are compared by section, offset, and number; 
+    // symbols by name.
+    static void CompareStores( const std::string& fixture, PDBDebugStore& native, PDBDebugStore& dia, const QuerySet& queries )
+    {
+        uint32_t    lineMismatches = 0;
+        uint32_t    lineNumMismatches = 0;
+        uint32_t    fileLinesMismatches = 0;
+        uint32_t    symbolMismatches = 0;
+        uint32_t    firstSymbolMismatches = 0;
+
+        for ( size_t i = 0; i < queries.Lines.size(); i++ )
+        {
+            const LineQuery&    query = queries.Lines[i];
+            LineNumber          nativeLine = { 0 };
+            LineNumber          diaLine = { 0 };
+            bool                nativeFound = native.FindLine( query.Segment, query.Offset, nativeLine );
+            bool                diaFound = dia.FindLine( query.Segment, query.Offset, diaLine );
+
+            if ( (nativeFound != diaFound)
+                || (nativeFound && (GetLineKey( nativeLine ) != GetLineKey( diaLine ))) )
+                lineMismatches++;
+        }
+
+        for ( size_t i = 0; i < queries.LineNums.size(); i++ )
+        {
+            const LineNumQuery& query = queries.LineNums[i];
+            LineNumber          nativeLine = { 0 };
+            LineNumber          diaLine = { 0 };
+            bool                nativeFound = native.FindLineByNum( (uint16_t) query.CompIndex, query.FileIndex, query.Line, nativeLine );
+            bool                diaFound = dia.FindLineByNum( (uint16_t) query.CompIndex, query.FileIndex, query.Line, diaLine );
+
+            if ( (nativeFound != diaFound)
+                || (nativeFound && (GetLineKey( nativeLine ) != GetLineKey( diaLine ))) )
+                lineNumMismatches++;
+        }
+
+        for ( size_t i = 0; i < queries.FileLines.size(); i++ )
+        {
+            const FileLinesQuery&   query = queries.FileLines[i];
+            std::vector<LineNumber> nativeLines;
+            std::vector<LineNumber> diaLines;
+            std::vector<uint64_t>   nativeKeys;
+            std::vector<uint64_t>   diaKeys;
+
+            native.FindLines( false, query.FileName.c_str(), query.FileName.size(), query.LineStart, query.LineEnd, nativeLines );
+            dia.FindLines( false, query.FileName.c_str(), query.FileName.size(), query.LineStart, query.LineEnd, diaLines );
+
+            // the two sides may list the lines in different orders
+            GetLineKeys( nativeLines, nativeKeys );
+            GetLineKeys( diaLines, diaKeys );
+
+            if ( nativeKeys != diaKeys )
+                fileLinesMismatches++;
+        }
+
+        for ( size_t i = 0; i < queries.Publics.size(); i++ )
+        {
+            const SymbolQuery&  query = queries.Publics[i];
+            SymHandle           nativeHandle = { 0 };
+            SymHandle           diaHandle = { 0 };
+            std::string         nativeName;
+            std::string         diaName;
+            bool                nativeFound = native.FindSymbol( SymHeap_PublicSymbols, query.Segment, query.Offset + (i % 3), nativeHandle ) == S_OK;
+            bool                diaFound = dia.FindSymbol( SymHeap_PublicSymbols, query.Segment, query.Offset + (i % 3), diaHandle ) == S_OK;
+
+            if ( nativeFound )
+                GetSymbolName( native, nativeHandle, nativeName );
+            if ( diaFound )
+                GetSymbolName( dia, diaHandle, diaName );
+
+            if ( (nativeFound != diaFound) || (nativeName != diaName) )
+                symbolMismatches++;
+
+            EnumNamedSymbolsData    nativeData = { 0 };
+            EnumNamedSymbolsData    diaData = { 0 };
+
+            nativeFound = native.FindFirstSymbol( SymHeap_GlobalSymbols, query.Name.c_str(), query.Name.size(), nativeData ) == S_OK;
+            diaFound = dia.FindFirstSymbol( SymHeap_GlobalSymbols, query.Name.c_str(), query.Name.size(), diaData ) == S_OK;
+
+            if ( nativeFound != diaFound )
+                firstSymbolMismatches++;
+        }
+
+        JsonLine    line( "compare" );
+
+        line.Add( "fixture", fixture.c_str() );
+        line.Add( "find_line", (uint32_t) queries.Lines.size() );
+        line.Add( "find_line_mismatches", lineMismatches );
+        line.Add( "find_line_by_num", (uint32_t) queries.LineNums.size() );
+        line.Add( "find_line_by_num_mismatches", lineNumMismatches );
+        line.Add( "find_lines", (uint32_t) queries.FileLines.size() );
+        line.Add( "find_lines_mismatches", fileLinesMismatches );
+        line.Add( "find_symbol_public", (uint32_t) queries.Publics.size() );
+        line.Add( "find_symbol_public_mismatches", symbolMismatches );
+        line.Add( "find_first_symbol_global", (uint32_t) queries.Publics.size() );
+        line.Add( "find_first_symbol_global_mismatches", firstSymbolMismatches );
+        line.Print();
+    }
+
+    // The same lookups through both sides of PDBDebugStore: the native
+    // readers, and DIA once a second store has closed them. The queries are
+    // picked from the native side. Both sides are timed, and then asked the
+    // same queries again to check that they agree.
+    static HRESULT RunDia( const std::string& fixture, const wchar_t* imagePath, const Options& options )
+    {
+        HRESULT         hr = S_OK;
+        ImageCodeView   codeView;
+        PDBDebugStore   native;
+        PDBDebugStore   dia;
+        QuerySet        queries;
+        SynthRandom     random( options.Seed );
+
+        hr = codeView.Load( imagePath, true );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = native.InitDebugInfo( codeView.GetData(), codeView.GetSize(), imagePath, NULL );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = dia.InitDebugInfo( codeView.GetData(), codeView.GetSize(), imagePath, NULL );
+        if ( FAILED( hr ) )
+            return hr;
+
+        dia.CloseNativeReaders();
+
+        JsonLine    fixtureLine( "fixture" );
+
+        fixtureLine.Add( "fixture", fixture.c_str() );
+        fixtureLine.Add( "image", imagePath );
+        fixtureLine.Add( "native_lines", (uint32_t) native.HasNativeLines() );
+        fixtureLine.Add( "native_symbols", (uint32_t) native.HasNativeSymbols() );
+        fixtureLine.Add( "timer_overhead_ns", TicksToNanoseconds( GetTimerOverhead() ) );
+        fixtureLine.Print();
+
+        // without the native readers, both sides would be DIA
+        if ( !native.HasNativeLines() )
+            return E_BAD_FORMAT;
+
+        GatherLineQueries( native, options.QueryCount, random, queries );
+        GatherSymbolQueries( native, codeView.GetAddrMap(), options.QueryCount, random, queries );
+
+        StoreFindLine<PDBDebugStore>        nativeFindLine( native, queries.Lines );
+        StoreFindLine<PDBDebugStore>        diaFindLine( dia, queries.Lines );
+        StoreFindLineByNum<PDBDebugStore>   nativeFindLineByNum( native, queries.LineNums );
+        StoreFindLineByNum<PDBDebugStore>   diaFindLineByNum( dia, queries.LineNums );
+        StoreFindLines<PDBDebugStore>       nativeFindLines( native, queries.FileLines );
+        StoreFindLines<PDBDebugStore>       diaFindLines( dia, queries.FileLines );
+
+        StoreFindSymbol<PDBDebugStore>      nativeFindPublic( native, SymHeap_PublicSymbols, queries.Publics );
+        StoreFindSymbol<PDBDebugStore>      diaFindPublic( dia, SymHeap_PublicSymbols, queries.Publics );
+        StoreFindFirstSymbol<PDBDebugStore> nativeFindFirstGlobal( native, SymHeap_GlobalSymbols, queries.Publics );
+        StoreFindFirstSymbol<PDBDebugStore> diaFindFirstGlobal( dia, SymHeap_GlobalSymbols, queries.Publics );
+
+        RunQueries( fixture, "native_find_line", nativeFindLine );
+        RunQueries( fixture, "dia_find_line", diaFindLine );
+        RunQueries( fixture, "native_find_line_by_num", nativeFindLineByNum );
+        RunQueries( fixture, "dia_find_line_by_num", diaFindLineByNum );
+        RunQueries( fixture, "native_find_lines", nativeFindLines );
+        RunQueries( fixture, "dia_find_lines", diaFindLines );
+        RunQueries( fixture, "native_find_symbol_public", nativeFindPublic );
+        RunQueries( fixture, "dia_find_symbol_public", diaFindPublic );
+        RunQueries( fixture, "native_find_first_symbol_global", nativeFindFirstGlobal );
+        RunQueries( fixture, "dia_find_first_symbol_global", diaFindFirstGlobal );
+
+        RunThreadScaling( fixture, "native_find_line_threads", nativeFindLine, options.MaxThreads );
+        RunThreadScaling( fixture, "dia_find_line_threads", diaFindLine, options.MaxThreads );
+
+        CompareStores( fixture, native, dia, queries );
+
+        return S_OK;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  Startup
+    //------------------------------------------------------------------------
+
+    // the most threads that the debug engine's SymbolLoader starts, unless
+    // it's configured otherwise
+    const uint32_t  StartupMaxThreads = 4;
+
+    struct StartupLoads
+    {
+        const wchar_t*                      ImagePath;
+        std::vector<RefPtr<IDataSource> >   Sources;
+        std::vector<RefPtr<ISession> >      Sessions;
+        volatile long                       NextModule;
+        volatile long                       Failures;
+    };
+
+    // Takes the next module until there are none left, the way that each of
+    // SymbolLoader's threads takes the next queued one.
+    static unsigned int __stdcall StartupThreadProc( void* param )
+    {
+        StartupLoads*   loads = (StartupLoads*) param;
+
+        for ( ;; )
+        {
+            long    index = InterlockedIncrement( &loads->NextModule ) - 1;
+
+            if ( index >= (long) loads->Sessions.size() )
+                break;
+
+            if ( FAILED( OpenSession( loads->ImagePath, NULL, loads->Sources[index], loads->Sessions[index] ) ) )
+                InterlockedIncrement( &loads->Failures );
+        }
+
+        return 0;
+    }
+
+    // Opens a session on the image for each module, on threadCount threads, 
+    // or on this thread if it's 0. Returns the time until all of them are 
+    // open, which is when the engine lets the debuggee run to its first 
+    // break. The sessions stay open until then, like the modules' do.
+    static HRESULT LoadStartupModules( const wchar_t* imagePath, uint32_t moduleCount, uint32_t threadCount, uint64_t& ticks )
+    {
+        StartupLoads            loads;
+        std::vector<HANDLE>     handles;
+        uint64_t                start = 0;
+
+        loads.ImagePath = imagePath;
+        loads.Sources.resize( moduleCount );
+        loads.Sessions.resize( moduleCount );
+        loads.NextModule = 0;
+        loads.Failures = 0;
+
+        start = GetTicks();
+
+        if ( threadCount == 0 )
+        {
+            StartupThreadProc( &loads );
+        }
+        else
+        {
+            for ( uint32_t t = 0; t < threadCount; t++ )
+            {
+                HANDLE  hThread = (HANDLE) _beginthreadex( NULL, 0, StartupThreadProc, &loads, 0, NULL );
+
+                if ( hThread == NULL )
+                    break;
+
+                handles.push_back( hThread );
+            }
+
+            if ( handles.size() == 0 )
+                return E_FAIL;
+
+            WaitForMultipleObjects( handles.size(), &handles[0], TRUE, INFINITE );
+        }
+
+        ticks = GetTicks() - start;
+
+        for ( size_t t = 0; t < handles.size(); t++ )
+            CloseHandle( handles[t] );
+
+        if ( loads.Failures > 0 )
+            return E_FAIL;
+
+        return S_OK;
+    }
+
+    // What the debug engine does for the modules that a process loads before
+    // its first break: a data source, the image, the store, and a session for
+    // each. They're opened one after another on the event thread, as before
+    // SymbolLoader, and then on a pool of threads, as SymbolLoader does. Each
+    // module is a load of the same image.
+    static HRESULT RunStartup( const std::string& fixture, const wchar_t* imagePath, const Options& options )
+    {
+        uint32_t    threadCount = std::min<uint32_t>( options.MaxThreads, StartupMaxThreads );
+        Samples     serial;
+        Samples     pooled;
+        uint64_t    serialTotal = 0;
+        uint64_t    pooledTotal = 0;
+
+        JsonLine    fixtureLine( "fixture" );
+
+        fixtureLine.Add( "fixture", fixture.c_str() );
+        fixtureLine.Add( "image", imagePath );
+        fixtureLine.Add( "timer_overhead_ns", TicksToNanoseconds( GetTimerOverhead() ) );
+        fixtureLine.Print();
+
+        // the two take turns going first, so that neither one always finds
+        // the image in a warmer cache
+        for ( uint32_t i = 0; i < (options.Iterations * 2); i++ )
+        {
+            bool        isPooled = ((i % 2) == (i / 2) % 2);
+            uint64_t    ticks = 0;
+            HRESULT     hr = LoadStartupModules( imagePath, options.ModuleCount, isPooled ? threadCount : 0, ticks );
+
+            if ( FAILED( hr ) )
+            {
+                PrintError( fixture, isPooled ? "startup_pooled" : "startup_serial", hr );
+                return hr;
+            }
+
+            if ( isPooled )
+            {
+                pooled.Add( ticks );
+                pooledTotal += ticks;
+            }
+            else
+            {
+                serial.Add( ticks );
+                serialTotal += ticks;
+            }
+        }
+
+        // each sample is the time to load all of the modules once
+        PrintResult( fixture.c_str(), "startup_serial", 1, serial, serialTotal, serial.GetCount() );
+        PrintResult( fixture.c_str(), "startup_pooled", threadCount, pooled, pooledTotal, pooled.GetCount() );
+
+        uint64_t    serialTicks = serial.GetPercentile( 50 );
+        uint64_t    pooledTicks = pooled.GetPercentile( 50 );
+        JsonLine    line( "startup" );
+
+        line.Add( "fixture", fixture.c_str() );
+        line.Add( "modules", options.ModuleCount );
+        line.Add( "threads", threadCount );
+        line.Add( "serial_p50_ns", TicksToNanoseconds( serialTicks ) );
+        line.Add( "pooled_p50_ns", TicksToNanoseconds( pooledTicks ) );
+        line.Add( "speedup", (pooledTicks > 0) ? (double) serialTicks / pooledTicks : 0.0 );
+        line.Print();
+
+        return S_OK;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  Stress
+    //------------------------------------------------------------------------
+
+    // addresses in each call to FindAddresses
+    const size_t    StressBatchSize = 16;
+
+    // What a session found for each stress query. Handles point into the
+    // session's store, so each result is reduced to a hash of what the
+    // handles refer to, which can be compared across sessions.
+    struct StressResults
+    {
+        std::vector<uint32_t>   Addresses;
+        std::vector<uint32_t>   Members;
+    };
+
+    class ResultHash
+    {
+        uint32_t    mHash;
+
+    public:
+        ResultHash()
+            :   mHash( Fnv1aOffsetBasis )
+        {
+        }
+
+        void Add( const void* data, size_t size )
+        {
+            mHash = HashFnv1a( data, size, mHash );
+        }
+
+        void Add( uint32_t value )
+        {
+            Add( &value, sizeof value );
+        }
+
+        void Add( const SymString& str )
+        {
+            Add( (uint32_t) str.GetLength() );
+            Add( str.GetName(), str.GetLength() );
+        }
+
+        uint32_t Get() const
+        {
+            return mHash;
+        }
+    };
+
+    static void HashSymbol( ISession* session, SymHandle handle, ResultHash& hash )
+    {
+        SymInfoData     infoData = { 0 };
+        ISymbolInfo*    symInfo = NULL;
+        SymString       name;
+        uint16_t        segment = 0;
+        uint32_t        offset = 0;
+        uint32_t        length = 0;
+
+        if ( session->GetSymbolInfo( handle, infoData, symInfo ) != S_OK )
+        {
+            hash.Add( 0xFFFFFFFF );
+            return;
+        }
+
+        symInfo->GetName( name );
+        symInfo->GetAddressSegment( segment );
+        symInfo->GetAddressOffset( offset );
+        symInfo->GetLength( length );
+
+        hash.Add( (uint32_t) symInfo->GetSymTag() );
+        hash.Add( name );
+        hash.Add( segment );
+        hash.Add( offset );
+        hash.Add( length );
+    }
+
+    static uint32_t HashAddress( ISession* session, const AddressInfo& info )
+    {
+        ResultHash  hash;
+
+        hash.Add( info.Section );
+
+        // nothing else is set for an address outside the module
+        if ( info.Section == 0 )
+            return hash.Get();
+
+        hash.Add( info.Offset );
+        hash.Add( info.HasFunction );
+
+        if ( info.HasFunction )
+            HashSymbol( session, info.FuncHandle, hash );
+
+        hash.Add( (uint32_t) info.Blocks.size() );
+
+        for ( size_t i = 0; i < info.Blocks.size(); i++ )
+            HashSymbol( session, info.Blocks[i], hash );
+
+        hash.Add( info.HasLine );
+
+        if ( info.HasLine )
+        {
+            hash.Add( info.Line.CompilandIndex );
+            hash.Add( info.Line.FileIndex );
+            hash.Add( info.Line.SegmentInstanceIndex );
+            hash.Add( info.Line.LineIndex );
+            hash.Add( info.Line.Number );
+            hash.Add( info.Line.NumberEnd );
+            hash.Add( info.Line.Section );
+            hash.Add( info.Line.Offset );
+            hash.Add( info.Line.Length );
+        }
+
+        return hash.Get();
+    }
+
+    static uint32_t HashMember( ISession* session, const MemberQuery& query )
+    {
+        ResultHash      hash;
+        TypeHandle      handle = { 0 };
+        int32_t         baseOffset = 0;
+        SymInfoData     infoData = { 0 };
+        ISymbolInfo*    typeInfo = NULL;
+        HRESULT         hr = S_OK;
+
+        hr = session->FindMemberType( query.FieldListIndex, query.Name.c_str(), query.Name.size(), handle, baseOffset );
+        hash.Add( (uint32_t) hr );
+
+        if ( hr != S_OK )
+            return hash.Get();
+
+        hash.Add( (uint32_t) baseOffset );
+
+        if ( session->GetTypeInfo( handle, infoData, typeInfo ) == S_OK )
+        {
+            SymString   name;
+            int32_t     offset = 0;
+            TypeIndex   type = 0;
+
+            typeInfo->GetName( name );
+            typeInfo->GetOffset( offset );
+            typeInfo->GetType( type );
+
+            hash.Add( (uint32_t) typeInfo->GetSymTag() );
+            hash.Add( name );
+            hash.Add( (uint32_t) offset );
+            hash.Add( type );
+        }
+
+        return hash.Get();
+    }
+
+    // Runs every batch of addresses and every member query once, starting at
+    // the given batch and member, and alternating between the two, so that
+    // scope trees and member indexes are built while the other is being read.
+    static uint64_t RunStressQueries(
+        ISession* session,
+        const std::vector<uint64_t>& vas,
+        const std::vector<MemberQuery>& members,
+        size_t firstBatch,
+        size_t firstMember,
+        StressResults& results )
+    {
+        size_t                      batchCount = (vas.size() + StressBatchSize - 1) / StressBatchSize;
+        size_t                      stepCount = std::max( batchCount, members.size() );
+        std::vector<AddressInfo>    infos( StressBatchSize );
+        uint64_t                    ops = 0;
+
+        results.Addresses.resize( vas.size() );
+        results.Members.resize( members.size() );
+
+        for ( size_t step = 0; step < stepCount; step++ )
+        {
+            if ( step < batchCount )
+            {
+                size_t  start = ((firstBatch + step) % batchCount) * StressBatchSize;
+                size_t  count = std::min( StressBatchSize, vas.size() - start );
+
+                if ( session->FindAddresses( &vas[start], (uint32_t) count, &infos[0] ) == S_OK )
+                {
+                    for ( size_t i = 0; i < count; i++ )
+                        results.Addresses[start + i] = HashAddress( session, infos[i] );
+                }
+                else
+                {
+                    for ( size_t i = 0; i < count; i++ )
+                        results.Addresses[start + i] = 0;
+                }
+
+                ops++;
+            }
+
+            if ( step < members.size() )
+            {
+                size_t  index = (firstMember + step) % members.size();
+
+                results.Members[index] = HashMember( session, members[index] );
+                ops++;
+            }
+        }
+
+        return ops;
+    }
+
+    struct StressThread
+    {
+        ISession*                           Session;
+        const std::vector<uint64_t>*        VAs;
+        const std::vector<MemberQuery>*     Members;
+        const StressResults*                Expected;
+        size_t                              FirstBatch;
+        size_t                              FirstMember;
+        HANDLE                              StartEvent;
+        uint64_t                            Ops;
+        uint64_t                            Mismatches;
+    };
+
+    static unsigned int __stdcall StressThreadProc( void* param )
+    {
+        StressThread*   thread = (StressThread*) param;
+        StressResults   results;
+
+        WaitForSingleObject( thread->StartEvent, INFINITE );
+
+        thread->Ops = RunStressQueries(
+            thread->Session,
+            *thread->VAs,
+            *thread->Members,
+            thread->FirstBatch,
+            thread->FirstMember,
+            results );
+
+        for ( size_t i = 0; i < results.Addresses.size(); i++ )
+        {
+            if ( results.Addresses[i] != thread->Expected->Addresses[i] )
+                thread->Mismatches++;
+        }
+
+        for ( size_t i = 0; i < results.Members.size(); i++ )
+        {
+            if ( results.Members[i] != thread->Expected->Members[i] )
+                thread->Mismatches++;
+        }
+
+        return 0;
+    }
+
+    // Runs the stress queries on all the threads at once, over a session
+    // that nothing has been looked up in yet.
+    static HRESULT RunStressRound(
+        const wchar_t* imagePath,
+        const std::vector<uint64_t>& vas,
+        const std::vector<MemberQuery>& members,
+        const StressResults& expected,
+        uint32_t threadCount,
+        uint64_t& ops,
+        uint64_t& mismatches )
+    {
+        HRESULT                     hr = S_OK;
+        RefPtr<IDataSource>         source;
+        RefPtr<ISession>            session;
+        std::vector<StressThread>   threads( threadCount );
+        std::vector<HANDLE>         handles;
+        HandlePtr                   startEvent;
+        size_t                      batchCount = (vas.size() + StressBatchSize - 1) / StressBatchSize;
+
+        hr = OpenSession( imagePath, NULL, source, session );
+        if ( FAILED( hr ) )
+            return hr;
+
+        startEvent.Attach( CreateEvent( NULL, TRUE, FALSE, NULL ) );
+        if ( startEvent.IsEmpty() )
+            return GetLastHr();
+
+        for ( uint32_t t = 0; t < threadCount; t++ )
+        {
+            threads[t].Session = session.Get();
+            threads[t].VAs = &vas;
+            threads[t].Members = &members;
+            threads[t].Expected = &expected;
+            threads[t].FirstBatch = (t * batchCount) / threadCount;
+            threads[t].FirstMember = (t * members.size()) / threadCount;
+            threads[t].StartEvent = startEvent.Get();
+            threads[t].Ops = 0;
+            threads[t].Mismatches = 0;
+
+            HANDLE  hThread = (HANDLE) _beginthreadex( NULL, 0, StressThreadProc, &threads[t], 0, NULL );
+
+            if ( hThread == NULL )
+                break;
+
+            handles.push_back( hThread );
+        }
+
+        if ( handles.size() == 0 )
+            return E_FAIL;
+
+        SetEvent( startEvent.Get() );
+        WaitForMultipleObjects( handles.size(), &handles[0], TRUE, INFINITE );
+
+        for ( size_t t = 0; t < handles.size(); t++ )
+        {
+            CloseHandle( handles[t] );
+            ops += threads[t].Ops;
+            mismatches += threads[t].Mismatches;
+        }
+
+        return S_OK;
+    }
+
+    // Looks up addresses, with their functions, blocks, and lines, and
+    // members of structures, from many threads at once on one session, and
+    // checks every result against what a session on one thread found. Each
+    // round opens a new session, so that the threads race to build its scope
+    // trees and member indexes.
+    static HRESULT RunStress( const std::string& fixture, const wchar_t* imagePath, const Options& options )
+    {
+        HRESULT                 hr = S_OK;
+        ImageCodeView           codeView;
+        DebugStore              store;
+        RefPtr<IDataSource>     source;
+        RefPtr<ISession>        session;
+        QuerySet                queries;
+        SynthRandom             random( options.Seed );
+        std::vector<uint64_t>   vas;
+        StressResults           expected;
+        uint64_t                ops = 0;
+        uint64_t                mismatches = 0;
+
+        hr = codeView.Load( imagePath, false );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = InitStore( codeView, store, NULL, 0 );
+        if ( FAILED( hr ) )
+            return hr;
+
+        GatherLineQueries( store, options.QueryCount, random, queries );
+        GatherSymbolQueries( store, codeView.GetAddrMap(), options.QueryCount, random, queries );
+        GatherMemberQueries( store, options.QueryCount, random, queries );
+
+        hr = OpenSession( imagePath, NULL, source, session );
+        if ( FAILED( hr ) )
+            return hr;
+
+        for ( size_t i = 0; i < queries.Lines.size(); i++ )
+            vas.push_back( session->GetVAFromSecOffset( queries.Lines[i].Segment, queries.Lines[i].Offset ) );
+
+        // a few bytes into each public, and now and then an address that
+        // isn't in the module
+        for ( size_t i = 0; i < queries.Publics.size(); i++ )
+        {
+            vas.push_back( session->GetVAFromSecOffset( queries.Publics[i].Segment, queries.Publics[i].Offset + (i % 3) ) );
+
+            if ( (i % 64) == 0 )
+                vas.push_back( 0 );
+        }
+
+        RunStressQueries( session.Get(), vas, queries.Members, 0, 0, expected );
+
+        uint64_t    wallStart = GetTicks();
+
+        for ( uint32_t i = 0; i < options.Iterations; i++ )
+        {
+            hr = RunStressRound( imagePath, vas, queries.Members, expected, options.MaxThreads, ops, mismatches );
+            if ( FAILED( hr ) )
+                return hr;
+        }
+
+        JsonLine    line( "stress" );
+
+        line.Add( "fixture", fixture.c_str() );
+        line.Add( "threads", options.MaxThreads );
+        line.Add( "rounds", options.Iterations );
+        line.Add( "addresses", (uint64_t) vas.size() );
+        line.Add( "members", (uint64_t) queries.Members.size() );
+        line.Add( "ops", ops );
+        line.Add( "mismatches", mismatches );
+        line.Add( "wall_ns", TicksToNanoseconds( GetTicks() - wallStart ) );
+        line.Print();
+
+        if ( mismatches != 0 )
+            return E_FAIL;
+
+        return S_OK;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  Generating
+    //------------------------------------------------------------------------
+
+    static void ApplyOverrides( const SynthParams& overrides, SynthParams& params )
+    {
+        if ( overrides.CompilandCount != 0 )    params.CompilandCount = overrides.CompilandCount;
+        if ( overrides.ProcsPerCompiland != 0 ) params.ProcsPerCompiland = overrides.ProcsPerCompiland;
+        if ( overrides.LinesPerProc != 0 )      params.LinesPerProc = overrides.LinesPerProc;
+        if ( overrides.FilesPerCompiland != 0 ) params.FilesPerCompiland = overrides.FilesPerCompiland;
+        if ( overrides.LocalsPerProc != 0 )     params.LocalsPerProc = overrides.LocalsPerProc;
+        if ( overrides.PublicCount != 0 )       params.PublicCount = overrides.PublicCount;
+        if ( overrides.StructCount != 0 )       params.StructCount = overrides.StructCount;
+        if ( overrides.FieldsPerStruct != 0 )   params.FieldsPerStruct = overrides.FieldsPerStruct;
+        if ( overrides.Seed != 0 )              params.Seed = overrides.Seed;
+    }
+
+    static HRESULT Generate( SynthScale scale, const wchar_t* imagePath, const Options& options )
+    {
+        SynthParams         params = { 0 };
+        SynthStats          stats = { 0 };
+        std::vector<BYTE>   cv;
+        HRESULT             hr = S_OK;
+
+        SetScaleParams( scale, params );
+        ApplyOverrides( options.Overrides, params );
+
+        BuildCodeView( params, cv, stats );
+
+        hr = WriteImage( imagePath, cv, stats );
+        if ( FAILED( hr ) )
+            return hr;
+
+        JsonLine    line( "generated" );
+
+        line.Add( "fixture", GetScaleName( scale ) );
+        line.Add( "image", imagePath );
+        line.Add( "compilands", params.CompilandCount );
+        line.Add( "procs", stats.ProcCount );
+        line.Add( "lines", stats.LineCount );
+        line.Add( "publics", stats.PublicCount );
+        line.Add( "types", stats.TypeCount );
+        line.Add( "code_bytes", stats.CodeSize );
+        line.Add( "cv_bytes", stats.CVSize );
+        line.Add( "seed", params.Seed );
+        line.Print();
+
+        return S_OK;
+    }
+
+    static HRESULT Sweep( const Options& options )
+    {
+        std::wstring    tempDir = GetBenchTempDir();
+
+        for ( int i = 0; i < SynthScale_Count; i++ )
+        {
+            SynthScale      scale = (SynthScale) i;
+            std::wstring    imagePath = tempDir + ToWide( GetScaleName( scale ) ) + L".exe";
+            HRESULT         hr = S_OK;
+
+            hr = Generate( scale, imagePath.c_str(), options );
+            if ( FAILED( hr ) )
+                return hr;
+
+            hr = RunImage( GetScaleName( scale ), imagePath.c_str(), options );
+
+            DeleteFile( imagePath.c_str() );
+
+            if ( FAILED( hr ) )
+                return hr;
+        }
+
+        return S_OK;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  Command line
+    //------------------------------------------------------------------------
+
+    static void PrintUsage()
+    {
+        fprintf( stderr,
+            "Usage:\n"
+            "  CVSymBench gen <small|medium|large> <image> [options]\n"
+            "  CVSymBench run <image> [options]\n"
+            "  CVSymBench sweep [options]\n"
+            "  CVSymBench pdb <pdb> [options]\n"
+            "  CVSymBench dia <image> [options]\n"
+            "  CVSymBench stress <image> [options]\n"
+            "  CVSymBench startup <image> [options]\n"
+            "\n"
+            "Options:\n"
+            "  -queries N      queries in each lookup scenario (10000)\n"
+            "  -iterations N   runs of each load and enumeration scenario,\n"
+            "                  and stress and startup rounds (5)\n"
+            "  -threads N      most threads for line lookup scaling, the\n"
+            "                  threads of the stress rounds, and the startup\n"
+            "                  threads, up to 4 (processors)\n"
+            "  -seed N         for the generated debug info and the queries (1)\n"
+            "  -modules N      modules loaded by startup (150)\n"
+            "  -compilands N, -procs N, -lines N, -files N, -locals N,\n"
+            "  -publics N, -structs N, -fields N\n"
+            "                  override the debug info of the scale\n" );
+    }
+
+    static bool ParseOptions( int argc, wchar_t* argv[], int first, Options& options )
+    {
+        SYSTEM_INFO sysInfo = { 0 };
+
+        GetSystemInfo( &sysInfo );
+
+        memset( &options, 0, sizeof options );
+        options.QueryCount = 10000;
+        options.Iterations = 5;
+        options.MaxThreads = std::max<DWORD>( sysInfo.dwNumberOfProcessors, 1 );
+        options.Seed = 1;
+        options.ModuleCount = 150;
+
+        for ( int i = first; i < argc; i += 2 )
+        {
+            const wchar_t*  name = argv[i];
+            uint32_t        value = 0;
+
+            if ( (i + 1) >= argc )
+                return false;
+
+            value = wcstoul( argv[i + 1], NULL, 10 );
+
+            if ( wcscmp( name, L"-queries" ) == 0 )          options.QueryCount = std::max<uint32_t>( value, 1 );
+            else if ( wcscmp( name, L"-iterations" ) == 0 )  options.Iterations = std::max<uint32_t>( value, 1 );
+            else if ( wcscmp( name, L"-threads" ) == 0 )     options.MaxThreads = std::min<uint32_t>( std::max<uint32_t>( value, 1 ), MAXIMUM_WAIT_OBJECTS );
+            else if ( wcscmp( name, L"-seed" ) == 0 )        options.Seed = options.Overrides.Seed = value;
+            else if ( wcscmp( name, L"-modules" ) == 0 )     options.ModuleCount = std::max<uint32_t>( value, 1 );
+            else if ( wcscmp( name, L"-compilands" ) == 0 )  options.Overrides.CompilandCount = value;
+            else if ( wcscmp( name, L"-procs" ) == 0 )       options.Overrides.ProcsPerCompiland = value;
+            else if ( wcscmp( name, L"-lines" ) == 0 )       options.Overrides.LinesPerProc = value;
+            else if ( wcscmp( name, L"-files" ) == 0 )       options.Overrides.FilesPerCompiland = value;
+            else if ( wcscmp( name, L"-locals" ) == 0 )      options.Overrides.LocalsPerProc = value;
+            else if ( wcscmp( name, L"-publics" ) == 0 )     options.Overrides.PublicCount = value;
+            else if ( wcscmp( name, L"-structs" ) == 0 )     options.Overrides.StructCount = value;
+            else if ( wcscmp( name, L"-fields" ) == 0 )      options.Overrides.FieldsPerStruct = value;
+            else
+                return false;
+        }
+
+        return true;
+    }
+
+    static std::string GetFixtureName( const wchar_t* path )
+    {
+        const wchar_t*  name = wcsrchr( path, L'\\' );
+
+        name = (name != NULL) ? name + 1 : path;
+        return ToUtf8( name );
+    }
+}
+
+
+int wmain( int argc, wchar_t* argv[] )
+{
+    Options     options;
+    HRESULT     hr = S_OK;
+    int         optionsStart = 0;
+
+    if ( argc < 2 )
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    const wchar_t*  command = argv[1];
+
+    if ( wcscmp( command, L"sweep" ) == 0 )
+        optionsStart = 2;
+    else if ( (wcscmp( command, L"run" ) == 0)
+        || (wcscmp( command, L"pdb" ) == 0)
+        || (wcscmp( command, L"dia" ) == 0)
+        || (wcscmp( command, L"stress" ) == 0)
+        || (wcscmp( command, L"startup" ) == 0) )
+        optionsStart = 3;
+    else if ( wcscmp( command, L"gen" ) == 0 )
+        optionsStart = 4;
+
+    if ( (optionsStart == 0) || (argc < optionsStart) || !ParseOptions( argc, argv, optionsStart, options ) )
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    if ( wcscmp( command, L"gen" ) == 0 )
+    {
+        SynthScale  scale = SynthScale_Small;
+
+        if ( !GetScaleFromName( ToUtf8( argv[2] ).c_str(), scale ) )
+        {
+            PrintUsage();
+            return 2;
+        }
+
+        hr = Generate( scale, argv[3], options );
+    }
+    else if ( wcscmp( command, L"run" ) == 0 )
+        hr = RunImage( GetFixtureName( argv[2] ), argv[2], options );
+    else if ( wcscmp( command, L"pdb" ) == 0 )
+        hr = RunPdb( GetFixtureName( argv[2] ), argv[2], options );
+    else if ( wcscmp( command, L"dia" ) == 0 )
+        hr = RunDia( GetFixtureName( argv[2] ), argv[2], options );
+    else if ( wcscmp( command, L"stress" ) == 0 )
+        hr = RunStress( GetFixtureName( argv[2] ), argv[2], options );
+    else if ( wcscmp( command, L"startup" ) == 0 )
+        hr = RunStartup( GetFixtureName( argv[2] ), argv[2], options );
+    else
+        hr = Sweep( options );
+
+    if ( FAILED( hr ) )
+    {
+        fprintf( stderr, "CVSymBench failed: %08x\n", hr );
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,61 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+// stdafx.h : include file for standard system include files,
+// or project specific include files that are used frequently, but
+// are changed infrequently
+//
+
+#pragma once
+
+#include "targetver.h"
+
+#define WIN32_LEAN_AND_MEAN             // Exclude rarely-used stuff from Windows headers
+
+// C
+#include <stdio.h>
+#include <crtdbg.h>
+#include <inttypes.h>
+#include <process.h>
+
+// STL
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Windows
+#include <windows.h>
+#include <psapi.h>
+
+// Magus
+#include <SmartPtr.h>
+#include <Guard.h>
+
+// CVSym project
+#include "..\CVSym\Error.h"
+#include "..\CVSym\CVSym.h"
+#include "..\CVSym\CVSymInternal.h"
+#include "..\CVSym\CVRec.h"
+#include "..\CVSym\CVExeFmt.h"
+#include "..\CVSym\OMFHashTable.h"
+#include "..\CVSym\PDBReader.h"
+#include "..\CVSym\C13SymbolStore.h"
+#include "..\CVSym\PDBDebugStore.h"
+#include "..\CVSym\Util.h"
+
+// CVSTI project
+#include "..\CVSTI\CVSTI.h"
+#include "..\CVSTI\ImageAddrMap.h"
+
+// BinImage project
+#include "..\BinImage\BinImage.h"
+
+// Windows declarations that I don't want
+#undef max
+#undef min
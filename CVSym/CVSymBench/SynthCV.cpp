@@ -0,0 +1,1045 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#include "Common.h"
+#include "SynthCV.h"
+
+
+namespace CVSymBench
+{
+    const WORD      CodeSegment = 1;
+    const WORD      DataSegment = 2;
+    const WORD      SegmentCount = 2;
+
+    const WORD      PrimUChar = 0x0020;
+    const WORD      PrimInt4 = 0x0074;
+    const WORD      PrimUInt4 = 0x0075;
+    const WORD      PrimReal64 = 0x0041;
+
+    const WORD      ArgListType = 0x1000;
+    const WORD      ProcType = 0x1001;
+    const WORD      FirstStructType = 0x1002;
+    const uint32_t  TypesPerStruct = 3;     // field list, structure, pointer
+
+    const WORD      PtrNear32 = 0x000A;
+    const WORD      MemberAttr = 3;         // public
+
+    // the line table of a file holds at most this many lines, and no line
+    // number can be higher
+    const uint32_t  MaxFileLines = 60000;
+
+    const uint32_t  ImageBase = 0x400000;
+    const uint32_t  SectionAlign = 0x1000;
+    const uint32_t  FileAlign = 0x200;
+
+    struct ProcLayout
+    {
+        DWORD       Start;
+        DWORD       Length;
+        uint32_t    FirstLine;      // in LineOffsets and LineNumbers
+        uint32_t    SymOffset;      // in its compiland's sstAlignSym
+    };
+
+    struct FileLayout
+    {
+        uint32_t    FirstProc;
+        uint32_t    ProcCount;
+    };
+
+    struct CompilandLayout
+    {
+        uint32_t                FirstProc;
+        DWORD                   Start;
+        DWORD                   Length;
+        DWORD                   StaticOffset;
+        std::vector<FileLayout> Files;
+    };
+
+    struct Layout
+    {
+        std::vector<CompilandLayout>    Compilands;
+        std::vector<ProcLayout>         Procs;
+        std::vector<DWORD>              LineOffsets;
+        std::vector<WORD>               LineNumbers;
+        uint32_t                        DataCount;
+        DWORD                           CodeSize;
+        DWORD                           DataSize;
+    };
+
+    // a symbol of a hashed heap, for its name and address tables
+    struct HashSym
+    {
+        uint32_t    SymOffset;
+        uint32_t    Hash;
+        WORD        Segment;        // 0 if it isn't in the address table
+        DWORD       Offset;
+    };
+
+    struct DirEntry
+    {
+        WORD        SubSection;
+        WORD        Mod;
+        DWORD       Offset;
+        DWORD       Size;
+    };
+
+
+    //------------------------------------------------------------------------
+    //  Writing bytes
+    //------------------------------------------------------------------------
+
+    static void Put8( std::vector<BYTE>& buf, BYTE value )
+    {
+        buf.push_back( value );
+    }
+
+    static void Put16( std::vector<BYTE>& buf, WORD value )
+    {
+        buf.push_back( (BYTE) value );
+        buf.push_back( (BYTE) (value >> 8) );
+    }
+
+    static void Put32( std::vector<BYTE>& buf, DWORD value )
+    {
+        Put16( buf, (WORD) value );
+        Put16( buf, (WORD) (value >> 16) );
+    }
+
+    static void Set16( std::vector<BYTE>& buf, size_t pos, WORD value )
+    {
+        buf[pos] = (BYTE) value;
+        buf[pos + 1] = (BYTE) (value >> 8);
+    }
+
+    static void Set32( std::vector<BYTE>& buf, size_t pos, DWORD value )
+    {
+        Set16( buf, pos, (WORD) value );
+        Set16( buf, pos + 2, (WORD) (value >> 16) );
+    }
+
+    static void PutName( std::vector<BYTE>& buf, const char* name )
+    {
+        size_t  len = strlen( name );
+
+        _ASSERT( len <= 255 );
+        Put8( buf, (BYTE) len );
+        buf.insert( buf.end(), name, name + len );
+    }
+
+    static void PadTo4( std::vector<BYTE>& buf )
+    {
+        while ( (buf.size() % 4) != 0 )
+            Put8( buf, 0 );
+    }
+
+    // type records are padded with LF_PAD bytes that count down to the end
+    static void PadLeafTo4( std::vector<BYTE>& buf )
+    {
+        size_t  padLen = (4 - (buf.size() % 4)) % 4;
+
+        for ( ; padLen > 0; padLen-- )
+            Put8( buf, (BYTE) (LF_PAD0 + padLen) );
+    }
+
+    // Symbols and types start with a length that doesn't count itself.
+    static size_t BeginRecord( std::vector<BYTE>& buf, WORD id )
+    {
+        size_t  start = buf.size();
+
+        Put16( buf, 0 );
+        Put16( buf, id );
+        return start;
+    }
+
+    static void EndSymbol( std::vector<BYTE>& buf, size_t start )
+    {
+        PadTo4( buf );
+        Set16( buf, start, (WORD) (buf.size() - start - 2) );
+    }
+
+    static void EndType( std::vector<BYTE>& buf, size_t start )
+    {
+        PadLeafTo4( buf );
+        Set16( buf, start, (WORD) (buf.size() - start - 2) );
+    }
+
+    static uint32_t HashName( const char* name )
+    {
+        return OMFHashTable::GetSymbolNameHash( name, strlen( name ) );
+    }
+
+
+    //------------------------------------------------------------------------
+    //  Names
+    //------------------------------------------------------------------------
+
+    static void MakeProcName( uint32_t compIndex, uint32_t procIndex, char* name, size_t nameSize )
+    {
+        sprintf_s( name, nameSize, "mod%u.func%u", compIndex, procIndex );
+    }
+
+    static void MakeDataName( uint32_t dataIndex, char* name, size_t nameSize )
+    {
+        sprintf_s( name, nameSize, "data.global%u", dataIndex );
+    }
+
+    static void MakeStructName( uint32_t structIndex, char* name, size_t nameSize )
+    {
+        sprintf_s( name, nameSize, "data.Struct%u", structIndex );
+    }
+
+
+    //------------------------------------------------------------------------
+    //  Parameters
+    //------------------------------------------------------------------------
+
+    const char* GetScaleName( SynthScale scale )
+    {
+        switch ( scale )
+        {
+        case SynthScale_Small:  return "small";
+        case SynthScale_Medium: return "medium";
+        case SynthScale_Large:  return "large";
+        }
+
+        return "";
+    }
+
+    bool GetScaleFromName( const char* name, SynthScale& scale )
+    {
+        for ( int i = 0; i < SynthScale_Count; i++ )
+        {
+            if ( strcmp( name, GetScaleName( (SynthScale) i ) ) == 0 )
+            {
+                scale = (SynthScale) i;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void SetScaleParams( SynthScale scale, SynthParams& params )
+    {
+        memset( &params, 0, sizeof params );
+
+        params.LocalsPerProc = 3;
+        params.Seed = 1;
+
+        switch ( scale )
+        {
+        case SynthScale_Small:
+            params.CompilandCount = 20;
+            params.ProcsPerCompiland = 20;
+            params.LinesPerProc = 8;
+            params.FilesPerCompiland = 2;
+            params.PublicCount = 1000;
+            params.StructCount = 200;
+            params.FieldsPerStruct = 8;
+            break;
+
+        case SynthScale_Medium:
+            params.CompilandCount = 200;
+            params.ProcsPerCompiland = 50;
+            params.LinesPerProc = 10;
+            params.FilesPerCompiland = 4;
+            params.PublicCount = 20000;
+            params.StructCount = 2000;
+            params.FieldsPerStruct = 10;
+            break;
+
+        default:
+            params.CompilandCount = 1000;
+            params.ProcsPerCompiland = 100;
+            params.LinesPerProc = 12;
+            params.FilesPerCompiland = 8;
+            params.PublicCount = 100000;
+            params.StructCount = 10000;
+            params.FieldsPerStruct = 12;
+            break;
+        }
+    }
+
+    void ClampParams( SynthParams& params )
+    {
+        // compilands, type indexes, and line numbers are 16 bits
+        params.CompilandCount = std::max<uint32_t>( params.CompilandCount, 1 );
+        params.CompilandCount = std::min<uint32_t>( params.CompilandCount, 0xFFFE );
+        params.ProcsPerCompiland = std::max<uint32_t>( params.ProcsPerCompiland, 1 );
+        params.ProcsPerCompiland = std::min<uint32_t>( params.ProcsPerCompiland, MaxFileLines / 8 );
+        params.LinesPerProc = std::max<uint32_t>( params.LinesPerProc, 1 );
+        params.LinesPerProc = std::min<uint32_t>( params.LinesPerProc, 1000 );
+        params.LocalsPerProc = std::min<uint32_t>( params.LocalsPerProc, 100 );
+        params.StructCount = std::min<uint32_t>( params.StructCount, (0xFFFF - FirstStructType) / TypesPerStruct );
+        // a field list has to fit in a 16-bit record length
+        params.FieldsPerStruct = std::min<uint32_t>( params.FieldsPerStruct, 2000 );
+
+        // each line takes at most 3 line numbers, and each procedure 8 more
+        uint32_t    linesPerProc = (params.LinesPerProc * 3) + 8;
+        uint32_t    procsPerFile = std::max<uint32_t>( MaxFileLines / linesPerProc, 1 );
+        uint32_t    minFiles = (params.ProcsPerCompiland + procsPerFile - 1) / procsPerFile;
+
+        params.FilesPerCompiland = std::max( params.FilesPerCompiland, minFiles );
+        params.FilesPerCompiland = std::min( params.FilesPerCompiland, params.ProcsPerCompiland );
+    }
+
+
+    //------------------------------------------------------------------------
+    //  Layout
+    //------------------------------------------------------------------------
+
+    static void LayOutCode( const SynthParams& params, SynthRandom& random, Layout& layout )
+    {
+        DWORD   offset = 0;
+
+        layout.Compilands.resize( params.CompilandCount );
+        layout.Procs.reserve( params.CompilandCount * params.ProcsPerCompiland );
+        layout.LineOffsets.reserve( params.CompilandCount * params.ProcsPerCompiland * params.LinesPerProc );
+        layout.LineNumbers.reserve( params.CompilandCount * params.ProcsPerCompiland * params.LinesPerProc );
+
+        for ( uint32_t c = 0; c < params.CompilandCount; c++ )
+        {
+            CompilandLayout&    comp = layout.Compilands[c];
+
+            comp.FirstProc = layout.Procs.size();
+            comp.Start = offset;
+            comp.Files.resize( params.FilesPerCompiland );
+
+            for ( uint32_t f = 0; f < params.FilesPerCompiland; f++ )
+            {
+                FileLayout& file = comp.Files[f];
+                uint32_t    procEnd = (f + 1) * params.ProcsPerCompiland / params.FilesPerCompiland;
+                WORD        lineNum = (WORD) (1 + random.Next( 20 ));
+
+                file.FirstProc = layout.Procs.size();
+                file.ProcCount = comp.FirstProc + procEnd - file.FirstProc;
+
+                for ( uint32_t p = 0; p < file.ProcCount; p++ )
+                {
+                    ProcLayout  proc = { 0 };
+
+                    proc.Start = offset;
+                    proc.FirstLine = layout.LineOffsets.size();
+
+                    // a prologue, the lines, and a return
+                    offset += 3;
+                    lineNum = (WORD) (lineNum + 1 + random.Next( 4 ));
+
+                    for ( uint32_t l = 0; l < params.LinesPerProc; l++ )
+                    {
+                        layout.LineOffsets.push_back( offset );
+                        layout.LineNumbers.push_back( lineNum );
+
+                        offset += 2 + random.Next( 15 );
+                        lineNum = (WORD) (lineNum + 1 + random.Next( 3 ));
+                    }
+
+                    offset += 1;
+                    proc.Length = offset - proc.Start;
+                    layout.Procs.push_back( proc );
+
+                    offset = (offset + 15) & ~15;
+                }
+            }
+
+            comp.Length = offset - comp.Start;
+            offset += 16;
+        }
+
+        layout.CodeSize = offset;
+
+        // global data first, then a static for each compiland
+        uint32_t    procCount = layout.Procs.size();
+
+        layout.DataCount = (params.PublicCount > procCount) ? params.PublicCount - procCount : 0;
+        layout.DataSize = layout.DataCount * 8;
+
+        for ( uint32_t c = 0; c < params.CompilandCount; c++ )
+        {
+            layout.Compilands[c].StaticOffset = layout.DataSize;
+            layout.DataSize += 4;
+        }
+    }
+
+
+    //------------------------------------------------------------------------
+    //  Subsections
+    //------------------------------------------------------------------------
+
+    static void WriteModule( uint32_t compIndex, const CompilandLayout& comp, std::vector<BYTE>& cv )
+    {
+        char    name[64] = "";
+
+        Put16( cv, 0 );                 // overlay
+        Put16( cv, 0 );                 // library
+        Put16( cv, 1 );                 // segment count
+        Put8( cv, 'C' );
+        Put8( cv, 'V' );
+
+        Put16( cv, CodeSegment );
+        Put16( cv, 0 );
+        Put32( cv, comp.Start );
+        Put32( cv, comp.Length );
+
+        sprintf_s( name, _countof( name ), "C:\\src\\obj\\mod%u.obj", compIndex );
+        PutName( cv, name );
+        PadTo4( cv );
+    }
+
+    static WORD PickLocalType( const SynthParams& params, SynthRandom& random )
+    {
+        if ( (params.StructCount > 0) && (random.Next( 2 ) == 0) )
+        {
+            uint32_t    structIndex = random.Next( params.StructCount );
+
+            return (WORD) (FirstStructType + (structIndex * TypesPerStruct) + 2);
+        }
+
+        return PrimInt4;
+    }
+
+    static void WriteLocal( std::vector<BYTE>& cv, int32_t frameOffset, WORD type, const char* name )
+    {
+        size_t  start = BeginRecord( cv, S_BPREL32 );
+
+        Put32( cv, (DWORD) frameOffset );
+        Put16( cv, type );
+        PutName( cv, name );
+        EndSymbol( cv, start );
+    }
+
+    // The offsets in the records, and the ones kept in the layout, count
+    // from the start of the subsection.
+    static void WriteAlignSym(
+        const SynthParams& params,
+        uint32_t compIndex,
+        size_t subStart,
+        SynthRandom& random,
+        Layout& layout,
+        std::vector<BYTE>& cv )
+    {
+        const CompilandLayout&  comp = layout.Compilands[compIndex];
+        char    name[64] = "";
+
+        Put32( cv, 1 );                 // signature
+
+        for ( uint32_t p = 0; p < params.ProcsPerCompiland; p++ )
+        {
+            ProcLayout& proc = layout.Procs[comp.FirstProc + p];
+            size_t      procStart = cv.size();
+            DWORD       procOffset = procStart - subStart;
+
+            proc.SymOffset = procOffset;
+
+            size_t  start = BeginRecord( cv, S_GPROC32 );
+
+            Put32( cv, 0 );             // parent
+            Put32( cv, 0 );             // end, set below
+            Put32( cv, 0 );             // next
+            Put32( cv, proc.Length );
+            Put32( cv, 3 );             // debug start
+            Put32( cv, proc.Length - 1 );
+            Put32( cv, proc.Start );
+            Put16( cv, CodeSegment );
+            Put16( cv, ProcType );
+            Put8( cv, 0 );              // flags
+            MakeProcName( compIndex, p, name, _countof( name ) );
+            PutName( cv, name );
+            EndSymbol( cv, start );
+
+            WriteLocal( cv, 8, PrimInt4, "param" );
+
+            for ( uint32_t l = 0; l < params.LocalsPerProc; l++ )
+            {
+                sprintf_s( name, _countof( name ), "local%u", l );
+                WriteLocal( cv, -4 * (int32_t) (l + 1), PickLocalType( params, random ), name );
+            }
+
+            // a block around the middle half of the lines, with its own local
+            if ( params.LinesPerProc >= 4 )
+            {
+                DWORD   blockStart = layout.LineOffsets[proc.FirstLine + params.LinesPerProc / 4];
+                DWORD   blockEnd = layout.LineOffsets[proc.FirstLine + (3 * params.LinesPerProc) / 4];
+                size_t  blockPos = cv.size();
+
+                start = BeginRecord( cv, S_BLOCK32 );
+                Put32( cv, procOffset );    // parent
+                Put32( cv, 0 );             // end, set below
+                Put32( cv, blockEnd - blockStart );
+                Put32( cv, blockStart );
+                Put16( cv, CodeSegment );
+                PutName( cv, "" );
+                EndSymbol( cv, start );
+
+                WriteLocal( cv, -4 * (int32_t) (params.LocalsPerProc + 1), PrimUInt4, "i" );
+
+                Set32( cv, blockPos + 8, cv.size() - subStart );
+                start = BeginRecord( cv, S_END );
+                EndSymbol( cv, start );
+            }
+
+            Set32( cv, procStart + 8, cv.size() - subStart );
+            start = BeginRecord( cv, S_END );
+            EndSymbol( cv, start );
+        }
+    }
+
+    static void WriteSrcModule( uint32_t compIndex, size_t subStart, const Layout& layout, std::vector<BYTE>& cv )
+    {
+        const CompilandLayout&  comp = layout.Compilands[compIndex];
+        WORD        fileCount = (WORD) comp.Files.size();
+        size_t      fileBasePos = 0;
+        char        name[64] = "";
+
+        Put16( cv, fileCount );
+        Put16( cv, 1 );                 // segment count
+        fileBasePos = cv.size();
+        for ( WORD f = 0; f < fileCount; f++ )
+            Put32( cv, 0 );             // set below
+        Put32( cv, comp.Start );
+        Put32( cv, comp.Start + comp.Length - 1 );
+        Put16( cv, CodeSegment );
+        PadTo4( cv );
+
+        for ( WORD f = 0; f < fileCount; f++ )
+        {
+            const FileLayout&   file = comp.Files[f];
+            const ProcLayout&   firstProc = layout.Procs[file.FirstProc];
+            const ProcLayout&   lastProc = layout.Procs[file.FirstProc + file.ProcCount - 1];
+            uint32_t            firstLine = firstProc.FirstLine;
+            uint32_t            lineCount = 0;
+            size_t              lineBasePos = 0;
+
+            // the procedures of a file are back to back, and so are their lines
+            if ( (file.FirstProc + file.ProcCount) < layout.Procs.size() )
+                lineCount = layout.Procs[file.FirstProc + file.ProcCount].FirstLine - firstLine;
+            else
+                lineCount = layout.LineOffsets.size() - firstLine;
+
+            Set32( cv, fileBasePos + (f * 4), cv.size() - subStart );
+
+            Put16( cv, 1 );             // segment count
+            Put16( cv, 0 );
+            lineBasePos = cv.size();
+            Put32( cv, 0 );             // set below
+            Put32( cv, firstProc.Start );
+            Put32( cv, lastProc.Start + lastProc.Length - 1 );
+            sprintf_s( name, _countof( name ), "C:\\src\\pkg%u\\mod%u_%u.d", compIndex % 16, compIndex, f );
+            PutName( cv, name );
+            PadTo4( cv );
+
+            Set32( cv, lineBasePos, cv.size() - subStart );
+
+            Put16( cv, CodeSegment );
+            Put16( cv, (WORD) lineCount );
+            for ( uint32_t l = 0; l < lineCount; l++ )
+                Put32( cv, layout.LineOffsets[firstLine + l] );
+            for ( uint32_t l = 0; l < lineCount; l++ )
+                Put16( cv, layout.LineNumbers[firstLine + l] );
+            PadTo4( cv );
+        }
+    }
+
+    static void WriteHashTables( const std::vector<HashSym>& syms, std::vector<BYTE>& cv, DWORD& nameSize, DWORD& addrSize )
+    {
+        size_t  start = cv.size();
+        WORD    groupCount = (WORD) std::min<size_t>( (syms.size() / 8) + 1, 0x7FFF );
+
+        // name table, grouped by hash
+        std::vector< std::vector<const HashSym*> >  groups( groupCount );
+
+        for ( size_t i = 0; i < syms.size(); i++ )
+            groups[syms[i].Hash % groupCount].push_back( &syms[i] );
+
+        Put16( cv, groupCount );
+        Put16( cv, 0 );
+
+        DWORD   pairOffset = 0;
+
+        for ( WORD g = 0; g < groupCount; g++ )
+        {
+            Put32( cv, pairOffset );
+            pairOffset += groups[g].size() * 8;
+        }
+        for ( WORD g = 0; g < groupCount; g++ )
+            Put32( cv, groups[g].size() );
+        for ( WORD g = 0; g < groupCount; g++ )
+        {
+            for ( size_t i = 0; i < groups[g].size(); i++ )
+            {
+                Put32( cv, groups[g][i]->SymOffset );
+                Put32( cv, groups[g][i]->Hash );
+            }
+        }
+
+        nameSize = cv.size() - start;
+        start = cv.size();
+
+        // address table, a group for each segment, sorted by offset
+        std::vector< std::vector< std::pair<DWORD, DWORD> > >   segs( SegmentCount );
+
+        for ( size_t i = 0; i < syms.size(); i++ )
+        {
+            if ( (syms[i].Segment >= 1) && (syms[i].Segment <= SegmentCount) )
+                segs[syms[i].Segment - 1].push_back( std::make_pair( syms[i].Offset, syms[i].SymOffset ) );
+        }
+
+        Put16( cv, SegmentCount );
+        Put16( cv, 0 );
+
+        pairOffset = 0;
+        for ( WORD s = 0; s < SegmentCount; s++ )
+        {
+            std::sort( segs[s].begin(), segs[s].end() );
+            Put32( cv, pairOffset );
+            pairOffset += segs[s].size() * 8;
+        }
+        for ( WORD s = 0; s < SegmentCount; s++ )
+            Put32( cv, segs[s].size() );
+        for ( WORD s = 0; s < SegmentCount; s++ )
+        {
+            for ( size_t i = 0; i < segs[s].size(); i++ )
+            {
+                Put32( cv, segs[s][i].second );
+                Put32( cv, segs[s][i].first );
+            }
+        }
+
+        addrSize = cv.size() - start;
+    }
+
+    // The symbols go after the OMFSymHash header, and the offsets in the
+    // tables count from there.
+    static void WriteSymHash( const std::vector<BYTE>& heap, const std::vector<HashSym>& syms, std::vector<BYTE>& cv )
+    {
+        size_t  headerPos = cv.size();
+        DWORD   nameSize = 0;
+        DWORD   addrSize = 0;
+
+        Put16( cv, 0xA );               // symbol hash: names
+        Put16( cv, 0xC );               // address hash: sorted by segment and offset
+        Put32( cv, heap.size() );
+        Put32( cv, 0 );                 // set below
+        Put32( cv, 0 );
+
+        cv.insert( cv.end(), heap.begin(), heap.end() );
+
+        WriteHashTables( syms, cv, nameSize, addrSize );
+
+        Set32( cv, headerPos + 8, nameSize );
+        Set32( cv, headerPos + 12, addrSize );
+    }
+
+    static void AddDataSym(
+        std::vector<BYTE>& heap,
+        std::vector<HashSym>& syms,
+        WORD id,
+        DWORD offset,
+        WORD segment,
+        WORD type,
+        const char* name )
+    {
+        HashSym hashSym = { heap.size(), HashName( name ), segment, offset };
+        size_t  start = BeginRecord( heap, id );
+
+        Put32( heap, offset );
+        Put16( heap, segment );
+        Put16( heap, type );
+        PutName( heap, name );
+        EndSymbol( heap, start );
+
+        syms.push_back( hashSym );
+    }
+
+    static void WriteGlobalSym( const SynthParams& params, const Layout& layout, std::vector<BYTE>& cv )
+    {
+        std::vector<BYTE>       heap;
+        std::vector<HashSym>    syms;
+        char                    name[64] = "";
+
+        for ( uint32_t c = 0; c < params.CompilandCount; c++ )
+        {
+            const CompilandLayout&  comp = layout.Compilands[c];
+
+            for ( uint32_t p = 0; p < params.ProcsPerCompiland; p++ )
+            {
+                const ProcLayout&   proc = layout.Procs[comp.FirstProc + p];
+
+                MakeProcName( c, p, name, _countof( name ) );
+
+                HashSym hashSym = { heap.size(), HashName( name ), CodeSegment, proc.Start };
+                size_t  start = BeginRecord( heap, S_PROCREF );
+
+                // the store checks this against the hash before following
+                Put32( heap, hashSym.Hash );
+                Put32( heap, proc.SymOffset );
+                Put16( heap, (WORD) (c + 1) );
+                EndSymbol( heap, start );
+
+                syms.push_back( hashSym );
+            }
+        }
+
+        for ( uint32_t i = 0; i < layout.DataCount; i++ )
+        {
+            MakeDataName( i, name, _countof( name ) );
+            AddDataSym( heap, syms, S_GDATA32, i * 8, DataSegment, PrimReal64, name );
+        }
+
+        for ( uint32_t i = 0; i < params.StructCount; i++ )
+        {
+            MakeStructName( i, name, _countof( name ) );
+
+            HashSym hashSym = { heap.size(), HashName( name ), 0, 0 };
+            size_t  start = BeginRecord( heap, S_UDT );
+
+            Put16( heap, (WORD) (FirstStructType + (i * TypesPerStruct) + 1) );
+            PutName( heap, name );
+            EndSymbol( heap, start );
+
+            syms.push_back( hashSym );
+        }
+
+        WriteSymHash( heap, syms, cv );
+    }
+
+    static void WriteStaticSym( const SynthParams& params, const Layout& layout, std::vector<BYTE>& cv )
+    {
+        std::vector<BYTE>       heap;
+        std::vector<HashSym>    syms;
+        char                    name[64] = "";
+
+        for ( uint32_t c = 0; c < params.CompilandCount; c++ )
+        {
+            sprintf_s( name, _countof( name ), "mod%u.count", c );
+            AddDataSym( heap, syms, S_LDATA32, layout.Compilands[c].StaticOffset, DataSegment, PrimUInt4, name );
+        }
+
+        WriteSymHash( heap, syms, cv );
+    }
+
+    static void WriteGlobalPub( const SynthParams& params, const Layout& layout, std::vector<BYTE>& cv )
+    {
+        std::vector<BYTE>       heap;
+        std::vector<HashSym>    syms;
+        char                    name[64] = "";
+
+        for ( uint32_t c = 0; c < params.CompilandCount; c++ )
+        {
+            const CompilandLayout&  comp = layout.Compilands[c];
+
+            for ( uint32_t p = 0; p < params.ProcsPerCompiland; p++ )
+            {
+                MakeProcName( c, p, name, _countof( name ) );
+                AddDataSym( heap, syms, S_PUB32, layout.Procs[comp.FirstProc + p].Start, CodeSegment, 0, name );
+            }
+        }
+
+        for ( uint32_t i = 0; i < layout.DataCount; i++ )
+        {
+            MakeDataName( i, name, _countof( name ) );
+            AddDataSym( heap, syms, S_PUB32, i * 8, DataSegment, 0, name );
+        }
+
+        WriteSymHash( heap, syms, cv );
+    }
+
+    static void WriteGlobalTypes( const SynthParams& params, SynthRandom& random, std::vector<BYTE>& cv, uint32_t& typeCount )
+    {
+        std::vector<BYTE>       types;
+        std::vector<DWORD>      offsets;
+        char                    name[64] = "";
+        size_t                  start = 0;
+
+        offsets.push_back( types.size() );
+        start = BeginRecord( types, LF_ARGLIST );
+        Put16( types, 1 );
+        Put16( types, PrimInt4 );
+        EndType( types, start );
+
+        offsets.push_back( types.size() );
+        start = BeginRecord( types, LF_PROCEDURE );
+        Put16( types, PrimInt4 );
+        Put8( types, 0 );               // near C
+        Put8( types, 0 );
+        Put16( types, 1 );
+        Put16( types, ArgListType );
+        EndType( types, start );
+
+        for ( uint32_t s = 0; s < params.StructCount; s++ )
+        {
+            WORD    fieldListType = (WORD) (FirstStructType + (s * TypesPerStruct));
+            WORD    fieldOffset = 0;
+
+            offsets.push_back( types.size() );
+            start = BeginRecord( types, LF_FIELDLIST );
+
+            for ( uint32_t f = 0; f < params.FieldsPerStruct; f++ )
+            {
+                WORD    fieldType = PrimInt4;
+                WORD    fieldSize = 4;
+
+                switch ( random.Next( 4 ) )
+                {
+                case 0: fieldType = PrimReal64; fieldSize = 8; break;
+                case 1: fieldType = PrimUChar; fieldSize = 1; break;
+                case 2:
+                    // a pointer to a structure declared before this one
+                    if ( s > 0 )
+                        fieldType = (WORD) (FirstStructType + (random.Next( s ) * TypesPerStruct) + 2);
+                    break;
+                }
+
+                Put16( types, LF_MEMBER );
+                Put16( types, fieldType );
+                Put16( types, MemberAttr );
+                Put16( types, fieldOffset );
+                sprintf_s( name, _countof( name ), "field%u", f );
+                PutName( types, name );
+                PadLeafTo4( types );
+
+                fieldOffset = (WORD) ((fieldOffset + fieldSize + 3) & ~3);
+            }
+
+            EndType( types, start );
+
+            offsets.push_back( types.size() );
+            start = BeginRecord( types, LF_STRUCTURE );
+            Put16( types, (WORD) params.FieldsPerStruct );
+            Put16( types, fieldListType );
+            Put16( types, 0 );          // properties
+            Put16( types, 0 );          // derived
+            Put16( types, 0 );          // vshape
+            Put16( types, fieldOffset );
+            MakeStructName( s, name, _countof( name ) );
+            PutName( types, name );
+            EndType( types, start );
+
+            offsets.push_back( types.size() );
+            start = BeginRecord( types, LF_POINTER );
+            Put16( types, PtrNear32 );
+            Put16( types, (WORD) (fieldListType + 1) );
+            EndType( types, start );
+        }
+
+        Put32( cv, 0 );                 // flags
+        Put32( cv, offsets.size() );
+        for ( size_t i = 0; i < offsets.size(); i++ )
+            Put32( cv, offsets[i] );
+        cv.insert( cv.end(), types.begin(), types.end() );
+
+        typeCount = offsets.size();
+    }
+
+
+    //------------------------------------------------------------------------
+    //  Putting it together
+    //------------------------------------------------------------------------
+
+    static size_t BeginSubsection( std::vector<BYTE>& cv, std::vector<DirEntry>& dirs, WORD subSection, WORD mod )
+    {
+        DirEntry    entry = { subSection, mod, cv.size(), 0 };
+
+        dirs.push_back( entry );
+        return cv.size();
+    }
+
+    static void EndSubsection( std::vector<BYTE>& cv, std::vector<DirEntry>& dirs )
+    {
+        dirs.back().Size = cv.size() - dirs.back().Offset;
+        PadTo4( cv );
+    }
+
+    void BuildCodeView( const SynthParams& origParams, std::vector<BYTE>& cv, SynthStats& stats )
+    {
+        SynthParams             params = origParams;
+        SynthRandom             random( params.Seed );
+        Layout                  layout;
+        std::vector<DirEntry>   dirs;
+        size_t                  subStart = 0;
+        uint32_t                typeCount = 0;
+
+        ClampParams( params );
+        LayOutCode( params, random, layout );
+
+        cv.clear();
+        cv.push_back( 'N' );
+        cv.push_back( 'B' );
+        cv.push_back( '0' );
+        cv.push_back( '9' );
+        Put32( cv, 0 );                 // directory offset, set below
+
+        for ( uint32_t c = 0; c < params.CompilandCount; c++ )
+        {
+            BeginSubsection( cv, dirs, sstModule, (WORD) (c + 1) );
+            WriteModule( c, layout.Compilands[c], cv );
+            EndSubsection( cv, dirs );
+        }
+
+        for ( uint32_t c = 0; c < params.CompilandCount; c++ )
+        {
+            subStart = BeginSubsection( cv, dirs, sstAlignSym, (WORD) (c + 1) );
+            WriteAlignSym( params, c, subStart, random, layout, cv );
+            EndSubsection( cv, dirs );
+
+            subStart = BeginSubsection( cv, dirs, sstSrcModule, (WORD) (c + 1) );
+            WriteSrcModule( c, subStart, layout, cv );
+            EndSubsection( cv, dirs );
+        }
+
+        BeginSubsection( cv, dirs, sstGlobalSym, 0xFFFF );
+        WriteGlobalSym( params, layout, cv );
+        EndSubsection( cv, dirs );
+
+        BeginSubsection( cv, dirs, sstStaticSym, 0xFFFF );
+        WriteStaticSym( params, layout, cv );
+        EndSubsection( cv, dirs );
+
+        BeginSubsection( cv, dirs, sstGlobalPub, 0xFFFF );
+        WriteGlobalPub( params, layout, cv );
+        EndSubsection( cv, dirs );
+
+        BeginSubsection( cv, dirs, sstGlobalTypes, 0xFFFF );
+        WriteGlobalTypes( params, random, cv, typeCount );
+        EndSubsection( cv, dirs );
+
+        Set32( cv, 4, cv.size() );
+
+        Put16( cv, sizeof( OMFDirHeader ) );
+        Put16( cv, sizeof( OMFDirEntry ) );
+        Put32( cv, dirs.size() );
+        Put32( cv, 0 );                 // next directory
+        Put32( cv, 0 );                 // flags
+
+        for ( size_t i = 0; i < dirs.size(); i++ )
+        {
+            Put16( cv, dirs[i].SubSection );
+            Put16( cv, dirs[i].Mod );
+            Put32( cv, dirs[i].Offset );
+            Put32( cv, dirs[i].Size );
+        }
+
+        stats.CodeSize = layout.CodeSize;
+        stats.DataSize = layout.DataSize;
+        stats.ProcCount = layout.Procs.size();
+        stats.LineCount = layout.LineOffsets.size();
+        stats.PublicCount = layout.Procs.size() + layout.DataCount;
+        stats.TypeCount = typeCount;
+        stats.CVSize = cv.size();
+    }
+
+
+    //------------------------------------------------------------------------
+    //  Image
+    //------------------------------------------------------------------------
+
+    static DWORD AlignUp( DWORD value, DWORD align )
+    {
+        return (value + align - 1) & ~(align - 1);
+    }
+
+    static void SetSectionName( IMAGE_SECTION_HEADER& section, const char* name )
+    {
+        // the name isn't terminated if it fills the field
+        memcpy( section.Name, name, std::min( strlen( name ), sizeof section.Name ) );
+    }
+
+    // The index cache tells images apart by time stamp and size, so the
+    // stamp comes from the debug info.
+    static DWORD HashBytes( const std::vector<BYTE>& bytes )
+    {
+        return HashFnv1a( bytes.empty() ? NULL : &bytes[0], bytes.size() );
+    }
+
+    HRESULT WriteImage( const wchar_t* filename, const std::vector<BYTE>& cv, const SynthStats& stats )
+    {
+        const WORD              SectionCount = 3;
+        const DWORD             HeadersSize = FileAlign;
+        const DWORD             DebugDirFilePos = HeadersSize;
+        const DWORD             CVFilePos = DebugDirFilePos + FileAlign;
+
+        std::vector<BYTE>       headers( HeadersSize + FileAlign );
+        IMAGE_DOS_HEADER*       dosHeader = (IMAGE_DOS_HEADER*) &headers[0];
+        IMAGE_NT_HEADERS32*     ntHeaders = (IMAGE_NT_HEADERS32*) (dosHeader + 1);
+        IMAGE_SECTION_HEADER*   sections = (IMAGE_SECTION_HEADER*) (ntHeaders + 1);
+        IMAGE_DEBUG_DIRECTORY*  debugDir = (IMAGE_DEBUG_DIRECTORY*) &headers[DebugDirFilePos];
+
+        dosHeader->e_magic = IMAGE_DOS_SIGNATURE;
+        dosHeader->e_lfanew = sizeof( IMAGE_DOS_HEADER );
+
+        DWORD   rva = SectionAlign;
+
+        SetSectionName( sections[0], ".text" );
+        sections[0].VirtualAddress = rva;
+        sections[0].Misc.VirtualSize = std::max<DWORD>( stats.CodeSize, 1 );
+        sections[0].Characteristics = IMAGE_SCN_CNT_CODE | IMAGE_SCN_MEM_EXECUTE | IMAGE_SCN_MEM_READ;
+        rva += AlignUp( sections[0].Misc.VirtualSize, SectionAlign );
+
+        SetSectionName( sections[1], ".data" );
+        sections[1].VirtualAddress = rva;
+        sections[1].Misc.VirtualSize = std::max<DWORD>( stats.DataSize, 1 );
+        sections[1].Characteristics = IMAGE_SCN_CNT_UNINITIALIZED_DATA | IMAGE_SCN_MEM_READ | IMAGE_SCN_MEM_WRITE;
+        rva += AlignUp( sections[1].Misc.VirtualSize, SectionAlign );
+
+        SetSectionName( sections[2], ".rdata" );
+        sections[2].VirtualAddress = rva;
+        sections[2].Misc.VirtualSize = sizeof( IMAGE_DEBUG_DIRECTORY );
+        sections[2].SizeOfRawData = FileAlign;
+        sections[2].PointerToRawData = DebugDirFilePos;
+        sections[2].Characteristics = IMAGE_SCN_CNT_INITIALIZED_DATA | IMAGE_SCN_MEM_READ;
+        rva += SectionAlign;
+
+        ntHeaders->Signature = IMAGE_NT_SIGNATURE;
+        ntHeaders->FileHeader.Machine = IMAGE_FILE_MACHINE_I386;
+        ntHeaders->FileHeader.NumberOfSections = SectionCount;
+        ntHeaders->FileHeader.TimeDateStamp = HashBytes( cv );
+        ntHeaders->FileHeader.SizeOfOptionalHeader = sizeof( IMAGE_OPTIONAL_HEADER32 );
+        ntHeaders->FileHeader.Characteristics = IMAGE_FILE_EXECUTABLE_IMAGE | IMAGE_FILE_32BIT_MACHINE;
+
+        IMAGE_OPTIONAL_HEADER32&    optHeader = ntHeaders->OptionalHeader;
+
+        optHeader.Magic = IMAGE_NT_OPTIONAL_HDR32_MAGIC;
+        optHeader.SizeOfCode = sections[0].Misc.VirtualSize;
+        optHeader.SizeOfUninitializedData = sections[1].Misc.VirtualSize;
+        optHeader.AddressOfEntryPoint = sections[0].VirtualAddress;
+        optHeader.BaseOfCode = sections[0].VirtualAddress;
+        optHeader.BaseOfData = sections[1].VirtualAddress;
+        optHeader.ImageBase = ImageBase;
+        optHeader.SectionAlignment = SectionAlign;
+        optHeader.FileAlignment = FileAlign;
+        optHeader.MajorOperatingSystemVersion = 4;
+        optHeader.MajorSubsystemVersion = 4;
+        optHeader.SizeOfImage = rva;
+        optHeader.SizeOfHeaders = HeadersSize;
+        optHeader.Subsystem = IMAGE_SUBSYSTEM_WINDOWS_CUI;
+        optHeader.NumberOfRvaAndSizes = IMAGE_NUMBEROF_DIRECTORY_ENTRIES;
+        optHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_DEBUG].VirtualAddress = sections[2].VirtualAddress;
+        optHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_DEBUG].Size = sizeof( IMAGE_DEBUG_DIRECTORY );
+
+        debugDir->Type = IMAGE_DEBUG_TYPE_CODEVIEW;
+        debugDir->SizeOfData = cv.size();
+        debugDir->PointerToRawData = CVFilePos;
+
+        HANDLE  hFile = CreateFile( filename, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
+        DWORD   written = 0;
+        HRESULT hr = S_OK;
+
+        if ( hFile == INVALID_HANDLE_VALUE )
+            return GetLastHr();
+
+        if ( !WriteFile( hFile, &headers[0], headers.size(), &written, NULL )
+            || !WriteFile( hFile, &cv[0], cv.size(), &written, NULL ) )
+            hr = GetLastHr();
+
+        CloseHandle( hFile );
+
+        if ( FAILED( hr ) )
+            DeleteFile( filename );
+
+        return hr;
+    }
+}
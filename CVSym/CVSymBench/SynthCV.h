@@ -0,0 +1,94 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+
+namespace CVSymBench
+{
+    // Xorshift, so that fixtures and queries don't depend on the C runtime's
+    // rand.
+    class SynthRandom
+    {
+        uint32_t    mState;
+
+    public:
+        SynthRandom( uint32_t seed )
+            :   mState( (seed == 0) ? 0x9E3779B9 : seed )
+        {
+        }
+
+        uint32_t Next()
+        {
+            mState ^= mState << 13;
+            mState ^= mState >> 17;
+            mState ^= mState << 5;
+            return mState;
+        }
+
+        uint32_t Next( uint32_t limit )
+        {
+            return Next() % limit;
+        }
+    };
+
+
+    enum SynthScale
+    {
+        SynthScale_Small,
+        SynthScale_Medium,
+        SynthScale_Large,
+        SynthScale_Count
+    };
+
+    // The shape of the CodeView 4 (NB09) debug info that BuildCodeView lays
+    // out. Each compiland has its procedures back to back in the code
+    // segment, split evenly among its source files. Every procedure gets a
+    // public and a global reference. Publics past the procedure count are
+    // global data in the data segment.
+    //
+    // Everything is drawn from Seed, so the same parameters always give the
+    // same bytes.
+
+    struct SynthParams
+    {
+        uint32_t    CompilandCount;
+        uint32_t    ProcsPerCompiland;
+        uint32_t    LinesPerProc;
+        uint32_t    FilesPerCompiland;
+        uint32_t    LocalsPerProc;
+        uint32_t    PublicCount;
+        uint32_t    StructCount;
+        uint32_t    FieldsPerStruct;
+        uint32_t    Seed;
+    };
+
+    struct SynthStats
+    {
+        uint32_t    CodeSize;
+        uint32_t    DataSize;
+        uint32_t    ProcCount;
+        uint32_t    LineCount;
+        uint32_t    PublicCount;
+        uint32_t    TypeCount;
+        uint32_t    CVSize;
+    };
+
+    const char* GetScaleName( SynthScale scale );
+    bool GetScaleFromName( const char* name, SynthScale& scale );
+    void SetScaleParams( SynthScale scale, SynthParams& params );
+
+    // Clamps the parameters to what the 16-bit fields of the format can hold.
+    void ClampParams( SynthParams& params );
+
+    void BuildCodeView( const SynthParams& params, std::vector<BYTE>& cv, SynthStats& stats );
+
+    // Writes a 32-bit PE image with a code and a data section of the sizes
+    // in stats, and a CodeView debug directory entry for the debug info.
+    // The sections have no raw data, only the debug info is in the file.
+    HRESULT WriteImage( const wchar_t* filename, const std::vector<BYTE>& cv, const SynthStats& stats );
+}
@@ -0,0 +1,366 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#include "Common.h"
+#include "C13SymbolStoreSuite.h"
+
+using namespace std;
+using namespace MagoST;
+
+
+const char      RecordsFixture[] = "records.pdb";
+
+
+static bool IsNames( const std::vector<std::string>& names, const char* const* expected, size_t expectedCount )
+{
+    if ( names.size() != expectedCount )
+        return false;
+
+    for ( size_t i = 0; i < expectedCount; i++ )
+    {
+        if ( names[i] != expected[i] )
+            return false;
+    }
+
+    return true;
+}
+
+
+C13SymbolStoreSuite::C13SymbolStoreSuite()
+:   mReader( NULL ),
+    mStore( NULL )
+{
+    TEST_ADD( C13SymbolStoreSuite::TestInit );
+    TEST_ADD( C13SymbolStoreSuite::TestModuleScope );
+    TEST_ADD( C13SymbolStoreSuite::TestProcScope );
+    TEST_ADD( C13SymbolStoreSuite::TestBlockScope );
+    TEST_ADD( C13SymbolStoreSuite::TestInlineSiteScope );
+    TEST_ADD( C13SymbolStoreSuite::TestLocalLocations );
+    TEST_ADD( C13SymbolStoreSuite::TestFindSymbol );
+    TEST_ADD( C13SymbolStoreSuite::TestBadModule );
+}
+
+void C13SymbolStoreSuite::setup()
+{
+    mReader = NULL;
+    mStore = NULL;
+
+    if ( !LoadFixture( RecordsFixture, mPdb ) )
+        return;
+
+    mReader = new PDBReader();
+
+    if ( mReader->Init( &mPdb[0], (uint32_t) mPdb.size() ) != S_OK )
+        return;
+
+    mStore = new C13SymbolStore();
+
+    if ( mStore->Init( *mReader ) != S_OK )
+    {
+        delete mStore;
+        mStore = NULL;
+    }
+}
+
+void C13SymbolStoreSuite::tear_down()
+{
+    if ( mStore != NULL )
+    {
+        delete mStore;
+        mStore = NULL;
+    }
+
+    if ( mReader != NULL )
+    {
+        delete mReader;
+        mReader = NULL;
+    }
+
+    mPdb.clear();
+}
+
+// The names of the symbols in a scope that the store can read. Nested
+// scopes are stepped over, and the records that end them are counted with
+// the ones that can't be read.
+
+void C13SymbolStoreSuite::GetChildNames( SymbolScope& scope, std::vector<std::string>& names, int& unreadCount )
+{
+    SymHandle   handle = { 0 };
+
+    names.clear();
+    unreadCount = 0;
+
+    while ( mStore->NextSymbol( scope, handle ) )
+    {
+        SymInfoData     infoData = { 0 };
+        ISymbolInfo*    symInfo = NULL;
+        SymString       name;
+
+        if ( (mStore->GetSymbolInfo( handle, infoData, symInfo ) != S_OK) || !symInfo->GetName( name ) )
+        {
+            unreadCount++;
+            continue;
+        }
+
+        names.push_back( std::string( name.GetName(), name.GetLength() ) );
+    }
+}
+
+bool C13SymbolStoreSuite::FindChild( SymHandle parent, const char* name, SymHandle& child )
+{
+    SymbolScope scope = { 0 };
+    size_t      nameLen = strlen( name );
+
+    if ( mStore->SetChildSymbolScope( parent, scope ) != S_OK )
+        return false;
+
+    while ( mStore->NextSymbol( scope, child ) )
+    {
+        SymInfoData     infoData = { 0 };
+        ISymbolInfo*    symInfo = NULL;
+        SymString       childName;
+
+        if ( (mStore->GetSymbolInfo( child, infoData, symInfo ) == S_OK) 
+            && symInfo->GetName( childName )
+            && (childName.GetLength() == nameLen)
+            && (memcmp( childName.GetName(), name, nameLen ) == 0) )
+            return true;
+    }
+
+    return false;
+}
+
+// where a child local is; reg and offset are 0 if the location doesn't have them
+bool C13SymbolStoreSuite::GetChildLocation( 
+    SymHandle parent, 
+    const char* name, 
+    LocationType& loc, 
+    uint32_t& reg, 
+    int32_t& offset )
+{
+    SymHandle       child = { 0 };
+    SymInfoData     infoData = { 0 };
+    ISymbolInfo*    symInfo = NULL;
+
+    if ( !FindChild( parent, name, child ) )
+        return false;
+    if ( mStore->GetSymbolInfo( child, infoData, symInfo ) != S_OK )
+        return false;
+    if ( !symInfo->GetLocation( loc ) )
+        return false;
+
+    if ( !symInfo->GetRegister( reg ) )
+        reg = 0;
+    if ( !symInfo->GetOffset( offset ) )
+        offset = 0;
+
+    return true;
+}
+
+// the first child that the store doesn't read, but that has a scope
+bool C13SymbolStoreSuite::FindChildScope( SymHandle parent, SymHandle& child )
+{
+    SymbolScope scope = { 0 };
+    SymbolScope childScope = { 0 };
+
+    if ( mStore->SetChildSymbolScope( parent, scope ) != S_OK )
+        return false;
+
+    while ( mStore->NextSymbol( scope, child ) )
+    {
+        SymInfoData     infoData = { 0 };
+        ISymbolInfo*    symInfo = NULL;
+
+        if ( mStore->GetSymbolInfo( child, infoData, symInfo ) == S_OK )
+            continue;
+
+        if ( mStore->SetChildSymbolScope( child, childScope ) == S_OK )
+            return true;
+    }
+
+    return false;
+}
+
+void C13SymbolStoreSuite::TestInit()
+{
+    TEST_ASSERT_RETURN( mReader != NULL );
+
+    // records that the store doesn't know don't keep it from reading the
+    // rest of the PDB
+    TEST_ASSERT( mStore != NULL );
+}
+
+void C13SymbolStoreSuite::TestModuleScope()
+{
+    TEST_ASSERT_RETURN( mStore != NULL );
+
+    static const char* const    Expected[] = { "main", "counter", "helper" };
+
+    SymbolScope                 scope = { 0 };
+    std::vector<std::string>    names;
+    int                         unreadCount = 0;
+
+    TEST_ASSERT_RETURN( mStore->SetCompilandSymbolScope( 1, scope ) == S_OK );
+
+    GetChildNames( scope, names, unreadCount );
+
+    TEST_ASSERT( IsNames( names, Expected, sizeof Expected / sizeof Expected[0] ) );
+
+    // S_OBJNAME, S_FILESTATIC, and the S_ENDs of the procedures
+    TEST_ASSERT( unreadCount == 4 );
+}
+
+void C13SymbolStoreSuite::TestProcScope()
+{
+    TEST_ASSERT_RETURN( mStore != NULL );
+
+    static const char* const    Expected[] = { "argc", "a", "r", "gone", "", "last" };
+
+    SymHandle                   proc = { 0 };
+    SymbolScope                 scope = { 0 };
+    std::vector<std::string>    names;
+    int                         unreadCount = 0;
+
+    TEST_ASSERT_RETURN( mStore->FindSymbol( SymHeap_GlobalSymbols, 1, 16, proc ) == S_OK );
+    TEST_ASSERT_RETURN( mStore->SetChildSymbolScope( proc, scope ) == S_OK );
+
+    GetChildNames( scope, names, unreadCount );
+
+    // the locals of the block and the inline site aren't the function's
+    TEST_ASSERT( IsNames( names, Expected, sizeof Expected / sizeof Expected[0] ) );
+
+    // S_FRAMEPROC, the S_DEFRANGEs of a and r, the block's S_END,
+    // S_INLINESITE, and S_INLINESITE_END
+    TEST_ASSERT( unreadCount == 8 );
+}
+
+void C13SymbolStoreSuite::TestBlockScope()
+{
+    TEST_ASSERT_RETURN( mStore != NULL );
+
+    static const char* const    Expected[] = { "x", "y" };
+
+    SymHandle                   proc = { 0 };
+    SymHandle                   block = { 0 };
+    SymbolScope                 scope = { 0 };
+    std::vector<std::string>    names;
+    int                         unreadCount = 0;
+
+    TEST_ASSERT_RETURN( mStore->FindSymbol( SymHeap_GlobalSymbols, 1, 16, proc ) == S_OK );
+    TEST_ASSERT_RETURN( FindChild( proc, "", block ) );
+    TEST_ASSERT_RETURN( mStore->SetChildSymbolScope( block, scope ) == S_OK );
+
+    GetChildNames( scope, names, unreadCount );
+
+    TEST_ASSERT( IsNames( names, Expected, sizeof Expected / sizeof Expected[0] ) );
+
+    // S_DEFRANGE_REGISTER_REL
+    TEST_ASSERT( unreadCount == 1 );
+}
+
+void C13SymbolStoreSuite::TestInlineSiteScope()
+{
+    TEST_ASSERT_RETURN( mStore != NULL );
+
+    static const char* const    Expected[] = { "n", "inlined" };
+
+    SymHandle                   proc = { 0 };
+    SymHandle                   site = { 0 };
+    SymbolScope                 scope = { 0 };
+    std::vector<std::string>    names;
+    int                         unreadCount = 0;
+
+    TEST_ASSERT_RETURN( mStore->FindSymbol( SymHeap_GlobalSymbols, 1, 16, proc ) == S_OK );
+    TEST_ASSERT_RETURN( FindChildScope( proc, site ) );
+    TEST_ASSERT_RETURN( mStore->SetChildSymbolScope( site, scope ) == S_OK );
+
+    GetChildNames( scope, names, unreadCount );
+
+    TEST_ASSERT( IsNames( names, Expected, sizeof Expected / sizeof Expected[0] ) );
+
+    // S_DEFRANGE_FRAMEPOINTER_REL_FULL_SCOPE
+    TEST_ASSERT( unreadCount == 1 );
+}
+
+void C13SymbolStoreSuite::TestLocalLocations()
+{
+    TEST_ASSERT_RETURN( mStore != NULL );
+
+    SymHandle       proc = { 0 };
+    SymHandle       block = { 0 };
+    SymHandle       site = { 0 };
+    SymHandle       local = { 0 };
+    SymInfoData     infoData = { 0 };
+    ISymbolInfo*    symInfo = NULL;
+    DataKind        dataKind = DataIsUnknown;
+    TypeIndex       type = 0;
+    LocationType    loc = LocIsNull;
+    uint32_t        reg = 0;
+    int32_t         offset = 0;
+
+    TEST_ASSERT_RETURN( mStore->FindSymbol( SymHeap_GlobalSymbols, 1, 16, proc ) == S_OK );
+    TEST_ASSERT_RETURN( FindChild( proc, "", block ) );
+    TEST_ASSERT_RETURN( FindChildScope( proc, site ) );
+
+    // the first range, relative to the frame pointer that S_FRAMEPROC
+    // names for locals
+    TEST_ASSERT( GetChildLocation( proc, "a", loc, reg, offset ) );
+    TEST_ASSERT( (loc == LocIsRegRel) && (reg == CV_AMD64_R13) && (offset == -8) );
+
+    // the range for a piece of the local is stepped over
+    TEST_ASSERT( GetChildLocation( proc, "r", loc, reg, offset ) );
+    TEST_ASSERT( (loc == LocIsEnregistered) && (reg == CV_AMD64_RBX) );
+
+    TEST_ASSERT( GetChildLocation( proc, "gone", loc, reg, offset ) );
+    TEST_ASSERT( loc == LocIsNull );
+
+    TEST_ASSERT( GetChildLocation( block, "y", loc, reg, offset ) );
+    TEST_ASSERT( (loc == LocIsRegRel) && (reg == CV_AMD64_RSP) && (offset == 20) );
+
+    // S_FRAMEPROC doesn't name one for parameters
+    TEST_ASSERT( GetChildLocation( site, "n", loc, reg, offset ) );
+    TEST_ASSERT( (loc == LocIsRegRel) && (reg == CV_AMD64_RBP) && (offset == 16) );
+
+    TEST_ASSERT_RETURN( FindChild( site, "n", local ) );
+    TEST_ASSERT_RETURN( mStore->GetSymbolInfo( local, infoData, symInfo ) == S_OK );
+    TEST_ASSERT( symInfo->GetDataKind( dataKind ) && (dataKind == DataIsParam) );
+    TEST_ASSERT( symInfo->GetType( type ) && (type == 0x74) );
+}
+
+void C13SymbolStoreSuite::TestFindSymbol()
+{
+    TEST_ASSERT_RETURN( mStore != NULL );
+
+    SymHandle       handle = { 0 };
+    SymInfoData     infoData = { 0 };
+    ISymbolInfo*    symInfo = NULL;
+    SymString       name;
+
+    // inside the inline site
+    TEST_ASSERT_RETURN( mStore->FindSymbol( SymHeap_GlobalSymbols, 1, 0x40, handle ) == S_OK );
+    TEST_ASSERT_RETURN( mStore->GetSymbolInfo( handle, infoData, symInfo ) == S_OK );
+    TEST_ASSERT( symInfo->GetName( name ) && (name.GetLength() == 4) && (memcmp( name.GetName(), "main", 4 ) == 0) );
+
+    TEST_ASSERT_RETURN( mStore->FindSymbol( SymHeap_StaticSymbols, 1, 100, handle ) == S_OK );
+    TEST_ASSERT_RETURN( mStore->GetSymbolInfo( handle, infoData, symInfo ) == S_OK );
+    TEST_ASSERT( symInfo->GetName( name ) && (name.GetLength() == 6) && (memcmp( name.GetName(), "helper", 6 ) == 0) );
+
+    TEST_ASSERT( mStore->FindSymbol( SymHeap_StaticSymbols, 1, 8, handle ) != S_OK );
+}
+
+void C13SymbolStoreSuite::TestBadModule()
+{
+    TEST_ASSERT_RETURN( mStore != NULL );
+
+    SymHandle   handle = { 0 };
+    SymbolScope scope = { 0 };
+
+    // the module acts like one without symbols, and the first one is kept
+    TEST_ASSERT( mStore->SetCompilandSymbolScope( 2, scope ) != S_OK );
+    TEST_ASSERT( mStore->FindSymbol( SymHeap_GlobalSymbols, 1, 130, handle ) != S_OK );
+    TEST_ASSERT( mStore->SetCompilandSymbolScope( 1, scope ) == S_OK );
+}
@@ -0,0 +1,47 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+
+// Reads the symbols of Fixtures\records.pdb with C13SymbolStore. The
+// fixture has the records of optimized code: S_LOCAL with its S_DEFRANGE_*
+// records, S_INLINESITE, and S_FILESTATIC, which the store doesn't read.
+// Its second module has a procedure whose end doesn't point at its S_END.
+
+class C13SymbolStoreSuite : public Test::Suite
+{
+    std::vector<BYTE>           mPdb;
+    MagoST::PDBReader*          mReader;
+    MagoST::C13SymbolStore*     mStore;
+
+public:
+    C13SymbolStoreSuite();
+
+    void setup();
+    void tear_down();
+
+private:
+    void TestInit();
+    void TestModuleScope();
+    void TestProcScope();
+    void TestBlockScope();
+    void TestInlineSiteScope();
+    void TestLocalLocations();
+    void TestFindSymbol();
+    void TestBadModule();
+
+    bool FindChild( MagoST::SymHandle parent, const char* name, MagoST::SymHandle& child );
+    bool GetChildLocation( 
+        MagoST::SymHandle parent, 
+        const char* name, 
+        MagoST::LocationType& loc, 
+        uint32_t& reg, 
+        int32_t& offset );
+    bool FindChildScope( MagoST::SymHandle parent, MagoST::SymHandle& child );
+    void GetChildNames( MagoST::SymbolScope& scope, std::vector<std::string>& names, int& unreadCount );
+};
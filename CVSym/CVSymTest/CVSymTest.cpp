@@ -0,0 +1,92 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+// CVSymTest.cpp : Defines the entry point for the console application.
+//
+// The suites only use the C runtime and the CVSym library, so that they
+// can also be built and run on hosts other than Windows.
+//
+
+#include "Common.h"
+#include "PDBReaderSuite.h"
+#include "C13SymbolStoreSuite.h"
+
+using namespace std;
+
+
+struct Options
+{
+    std::auto_ptr<Test::Output> Out;
+    const char*                 FixtureDir;
+};
+
+
+bool ParseCommandLine( int argc, char* argv[], Options& options )
+{
+    options.FixtureDir = NULL;
+
+    for ( int i = 1; i < argc; i++ )
+    {
+        if ( strcmp( argv[i], "-textOut" ) == 0 )
+        {
+            if ( (i + 1) >= argc )
+                return false;
+
+            Test::TextOutput::Mode  mode;
+
+            i++;
+            if ( strcmp( argv[i], "terse" ) == 0 )
+                mode = Test::TextOutput::Terse;
+            else if ( strcmp( argv[i], "verbose" ) == 0 )
+                mode = Test::TextOutput::Verbose;
+            else
+                return false;
+
+            options.Out.reset( new Test::TextOutput( mode ) );
+        }
+        else if ( strcmp( argv[i], "-fixtures" ) == 0 )
+        {
+            if ( (i + 1) >= argc )
+                return false;
+
+            i++;
+            options.FixtureDir = argv[i];
+        }
+        else
+            return false;
+    }
+
+    if ( options.Out.get() == NULL )
+    {
+        options.Out.reset( new Test::TextOutput( Test::TextOutput::Verbose ) );
+    }
+
+    return true;
+}
+
+int main( int argc, char* argv[] )
+{
+    Options options;
+
+    if ( !ParseCommandLine( argc, argv, options ) )
+    {
+        fprintf( stderr, "Usage: CVSymTest [-textOut terse|verbose] [-fixtures <dir>]\n" );
+        return EXIT_FAILURE;
+    }
+
+    if ( options.FixtureDir != NULL )
+        SetFixtureDir( options.FixtureDir );
+
+    Test::Suite         comboSuite;
+
+    comboSuite.add( auto_ptr<Test::Suite>( new PDBReaderSuite() ) );
+    comboSuite.add( auto_ptr<Test::Suite>( new C13SymbolStoreSuite() ) );
+
+    bool    passed = comboSuite.run( *options.Out.get() );
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,5 @@
+// Common.cpp : source file that includes just the standard includes
+// CVSymTest.pch will be the pre-compiled header
+// Common.obj will contain the pre-compiled type information
+
+#include "Common.h"
@@ -0,0 +1,65 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+// Common.h : include file for standard system include files,
+// or project specific include files that are used frequently, but
+// are changed infrequently
+//
+
+#pragma once
+
+#include "targetver.h"
+
+#define WIN32_LEAN_AND_MEAN             // Exclude rarely-used stuff from Windows headers
+
+// C
+#include <stdio.h>
+#include <string.h>
+#include <crtdbg.h>
+#include <inttypes.h>
+
+// STL
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Windows
+#include <windows.h>
+
+// Other
+#include <cpptest.h>
+
+// Magus
+#include <SmartPtr.h>
+#include <Guard.h>
+
+// CVSym project
+#include "../CVSym/Error.h"
+#include "../CVSym/CVSym.h"
+#include "../CVSym/CVSymInternal.h"
+#include "../CVSym/CVRec.h"
+#include "../CVSym/CV8Rec.h"
+#include "../CVSym/PDBReader.h"
+#include "../CVSym/C13SymbolStore.h"
+
+// This project
+#include "Fixture.h"
+
+// Windows declarations that I don't want
+#undef max
+#undef min
+
+
+#define TEST_ASSERT_RETURN( expr )                                  \
+    {                                                               \
+        if (!(expr))                                                \
+        {                                                           \
+            assertment(::Test::Source(__FILE__, __LINE__, #expr));  \
+            return;                                                 \
+        }                                                           \
+    }
@@ -0,0 +1,49 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#include "Common.h"
+#include "Fixture.h"
+
+
+static std::string  gFixtureDir( "Fixtures" );
+
+
+void SetFixtureDir( const char* dir )
+{
+    gFixtureDir = dir;
+}
+
+bool LoadFixture( const char* name, std::vector<BYTE>& data )
+{
+    std::string path( gFixtureDir );
+    FILE*       file = NULL;
+    long        size = 0;
+    bool        ok = false;
+
+    path += '/';
+    path += name;
+
+    data.clear();
+
+    file = fopen( path.c_str(), "rb" );
+    if ( file == NULL )
+    {
+        fprintf( stderr, "Can't open fixture %s\n", path.c_str() );
+        return false;
+    }
+
+    if ( (fseek( file, 0, SEEK_END ) == 0) && ((size = ftell( file )) > 0) )
+    {
+        data.resize( size );
+
+        ok = (fseek( file, 0, SEEK_SET ) == 0)
+            && (fread( &data[0], 1, size, file ) == (size_t) size);
+    }
+
+    fclose( file );
+    return ok;
+}
@@ -0,0 +1,16 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+
+// The PDBs that the suites read are checked in under Fixtures, along with
+// the YAML that they were made from. A fixture is read whole into memory,
+// like PDBDebugStore maps the PDB it opens.
+
+void SetFixtureDir( const char* dir );
+bool LoadFixture( const char* name, std::vector<BYTE>& data );
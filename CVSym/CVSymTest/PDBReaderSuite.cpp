@@ -0,0 +1,324 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#include "Common.h"
+#include "PDBReaderSuite.h"
+
+using namespace std;
+using namespace MagoST;
+
+
+const char      LinesFixture[] = "lines.pdb";
+
+// {11223344-5566-7788-99AA-BBCCDDEEFF00}, age 3
+const GUID      LinesGuid = { 0x11223344, 0x5566, 0x7788, { 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF, 0x00 } };
+const uint32_t  LinesAge = 3;
+
+const uint32_t  ModuleSymSignatureC13 = 4;
+
+
+static bool NameIs( const SymString& name, const char* expected )
+{
+    return (name.GetLength() == strlen( expected ))
+        && (memcmp( name.GetName(), expected, name.GetLength() ) == 0);
+}
+
+
+PDBReaderSuite::PDBReaderSuite()
+:   mReader( NULL )
+{
+    TEST_ADD( PDBReaderSuite::TestStreams );
+    TEST_ADD( PDBReaderSuite::TestBadFile );
+    TEST_ADD( PDBReaderSuite::TestMatches );
+    TEST_ADD( PDBReaderSuite::TestModules );
+    TEST_ADD( PDBReaderSuite::TestFiles );
+    TEST_ADD( PDBReaderSuite::TestFileSegments );
+    TEST_ADD( PDBReaderSuite::TestFindLine );
+    TEST_ADD( PDBReaderSuite::TestFindLineByNum );
+    TEST_ADD( PDBReaderSuite::TestFindLines );
+    TEST_ADD( PDBReaderSuite::TestModuleSymbols );
+}
+
+void PDBReaderSuite::setup()
+{
+    mReader = NULL;
+
+    if ( !LoadFixture( LinesFixture, mPdb ) )
+        return;
+
+    mReader = new PDBReader();
+
+    if ( mReader->Init( &mPdb[0], (uint32_t) mPdb.size() ) != S_OK )
+    {
+        delete mReader;
+        mReader = NULL;
+    }
+}
+
+void PDBReaderSuite::tear_down()
+{
+    if ( mReader != NULL )
+    {
+        delete mReader;
+        mReader = NULL;
+    }
+
+    mPdb.clear();
+}
+
+void PDBReaderSuite::TestStreams()
+{
+    TEST_ASSERT_RETURN( mReader != NULL );
+
+    MSFFile     msf;
+    const BYTE* data = NULL;
+    uint32_t    size = 0;
+
+    TEST_ASSERT_RETURN( msf.Init( &mPdb[0], (uint32_t) mPdb.size() ) == S_OK );
+
+    // old directory, PDB, TPI, DBI, IPI, /LinkInfo, TPI hash, main.obj, /names
+    TEST_ASSERT( msf.GetStreamCount() == 9 );
+
+    // the PDB info stream starts with its version, VC70
+    TEST_ASSERT_RETURN( msf.GetStream( 1, data, size ) );
+    TEST_ASSERT_RETURN( size >= 4 );
+    TEST_ASSERT( *(const uint32_t*) data == 20000404 );
+
+    TEST_ASSERT( !msf.GetStream( msf.GetStreamCount(), data, size ) );
+
+    TEST_ASSERT( mReader->GetMachine() == IMAGE_FILE_MACHINE_I386 );
+}
+
+void PDBReaderSuite::TestBadFile()
+{
+    TEST_ASSERT_RETURN( !mPdb.empty() );
+
+    std::vector<BYTE>   bad( mPdb );
+    PDBReader           reader1;
+    PDBReader           reader2;
+    PDBReader           reader3;
+
+    // cut off in the middle of the streams
+    TEST_ASSERT( reader1.Init( &bad[0], (uint32_t) bad.size() / 2 ) != S_OK );
+
+    // not an MSF file
+    bad[0] = 'X';
+    TEST_ASSERT( reader2.Init( &bad[0], (uint32_t) bad.size() ) != S_OK );
+
+    // a block map that's past the end of the file; it follows the
+    // signature, block size, free block map, block count, directory size,
+    // and an unused field
+    bad = mPdb;
+    *(uint32_t*) &bad[32 + 5 * 4] = 0x7FFFFFFF;
+    TEST_ASSERT( reader3.Init( &bad[0], (uint32_t) bad.size() ) != S_OK );
+}
+
+void PDBReaderSuite::TestMatches()
+{
+    TEST_ASSERT_RETURN( mReader != NULL );
+
+    GUID    otherGuid = LinesGuid;
+
+    otherGuid.Data4[7] = 1;
+
+    TEST_ASSERT( mReader->Matches( LinesGuid, LinesAge ) );
+    TEST_ASSERT( !mReader->Matches( LinesGuid, LinesAge - 1 ) );
+    TEST_ASSERT( !mReader->Matches( otherGuid, LinesAge ) );
+}
+
+void PDBReaderSuite::TestModules()
+{
+    TEST_ASSERT_RETURN( mReader != NULL );
+
+    SymString   name;
+    uint16_t    fileCount = 0;
+
+    TEST_ASSERT_RETURN( mReader->GetModuleCount() == 2 );
+
+    TEST_ASSERT( mReader->GetModuleName( 0, name ) && NameIs( name, "d:\\obj\\main.obj" ) );
+    TEST_ASSERT( mReader->GetModuleName( 1, name ) && NameIs( name, "* Linker *" ) );
+    TEST_ASSERT( !mReader->GetModuleName( 2, name ) );
+
+    TEST_ASSERT( mReader->GetFileCount( 1, fileCount ) && (fileCount == 0) );
+    TEST_ASSERT( !mReader->GetFileCount( 2, fileCount ) );
+}
+
+void PDBReaderSuite::TestFiles()
+{
+    TEST_ASSERT_RETURN( mReader != NULL );
+
+    SymString   name;
+    uint16_t    fileCount = 0;
+    uint16_t    segCount = 0;
+
+    TEST_ASSERT_RETURN( mReader->GetFileCount( 0, fileCount ) );
+    TEST_ASSERT_RETURN( fileCount == 2 );
+
+    // main.d has two blocks of lines, with util.d's in between
+    TEST_ASSERT( mReader->GetFileInfo( 0, 0, name, segCount ) );
+    TEST_ASSERT( NameIs( name, "d:\\src\\main.d" ) && (segCount == 2) );
+
+    TEST_ASSERT( mReader->GetFileInfo( 0, 1, name, segCount ) );
+    TEST_ASSERT( NameIs( name, "d:\\src\\util.d" ) && (segCount == 1) );
+
+    TEST_ASSERT( !mReader->GetFileInfo( 0, 2, name, segCount ) );
+}
+
+void PDBReaderSuite::TestFileSegments()
+{
+    TEST_ASSERT_RETURN( mReader != NULL );
+
+    FileSegmentInfo segInfo = { 0 };
+
+    TEST_ASSERT_RETURN( mReader->GetFileSegment( 0, 0, 0, segInfo ) );
+    TEST_ASSERT( (segInfo.SegmentIndex == 1) && (segInfo.SegmentInstance == 0) );
+    TEST_ASSERT( (segInfo.Start == 0x10) && (segInfo.End == 0x1F) );
+    TEST_ASSERT_RETURN( segInfo.LineCount == 2 );
+    TEST_ASSERT( (segInfo.LineNumbers[0] == 5) && (segInfo.Offsets[0] == 0x10) );
+    TEST_ASSERT( (segInfo.LineNumbers[1] == 6) && (segInfo.Offsets[1] == 0x18) );
+
+    TEST_ASSERT_RETURN( mReader->GetFileSegment( 0, 0, 1, segInfo ) );
+    TEST_ASSERT( (segInfo.Start == 0x30) && (segInfo.End == 0x4F) );
+    TEST_ASSERT_RETURN( segInfo.LineCount == 1 );
+    TEST_ASSERT( (segInfo.LineNumbers[0] == 7) && (segInfo.Offsets[0] == 0x30) );
+
+    TEST_ASSERT_RETURN( mReader->GetFileSegment( 0, 1, 0, segInfo ) );
+    TEST_ASSERT( (segInfo.Start == 0x20) && (segInfo.End == 0x2F) );
+    TEST_ASSERT_RETURN( segInfo.LineCount == 1 );
+    TEST_ASSERT( (segInfo.LineNumbers[0] == 20) && (segInfo.Offsets[0] == 0x20) );
+
+    TEST_ASSERT( !mReader->GetFileSegment( 0, 0, 2, segInfo ) );
+    TEST_ASSERT( !mReader->GetFileSegment( 1, 0, 0, segInfo ) );
+}
+
+void PDBReaderSuite::AssertLine( uint32_t offset, uint16_t fileIndex, uint16_t segInstance, 
+                                 uint16_t number, uint32_t lineOffset, uint32_t length )
+{
+    LineNumber  line = { 0 };
+
+    TEST_ASSERT_RETURN( mReader->FindLine( 1, offset, line ) );
+    TEST_ASSERT( line.CompilandIndex == 1 );
+    TEST_ASSERT( line.FileIndex == fileIndex );
+    TEST_ASSERT( line.SegmentInstanceIndex == segInstance );
+    TEST_ASSERT( (line.Number == number) && (line.NumberEnd == number) );
+    TEST_ASSERT( line.Section == 1 );
+    TEST_ASSERT( line.Offset == lineOffset );
+    TEST_ASSERT( line.Length == length );
+}
+
+void PDBReaderSuite::TestFindLine()
+{
+    TEST_ASSERT_RETURN( mReader != NULL );
+
+    LineNumber  line = { 0 };
+
+    // each line runs to the next one, or to the end of the code
+    AssertLine( 0x10, 0, 0, 5, 0x10, 8 );
+    AssertLine( 0x17, 0, 0, 5, 0x10, 8 );
+    AssertLine( 0x18, 0, 0, 6, 0x18, 8 );
+    AssertLine( 0x2C, 1, 0, 20, 0x20, 16 );
+    AssertLine( 0x30, 0, 1, 7, 0x30, 32 );
+    AssertLine( 0x4F, 0, 1, 7, 0x30, 32 );
+
+    TEST_ASSERT( !mReader->FindLine( 1, 0x0C, line ) );
+    TEST_ASSERT( !mReader->FindLine( 1, 0x50, line ) );
+    TEST_ASSERT( !mReader->FindLine( 2, 0x10, line ) );
+}
+
+void PDBReaderSuite::TestFindLineByNum()
+{
+    TEST_ASSERT_RETURN( mReader != NULL );
+
+    LineNumber  line = { 0 };
+
+    TEST_ASSERT_RETURN( mReader->FindLineByNum( 0, 0, 6, line ) );
+    TEST_ASSERT( (line.Number == 6) && (line.Offset == 0x18) && (line.FileIndex == 0) );
+    TEST_ASSERT( !mReader->FindNextLineByNum( 0, 0, line ) );
+
+    // a line without code goes to the next one that has some
+    TEST_ASSERT_RETURN( mReader->FindLineByNum( 0, 0, 1, line ) );
+    TEST_ASSERT( (line.Number == 5) && (line.Offset == 0x10) );
+
+    TEST_ASSERT_RETURN( mReader->FindLineByNum( 0, 1, 20, line ) );
+    TEST_ASSERT( (line.Number == 20) && (line.Offset == 0x20) && (line.FileIndex == 1) );
+
+    TEST_ASSERT( !mReader->FindLineByNum( 0, 0, 8, line ) );
+    TEST_ASSERT( !mReader->FindLineByNum( 0, 2, 5, line ) );
+    TEST_ASSERT( !mReader->FindLineByNum( 1, 0, 5, line ) );
+}
+
+void PDBReaderSuite::TestFindLines()
+{
+    TEST_ASSERT_RETURN( mReader != NULL );
+
+    std::vector<LineNumber> lines;
+
+    mReader->FindLines( 0, 0, 7, 7, lines );
+    TEST_ASSERT_RETURN( lines.size() == 1 );
+    TEST_ASSERT( (lines[0].Number == 7) && (lines[0].Offset == 0x30) && (lines[0].SegmentInstanceIndex == 1) );
+
+    lines.clear();
+    mReader->FindLines( 0, 1, 19, 21, lines );
+    TEST_ASSERT_RETURN( lines.size() == 1 );
+    TEST_ASSERT( (lines[0].Number == 20) && (lines[0].FileIndex == 1) );
+
+    // the next line with code is past the range
+    lines.clear();
+    mReader->FindLines( 0, 0, 1, 4, lines );
+    TEST_ASSERT( lines.empty() );
+}
+
+void PDBReaderSuite::TestModuleSymbols()
+{
+    TEST_ASSERT_RETURN( mReader != NULL );
+
+    static const uint16_t   Expected[] = 
+    {
+        S_OBJNAME_V3,
+        S_GPROC32_V3,
+        S_BPREL32_V3,
+        S_BLOCK32_V3,
+        S_BPREL32_V3,
+        S_END,
+        S_END,
+        S_LPROC32_V3,
+        S_END,
+    };
+    const int   ExpectedCount = sizeof Expected / sizeof Expected[0];
+
+    const BYTE* data = NULL;
+    uint32_t    size = 0;
+    uint32_t    offset = 4;
+    int         count = 0;
+
+    TEST_ASSERT_RETURN( mReader->GetModuleSymbols( 0, data, size ) );
+    TEST_ASSERT_RETURN( size >= 4 );
+    TEST_ASSERT( *(const uint32_t*) data == ModuleSymSignatureC13 );
+
+    while ( (size - offset) >= 4 )
+    {
+        const CodeViewSymbolV3* sym = (const CodeViewSymbolV3*) (data + offset);
+
+        TEST_ASSERT_RETURN( count < ExpectedCount );
+        TEST_ASSERT( sym->Generic.id == Expected[count] );
+
+        if ( sym->Generic.id == S_GPROC32_V3 )
+        {
+            TEST_ASSERT( (sym->proc.segment == 1) && (sym->proc.offset == 16) && (sym->proc.length == 32) );
+        }
+
+        offset += sym->Generic.len + 2;
+        count++;
+    }
+
+    TEST_ASSERT( offset == size );
+    TEST_ASSERT( count == ExpectedCount );
+
+    // the linker's module has no symbol stream
+    TEST_ASSERT( mReader->GetModuleSymbols( 1, data, size ) && (size == 0) );
+    TEST_ASSERT( !mReader->GetModuleSymbols( 2, data, size ) );
+}
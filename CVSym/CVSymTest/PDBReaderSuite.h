@@ -0,0 +1,39 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+
+// Reads the lines and raw module symbols of Fixtures\lines.pdb with
+// MSFFile and PDBReader. The expected values are the ones in lines.yaml.
+
+class PDBReaderSuite : public Test::Suite
+{
+    std::vector<BYTE>   mPdb;
+    MagoST::PDBReader*  mReader;
+
+public:
+    PDBReaderSuite();
+
+    void setup();
+    void tear_down();
+
+private:
+    void TestStreams();
+    void TestBadFile();
+    void TestMatches();
+    void TestModules();
+    void TestFiles();
+    void TestFileSegments();
+    void TestFindLine();
+    void TestFindLineByNum();
+    void TestFindLines();
+    void TestModuleSymbols();
+
+    void AssertLine( uint32_t offset, uint16_t fileIndex, uint16_t segInstance, 
+                     uint16_t number, uint32_t lineOffset, uint32_t length );
+};
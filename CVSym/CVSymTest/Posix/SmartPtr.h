@@ -0,0 +1,101 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+// SmartPtr.h : takes the place of Include\SmartPtr.h when CVSymTest is built 
+// on other hosts. That one's unique and handle pointers only build with 
+// MSVC. The readers that the suites test only need UniquePtr, for members 
+// of the stores that their headers declare.
+//
+
+#pragma once
+
+
+template <class T>
+struct DefaultDeleter
+{
+    typedef T Elem;
+
+    static void Delete( T* p )
+    {
+        delete p;
+    }
+};
+
+template <class T>
+struct DefaultDeleter<T[]>
+{
+    typedef T Elem;
+
+    static void Delete( T* p )
+    {
+        delete [] p;
+    }
+};
+
+
+template <class T, class TDeleter = DefaultDeleter<T> >
+class UniquePtr
+{
+    typedef typename DefaultDeleter<T>::Elem    Elem;
+
+    Elem*   p;
+
+public:
+    UniquePtr()
+        :   p( NULL )
+    {
+    }
+
+    explicit UniquePtr( Elem* value )
+        :   p( value )
+    {
+    }
+
+    ~UniquePtr()
+    {
+        if ( p != NULL )
+            TDeleter::Delete( p );
+    }
+
+    Elem* Get() const
+    {
+        return p;
+    }
+
+    operator Elem*() const
+    {
+        return p;
+    }
+
+    Elem* operator->() const
+    {
+        return p;
+    }
+
+    bool IsEmpty() const
+    {
+        return p == NULL;
+    }
+
+    void Attach( Elem* value )
+    {
+        if ( (value != p) && (p != NULL) )
+            TDeleter::Delete( p );
+        p = value;
+    }
+
+    Elem* Detach()
+    {
+        Elem* outP = p;
+        p = NULL;
+        return outP;
+    }
+
+private:
+    UniquePtr( const UniquePtr& other );
+    UniquePtr& operator=( const UniquePtr& other );
+};
@@ -0,0 +1,23 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+// crtdbg.h : the debug CRT's asserts and reports, for building CVSymTest on 
+// hosts other than Windows. Reports are dropped.
+//
+
+#pragma once
+
+#include <assert.h>
+
+#define _ASSERT( expr )                     assert( expr )
+
+#define _CRT_WARN                           0
+#define _RPT0( type, fmt )                  ((void) 0)
+#define _RPT1( type, fmt, a )               ((void) (a))
+#define _RPT2( type, fmt, a, b )            ((void) (a), (void) (b))
+#define _RPT3( type, fmt, a, b, c )         ((void) (a), (void) (b), (void) (c))
+#define _RPT4( type, fmt, a, b, c, d )      ((void) (a), (void) (b), (void) (c), (void) (d))
@@ -0,0 +1,10 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+// poppack.h : goes back to the packing from before pshpack1.h
+
+#pragma pack( pop )
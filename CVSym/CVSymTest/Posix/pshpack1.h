@@ -0,0 +1,10 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+// pshpack1.h : packs the structures that follow on byte boundaries, until poppack.h
+
+#pragma pack( push, 1 )
@@ -0,0 +1,147 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+// windows.h : stands in for the Windows headers when CVSymTest is built on 
+// other hosts. It has only what the suites and the CVSym sources that they 
+// test use. The sizes of the types are the ones they have on Windows, 
+// because the debug info records are read straight into structures.
+//
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+#include <ctype.h>
+#include <pthread.h>
+
+
+typedef unsigned char       BYTE;
+typedef uint16_t            WORD;
+typedef uint32_t            DWORD;
+typedef uint64_t            DWORD64;
+typedef int32_t             LONG;
+typedef uint32_t            ULONG;
+typedef uint64_t            ULONG64;
+typedef int64_t             LONGLONG;
+typedef uint64_t            ULONGLONG;
+typedef uint16_t            USHORT;
+typedef uint32_t            UINT;
+typedef int                 BOOL;
+typedef int32_t             HRESULT;
+typedef wchar_t             WCHAR;
+typedef void*               PVOID;
+typedef void*               HANDLE;
+
+#ifndef GUID_DEFINED
+#define GUID_DEFINED
+typedef struct _GUID
+{
+    uint32_t    Data1;
+    uint16_t    Data2;
+    uint16_t    Data3;
+    uint8_t     Data4[8];
+} GUID;
+#endif
+
+#define TRUE    1
+#define FALSE   0
+
+#define S_OK                    ((HRESULT) 0)
+#define S_FALSE                 ((HRESULT) 1)
+#define E_NOTIMPL               ((HRESULT) 0x80004001)
+#define E_POINTER               ((HRESULT) 0x80004003)
+#define E_FAIL                  ((HRESULT) 0x80004005)
+#define E_UNEXPECTED            ((HRESULT) 0x8000FFFF)
+#define E_ACCESSDENIED          ((HRESULT) 0x80070005)
+#define E_OUTOFMEMORY           ((HRESULT) 0x8007000E)
+#define E_INVALIDARG            ((HRESULT) 0x80070057)
+
+#define SUCCEEDED( hr )         (((HRESULT) (hr)) >= 0)
+#define FAILED( hr )            (((HRESULT) (hr)) < 0)
+#define HRESULT_FROM_WIN32( x ) ((HRESULT) (((x) & 0x0000FFFF) | 0x80070000))
+
+#define ERROR_FILE_NOT_FOUND        2
+#define ERROR_BAD_FORMAT            11
+#define ERROR_INVALID_DATA          13
+#define ERROR_HANDLE_EOF            38
+#define ERROR_INSUFFICIENT_BUFFER   122
+#define ERROR_PARTIAL_COPY          299
+#define ERROR_NOT_FOUND             1168
+#define ERROR_ALREADY_INITIALIZED   1247
+
+#define IMAGE_FILE_MACHINE_I386     0x014c
+#define IMAGE_FILE_MACHINE_AMD64    0x8664
+
+#define C_ASSERT( e )               typedef char __C_ASSERT__[(e) ? 1 : -1]
+#define UNREFERENCED_PARAMETER( p ) ((void) (p))
+#define _countof( a )               (sizeof (a) / sizeof (a)[0])
+
+#define __stdcall
+#define WINAPI
+
+
+inline DWORD GetLastError()
+{
+    return 0;
+}
+
+inline long InterlockedIncrement( volatile long* p )
+{
+    return __sync_add_and_fetch( p, 1 );
+}
+
+inline long InterlockedDecrement( volatile long* p )
+{
+    return __sync_sub_and_fetch( p, 1 );
+}
+
+inline PVOID InterlockedCompareExchangePointer( PVOID volatile* p, PVOID exchange, PVOID comparand )
+{
+    return __sync_val_compare_and_swap( p, comparand, exchange );
+}
+
+
+// Guard only needs a lock that the same thread can take more than once.
+typedef struct
+{
+    pthread_mutex_t Mutex;
+} CRITICAL_SECTION;
+
+inline void InitializeCriticalSection( CRITICAL_SECTION* critSec )
+{
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init( &attr );
+    pthread_mutexattr_settype( &attr, PTHREAD_MUTEX_RECURSIVE );
+    pthread_mutex_init( &critSec->Mutex, &attr );
+    pthread_mutexattr_destroy( &attr );
+}
+
+inline void DeleteCriticalSection( CRITICAL_SECTION* critSec )
+{
+    pthread_mutex_destroy( &critSec->Mutex );
+}
+
+inline void EnterCriticalSection( CRITICAL_SECTION* critSec )
+{
+    pthread_mutex_lock( &critSec->Mutex );
+}
+
+inline void LeaveCriticalSection( CRITICAL_SECTION* critSec )
+{
+    pthread_mutex_unlock( &critSec->Mutex );
+}
+
+inline BOOL CloseHandle( HANDLE handle )
+{
+    UNREFERENCED_PARAMETER( handle );
+    return TRUE;
+}
@@ -79,11 +79,11 @@ namespace Mago
         if ( !mod->GetSymbolSession( session ) )
             return false;
 
-        std::list<MagoST::LineNumber> lines;
+        std::vector<MagoST::LineNumber> lines;
         if( !session->FindLines( exactMatch, fileName, fileNameLen, mReqLineStart, mReqLineEnd, lines ) )
             return false;
 
-        for( std::list<MagoST::LineNumber>::iterator it = lines.begin(); it != lines.end(); ++it )
+        for( std::vector<MagoST::LineNumber>::iterator it = lines.begin(); it != lines.end(); ++it )
         {
             PutLineError( err );
 
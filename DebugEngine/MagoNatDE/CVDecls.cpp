@@ -54,10 +54,12 @@ namespace Mago
 
     void CVDecl::Release()
     {
-        InterlockedDecrement( &mRefCount );
-        _ASSERT( mRefCount >= 0 );
-        if ( mRefCount == 0 )
+        long    newRef = InterlockedDecrement( &mRefCount );
+        _ASSERT( newRef >= 0 );
+        if ( newRef == 0 )
+        {
             delete this;
+        }
     }
 
     const wchar_t* CVDecl::GetName()
@@ -562,7 +564,7 @@ namespace Mago
         HRESULT             hr = S_OK;
         MagoST::TypeHandle  childTH = { 0 };
         MagoST::TypeIndex   flistIndex = 0;
-        MagoST::TypeHandle  flistHandle = { 0 };
+        int32_t             baseOffset = 0;
         CAutoVectorPtr<char>    u8Name;
         size_t                  u8NameLen = 0;
 
@@ -573,52 +575,10 @@ namespace Mago
         if ( !mSymInfo->GetFieldList( flistIndex ) )
             return E_NOT_FOUND;
 
-        for ( ; ; )
-        {
-            if ( !mSession->GetTypeFromTypeIndex( flistIndex, flistHandle ) )
-                return E_NOT_FOUND;
-
-            hr = mSession->FindChildType( flistHandle, u8Name, u8NameLen, childTH );
-            if ( hr == S_OK )
-                break;
-
-            MagoST::TypeScope       scope = { 0 };
-            MagoST::TypeHandle      baseTH = { 0 };
-            MagoST::SymInfoData     baseInfoData = { 0 };
-            MagoST::ISymbolInfo*    baseInfo = NULL;
-            MagoST::TypeIndex       baseClassTI = 0;
-            MagoST::TypeHandle      baseClassTH = { 0 };
-            MagoST::SymInfoData     baseClassInfoData = { 0 };
-            MagoST::ISymbolInfo*    baseClassInfo = NULL;
-
-            hr = mSession->SetChildTypeScope( flistHandle, scope );
-            if ( hr != S_OK )
-                return E_NOT_FOUND;
-
-            // base classes are first in the field list
-            if ( !mSession->NextType( scope, baseTH ) )
-                return E_NOT_FOUND;
-
-            hr = mSession->GetTypeInfo( baseTH, baseInfoData, baseInfo );
-            if ( hr != S_OK )
-                return E_NOT_FOUND;
-
-            if ( baseInfo->GetSymTag() != MagoST::SymTagBaseClass )
-                return E_NOT_FOUND;
-
-            if ( !baseInfo->GetType( baseClassTI ) )
-                return E_NOT_FOUND;
-
-            if ( !mSession->GetTypeFromTypeIndex( baseClassTI, baseClassTH ) )
-                return E_NOT_FOUND;
-
-            hr = mSession->GetTypeInfo( baseClassTH, baseClassInfoData, baseClassInfo );
-            if ( hr != S_OK )
-                return E_NOT_FOUND;
-
-            if ( !baseClassInfo->GetFieldList( flistIndex ) )
-                return E_NOT_FOUND;
-        }
+        // looks in the base classes, too
+        hr = mSession->FindMemberType( flistIndex, u8Name, u8NameLen, childTH, baseOffset );
+        if ( hr != S_OK )
+            return E_NOT_FOUND;
 
         if ( mSymInfo->GetSymTag() == MagoST::SymTagEnum )
         {
@@ -639,9 +599,23 @@ namespace Mago
         }
         else
         {
-            hr = mSymStore->MakeDeclarationFromSymbol( childTH, decl );
+            RefPtr<MagoEE::Declaration> memberDecl;
+
+            hr = mSymStore->MakeDeclarationFromSymbol( childTH, memberDecl.Ref() );
             if ( FAILED( hr ) )
                 return hr;
+
+            // the member's offset is from the start of the base class that has it
+            if ( baseOffset != 0 )
+            {
+                decl = new InheritedMemberDecl( memberDecl, baseOffset );
+                if ( decl == NULL )
+                    return E_OUTOFMEMORY;
+
+                decl->AddRef();
+            }
+            else
+                decl = memberDecl.Detach();
         }
 
         return S_OK;
@@ -1047,4 +1021,120 @@ namespace Mago
     {
         return E_NOT_FOUND;
     }
+
+
+//----------------------------------------------------------------------------
+//  InheritedMemberDecl
+//----------------------------------------------------------------------------
+
+    InheritedMemberDecl::InheritedMemberDecl( Declaration* decl, int baseOffset )
+        :   mRefCount( 0 ),
+            mOrigDecl( decl ),
+            mBaseOffset( baseOffset )
+    {
+    }
+
+    void InheritedMemberDecl::AddRef()
+    {
+        InterlockedIncrement( &mRefCount );
+    }
+
+    void InheritedMemberDecl::Release()
+    {
+        long    newRef = InterlockedDecrement( &mRefCount );
+        _ASSERT( newRef >= 0 );
+        if ( newRef == 0 )
+        {
+            delete this;
+        }
+    }
+
+    const wchar_t* InheritedMemberDecl::GetName()
+    {
+        return mOrigDecl->GetName();
+    }
+
+    bool InheritedMemberDecl::GetType( MagoEE::Type*& type )
+    {
+        return mOrigDecl->GetType( type );
+    }
+
+    bool InheritedMemberDecl::GetAddress( MagoEE::Address& addr )
+    {
+        return mOrigDecl->GetAddress( addr );
+    }
+
+    bool InheritedMemberDecl::GetOffset( int& offset )
+    {
+        if ( !mOrigDecl->GetOffset( offset ) )
+            return false;
+
+        offset += mBaseOffset;
+        return true;
+    }
+
+    bool InheritedMemberDecl::GetSize( uint32_t& size )
+    {
+        return mOrigDecl->GetSize( size );
+    }
+
+    bool InheritedMemberDecl::GetBackingTy( MagoEE::ENUMTY& ty )
+    {
+        return mOrigDecl->GetBackingTy( ty );
+    }
+
+    bool InheritedMemberDecl::GetUdtKind( MagoEE::UdtKind& kind )
+    {
+        return mOrigDecl->GetUdtKind( kind );
+    }
+
+    bool InheritedMemberDecl::GetBaseClassOffset( Declaration* baseClass, int& offset )
+    {
+        return mOrigDecl->GetBaseClassOffset( baseClass, offset );
+    }
+
+    bool InheritedMemberDecl::IsField()
+    {
+        return mOrigDecl->IsField();
+    }
+
+    bool InheritedMemberDecl::IsStaticField()
+    {
+        return mOrigDecl->IsStaticField();
+    }
+
+    bool InheritedMemberDecl::IsVar()
+    {
+        return mOrigDecl->IsVar();
+    }
+
+    bool InheritedMemberDecl::IsConstant()
+    {
+        return mOrigDecl->IsConstant();
+    }
+
+    bool InheritedMemberDecl::IsType()
+    {
+        return mOrigDecl->IsType();
+    }
+
+    bool InheritedMemberDecl::IsBaseClass()
+    {
+        return mOrigDecl->IsBaseClass();
+    }
+
+    HRESULT InheritedMemberDecl::FindObject( const wchar_t* name, Declaration*& decl )
+    {
+        return mOrigDecl->FindObject( name, decl );
+    }
+
+    bool InheritedMemberDecl::EnumMembers( MagoEE::IEnumDeclarationMembers*& members )
+    {
+        return mOrigDecl->EnumMembers( members );
+    }
+
+    HRESULT InheritedMemberDecl::FindObjectByValue( uint64_t intVal, Declaration*& decl )
+    {
+        return mOrigDecl->FindObjectByValue( intVal, decl );
+    }
 }
@@ -209,4 +209,42 @@ namespace Mago
         virtual bool EnumMembers( MagoEE::IEnumDeclarationMembers*& members );
         virtual HRESULT FindObjectByValue( uint64_t intVal, Declaration*& decl );
     };
+
+
+    // A member found in a base class, whose offset is counted from the
+    // start of the derived class instead of the base class that declares it.
+
+    class InheritedMemberDecl : public MagoEE::Declaration
+    {
+        long                        mRefCount;
+        RefPtr<MagoEE::Declaration> mOrigDecl;
+        int                         mBaseOffset;
+
+    public:
+        InheritedMemberDecl( Declaration* decl, int baseOffset );
+
+        virtual void AddRef();
+        virtual void Release();
+
+        virtual const wchar_t* GetName();
+
+        virtual bool GetType( MagoEE::Type*& type );
+        virtual bool GetAddress( MagoEE::Address& addr );
+        virtual bool GetOffset( int& offset );
+        virtual bool GetSize( uint32_t& size );
+        virtual bool GetBackingTy( MagoEE::ENUMTY& ty );
+        virtual bool GetUdtKind( MagoEE::UdtKind& kind );
+        virtual bool GetBaseClassOffset( Declaration* baseClass, int& offset );
+
+        virtual bool IsField();
+        virtual bool IsStaticField();
+        virtual bool IsVar();
+        virtual bool IsConstant();
+        virtual bool IsType();
+        virtual bool IsBaseClass();
+
+        virtual HRESULT FindObject( const wchar_t* name, Declaration*& decl );
+        virtual bool EnumMembers( MagoEE::IEnumDeclarationMembers*& members );
+        virtual HRESULT FindObjectByValue( uint64_t intVal, Declaration*& decl );
+    };
 }
@@ -11,6 +11,14 @@
 
 
 #define MAGO_SUBKEY             L"SOFTWARE\\MagoDebugger"
+#define SYM_INDEX_DIR_VALUE     L"SymbolIndexCache"
+#define SYM_INDEX_SIZE_VALUE    L"SymbolIndexCacheSizeMB"
+#define SYM_INDEX_DEFAULT_DIR   L"MagoSymbolIndex"
+#define SYM_LOAD_THREADS_VALUE  L"SymbolLoadThreads"
+
+const DWORD DefaultSymIndexCacheSizeMB = 256;
+const DWORD DefaultMaxSymLoadThreads = 4;
+const DWORD MaxSymLoadThreads = 16;
 
 // {B9D303A5-4EC7-4444-A7F8-6BFA4C7977EF}
 static const GUID gGuidDLang = 
@@ -148,3 +156,90 @@ LSTATUS GetRegString( HKEY hKey, const wchar_t* valueName, wchar_t* charBuf, int
 
     return ERROR_SUCCESS;
 }
+
+// The symbol index cache is in the temporary directory, unless the registry 
+// names another one. Setting the directory or size to empty or zero turns 
+// the cache off.
+
+bool GetSymbolIndexCacheConfig( std::wstring& dir, uint64_t& maxSize )
+{
+    wchar_t dirBuf[MAX_PATH] = L"";
+    int     dirLen = _countof( dirBuf );
+    DWORD   sizeMB = DefaultSymIndexCacheSizeMB;
+    bool    hasDir = false;
+    HKEY    hKey = NULL;
+    LSTATUS ret = 0;
+
+    ret = OpenRootRegKey( false, hKey );
+    if ( ret == ERROR_SUCCESS )
+    {
+        DWORD   regType = 0;
+        DWORD   value = 0;
+        DWORD   valueLen = sizeof value;
+
+        ret = GetRegString( hKey, SYM_INDEX_DIR_VALUE, dirBuf, dirLen );
+        if ( ret == ERROR_SUCCESS )
+            hasDir = true;
+
+        ret = RegQueryValueEx( hKey, SYM_INDEX_SIZE_VALUE, NULL, &regType, (BYTE*) &value, &valueLen );
+        if ( (ret == ERROR_SUCCESS) && (regType == REG_DWORD) )
+            sizeMB = value;
+
+        RegCloseKey( hKey );
+    }
+
+    if ( !hasDir )
+    {
+        // the temp path ends in a backslash
+        DWORD   len = GetTempPath( _countof( dirBuf ), dirBuf );
+        if ( (len == 0) || (len >= _countof( dirBuf )) )
+            return false;
+
+        if ( wcscat_s( dirBuf, SYM_INDEX_DEFAULT_DIR ) != 0 )
+            return false;
+    }
+
+    if ( (dirBuf[0] == L'\0') || (sizeMB == 0) )
+        return false;
+
+    dir = dirBuf;
+    maxSize = (uint64_t) sizeMB * 1024 * 1024;
+    return true;
+}
+
+// Symbols are loaded on as many threads as there are processors, up to a 
+// few. The registry can name another count. Zero threads turns loading in 
+// the background off.
+
+DWORD GetSymbolLoadThreadCount()
+{
+    SYSTEM_INFO sysInfo = { 0 };
+    DWORD   count = 0;
+    HKEY    hKey = NULL;
+    LSTATUS ret = 0;
+
+    GetSystemInfo( &sysInfo );
+
+    count = sysInfo.dwNumberOfProcessors;
+    if ( count > DefaultMaxSymLoadThreads )
+        count = DefaultMaxSymLoadThreads;
+
+    ret = OpenRootRegKey( false, hKey );
+    if ( ret == ERROR_SUCCESS )
+    {
+        DWORD   regType = 0;
+        DWORD   value = 0;
+        DWORD   valueLen = sizeof value;
+
+        ret = RegQueryValueEx( hKey, SYM_LOAD_THREADS_VALUE, NULL, &regType, (BYTE*) &value, &valueLen );
+        if ( (ret == ERROR_SUCCESS) && (regType == REG_DWORD) )
+            count = value;
+
+        RegCloseKey( hKey );
+    }
+
+    if ( count > MaxSymLoadThreads )
+        count = MaxSymLoadThreads;
+
+    return count;
+}
@@ -48,3 +48,6 @@ bool GetString( DWORD strId, CString& str );
 
 LSTATUS OpenRootRegKey( bool readWrite, HKEY& hKey );
 LSTATUS GetRegString( HKEY hKey, const wchar_t* valueName, wchar_t* charBuf, int& charLen );
+
+bool GetSymbolIndexCacheConfig( std::wstring& dir, uint64_t& maxSize );
+DWORD GetSymbolLoadThreadCount();
@@ -13,49 +13,14 @@
 #include <MagoEED.h>
 
 
-struct TypeInfo_Struct32
-{
-    uint32_t    vptr;
-    uint32_t    monitor;
-
-    DArray32    name;       // string
-    DArray32    m_init;     // void[]
-    uint32_t    xtoHash;    // size_t   function(in void*)
-    uint32_t    xopEquals;  // bool     function(in void*, in void*)
-    uint32_t    xopCmp;     // int      function(in void*, in void*)
-    uint32_t    xtoString;  // char[]   function(in void*)
-    uint32_t    m_flags;
-    uint32_t    xdtor;      // void function(void*)
-    uint32_t    xpostblit;  // void function(void*)
-    uint32_t    m_align;
-    // ...
-};
-
-struct TypeInfo_Struct64
-{
-    uint64_t    vptr;
-    uint64_t    monitor;
-
-    DArray64    name;       // string
-    DArray64    m_init;     // void[]
-    uint64_t    xtoHash;    // size_t   function(in void*)
-    uint64_t    xopEquals;  // bool     function(in void*, in void*)
-    uint64_t    xopCmp;     // int      function(in void*, in void*)
-    uint64_t    xtoString;  // char[]   function(in void*)
-    uint32_t    m_flags;
-    uint64_t    xdtor;      // void function(void*)
-    uint64_t    xpostblit;  // void function(void*)
-    uint32_t    m_align;
-};
-
-
 namespace Mago
 {
     DRuntime::DRuntime( IDebuggerProxy* debugger, ICoreProcess* coreProcess )
         :   mDebugger( debugger ),
             mCoreProc( coreProcess ),
             mPtrSize( 0 ),
-            mAAVersion( -1 )
+            mAAVersion( -1 ),
+            mAALookup( coreProcess->GetArchData()->GetPointerSize() )
     {
         _ASSERT( debugger != NULL );
         _ASSERT( coreProcess != NULL );
@@ -64,634 +29,30 @@ namespace Mago
         mPtrSize = archData->GetPointerSize();
     }
 
-    uint32_t DRuntime::AlignTSize( uint32_t size )
-    {
-        if ( mPtrSize == 4 )
-            return (size + sizeof( uint32_t ) - 1) & ~(sizeof( uint32_t ) - 1);
-        else
-            return (size + 16 - 1) & ~(16 - 1);
-    }
-
-    uint64_t DRuntime::DHashOf( const void* buffer, uint32_t length )
-    {
-        if ( mPtrSize == 4 )
-            return HashOf32( buffer, length );
-        else
-            return HashOf64( buffer, length );
-    }
-
-    HRESULT DRuntime::GetHash( MagoEE::Type* type, const MagoEE::DataValue& value, uint64_t& hash )
-    {
-        _ASSERT( type != NULL );
-
-        if ( type->IsPointer() )
-        {
-            hash = value.Addr;
-        }
-        else if ( type->IsIntegral() && (type->GetSize() <= sizeof( uint32_t )) )
-        {
-            hash = value.UInt64Value;
-        }
-        else if ( type->GetBackingTy() == MagoEE::Tfloat32 || type->GetBackingTy() == MagoEE::Timaginary32 )
-        {
-            float f = value.Float80Value.ToFloat();
-            hash = *(uint32_t*) &f;
-        }
-        else if ( type->IsIntegral() && (type->GetSize() > sizeof( uint32_t )) )
-        {
-            hash = DHashOf( &value.UInt64Value, sizeof value.UInt64Value );
-        }
-        else if ( type->GetBackingTy() == MagoEE::Tfloat64 || type->GetBackingTy() == MagoEE::Timaginary64 )
-        {
-            double d = value.Float80Value.ToDouble();
-            hash = DHashOf( &d, sizeof d );
-        }
-        else if ( type->GetBackingTy() == MagoEE::Tfloat80 || type->GetBackingTy() == MagoEE::Timaginary80 )
-        {
-            hash = DHashOf( &value.Float80Value, sizeof value.Float80Value );
-        }
-        else if ( type->GetBackingTy() == MagoEE::Tcomplex32 )
-        {
-            float c[2] = { value.Complex80Value.RealPart.ToFloat(), value.Complex80Value.ImaginaryPart.ToFloat() };
-            hash = DHashOf( c, sizeof c );
-        }
-        else if ( type->GetBackingTy() == MagoEE::Tcomplex64 )
-        {
-            double c[2] = { value.Complex80Value.RealPart.ToDouble(), value.Complex80Value.ImaginaryPart.ToDouble() };
-            hash = DHashOf( c, sizeof c );
-        }
-        else if ( type->GetBackingTy() == MagoEE::Tcomplex80 )
-        {
-            hash = DHashOf( &value.Complex80Value, sizeof value.Complex80Value );
-        }
-        else if ( type->IsDelegate() )
-        {
-            uint32_t delPtrs[2] = { (uint32_t) value.Delegate.ContextAddr, (uint32_t) value.Delegate.FuncAddr };
-            hash = DHashOf( delPtrs, sizeof delPtrs );
-        }
-        else
-            return E_FAIL;
-
-        if ( mPtrSize == 4 )
-            hash &= 0xFFFFFFFF;
-
-        return S_OK;
-    }
-
-    HRESULT DRuntime::GetStructHash( 
-        const MagoEE::DataObject& key, 
-        const BB64& bb, 
-        HeapPtr& keyBuf, 
-        uint64_t& hash )
-    {
-        _ASSERT( keyBuf.IsEmpty() );
-
-        HRESULT hr = S_OK;
-        TypeInfo_Struct64 tiStruct;
-
-        if ( (key.Addr == 0) || (bb.keyti == 0) )
-            return E_FAIL;
-
-        hr = ReadTypeInfoStruct( bb.keyti, tiStruct );
-        if ( FAILED( hr ) )
-            return hr;
-
-        // if the user defined hash and compare functions,
-        // then we can't do the standard hash and compare
-        if ( (tiStruct.xtoHash != 0) || (tiStruct.xopCmp != 0) )
-            return E_FAIL;
-
-        keyBuf = (uint8_t*) HeapAlloc( GetProcessHeap(), 0, key._Type->GetSize() );
-        if ( keyBuf.IsEmpty() )
-            return E_OUTOFMEMORY;
-
-        hr = ReadMemory( key.Addr, key._Type->GetSize(), keyBuf );
-        if ( FAILED( hr ) )
-            return hr;
-
-        // TODO: I think we can get init().length. Try again
-
-        // TODO: we only need to hash upto init().length, but we can't get that 
-        //       from the CV debug info. So, hope that the size is the same
-        hash = DHashOf( keyBuf, key._Type->GetSize() );
-        return S_OK;
-    }
-
-    HRESULT DRuntime::GetArrayHash( 
-        const MagoEE::DataObject& key, 
-        HeapPtr& keyBuf, 
-        uint64_t& hash )
-    {
-        _ASSERT( keyBuf.IsEmpty() );
-        _ASSERT( key._Type->IsSArray() || key._Type->IsDArray() );
-
-        HRESULT         hr = S_OK;
-        MagoEE::Address addr = 0;
-        uint32_t        size = 0;
-        RefPtr<MagoEE::Type> elemType;
-        const uint8_t*  buf = NULL;
-
-        elemType = key._Type->AsTypeNext()->GetNext();
-
-        if ( key._Type->IsDArray() && (key.Value.Array.LiteralString != NULL) )
-        {
-            switch ( key.Value.Array.LiteralString->Kind )
-            {
-            case MagoEE::StringKind_Byte:
-                buf = (uint8_t*) ((MagoEE::ByteString*) key.Value.Array.LiteralString)->Str;
-                break;
-            case MagoEE::StringKind_Utf16:
-                buf = (uint8_t*) ((MagoEE::Utf16String*) key.Value.Array.LiteralString)->Str;
-                break;
-            case MagoEE::StringKind_Utf32:
-                buf = (uint8_t*) ((MagoEE::Utf32String*) key.Value.Array.LiteralString)->Str;
-                break;
-            default:
-                _ASSERT( false );
-                return E_UNEXPECTED;
-            }
-
-            size = key.Value.Array.LiteralString->Length * elemType->GetSize();
-        }
-        else
-        {
-            if ( key._Type->IsSArray() )
-            {
-                addr = key.Addr;
-                size = key._Type->GetSize();
-            }
-            else
-            {
-                addr = key.Value.Array.Addr;
-                size = (uint32_t) key.Value.Array.Length * elemType->GetSize();
-            }
-
-            if ( addr == 0 )
-                return E_FAIL;
-
-            keyBuf = (uint8_t*) HeapAlloc( GetProcessHeap(), 0, size );
-            if ( keyBuf.IsEmpty() )
-                return E_OUTOFMEMORY;
-
-            hr = ReadMemory( addr, size, keyBuf );
-            if ( FAILED( hr ) )
-                return hr;
-
-            buf = keyBuf;
-        }
-
-        if ( key._Type->IsSArray() )
-        {
-            uint32_t    length = key._Type->AsTypeSArray()->GetLength();
-            uint32_t    elemSize = elemType->GetSize();
-
-            // TODO: for structs, we only need to hash upto init().length, but we can't 
-            //       get that from the CV debug info. So, hope that the size is the same
-            uint32_t    initSize = elemType->GetSize();
-
-            hash = 0;
-
-            for ( uint32_t i = 0; i < length; i++ )
-            {
-                uint32_t    offset = i * elemSize;
-                uint64_t    elemHash = 0;
-
-                if ( elemType->AsTypeStruct() != NULL )
-                {
-                    elemHash = DHashOf( buf + offset, initSize );
-                }
-                else
-                {
-                    MagoEE::DataValue elem = { 0 };
-
-                    hr = FromRawValue( buf + offset, elemType, elem );
-                    if ( FAILED( hr ) )
-                        return hr;
-
-                    hr = GetHash( elemType, elem, elemHash );
-                    if ( FAILED( hr ) )
-                        return hr;
-                }
-
-                hash += elemHash;
-                if ( mPtrSize == 4 )
-                    hash &= 0xFFFFFFFF;
-            }
-        }
-        else
-        {
-            if ( elemType->IsBasic() && elemType->IsChar() && (elemType->GetSize() == 1) )
-            {
-                hash = 0;
-
-                for ( uint32_t i = 0; i < key.Value.Array.Length; i++ )
-                {
-                    hash = hash * 11 + buf[i];
-                    if ( mPtrSize == 4 )
-                        hash &= 0xFFFFFFFF;
-                }
-            }
-            // TODO: There's a bug in druntime, where the length in elements is used as the size in bytes to hash
-            //       merge the non-basic case into the basic one when it's fixed
-            else if ( elemType->IsBasic() )
-            {
-                hash = DHashOf( buf, size );
-            }
-            else
-            {
-                hash = DHashOf( buf, (uint32_t) key.Value.Array.Length );
-            }
-        }
-
-        return S_OK;
-    }
-
-    bool DRuntime::EqualArray(
-        MagoEE::Type* elemType,
-        uint32_t length,
-        const void* keyBuf, 
-        const void* nodeArrayBuf )
-    {
-        // key and nodeKey array lengths match, because they're the same type
-        uint32_t        size = length * elemType->GetSize();
-
-        if ( elemType->IsIntegral() 
-            || elemType->IsPointer() 
-            || elemType->IsDelegate() )
-        {
-            return memcmp( keyBuf, nodeArrayBuf, size ) == 0;
-        }
-        else if ( elemType->IsFloatingPoint() )
-        {
-            uint32_t    elemSize = elemType->GetSize();
-            EqualsFunc  equals = GetFloatingEqualsFunc( elemType );
-
-            if ( equals == NULL )
-                return false;
-
-            for ( uint32_t i = 0; i < length; i++ )
-            {
-                uint32_t    offset = i * elemSize;
-                if ( !equals( (uint8_t*) keyBuf + offset, (uint8_t*) nodeArrayBuf + offset ) )
-                    return false;
-            }
-
-            return true;
-        }
-        else if ( elemType->AsTypeStruct() != NULL )
-        {
-            // TODO: you have to compare each element
-            //       with structs, only compare upto init().length
-            return memcmp( keyBuf, nodeArrayBuf, size ) == 0;
-        }
-
-        return false;
-    }
-
-    bool DRuntime::EqualSArray(
-        const MagoEE::DataObject& key, 
-        const void* keyBuf, 
-        const void* nodeArrayBuf )
-    {
-        _ASSERT( key._Type->IsSArray() );
-
-        MagoEE::Type*   elemType = key._Type->AsTypeSArray()->GetElement();
-        uint32_t        length = key._Type->AsTypeSArray()->GetLength();
-
-        return EqualArray( elemType, length, keyBuf, nodeArrayBuf );
-    }
-
-    bool DRuntime::EqualDArray( 
-        const MagoEE::DataObject& key, 
-        const void* keyBuf, 
-        HeapPtr& inout_nodeArrayBuf, 
-        const MagoEE::DataValue& nodeKey )
-    {
-        _ASSERT( key._Type->IsDArray() );
-
-        HRESULT         hr = S_OK;
-        MagoEE::Type*   elemType = key._Type->AsTypeDArray()->GetElement();
-        uint32_t        size = (uint32_t) nodeKey.Array.Length * elemType->GetSize();
-        const void*     buf = keyBuf;
-
-        if ( nodeKey.Array.Length != key.Value.Array.Length )
-            return false;
-
-        if ( inout_nodeArrayBuf.IsEmpty() )
-        {
-            inout_nodeArrayBuf = (uint8_t*) HeapAlloc( GetProcessHeap(), 0, size );
-            if ( inout_nodeArrayBuf.IsEmpty() )
-                return false;
-        }
-
-        hr = ReadMemory( nodeKey.Array.Addr, size, inout_nodeArrayBuf );
-        if ( FAILED( hr ) )
-            return false;
-
-        if ( key.Value.Array.LiteralString != NULL )
-        {
-            switch ( key.Value.Array.LiteralString->Kind )
-            {
-            case MagoEE::StringKind_Byte:
-                buf = (uint8_t*) ((MagoEE::ByteString*) key.Value.Array.LiteralString)->Str;
-                break;
-            case MagoEE::StringKind_Utf16:
-                buf = (uint8_t*) ((MagoEE::Utf16String*) key.Value.Array.LiteralString)->Str;
-                break;
-            case MagoEE::StringKind_Utf32:
-                buf = (uint8_t*) ((MagoEE::Utf32String*) key.Value.Array.LiteralString)->Str;
-                break;
-            default:
-                _ASSERT( false );
-                return false;
-            }
-        }
-
-        return EqualArray( elemType, (uint32_t) nodeKey.Array.Length, buf, inout_nodeArrayBuf );
-    }
-
-    bool DRuntime::EqualStruct(
-        const MagoEE::DataObject& key, 
-        const void* keyBuf, 
-        const void* nodeArrayBuf )
-    {
-        // we would also check and run TypeInfo_Struct.xopCmp, if we supported func eval
-        // TODO: actually, you have to compare upto init().length
-        return memcmp( keyBuf, nodeArrayBuf, key._Type->GetSize() ) == 0;
-    }
-
-    // mix hash to "fix" bad hash functions
-    static uint64_t mix( uint64_t h, uint32_t ptrSize )
-    {
-        // final mix function of MurmurHash2
-        static const uint64_t m = 0x5bd1e995;
-        h ^= h >> 13;
-        h *= m;
-        if ( ptrSize == 4 )
-            h &= 0xffffffff;
-        h ^= h >> 15;
-        return h;
-    }
-
     HRESULT DRuntime::GetValue(
+        MagoEE::IValueBinder* binder, 
         MagoEE::Address aArrayAddr, 
         const MagoEE::DataObject& key, 
         MagoEE::Address& valueAddr )
     {
-        HRESULT     hr = S_OK;
-        BB64        bb = { 0 };
-        BB64_V1     bb_v1 = { 0 };
-        uint64_t    hash = 0;
-        HeapPtr     keyBuf;
+        GuardedArea guard( mAALookupGuard );
 
-        hr = ReadBB( aArrayAddr, bb, bb_v1 );
-        if ( FAILED( hr ) )
-            return hr;
+        HRESULT     hr = S_OK;
+        int         aaVersion = mAAVersion;
 
-        if ( mAAVersion != 1 && ( (bb.b.ptr == 0) || (bb.b.length == 0) ) )
-            return E_FAIL;
-        if ( mAAVersion == 1 && ( (bb_v1.buckets.ptr == 0) || (bb_v1.buckets.length == 0) ) )
-            return E_FAIL;
+        hr = mAALookup.FindValue( binder, aArrayAddr, aaVersion, key, valueAddr );
 
-        if ( key._Type->AsTypeStruct() != NULL )
+        if ( (mAAVersion == -1) && (aaVersion != -1) )
         {
-            // TODO: fails for mAAVersion == 1, no TypeInfo for key
-            hr = GetStructHash( key, bb, keyBuf, hash );
-            if ( FAILED( hr ) )
-                return hr;
-        }
-        else if ( key._Type->IsSArray() || key._Type->IsDArray() )
-        {
-            hr = GetArrayHash( key, keyBuf, hash );
-            if ( FAILED( hr ) )
-                return hr;
+            // On x86, uninitialized arrays likely look like the old layout, 
+            // so better don't remember it. Only a power of 2 buckets is sure.
+            if ( (aaVersion == 1) || (mPtrSize != 4) )
+                mAAVersion = aaVersion;
         }
-        else
-        {
-            hr = GetHash( key._Type, key.Value, hash );
-            if ( FAILED( hr ) )
-                return hr;
-        }
-
-        if ( mAAVersion == 1 )
-            hr = FindValue_V1( bb_v1, hash, key, keyBuf.Ref(), valueAddr );
-        else
-            hr = FindValue( bb, hash, key, keyBuf.Ref(), valueAddr );
 
         return hr;
     }
 
-    HRESULT DRuntime::FindValue( 
-        BB64& bb, 
-        uint64_t hash,
-        const MagoEE::DataObject& key, 
-        uint8_t*& keyBuf,
-        MagoEE::Address& valueAddr )
-    {
-        const int MAX_AA_SEARCH_NODES = 1000000;
-        const int AAA_BUF_SIZE = sizeof( aaA64 ) + 4 * sizeof( MagoEE::DataValue );
-
-        uint64_t    aaaBuf[ (AAA_BUF_SIZE + sizeof( uint64_t )-1) / sizeof( uint64_t ) ] = { 0 };
-        aaAUnion*   aaa = (aaAUnion*) aaaBuf;
-
-        uint64_t    bucketIndex = hash % bb.b.length;
-        uint64_t    aaAAddr = 0;
-        uint32_t    lenToRead = key._Type->GetSize();
-        uint32_t    lenBeforeValue = AlignTSize( key._Type->GetSize() );
-        HeapPtr     nodeBuf;
-        HeapPtr     nodeArrayBuf;
-
-        if ( mPtrSize == 4 )
-        {
-            lenToRead += sizeof( aaA32 );
-            lenBeforeValue += sizeof( aaA32 );
-        }
-        else
-        {
-            lenToRead += sizeof( aaA64 );
-            lenBeforeValue += sizeof( aaA64 );
-        }
-
-        if ( lenToRead > sizeof aaaBuf )
-        {
-            nodeBuf = (uint8_t*) HeapAlloc( GetProcessHeap(), 0, lenToRead );
-            if ( nodeBuf.IsEmpty() )
-                return E_OUTOFMEMORY;
-
-            aaa = (aaAUnion*) nodeBuf.Get();
-        }
-
-        HRESULT hr = ReadAddress( bb.b.ptr, bucketIndex, aaAAddr );
-        if ( FAILED( hr ) )
-            return hr;
-
-        valueAddr = 0;
-
-        for ( int i = 0; (i < MAX_AA_SEARCH_NODES) && (aaAAddr != 0); i++ )
-        {
-            MagoEE::DataValue nodeKey = { 0 };
-            bool     found = false;
-            uint64_t aaaHash;
-            uint64_t aaaNext;
-            void*    pAaaKey;
-
-            hr = ReadMemory( aaAAddr, lenToRead, aaa );
-            if ( FAILED( hr ) )
-                return hr;
-
-            if ( mPtrSize == 4 )
-            {
-                aaaHash = aaa->_32.hash;
-                aaaNext = aaa->_32.next;
-                pAaaKey = &aaa->_32 + 1;
-            }
-            else
-            {
-                aaaHash = aaa->_64.hash;
-                aaaNext = aaa->_64.next;
-                pAaaKey = &aaa->_64 + 1;
-            }
-
-            if ( aaaHash == hash )
-            {
-                if ( key._Type->AsTypeStruct() != NULL )
-                {
-                    found = EqualStruct( key, keyBuf, pAaaKey );
-                }
-                else if ( key._Type->IsSArray() )
-                {
-                    found = EqualSArray( key, keyBuf, pAaaKey );
-                }
-                else if ( key._Type->IsDArray() )
-                {
-                    hr = FromRawValue( pAaaKey, key._Type, nodeKey );
-                    if ( FAILED( hr ) )
-                        return hr;
-
-                    found = EqualDArray( key, keyBuf, nodeArrayBuf, nodeKey );
-                }
-                else
-                {
-                    hr = FromRawValue( pAaaKey, key._Type, nodeKey );
-                    if ( FAILED( hr ) )
-                        return hr;
-
-                    found = EqualValue( key._Type, key.Value, nodeKey );
-                }
-            }
-
-            if ( found )
-            {
-                valueAddr = aaAAddr + lenBeforeValue;
-                break;
-            }
-
-            aaAAddr = aaaNext;
-        }
-
-        if ( valueAddr == 0 )
-            return E_NOT_FOUND;
-
-        return S_OK;
-    }
-
-    HRESULT DRuntime::FindValue_V1( 
-        BB64_V1& bb, 
-        uint64_t hash,
-        const MagoEE::DataObject& key, 
-        uint8_t*& keyBuf,
-        MagoEE::Address& valueAddr )
-    {
-        uint64_t hashFilledMark = 1LL << (8 * mPtrSize - 1);
-        hash = ( mix( hash, mPtrSize ) & ( hashFilledMark - 1 ) ) | hashFilledMark;
-
-        const int MAX_AA_SEARCH_NODES = 1000000;
-        const int AAA_BUF_SIZE = sizeof( aaA64 ) + 4 * sizeof( MagoEE::DataValue );
-
-        const int HASH_EMPTY = 0;
-        //const int HASH_DELETED = 0x1;
-
-        uint64_t    aaaBuf[ (AAA_BUF_SIZE + sizeof( uint64_t )-1) / sizeof( uint64_t ) ] = { 0 };
-        aaAUnion*   aaa = (aaAUnion*) aaaBuf;
-
-        uint64_t    bucketIndex = hash % bb.buckets.length;
-        uint64_t    aaAAddr = 0;
-        HeapPtr     nodeBuf;
-        HeapPtr     nodeArrayBuf;
-
-        if ( bb.keysz > sizeof aaaBuf )
-        {
-            nodeBuf = (uint8_t*) HeapAlloc( GetProcessHeap(), 0, bb.keysz );
-            if ( nodeBuf.IsEmpty() )
-                return E_OUTOFMEMORY;
-
-            aaa = (aaAUnion*) nodeBuf.Get();
-        }
-
-        valueAddr = 0;
-
-        for ( int j = 0; j < MAX_AA_SEARCH_NODES; bucketIndex = ( bucketIndex + ++j ) % bb.buckets.length )
-        {
-            uint64_t    bucketHash;
-            HRESULT hr = ReadAddress( bb.buckets.ptr, 2 * bucketIndex, bucketHash );
-            if ( FAILED( hr ) )
-                return hr;
-
-            if ( bucketHash == HASH_EMPTY )
-                break;
-
-            if ( bucketHash != hash )
-                continue;
-
-            hr = ReadAddress( bb.buckets.ptr, 2 * bucketIndex + 1, aaAAddr );
-            if ( FAILED( hr ) )
-                return hr;
-
-            MagoEE::DataValue nodeKey = { 0 };
-            bool     found = false;
-
-            hr = ReadMemory( aaAAddr, bb.keysz, aaa );
-            if ( FAILED( hr ) )
-                return hr;
-
-            if ( key._Type->AsTypeStruct() != NULL )
-            {
-                found = EqualStruct( key, keyBuf, aaa );
-            }
-            else if ( key._Type->IsSArray() )
-            {
-                found = EqualSArray( key, keyBuf, aaa );
-            }
-            else if ( key._Type->IsDArray() )
-            {
-                hr = FromRawValue( aaa, key._Type, nodeKey );
-                if ( FAILED( hr ) )
-                    return hr;
-
-                found = EqualDArray( key, keyBuf, nodeArrayBuf, nodeKey );
-            }
-            else
-            {
-                hr = FromRawValue( aaa, key._Type, nodeKey );
-                if ( FAILED( hr ) )
-                    return hr;
-
-                found = EqualValue( key._Type, key.Value, nodeKey );
-            }
-
-            if ( found )
-            {
-                valueAddr = aaAAddr + bb.valoff;
-                break;
-            }
-        }
-
-        if ( valueAddr == 0 )
-            return E_NOT_FOUND;
-
-        return S_OK;
-    }
-
     HRESULT DRuntime::ReadMemory( MagoEE::Address addr, uint32_t sizeToRead, void* buffer )
     {
         HRESULT         hr = S_OK;
@@ -715,133 +76,34 @@ namespace Mago
         return S_OK;
     }
 
-    HRESULT DRuntime::ReadBB( Address64 address, BB64& bb, BB64_V1& bb_v1 )
+    HRESULT DRuntime::ReadMemory( MagoEE::Address addr, uint32_t sizeToRead, uint32_t& sizeRead, uint8_t* buffer )
     {
-        HRESULT hr = S_OK;
-
-        if ( mPtrSize == 4 )
-        {
-            BB32    bb32;
-            BB32_V1 bb32_v1;
-
-            if ( mAAVersion == 1 )
-                hr = ReadMemory( address, sizeof bb32_v1, &bb32_v1 );
-            else
-                hr = ReadMemory( address, sizeof bb32, &bb32 );
-            if ( FAILED( hr ) )
-                return hr;
-
-            if ( mAAVersion == -1 )
-            {
-                if ( bb32.b.length > 4 && ( bb32.b.length & ( bb32.b.length - 1 ) ) == 0 )
-                {
-                    mAAVersion = 1; // power of 2 indicates new AA
-                    hr = ReadMemory( address, sizeof bb32_v1, &bb32_v1 );
-                    if ( FAILED( hr ) )
-                        return hr;
-                }
-                else
-                {
-                    // uninitialized arrays likely hit this case, so better don't remmeber
-                    // mAAVersion = 0;
-                }
-            }
-
-            if ( mAAVersion == 1 )
-            {
-                bb_v1.buckets.length = bb32_v1.buckets.length;
-                bb_v1.buckets.ptr = bb32_v1.buckets.ptr;
-                bb_v1.used = bb32_v1.used;
-                bb_v1.deleted = bb32_v1.deleted;
-                bb_v1.entryTI = bb32_v1.entryTI;
-                bb_v1.firstUsed = bb32_v1.firstUsed;
-                bb_v1.keysz = bb32_v1.keysz;
-                bb_v1.valsz = bb32_v1.valsz;
-                bb_v1.valoff = bb32_v1.valoff;
-                bb_v1.flags = bb32_v1.flags;
-            }
-            else
-            {
-                if ( bb32.firstUsedBucket > bb32.nodes )
-                {
-                    bb32.keyti = bb32.firstUsedBucket; // compatibility fix for dmd before 2.067
-                    bb32.firstUsedBucket = 0;
-                }
-                bb.b.length = bb32.b.length;
-                bb.b.ptr = bb32.b.ptr;
-                bb.firstUsedBucket = bb32.firstUsedBucket;
-                bb.keyti = bb32.keyti;
-                bb.nodes = bb32.nodes;
-            }
-        }
-        else
-        {
-            if ( mAAVersion == 1 )
-                hr = ReadMemory( address, sizeof bb_v1, &bb_v1 );
-            else
-                hr = ReadMemory( address, sizeof bb, &bb );
-
-            if ( FAILED( hr ) )
-                return hr;
-
-            if ( mAAVersion == -1 )
-            {
-                if ( bb.b.length > 4 && ( bb.b.length & ( bb.b.length - 1 ) ) == 0 )
-                {
-                    mAAVersion = 1; // power of 2 indicates new AA
-                    hr = ReadMemory( address, sizeof bb_v1, &bb_v1 );
-                    if ( FAILED( hr ) )
-                        return hr;
-                }
-                else
-                {
-                    mAAVersion = 0;
-                }
-            }
-
-            if ( mAAVersion == 0 && bb.firstUsedBucket > bb.nodes )
-            {
-                bb.keyti = bb.firstUsedBucket; // compatibility fix for dmd before 2.067
-                bb.firstUsedBucket = 0;
-            }
-        }
+        uint32_t        lenUnreadable = 0;
 
-        return S_OK;
+        return mDebugger->ReadMemory(
+            mCoreProc.Get(),
+            (Address64) addr,
+            sizeToRead,
+            sizeRead,
+            lenUnreadable,
+            buffer );
     }
 
-    HRESULT DRuntime::ReadTypeInfoStruct( Address64 addr, TypeInfo_Struct64& ti )
+    HRESULT DRuntime::ReadMemory( MagoEE::MemoryRead* reads, uint32_t count )
     {
-        HRESULT hr = S_OK;
+        HRESULT             hr = S_OK;
+        MagoEE::ReadPlan    plan;
+        uint32_t            totalRead = 0;
 
-        if ( mPtrSize == 4 )
-        {
-            TypeInfo_Struct32   ti32;
+        hr = plan.Read( this, reads, count );
+        if ( FAILED( hr ) )
+            return hr;
 
-            hr = ReadMemory( addr, sizeof ti32, &ti32 );
-            if ( FAILED( hr ) )
-                return hr;
+        for ( uint32_t i = 0; i < count; i++ )
+            totalRead += reads[i].SizeRead;
 
-            ti.vptr = ti32.vptr;
-            ti.monitor = ti32.monitor;
-            ti.name.length = ti32.name.length;
-            ti.name.ptr = ti32.name.ptr;
-            ti.m_init.length = ti32.m_init.length;
-            ti.m_init.ptr = ti32.m_init.ptr;
-            ti.m_align = ti32.m_align;
-            ti.m_flags = ti32.m_flags;
-            ti.xdtor = ti32.xdtor;
-            ti.xopCmp = ti32.xopCmp;
-            ti.xopEquals = ti32.xopEquals;
-            ti.xpostblit = ti32.xpostblit;
-            ti.xtoHash = ti32.xtoHash;
-            ti.xtoString = ti32.xtoString;
-        }
-        else
-        {
-            hr = ReadMemory( addr, sizeof ti, &ti );
-            if ( FAILED( hr ) )
-                return hr;
-        }
+        if ( (count > 0) && (totalRead == 0) )
+            return HRESULT_FROM_WIN32( ERROR_PARTIAL_COPY );
 
         return S_OK;
     }
@@ -1061,7 +323,6 @@ namespace Mago
         _ASSERT( pbstrInfo != NULL );
 
         Throwable64 throwable;
-        uint32_t read, unread;
         HRESULT hr = S_OK;
     
         hr = ReadThrowable( addr, throwable );
@@ -1077,29 +338,42 @@ namespace Mago
         else
         {
             CAutoVectorPtr<char>    buf;
+            CAutoVectorPtr<char>    text;
             if ( !buf.Allocate( (size_t) (throwable.msg.length + throwable.file.length + 30) ) )
                 return E_OUTOFMEMORY;
+            if ( !text.Allocate( (size_t) (throwable.msg.length + throwable.file.length + 1) ) )
+                return E_OUTOFMEMORY;
+
+            // the message and the file name are often next to each other in 
+            // the data section, so ask for them together
+            MagoEE::MemoryRead  reads[2] = { 0 };
+            reads[0].Addr = throwable.msg.ptr;
+            reads[0].Size = (uint32_t) throwable.msg.length;
+            reads[0].Buffer = (uint8_t*) text.m_p;
+            reads[1].Addr = throwable.file.ptr;
+            reads[1].Size = (uint32_t) throwable.file.length;
+            reads[1].Buffer = (uint8_t*) text.m_p + throwable.msg.length;
+
+            hr = ReadMemory( reads, _countof( reads ) );
+            if ( FAILED( hr ) )
+                reads[0].SizeRead = reads[1].SizeRead = 0;
+
             char* p = buf;
-            if ( throwable.msg.length > 0 )
+            if ( reads[0].SizeRead > 0 )
             {
-                hr = mDebugger->ReadMemory( mCoreProc, throwable.msg.ptr, (uint32_t) throwable.msg.length, 
-                                            read, unread, (uint8_t*) p );
-                if ( SUCCEEDED( hr ) )
-                {
-                    p += read;    // read at most throwable.msg.length
-                    *p++ = ' ';
-                }
+                memcpy( p, reads[0].Buffer, reads[0].SizeRead );
+                p += reads[0].SizeRead;    // read at most throwable.msg.length
+                *p++ = ' ';
             }
             if ( throwable.file.length > 0 )
             {
                 *p++ = 'a';
                 *p++ = 't';
                 *p++ = ' ';
-                hr = mDebugger->ReadMemory( mCoreProc, throwable.file.ptr, (uint32_t) throwable.file.length, 
-                                            read, unread, (uint8_t*) p );
-                if ( SUCCEEDED( hr ) )
+                if ( reads[1].SizeRead > 0 )
                 {
-                    p += read;    // read at most throwable.file.length
+                    memcpy( p, reads[1].Buffer, reads[1].SizeRead );
+                    p += reads[1].SizeRead;    // read at most throwable.file.length
                     *p++ = '(';
                     p += sprintf_s( p, 12, "%d", (uint32_t) throwable.line );
                     *p++ = ')';
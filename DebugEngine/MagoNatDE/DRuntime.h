@@ -10,8 +10,6 @@
 #include <MagoEED.h>
 
 
-struct BB64;
-struct TypeInfo_Struct64;
 struct DArray64;
 
 
@@ -22,12 +20,16 @@ namespace Mago
     struct Throwable64;
 
 
-    class DRuntime
+    class DRuntime : private MagoEE::IMemoryReader
     {
         IDebuggerProxy*         mDebugger;
         RefPtr<ICoreProcess>    mCoreProc;
         int                     mPtrSize;
         int                     mAAVersion;
+        // keeps its buffers from one lookup to the next, so it's only used
+        // by one at a time
+        MagoEE::AArrayLookup    mAALookup;
+        Guard                   mAALookupGuard;
 
     public:
         DRuntime( IDebuggerProxy* debugger, ICoreProcess* coreProcess );
@@ -35,7 +37,10 @@ namespace Mago
         void SetAAVersion( int ver );
         int GetAAVersion() const { return mAAVersion; }
 
+        // Finds the value for key in an associative array, reading memory 
+        // through binder.
         virtual HRESULT GetValue(
+            MagoEE::IValueBinder* binder, 
             MagoEE::Address aArrayAddr, 
             const MagoEE::DataObject& key, 
             MagoEE::Address& valueAddr );
@@ -45,60 +50,17 @@ namespace Mago
         HRESULT GetExceptionInfo( Address64 addr, BSTR* pbstrInfo );
 
     private:
-        HRESULT GetStructHash( 
-            const MagoEE::DataObject& key, 
-            const BB64& bb, 
-            // To hash a struct, we need to read the key memory into a buffer.
-            // Return it, because the caller needs it, too.
-            HeapPtr& keyBuf,
-            uint64_t& hash );
-
-        HRESULT GetArrayHash( 
-            const MagoEE::DataObject& key, 
-            // To hash an array, we need to read the key memory into a buffer.
-            // Return it, because the caller needs it, too.
-            HeapPtr& keyBuf,
-            uint64_t& hash );
-
-        bool EqualArray(
-            MagoEE::Type* elemType,
-            uint32_t length,
-            const void* keyBuf, 
-            const void* nodeArrayBuf );
-
-        bool EqualSArray(
-            const MagoEE::DataObject& key, 
-            const void* keyBuf, 
-            const void* nodeArrayBuf );
-
-        bool EqualDArray(
-            const MagoEE::DataObject& key, 
-            const void* keyBuf, 
-            HeapPtr& inout_nodeArrayBuf, 
-            const MagoEE::DataValue& nodeKey );
-
-        bool EqualStruct(
-            const MagoEE::DataObject& key, 
-            const void* keyBuf, 
-            const void* nodeArrayBuf );
-
-        HRESULT GetHash( MagoEE::Type* type, const MagoEE::DataValue& value, uint64_t& hash );
-        uint64_t DHashOf( const void* buffer, uint32_t length );
-        uint32_t AlignTSize( uint32_t size );
-
         HRESULT ReadMemory( MagoEE::Address addr, uint32_t sizeToRead, void* buffer );
+        // reads the pieces that are close together as one block; sets how
+        // much of each one was read, and only fails if none of them could be
+        HRESULT ReadMemory( MagoEE::MemoryRead* reads, uint32_t count );
+        // IMemoryReader, for the ReadPlan of the one above
+        virtual HRESULT ReadMemory( MagoEE::Address addr, uint32_t sizeToRead, uint32_t& sizeRead, uint8_t* buffer );
 
-        HRESULT ReadBB( Address64 addr, BB64& bb, BB64_V1& bb_v1 );
-        HRESULT ReadTypeInfoStruct( Address64 addr, TypeInfo_Struct64& ti );
         HRESULT ReadAddress( Address64 baseAddr, uint64_t index, uint64_t& ptrValue );
         HRESULT ReadDArray( Address64 addr, DArray64& darray );
         HRESULT ReadThrowable( Address64 addr, Throwable64& throwable );
 
-        HRESULT FindValue( BB64& bb, uint64_t hash, 
-                           const MagoEE::DataObject& key, uint8_t*& keybuf, MagoEE::Address& valueAddr );
-        HRESULT FindValue_V1( BB64_V1& bb, uint64_t hash, 
-                              const MagoEE::DataObject& key, uint8_t*& keybuf, MagoEE::Address& valueAddr );
-
         DRuntime& operator=( const DRuntime& other );
         DRuntime( const DRuntime& other );
     };
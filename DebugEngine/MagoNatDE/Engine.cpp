@@ -62,11 +62,16 @@ namespace Mago
         if ( FAILED( hr ) )
             return hr;
 
+        hr = mSymLoader.Init( callback.Get() );
+        if ( FAILED( hr ) )
+            return hr;
+
         return hr;
     }
 
     void Engine::FinalRelease()
     {
+        mSymLoader.Shutdown();
     }
 
 
@@ -731,6 +736,7 @@ Error:
 
         mDebugger.Shutdown();
         mRemoteDebugger->Shutdown();
+        mSymLoader.Shutdown();
         // TODO: this should probably be guarded, too
 
         for ( BPMap::iterator it = mBPs.begin();
@@ -827,6 +833,11 @@ Error:
         return hr;
     }
 
+    HRESULT Engine::QueueSymbolLoad( Program* prog, Module* mod )
+    {
+        return mSymLoader.Queue( prog, mod );
+    }
+
     HRESULT Engine::UnbindPendingBPsFromModule( Module* mod, Program* prog )
     {
         _ASSERT( mod != NULL );
@@ -14,6 +14,7 @@
 #include "DebuggerProxy.h"
 #include "RemoteDebuggerProxy.h"
 #include "ExceptionTable.h"
+#include "SymbolLoader.h"
 
 namespace Mago
 {
@@ -33,6 +34,7 @@ namespace Mago
 
         DebuggerProxy       mDebugger;
         RefPtr<RemoteDebuggerProxy> mRemoteDebugger;
+        SymbolLoader        mSymLoader;
         bool                mPollThreadStarted;
         bool                mSentEngineCreate;
         ProgramMap          mProgs;
@@ -142,6 +144,9 @@ namespace Mago
         HRESULT BindPendingBPsToModule( Module* mod, Program* prog );
         HRESULT UnbindPendingBPsFromModule( Module* mod, Program* prog );
 
+        // Returns S_FALSE if the caller has to load the symbols itself.
+        HRESULT QueueSymbolLoad( Program* prog, Module* mod );
+
         void BeginBindBP();
         void EndBindBP();
 
@@ -184,10 +184,8 @@ namespace Mago
         OutputDebugStringA( "EventCallback::OnModuleLoad\n" );
 
         HRESULT     hr = S_OK;
-        RefPtr<ModuleLoadEvent>     event;
         RefPtr<Program>             prog;
         RefPtr<Module>              mod;
-        CComPtr<IDebugModule2>      mod2;
 
         if ( !mEngine->FindProgram( uniquePid, prog ) )
             return;
@@ -200,6 +198,19 @@ namespace Mago
         if ( FAILED( hr ) )
             return;
 
+        // No code in the module runs before the loader breakpoint, so until 
+        // then, its symbols can be loaded and its breakpoints bound later.
+
+        if ( !prog->GetLoadCompleted() )
+        {
+            hr = mEngine->QueueSymbolLoad( prog.Get(), mod.Get() );
+            if ( hr == S_OK )
+            {
+                SendModuleLoadEvent( prog.Get(), mod.Get() );
+                return;
+            }
+        }
+
         hr = mod->LoadSymbols( false );
         // later we'll check if symbols were loaded
 
@@ -207,6 +218,43 @@ namespace Mago
 
         hr = mEngine->BindPendingBPsToModule( mod.Get(), prog.Get() );
 
+        SendModuleLoadEvent( prog.Get(), mod.Get() );
+        SendSymbolSearchEvent( prog.Get(), mod.Get() );
+    }
+
+    void EventCallback::OnSymbolsLoaded( Program* prog, Module* mod )
+    {
+        RefPtr<Program>             curProg;
+        RefPtr<Module>              curMod;
+        bool                        loaded = false;
+
+        mEngine->BeginBindBP();
+
+        // the module could have been unloaded while its symbols were loading
+        if ( mEngine->FindProgram( prog->GetCoreProcess()->GetPid(), curProg ) 
+            && (curProg.Get() == prog)
+            && prog->FindModule( mod->GetAddress(), curMod )
+            && (curMod.Get() == mod) )
+        {
+            loaded = true;
+
+            prog->UpdateAAVersion( mod );
+
+            mEngine->BindPendingBPsToModule( mod, prog );
+        }
+
+        mEngine->EndBindBP();
+
+        if ( loaded )
+            SendSymbolSearchEvent( prog, mod );
+    }
+
+    void EventCallback::SendModuleLoadEvent( Program* prog, Module* mod )
+    {
+        HRESULT     hr = S_OK;
+        RefPtr<ModuleLoadEvent>     event;
+        CComPtr<IDebugModule2>      mod2;
+
         hr = MakeCComObject( event );
         if ( FAILED( hr ) )
             return;
@@ -218,10 +266,12 @@ namespace Mago
         // TODO: message
         event->Init( mod2, NULL, true );
 
-        SendEvent( event.Get(), prog.Get(), NULL );
-
-        //-------------------------
+        SendEvent( event.Get(), prog, NULL );
+    }
 
+    void EventCallback::SendSymbolSearchEvent( Program* prog, Module* mod )
+    {
+        HRESULT     hr = S_OK;
         RefPtr<SymbolSearchEvent>       symEvent;
         CComPtr<IDebugModule3>          mod3;
         MODULE_INFO_FLAGS               flags = 0;
@@ -247,7 +297,7 @@ namespace Mago
 
         symEvent->Init( mod3, msg.m_str, flags );
 
-        hr = SendEvent( symEvent.Get(), prog.Get(), NULL );
+        hr = SendEvent( symEvent.Get(), prog, NULL );
     }
 
     void EventCallback::OnModuleUnloadInternal( DWORD uniquePid, Address64 baseAddr )
@@ -317,20 +367,10 @@ namespace Mago
         if ( !mainMod->GetSymbolSession( session ) )
             return false;
 
-        MagoST::EnumNamedSymbolsData enumData = { 0 };
-
-        hr = session->FindFirstSymbol( MagoST::SymHeap_GlobalSymbols, symbol, strlen(symbol), enumData );
-        if ( hr != S_OK )
-            hr = session->FindFirstSymbol( MagoST::SymHeap_StaticSymbols, symbol, strlen(symbol), enumData );
-        if ( hr != S_OK )
-            hr = session->FindFirstSymbol( MagoST::SymHeap_PublicSymbols, symbol, strlen(symbol), enumData );
-        if ( hr != S_OK )
-            return false;
-
         MagoST::SymHandle handle;
 
-        hr = session->GetCurrentSymbol( enumData, handle );
-        if ( FAILED( hr ) )
+        hr = session->FindGlobalSymbol( symbol, strlen(symbol), handle );
+        if ( hr != S_OK )
             return false;
 
         MagoST::SymInfoData infoData = { 0 };
@@ -375,6 +415,12 @@ namespace Mago
         if ( !prog->FindThread( threadId, thread ) )
             return;
 
+        // Module code is about to run, so the breakpoints bound by the 
+        // symbol loader threads have to be in place. Later modules are 
+        // loaded right away.
+        prog->SetLoadCompleted();
+        prog->WaitForSymbolLoads();
+
         hr = MakeCComObject( event );
         if ( FAILED( hr ) )
             return;
@@ -16,6 +16,7 @@ namespace Mago
     class EventBase;
     class ICoreThread;
     class ICoreModule;
+    class Module;
 
 
     class EventCallback
@@ -48,6 +49,9 @@ namespace Mago
         virtual ProbeRunMode OnCallProbe( 
             DWORD uniquePid, uint32_t threadId, Address64 address, AddressRange64& thunkRange );
 
+        // called on a symbol loader thread
+        void OnSymbolsLoaded( Program* program, Module* module );
+
     private:
         HRESULT SendEvent( EventBase* eventBase, Program* program, Thread* thread );
 
@@ -59,5 +63,8 @@ namespace Mago
 
         virtual void OnModuleLoadInternal( DWORD uniquePid, ICoreModule* module );
         virtual void OnModuleUnloadInternal( DWORD uniquePid, Address64 baseAddr );
+
+        void SendModuleLoadEvent( Program* program, Module* module );
+        void SendSymbolSearchEvent( Program* program, Module* module );
     };
 }
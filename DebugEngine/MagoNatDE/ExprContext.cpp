@@ -40,7 +40,8 @@ namespace Mago
     // ExprContext
 
     ExprContext::ExprContext()
-        :   mPC( 0 )
+        :   mPC( 0 ),
+            mDisposed( false )
     {
         memset( &mFuncSH, 0, sizeof mFuncSH );
     }
@@ -71,25 +72,43 @@ namespace Mago
         HRESULT hr = S_OK;
         RefPtr<Expr>    expr;
         RefPtr<MagoEE::IEEDParsedExpr>  parsedExpr;
+        RefPtr<MagoST::ISession>        session;
+        DWORD               threadId = mThread->GetCoreThread()->GetTid();
+        int                 ptrSize = mThread->GetCoreProcess()->GetArchData()->GetPointerSize();
+        MagoST::SymHandle   blockSH = { 0 };
 
         hr = MakeCComObject( expr );
         if ( FAILED( hr ) )
             return hr;
 
-        hr = MagoEE::EED::ParseText( pszCode, mTypeEnv, mStrTable, parsedExpr.Ref() );
-        if ( FAILED( hr ) )
+        if ( mBlockSH.size() > 0 )
+            blockSH = mBlockSH.back();
+
+        // only the evaluation is left when the module already bound the same 
+        // text in the same scope
+        if ( !mModule->FindCachedExpr( pszCode, threadId, ptrSize, mFuncSH, blockSH, parsedExpr ) )
         {
-            MagoEE::EED::GetErrorString( hr, *pbstrError );
-            return hr;
-        }
+            // without symbols there's nothing to cache against
+            mModule->GetSymbolSession( session );
 
-        MagoEE::EvalOptions options = { 0 };
+            hr = MagoEE::EED::ParseText( pszCode, mTypeEnv, mStrTable, parsedExpr.Ref() );
+            if ( FAILED( hr ) )
+            {
+                MagoEE::EED::GetErrorString( hr, *pbstrError );
+                return hr;
+            }
 
-        hr = parsedExpr->Bind( options, this );
-        if ( FAILED( hr ) )
-        {
-            MagoEE::EED::GetErrorString( hr, *pbstrError );
-            return hr;
+            MagoEE::EvalOptions options = { 0 };
+
+            hr = parsedExpr->Bind( options, this );
+            if ( FAILED( hr ) )
+            {
+                MagoEE::EED::GetErrorString( hr, *pbstrError );
+                return hr;
+            }
+
+            if ( session != NULL )
+                mModule->CacheExpr( session, pszCode, threadId, ptrSize, mFuncSH, blockSH, parsedExpr );
         }
 
         hr = expr->Init( parsedExpr, pszCode, this );
@@ -124,18 +143,109 @@ namespace Mago
     HRESULT ExprContext::FindObject( 
         const wchar_t* name, 
         MagoEE::Declaration*& decl )
+    {
+        HRESULT hr = S_OK;
+        RefPtr<MagoST::ISession>    session;
+        RefPtr<MagoEE::Declaration> newDecl;
+
+        if ( !mModule->GetSymbolSession( session ) )
+            return E_NOT_FOUND;
+
+        if ( FindCachedDeclaration( session, name, decl ) )
+        {
+            if ( decl == NULL )
+                return E_NOT_FOUND;
+
+            return S_OK;
+        }
+
+        hr = MakeDeclarationFromName( name, newDecl.Ref() );
+        if ( hr == E_NOT_FOUND )
+        {
+            CacheDeclaration( session, name, NULL );
+            return hr;
+        }
+        if ( FAILED( hr ) )
+            return hr;
+
+        CacheDeclaration( session, name, newDecl );
+
+        decl = newDecl.Detach();
+        return S_OK;
+    }
+
+    bool ExprContext::FindCachedDeclaration( 
+        MagoST::ISession* session, 
+        const wchar_t* name, 
+        MagoEE::Declaration*& decl )
+    {
+        GuardedArea guard( mDeclCacheGuard );
+
+        // the symbols were reloaded, so start over
+        if ( session != mDeclCacheSession.Get() )
+            return false;
+
+        DeclCache::iterator it = mDeclCache.find( name );
+        if ( it == mDeclCache.end() )
+            return false;
+
+        decl = it->second;
+        if ( decl != NULL )
+            decl->AddRef();
+
+        return true;
+    }
+
+    void ExprContext::CacheDeclaration( 
+        MagoST::ISession* session, 
+        const wchar_t* name, 
+        MagoEE::Declaration* decl )
+    {
+        DeclCache   oldDecls;
+
+        // the name is filled in lazily, so fill it in while the declaration 
+        // is still only seen by this thread
+        if ( decl != NULL )
+            decl->GetName();
+
+        GuardedArea guard( mDeclCacheGuard );
+
+        if ( mDisposed )
+            return;
+
+        if ( session != mDeclCacheSession.Get() )
+        {
+            oldDecls.swap( mDeclCache );
+            mDeclCacheSession = session;
+        }
+
+        mDeclCache[name] = decl;
+    }
+
+    void ExprContext::Dispose()
+    {
+        DeclCache   oldDecls;
+
+        {
+            GuardedArea guard( mDeclCacheGuard );
+
+            mDisposed = true;
+            oldDecls.swap( mDeclCache );
+            mDeclCacheSession.Release();
+        }
+    }
+
+    HRESULT ExprContext::MakeDeclarationFromName( 
+        const wchar_t* name, 
+        MagoEE::Declaration*& decl )
     {
         HRESULT hr = S_OK;
         CAutoVectorPtr<char>        u8Name;
         size_t                      u8NameLen = 0;
         MagoST::SymHandle           symHandle = { 0 };
-        RefPtr<MagoST::ISession>    session;
         RefPtr<MagoEE::Declaration> origDecl;
         MagoEE::UdtKind             udtKind = MagoEE::Udt_Struct;
 
-        if ( !mModule->GetSymbolSession( session ) )
-            return E_NOT_FOUND;
-
         hr = Utf16To8( name, wcslen( name ), u8Name.m_p, u8NameLen );
         if ( FAILED( hr ) )
             return hr;
@@ -465,7 +575,7 @@ namespace Mago
         if ( lenRead < targetSize )
             return HRESULT_FROM_WIN32( ERROR_PARTIAL_COPY );
 
-        return FromRawValue( targetBuf, type, value );
+        return ::FromRawValue( targetBuf, type, value );
     }
 
     HRESULT ExprContext::GetValue(
@@ -476,7 +586,7 @@ namespace Mago
         Program* prog = mThread->GetProgram();
         DRuntime* druntime = prog->GetDRuntime();
 
-        return druntime->GetValue( aArrayAddr, key, valueAddr );
+        return druntime->GetValue( this, aArrayAddr, key, valueAddr );
     }
 
     int ExprContext::GetAAVersion()
@@ -671,6 +781,25 @@ namespace Mago
         return S_OK;
     }
 
+    HRESULT ExprContext::ReadMemory( 
+        MagoEE::MemoryRead* reads, 
+        uint32_t count )
+    {
+        MagoEE::ReadPlan    plan;
+
+        // pieces near each other are read together, which saves a round 
+        // trip for each one when debugging remotely
+        return plan.Read( this, reads, count );
+    }
+
+    HRESULT ExprContext::FromRawValue( 
+        const uint8_t* buffer, 
+        MagoEE::Type* type, 
+        MagoEE::DataValue& value )
+    {
+        return ::FromRawValue( buffer, type, value );
+    }
+
 
     ////////////////////////////////////////////////////////////////////////////// 
 
@@ -736,69 +865,31 @@ namespace Mago
 
     HRESULT ExprContext::FindGlobalSymbol( const char* name, size_t nameLen, MagoST::SymHandle& globalSH )
     {
+        HRESULT                     hr = S_OK;
         RefPtr<MagoST::ISession>    session;
+        SymInfoData                 infoData = { 0 };
+        ISymbolInfo*                symInfo = NULL;
+        SymString                   pstrName;
+        const char*                 scopeChars = NULL;
+        size_t                      scopeLen = 0;
 
         if ( !mModule->GetSymbolSession( session ) )
             return E_NOT_FOUND;
 
-        HRESULT hr = FindGlobalSymbol( session, name, nameLen, globalSH );
-        if ( FAILED( hr ) )
-        {
-            // look for static and global symbols by adding the scope to the name
-            // the scope is determined from the current function name, so it does
-            // not work with extern(C) functions
-            SymInfoData     infoData = { 0 };
-            ISymbolInfo*    symInfo = NULL;
-
-            hr = session->GetSymbolInfo( mFuncSH, infoData, symInfo );
-            if ( SUCCEEDED( hr ) && symInfo )
-            {
-                SymString       pstrName;
-                if ( symInfo->GetName( pstrName ) )
-                {
-                    std::string sym( name, nameLen );
-                    std::string scopeName( pstrName.GetName(), pstrName.GetLength() );
-                    while ( scopeName.length() > 0 )
-                    {
-                        std::string symName = scopeName + "." + sym;
-                        hr = FindGlobalSymbol( session, symName.c_str(), symName.length(), globalSH );
-                        if ( SUCCEEDED( hr ) )
-                            break;
-                        std::string::reverse_iterator it = std::find( scopeName.rbegin(), scopeName.rend(), '.' );
-                        if( it == scopeName.rend() )
-                            break;
-                        scopeName.erase( it.base() - 1, scopeName.end() );
-                    }
-                }
-            }
-        }
-        return hr;
-    }
-
-    HRESULT ExprContext::FindGlobalSymbol( 
-        MagoST::ISession* session, 
-        const char* name, 
-        size_t nameLen, 
-        MagoST::SymHandle& globalSH )
-    {
-        HRESULT hr = S_OK;
-        MagoST::EnumNamedSymbolsData    enumData = { 0 };
-
-        for ( int i = 0; i < MagoST::SymHeap_Count; i++ )
+        // static and global symbols can also be found by adding the scope to the name
+        // the scope is determined from the current function name, so it does
+        // not work with extern(C) functions
+        hr = session->GetSymbolInfo( mFuncSH, infoData, symInfo );
+        if ( SUCCEEDED( hr ) && symInfo && symInfo->GetName( pstrName ) )
         {
-            hr = session->FindFirstSymbol( (MagoST::SymbolHeapId) i, name, nameLen, enumData );
-            if ( hr == S_OK )
-                break;
+            scopeChars = pstrName.GetName();
+            scopeLen = pstrName.GetLength();
         }
 
+        hr = session->FindScopedGlobalSymbol( scopeChars, scopeLen, name, nameLen, globalSH );
         if ( hr != S_OK )
             return E_NOT_FOUND;
 
-        // TODO: for now we only care about the first one
-        hr = session->GetCurrentSymbol( enumData, globalSH );
-        if ( FAILED( hr ) )
-            return hr;
-
         return S_OK;
     }
 
@@ -1158,16 +1249,42 @@ namespace Mago
     HRESULT ExprContext::GetTypeFromTypeSymbol( 
         MagoST::TypeIndex typeIndex,
         MagoEE::Type*& type )
+    {
+        HRESULT                     hr = S_OK;
+        DWORD                       threadId = mThread->GetCoreThread()->GetTid();
+        RefPtr<MagoEE::Type>        cachedType;
+        RefPtr<MagoST::ISession>    session;
+
+        if ( mModule->FindCachedType( threadId, typeIndex, cachedType ) )
+        {
+            type = cachedType.Detach();
+            return S_OK;
+        }
+
+        if ( !mModule->GetSymbolSession( session ) )
+            return E_FAIL;
+
+        hr = MakeTypeFromTypeSymbol( session, typeIndex, cachedType.Ref() );
+        if ( FAILED( hr ) )
+            return hr;
+
+        if ( cachedType != NULL )
+            mModule->CacheType( session, threadId, typeIndex, cachedType );
+
+        type = cachedType.Detach();
+        return hr;
+    }
+
+    HRESULT ExprContext::MakeTypeFromTypeSymbol( 
+        MagoST::ISession* session,
+        MagoST::TypeIndex typeIndex,
+        MagoEE::Type*& type )
     {
         HRESULT                 hr = S_OK;
         MagoST::SymTag          tag = MagoST::SymTagNull;
         MagoST::TypeHandle      typeTH = { 0 };
         MagoST::SymInfoData     infoData = { 0 };
         MagoST::ISymbolInfo*    symInfo = NULL;
-        RefPtr<MagoST::ISession>    session;
-
-        if ( !mModule->GetSymbolSession( session ) )
-            return E_FAIL;
 
         if ( !session->GetTypeFromTypeIndex( typeIndex, typeTH ) )
             return E_FAIL;
@@ -21,6 +21,11 @@ namespace Mago
         public IDebugExpressionContext2,
         public MagoEE::IValueBinder
     {
+        // Declarations found by name. The function and blocks don't change 
+        // for the life of the context, so the name is enough of a key. A name 
+        // that wasn't found has a NULL declaration.
+        typedef std::map< std::wstring, RefPtr<MagoEE::Declaration> >   DeclCache;
+
         Address64                       mPC;
         RefPtr<IRegisterSet>            mRegSet;
         RefPtr<Module>                  mModule;
@@ -29,6 +34,10 @@ namespace Mago
         std::vector<MagoST::SymHandle>  mBlockSH;
         RefPtr<MagoEE::ITypeEnv>        mTypeEnv;
         RefPtr<MagoEE::NameTable>       mStrTable;
+        DeclCache                       mDeclCache;
+        RefPtr<MagoST::ISession>        mDeclCacheSession;
+        bool                            mDisposed;
+        Guard                           mDeclCacheGuard;
 
     public:
         ExprContext();
@@ -69,6 +78,10 @@ namespace Mago
         virtual HRESULT GetSuper( MagoEE::Declaration*& decl );
         virtual HRESULT GetReturnType( MagoEE::Type*& type );
 
+        virtual HRESULT GetAddress( 
+            MagoEE::Declaration* decl, 
+            MagoEE::Address& addr );
+
         virtual HRESULT GetValue( 
             MagoEE::Declaration* decl, 
             MagoEE::DataValue& value );
@@ -100,6 +113,15 @@ namespace Mago
             uint32_t& sizeRead, 
             uint8_t* buffer );
 
+        virtual HRESULT ReadMemory( 
+            MagoEE::MemoryRead* reads, 
+            uint32_t count );
+
+        virtual HRESULT FromRawValue( 
+            const uint8_t* buffer, 
+            MagoEE::Type* type, 
+            MagoEE::DataValue& value );
+
         //////////////////////////////////////////////////////////// 
         // IMagoSymStore 
 
@@ -112,8 +134,6 @@ namespace Mago
         const std::vector<MagoST::SymHandle>& GetBlockSH();
         Address64 GetPC();
 
-        HRESULT GetAddress( MagoEE::Declaration* decl, MagoEE::Address& addr );
-
         static MagoEE::ENUMTY GetBasicTy( DWORD diaBaseTypeId, DWORD size );
 
         HRESULT MakeDeclarationFromSymbol( 
@@ -150,7 +170,24 @@ namespace Mago
 
         Thread* GetThread();
 
+        // The cached declarations refer back to this context, so the owner 
+        // has to release them when it's done with the context.
+        void Dispose();
+
     private:
+        HRESULT MakeDeclarationFromName( 
+            const wchar_t* name, 
+            MagoEE::Declaration*& decl );
+
+        bool FindCachedDeclaration( 
+            MagoST::ISession* session, 
+            const wchar_t* name, 
+            MagoEE::Declaration*& decl );
+        void CacheDeclaration( 
+            MagoST::ISession* session, 
+            const wchar_t* name, 
+            MagoEE::Declaration* decl );
+
         HRESULT FindLocalSymbol( const char* name, size_t nameLen, MagoST::SymHandle& localSH );
         HRESULT FindGlobalSymbol( const char* name, size_t nameLen, MagoST::SymHandle& globalSH );
 
@@ -161,12 +198,6 @@ namespace Mago
             size_t nameLen, 
             MagoST::SymHandle& localSH );
 
-        static HRESULT FindGlobalSymbol( 
-            MagoST::ISession* session, 
-            const char* name, 
-            size_t nameLen, 
-            MagoST::SymHandle& globalSH );
-
         HRESULT MakeDeclarationFromTypedefSymbol( 
             const MagoST::SymInfoData& infoData, 
             MagoST::ISymbolInfo* symInfo, 
@@ -177,10 +208,16 @@ namespace Mago
             MagoST::ISymbolInfo* symInfo, 
             MagoEE::Declaration*& decl );
 
+        // Types are looked up in the module's type cache first.
         HRESULT GetTypeFromTypeSymbol( 
             MagoST::TypeIndex typeIndex,
             MagoEE::Type*& type );
 
+        HRESULT MakeTypeFromTypeSymbol( 
+            MagoST::ISession* session,
+            MagoST::TypeIndex typeIndex,
+            MagoEE::Type*& type );
+
         HRESULT GetFunctionTypeFromTypeSymbol( 
             MagoST::TypeHandle typeHandle,
             const MagoST::SymInfoData& infoData,
@@ -9,6 +9,7 @@
 #include "Module.h"
 #include "DiaLoadCallback.h"
 #include "ICoreProcess.h"
+#include <MagoEED.h>
 
 
 namespace Mago
@@ -17,7 +18,10 @@ namespace Mago
 
     Module::Module()
         :   mId( 0 ),
-            mLoadIndex( 0 )
+            mLoadIndex( 0 ),
+            mDisposed( false ),
+            mExprCacheHits( 0 ),
+            mExprCacheMisses( 0 )
     {
     }
 
@@ -37,7 +41,14 @@ namespace Mago
         if ( pInfo == NULL )
             return E_POINTER;
 
-        HRESULT hr = S_OK;
+        HRESULT     hr = S_OK;
+        CComBSTR    loadedSymPath;
+
+        {
+            // the symbols can be loaded on another thread
+            GuardedArea guard( mSessionGuard );
+            loadedSymPath = mLoadedSymPath;
+        }
 
         pInfo->dwValidFields = 0;
 
@@ -65,7 +76,7 @@ namespace Mago
 
         if ( (dwFields & MIF_DEBUGMESSAGE) != 0 )
         {
-            if ( mLoadedSymPath != NULL )
+            if ( loadedSymPath != NULL )
             {
                 pInfo->m_bstrDebugMessage = SysAllocString( L"has Symbols." );
             }
@@ -106,9 +117,9 @@ namespace Mago
 
         if ( (dwFields & MIF_URLSYMBOLLOCATION) != 0 )
         {
-            if ( mLoadedSymPath != NULL )
+            if ( loadedSymPath != NULL )
             {
-                pInfo->m_bstrUrlSymbolLocation = mLoadedSymPath.Copy();
+                pInfo->m_bstrUrlSymbolLocation = loadedSymPath.Copy();
                 if ( pInfo->m_bstrUrlSymbolLocation != NULL )
                     pInfo->dwValidFields |= MIF_URLSYMBOLLOCATION;
             }
@@ -157,7 +168,9 @@ namespace Mago
 
         if ( (dwFields & SSIF_VERBOSE_SEARCH_INFO) != 0 )
         {
-            if ( GetSession() != NULL )
+            GuardedArea guard( mSessionGuard );
+
+            if ( mSession != NULL )
             {
                 pInfo->bstrVerboseSearchInfo = mSearchText.Copy();
                 if ( pInfo->bstrVerboseSearchInfo != NULL )
@@ -170,15 +183,38 @@ namespace Mago
 
     HRESULT Module::LoadSymbols()
     {
+        // don't race a load that's going on in the background
+        WaitForSymbols();
+
         return LoadSymbols( true );
     }
 
     HRESULT Module::LoadSymbols( bool sendEvent )
+    {
+        HRESULT hr = LoadSymbolsInternal( sendEvent );
+
+        EndLoadSymbols();
+
+        return hr;
+    }
+
+    HRESULT Module::LoadSymbolsInternal( bool sendEvent )
     {
         HRESULT hr = S_OK;
         RefPtr<DiaLoadCallback>     callback;
         RefPtr<MagoST::ISession>    session;
         RefPtr<MagoST::IDataSource> dataSource;
+        std::wstring                indexDir;
+        uint64_t                    indexMaxSize = 0;
+        CComBSTR                    searchText;
+        CComBSTR                    loadedSymPath;
+
+        {
+            // the module could have been unloaded while it waited to be loaded
+            GuardedArea guard( mSessionGuard );
+            if ( mDisposed )
+                return E_FAIL;
+        }
 
         callback = new DiaLoadCallback();
         if ( callback == NULL )
@@ -192,6 +228,10 @@ namespace Mago
         if ( FAILED( hr ) )
             return hr;
 
+        // the index cache only saves time, so go on without it
+        if ( GetSymbolIndexCacheConfig( indexDir, indexMaxSize ) )
+            dataSource->SetIndexCache( indexDir.c_str(), indexMaxSize );
+
         hr = dataSource->InitDebugInfo( mCoreMod->GetPath(), mCoreMod->GetSymbolSearchPath() );
         if ( FAILED( hr ) )
             return hr;
@@ -202,20 +242,34 @@ namespace Mago
 
         session->SetLoadAddress( mCoreMod->GetImageBase() );
 
-        SetSession( session );
-
         // it's OK to fail here, we'll just return a blank string
-        callback->GetSearchText( &mSearchText );
+        callback->GetSearchText( &searchText );
 
         if ( callback->GetSearchList().size() > 0 )
         {
-            mLoadedSymPath = callback->GetSearchList().back().Path.c_str();
+            loadedSymPath = callback->GetSearchList().back().Path.c_str();
         }
         else
         {
-            mLoadedSymPath = mCoreMod->GetPath();
+            loadedSymPath = mCoreMod->GetPath();
         }
 
+        {
+            GuardedArea guard( mSessionGuard );
+
+            // a background load can finish after the module was disposed
+            if ( mDisposed )
+                return E_FAIL;
+
+            mSession = session;
+            mSearchText.Attach( searchText.Detach() );
+            mLoadedSymPath.Attach( loadedSymPath.Detach() );
+        }
+
+        // types built from the old symbols don't match the new type indexes
+        ClearCachedTypes();
+        ClearCachedExprs();
+
         if ( sendEvent )
         {
             // TODO: send the symbol load event
@@ -261,7 +315,17 @@ namespace Mago
         // these have to be closed when we're told to close
         // all other resources can be left open
 
-        SetSession( NULL );
+        {
+            GuardedArea guard( mSessionGuard );
+
+            mDisposed = true;
+            mSession.Release();
+        }
+
+        // the cached types and expressions hold expression contexts that 
+        // hold this module
+        ClearCachedTypes();
+        ClearCachedExprs();
     }
 
     void    Module::GetPath( CComBSTR& path )
@@ -319,20 +383,54 @@ namespace Mago
 
     bool    Module::GetSymbolSession( RefPtr<MagoST::ISession>& session )
     {
+        WaitForSymbols();
+
         session = GetSession();
         return session != NULL;
     }
 
-    RefPtr<MagoST::ISession>    Module::GetSession()
+    HRESULT Module::BeginLoadSymbols()
     {
+        HandlePtr   hEvent;
+
+        hEvent = CreateEvent( NULL, TRUE, FALSE, NULL );
+        if ( hEvent.IsEmpty() )
+            return GetLastHr();
+
         GuardedArea guard( mSessionGuard );
-        return mSession;
+
+        _ASSERT( mhSymLoadEvent.IsEmpty() );
+        mhSymLoadEvent.Attach( hEvent.Detach() );
+
+        return S_OK;
     }
 
-    void    Module::SetSession( MagoST::ISession* session )
+    void    Module::EndLoadSymbols()
     {
         GuardedArea guard( mSessionGuard );
-        mSession = session;
+
+        if ( !mhSymLoadEvent.IsEmpty() )
+            SetEvent( mhSymLoadEvent );
+    }
+
+    void    Module::WaitForSymbols()
+    {
+        HANDLE  hEvent = NULL;
+
+        {
+            GuardedArea guard( mSessionGuard );
+            hEvent = mhSymLoadEvent.Get();
+        }
+
+        // the event lives as long as the module, and it's never reset
+        if ( hEvent != NULL )
+            WaitForSingleObject( hEvent, INFINITE );
+    }
+
+    RefPtr<MagoST::ISession>    Module::GetSession()
+    {
+        GuardedArea guard( mSessionGuard );
+        return mSession;
     }
 
     bool    Module::Contains( Address64 addr )
@@ -340,4 +438,214 @@ namespace Mago
         Address64 modAddr = GetAddress();
         return (addr >= modAddr) && ((addr - modAddr) < GetSize());
     }
+
+    bool    Module::FindCachedType( DWORD threadId, MagoST::TypeIndex typeIndex, RefPtr<MagoEE::Type>& type )
+    {
+        GuardedArea guard( mTypeCacheGuard );
+
+        TypeCache::iterator it = mTypeCache.find( TypeCacheKey( threadId, typeIndex ) );
+        if ( it == mTypeCache.end() )
+            return false;
+
+        type = it->second;
+        return true;
+    }
+
+    void    Module::CacheType( 
+        MagoST::ISession* session, 
+        DWORD threadId, 
+        MagoST::TypeIndex typeIndex, 
+        MagoEE::Type* type )
+    {
+        _ASSERT( type != NULL );
+
+        GuardedArea guard( mSessionGuard );
+
+        // the symbols could have been reloaded while the type was being built
+        if ( session != mSession.Get() )
+            return;
+
+        GuardedArea typeGuard( mTypeCacheGuard );
+
+        mTypeCache[TypeCacheKey( threadId, typeIndex )] = type;
+    }
+
+    void    Module::ClearCachedTypes( DWORD threadId )
+    {
+        std::vector< RefPtr<MagoEE::Type> > oldTypes;
+
+        {
+            GuardedArea guard( mTypeCacheGuard );
+
+            TypeCache::iterator it = mTypeCache.lower_bound( TypeCacheKey( threadId, 0 ) );
+
+            while ( (it != mTypeCache.end()) && (it->first.first == threadId) )
+            {
+                oldTypes.push_back( it->second );
+                mTypeCache.erase( it++ );
+            }
+        }
+
+        // the types are released outside the lock, because they can release 
+        // the last reference to an expression context
+    }
+
+    void    Module::ClearCachedTypes()
+    {
+        TypeCache   oldTypes;
+
+        {
+            GuardedArea guard( mTypeCacheGuard );
+            oldTypes.swap( mTypeCache );
+        }
+    }
+
+
+    bool    Module::ExprCacheKey::operator<( const ExprCacheKey& other ) const
+    {
+        if ( ThreadId != other.ThreadId )
+            return ThreadId < other.ThreadId;
+        if ( PtrSize != other.PtrSize )
+            return PtrSize < other.PtrSize;
+
+        int cmp = memcmp( &FuncSH, &other.FuncSH, sizeof FuncSH );
+        if ( cmp != 0 )
+            return cmp < 0;
+
+        cmp = memcmp( &BlockSH, &other.BlockSH, sizeof BlockSH );
+        if ( cmp != 0 )
+            return cmp < 0;
+
+        return Text < other.Text;
+    }
+
+    bool    Module::FindCachedExpr( 
+        const wchar_t* text, 
+        DWORD threadId, 
+        int ptrSize, 
+        MagoST::SymHandle funcSH, 
+        MagoST::SymHandle blockSH, 
+        RefPtr<MagoEE::IEEDParsedExpr>& expr )
+    {
+        _ASSERT( text != NULL );
+
+        ExprCacheKey    key;
+
+        key.Text = text;
+        key.ThreadId = threadId;
+        key.PtrSize = ptrSize;
+        key.FuncSH = funcSH;
+        key.BlockSH = blockSH;
+
+        GuardedArea guard( mExprCacheGuard );
+
+        ExprCacheMap::iterator it = mExprCacheMap.find( key );
+        if ( it == mExprCacheMap.end() )
+        {
+            mExprCacheMisses++;
+            return false;
+        }
+
+        // move it to the front
+        mExprCacheList.splice( mExprCacheList.begin(), mExprCacheList, it->second );
+        mExprCacheHits++;
+
+        expr = it->second->second;
+        return true;
+    }
+
+    void    Module::CacheExpr( 
+        MagoST::ISession* session, 
+        const wchar_t* text, 
+        DWORD threadId, 
+        int ptrSize, 
+        MagoST::SymHandle funcSH, 
+        MagoST::SymHandle blockSH, 
+        MagoEE::IEEDParsedExpr* expr )
+    {
+        _ASSERT( text != NULL );
+        _ASSERT( expr != NULL );
+
+        RefPtr<MagoEE::IEEDParsedExpr>  oldExpr;
+        ExprCacheEntry                  entry;
+
+        entry.first.Text = text;
+        entry.first.ThreadId = threadId;
+        entry.first.PtrSize = ptrSize;
+        entry.first.FuncSH = funcSH;
+        entry.first.BlockSH = blockSH;
+        entry.second = expr;
+
+        GuardedArea guard( mSessionGuard );
+
+        // the symbols could have been reloaded while the expression was bound
+        if ( session != mSession.Get() )
+            return;
+
+        GuardedArea exprGuard( mExprCacheGuard );
+
+        ExprCacheMap::iterator it = mExprCacheMap.find( entry.first );
+        if ( it != mExprCacheMap.end() )
+        {
+            // another context bound it at the same time, keep the newer one
+            oldExpr = it->second->second;
+            it->second->second = expr;
+            mExprCacheList.splice( mExprCacheList.begin(), mExprCacheList, it->second );
+            return;
+        }
+
+        if ( mExprCacheList.size() >= MaxCachedExprs )
+        {
+            oldExpr = mExprCacheList.back().second;
+            mExprCacheMap.erase( mExprCacheList.back().first );
+            mExprCacheList.pop_back();
+        }
+
+        mExprCacheList.push_front( entry );
+        mExprCacheMap.insert( ExprCacheMap::value_type( entry.first, mExprCacheList.begin() ) );
+    }
+
+    void    Module::ClearCachedExprs( DWORD threadId )
+    {
+        ExprCacheList   oldExprs;
+
+        {
+            GuardedArea guard( mExprCacheGuard );
+
+            ExprCacheList::iterator it = mExprCacheList.begin();
+
+            while ( it != mExprCacheList.end() )
+            {
+                ExprCacheList::iterator cur = it++;
+
+                if ( cur->first.ThreadId == threadId )
+                {
+                    mExprCacheMap.erase( cur->first );
+                    oldExprs.splice( oldExprs.end(), mExprCacheList, cur );
+                }
+            }
+        }
+
+        // like types, the expressions are released outside the lock
+    }
+
+    void    Module::ClearCachedExprs()
+    {
+        ExprCacheList   oldExprs;
+
+        {
+            GuardedArea guard( mExprCacheGuard );
+
+            mExprCacheMap.clear();
+            oldExprs.swap( mExprCacheList );
+        }
+    }
+
+    void    Module::GetExprCacheStats( uint32_t& hits, uint32_t& misses )
+    {
+        GuardedArea guard( mExprCacheGuard );
+
+        hits = mExprCacheHits;
+        misses = mExprCacheMisses;
+    }
 }
@@ -8,6 +8,12 @@
 #pragma once
 
 
+namespace MagoEE
+{
+    class Type;
+    class IEEDParsedExpr;
+}
+
 namespace Mago
 {
     class ICoreModule;
@@ -17,13 +23,47 @@ namespace Mago
         public CComObjectRootEx<CComMultiThreadModel>,
         public IDebugModule3
     {
+        // The types built from the module's type records. Member declarations
+        // of a type can resolve TLS addresses, so types are kept per thread.
+        typedef std::pair<DWORD, MagoST::TypeIndex>                 TypeCacheKey;
+        typedef std::map< TypeCacheKey, RefPtr<MagoEE::Type> >      TypeCache;
+
+        // Expressions that were parsed and bound in the module, most recently 
+        // used first. Binding depends on the scope of the frame and, like 
+        // types, on the thread.
+        struct ExprCacheKey
+        {
+            std::wstring        Text;
+            DWORD               ThreadId;
+            int                 PtrSize;
+            MagoST::SymHandle   FuncSH;
+            MagoST::SymHandle   BlockSH;
+
+            bool operator<( const ExprCacheKey& other ) const;
+        };
+
+        typedef std::pair< ExprCacheKey, RefPtr<MagoEE::IEEDParsedExpr> >    ExprCacheEntry;
+        typedef std::list< ExprCacheEntry >                                 ExprCacheList;
+        typedef std::map< ExprCacheKey, ExprCacheList::iterator >           ExprCacheMap;
+
+        static const size_t MaxCachedExprs = 256;
+
         DWORD                       mId;
         RefPtr<ICoreModule>         mCoreMod;
         DWORD                       mLoadIndex;
         RefPtr<MagoST::ISession>    mSession;
         CComBSTR                    mLoadedSymPath;
         CComBSTR                    mSearchText;
+        HandlePtr                   mhSymLoadEvent;     // set when a background load is done
+        bool                        mDisposed;
         Guard                       mSessionGuard;
+        TypeCache                   mTypeCache;
+        Guard                       mTypeCacheGuard;
+        ExprCacheList               mExprCacheList;
+        ExprCacheMap                mExprCacheMap;
+        uint32_t                    mExprCacheHits;
+        uint32_t                    mExprCacheMisses;
+        Guard                       mExprCacheGuard;
 
     public:
         Module();
@@ -75,13 +115,52 @@ namespace Mago
         DWORD   GetSize();
         DWORD   GetLoadIndex();
         void    SetLoadIndex( DWORD index );
+
+        // If the symbols are being loaded in the background, then this waits 
+        // for them. Module info only reports the symbols once they're loaded.
         bool    GetSymbolSession( RefPtr<MagoST::ISession>& session );
 
         HRESULT LoadSymbols( bool sendEvent );
+        HRESULT BeginLoadSymbols();
+        void    EndLoadSymbols();
+        void    WaitForSymbols();
         bool    Contains( Address64 addr );
 
+        // The cache is shared by all the expression contexts of the module. 
+        // It's cleared when the symbols are reloaded or the module is disposed.
+        bool    FindCachedType( DWORD threadId, MagoST::TypeIndex typeIndex, RefPtr<MagoEE::Type>& type );
+        void    CacheType( 
+            MagoST::ISession* session, 
+            DWORD threadId, 
+            MagoST::TypeIndex typeIndex, 
+            MagoEE::Type* type );
+        void    ClearCachedTypes( DWORD threadId );
+
+        // Bound expressions are cached the same way. The declarations in them 
+        // refer to the expression context that bound them, so addresses have 
+        // to be taken through the binder that evaluates them.
+        bool    FindCachedExpr( 
+            const wchar_t* text, 
+            DWORD threadId, 
+            int ptrSize, 
+            MagoST::SymHandle funcSH, 
+            MagoST::SymHandle blockSH, 
+            RefPtr<MagoEE::IEEDParsedExpr>& expr );
+        void    CacheExpr( 
+            MagoST::ISession* session, 
+            const wchar_t* text, 
+            DWORD threadId, 
+            int ptrSize, 
+            MagoST::SymHandle funcSH, 
+            MagoST::SymHandle blockSH, 
+            MagoEE::IEEDParsedExpr* expr );
+        void    ClearCachedExprs( DWORD threadId );
+        void    GetExprCacheStats( uint32_t& hits, uint32_t& misses );
+
     private:
+        HRESULT LoadSymbolsInternal( bool sendEvent );
         RefPtr<MagoST::ISession>    GetSession();
-        void    SetSession( MagoST::ISession* session );
+        void    ClearCachedTypes();
+        void    ClearCachedExprs();
     };
 }
@@ -60,7 +60,9 @@ namespace Mago
         mCanPassExceptionToDebuggee( true ),
         mDebugger( NULL ),
         mNextModLoadIndex( 0 ),
-        mEntryPoint( 0 )
+        mEntryPoint( 0 ),
+        mLoadCompleted( false ),
+        mSymLoadCount( 0 )
     {
     }
 
@@ -230,11 +232,11 @@ namespace Mago
             if ( !mod->GetSymbolSession( session ) )
                 continue;
 
-            std::list<MagoST::LineNumber> lines;
+            std::vector<MagoST::LineNumber> lines;
             if( !session->FindLines( exactMatch, fileName, fileNameLen, reqLineStart, reqLineEnd, lines ) )
                 continue;
 
-            for( std::list<MagoST::LineNumber>::iterator it = lines.begin(); it != lines.end(); ++it )
+            for( std::vector<MagoST::LineNumber>::iterator it = lines.begin(); it != lines.end(); ++it )
             {
                 bindings.push_back( AddressBinding() );
                 bindings.back().Addr = session->GetVAFromSecOffset( it->Section, it->Offset );
@@ -494,6 +496,60 @@ namespace Mago
         }
     }
 
+    bool Program::GetLoadCompleted()
+    {
+        return mLoadCompleted;
+    }
+
+    void Program::SetLoadCompleted()
+    {
+        mLoadCompleted = true;
+    }
+
+    HRESULT Program::BeginSymbolLoad()
+    {
+        GuardedArea guard( mSymLoadGuard );
+
+        if ( mhSymLoadsDone.IsEmpty() )
+        {
+            mhSymLoadsDone = CreateEvent( NULL, TRUE, TRUE, NULL );
+            if ( mhSymLoadsDone.IsEmpty() )
+                return GetLastHr();
+        }
+
+        if ( mSymLoadCount == 0 )
+            ResetEvent( mhSymLoadsDone );
+
+        mSymLoadCount++;
+
+        return S_OK;
+    }
+
+    void Program::EndSymbolLoad()
+    {
+        GuardedArea guard( mSymLoadGuard );
+
+        _ASSERT( mSymLoadCount > 0 );
+        mSymLoadCount--;
+
+        if ( mSymLoadCount == 0 )
+            SetEvent( mhSymLoadsDone );
+    }
+
+    void Program::WaitForSymbolLoads()
+    {
+        HANDLE  hEvent = NULL;
+
+        {
+            GuardedArea guard( mSymLoadGuard );
+            hEvent = mhSymLoadsDone.Get();
+        }
+
+        // the event lives as long as the program
+        if ( hEvent != NULL )
+            WaitForSingleObject( hEvent, INFINITE );
+    }
+
     bool Program::GetAttached()
     {
         return mAttached;
@@ -580,8 +636,21 @@ namespace Mago
 
     void Program::DeleteThread( Thread* thread )
     {
-        GuardedArea guard( mThreadGuard );
-        mThreadMap.erase( thread->GetCoreThread()->GetTid() );
+        DWORD   threadId = thread->GetCoreThread()->GetTid();
+
+        {
+            GuardedArea guard( mThreadGuard );
+            mThreadMap.erase( threadId );
+        }
+
+        // the types and expressions cached for the thread hold on to it
+        GuardedArea guard( mModGuard );
+
+        for ( ModuleMap::iterator it = mModMap.begin(); it != mModMap.end(); it++ )
+        {
+            it->second->ClearCachedTypes( threadId );
+            it->second->ClearCachedExprs( threadId );
+        }
     }
 
     Address64 Program::FindEntryPoint()
@@ -52,6 +52,10 @@ namespace Mago
         RefPtr<Module>                  mProgMod;
         RefPtr<Thread>                  mProgThread;
         UniquePtr<DRuntime>             mDRuntime;
+        bool                            mLoadCompleted;
+        int                             mSymLoadCount;      // protected by sym load guard
+        HandlePtr                       mhSymLoadsDone;     // set when the count drops to zero
+        Guard                           mSymLoadGuard;
 
     public:
         Program();
@@ -143,6 +147,14 @@ namespace Mago
         void        SetEntryPoint( Address64 address );
         void        UpdateAAVersion( Module* mod );
 
+        // Module symbols are loaded in the background until the loader 
+        // breakpoint. After that, modules are loaded one at a time.
+        bool        GetLoadCompleted();
+        void        SetLoadCompleted();
+        HRESULT     BeginSymbolLoad();
+        void        EndSymbolLoad();
+        void        WaitForSymbolLoads();
+
     private:
         HRESULT     StepInternal( IDebugThread2* pThread, STEPKIND sk, STEPUNIT step );
 
@@ -21,13 +21,17 @@ namespace Mago
 {
     StackFrame::StackFrame()
         :   mPC( 0 ),
-            mPtrSize( 0 )
+            mPtrSize( 0 ),
+            mHasLine( false )
     {
         memset( &mFuncSH, 0, sizeof mFuncSH );
+        memset( &mLine, 0, sizeof mLine );
     }
 
     StackFrame::~StackFrame()
     {
+        if ( mExprContext != NULL )
+            mExprContext->Dispose();
     }
 
     HRESULT StackFrame::GetCodeContext( 
@@ -350,6 +354,31 @@ namespace Mago
         mPtrSize = ptrSize;
     }
 
+    Address64 StackFrame::GetPC()
+    {
+        return mPC;
+    }
+
+    Module* StackFrame::GetModule()
+    {
+        return mModule.Get();
+    }
+
+    // Takes the function, blocks, and line that were found for the PC along 
+    // with the other frames, so that they don't have to be looked up again.
+
+    void StackFrame::SetAddressInfo( const MagoST::AddressInfo& info )
+    {
+        if ( info.HasFunction )
+        {
+            mFuncSH = info.FuncHandle;
+            mBlockSH = info.Blocks;
+        }
+
+        mHasLine = info.HasLine;
+        mLine = info.Line;
+    }
+
     HRESULT StackFrame::GetLineInfo( LineInfo& info )
     {
         HRESULT hr = S_OK;
@@ -361,15 +390,19 @@ namespace Mago
         if ( !mModule->GetSymbolSession( session ) )
             return E_NOT_FOUND;
 
-        uint16_t    sec = 0;
-        uint32_t    offset = 0;
-        sec = session->GetSecOffsetFromVA( mPC, offset );
-        if ( sec == 0 )
-            return E_FAIL;
+        MagoST::LineNumber line = mLine;
 
-        MagoST::LineNumber line = { 0 };
-        if ( !session->FindLine( sec, offset, line ) )
-            return E_FAIL;
+        if ( !mHasLine )
+        {
+            uint16_t    sec = 0;
+            uint32_t    offset = 0;
+            sec = session->GetSecOffsetFromVA( mPC, offset );
+            if ( sec == 0 )
+                return E_FAIL;
+
+            if ( !session->FindLine( sec, offset, line ) )
+                return E_FAIL;
+        }
 
         info.LineBegin.dwLine = line.Number;
         //info.LineEnd.dwLine = line.NumberEnd;
@@ -37,6 +37,8 @@ namespace Mago
 
         MagoST::SymHandle               mFuncSH;
         std::vector<MagoST::SymHandle>  mBlockSH;
+        bool                            mHasLine;
+        MagoST::LineNumber              mLine;
 
         RefPtr<ExprContext>             mExprContext;
         Guard                           mExprContextGuard;
@@ -101,6 +103,10 @@ namespace Mago
             Module* module,
             int ptrSize );
 
+        Address64   GetPC();
+        Module*     GetModule();
+        void        SetAddressInfo( const MagoST::AddressInfo& info );
+
     private:
         HRESULT GetLineInfo( LineInfo& info );
 
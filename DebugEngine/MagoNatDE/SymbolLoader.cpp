@@ -0,0 +1,207 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#include "Common.h"
+#include "SymbolLoader.h"
+#include "EventCallback.h"
+#include "Program.h"
+#include "Module.h"
+#include <process.h>
+
+
+namespace Mago
+{
+    SymbolLoader::SymbolLoader()
+        :   mThreadCount( 0 ),
+            mhJobSemaphore( NULL ),
+            mShutdown( false )
+    {
+    }
+
+    SymbolLoader::~SymbolLoader()
+    {
+        Shutdown();
+    }
+
+    HRESULT SymbolLoader::Init( EventCallback* callback )
+    {
+        _ASSERT( callback != NULL );
+        if ( callback == NULL )
+            return E_INVALIDARG;
+
+        mCallback = callback;
+        mThreadCount = GetSymbolLoadThreadCount();
+
+        return S_OK;
+    }
+
+    void SymbolLoader::Shutdown()
+    {
+        JobList     jobs;
+
+        {
+            GuardedArea guard( mJobGuard );
+
+            mShutdown = true;
+            jobs.swap( mJobs );
+        }
+
+        // the modules that never got loaded still have to release their waiters
+        for ( JobList::iterator it = jobs.begin(); it != jobs.end(); it++ )
+        {
+            it->Mod->EndLoadSymbols();
+            it->Prog->EndSymbolLoad();
+        }
+
+        StopThreads();
+    }
+
+    HRESULT SymbolLoader::Queue( Program* prog, Module* mod )
+    {
+        _ASSERT( prog != NULL );
+        _ASSERT( mod != NULL );
+
+        HRESULT     hr = S_OK;
+        Job         job;
+        GuardedArea guard( mJobGuard );
+
+        if ( mThreadCount == 0 )
+            return S_FALSE;
+
+        if ( mThreads.size() == 0 )
+        {
+            hr = StartThreads();
+            if ( FAILED( hr ) )
+                return hr;
+        }
+
+        hr = mod->BeginLoadSymbols();
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = prog->BeginSymbolLoad();
+        if ( FAILED( hr ) )
+        {
+            mod->EndLoadSymbols();
+            return hr;
+        }
+
+        job.Prog = prog;
+        job.Mod = mod;
+
+        mJobs.push_back( job );
+
+        ReleaseSemaphore( mhJobSemaphore, 1, NULL );
+
+        return S_OK;
+    }
+
+    HRESULT SymbolLoader::StartThreads()
+    {
+        HandlePtr   hSemaphore;
+
+        hSemaphore = CreateSemaphore( NULL, 0, LONG_MAX, NULL );
+        if ( hSemaphore.IsEmpty() )
+            return GetLastHr();
+
+        mhJobSemaphore = hSemaphore.Detach();
+        mShutdown = false;
+
+        for ( DWORD i = 0; i < mThreadCount; i++ )
+        {
+            HANDLE  hThread = (HANDLE) _beginthreadex(
+                NULL,
+                0,
+                LoadProc,
+                this,
+                0,
+                NULL );
+            if ( hThread == NULL )
+                break;
+
+            mThreads.push_back( hThread );
+        }
+
+        // we can get by with fewer threads, but not with none
+        if ( mThreads.size() == 0 )
+        {
+            CloseHandle( mhJobSemaphore );
+            mhJobSemaphore = NULL;
+            return E_FAIL;
+        }
+
+        return S_OK;
+    }
+
+    void SymbolLoader::StopThreads()
+    {
+        if ( mThreads.size() > 0 )
+        {
+            // wake up every thread, so that each one sees the shutdown flag
+            ReleaseSemaphore( mhJobSemaphore, (LONG) mThreads.size(), NULL );
+
+            WaitForMultipleObjects( (DWORD) mThreads.size(), &mThreads[0], TRUE, INFINITE );
+
+            for ( ThreadList::iterator it = mThreads.begin(); it != mThreads.end(); it++ )
+            {
+                CloseHandle( *it );
+            }
+
+            mThreads.clear();
+        }
+
+        if ( mhJobSemaphore != NULL )
+        {
+            CloseHandle( mhJobSemaphore );
+            mhJobSemaphore = NULL;
+        }
+    }
+
+    void SymbolLoader::RunJobs()
+    {
+        for ( ;; )
+        {
+            Job     job;
+
+            WaitForSingleObject( mhJobSemaphore, INFINITE );
+
+            {
+                GuardedArea guard( mJobGuard );
+
+                if ( mShutdown )
+                    break;
+
+                // Shutdown could have taken the job away
+                if ( mJobs.empty() )
+                    continue;
+
+                job = mJobs.front();
+                mJobs.pop_front();
+            }
+
+            // this releases the module's waiters, whether it succeeds or not
+            job.Mod->LoadSymbols( false );
+
+            mCallback->OnSymbolsLoaded( job.Prog, job.Mod );
+
+            job.Prog->EndSymbolLoad();
+        }
+    }
+
+    unsigned int SymbolLoader::LoadProc( void* param )
+    {
+        _ASSERT( param != NULL );
+
+        SymbolLoader*   pThis = (SymbolLoader*) param;
+
+        CoInitializeEx( NULL, COINIT_MULTITHREADED );
+        pThis->RunJobs();
+        CoUninitialize();
+
+        return 0;
+    }
+}
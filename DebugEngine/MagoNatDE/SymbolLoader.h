@@ -0,0 +1,60 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+
+namespace Mago
+{
+    class EventCallback;
+    class Program;
+    class Module;
+
+
+    // Loads the symbols of modules on a small pool of worker threads, so that
+    // the debug event thread doesn't parse the symbols of each module while
+    // the debuggee waits. The threads are started when the first module is
+    // queued.
+
+    class SymbolLoader
+    {
+        struct Job
+        {
+            RefPtr<Program> Prog;
+            RefPtr<Module>  Mod;
+        };
+
+        typedef std::list<Job>          JobList;
+        typedef std::vector<HANDLE>     ThreadList;
+
+        RefPtr<EventCallback>   mCallback;
+        DWORD                   mThreadCount;
+        ThreadList              mThreads;
+        HANDLE                  mhJobSemaphore;
+        JobList                 mJobs;
+        bool                    mShutdown;
+        Guard                   mJobGuard;
+
+    public:
+        SymbolLoader();
+        ~SymbolLoader();
+
+        HRESULT Init( EventCallback* callback );
+        void    Shutdown();
+
+        // Returns S_FALSE if loading in the background is turned off.
+        // Then the caller has to load the module's symbols itself.
+        HRESULT Queue( Program* prog, Module* mod );
+
+    private:
+        HRESULT StartThreads();
+        void    StopThreads();
+        void    RunJobs();
+
+        static unsigned int __stdcall LoadProc( void* param );
+    };
+}
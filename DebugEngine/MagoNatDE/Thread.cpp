@@ -590,6 +590,8 @@ namespace Mago
         RefPtr<EnumDebugFrameInfo>  enumFrameInfo;
         int i = 0;
 
+        FindCallstackAddresses( callstack );
+
         for ( Callstack::const_iterator it = callstack.begin();
             it != callstack.end();
             it++, i++ )
@@ -610,4 +612,48 @@ namespace Mago
         array.Detach();
         return enumFrameInfo->QueryInterface( __uuidof( IEnumDebugFrameInfo2 ), (void**) ppEnum );
     }
+
+    // Looks up the functions and lines of all the frames in a module at once, 
+    // instead of making each frame look up its own.
+
+    void Thread::FindCallstackAddresses( const Callstack& callstack )
+    {
+        std::vector<bool>                   done( callstack.size() );
+        std::vector<uint64_t>               addrs;
+        std::vector<size_t>                 frameIndexes;
+        std::vector<MagoST::AddressInfo>    infos;
+
+        for ( size_t i = 0; i < callstack.size(); i++ )
+        {
+            Module*                     mod = callstack[i]->GetModule();
+            RefPtr<MagoST::ISession>    session;
+
+            if ( done[i] || (mod == NULL) )
+                continue;
+
+            addrs.resize( 0 );
+            frameIndexes.resize( 0 );
+
+            for ( size_t j = i; j < callstack.size(); j++ )
+            {
+                if ( !done[j] && (callstack[j]->GetModule() == mod) )
+                {
+                    addrs.push_back( callstack[j]->GetPC() );
+                    frameIndexes.push_back( j );
+                    done[j] = true;
+                }
+            }
+
+            if ( !mod->GetSymbolSession( session ) )
+                continue;
+
+            infos.resize( addrs.size() );
+
+            if ( FAILED( session->FindAddresses( &addrs[0], (uint32_t) addrs.size(), &infos[0] ) ) )
+                continue;
+
+            for ( size_t k = 0; k < frameIndexes.size(); k++ )
+                callstack[frameIndexes[k]]->SetAddressInfo( infos[k] );
+        }
+    }
 }
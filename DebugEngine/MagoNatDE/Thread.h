@@ -84,6 +84,7 @@ namespace Mago
             FRAMEINFO_FLAGS dwFieldSpec, 
             UINT nRadix, 
             IEnumDebugFrameInfo2** ppEnum );
+        void    FindCallstackAddresses( const Callstack& callstack );
 
         HRESULT StepStatement( ICoreProcess* coreProc, STEPKIND sk, bool handleException );
         HRESULT StepInstruction( ICoreProcess* coreProc, STEPKIND sk, bool handleException );
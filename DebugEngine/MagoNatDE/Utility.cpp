@@ -406,234 +406,6 @@ HRESULT FromRawValue( const void* srcBuf, MagoEE::Type* type, MagoEE::DataValue&
 }
 
 
-//----------------------------------------------------------------------------
-//  Compare values
-//----------------------------------------------------------------------------
-
-bool EqualFloat32( const void* leftBuf, const void* rightBuf )
-{
-    const float* left = (const float*) leftBuf;
-    const float* right = (const float*) rightBuf;
-
-    // NaNs have to match
-    if ( (*left != *left) && (*right != *right) )
-        return true;
-
-    return *left == *right;
-}
-
-bool EqualFloat64( const void* leftBuf, const void* rightBuf )
-{
-    const double* left = (const double*) leftBuf;
-    const double* right = (const double*) rightBuf;
-
-    // NaNs have to match
-    if ( (*left != *left) && (*right != *right) )
-        return true;
-
-    return *left == *right;
-}
-
-bool EqualFloat80( const void* leftBuf, const void* rightBuf )
-{
-    const Real10* left = (const Real10*) leftBuf;
-    const Real10* right = (const Real10*) rightBuf;
-
-    if ( left->IsNan() && right->IsNan() )
-        return true;
-
-    uint16_t comp = Real10::Compare( *left, *right );
-    return Real10::IsEqual( comp );
-}
-
-bool EqualComplex32( const void* leftBuf, const void* rightBuf )
-{
-    const float* left = (const float*) leftBuf;
-    const float* right = (const float*) rightBuf;
-
-    if ( !EqualFloat32( &left[0], &right[0] ) )
-        return false;
-
-    return EqualFloat32( &left[1], &right[1] );
-}
-
-bool EqualComplex64( const void* leftBuf, const void* rightBuf )
-{
-    const double* left = (const double*) leftBuf;
-    const double* right = (const double*) rightBuf;
-
-    if ( !EqualFloat64( &left[0], &right[0] ) )
-        return false;
-
-    return EqualFloat64( &left[1], &right[1] );
-}
-
-bool EqualComplex80( const void* leftBuf, const void* rightBuf )
-{
-    const Real10* left = (const Real10*) leftBuf;
-    const Real10* right = (const Real10*) rightBuf;
-
-    if ( !EqualFloat80( &left[0], &right[0] ) )
-        return false;
-
-    return EqualFloat80( &left[1], &right[1] );
-}
-
-EqualsFunc GetFloatingEqualsFunc( MagoEE::Type* type )
-{
-    _ASSERT( type != NULL );
-    _ASSERT( type->IsFloatingPoint() );
-
-    EqualsFunc  equals = NULL;
-
-    if ( type->IsComplex() )
-    {
-        switch ( type->GetSize() )
-        {
-        case 8: equals = EqualComplex32;  break;
-        case 16: equals = EqualComplex64;  break;
-        case 20: equals = EqualComplex80;  break;
-        default: _ASSERT( false ); break;
-        }
-    }
-    else
-    {
-        switch ( type->GetSize() )
-        {
-        case 4: equals = EqualFloat32;  break;
-        case 8: equals = EqualFloat64;  break;
-        case 10: equals = EqualFloat80;  break;
-        default: _ASSERT( false ); break;
-        }
-    }
-
-    return equals;
-}
-
-bool EqualFloat( size_t typeSize, const Real10& left, const Real10& right )
-{
-    if ( left.IsNan() && right.IsNan() )
-        return true;
-
-    switch ( typeSize )
-    {
-    case 4: return left.ToFloat() == right.ToFloat();
-    case 8: return left.ToDouble() == right.ToDouble();
-    case 10: 
-        uint16_t comp = Real10::Compare( left, right );
-        return Real10::IsEqual( comp );
-    }
-
-    return false;
-}
-
-bool EqualValue( MagoEE::Type* type, const MagoEE::DataValue& left, const MagoEE::DataValue& right )
-{
-    if ( type->IsPointer() )
-    {
-        return left.Addr == right.Addr;
-    }
-    else if ( type->IsIntegral() )
-    {
-        return left.UInt64Value == right.UInt64Value;
-    }
-    else if ( type->IsReal() || type->IsImaginary() )
-    {
-        return EqualFloat( type->GetSize(), left.Float80Value, right.Float80Value );
-    }
-    else if ( type->IsComplex() )
-    {
-        size_t size = type->GetSize() / 2;
-        if ( !EqualFloat( size, left.Complex80Value.RealPart, right.Complex80Value.RealPart ) )
-            return false;
-
-        return EqualFloat( size, left.Complex80Value.ImaginaryPart, right.Complex80Value.ImaginaryPart );
-    }
-    else if ( type->IsDelegate() )
-    {
-        return (left.Delegate.ContextAddr == right.Delegate.ContextAddr) 
-            && (left.Delegate.FuncAddr == right.Delegate.FuncAddr);
-    }
-
-    return false;
-}
-
-
-static uint32_t Get16bits( const uint8_t* x )
-{
-    return *(uint16_t*) x;
-}
-
-template <class T>
-T HashOf( const void* buffer, T length )
-{
-    // This is what druntime uses to hash most values longer than 32 bits
-    /*
-    * This is Paul Hsieh's SuperFastHash algorithm, described here:
-    *   http://www.azillionmonkeys.com/qed/hash.html
-    * It is protected by the following open source license:
-    *   http://www.azillionmonkeys.com/qed/weblicense.html
-    */
-    _ASSERT( buffer != NULL );
-
-    const uint8_t* data = (uint8_t*) buffer;
-    int rem = 0;
-    T hash = 0;
-
-    rem = length & 3;
-    length >>= 2;
-
-    for ( ; length > 0; length-- )
-    {
-        hash += Get16bits( data );
-        T temp = (Get16bits( data + 2 ) << 11) ^ hash;
-        hash = (hash << 16) ^ temp;
-        data += 2 * sizeof( uint16_t );
-        hash += hash >> 11;
-    }
-
-    /* Handle end cases */
-    switch ( rem )
-    {
-    case 3: hash += Get16bits( data );
-            hash ^= hash << 16;
-            hash ^= data[sizeof( uint16_t )] << 18;
-            hash += hash >> 11;
-            break;
-    case 2: hash += Get16bits( data );
-            hash ^= hash << 11;
-            hash += hash >> 17;
-            break;
-    case 1: hash += *data;
-            hash ^= hash << 10;
-            hash += hash >> 1;
-            break;
-        default:
-            break;
-    }
-
-    /* Force "avalanching" of final 127 bits */
-    hash ^= hash << 3;
-    hash += hash >> 5;
-    hash ^= hash << 4;
-    hash += hash >> 17;
-    hash ^= hash << 25;
-    hash += hash >> 6;
-
-    return hash;
-}
-
-uint32_t HashOf32( const void* buffer, uint32_t length )
-{
-    return HashOf<uint32_t>( buffer, length );
-}
-
-uint64_t HashOf64( const void* buffer, uint32_t length )
-{
-    return HashOf<uint64_t>( buffer, length );
-}
-
-
 namespace Mago
 {
     const wchar_t AddressPrefix[] = L"0x";
@@ -145,22 +145,6 @@ HRESULT WriteInt( uint8_t* buffer, uint32_t bufSize, MagoEE::Type* type, uint64_
 HRESULT WriteFloat( uint8_t* buffer, uint32_t bufSize, MagoEE::Type* type, const Real10& val );
 HRESULT FromRawValue( const void* srcBuf, MagoEE::Type* type, MagoEE::DataValue& value );
 
-typedef bool (*EqualsFunc)( const void* leftBuf, const void* rightBuf );
-
-bool EqualFloat32( const void* leftBuf, const void* rightBuf );
-bool EqualFloat64( const void* leftBuf, const void* rightBuf );
-bool EqualFloat80( const void* leftBuf, const void* rightBuf );
-bool EqualComplex32( const void* leftBuf, const void* rightBuf );
-bool EqualComplex64( const void* leftBuf, const void* rightBuf );
-bool EqualComplex80( const void* leftBuf, const void* rightBuf );
-EqualsFunc GetFloatingEqualsFunc( MagoEE::Type* type );
-
-bool EqualFloat( size_t typeSize, const Real10& left, const Real10& right );
-bool EqualValue( MagoEE::Type* type, const MagoEE::DataValue& left, const MagoEE::DataValue& right );
-
-uint32_t HashOf32( const void* buffer, uint32_t length );
-uint64_t HashOf64( const void* buffer, uint32_t length );
-
 
 struct HeapDeleter
 {
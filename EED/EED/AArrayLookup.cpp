@@ -0,0 +1,1096 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#include "Common.h"
+#include "EED.h"
+#include "AArrayLookup.h"
+#include "Type.h"
+
+#include <algorithm>
+
+
+const HRESULT E_NOT_FOUND = HRESULT_FROM_WIN32( ERROR_NOT_FOUND );
+
+
+struct TypeInfo_Struct32
+{
+    uint32_t    vptr;
+    uint32_t    monitor;
+
+    DArray32    name;       // string
+    DArray32    m_init;     // void[]
+    uint32_t    xtoHash;    // size_t   function(in void*)
+    uint32_t    xopEquals;  // bool     function(in void*, in void*)
+    uint32_t    xopCmp;     // int      function(in void*, in void*)
+    uint32_t    xtoString;  // char[]   function(in void*)
+    uint32_t    m_flags;
+    uint32_t    xdtor;      // void function(void*)
+    uint32_t    xpostblit;  // void function(void*)
+    uint32_t    m_align;
+    // ...
+};
+
+struct TypeInfo_Struct64
+{
+    uint64_t    vptr;
+    uint64_t    monitor;
+
+    DArray64    name;       // string
+    DArray64    m_init;     // void[]
+    uint64_t    xtoHash;    // size_t   function(in void*)
+    uint64_t    xopEquals;  // bool     function(in void*, in void*)
+    uint64_t    xopCmp;     // int      function(in void*, in void*)
+    uint64_t    xtoString;  // char[]   function(in void*)
+    uint32_t    m_flags;
+    uint64_t    xdtor;      // void function(void*)
+    uint64_t    xpostblit;  // void function(void*)
+    uint32_t    m_align;
+};
+
+
+namespace MagoEE
+{
+    // the longest chain or probe sequence that's followed
+    const uint32_t  MaxSearchNodes = 1000000;
+    // the hash of a bucket of the open addressing layout that was never used
+    const uint64_t  HashEmpty = 0;
+
+
+    //------------------------------------------------------------------------
+    //  Comparing and hashing keys
+    //------------------------------------------------------------------------
+
+    typedef bool (*EqualsFunc)( const void* leftBuf, const void* rightBuf );
+
+    static bool EqualFloat32( const void* leftBuf, const void* rightBuf )
+    {
+        const float* left = (const float*) leftBuf;
+        const float* right = (const float*) rightBuf;
+
+        // NaNs have to match
+        if ( (*left != *left) && (*right != *right) )
+            return true;
+
+        return *left == *right;
+    }
+
+    static bool EqualFloat64( const void* leftBuf, const void* rightBuf )
+    {
+        const double* left = (const double*) leftBuf;
+        const double* right = (const double*) rightBuf;
+
+        // NaNs have to match
+        if ( (*left != *left) && (*right != *right) )
+            return true;
+
+        return *left == *right;
+    }
+
+    static bool EqualFloat80( const void* leftBuf, const void* rightBuf )
+    {
+        const Real10* left = (const Real10*) leftBuf;
+        const Real10* right = (const Real10*) rightBuf;
+
+        if ( left->IsNan() && right->IsNan() )
+            return true;
+
+        uint16_t comp = Real10::Compare( *left, *right );
+        return Real10::IsEqual( comp );
+    }
+
+    static bool EqualComplex32( const void* leftBuf, const void* rightBuf )
+    {
+        const float* left = (const float*) leftBuf;
+        const float* right = (const float*) rightBuf;
+
+        if ( !EqualFloat32( &left[0], &right[0] ) )
+            return false;
+
+        return EqualFloat32( &left[1], &right[1] );
+    }
+
+    static bool EqualComplex64( const void* leftBuf, const void* rightBuf )
+    {
+        const double* left = (const double*) leftBuf;
+        const double* right = (const double*) rightBuf;
+
+        if ( !EqualFloat64( &left[0], &right[0] ) )
+            return false;
+
+        return EqualFloat64( &left[1], &right[1] );
+    }
+
+    static bool EqualComplex80( const void* leftBuf, const void* rightBuf )
+    {
+        const Real10* left = (const Real10*) leftBuf;
+        const Real10* right = (const Real10*) rightBuf;
+
+        if ( !EqualFloat80( &left[0], &right[0] ) )
+            return false;
+
+        return EqualFloat80( &left[1], &right[1] );
+    }
+
+    static EqualsFunc GetFloatingEqualsFunc( Type* type )
+    {
+        _ASSERT( type != NULL );
+        _ASSERT( type->IsFloatingPoint() );
+
+        EqualsFunc  equals = NULL;
+
+        if ( type->IsComplex() )
+        {
+            switch ( type->GetSize() )
+            {
+            case 8: equals = EqualComplex32;  break;
+            case 16: equals = EqualComplex64;  break;
+            case 20: equals = EqualComplex80;  break;
+            default: _ASSERT( false ); break;
+            }
+        }
+        else
+        {
+            switch ( type->GetSize() )
+            {
+            case 4: equals = EqualFloat32;  break;
+            case 8: equals = EqualFloat64;  break;
+            case 10: equals = EqualFloat80;  break;
+            default: _ASSERT( false ); break;
+            }
+        }
+
+        return equals;
+    }
+
+    static bool EqualFloat( size_t typeSize, const Real10& left, const Real10& right )
+    {
+        if ( left.IsNan() && right.IsNan() )
+            return true;
+
+        switch ( typeSize )
+        {
+        case 4: return left.ToFloat() == right.ToFloat();
+        case 8: return left.ToDouble() == right.ToDouble();
+        case 10:
+            uint16_t comp = Real10::Compare( left, right );
+            return Real10::IsEqual( comp );
+        }
+
+        return false;
+    }
+
+    static bool EqualValue( Type* type, const DataValue& left, const DataValue& right )
+    {
+        if ( type->IsPointer() )
+        {
+            return left.Addr == right.Addr;
+        }
+        else if ( type->IsIntegral() )
+        {
+            return left.UInt64Value == right.UInt64Value;
+        }
+        else if ( type->IsReal() || type->IsImaginary() )
+        {
+            return EqualFloat( type->GetSize(), left.Float80Value, right.Float80Value );
+        }
+        else if ( type->IsComplex() )
+        {
+            size_t size = type->GetSize() / 2;
+            if ( !EqualFloat( size, left.Complex80Value.RealPart, right.Complex80Value.RealPart ) )
+                return false;
+
+            return EqualFloat( size, left.Complex80Value.ImaginaryPart, right.Complex80Value.ImaginaryPart );
+        }
+        else if ( type->IsDelegate() )
+        {
+            return (left.Delegate.ContextAddr == right.Delegate.ContextAddr)
+                && (left.Delegate.FuncAddr == right.Delegate.FuncAddr);
+        }
+
+        return false;
+    }
+
+    static bool EqualArray(
+        Type* elemType,
+        uint32_t length,
+        const void* keyBuf,
+        const void* nodeArrayBuf )
+    {
+        // key and nodeKey array lengths match, because they're the same type
+        uint32_t        size = length * elemType->GetSize();
+
+        if ( elemType->IsIntegral()
+            || elemType->IsPointer()
+            || elemType->IsDelegate() )
+        {
+            return memcmp( keyBuf, nodeArrayBuf, size ) == 0;
+        }
+        else if ( elemType->IsFloatingPoint() )
+        {
+            uint32_t    elemSize = elemType->GetSize();
+            EqualsFunc  equals = GetFloatingEqualsFunc( elemType );
+
+            if ( equals == NULL )
+                return false;
+
+            for ( uint32_t i = 0; i < length; i++ )
+            {
+                uint32_t    offset = i * elemSize;
+                if ( !equals( (uint8_t*) keyBuf + offset, (uint8_t*) nodeArrayBuf + offset ) )
+                    return false;
+            }
+
+            return true;
+        }
+        else if ( elemType->AsTypeStruct() != NULL )
+        {
+            // TODO: you have to compare each element
+            //       with structs, only compare upto init().length
+            return memcmp( keyBuf, nodeArrayBuf, size ) == 0;
+        }
+
+        return false;
+    }
+
+    static uint32_t Get16bits( const uint8_t* x )
+    {
+        return *(uint16_t*) x;
+    }
+
+    template <class T>
+    static T HashOf( const void* buffer, T length )
+    {
+        // This is what druntime uses to hash most values longer than 32 bits
+        /*
+        * This is Paul Hsieh's SuperFastHash algorithm, described here:
+        *   http://www.azillionmonkeys.com/qed/hash.html
+        * It is protected by the following open source license:
+        *   http://www.azillionmonkeys.com/qed/weblicense.html
+        */
+        _ASSERT( buffer != NULL );
+
+        const uint8_t* data = (uint8_t*) buffer;
+        int rem = 0;
+        T hash = 0;
+
+        rem = length & 3;
+        length >>= 2;
+
+        for ( ; length > 0; length-- )
+        {
+            hash += Get16bits( data );
+            T temp = (Get16bits( data + 2 ) << 11) ^ hash;
+            hash = (hash << 16) ^ temp;
+            data += 2 * sizeof( uint16_t );
+            hash += hash >> 11;
+        }
+
+        /* Handle end cases */
+        switch ( rem )
+        {
+        case 3: hash += Get16bits( data );
+                hash ^= hash << 16;
+                hash ^= data[sizeof( uint16_t )] << 18;
+                hash += hash >> 11;
+                break;
+        case 2: hash += Get16bits( data );
+                hash ^= hash << 11;
+                hash += hash >> 17;
+                break;
+        case 1: hash += *data;
+                hash ^= hash << 10;
+                hash += hash >> 1;
+                break;
+            default:
+                break;
+        }
+
+        /* Force "avalanching" of final 127 bits */
+        hash ^= hash << 3;
+        hash += hash >> 5;
+        hash ^= hash << 4;
+        hash += hash >> 17;
+        hash ^= hash << 25;
+        hash += hash >> 6;
+
+        return hash;
+    }
+
+    // mix hash to "fix" bad hash functions
+    static uint64_t mix( uint64_t h, uint32_t ptrSize )
+    {
+        // final mix function of MurmurHash2
+        static const uint64_t m = 0x5bd1e995;
+        h ^= h >> 13;
+        h *= m;
+        if ( ptrSize == 4 )
+            h &= 0xffffffff;
+        h ^= h >> 15;
+        return h;
+    }
+
+    static const uint8_t* GetLiteralString( const DataObject& key )
+    {
+        switch ( key.Value.Array.LiteralString->Kind )
+        {
+        case StringKind_Byte:
+            return (uint8_t*) ((ByteString*) key.Value.Array.LiteralString)->Str;
+        case StringKind_Utf16:
+            return (uint8_t*) ((Utf16String*) key.Value.Array.LiteralString)->Str;
+        case StringKind_Utf32:
+            return (uint8_t*) ((Utf32String*) key.Value.Array.LiteralString)->Str;
+        }
+
+        _ASSERT( false );
+        return NULL;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  AArrayLookup
+    //------------------------------------------------------------------------
+
+    AArrayLookup::AArrayLookup( uint32_t ptrSize )
+        :   mPtrSize( ptrSize )
+    {
+        _ASSERT( (ptrSize == 4) || (ptrSize == 8) );
+    }
+
+    HRESULT AArrayLookup::FindValue(
+        IValueBinder* binder,
+        Address aArrayAddr,
+        int& aaVersion,
+        const DataObject& key,
+        Address& valueAddr )
+    {
+        _ASSERT( binder != NULL );
+        _ASSERT( key._Type != NULL );
+
+        HRESULT         hr = S_OK;
+        BB64            bb = { 0 };
+        BB64_V1         bb_v1 = { 0 };
+        uint64_t        hash = 0;
+        const uint8_t*  keyBytes = NULL;
+
+        valueAddr = 0;
+
+        hr = ReadBB( binder, aArrayAddr, aaVersion, bb, bb_v1 );
+        if ( FAILED( hr ) )
+            return hr;
+
+        if ( aaVersion != 1 && ( (bb.b.ptr == 0) || (bb.b.length == 0) ) )
+            return E_FAIL;
+        if ( aaVersion == 1 && ( (bb_v1.buckets.ptr == 0) || (bb_v1.buckets.length == 0) ) )
+            return E_FAIL;
+
+        // the open addressing layout doesn't keep the key's TypeInfo, so
+        // there's no telling whether a struct key hashes itself
+        hr = GetKeyHash( binder, key, (aaVersion == 1) ? 0 : bb.keyti, keyBytes, hash );
+        if ( FAILED( hr ) )
+            return hr;
+
+        if ( aaVersion == 1 )
+            return FindValue_V1( binder, bb_v1, hash, key, keyBytes, valueAddr );
+
+        return FindValue_V0( binder, bb, hash, key, keyBytes, valueAddr );
+    }
+
+    // druntime's TypeInfo.getHash for each type of key:
+    //
+    //  pointer                         the address
+    //  byte, short                     the value, sign extended to size_t
+    //  ubyte, ushort, bool, char,
+    //  wchar, int, uint, dchar         the value, zero extended to size_t
+    //  float, ifloat                   the bits of the value
+    //  long, ulong, double, idouble,
+    //  real, ireal, and complex types  hashOf of the bytes of the value
+    //  delegate                        hashOf of the context and function
+    //                                  pointers
+    //  char[]                          hash * 11 + c for each char
+    //  other arrays of basic types     hashOf of the bytes of the elements
+    //  other dynamic arrays            hashOf of as many bytes as elements
+    //  static arrays                   the sum of the elements' hashes
+    //  structs                         hashOf of the bytes of the struct,
+    //                                  unless it has a toHash
+    //
+    // hashOf is SuperFastHash over size_t. A hash is as wide as size_t.
+
+    HRESULT AArrayLookup::GetHash( Type* type, const DataValue& value, uint64_t& hash )
+    {
+        _ASSERT( type != NULL );
+
+        if ( type->IsPointer() )
+        {
+            hash = value.Addr;
+        }
+        else if ( type->IsIntegral() && (type->GetSize() == sizeof( uint32_t )) )
+        {
+            // TypeInfo_i hashes an int as a uint
+            hash = (uint32_t) value.UInt64Value;
+        }
+        else if ( type->IsIntegral() && (type->GetSize() < sizeof( uint32_t )) )
+        {
+            hash = value.UInt64Value;
+        }
+        else if ( type->GetBackingTy() == Tfloat32 || type->GetBackingTy() == Timaginary32 )
+        {
+            float f = value.Float80Value.ToFloat();
+            hash = *(uint32_t*) &f;
+        }
+        else if ( type->IsIntegral() && (type->GetSize() > sizeof( uint32_t )) )
+        {
+            hash = HashOf( &value.UInt64Value, sizeof value.UInt64Value );
+        }
+        else if ( type->GetBackingTy() == Tfloat64 || type->GetBackingTy() == Timaginary64 )
+        {
+            double d = value.Float80Value.ToDouble();
+            hash = HashOf( &d, sizeof d );
+        }
+        else if ( type->GetBackingTy() == Tfloat80 || type->GetBackingTy() == Timaginary80 )
+        {
+            hash = HashOf( &value.Float80Value, sizeof value.Float80Value );
+        }
+        else if ( type->GetBackingTy() == Tcomplex32 )
+        {
+            float c[2] = { value.Complex80Value.RealPart.ToFloat(), value.Complex80Value.ImaginaryPart.ToFloat() };
+            hash = HashOf( c, sizeof c );
+        }
+        else if ( type->GetBackingTy() == Tcomplex64 )
+        {
+            double c[2] = { value.Complex80Value.RealPart.ToDouble(), value.Complex80Value.ImaginaryPart.ToDouble() };
+            hash = HashOf( c, sizeof c );
+        }
+        else if ( type->GetBackingTy() == Tcomplex80 )
+        {
+            hash = HashOf( &value.Complex80Value, sizeof value.Complex80Value );
+        }
+        else if ( type->IsDelegate() )
+        {
+            // the pointers are as wide as the program's
+            if ( mPtrSize == 4 )
+            {
+                uint32_t delPtrs[2] = { (uint32_t) value.Delegate.ContextAddr, (uint32_t) value.Delegate.FuncAddr };
+                hash = HashOf( delPtrs, sizeof delPtrs );
+            }
+            else
+            {
+                uint64_t delPtrs[2] = { value.Delegate.ContextAddr, value.Delegate.FuncAddr };
+                hash = HashOf( delPtrs, sizeof delPtrs );
+            }
+        }
+        else
+            return E_FAIL;
+
+        if ( mPtrSize == 4 )
+            hash &= 0xFFFFFFFF;
+
+        return S_OK;
+    }
+
+    HRESULT AArrayLookup::ReadBB(
+        IValueBinder* binder,
+        Address addr,
+        int& aaVersion,
+        BB64& bb,
+        BB64_V1& bb_v1 )
+    {
+        HRESULT     hr = S_OK;
+        uint32_t    sizeRead = 0;
+        uint32_t    sizeV0 = (mPtrSize == 4) ? sizeof( BB32 ) : sizeof( BB64 );
+        uint32_t    sizeV1 = (mPtrSize == 4) ? sizeof( BB32_V1 ) : sizeof( BB64_V1 );
+        union
+        {
+            BB32        bb32;
+            BB32_V1     bb32_v1;
+            BB64        bb64;
+            BB64_V1     bb64_v1;
+        }           raw;
+
+        memset( &raw, 0, sizeof raw );
+
+        // If the layout isn't known, read as much as the bigger one needs,
+        // so that it doesn't have to be read again. The smaller one might
+        // end where memory does.
+        hr = binder->ReadMemory( addr, (aaVersion == 0) ? sizeV0 : sizeV1, sizeRead, (uint8_t*) &raw );
+        if ( FAILED( hr ) )
+            return hr;
+        if ( sizeRead < sizeV0 )
+            return HRESULT_FROM_WIN32( ERROR_PARTIAL_COPY );
+
+        if ( aaVersion == -1 )
+        {
+            uint64_t    length = (mPtrSize == 4) ? raw.bb32.b.length : raw.bb64.b.length;
+
+            // power of 2 indicates new AA
+            if ( length > 4 && ( length & ( length - 1 ) ) == 0 )
+                aaVersion = 1;
+            else
+                aaVersion = 0;
+        }
+
+        if ( aaVersion == 1 )
+        {
+            if ( sizeRead < sizeV1 )
+                return HRESULT_FROM_WIN32( ERROR_PARTIAL_COPY );
+
+            if ( mPtrSize == 4 )
+            {
+                bb_v1.buckets.length = raw.bb32_v1.buckets.length;
+                bb_v1.buckets.ptr = raw.bb32_v1.buckets.ptr;
+                bb_v1.used = raw.bb32_v1.used;
+                bb_v1.deleted = raw.bb32_v1.deleted;
+                bb_v1.entryTI = raw.bb32_v1.entryTI;
+                bb_v1.firstUsed = raw.bb32_v1.firstUsed;
+                bb_v1.keysz = raw.bb32_v1.keysz;
+                bb_v1.valsz = raw.bb32_v1.valsz;
+                bb_v1.valoff = raw.bb32_v1.valoff;
+                bb_v1.flags = raw.bb32_v1.flags;
+            }
+            else
+                bb_v1 = raw.bb64_v1;
+        }
+        else
+        {
+            if ( mPtrSize == 4 )
+            {
+                bb.b.length = raw.bb32.b.length;
+                bb.b.ptr = raw.bb32.b.ptr;
+                bb.firstUsedBucket = raw.bb32.firstUsedBucket;
+                bb.keyti = raw.bb32.keyti;
+                bb.nodes = raw.bb32.nodes;
+            }
+            else
+                bb = raw.bb64;
+
+            if ( bb.firstUsedBucket > bb.nodes )
+            {
+                bb.keyti = bb.firstUsedBucket; // compatibility fix for dmd before 2.067
+                bb.firstUsedBucket = 0;
+            }
+        }
+
+        return S_OK;
+    }
+
+    HRESULT AArrayLookup::ReadMemory( IValueBinder* binder, Address addr, uint32_t size, void* buffer )
+    {
+        uint32_t    sizeRead = 0;
+
+        HRESULT hr = binder->ReadMemory( addr, size, sizeRead, (uint8_t*) buffer );
+        if ( FAILED( hr ) )
+            return hr;
+
+        if ( sizeRead < size )
+            return HRESULT_FROM_WIN32( ERROR_PARTIAL_COPY );
+
+        return S_OK;
+    }
+
+    HRESULT AArrayLookup::GetKeyHash(
+        IValueBinder* binder,
+        const DataObject& key,
+        Address keyTypeInfo,
+        uint64_t& hash )
+    {
+        _ASSERT( binder != NULL );
+        _ASSERT( key._Type != NULL );
+
+        const uint8_t*  keyBytes = NULL;
+
+        return GetKeyHash( binder, key, keyTypeInfo, keyBytes, hash );
+    }
+
+    HRESULT AArrayLookup::GetKeyHash(
+        IValueBinder* binder,
+        const DataObject& key,
+        Address keyTypeInfo,
+        const uint8_t*& keyBytes,
+        uint64_t& hash )
+    {
+        HRESULT hr = S_OK;
+
+        keyBytes = NULL;
+
+        if ( key._Type->AsTypeStruct() != NULL )
+        {
+            hr = GetStructHash( binder, key, keyTypeInfo, hash );
+            if ( FAILED( hr ) )
+                return hr;
+
+            keyBytes = &mKeyBuf[0];
+        }
+        else if ( key._Type->IsSArray() || key._Type->IsDArray() )
+        {
+            hr = GetArrayHash( binder, key, keyBytes, hash );
+        }
+        else
+        {
+            hr = GetHash( key._Type, key.Value, hash );
+        }
+
+        return hr;
+    }
+
+    HRESULT AArrayLookup::GetStructHash(
+        IValueBinder* binder,
+        const DataObject& key,
+        Address keyTypeInfo,
+        uint64_t& hash )
+    {
+        HRESULT             hr = S_OK;
+        TypeInfo_Struct32   ti32 = { 0 };
+        TypeInfo_Struct64   ti64 = { 0 };
+        uint32_t            size = key._Type->GetSize();
+        MemoryRead          reads[2] = { 0 };
+
+        if ( (key.Addr == 0) || (keyTypeInfo == 0) )
+            return E_FAIL;
+
+        mKeyBuf.resize( std::max<uint32_t>( size, 1 ) );
+
+        // the TypeInfo and the key are asked for together
+        reads[0].Addr = keyTypeInfo;
+        reads[0].Size = (mPtrSize == 4) ? sizeof ti32 : sizeof ti64;
+        reads[0].Buffer = (mPtrSize == 4) ? (uint8_t*) &ti32 : (uint8_t*) &ti64;
+        reads[1].Addr = key.Addr;
+        reads[1].Size = size;
+        reads[1].Buffer = &mKeyBuf[0];
+
+        hr = binder->ReadMemory( reads, _countof( reads ) );
+        if ( FAILED( hr ) )
+            return hr;
+
+        if ( (reads[0].SizeRead < reads[0].Size) || (reads[1].SizeRead < reads[1].Size) )
+            return HRESULT_FROM_WIN32( ERROR_PARTIAL_COPY );
+
+        // if the user defined hash and compare functions,
+        // then we can't do the standard hash and compare
+        if ( mPtrSize == 4 )
+        {
+            if ( (ti32.xtoHash != 0) || (ti32.xopCmp != 0) )
+                return E_FAIL;
+        }
+        else
+        {
+            if ( (ti64.xtoHash != 0) || (ti64.xopCmp != 0) )
+                return E_FAIL;
+        }
+
+        // TODO: I think we can get init().length. Try again
+
+        // TODO: we only need to hash upto init().length, but we can't get that
+        //       from the CV debug info. So, hope that the size is the same
+        hash = HashOf( &mKeyBuf[0], size );
+        return S_OK;
+    }
+
+    HRESULT AArrayLookup::GetArrayHash(
+        IValueBinder* binder,
+        const DataObject& key,
+        const uint8_t*& keyBytes,
+        uint64_t& hash )
+    {
+        _ASSERT( key._Type->IsSArray() || key._Type->IsDArray() );
+
+        HRESULT         hr = S_OK;
+        Address         addr = 0;
+        uint32_t        size = 0;
+        Type*           elemType = key._Type->AsTypeNext()->GetNext();
+        const uint8_t*  buf = NULL;
+
+        if ( key._Type->IsDArray() && (key.Value.Array.LiteralString != NULL) )
+        {
+            buf = GetLiteralString( key );
+            if ( buf == NULL )
+                return E_UNEXPECTED;
+
+            size = key.Value.Array.LiteralString->Length * elemType->GetSize();
+        }
+        else
+        {
+            if ( key._Type->IsSArray() )
+            {
+                addr = key.Addr;
+                size = key._Type->GetSize();
+            }
+            else
+            {
+                addr = key.Value.Array.Addr;
+                size = (uint32_t) key.Value.Array.Length * elemType->GetSize();
+            }
+
+            if ( addr == 0 )
+                return E_FAIL;
+
+            mKeyBuf.resize( std::max<uint32_t>( size, 1 ) );
+
+            hr = ReadMemory( binder, addr, size, &mKeyBuf[0] );
+            if ( FAILED( hr ) )
+                return hr;
+
+            buf = &mKeyBuf[0];
+        }
+
+        if ( key._Type->IsSArray() )
+        {
+            uint32_t    length = key._Type->AsTypeSArray()->GetLength();
+            uint32_t    elemSize = elemType->GetSize();
+
+            // TODO: for structs, we only need to hash upto init().length, but we can't
+            //       get that from the CV debug info. So, hope that the size is the same
+            uint32_t    initSize = elemType->GetSize();
+
+            hash = 0;
+
+            for ( uint32_t i = 0; i < length; i++ )
+            {
+                uint32_t    offset = i * elemSize;
+                uint64_t    elemHash = 0;
+
+                if ( elemType->AsTypeStruct() != NULL )
+                {
+                    elemHash = HashOf( buf + offset, initSize );
+                }
+                else
+                {
+                    DataValue elem = { 0 };
+
+                    hr = binder->FromRawValue( buf + offset, elemType, elem );
+                    if ( FAILED( hr ) )
+                        return hr;
+
+                    hr = GetHash( elemType, elem, elemHash );
+                    if ( FAILED( hr ) )
+                        return hr;
+                }
+
+                hash += elemHash;
+                if ( mPtrSize == 4 )
+                    hash &= 0xFFFFFFFF;
+            }
+        }
+        else
+        {
+            if ( elemType->IsBasic() && elemType->IsChar() && (elemType->GetSize() == 1) )
+            {
+                hash = 0;
+
+                for ( uint32_t i = 0; i < key.Value.Array.Length; i++ )
+                {
+                    hash = hash * 11 + buf[i];
+                    if ( mPtrSize == 4 )
+                        hash &= 0xFFFFFFFF;
+                }
+            }
+            // TODO: There's a bug in druntime, where the length in elements is used as the size in bytes to hash
+            //       merge the non-basic case into the basic one when it's fixed
+            else if ( elemType->IsBasic() )
+            {
+                hash = HashOf( buf, size );
+            }
+            else
+            {
+                hash = HashOf( buf, (uint32_t) key.Value.Array.Length );
+            }
+        }
+
+        keyBytes = buf;
+        return S_OK;
+    }
+
+    HRESULT AArrayLookup::FindValue_V0(
+        IValueBinder* binder,
+        const BB64& bb,
+        uint64_t hash,
+        const DataObject& key,
+        const uint8_t* keyBytes,
+        Address& valueAddr )
+    {
+        HRESULT     hr = S_OK;
+        uint32_t    headerSize = 2 * mPtrSize;  // aaA: next, hash
+        uint32_t    keySize = key._Type->GetSize();
+        uint32_t    lenBeforeValue = headerSize + AlignTSize( keySize );
+        Address     node = 0;
+
+        mNodes.resize( headerSize + keySize );
+
+        hr = ReadMemory( binder, bb.b.ptr + (hash % bb.b.length) * mPtrSize, mPtrSize, &mNodes[0] );
+        if ( FAILED( hr ) )
+            return hr;
+
+        node = GetPointer( &mNodes[0] );
+
+        // each node's link is in the one before it, so the chain can only be
+        // read one node at a time
+        for ( uint32_t i = 0; (i < MaxSearchNodes) && (node != 0); i++ )
+        {
+            hr = ReadMemory( binder, node, headerSize + keySize, &mNodes[0] );
+            if ( FAILED( hr ) )
+                return hr;
+
+            if ( GetPointer( &mNodes[mPtrSize] ) == hash )
+            {
+                int match = -1;
+
+                hr = MatchKeys( binder, key, keyBytes, &mNodes[headerSize], keySize, 1, match );
+                if ( FAILED( hr ) )
+                    return hr;
+
+                if ( match == 0 )
+                {
+                    valueAddr = node + lenBeforeValue;
+                    return S_OK;
+                }
+            }
+
+            node = GetPointer( &mNodes[0] );
+        }
+
+        return E_NOT_FOUND;
+    }
+
+    HRESULT AArrayLookup::FindValue_V1(
+        IValueBinder* binder,
+        const BB64_V1& bb,
+        uint64_t hash,
+        const DataObject& key,
+        const uint8_t* keyBytes,
+        Address& valueAddr )
+    {
+        HRESULT     hr = S_OK;
+        uint64_t    hashFilledMark = 1ULL << (8 * mPtrSize - 1);
+        uint32_t    bucketSize = 2 * mPtrSize;  // Bucket: hash, entry
+        uint64_t    length = bb.buckets.length;
+        uint64_t    index = 0;
+        uint64_t    step = 0;
+        uint64_t    maxProbes = std::min<uint64_t>( length, MaxSearchNodes );
+        bool        ended = false;
+
+        if ( bb.keysz < key._Type->GetSize() )
+            return E_FAIL;
+
+        hash = ( mix( hash, mPtrSize ) & ( hashFilledMark - 1 ) ) | hashFilledMark;
+        index = hash % length;
+
+        mBuckets.resize( ProbeCount * bucketSize );
+
+        for ( uint64_t probed = 0; !ended && (probed < maxProbes); )
+        {
+            uint32_t    count = (uint32_t) std::min<uint64_t>( ProbeCount, maxProbes - probed );
+
+            // the next few buckets that druntime would probe are asked for
+            // together; they're close to each other, until they wrap around
+            mReads.resize( count );
+
+            for ( uint32_t i = 0; i < count; i++ )
+            {
+                mReads[i].Addr = bb.buckets.ptr + index * bucketSize;
+                mReads[i].Size = bucketSize;
+                mReads[i].Buffer = &mBuckets[i * bucketSize];
+                mReads[i].SizeRead = 0;
+
+                index = (index + ++step) % length;
+            }
+
+            probed += count;
+
+            hr = binder->ReadMemory( &mReads[0], count );
+            if ( FAILED( hr ) )
+                return hr;
+
+            mEntries.clear();
+
+            for ( uint32_t i = 0; i < count; i++ )
+            {
+                if ( mReads[i].SizeRead < bucketSize )
+                    return HRESULT_FROM_WIN32( ERROR_PARTIAL_COPY );
+
+                uint64_t    bucketHash = GetPointer( mReads[i].Buffer );
+
+                if ( bucketHash == HashEmpty )
+                {
+                    ended = true;
+                    break;
+                }
+
+                // deleted buckets are passed over, like any other hash
+                if ( bucketHash == hash )
+                    mEntries.push_back( GetPointer( mReads[i].Buffer + mPtrSize ) );
+            }
+
+            if ( mEntries.empty() )
+                continue;
+
+            // and so are the keys of the entries that could be the one
+            uint32_t    entryCount = (uint32_t) mEntries.size();
+
+            mNodes.resize( entryCount * bb.keysz );
+            mReads.resize( entryCount );
+
+            for ( uint32_t i = 0; i < entryCount; i++ )
+            {
+                mReads[i].Addr = mEntries[i];
+                mReads[i].Size = bb.keysz;
+                mReads[i].Buffer = &mNodes[i * bb.keysz];
+                mReads[i].SizeRead = 0;
+            }
+
+            hr = binder->ReadMemory( &mReads[0], entryCount );
+            if ( FAILED( hr ) )
+                return hr;
+
+            for ( uint32_t i = 0; i < entryCount; i++ )
+            {
+                if ( mReads[i].SizeRead < bb.keysz )
+                    return HRESULT_FROM_WIN32( ERROR_PARTIAL_COPY );
+            }
+
+            int match = -1;
+
+            hr = MatchKeys( binder, key, keyBytes, &mNodes[0], bb.keysz, entryCount, match );
+            if ( FAILED( hr ) )
+                return hr;
+
+            if ( match >= 0 )
+            {
+                valueAddr = mEntries[match] + bb.valoff;
+                return S_OK;
+            }
+        }
+
+        return E_NOT_FOUND;
+    }
+
+    HRESULT AArrayLookup::MatchKeys(
+        IValueBinder* binder,
+        const DataObject& key,
+        const uint8_t* keyBytes,
+        const uint8_t* nodeKeys,
+        uint32_t stride,
+        uint32_t count,
+        int& match )
+    {
+        HRESULT     hr = S_OK;
+        Type*       elemType = NULL;
+        uint32_t    arraySize = 0;
+
+        match = -1;
+
+        if ( key._Type->IsDArray() )
+        {
+            // what the node keys of the same length point to is read all at
+            // once; the others can't be equal
+            elemType = key._Type->AsTypeDArray()->GetElement();
+            arraySize = (uint32_t) key.Value.Array.Length * elemType->GetSize();
+
+            mArrays.resize( std::max<uint32_t>( count * arraySize, 1 ) );
+            mReads.resize( count );
+
+            for ( uint32_t i = 0; i < count; i++ )
+            {
+                DataValue   nodeKey = { 0 };
+
+                hr = binder->FromRawValue( nodeKeys + i * stride, key._Type, nodeKey );
+                if ( FAILED( hr ) )
+                    return hr;
+
+                mReads[i].Addr = nodeKey.Array.Addr;
+                mReads[i].Size = 0;
+                mReads[i].Buffer = NULL;
+                mReads[i].SizeRead = 0;
+
+                if ( nodeKey.Array.Length == key.Value.Array.Length )
+                {
+                    mReads[i].Size = arraySize;
+                    mReads[i].Buffer = &mArrays[i * arraySize];
+                }
+            }
+
+            hr = binder->ReadMemory( &mReads[0], count );
+            if ( FAILED( hr ) )
+                return hr;
+        }
+
+        for ( uint32_t i = 0; i < count; i++ )
+        {
+            const uint8_t*  nodeKey = nodeKeys + i * stride;
+            bool            equal = false;
+
+            if ( key._Type->AsTypeStruct() != NULL )
+            {
+                // we would also check and run TypeInfo_Struct.xopCmp, if we supported func eval
+                // TODO: actually, you have to compare upto init().length
+                equal = memcmp( keyBytes, nodeKey, key._Type->GetSize() ) == 0;
+            }
+            else if ( key._Type->IsSArray() )
+            {
+                ITypeSArray*    sarray = key._Type->AsTypeSArray();
+
+                equal = EqualArray( sarray->GetElement(), sarray->GetLength(), keyBytes, nodeKey );
+            }
+            else if ( key._Type->IsDArray() )
+            {
+                if ( (mReads[i].Buffer != NULL) && (mReads[i].SizeRead == arraySize) )
+                {
+                    equal = EqualArray(
+                        elemType,
+                        (uint32_t) key.Value.Array.Length,
+                        keyBytes,
+                        mReads[i].Buffer );
+                }
+            }
+            else
+            {
+                DataValue   nodeValue = { 0 };
+
+                hr = binder->FromRawValue( nodeKey, key._Type, nodeValue );
+                if ( FAILED( hr ) )
+                    return hr;
+
+                equal = EqualValue( key._Type, key.Value, nodeValue );
+            }
+
+            if ( equal )
+            {
+                match = (int) i;
+                break;
+            }
+        }
+
+        return S_OK;
+    }
+
+    uint64_t AArrayLookup::HashOf( const void* buffer, uint32_t length )
+    {
+        if ( mPtrSize == 4 )
+            return MagoEE::HashOf<uint32_t>( buffer, length );
+        else
+            return MagoEE::HashOf<uint64_t>( buffer, length );
+    }
+
+    uint64_t AArrayLookup::GetPointer( const uint8_t* buffer )
+    {
+        if ( mPtrSize == 4 )
+        {
+            uint32_t    ptrValue32 = 0;
+            memcpy( &ptrValue32, buffer, sizeof ptrValue32 );
+            return ptrValue32;
+        }
+
+        uint64_t    ptrValue = 0;
+        memcpy( &ptrValue, buffer, sizeof ptrValue );
+        return ptrValue;
+    }
+
+    uint32_t AArrayLookup::AlignTSize( uint32_t size )
+    {
+        if ( mPtrSize == 4 )
+            return (size + sizeof( uint32_t ) - 1) & ~(sizeof( uint32_t ) - 1);
+        else
+            return (size + 16 - 1) & ~(16 - 1);
+    }
+}
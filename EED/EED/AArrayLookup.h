@@ -0,0 +1,123 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+
+namespace MagoEE
+{
+    // Finds the value for a key in an associative array of the program, the
+    // way druntime does it: the key is hashed like its TypeInfo.getHash
+    // does, and the nodes or entries it could be in are compared with it.
+    // Both the chained layout from before dmd 2.067 and the open addressing
+    // one after it are understood.
+    //
+    // Memory is read through a binder. The buckets that the open addressing
+    // layout probes are asked for together, and so are the keys of the
+    // entries whose hashes match. The buffers they're read into are kept
+    // from one lookup to the next.
+
+    class AArrayLookup
+    {
+        uint32_t                mPtrSize;
+        std::vector<uint8_t>    mKeyBuf;    // the key, if it's a struct or an array
+        std::vector<uint8_t>    mBuckets;   // the buckets being probed
+        std::vector<uint8_t>    mNodes;     // the nodes or keys being compared
+        std::vector<uint8_t>    mArrays;    // what the nodes' array keys point to
+        std::vector<Address>    mEntries;   // the entries whose hashes match
+        std::vector<MemoryRead> mReads;
+
+    public:
+        // how many buckets of the open addressing layout are read at once;
+        // a lookup in a full table rarely probes more
+        static const uint32_t   ProbeCount = 8;
+
+        AArrayLookup( uint32_t ptrSize );
+
+        // Sets valueAddr to the address of the value for key in the
+        // associative array whose implementation is at aArrayAddr. aaVersion
+        // is the layout: 0 for chained and 1 for open addressing. If it's -1,
+        // it's worked out from the number of buckets, and set. Returns
+        // E_NOT_FOUND if the key isn't there.
+        HRESULT FindValue(
+            IValueBinder* binder,
+            Address aArrayAddr,
+            int& aaVersion,
+            const DataObject& key,
+            Address& valueAddr );
+
+        // Hashes a value of a basic type, a pointer, or a delegate the way
+        // druntime's TypeInfo for the type does.
+        HRESULT GetHash( Type* type, const DataValue& value, uint64_t& hash );
+
+        // Hashes a key of any type the way druntime does, reading what the
+        // key points to through binder. keyTypeInfo is the address of the
+        // key's TypeInfo, which only struct keys need.
+        HRESULT GetKeyHash(
+            IValueBinder* binder,
+            const DataObject& key,
+            Address keyTypeInfo,
+            uint64_t& hash );
+
+    private:
+        HRESULT ReadBB(
+            IValueBinder* binder,
+            Address addr,
+            int& aaVersion,
+            BB64& bb,
+            BB64_V1& bb_v1 );
+        HRESULT ReadMemory( IValueBinder* binder, Address addr, uint32_t size, void* buffer );
+
+        HRESULT GetKeyHash(
+            IValueBinder* binder,
+            const DataObject& key,
+            Address keyTypeInfo,
+            const uint8_t*& keyBytes,
+            uint64_t& hash );
+        HRESULT GetStructHash(
+            IValueBinder* binder,
+            const DataObject& key,
+            Address keyTypeInfo,
+            uint64_t& hash );
+        HRESULT GetArrayHash(
+            IValueBinder* binder,
+            const DataObject& key,
+            const uint8_t*& keyBytes,
+            uint64_t& hash );
+
+        HRESULT FindValue_V0(
+            IValueBinder* binder,
+            const BB64& bb,
+            uint64_t hash,
+            const DataObject& key,
+            const uint8_t* keyBytes,
+            Address& valueAddr );
+        HRESULT FindValue_V1(
+            IValueBinder* binder,
+            const BB64_V1& bb,
+            uint64_t hash,
+            const DataObject& key,
+            const uint8_t* keyBytes,
+            Address& valueAddr );
+
+        // Compares the key with count node keys that were read one after
+        // another, stride bytes apart, and sets the index of the first one
+        // that's equal, or -1.
+        HRESULT MatchKeys(
+            IValueBinder* binder,
+            const DataObject& key,
+            const uint8_t* keyBytes,
+            const uint8_t* nodeKeys,
+            uint32_t stride,
+            uint32_t count,
+            int& match );
+
+        uint64_t HashOf( const void* buffer, uint32_t length );
+        uint64_t GetPointer( const uint8_t* buffer );
+        uint32_t AlignTSize( uint32_t size );
+    };
+}
@@ -0,0 +1,625 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+// Bytecode: the interpreter for compiled expressions
+
+#include "Common.h"
+#include "Bytecode.h"
+#include "Declaration.h"
+#include "Type.h"
+#include "TypeCommon.h"
+
+
+namespace MagoEE
+{
+    //----------------------------------------------------------------------------
+    //  Bytecode
+    //----------------------------------------------------------------------------
+
+    Bytecode::Bytecode()
+        :   mRegCount( 0 )
+    {
+    }
+
+    Bytecode::~Bytecode()
+    {
+    }
+
+    HRESULT Bytecode::Run( const EvalData& evalData, IValueBinder* binder, DataObject& obj )
+    {
+        _ASSERT( mRegCount <= MaxRegisters );
+        _ASSERT( mCode.size() > 0 );
+
+        HRESULT             hr = S_OK;
+        DataObject          temps[MaxRegisters];
+        DataObject*         regs[MaxRegisters];
+        const Instruction*  code = &mCode[0];
+        uint32_t            count = (uint32_t) mCode.size();
+        uint32_t            pc = 0;
+
+        // register 0 is the result, the rest start out cleared, like the
+        // walker's DataObjects for subexpressions
+        regs[0] = &obj;
+
+        for ( uint32_t i = 1; i < mRegCount; i++ )
+        {
+            temps[i].Addr = 0;
+            memset( &temps[i].Value, 0, sizeof temps[i].Value );
+            regs[i] = &temps[i];
+        }
+
+        while ( pc < count )
+        {
+            const Instruction&  inst = code[pc];
+            DataObject&         dest = *regs[inst.Dest];
+
+            pc++;
+
+            // only the result's type is ever looked at
+            if ( (inst.Dest == 0) && (inst._Type != NULL) )
+                dest._Type = inst._Type;
+
+            switch ( inst.Op )
+            {
+            case BOp_Tree:
+                hr = inst.Node->Evaluate( (EvalMode) inst.Mode, evalData, binder, dest );
+                break;
+
+            case BOp_Const:
+                dest.Addr = 0;
+                dest.Value.UInt64Value = inst.Imm;
+                break;
+
+            case BOp_Var:
+                binder->GetAddress( inst.Decl, dest.Addr );
+                hr = Load( binder, inst, dest );
+                break;
+
+            case BOp_Field:
+                {
+                    const DataObject&   parent = *regs[inst.A];
+                    Address             base = parent.Value.Addr;
+
+                    if ( inst.Kind == AddrKind_Object )
+                        base = parent.Addr;
+
+                    if ( base == 0 )
+                    {
+                        hr = E_FAIL;
+                        break;
+                    }
+
+                    dest.Addr = base + inst.Imm;
+                    hr = Load( binder, inst, dest );
+                }
+                break;
+
+            case BOp_Deref:
+            case BOp_Index:
+                {
+                    const DataObject&   array = *regs[inst.A];
+
+                    if ( inst.Kind == AddrKind_Object )
+                        dest.Addr = array.Addr;
+                    else if ( inst.Kind == AddrKind_Array )
+                        dest.Addr = array.Value.Array.Addr;
+                    else
+                        dest.Addr = array.Value.Addr;
+
+                    if ( inst.Op == BOp_Index )
+                    {
+                        uint32_t    size = inst.Size;
+                        doffset_t   offset = size * regs[inst.B]->Value.Int64Value;
+                        dest.Addr += offset;
+                    }
+
+                    if ( inst.Mode == EvalMode_Value )
+                        hr = binder->GetValue( dest.Addr, inst._Type, dest.Value );
+                }
+                break;
+
+            case BOp_CheckAddr:
+                if ( regs[inst.A]->Addr == 0 )
+                    hr = E_FAIL;
+                break;
+
+            case BOp_AddressOf:
+                if ( regs[inst.A]->Addr == 0 )
+                {
+                    hr = E_MAGOEE_NO_ADDRESS;
+                    break;
+                }
+
+                dest.Value.Addr = regs[inst.A]->Addr;
+                break;
+
+            case BOp_Add:
+            case BOp_Sub:
+            case BOp_Mul:
+            case BOp_Div:
+            case BOp_Mod:
+            case BOp_And:
+            case BOp_Or:
+            case BOp_Xor:
+                {
+                    uint64_t    left = Promote( regs[inst.A]->Value.UInt64Value, inst.PromoteA );
+                    uint64_t    right = Promote( regs[inst.B]->Value.UInt64Value, inst.PromoteB );
+
+                    dest.Addr = 0;
+                    hr = IntegerOp( inst.Op, inst.Kind != 0, left, right, dest.Value.UInt64Value );
+                    dest.Value.UInt64Value = Promote( dest.Value.UInt64Value, inst.PromoteDest );
+                }
+                break;
+
+            case BOp_Shl:
+            case BOp_Shr:
+            case BOp_UShr:
+                {
+                    uint64_t    left = regs[inst.A]->Value.UInt64Value;
+                    uint32_t    shiftAmount = (uint32_t) regs[inst.B]->Value.UInt64Value;
+                    uint64_t    result = 0;
+
+                    // Size is the mask
+                    shiftAmount &= inst.Size;
+
+                    if ( inst.Op == BOp_Shl )
+                        result = left << shiftAmount;
+                    else if ( inst.Op == BOp_Shr )
+                    {
+                        if ( inst.Kind != 0 )
+                            result = ((int64_t) left) >> shiftAmount;
+                        else
+                            result = left >> shiftAmount;
+                    }
+                    else
+                    {
+                        // Kind is the size of the left side
+                        switch ( inst.Kind )
+                        {
+                        case 1: result = ((uint8_t) left) >> shiftAmount;   break;
+                        case 2: result = ((uint16_t) left) >> shiftAmount;  break;
+                        case 4: result = ((uint32_t) left) >> shiftAmount;  break;
+                        case 8: result = ((uint64_t) left) >> shiftAmount;  break;
+                        default: result = 0;
+                        }
+                    }
+
+                    dest.Value.UInt64Value = Promote( result, inst.PromoteDest );
+                    dest.Addr = 0;
+                }
+                break;
+
+            case BOp_PtrAdd:
+            case BOp_PtrSub:
+                {
+                    const DataObject*   ptr = regs[inst.A];
+                    const DataObject*   index = regs[inst.B];
+                    uint32_t            size = inst.Size;
+
+                    // Kind is set when the pointer is on the right
+                    if ( inst.Kind != 0 )
+                    {
+                        ptr = regs[inst.B];
+                        index = regs[inst.A];
+                    }
+
+                    Address     addr = ptr->Value.Addr;
+                    doffset_t   offset = index->Value.Int64Value;
+
+                    if ( inst.Op == BOp_PtrAdd )
+                        dest.Value.Addr = addr + (size * offset);
+                    else
+                        dest.Value.Addr = addr - (size * offset);
+
+                    dest.Addr = 0;
+                }
+                break;
+
+            case BOp_PtrDiff:
+                {
+                    uint32_t    size = inst.Size;
+
+                    dest.Value.Int64Value = (regs[inst.A]->Value.Addr - regs[inst.B]->Value.Addr);
+                    dest.Value.Int64Value /= size;                      // make sure it's a signed divide
+                    dest.Addr = 0;
+                }
+                break;
+
+            case BOp_Negate:
+                dest.Value.UInt64Value = -dest.Value.Int64Value;
+                dest.Value.UInt64Value = Promote( dest.Value.UInt64Value, inst.PromoteDest );
+                dest.Addr = 0;
+                break;
+
+            case BOp_BitNot:
+                dest.Value.UInt64Value = ~dest.Value.UInt64Value;
+                dest.Value.UInt64Value = Promote( dest.Value.UInt64Value, inst.PromoteDest );
+                dest.Addr = 0;
+                break;
+
+            case BOp_Compare:
+                {
+                    uint64_t    left = Promote( regs[inst.A]->Value.UInt64Value, inst.PromoteA );
+                    uint64_t    right = Promote( regs[inst.B]->Value.UInt64Value, inst.PromoteB );
+                    bool        result = false;
+
+                    if ( inst.Kind != 0 )
+                        result = CompareExpr::IntegerOp( inst.Code, (int64_t) left, (int64_t) right );
+                    else
+                        result = CompareExpr::IntegerOp( inst.Code, left, right );
+
+                    dest.Value.UInt64Value = result ? 1 : 0;
+                    dest.Addr = 0;
+                }
+                break;
+
+            case BOp_CompareAddr:
+                {
+                    Address     left = regs[inst.A]->Value.Addr;
+                    Address     right = regs[inst.B]->Value.Addr;
+
+                    dest.Value.UInt64Value = CompareExpr::IntegerOp( inst.Code, left, right ) ? 1 : 0;
+                    dest.Addr = 0;
+                }
+                break;
+
+            case BOp_ToBool:
+                // Imm is set for Not
+                if ( inst.Imm != 0 )
+                    dest.Value.UInt64Value = ToBool( *regs[inst.A], inst.Kind ) ? 0 : 1;
+                else
+                    dest.Value.UInt64Value = ToBool( *regs[inst.A], inst.Kind ) ? 1 : 0;
+                dest.Addr = 0;
+                break;
+
+            case BOp_CastBool:
+                dest.Value.UInt64Value = ToBool( *regs[inst.A], inst.Kind ) ? 1 : 0;
+                break;
+
+            case BOp_CastInt:
+                dest.Value.UInt64Value = regs[inst.A]->Value.UInt64Value;
+                dest.Value.UInt64Value = Promote( dest.Value.UInt64Value, inst.PromoteDest );
+                break;
+
+            case BOp_CastPtr:
+                {
+                    const DataObject&   source = *regs[inst.A];
+
+                    switch ( inst.Kind )
+                    {
+                    case AddrKind_Value:    dest.Value.Addr = source.Value.Addr + inst.Imm;   break;
+                    case AddrKind_Object:   dest.Value.Addr = source.Addr;  break;
+                    case AddrKind_Array:    dest.Value.Addr = source.Value.Array.Addr;  break;
+                    case AddrKind_Delegate: dest.Value.Addr = source.Value.Delegate.ContextAddr;    break;
+                    }
+
+                    if ( inst.Size == 4 )
+                        dest.Value.Addr &= 0xFFFFFFFF;
+                }
+                break;
+
+            case BOp_Jump:
+                pc = (uint32_t) inst.Imm;
+                break;
+
+            case BOp_JumpIfFalse:
+                if ( !ToBool( *regs[inst.A], inst.Kind ) )
+                    pc = (uint32_t) inst.Imm;
+                break;
+
+            case BOp_JumpIfTrue:
+                if ( ToBool( *regs[inst.A], inst.Kind ) )
+                    pc = (uint32_t) inst.Imm;
+                break;
+
+            default:
+                _ASSERT( false );
+                hr = E_FAIL;
+                break;
+            }
+
+            if ( FAILED( hr ) )
+                return hr;
+        }
+
+        return S_OK;
+    }
+
+    // the end of IdExpr::Evaluate and DotExpr::Evaluate
+    HRESULT Bytecode::Load( IValueBinder* binder, const Instruction& inst, DataObject& obj )
+    {
+        if ( inst.Mode == EvalMode_Address )
+        {
+            if ( obj.Addr != 0 )
+                return S_OK;
+
+            return E_MAGOEE_NO_ADDRESS;
+        }
+
+        if ( obj.Addr == 0 )
+            return binder->GetValue( inst.Decl, obj.Value );
+
+        return binder->GetValue( obj.Addr, inst._Type, obj.Value );
+    }
+
+    uint64_t Bytecode::Promote( uint64_t value, uint8_t kind )
+    {
+        switch ( kind )
+        {
+        case Promote_Int8:      return (int8_t) value;
+        case Promote_UInt8:     return (uint8_t) value;
+        case Promote_Int16:     return (int16_t) value;
+        case Promote_UInt16:    return (uint16_t) value;
+        case Promote_Int32:     return (int32_t) value;
+        case Promote_UInt32:    return (uint32_t) value;
+        case Promote_Int8To32:  return (uint32_t) (int8_t) value;
+        case Promote_Int16To32: return (uint32_t) (int16_t) value;
+        case Promote_Zero:      return 0;
+        }
+
+        return value;
+    }
+
+    bool Bytecode::ToBool( const DataObject& obj, uint8_t kind )
+    {
+        switch ( kind )
+        {
+        case Bool_Value:
+            return obj.Value.UInt64Value != 0;
+
+        case Bool_Complex:
+            return !obj.Value.Complex80Value.RealPart.IsZero()
+                || !obj.Value.Complex80Value.ImaginaryPart.IsZero();
+
+        case Bool_Float:
+            return !obj.Value.Float80Value.IsZero();
+
+        case Bool_ArrayAddr:
+            return obj.Value.Array.Addr != 0;
+
+        case Bool_ObjectAddr:
+            return obj.Addr != 0;
+
+        case Bool_Delegate:
+            return (obj.Value.Delegate.ContextAddr != 0) || (obj.Value.Delegate.FuncAddr != 0);
+        }
+
+        _ASSERT( false );
+        return false;
+    }
+
+    HRESULT Bytecode::IntegerOp( uint8_t op, bool isSigned, uint64_t left, uint64_t right, uint64_t& result )
+    {
+        if ( isSigned )
+        {
+            int64_t     sleft = (int64_t) left;
+            int64_t     sright = (int64_t) right;
+            int64_t     sresult = 0;
+
+            switch ( op )
+            {
+            case BOp_Add:   sresult = sleft + sright;   break;
+            case BOp_Sub:   sresult = sleft - sright;   break;
+            case BOp_Mul:   sresult = sleft * sright;   break;
+            case BOp_And:   sresult = sleft & sright;   break;
+            case BOp_Or:    sresult = sleft | sright;   break;
+            case BOp_Xor:   sresult = sleft ^ sright;   break;
+            case BOp_Div:
+                if ( sright == 0 )
+                    return E_MAGOEE_DIVIDE_BY_ZERO;
+                sresult = sleft / sright;
+                break;
+            case BOp_Mod:
+                if ( sright == 0 )
+                    return E_MAGOEE_DIVIDE_BY_ZERO;
+                sresult = sleft % sright;
+                break;
+            default:
+                _ASSERT( false );
+                return E_FAIL;
+            }
+
+            result = (uint64_t) sresult;
+        }
+        else
+        {
+            switch ( op )
+            {
+            case BOp_Add:   result = left + right;  break;
+            case BOp_Sub:   result = left - right;  break;
+            case BOp_Mul:   result = left * right;  break;
+            case BOp_And:   result = left & right;  break;
+            case BOp_Or:    result = left | right;  break;
+            case BOp_Xor:   result = left ^ right;  break;
+            case BOp_Div:
+                if ( right == 0 )
+                    return E_MAGOEE_DIVIDE_BY_ZERO;
+                result = left / right;
+                break;
+            case BOp_Mod:
+                if ( right == 0 )
+                    return E_MAGOEE_DIVIDE_BY_ZERO;
+                result = left % right;
+                break;
+            default:
+                _ASSERT( false );
+                return E_FAIL;
+            }
+        }
+
+        return S_OK;
+    }
+
+
+    //----------------------------------------------------------------------------
+    //  BytecodeCompiler
+    //----------------------------------------------------------------------------
+
+    BytecodeCompiler::BytecodeCompiler( ITypeEnv* typeEnv )
+        :   mRegCount( 1 ),
+            mTypeEnv( typeEnv )
+    {
+        _ASSERT( typeEnv != NULL );
+
+        // enough for most watches and conditions without growing
+        mCode.reserve( 16 );
+    }
+
+    ITypeEnv* BytecodeCompiler::GetTypeEnv()
+    {
+        return mTypeEnv;
+    }
+
+    HRESULT BytecodeCompiler::Compile( Expression* root, Bytecode*& code )
+    {
+        _ASSERT( root != NULL );
+
+        HRESULT hr = S_OK;
+
+        hr = root->Compile( *this, EvalMode_Value, 0 );
+        if ( FAILED( hr ) )
+            return hr;
+
+        // nothing gained over the walker
+        if ( (mCode.size() == 0)
+            || ((mCode.size() == 1) && (mCode[0].Op == BOp_Tree)) )
+            return E_FAIL;
+
+        Bytecode*   newCode = new Bytecode();
+        if ( newCode == NULL )
+            return E_OUTOFMEMORY;
+
+        // only keep what's used
+        newCode->mCode.assign( mCode.begin(), mCode.end() );
+        newCode->mRegCount = mRegCount;
+
+        code = newCode;
+        return S_OK;
+    }
+
+    HRESULT BytecodeCompiler::NewRegister( uint8_t& reg )
+    {
+        if ( mRegCount >= Bytecode::MaxRegisters )
+            return E_FAIL;
+
+        reg = (uint8_t) mRegCount;
+        mRegCount++;
+        return S_OK;
+    }
+
+    Instruction& BytecodeCompiler::Emit( BytecodeOp op, uint8_t dest, Type* type )
+    {
+        Instruction inst = { 0 };
+
+        inst.Op = (uint8_t) op;
+        inst.Dest = dest;
+        inst._Type = type;
+
+        mCode.push_back( inst );
+        return mCode.back();
+    }
+
+    HRESULT BytecodeCompiler::EmitTree( Expression* node, EvalMode mode, uint8_t dest )
+    {
+        _ASSERT( node != NULL );
+
+        // the walker sets the type
+        Instruction&    inst = Emit( BOp_Tree, dest, NULL );
+
+        inst.Node = node;
+        inst.Mode = (uint8_t) mode;
+        return S_OK;
+    }
+
+    uint32_t BytecodeCompiler::GetPosition()
+    {
+        return (uint32_t) mCode.size();
+    }
+
+    void BytecodeCompiler::SetTarget( uint32_t jumpPos )
+    {
+        _ASSERT( jumpPos < mCode.size() );
+        mCode[jumpPos].Imm = mCode.size();
+    }
+
+    bool BytecodeCompiler::HasTree( uint32_t position )
+    {
+        for ( uint32_t i = position; i < mCode.size(); i++ )
+        {
+            if ( mCode[i].Op == BOp_Tree )
+                return true;
+        }
+
+        return false;
+    }
+
+    void BytecodeCompiler::Rewind( uint32_t position )
+    {
+        _ASSERT( position <= mCode.size() );
+        mCode.resize( position );
+    }
+
+    uint8_t BytecodeCompiler::GetPromoteKind( Type* type )
+    {
+        switch ( type->GetBackingTy() )
+        {
+        case Tint32:    return Promote_Int32;
+        case Tuns32:    return Promote_UInt32;
+        case Tint16:    return Promote_Int16;
+        case Tuns16:    return Promote_UInt16;
+        case Tint8:     return Promote_Int8;
+        case Tuns8:     return Promote_UInt8;
+        }
+
+        return Promote_None;
+    }
+
+    uint8_t BytecodeCompiler::GetPromoteKind( Type* type, Type* targetType )
+    {
+        if ( (targetType->GetSize() == 8) || targetType->IsSigned() )
+            return GetPromoteKind( type );
+
+        // PromoteInPlace goes through a uint32_t, and leaves it 0 for the
+        // other types
+        switch ( type->GetBackingTy() )
+        {
+        case Tint32:    return Promote_UInt32;
+        case Tuns32:    return Promote_UInt32;
+        case Tint16:    return Promote_Int16To32;
+        case Tuns16:    return Promote_UInt16;
+        case Tint8:     return Promote_Int8To32;
+        case Tuns8:     return Promote_UInt8;
+        }
+
+        return Promote_Zero;
+    }
+
+    uint8_t BytecodeCompiler::GetBoolKind( Type* type )
+    {
+        // in the order of Expression::ConvertToBool
+        if ( type->IsPointer() )
+            return Bool_Value;
+        else if ( type->IsComplex() )
+            return Bool_Complex;
+        else if ( type->IsImaginary() )
+            return Bool_Float;
+        else if ( type->IsFloatingPoint() )
+            return Bool_Float;
+        else if ( type->IsIntegral() )
+            return Bool_Value;
+        else if ( type->IsDArray() )
+            return Bool_ArrayAddr;
+        else if ( type->IsSArray() )
+            return Bool_ObjectAddr;
+        else if ( type->IsAArray() )
+            return Bool_Value;
+        else if ( type->IsDelegate() )
+            return Bool_Delegate;
+
+        return Bool_None;
+    }
+}
@@ -0,0 +1,175 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+#include "Expression.h"
+
+
+namespace MagoEE
+{
+    // A bound expression can be compiled to a short list of instructions over
+    // registers of DataObjects. Everything the tree walker works out from the
+    // types on each evaluation (common types, promotions, element sizes,
+    // field offsets) is worked out once here.
+    //
+    // Nodes that don't compile, like floating point and array operations,
+    // become a Tree instruction that runs the node's Evaluate. So, the results
+    // are the same as the walker's, bit for bit.
+
+    enum BytecodeOp
+    {
+        BOp_Tree,           // Dest = Node->Evaluate( Mode )
+        BOp_Const,          // Dest = Imm
+        BOp_Var,            // Dest = Decl, by Mode
+        BOp_Field,          // Dest = A.Imm, by Mode
+        BOp_Deref,          // Dest = *A, by Mode
+        BOp_CheckAddr,      // fail if A has no address
+        BOp_Index,          // Dest = A[B], by Mode
+        BOp_AddressOf,      // Dest = &A
+        BOp_Add,            // Dest = A op B
+        BOp_Sub,
+        BOp_Mul,
+        BOp_Div,
+        BOp_Mod,
+        BOp_And,
+        BOp_Or,
+        BOp_Xor,
+        BOp_Shl,
+        BOp_Shr,
+        BOp_UShr,
+        BOp_PtrAdd,         // Dest = A + (B * Size), or B + (A * Size)
+        BOp_PtrSub,         // Dest = A - (B * Size)
+        BOp_PtrDiff,        // Dest = (A - B) / Size
+        BOp_Negate,         // Dest = -Dest
+        BOp_BitNot,         // Dest = ~Dest
+        BOp_Compare,        // Dest = A Code B, as integers
+        BOp_CompareAddr,    // Dest = A Code B, as addresses
+        BOp_ToBool,         // Dest = A ? 1 : 0, or A ? 0 : 1
+        BOp_CastBool,       // the same, without touching Dest's address
+        BOp_CastInt,        // Dest = (integral) A
+        BOp_CastPtr,        // Dest = (pointer) A
+        BOp_Jump,           // go to Imm
+        BOp_JumpIfFalse,    // go to Imm if !A
+        BOp_JumpIfTrue,     // go to Imm if A
+    };
+
+    // how an integer is sign or zero extended, see Expression::PromoteInPlace
+    enum PromoteKind
+    {
+        Promote_None,
+        Promote_Int8,
+        Promote_UInt8,
+        Promote_Int16,
+        Promote_UInt16,
+        Promote_Int32,
+        Promote_UInt32,
+        // promoting to uns32
+        Promote_Int8To32,
+        Promote_Int16To32,
+        Promote_Zero,
+    };
+
+    // which part of a value is tested, see Expression::ConvertToBool
+    enum BoolKind
+    {
+        Bool_None,
+        Bool_Value,         // pointers, integers, associative arrays
+        Bool_Complex,
+        Bool_Float,
+        Bool_ArrayAddr,
+        Bool_ObjectAddr,    // static arrays
+        Bool_Delegate,
+    };
+
+    // where an address is taken from in an object
+    enum AddrKind
+    {
+        AddrKind_Value,     // pointers, integers, associative arrays
+        AddrKind_Object,    // static arrays and structs
+        AddrKind_Array,     // dynamic arrays
+        AddrKind_Delegate,
+    };
+
+    struct Instruction
+    {
+        uint8_t         Op;
+        uint8_t         Dest;
+        uint8_t         A;
+        uint8_t         B;
+        uint8_t         Mode;       // EvalMode
+        uint8_t         Kind;       // BoolKind, AddrKind, signedness, ...
+        uint8_t         PromoteA;
+        uint8_t         PromoteB;
+        uint8_t         PromoteDest;
+        TOK             Code;
+        uint32_t        Size;
+        uint64_t        Imm;
+        // these are owned by the tree that was compiled
+        Type*           _Type;      // the result type, if the instruction sets it
+        Declaration*    Decl;
+        Expression*     Node;
+    };
+
+
+    class Bytecode
+    {
+        friend class BytecodeCompiler;
+
+        std::vector<Instruction>    mCode;
+        uint32_t                    mRegCount;
+
+    public:
+        static const uint32_t   MaxRegisters = 32;
+
+        Bytecode();
+        ~Bytecode();
+
+        // Evaluates the compiled expression as a value into obj, like
+        // Expression::Evaluate.
+        HRESULT Run( const EvalData& evalData, IValueBinder* binder, DataObject& obj );
+
+    private:
+        static HRESULT Load( IValueBinder* binder, const Instruction& inst, DataObject& obj );
+        static uint64_t Promote( uint64_t value, uint8_t kind );
+        static bool ToBool( const DataObject& obj, uint8_t kind );
+        static HRESULT IntegerOp( uint8_t op, bool isSigned, uint64_t left, uint64_t right, uint64_t& result );
+    };
+
+
+    class BytecodeCompiler
+    {
+        std::vector<Instruction>    mCode;
+        uint32_t                    mRegCount;
+        ITypeEnv*                   mTypeEnv;
+
+    public:
+        BytecodeCompiler( ITypeEnv* typeEnv );
+
+        ITypeEnv* GetTypeEnv();
+
+        // Compiles the tree under root. Fails if it can't do any better than
+        // the tree walker.
+        HRESULT Compile( Expression* root, Bytecode*& code );
+
+        HRESULT NewRegister( uint8_t& reg );
+        Instruction& Emit( BytecodeOp op, uint8_t dest, Type* type );
+        HRESULT EmitTree( Expression* node, EvalMode mode, uint8_t dest );
+
+        uint32_t GetPosition();
+        // points the jump at jumpPos to the current position
+        void SetTarget( uint32_t jumpPos );
+        // whether a Tree instruction was emitted after position
+        bool HasTree( uint32_t position );
+        // drops the code emitted after position
+        void Rewind( uint32_t position );
+
+        static uint8_t GetPromoteKind( Type* type );
+        static uint8_t GetPromoteKind( Type* type, Type* targetType );
+        static uint8_t GetBoolKind( Type* type );
+    };
+}
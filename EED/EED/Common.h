@@ -30,12 +30,14 @@
 #include <vector>
 #include <list>
 #include <map>
+#include <set>
 
 // Windows
 #include <windows.h>
 
 // Magus
 #include <SmartPtr.h>
+#include <Guard.h>
 
 // This project
 #include "..\Real\Real.h"
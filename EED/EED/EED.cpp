@@ -12,6 +12,7 @@
 #include "Scanner.h"
 #include "Parser.h"
 #include "Expression.h"
+#include "Bytecode.h"
 #include "PropTables.h"
 #include "EnumValues.h"
 
@@ -21,18 +22,22 @@ namespace MagoEE
     class EEDParsedExpr : public IEEDParsedExpr
     {
         long                mRefCount;
+        RefPtr<ObjectArena> mArena;         // expr's nodes live in here
         RefPtr<Expression>  mExpr;
         RefPtr<NameTable>   mStrTable;      // expr holds refs to strings in here
         RefPtr<ITypeEnv>    mTypeEnv;       // eval will need this
+        UniquePtr<Bytecode> mCode;          // expr compiled when it was bound, if it could be
 
     public:
-        EEDParsedExpr( Expression* e, NameTable* strTable, ITypeEnv* typeEnv )
+        EEDParsedExpr( Expression* e, ObjectArena* arena, NameTable* strTable, ITypeEnv* typeEnv )
             :   mRefCount( 0 ),
+                mArena( arena ),
                 mExpr( e ),
                 mStrTable( strTable ),
                 mTypeEnv( typeEnv )
         {
             _ASSERT( e != NULL );
+            _ASSERT( arena != NULL );
             _ASSERT( strTable != NULL );
             _ASSERT( typeEnv != NULL );
         }
@@ -60,10 +65,20 @@ namespace MagoEE
             evalData.Options = options;
             evalData.TypeEnv = mTypeEnv;
 
+            // the code refers to what the last bind found
+            mCode.Attach( NULL );
+
             hr = mExpr->Semantic( evalData, mTypeEnv, binder );
             if ( FAILED( hr ) )
                 return hr;
 
+            // if it doesn't compile, then it's evaluated by walking the tree
+            BytecodeCompiler    compiler( mTypeEnv );
+            Bytecode*           code = NULL;
+
+            if ( SUCCEEDED( compiler.Compile( mExpr, code ) ) )
+                mCode.Attach( code );
+
             return S_OK;
         }
 
@@ -75,7 +90,10 @@ namespace MagoEE
             evalData.Options = options;
             evalData.TypeEnv = mTypeEnv;
 
-            hr = mExpr->Evaluate( EvalMode_Value, evalData, binder, result.ObjVal );
+            if ( mCode.Get() != NULL )
+                hr = mCode->Run( evalData, binder, result.ObjVal );
+            else
+                hr = mExpr->Evaluate( EvalMode_Value, evalData, binder, result.ObjVal );
             if ( FAILED( hr ) )
                 return hr;
 
@@ -166,8 +184,12 @@ namespace MagoEE
         if ( (text == NULL) || (typeEnv == NULL) || (strTable == NULL) )
             return E_INVALIDARG;
 
+        RefPtr<ObjectArena> arena = new ObjectArena();
+        if ( arena == NULL )
+            return E_OUTOFMEMORY;
+
         Scanner scanner( text, wcslen( text ), strTable );
-        Parser  parser( &scanner, typeEnv );
+        Parser  parser( &scanner, typeEnv, arena );
         RefPtr<Expression>  e;
 
         try
@@ -185,7 +207,7 @@ namespace MagoEE
             return E_MAGOEE_SYNTAX_ERROR;
         }
 
-        expr = new EEDParsedExpr( e, strTable, typeEnv );
+        expr = new EEDParsedExpr( e, arena, strTable, typeEnv );
         if ( expr == NULL )
             return E_OUTOFMEMORY;
 
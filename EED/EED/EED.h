@@ -15,6 +15,8 @@
 #include "Type.h"
 #include "FormatValue.h"
 #include "Array.h"
+#include "ReadPlan.h"
+#include "AArrayLookup.h"
 
 
 namespace MagoEE
@@ -9,10 +9,26 @@
 #include "EnumValues.h"
 #include "UniAlpha.h"
 
+#include <algorithm>
+
 
 namespace MagoEE
 {
     const uint32_t  MaxArrayLength = 1024*1024*1024;
+    // how much of an array is read at once while enumerating its elements
+    const uint32_t  ArrayPrefetchSize = 4096;
+    // how much of an associative array's bucket array is read at once
+    const uint32_t  BucketReadSize = 16 * 1024;
+    // how many occupied buckets have their nodes read at once, to show them
+    const uint32_t  NodePrefetchCount = 64;
+    // and to skip them, which only takes their links
+    const uint32_t  LinkPrefetchCount = 4096;
+    // the rest of a bigger node is read when it's needed
+    const uint32_t  MaxNodePrefetchSize = 1024;
+    // how far down its chain a bucket's nodes are read ahead
+    const uint32_t  MaxChainPrefetch = 4;
+    // how many elements apart the places that Skip can start from are
+    const uint32_t  CheckpointInterval = 256;
 
 
     EEDEnumValues::EEDEnumValues()
@@ -183,6 +199,7 @@ namespace MagoEE
     void EEDEnumSArray::Reset()
     {
         mCountDone = 0;
+        mPrefetch.Attach( NULL );
     }
 
     HRESULT EEDEnumSArray::Skip( uint32_t count )
@@ -248,15 +265,17 @@ namespace MagoEE
             fullName.append( L")" );
         fullName.append( name );
 
+        IValueBinder*   binder = GetBinder();
+
         hr = ParseText( fullName.c_str(), mTypeEnv, mStrTable, parsedExpr.Ref() );
         if ( FAILED( hr ) )
             return hr;
 
-        hr = parsedExpr->Bind( options, mBinder );
+        hr = parsedExpr->Bind( options, binder );
         if ( FAILED( hr ) )
             return hr;
 
-        hr = parsedExpr->Evaluate( options, mBinder, result );
+        hr = parsedExpr->Evaluate( options, binder, result );
         if ( FAILED( hr ) )
             return hr;
 
@@ -265,6 +284,57 @@ namespace MagoEE
         return S_OK;
     }
 
+    // Gets a binder that has the current element, and the ones after it up 
+    // to ArrayPrefetchSize, already read.
+    IValueBinder* EEDEnumSArray::GetBinder()
+    {
+        Address         arrayAddr = 0;
+        RefPtr<Type>    elemType = mParentVal._Type->AsTypeNext()->GetNext();
+        uint32_t        elemSize = elemType->GetSize();
+
+        if ( mParentVal._Type->IsSArray() )
+            arrayAddr = mParentVal.Addr;
+        else
+            arrayAddr = mParentVal.Value.Array.Addr;
+
+        // the rest have no values to read
+        if ( (arrayAddr == 0) || (elemSize == 0) || !HasRawValue( elemType ) )
+            return mBinder;
+
+        Address elemAddr = arrayAddr + (uint64_t) mCountDone * elemSize;
+
+        if ( mPrefetch.Get() == NULL )
+        {
+            mPrefetch.Attach( new PrefetchBinder( mBinder ) );
+            if ( mPrefetch.Get() == NULL )
+                return mBinder;
+        }
+        else if ( mPrefetch->Contains( elemAddr, elemSize ) )
+        {
+            return mPrefetch.Get();
+        }
+
+        std::vector<MemoryRead> reads;
+        uint32_t                count = std::max<uint32_t>( ArrayPrefetchSize / elemSize, 1 );
+
+        count = std::min( count, GetCount() - mCountDone );
+
+        // each element's expression gets the array's value again, too
+        if ( (mParentVal.Addr != 0) && HasRawValue( mParentVal._Type ) )
+        {
+            MemoryRead  read = { mParentVal.Addr, mParentVal._Type->GetSize(), NULL, 0 };
+            reads.push_back( read );
+        }
+
+        AddArrayReads( elemType, elemAddr, count, reads );
+
+        mPrefetch->Clear();
+        if ( !reads.empty() )
+            mPrefetch->Prefetch( &reads[0], (uint32_t) reads.size() );
+
+        return mPrefetch.Get();
+    }
+
 
     //------------------------------------------------------------------------
     //  EEDEnumSArray
@@ -273,6 +343,11 @@ namespace MagoEE
     EEDEnumAArray::EEDEnumAArray( int aaVersion )
         :   mCountDone( 0 )
         ,   mAAVersion ( aaVersion )
+        ,   mBucketsStart( 0 )
+        ,   mBucketsCount( 0 )
+        ,   mPrefetchStart( 0 )
+        ,   mPrefetchEnd( 0 )
+        ,   mPrefetchSize( 0 )
     {
         mBB.nodes = UINT64_MAX;
         mBucketIndex = 0;
@@ -390,12 +465,13 @@ namespace MagoEE
         uint32_t ptrSize = mParentVal._Type->GetSize();
         uint64_t addr = baseAddr + (index * ptrSize);
         uint32_t sizeRead;
+        IValueBinder* binder = GetBinder();
 
         if ( ptrSize == 4 )
         {
             uint32_t    ptrValue32;
 
-            hr = mBinder->ReadMemory( addr, ptrSize, sizeRead, (uint8_t*)&ptrValue32 );
+            hr = binder->ReadMemory( addr, ptrSize, sizeRead, (uint8_t*)&ptrValue32 );
             if ( FAILED( hr ) )
                 return hr;
 
@@ -403,14 +479,207 @@ namespace MagoEE
         }
         else
         {
-            hr = mBinder->ReadMemory( addr, ptrSize, sizeRead, (uint8_t*)&ptrValue );
+            hr = binder->ReadMemory( addr, ptrSize, sizeRead, (uint8_t*)&ptrValue );
+            if ( FAILED( hr ) )
+                return hr;
+        }
+
+        return S_OK;
+    }
+
+    // Gets a bucket out of the window of the bucket array that was read last,
+    // reading the window that starts with it if it isn't there. A bucket of
+    // the old layout is only a node pointer, so its hash is 0.
+    HRESULT EEDEnumAArray::ReadBucket( uint64_t index, Address& hash, Address& node )
+    {
+        uint32_t ptrSize = mParentVal._Type->GetSize();
+        uint32_t bucketSize = (mAAVersion == 1) ? 2 * ptrSize : ptrSize;
+
+        _ASSERT( index < mBB.b.length );
+
+        if ( (index < mBucketsStart) || (index >= mBucketsStart + mBucketsCount) )
+        {
+            uint64_t    count = std::min<uint64_t>( BucketReadSize / bucketSize, mBB.b.length - index );
+            uint32_t    size = (uint32_t) count * bucketSize;
+            uint32_t    sizeRead = 0;
+
+            mBucketsCount = 0;
+            mBuckets.resize( size );
+
+            HRESULT hr = mBinder->ReadMemory( mBB.b.ptr + index * bucketSize, size, sizeRead, &mBuckets[0] );
             if ( FAILED( hr ) )
                 return hr;
+
+            // what was read before a part that couldn't be is still good
+            if ( sizeRead < bucketSize )
+                return E_FAIL;
+
+            mBucketsStart = index;
+            mBucketsCount = sizeRead / bucketSize;
+        }
+
+        const uint8_t*  bucket = &mBuckets[(size_t) (index - mBucketsStart) * bucketSize];
+
+        if ( mAAVersion == 1 )
+        {
+            hash = GetPointer( bucket );
+            node = GetPointer( bucket + ptrSize );
+        }
+        else
+        {
+            hash = 0;
+            node = GetPointer( bucket );
+        }
+
+        return S_OK;
+    }
+
+    // Reads the first nodeSize bytes of the nodes of the next count occupied
+    // buckets in the window from index on, and of the nodes chained to them,
+    // all together. Whatever isn't read here is read when it's needed.
+    HRESULT EEDEnumAArray::PrefetchNodes( uint64_t index, uint32_t count, uint32_t nodeSize )
+    {
+        HRESULT hr = S_OK;
+        Address hash = 0;
+        Address node = 0;
+
+        if ( (mPrefetch.Get() != NULL) && (index >= mPrefetchStart) && (index < mPrefetchEnd) 
+            && (nodeSize <= mPrefetchSize) )
+            return S_OK;
+
+        if ( mPrefetch.Get() == NULL )
+        {
+            mPrefetch.Attach( new PrefetchBinder( mBinder ) );
+            if ( mPrefetch.Get() == NULL )
+                return E_OUTOFMEMORY;
+        }
+
+        // load the window that index is in
+        hr = ReadBucket( index, hash, node );
+        if ( FAILED( hr ) )
+            return hr;
+
+        std::vector<MemoryRead> reads;
+        uint32_t                ptrSize = mParentVal._Type->GetSize();
+        uint64_t                end = index;
+
+        for ( ; (end < mBucketsStart + mBucketsCount) && (reads.size() < count); end++ )
+        {
+            hr = ReadBucket( end, hash, node );
+            if ( FAILED( hr ) )
+                return hr;
+
+            if ( IsUsedBucket( hash, node ) && (node != 0) )
+            {
+                MemoryRead  read = { node, nodeSize, NULL, 0 };
+                reads.push_back( read );
+            }
+        }
+
+        mPrefetch->Clear();
+        mPrefetchStart = index;
+        mPrefetchEnd = end;
+        mPrefetchSize = nodeSize;
+
+        for ( uint32_t i = 0; !reads.empty(); i++ )
+        {
+            hr = mPrefetch->Prefetch( &reads[0], (uint32_t) reads.size() );
+            if ( FAILED( hr ) )
+                return hr;
+
+            // only the old layout chains its nodes
+            if ( (mAAVersion == 1) || (i == MaxChainPrefetch) )
+                break;
+
+            std::vector<MemoryRead> links;
+
+            for ( size_t j = 0; j < reads.size(); j++ )
+            {
+                uint8_t     buffer[sizeof( Address )] = { 0 };
+                uint32_t    sizeRead = 0;
+
+                if ( !mPrefetch->Contains( reads[j].Addr, ptrSize ) )
+                    continue;
+
+                mPrefetch->ReadMemory( reads[j].Addr, ptrSize, sizeRead, buffer );
+
+                node = GetPointer( buffer );
+                if ( node != 0 )
+                {
+                    MemoryRead  read = { node, nodeSize, NULL, 0 };
+                    links.push_back( read );
+                }
+            }
+
+            reads.swap( links );
         }
 
         return S_OK;
     }
 
+    IValueBinder* EEDEnumAArray::GetBinder()
+    {
+        if ( mPrefetch.Get() != NULL )
+            return mPrefetch.Get();
+
+        return mBinder;
+    }
+
+    bool EEDEnumAArray::IsUsedBucket( Address hash, Address node )
+    {
+        if ( mAAVersion == 1 )
+        {
+            uint32_t ptrSize = mParentVal._Type->GetSize();
+            uint64_t hashFilledMark = 1ULL << (8 * ptrSize - 1);
+
+            return (hash & hashFilledMark) != 0;
+        }
+
+        return node != NULL;
+    }
+
+    // how much of a node is read ahead: its link, key, and value
+    uint32_t EEDEnumAArray::GetNodeSize()
+    {
+        ITypeAArray* aa = mParentVal._Type->AsTypeAArray();
+        uint32_t ptrSize = mParentVal._Type->GetSize();
+        uint64_t size = 0;
+
+        if ( mAAVersion == 1 )
+            size = (uint64_t) mBB_V1.valoff + aa->GetElement()->GetSize();
+        else
+            size = 2 * ptrSize + AlignTSize( aa->GetIndex()->GetSize() ) + aa->GetElement()->GetSize();
+
+        return (uint32_t) std::min<uint64_t>( size, MaxNodePrefetchSize );
+    }
+
+    Address EEDEnumAArray::GetPointer( const uint8_t* buffer )
+    {
+        if ( mParentVal._Type->GetSize() == 4 )
+        {
+            uint32_t    ptrValue32 = 0;
+            memcpy( &ptrValue32, buffer, sizeof ptrValue32 );
+            return ptrValue32;
+        }
+
+        uint64_t    ptrValue = 0;
+        memcpy( &ptrValue, buffer, sizeof ptrValue );
+        return ptrValue;
+    }
+
+    // Remembers where the enumeration is every CheckpointInterval elements,
+    // so that skipping back to there later doesn't walk the buckets again.
+    void EEDEnumAArray::AddCheckpoint()
+    {
+        if ( (mCountDone % CheckpointInterval) != 0 )
+            return;
+        if ( !mCheckpoints.empty() && (mCheckpoints.back().CountDone >= mCountDone) )
+            return;
+
+        Checkpoint  checkpoint = { mCountDone, mBucketIndex, mNextNode };
+        mCheckpoints.push_back( checkpoint );
+    }
+
     uint32_t EEDEnumAArray::AlignTSize( uint32_t size )
     {
         uint32_t ptrSize = mParentVal._Type->GetSize();
@@ -445,37 +714,18 @@ namespace MagoEE
 
     HRESULT EEDEnumAArray::FindCurrent()
     {
-        if ( mAAVersion == 1 )
+        while( mNextNode == NULL && mBucketIndex < mBB.b.length )
         {
-            uint32_t ptrSize = mParentVal._Type->GetSize();
-            uint64_t hashFilledMark = 1LL << (8 * ptrSize - 1);
-
-            while( mNextNode == NULL && mBucketIndex < mBB.b.length )
-            {
-                Address hash;
-                HRESULT hr = ReadAddress( mBB.b.ptr, 2 * mBucketIndex, hash );
-                if ( FAILED( hr ) )
-                    return hr;
-
-                if ( hash & hashFilledMark )
-                    return ReadAddress( mBB.b.ptr, 2 * mBucketIndex + 1, mNextNode );
-
-                mBucketIndex++;
-            }
-        }
-        else
-        {
-            while( mNextNode == NULL && mBucketIndex < mBB.b.length )
-            {
-                HRESULT hr = ReadAddress( mBB.b.ptr, mBucketIndex, mNextNode );
-                if ( FAILED( hr ) )
-                    return hr;
+            Address hash = 0;
+            HRESULT hr = ReadBucket( mBucketIndex, hash, mNextNode );
+            if ( FAILED( hr ) )
+                return hr;
 
-                if( mNextNode != NULL )
-                    return S_OK;
+            if ( IsUsedBucket( hash, mNextNode ) )
+                return S_OK;
 
-                mBucketIndex++;
-            }
+            mNextNode = NULL;
+            mBucketIndex++;
         }
         return S_OK;
     }
@@ -516,17 +766,43 @@ namespace MagoEE
             return S_FALSE;
         }
 
+        uint64_t    target = mCountDone + count;
+
+        // start from the last place passed before the target, if it's ahead
+        for ( size_t i = mCheckpoints.size(); i > 0; i-- )
+        {
+            const Checkpoint&   checkpoint = mCheckpoints[i - 1];
+
+            if ( checkpoint.CountDone <= target )
+            {
+                if ( checkpoint.CountDone > mCountDone )
+                {
+                    mCountDone = checkpoint.CountDone;
+                    mBucketIndex = checkpoint.BucketIndex;
+                    mNextNode = checkpoint.Node;
+                }
+                break;
+            }
+        }
+
         HRESULT hr = FindCurrent();
         if ( FAILED( hr ) )
             return hr;
 
-        for( uint32_t i = 0; i < count; i++ )
+        uint32_t    ptrSize = mParentVal._Type->GetSize();
+
+        while ( mCountDone < target )
         {
+            // walking the chains only takes the nodes' links
+            if ( mAAVersion != 1 )
+                PrefetchNodes( mBucketIndex, LinkPrefetchCount, ptrSize );
+
             hr = FindNext();
             if ( FAILED( hr ) )
                 return E_FAIL;
             
             mCountDone++;
+            AddCheckpoint();
         }
 
         return S_OK;
@@ -552,6 +828,7 @@ namespace MagoEE
         en->mCountDone = mCountDone;
         en->mBucketIndex = mBucketIndex;
         en->mNextNode = mNextNode;
+        en->mCheckpoints = mCheckpoints;
 
         copiedEnum = en.Detach();
         return S_OK;
@@ -573,6 +850,10 @@ namespace MagoEE
         if( !mNextNode )
             return E_FAIL;
 
+        PrefetchNodes( mBucketIndex, NodePrefetchCount, GetNodeSize() );
+
+        IValueBinder*   binder = GetBinder();
+
         _ASSERT( mParentVal._Type->IsAArray() );
         ITypeAArray* aa = mParentVal._Type->AsTypeAArray();
 
@@ -582,12 +863,12 @@ namespace MagoEE
         keyobj._Type = aa->GetIndex();
         keyobj.Addr = mNextNode + ( mAAVersion == 1 ? 0 : 2 * ptrSize );
 
-        hr = mBinder->GetValue( keyobj.Addr, keyobj._Type, keyobj.Value );
+        hr = binder->GetValue( keyobj.Addr, keyobj._Type, keyobj.Value );
         if ( FAILED( hr ) )
             return hr;
 
         std::wstring keystr;
-        hr = FormatValue( mBinder, keyobj, 10, keystr );
+        hr = FormatValue( binder, keyobj, 10, keystr );
         if ( FAILED( hr ) )
             return hr;
 
@@ -608,13 +889,18 @@ namespace MagoEE
 
         result.ObjVal.Addr = keyobj.Addr + alignKeySize;
         result.ObjVal._Type = aa->GetElement();
-        hr = mBinder->GetValue( result.ObjVal.Addr, result.ObjVal._Type, result.ObjVal.Value );
+        hr = binder->GetValue( result.ObjVal.Addr, result.ObjVal._Type, result.ObjVal.Value );
         if ( FAILED( hr ) )
             return hr;
 
         mCountDone++;
 
-        return FindNext();
+        hr = FindNext();
+        if ( FAILED( hr ) )
+            return hr;
+
+        AddCheckpoint();
+        return S_OK;
     }
 
 
@@ -624,7 +910,8 @@ namespace MagoEE
 
     EEDEnumStruct::EEDEnumStruct( bool skipHeadRef )
         :   mCountDone( 0 ),
-            mSkipHeadRef( skipHeadRef )
+            mSkipHeadRef( skipHeadRef ),
+            mStructAddr( 0 )
     {
     }
 
@@ -643,9 +930,12 @@ namespace MagoEE
         if ( parentValCopy._Type == NULL )
             return E_INVALIDARG;
 
+        mStructAddr = parentValCopy.Addr;
+
         if ( mSkipHeadRef && parentValCopy._Type->IsReference() )
         {
             parentValCopy._Type = parentValCopy._Type->AsTypeNext()->GetNext();
+            mStructAddr = parentValCopy.Value.Addr;
         }
 
         if ( parentValCopy._Type->AsTypeStruct() == NULL )
@@ -686,6 +976,7 @@ namespace MagoEE
     {
         mCountDone = 0;
         mMembers->Reset();
+        mPrefetch.Attach( NULL );
     }
 
     HRESULT EEDEnumStruct::Skip( uint32_t count )
@@ -757,21 +1048,54 @@ namespace MagoEE
                 return E_FAIL;
         }
 
+        IValueBinder*   binder = GetBinder();
+
         hr = ParseText( fullName.c_str(), mTypeEnv, mStrTable, parsedExpr.Ref() );
         if ( FAILED( hr ) )
             return hr;
 
-        hr = parsedExpr->Bind( options, mBinder );
+        hr = parsedExpr->Bind( options, binder );
         if ( FAILED( hr ) )
             return hr;
 
-        hr = parsedExpr->Evaluate( options, mBinder, result );
+        hr = parsedExpr->Evaluate( options, binder, result );
         if ( FAILED( hr ) )
             return hr;
 
         return S_OK;
     }
 
+    // Gets a binder that has all the members already read, so that showing
+    // a struct doesn't take a read of the target for each one.
+    IValueBinder* EEDEnumStruct::GetBinder()
+    {
+        if ( mPrefetch.Get() != NULL )
+            return mPrefetch.Get();
+
+        if ( mStructAddr == 0 )
+            return mBinder;
+
+        mPrefetch.Attach( new PrefetchBinder( mBinder ) );
+        if ( mPrefetch.Get() == NULL )
+            return mBinder;
+
+        std::vector<MemoryRead> reads;
+
+        // a member's expression gets the class reference again, too
+        if ( (mStructAddr != mParentVal.Addr) && (mParentVal.Addr != 0) )
+        {
+            MemoryRead  read = { mParentVal.Addr, mTypeEnv->GetVoidPointerType()->GetSize(), NULL, 0 };
+            reads.push_back( read );
+        }
+
+        AddStructReads( mParentVal._Type, mStructAddr, reads );
+
+        if ( !reads.empty() )
+            mPrefetch->Prefetch( &reads[0], (uint32_t) reads.size() );
+
+        return mPrefetch.Get();
+    }
+
     bool EEDEnumStruct::NameBaseClass( 
             Declaration* decl, 
             std::wstring& name,
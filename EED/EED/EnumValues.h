@@ -63,6 +63,11 @@ namespace MagoEE
     {
         uint32_t        mCountDone;
 
+        // the elements around the current one, read together
+        UniquePtr<PrefetchBinder>   mPrefetch;
+
+        IValueBinder* GetBinder();
+
     public:
         EEDEnumSArray();
 
@@ -84,6 +89,14 @@ namespace MagoEE
 
     class EEDEnumAArray : public EEDEnumValues
     {
+        // where the enumeration was after a number of elements
+        struct Checkpoint
+        {
+            uint64_t    CountDone;
+            uint64_t    BucketIndex;
+            Address     Node;
+        };
+
         int             mAAVersion;
         uint64_t        mCountDone;
         uint64_t        mBucketIndex;
@@ -94,8 +107,30 @@ namespace MagoEE
             BB64_V1         mBB_V1;
         };
 
+        // a window of the bucket array, which is scanned here instead of 
+        // being read a bucket at a time
+        std::vector<uint8_t>    mBuckets;
+        uint64_t        mBucketsStart;
+        uint64_t        mBucketsCount;
+
+        // the first mPrefetchSize bytes of the nodes of the occupied buckets
+        // from mPrefetchStart up to mPrefetchEnd, read together
+        UniquePtr<PrefetchBinder>   mPrefetch;
+        uint64_t        mPrefetchStart;
+        uint64_t        mPrefetchEnd;
+        uint32_t        mPrefetchSize;
+
+        std::vector<Checkpoint> mCheckpoints;
+
         HRESULT ReadBB();
         HRESULT ReadAddress( Address baseAddr, uint64_t index, Address& ptrValue );
+        HRESULT ReadBucket( uint64_t index, Address& hash, Address& node );
+        HRESULT PrefetchNodes( uint64_t index, uint32_t count, uint32_t nodeSize );
+        IValueBinder* GetBinder();
+        bool IsUsedBucket( Address hash, Address node );
+        uint32_t GetNodeSize();
+        Address GetPointer( const uint8_t* buffer );
+        void AddCheckpoint();
         HRESULT FindCurrent();
         HRESULT FindNext();
         uint32_t AlignTSize( uint32_t size );
@@ -121,9 +156,13 @@ namespace MagoEE
     {
         uint32_t        mCountDone;
         bool            mSkipHeadRef;
+        Address         mStructAddr;
 
         RefPtr<IEnumDeclarationMembers> mMembers;
 
+        // all the members, read together when the first one is evaluated
+        UniquePtr<PrefetchBinder>   mPrefetch;
+
     public:
         EEDEnumStruct( bool skipHeadRef = false );
 
@@ -147,6 +186,8 @@ namespace MagoEE
             std::wstring& fullName );
 
     private:
+        IValueBinder* GetBinder();
+
         bool NameBaseClass( 
             Declaration* decl, 
             std::wstring& name,
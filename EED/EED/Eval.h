@@ -72,6 +72,17 @@ namespace MagoEE
     };
 
 
+    // One piece of a scatter/gather read: Size bytes at Addr go to Buffer.
+    // SizeRead is how many of them could be read.
+    struct MemoryRead
+    {
+        Address     Addr;
+        uint32_t    Size;
+        uint8_t*    Buffer;
+        uint32_t    SizeRead;
+    };
+
+
     struct EvalOptions
     {
         bool    AllowAssignment;
@@ -96,6 +107,8 @@ namespace MagoEE
         virtual HRESULT GetSuper( Declaration*& decl ) = 0;
         virtual HRESULT GetReturnType( Type*& type ) = 0;
 
+        virtual HRESULT GetAddress( Declaration* decl, Address& addr ) = 0;
+
         virtual HRESULT GetValue( Declaration* decl, DataValue& value ) = 0;
         virtual HRESULT GetValue( Address addr, Type* type, DataValue& value ) = 0;
         virtual HRESULT GetValue( Address aArrayAddr, const DataObject& key, Address& valueAddr ) = 0;
@@ -105,5 +118,12 @@ namespace MagoEE
         virtual HRESULT SetValue( Address addr, Type* type, const DataValue& value ) = 0;
 
         virtual HRESULT ReadMemory( Address addr, uint32_t sizeToRead, uint32_t& sizeRead, uint8_t* buffer ) = 0;
+
+        // Reads all the pieces, with as few reads of the target as it can.
+        // A piece that can't be read doesn't fail the others, so check each 
+        // one's SizeRead.
+        virtual HRESULT ReadMemory( MemoryRead* reads, uint32_t count ) = 0;
+        // Gets a value out of bytes that were read from the target.
+        virtual HRESULT FromRawValue( const uint8_t* buffer, Type* type, DataValue& value ) = 0;
     };
 }
@@ -0,0 +1,780 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+// Compile: turning bound expressions into bytecode
+
+#include "Common.h"
+#include "Expression.h"
+#include "Bytecode.h"
+#include "Declaration.h"
+#include "Type.h"
+#include "TypeCommon.h"
+#include "ITypeEnv.h"
+
+
+namespace MagoEE
+{
+    // Each Compile leaves the node's result in the dest register, the same way
+    // that Evaluate leaves it in obj. A node that can't do that by itself in
+    // bytecode has the walker evaluate it.
+
+    HRESULT Expression::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        return compiler.EmitTree( this, mode, dest );
+    }
+
+    static HRESULT CompileOperands(
+        BytecodeCompiler& compiler,
+        Expression* left,
+        Expression* right,
+        uint8_t& leftReg,
+        uint8_t& rightReg )
+    {
+        HRESULT hr = S_OK;
+
+        hr = compiler.NewRegister( leftReg );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = compiler.NewRegister( rightReg );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = left->Compile( compiler, EvalMode_Value, leftReg );
+        if ( FAILED( hr ) )
+            return hr;
+
+        return right->Compile( compiler, EvalMode_Value, rightReg );
+    }
+
+    // the integral part of ArithmeticBinExpr::Evaluate
+    static HRESULT CompileIntegerOp( BytecodeCompiler& compiler, BinExpr* expr, EvalMode mode, BytecodeOp op, uint8_t dest )
+    {
+        HRESULT hr = S_OK;
+        Type*   type = expr->_Type;
+        uint8_t left = 0;
+        uint8_t right = 0;
+
+        if ( (mode == EvalMode_Address) || type->IsComplex() || type->IsFloatingPoint()
+            || !type->IsIntegral() )
+            return compiler.EmitTree( expr, mode, dest );
+
+        hr = CompileOperands( compiler, expr->Left, expr->Right, left, right );
+        if ( FAILED( hr ) )
+            return hr;
+
+        Instruction&    inst = compiler.Emit( op, dest, type );
+
+        inst.A = left;
+        inst.B = right;
+        inst.Kind = type->IsSigned() ? 1 : 0;
+        inst.PromoteA = BytecodeCompiler::GetPromoteKind( expr->Left->_Type, type );
+        inst.PromoteB = BytecodeCompiler::GetPromoteKind( expr->Right->_Type, type );
+        inst.PromoteDest = BytecodeCompiler::GetPromoteKind( type );
+        return S_OK;
+    }
+
+    static HRESULT CompileShift( BytecodeCompiler& compiler, BinExpr* expr, EvalMode mode, BytecodeOp op, uint8_t dest )
+    {
+        HRESULT hr = S_OK;
+        Type*   type = expr->_Type;
+        uint8_t left = 0;
+        uint8_t right = 0;
+
+        if ( mode == EvalMode_Address )
+            return compiler.EmitTree( expr, mode, dest );
+
+        hr = CompileOperands( compiler, expr->Left, expr->Right, left, right );
+        if ( FAILED( hr ) )
+            return hr;
+
+        Instruction&    inst = compiler.Emit( op, dest, type );
+
+        inst.A = left;
+        inst.B = right;
+        // can't shift all the bits out
+        inst.Size = (type->GetSize() == 8) ? 0x3F : 0x1F;
+        inst.PromoteDest = BytecodeCompiler::GetPromoteKind( type );
+
+        if ( op == BOp_Shr )
+        {
+            inst.Kind = type->IsSigned() ? 1 : 0;
+        }
+        else if ( op == BOp_UShr )
+        {
+            switch ( type->GetBackingTy() )
+            {
+            case Tint8:     case Tuns8:     inst.Kind = 1;  break;
+            case Tint16:    case Tuns16:    inst.Kind = 2;  break;
+            case Tint32:    case Tuns32:    inst.Kind = 4;  break;
+            case Tint64:    case Tuns64:    inst.Kind = 8;  break;
+            default:                        inst.Kind = 0;  break;
+            }
+        }
+
+        return S_OK;
+    }
+
+    static bool GetAddrKind( Type* type, uint8_t& kind )
+    {
+        if ( type->IsPointer() )
+            kind = AddrKind_Value;
+        else if ( type->IsSArray() )
+            kind = AddrKind_Object;
+        else if ( type->IsDArray() )
+            kind = AddrKind_Array;
+        else
+            return false;
+
+        return true;
+    }
+
+
+    //----------------------------------------------------------------------------
+    //  ConditionalExpr
+    //----------------------------------------------------------------------------
+
+    HRESULT ConditionalExpr::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        HRESULT     hr = S_OK;
+        uint8_t     pred = 0;
+        uint8_t     boolKind = BytecodeCompiler::GetBoolKind( PredicateExpr->_Type );
+        uint32_t    jumpFalse = 0;
+        uint32_t    jumpEnd = 0;
+
+        if ( boolKind == Bool_None )
+            return compiler.EmitTree( this, mode, dest );
+
+        hr = compiler.NewRegister( pred );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = PredicateExpr->Compile( compiler, EvalMode_Value, pred );
+        if ( FAILED( hr ) )
+            return hr;
+
+        jumpFalse = compiler.GetPosition();
+        Instruction&    inst = compiler.Emit( BOp_JumpIfFalse, 0, NULL );
+        inst.A = pred;
+        inst.Kind = boolKind;
+
+        hr = TrueExpr->Compile( compiler, mode, dest );
+        if ( FAILED( hr ) )
+            return hr;
+
+        jumpEnd = compiler.GetPosition();
+        compiler.Emit( BOp_Jump, 0, NULL );
+
+        compiler.SetTarget( jumpFalse );
+
+        hr = FalseExpr->Compile( compiler, mode, dest );
+        if ( FAILED( hr ) )
+            return hr;
+
+        compiler.SetTarget( jumpEnd );
+        return S_OK;
+    }
+
+
+    //----------------------------------------------------------------------------
+    //  OrOrExpr, AndAndExpr, NotExpr
+    //----------------------------------------------------------------------------
+
+    static HRESULT CompileLogical( BytecodeCompiler& compiler, BinExpr* expr, EvalMode mode, BytecodeOp jumpOp, uint8_t dest )
+    {
+        HRESULT     hr = S_OK;
+        uint8_t     leftKind = BytecodeCompiler::GetBoolKind( expr->Left->_Type );
+        uint8_t     rightKind = BytecodeCompiler::GetBoolKind( expr->Right->_Type );
+        uint8_t     left = 0;
+        uint8_t     right = 0;
+        uint32_t    jumpShort = 0;
+        uint32_t    jumpEnd = 0;
+
+        if ( (mode == EvalMode_Address) || (leftKind == Bool_None) || (rightKind == Bool_None) )
+            return compiler.EmitTree( expr, mode, dest );
+
+        hr = compiler.NewRegister( left );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = compiler.NewRegister( right );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = expr->Left->Compile( compiler, EvalMode_Value, left );
+        if ( FAILED( hr ) )
+            return hr;
+
+        jumpShort = compiler.GetPosition();
+        Instruction&    jumpInst = compiler.Emit( jumpOp, 0, NULL );
+        jumpInst.A = left;
+        jumpInst.Kind = leftKind;
+
+        hr = expr->Right->Compile( compiler, EvalMode_Value, right );
+        if ( FAILED( hr ) )
+            return hr;
+
+        Instruction&    boolInst = compiler.Emit( BOp_ToBool, dest, expr->_Type );
+        boolInst.A = right;
+        boolInst.Kind = rightKind;
+
+        jumpEnd = compiler.GetPosition();
+        compiler.Emit( BOp_Jump, 0, NULL );
+
+        // || is true and && is false without looking at the right side
+        compiler.SetTarget( jumpShort );
+        Instruction&    constInst = compiler.Emit( BOp_Const, dest, expr->_Type );
+        constInst.Imm = (jumpOp == BOp_JumpIfTrue) ? 1 : 0;
+
+        compiler.SetTarget( jumpEnd );
+        return S_OK;
+    }
+
+    HRESULT OrOrExpr::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        return CompileLogical( compiler, this, mode, BOp_JumpIfTrue, dest );
+    }
+
+    HRESULT AndAndExpr::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        return CompileLogical( compiler, this, mode, BOp_JumpIfFalse, dest );
+    }
+
+    HRESULT NotExpr::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        HRESULT hr = S_OK;
+        uint8_t child = 0;
+        uint8_t boolKind = BytecodeCompiler::GetBoolKind( Child->_Type );
+
+        if ( (mode == EvalMode_Address) || (boolKind == Bool_None) )
+            return compiler.EmitTree( this, mode, dest );
+
+        hr = compiler.NewRegister( child );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = Child->Compile( compiler, EvalMode_Value, child );
+        if ( FAILED( hr ) )
+            return hr;
+
+        Instruction&    inst = compiler.Emit( BOp_ToBool, dest, _Type );
+        inst.A = child;
+        inst.Kind = boolKind;
+        inst.Imm = 1;
+        return S_OK;
+    }
+
+
+    //----------------------------------------------------------------------------
+    //  Arithmetic
+    //----------------------------------------------------------------------------
+
+    HRESULT AddExpr::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        Type*   ltype = Left->_Type.Get();
+        Type*   rtype = Right->_Type.Get();
+
+        if ( (ltype->IsImaginary() && (rtype->IsReal() || rtype->IsIntegral()))
+            || ((ltype->IsReal() || ltype->IsIntegral()) && rtype->IsImaginary()) )
+        {
+            return compiler.EmitTree( this, mode, dest );
+        }
+        else if ( _Type->IsPointer() )
+        {
+            HRESULT hr = S_OK;
+            uint8_t left = 0;
+            uint8_t right = 0;
+
+            if ( mode == EvalMode_Address )
+                return compiler.EmitTree( this, mode, dest );
+
+            hr = CompileOperands( compiler, Left, Right, left, right );
+            if ( FAILED( hr ) )
+                return hr;
+
+            Instruction&    inst = compiler.Emit( BOp_PtrAdd, dest, _Type );
+            inst.A = left;
+            inst.B = right;
+            inst.Kind = ltype->IsPointer() ? 0 : 1;
+            inst.Size = _Type->AsTypeNext()->GetNext()->GetSize();
+            return S_OK;
+        }
+
+        return CompileIntegerOp( compiler, this, mode, BOp_Add, dest );
+    }
+
+    HRESULT MinExpr::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        Type*   ltype = Left->_Type.Get();
+        Type*   rtype = Right->_Type.Get();
+
+        if ( (ltype->IsImaginary() && (rtype->IsReal() || rtype->IsIntegral()))
+            || ((ltype->IsReal() || ltype->IsIntegral()) && rtype->IsImaginary()) )
+        {
+            return compiler.EmitTree( this, mode, dest );
+        }
+        else if ( ltype->IsImaginary() && rtype->IsComplex() )
+        {
+            return compiler.EmitTree( this, mode, dest );
+        }
+        else if ( _Type->IsPointer() || (ltype->IsPointer() && rtype->IsPointer()) )
+        {
+            HRESULT     hr = S_OK;
+            uint8_t     left = 0;
+            uint8_t     right = 0;
+            BytecodeOp  op = BOp_PtrSub;
+            uint32_t    size = 0;
+
+            if ( ltype->IsPointer() && rtype->IsPointer() )
+            {
+                op = BOp_PtrDiff;
+                size = ltype->AsTypeNext()->GetNext()->GetSize();
+            }
+            else
+                size = _Type->AsTypeNext()->GetNext()->GetSize();
+
+            // leave the walker's behavior for void* - void*
+            if ( (mode == EvalMode_Address) || ((op == BOp_PtrDiff) && (size == 0)) )
+                return compiler.EmitTree( this, mode, dest );
+
+            hr = CompileOperands( compiler, Left, Right, left, right );
+            if ( FAILED( hr ) )
+                return hr;
+
+            Instruction&    inst = compiler.Emit( op, dest, _Type );
+            inst.A = left;
+            inst.B = right;
+            inst.Size = size;
+            return S_OK;
+        }
+
+        return CompileIntegerOp( compiler, this, mode, BOp_Sub, dest );
+    }
+
+    HRESULT MulExpr::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        return CompileIntegerOp( compiler, this, mode, BOp_Mul, dest );
+    }
+
+    HRESULT DivExpr::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        return CompileIntegerOp( compiler, this, mode, BOp_Div, dest );
+    }
+
+    HRESULT ModExpr::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        return CompileIntegerOp( compiler, this, mode, BOp_Mod, dest );
+    }
+
+    HRESULT AndExpr::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        return CompileIntegerOp( compiler, this, mode, BOp_And, dest );
+    }
+
+    HRESULT OrExpr::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        return CompileIntegerOp( compiler, this, mode, BOp_Or, dest );
+    }
+
+    HRESULT XorExpr::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        return CompileIntegerOp( compiler, this, mode, BOp_Xor, dest );
+    }
+
+    HRESULT ShiftLeftExpr::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        return CompileShift( compiler, this, mode, BOp_Shl, dest );
+    }
+
+    HRESULT ShiftRightExpr::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        return CompileShift( compiler, this, mode, BOp_Shr, dest );
+    }
+
+    HRESULT UShiftRightExpr::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        return CompileShift( compiler, this, mode, BOp_UShr, dest );
+    }
+
+    HRESULT NegateExpr::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        HRESULT hr = S_OK;
+
+        if ( (mode == EvalMode_Address) || _Type->IsComplex() || _Type->IsFloatingPoint()
+            || !_Type->IsIntegral() )
+            return compiler.EmitTree( this, mode, dest );
+
+        // the child's value is negated in place
+        hr = Child->Compile( compiler, EvalMode_Value, dest );
+        if ( FAILED( hr ) )
+            return hr;
+
+        Instruction&    inst = compiler.Emit( BOp_Negate, dest, _Type );
+        inst.PromoteDest = BytecodeCompiler::GetPromoteKind( Child->_Type );
+        return S_OK;
+    }
+
+    HRESULT UnaryAddExpr::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        return Child->Compile( compiler, mode, dest );
+    }
+
+    HRESULT BitNotExpr::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        HRESULT hr = S_OK;
+
+        if ( mode == EvalMode_Address )
+            return compiler.EmitTree( this, mode, dest );
+
+        hr = Child->Compile( compiler, EvalMode_Value, dest );
+        if ( FAILED( hr ) )
+            return hr;
+
+        Instruction&    inst = compiler.Emit( BOp_BitNot, dest, _Type );
+        inst.PromoteDest = BytecodeCompiler::GetPromoteKind( _Type );
+        return S_OK;
+    }
+
+
+    //----------------------------------------------------------------------------
+    //  CompareExpr
+    //----------------------------------------------------------------------------
+
+    HRESULT CompareExpr::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        HRESULT         hr = S_OK;
+        uint8_t         left = 0;
+        uint8_t         right = 0;
+        RefPtr<Type>    commonType;
+        BytecodeOp      op = BOp_CompareAddr;
+
+        if ( mode == EvalMode_Address )
+            return compiler.EmitTree( this, mode, dest );
+
+        if ( Left->_Type->IsPointer() || Left->_Type->IsAArray() )
+        {
+            op = BOp_CompareAddr;
+        }
+        else if ( Left->_Type->IsSArray() || Left->_Type->IsDArray() || Left->_Type->IsDelegate() )
+        {
+            return compiler.EmitTree( this, mode, dest );
+        }
+        else
+        {
+            // the walker works this out on every evaluation
+            commonType = GetCommonType( compiler.GetTypeEnv(), Left->_Type.Get(), Right->_Type.Get() );
+
+            if ( (commonType == NULL) || commonType->IsComplex() || commonType->IsFloatingPoint() )
+                return compiler.EmitTree( this, mode, dest );
+
+            op = BOp_Compare;
+        }
+
+        hr = CompileOperands( compiler, Left, Right, left, right );
+        if ( FAILED( hr ) )
+            return hr;
+
+        Instruction&    inst = compiler.Emit( op, dest, _Type );
+        inst.A = left;
+        inst.B = right;
+        inst.Code = OpCode;
+
+        if ( op == BOp_Compare )
+        {
+            inst.Kind = commonType->IsSigned() ? 1 : 0;
+            inst.PromoteA = BytecodeCompiler::GetPromoteKind( Left->_Type, commonType );
+            inst.PromoteB = BytecodeCompiler::GetPromoteKind( Right->_Type, commonType );
+        }
+
+        return S_OK;
+    }
+
+
+    //----------------------------------------------------------------------------
+    //  CastExpr
+    //----------------------------------------------------------------------------
+
+    HRESULT CastExpr::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        HRESULT     hr = S_OK;
+        Type*       srcType = Child->_Type;
+        Type*       destType = _Type;
+        BytecodeOp  op = BOp_CastInt;
+        uint8_t     kind = 0;
+        uint64_t    offset = 0;
+        uint8_t     child = 0;
+
+        if ( mode == EvalMode_Address )
+            return compiler.EmitTree( this, mode, dest );
+
+        // in the order of CastExpr::AssignValue, and only from the sources
+        // that don't need floating point
+        if ( destType->IsBool() )
+        {
+            op = BOp_CastBool;
+            kind = BytecodeCompiler::GetBoolKind( srcType );
+
+            if ( kind == Bool_None )
+                return compiler.EmitTree( this, mode, dest );
+        }
+        else if ( destType->IsComplex() || destType->IsImaginary() || destType->IsReal() )
+        {
+            return compiler.EmitTree( this, mode, dest );
+        }
+        else if ( destType->IsIntegral() )
+        {
+            op = BOp_CastInt;
+
+            if ( srcType->IsComplex() || srcType->IsImaginary() || srcType->IsReal()
+                || (!srcType->IsIntegral() && !srcType->IsPointer()) )
+                return compiler.EmitTree( this, mode, dest );
+        }
+        else if ( destType->IsPointer() )
+        {
+            op = BOp_CastPtr;
+
+            if ( srcType->IsComplex() || srcType->IsImaginary() || srcType->IsReal() )
+            {
+                return compiler.EmitTree( this, mode, dest );
+            }
+            else if ( srcType->IsIntegral() )
+            {
+                kind = AddrKind_Value;
+            }
+            else if ( srcType->IsPointer() )
+            {
+                RefPtr<Type>    nextSrc = srcType->AsTypeNext()->GetNext();
+                RefPtr<Type>    nextDest = destType->AsTypeNext()->GetNext();
+
+                kind = AddrKind_Value;
+
+                if ( (nextSrc != NULL) && (nextSrc->AsTypeStruct() != NULL)
+                    && (nextDest != NULL) && (nextDest->AsTypeStruct() != NULL) )
+                {
+                    int baseOffset = 0;
+
+                    if ( nextSrc->AsTypeStruct()->GetBaseClassOffset( nextDest, baseOffset ) )
+                        offset = (uint64_t) (int64_t) baseOffset;
+                }
+            }
+            else if ( srcType->IsDArray() )
+                kind = AddrKind_Array;
+            else if ( srcType->IsSArray() )
+                kind = AddrKind_Object;
+            else if ( srcType->IsAArray() )
+                kind = AddrKind_Value;
+            else if ( srcType->IsDelegate() )
+                kind = AddrKind_Delegate;
+            else
+                return compiler.EmitTree( this, mode, dest );
+        }
+        else
+        {
+            return compiler.EmitTree( this, mode, dest );
+        }
+
+        hr = compiler.NewRegister( child );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = Child->Compile( compiler, EvalMode_Value, child );
+        if ( FAILED( hr ) )
+            return hr;
+
+        Instruction&    inst = compiler.Emit( op, dest, _Type );
+        inst.A = child;
+        inst.Kind = kind;
+        inst.Imm = offset;
+        inst.Size = destType->GetSize();
+        inst.PromoteDest = BytecodeCompiler::GetPromoteKind( destType );
+        return S_OK;
+    }
+
+
+    //----------------------------------------------------------------------------
+    //  AddressOfExpr, PointerExpr, IndexExpr
+    //----------------------------------------------------------------------------
+
+    HRESULT AddressOfExpr::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        HRESULT hr = S_OK;
+        uint8_t pointed = 0;
+
+        if ( mode == EvalMode_Address )
+            return compiler.EmitTree( this, mode, dest );
+
+        hr = compiler.NewRegister( pointed );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = Child->Compile( compiler, EvalMode_Address, pointed );
+        if ( FAILED( hr ) )
+            return hr;
+
+        Instruction&    inst = compiler.Emit( BOp_AddressOf, dest, _Type );
+        inst.A = pointed;
+        return S_OK;
+    }
+
+    HRESULT PointerExpr::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        HRESULT hr = S_OK;
+        uint8_t pointer = 0;
+        uint8_t addrKind = 0;
+
+        if ( !GetAddrKind( Child->_Type, addrKind ) )
+            return compiler.EmitTree( this, mode, dest );
+
+        hr = compiler.NewRegister( pointer );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = Child->Compile( compiler, EvalMode_Value, pointer );
+        if ( FAILED( hr ) )
+            return hr;
+
+        Instruction&    inst = compiler.Emit( BOp_Deref, dest, _Type );
+        inst.A = pointer;
+        inst.Kind = addrKind;
+        inst.Mode = (uint8_t) mode;
+        return S_OK;
+    }
+
+    HRESULT IndexExpr::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        HRESULT     hr = S_OK;
+        uint8_t     array = 0;
+        uint8_t     index = 0;
+        uint8_t     addrKind = 0;
+        uint32_t    start = compiler.GetPosition();
+        uint32_t    indexStart = 0;
+
+        // associative arrays are looked up by the walker
+        if ( !GetAddrKind( Child->_Type, addrKind ) )
+            return compiler.EmitTree( this, mode, dest );
+
+        hr = compiler.NewRegister( array );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = compiler.NewRegister( index );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = Child->Compile( compiler, EvalMode_Value, array );
+        if ( FAILED( hr ) )
+            return hr;
+
+        if ( addrKind == AddrKind_Object )
+        {
+            Instruction&    checkInst = compiler.Emit( BOp_CheckAddr, 0, NULL );
+            checkInst.A = array;
+        }
+
+        indexStart = compiler.GetPosition();
+
+        hr = Args->List.front()->Compile( compiler, EvalMode_Value, index );
+        if ( FAILED( hr ) )
+            return hr;
+
+        // The walker evaluates the index with the array's length for $. That
+        // isn't passed down to the nodes that the walker evaluates here.
+        if ( compiler.HasTree( indexStart ) )
+        {
+            compiler.Rewind( start );
+            return compiler.EmitTree( this, mode, dest );
+        }
+
+        Instruction&    inst = compiler.Emit( BOp_Index, dest, _Type );
+        inst.A = array;
+        inst.B = index;
+        inst.Kind = addrKind;
+        inst.Mode = (uint8_t) mode;
+        inst.Size = _Type->GetSize();
+        return S_OK;
+    }
+
+
+    //----------------------------------------------------------------------------
+    //  IdExpr, DotExpr
+    //----------------------------------------------------------------------------
+
+    HRESULT IdExpr::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        // fields of "this" are left to the walker
+        if ( (Kind != DataKind_Value) || Decl->IsField() )
+            return compiler.EmitTree( this, mode, dest );
+
+        Instruction&    inst = compiler.Emit( BOp_Var, dest, _Type );
+        inst.Decl = Decl;
+        inst.Mode = (uint8_t) mode;
+        return S_OK;
+    }
+
+    HRESULT DotExpr::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        HRESULT hr = S_OK;
+        int     offset = 0;
+        uint8_t parent = 0;
+
+        if ( (Kind != DataKind_Value) || (Property != NULL) )
+            return compiler.EmitTree( this, mode, dest );
+
+        if ( !Decl->IsField() )
+        {
+            Instruction&    varInst = compiler.Emit( BOp_Var, dest, _Type );
+            varInst.Decl = Decl;
+            varInst.Mode = (uint8_t) mode;
+            return S_OK;
+        }
+
+        if ( !Decl->GetOffset( offset ) )
+            return compiler.EmitTree( this, mode, dest );
+
+        hr = compiler.NewRegister( parent );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = Child->Compile( compiler, EvalMode_Value, parent );
+        if ( FAILED( hr ) )
+            return hr;
+
+        Instruction&    inst = compiler.Emit( BOp_Field, dest, _Type );
+        inst.A = parent;
+        inst.Decl = Decl;
+        inst.Mode = (uint8_t) mode;
+        inst.Imm = (uint64_t) (int64_t) offset;
+        // as opposed to a pointer or reference to the class
+        inst.Kind = (Child->_Type->AsTypeStruct() != NULL) ? AddrKind_Object : AddrKind_Value;
+        return S_OK;
+    }
+
+
+    //----------------------------------------------------------------------------
+    //  IntExpr, NullExpr
+    //----------------------------------------------------------------------------
+
+    HRESULT IntExpr::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        if ( mode == EvalMode_Address )
+            return compiler.EmitTree( this, mode, dest );
+
+        Instruction&    inst = compiler.Emit( BOp_Const, dest, _Type );
+        inst.Imm = Value;
+        return S_OK;
+    }
+
+    HRESULT NullExpr::Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest )
+    {
+        if ( (mode == EvalMode_Address) || (!_Type->IsPointer() && !_Type->IsAArray()) )
+            return compiler.EmitTree( this, mode, dest );
+
+        Instruction&    inst = compiler.Emit( BOp_Const, dest, _Type );
+        inst.Imm = 0;
+        return S_OK;
+    }
+}
@@ -693,7 +693,7 @@ namespace MagoEE
             obj.Addr = thisAddr + offset;
         }
         else
-            Decl->GetAddress( obj.Addr );
+            binder->GetAddress( Decl, obj.Addr );
 
         if ( mode == EvalMode_Address )
         {
@@ -909,7 +909,7 @@ namespace MagoEE
         }
         // else is some other value: constant, var
         else
-            Decl->GetAddress( obj.Addr );
+            binder->GetAddress( Decl, obj.Addr );
 
         if ( mode == EvalMode_Address )
         {
@@ -936,7 +936,19 @@ namespace MagoEE
 
         childType = Child->_Type;
 
-        if ( Property->UsesParentValue() )
+        // the address comes from the binder, the declaration might have been
+        // bound in another frame
+        if ( Property->UsesParentAddress() )
+        {
+            DataObject  parent = { 0 };
+
+            hr = Child->Evaluate( EvalMode_Address, evalData, binder, parent );
+            if ( FAILED( hr ) )
+                return hr;
+
+            Property->GetValue( Child->_Type, parent.Addr, obj.Value );
+        }
+        else if ( Property->UsesParentValue() )
         {
             DataObject  parent = { 0 };
 
@@ -988,7 +1000,7 @@ namespace MagoEE
         UNREFERENCED_PARAMETER( evalData );
 
         obj._Type = _Type;
-        Decl->GetAddress( obj.Addr );
+        binder->GetAddress( Decl, obj.Addr );
 
         if ( mode == EvalMode_Address )
         {
@@ -1036,7 +1048,7 @@ namespace MagoEE
         UNREFERENCED_PARAMETER( evalData );
 
         obj._Type = _Type;
-        Decl->GetAddress( obj.Addr );
+        binder->GetAddress( Decl, obj.Addr );
 
         if ( mode == EvalMode_Address )
         {
@@ -22,6 +22,7 @@ namespace MagoEE
     class NamingExpression;
     class StdProperty;
     class SharedString;
+    class BytecodeCompiler;
 
 
     enum EvalMode
@@ -67,6 +68,7 @@ namespace MagoEE
         // TODO: abstract
         virtual HRESULT Semantic( const EvalData& evalData, ITypeEnv* typeEnv, IValueBinder* binder );
         virtual HRESULT Evaluate( EvalMode mode, const EvalData& evalData, IValueBinder* binder, DataObject& obj );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
         virtual bool TrySetType( Type* type );
         virtual NamingExpression* AsNamingExpression();
 
@@ -159,6 +161,7 @@ namespace MagoEE
         ConditionalExpr( Expression* predicate, Expression* trueExpr, Expression* falseExpr );
         virtual HRESULT Semantic( const EvalData& evalData, ITypeEnv* typeEnv, IValueBinder* binder );
         virtual HRESULT Evaluate( EvalMode mode, const EvalData& evalData, IValueBinder* binder, DataObject& obj );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
     };
 
 
@@ -168,6 +171,7 @@ namespace MagoEE
         OrOrExpr( Expression* left, Expression* right );
         virtual HRESULT Semantic( const EvalData& evalData, ITypeEnv* typeEnv, IValueBinder* binder );
         virtual HRESULT Evaluate( EvalMode mode, const EvalData& evalData, IValueBinder* binder, DataObject& obj );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
     };
 
 
@@ -177,6 +181,7 @@ namespace MagoEE
         AndAndExpr( Expression* left, Expression* right );
         virtual HRESULT Semantic( const EvalData& evalData, ITypeEnv* typeEnv, IValueBinder* binder );
         virtual HRESULT Evaluate( EvalMode mode, const EvalData& evalData, IValueBinder* binder, DataObject& obj );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
     };
 
 
@@ -227,6 +232,7 @@ namespace MagoEE
     {
     public:
         OrExpr( Expression* left, Expression* right );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
 
     protected:
         virtual bool    AllowOnlyIntegral();
@@ -239,6 +245,7 @@ namespace MagoEE
     {
     public:
         XorExpr( Expression* left, Expression* right );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
 
     protected:
         virtual bool    AllowOnlyIntegral();
@@ -251,6 +258,7 @@ namespace MagoEE
     {
     public:
         AndExpr( Expression* left, Expression* right );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
 
     protected:
         virtual bool    AllowOnlyIntegral();
@@ -279,6 +287,7 @@ namespace MagoEE
 
         virtual HRESULT Semantic( const EvalData& evalData, ITypeEnv* typeEnv, IValueBinder* binder );
         virtual HRESULT Evaluate( EvalMode mode, const EvalData& evalData, IValueBinder* binder, DataObject& obj );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
 
         template <class T>
         static bool IntegerOp( TOK code, T left, T right )
@@ -362,6 +371,7 @@ namespace MagoEE
     {
     public:
         ShiftLeftExpr( Expression* left, Expression* right );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
 
     protected:
         virtual uint64_t        IntOp( uint64_t left, uint32_t right, Type* type );
@@ -372,6 +382,7 @@ namespace MagoEE
     {
     public:
         ShiftRightExpr( Expression* left, Expression* right );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
 
     protected:
         virtual uint64_t        IntOp( uint64_t left, uint32_t right, Type* type );
@@ -382,6 +393,7 @@ namespace MagoEE
     {
     public:
         UShiftRightExpr( Expression* left, Expression* right );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
 
     protected:
         virtual uint64_t        IntOp( uint64_t left, uint32_t right, Type* type );
@@ -394,6 +406,7 @@ namespace MagoEE
         AddExpr( Expression* left, Expression* right );
         virtual HRESULT Semantic( const EvalData& evalData, ITypeEnv* typeEnv, IValueBinder* binder );
         virtual HRESULT Evaluate( EvalMode mode, const EvalData& evalData, IValueBinder* binder, DataObject& obj );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
 
     protected:
         virtual HRESULT UInt64Op( uint64_t left, uint64_t right, uint64_t& result );
@@ -413,6 +426,7 @@ namespace MagoEE
         MinExpr( Expression* left, Expression* right );
         virtual HRESULT Semantic( const EvalData& evalData, ITypeEnv* typeEnv, IValueBinder* binder );
         virtual HRESULT Evaluate( EvalMode mode, const EvalData& evalData, IValueBinder* binder, DataObject& obj );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
 
     protected:
         virtual HRESULT UInt64Op( uint64_t left, uint64_t right, uint64_t& result );
@@ -441,6 +455,7 @@ namespace MagoEE
         MulExpr( Expression* left, Expression* right );
         virtual HRESULT Semantic( const EvalData& evalData, ITypeEnv* typeEnv, IValueBinder* binder );
         virtual HRESULT Evaluate( EvalMode mode, const EvalData& evalData, IValueBinder* binder, DataObject& obj );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
 
     protected:
         virtual HRESULT UInt64Op( uint64_t left, uint64_t right, uint64_t& result );
@@ -459,6 +474,7 @@ namespace MagoEE
         DivExpr( Expression* left, Expression* right );
         virtual HRESULT Semantic( const EvalData& evalData, ITypeEnv* typeEnv, IValueBinder* binder );
         virtual HRESULT Evaluate( EvalMode mode, const EvalData& evalData, IValueBinder* binder, DataObject& obj );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
 
     protected:
         virtual HRESULT UInt64Op( uint64_t left, uint64_t right, uint64_t& result );
@@ -477,6 +493,7 @@ namespace MagoEE
         ModExpr( Expression* left, Expression* right );
         virtual HRESULT Semantic( const EvalData& evalData, ITypeEnv* typeEnv, IValueBinder* binder );
         virtual HRESULT Evaluate( EvalMode mode, const EvalData& evalData, IValueBinder* binder, DataObject& obj );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
 
     protected:
         virtual HRESULT UInt64Op( uint64_t left, uint64_t right, uint64_t& result );
@@ -510,6 +527,7 @@ namespace MagoEE
         AddressOfExpr( Expression* child );
         virtual HRESULT Semantic( const EvalData& evalData, ITypeEnv* typeEnv, IValueBinder* binder );
         virtual HRESULT Evaluate( EvalMode mode, const EvalData& evalData, IValueBinder* binder, DataObject& obj );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
     };
 
 
@@ -521,6 +539,7 @@ namespace MagoEE
         PointerExpr( Expression* child );
         virtual HRESULT Semantic( const EvalData& evalData, ITypeEnv* typeEnv, IValueBinder* binder );
         virtual HRESULT Evaluate( EvalMode mode, const EvalData& evalData, IValueBinder* binder, DataObject& obj );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
     };
 
 
@@ -532,6 +551,7 @@ namespace MagoEE
         NegateExpr( Expression* child );
         virtual HRESULT Semantic( const EvalData& evalData, ITypeEnv* typeEnv, IValueBinder* binder );
         virtual HRESULT Evaluate( EvalMode mode, const EvalData& evalData, IValueBinder* binder, DataObject& obj );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
     };
 
 
@@ -543,6 +563,7 @@ namespace MagoEE
         UnaryAddExpr( Expression* child );
         virtual HRESULT Semantic( const EvalData& evalData, ITypeEnv* typeEnv, IValueBinder* binder );
         virtual HRESULT Evaluate( EvalMode mode, const EvalData& evalData, IValueBinder* binder, DataObject& obj );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
     };
 
 
@@ -554,6 +575,7 @@ namespace MagoEE
         NotExpr( Expression* child );
         virtual HRESULT Semantic( const EvalData& evalData, ITypeEnv* typeEnv, IValueBinder* binder );
         virtual HRESULT Evaluate( EvalMode mode, const EvalData& evalData, IValueBinder* binder, DataObject& obj );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
     };
 
 
@@ -565,6 +587,7 @@ namespace MagoEE
         BitNotExpr( Expression* child );
         virtual HRESULT Semantic( const EvalData& evalData, ITypeEnv* typeEnv, IValueBinder* binder );
         virtual HRESULT Evaluate( EvalMode mode, const EvalData& evalData, IValueBinder* binder, DataObject& obj );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
     };
 
 
@@ -595,6 +618,7 @@ namespace MagoEE
         CastExpr( Expression* child, Type* type );
         virtual HRESULT Semantic( const EvalData& evalData, ITypeEnv* typeEnv, IValueBinder* binder );
         virtual HRESULT Evaluate( EvalMode mode, const EvalData& evalData, IValueBinder* binder, DataObject& obj );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
 
         static bool CanImplicitCast( Type* source, Type* dest );
         static bool CanCast( Type* source, Type* dest );
@@ -634,6 +658,7 @@ namespace MagoEE
         DotExpr( Expression* child, Utf16String* id );
         virtual HRESULT Semantic( const EvalData& evalData, ITypeEnv* typeEnv, IValueBinder* binder );
         virtual HRESULT Evaluate( EvalMode mode, const EvalData& evalData, IValueBinder* binder, DataObject& obj );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
 
     protected:
         virtual HRESULT MakeName( uint32_t capacity, RefPtr<SharedString>& namePath );
@@ -694,6 +719,7 @@ namespace MagoEE
         IndexExpr( Expression* child, ExpressionList* args );
         virtual HRESULT Semantic( const EvalData& evalData, ITypeEnv* typeEnv, IValueBinder* binder );
         virtual HRESULT Evaluate( EvalMode mode, const EvalData& evalData, IValueBinder* binder, DataObject& obj );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
     };
 
 
@@ -720,6 +746,7 @@ namespace MagoEE
         IdExpr( Utf16String* id );
         virtual HRESULT Semantic( const EvalData& evalData, ITypeEnv* typeEnv, IValueBinder* binder );
         virtual HRESULT Evaluate( EvalMode mode, const EvalData& evalData, IValueBinder* binder, DataObject& obj );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
 
     protected:
         virtual HRESULT MakeName( uint32_t capacity, RefPtr<SharedString>& namePath );
@@ -804,6 +831,7 @@ namespace MagoEE
         IntExpr( uint64_t value, Type* type );
         virtual HRESULT Semantic( const EvalData& evalData, ITypeEnv* typeEnv, IValueBinder* binder );
         virtual HRESULT Evaluate( EvalMode mode, const EvalData& evalData, IValueBinder* binder, DataObject& obj );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
     };
 
 
@@ -876,6 +904,7 @@ namespace MagoEE
     public:
         virtual HRESULT Semantic( const EvalData& evalData, ITypeEnv* typeEnv, IValueBinder* binder );
         virtual HRESULT Evaluate( EvalMode mode, const EvalData& evalData, IValueBinder* binder, DataObject& obj );
+        virtual HRESULT Compile( BytecodeCompiler& compiler, EvalMode mode, uint8_t dest );
         virtual bool TrySetType( Type* type );
     };
 
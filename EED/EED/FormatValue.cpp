@@ -489,6 +489,16 @@ namespace MagoEE
         if ( !decl->EnumMembers( members.Ref() ) )
             return E_INVALIDARG;
 
+        // read all the members that have values at once, instead of one at a
+        // time as they're formatted; anything missed is read as it was before
+        PrefetchBinder          prefetch( binder );
+        std::vector<MemoryRead> reads;
+
+        if ( addr != 0 )
+            AddStructReads( type, addr, reads );
+        if ( !reads.empty() )
+            prefetch.Prefetch( &reads[0], (uint32_t) reads.size() );
+
         outStr.append( L"{" );
         for ( ; ; )
         {
@@ -511,12 +521,12 @@ namespace MagoEE
             if ( member->GetOffset( offset ) )
                 memberObj.Addr += offset;
 
-            hr = binder->GetValue( memberObj.Addr, memberObj._Type, memberObj.Value );
+            hr = prefetch.GetValue( memberObj.Addr, memberObj._Type, memberObj.Value );
             if ( FAILED( hr ) )
                 return hr;
 
             std::wstring memberStr;
-            hr = FormatValue( binder, memberObj, radix, memberStr );
+            hr = FormatValue( &prefetch, memberObj, radix, memberStr );
             if ( FAILED( hr ) )
                 return hr;
 
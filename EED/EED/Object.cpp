@@ -11,6 +11,15 @@
 
 namespace MagoEE
 {
+    // Every object is preceded by the arena it came from, or NULL for the 
+    // heap. It's padded to keep the object 8 byte aligned.
+    union ObjectHeader
+    {
+        ObjectArena*    Arena;
+        double          Align;
+    };
+
+
     Object::Object()
         :   mRefCount( 0 )
     {
@@ -22,19 +31,140 @@ namespace MagoEE
 
     void Object::AddRef()
     {
-        mRefCount++;
+        InterlockedIncrement( &mRefCount );
     }
 
     void Object::Release()
     {
-        mRefCount--;
-        _ASSERT( mRefCount >= 0 );
-        if ( mRefCount == 0 )
+        long    newRef = InterlockedDecrement( &mRefCount );
+        _ASSERT( newRef >= 0 );
+        if ( newRef == 0 )
         {
             delete this;
         }
     }
 
+    void* Object::operator new( size_t size )
+    {
+        ObjectHeader*   header = (ObjectHeader*) ::operator new( sizeof( ObjectHeader ) + size );
+
+        header->Arena = NULL;
+        return header + 1;
+    }
+
+    void* Object::operator new( size_t size, ObjectArena* arena )
+    {
+        if ( arena == NULL )
+            return operator new( size );
+
+        ObjectHeader*   header = (ObjectHeader*) arena->Alloc( sizeof( ObjectHeader ) + size );
+
+        header->Arena = arena;
+        arena->AddRef();
+        return header + 1;
+    }
+
+    void Object::operator delete( void* p )
+    {
+        if ( p == NULL )
+            return;
+
+        ObjectHeader*   header = (ObjectHeader*) p - 1;
+
+        if ( header->Arena != NULL )
+            header->Arena->Release();
+        else
+            ::operator delete( header );
+    }
+
+    void Object::operator delete( void* p, ObjectArena* arena )
+    {
+        UNREFERENCED_PARAMETER( arena );
+        operator delete( p );
+    }
+
+
+    //------------------------------------------------------------------------
+    //  ObjectArena
+    //------------------------------------------------------------------------
+
+    ObjectArena::ObjectArena()
+        :   mRefCount( 0 ),
+            mChunks( NULL ),
+            mCur( mFirstChunk ),
+            mLimit( mFirstChunk + FirstChunkSize )
+    {
+    }
+
+    ObjectArena::~ObjectArena()
+    {
+        while ( mChunks != NULL )
+        {
+            Chunk*  next = mChunks->Next;
+
+            ::operator delete( mChunks );
+            mChunks = next;
+        }
+    }
+
+    void ObjectArena::AddRef()
+    {
+        InterlockedIncrement( &mRefCount );
+    }
+
+    void ObjectArena::Release()
+    {
+        long    newRef = InterlockedDecrement( &mRefCount );
+        _ASSERT( newRef >= 0 );
+        if ( newRef == 0 )
+        {
+            delete this;
+        }
+    }
+
+    void* ObjectArena::Alloc( size_t size )
+    {
+        const size_t    Align = sizeof( ObjectHeader );
+        const size_t    HeaderSize = (sizeof( Chunk ) + Align - 1) & ~(Align - 1);
+
+        size = (size + Align - 1) & ~(Align - 1);
+
+        if ( size > (size_t) (mLimit - mCur) )
+        {
+            // big blocks get a chunk of their own, behind the current one, 
+            // so that the rest of the current chunk can still be used
+            if ( size > (ChunkSize - HeaderSize) / 4 )
+            {
+                Chunk*  chunk = (Chunk*) ::operator new( HeaderSize + size );
+
+                if ( mChunks != NULL )
+                {
+                    chunk->Next = mChunks->Next;
+                    mChunks->Next = chunk;
+                }
+                else
+                {
+                    chunk->Next = NULL;
+                    mChunks = chunk;
+                }
+
+                return (uint8_t*) chunk + HeaderSize;
+            }
+
+            Chunk*  chunk = (Chunk*) ::operator new( ChunkSize );
+
+            chunk->Next = mChunks;
+            mChunks = chunk;
+            mCur = (uint8_t*) chunk + HeaderSize;
+            mLimit = (uint8_t*) chunk + ChunkSize;
+        }
+
+        void*   p = mCur;
+        mCur += size;
+        return p;
+    }
+
+
     ObjectKind ObjectList::GetObjectKind()
     {
         return ObjectKind_ObjectList;
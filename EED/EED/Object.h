@@ -22,6 +22,9 @@ namespace MagoEE
         ObjectKind_ParameterList,
     };
 
+    class ObjectArena;
+
+
     class Object
     {
         long    mRefCount;
@@ -34,6 +37,59 @@ namespace MagoEE
         virtual void Release();
 
         virtual ObjectKind GetObjectKind() = 0;
+
+        // An object made with the arena form of new lives in the arena's 
+        // chunks. It's still released like any other, but its memory only 
+        // goes back when the arena and everything in it have been released.
+        // A NULL arena means the heap.
+        static void* operator new( size_t size );
+        static void* operator new( size_t size, ObjectArena* arena );
+        static void operator delete( void* p );
+        static void operator delete( void* p, ObjectArena* arena );
+    };
+
+
+    // A bump pointer allocator for the nodes of one parsed expression, so 
+    // that parsing doesn't go to the heap for every node. Each object in the 
+    // arena holds a reference on it, so the chunks outlive any node that 
+    // escapes the tree, like a type that ends up in an evaluation result.
+
+    class ObjectArena
+    {
+        struct Chunk
+        {
+            Chunk*      Next;
+        };
+
+        static const size_t ChunkSize = 1024;
+        static const size_t FirstChunkSize = 512;
+
+        long        mRefCount;
+        Chunk*      mChunks;
+        uint8_t*    mCur;
+        uint8_t*    mLimit;
+
+        // most expressions fit in here, so the arena's the only allocation
+        union
+        {
+            double      mAlign;
+            uint8_t     mFirstChunk[FirstChunkSize];
+        };
+
+    public:
+        ObjectArena();
+        ~ObjectArena();
+
+        void AddRef();
+        void Release();
+
+        // Not thread safe. Only the parser filling the arena allocates in it, 
+        // but objects can be released from any thread.
+        void* Alloc( size_t size );
+
+    private:
+        ObjectArena( const ObjectArena& );
+        ObjectArena& operator=( const ObjectArena& );
     };
 
 
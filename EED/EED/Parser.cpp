@@ -20,9 +20,10 @@ using namespace std;
 
 namespace MagoEE
 {
-    Parser::Parser( Scanner* scanner, ITypeEnv* typeEnv )
+    Parser::Parser( Scanner* scanner, ITypeEnv* typeEnv, ObjectArena* arena )
     :   mScanner( scanner ),
         mTypeEnv( typeEnv ),
+        mArena( arena ),
         mDVer( 2 ),
         mBracketCount( 0 )
     {
@@ -39,16 +40,15 @@ namespace MagoEE
 
     RefPtr<Expression> Parser::ParseCommaExpr()
     {
-        RefPtr<Expression>  e;
+        RefPtr<Expression>  e = ParseAssignExpr();
         RefPtr<Expression>  e2;
 
-        e = ParseAssignExpr();
 
         while ( GetTokenCode() == TOKcomma )
         {
             NextToken();
             e2 = ParseAssignExpr();
-            e = new CommaExpr( e.Get(), e2.Get() );
+            e = new ( mArena ) CommaExpr( e.Get(), e2.Get() );
         }
 
         return e;
@@ -56,30 +56,29 @@ namespace MagoEE
 
     RefPtr<Expression> Parser::ParseAssignExpr()
     {
-        RefPtr<Expression>  e;
+        RefPtr<Expression>  e = ParseConditionalExpr();
         RefPtr<Expression>  e2;
 
-        e = ParseConditionalExpr();
 
         for ( ; ; )
         {
             switch ( GetTokenCode() )
             {
-            case TOKassign: NextToken(); e2 = ParseAssignExpr(); e = new AssignExpr( e.Get(), e2.Get() ); break;
-
-            case TOKaddass: NextToken(); e2 = ParseAssignExpr(); e = new CombinedAssignExpr( new AddExpr( e.Get(), e2.Get() ) ); break;
-            case TOKminass: NextToken(); e2 = ParseAssignExpr(); e = new CombinedAssignExpr( new MinExpr( e.Get(), e2.Get() ) ); break;
-            case TOKmulass: NextToken(); e2 = ParseAssignExpr(); e = new CombinedAssignExpr( new MulExpr( e.Get(), e2.Get() ) ); break;
-            case TOKdivass: NextToken(); e2 = ParseAssignExpr(); e = new CombinedAssignExpr( new DivExpr( e.Get(), e2.Get() ) ); break;
-            case TOKmodass: NextToken(); e2 = ParseAssignExpr(); e = new CombinedAssignExpr( new ModExpr( e.Get(), e2.Get() ) ); break;
-            //case TOKpowas: NextToken(); e2 = ParseAssignExpr(); e = new CombinedAssignExpr( new PowExpr( e.Get(), e2.Get() ) ); break;
-            case TOKandass: NextToken(); e2 = ParseAssignExpr(); e = new CombinedAssignExpr( new AndExpr( e.Get(), e2.Get() ) ); break;
-            case TOKorass:  NextToken(); e2 = ParseAssignExpr(); e = new CombinedAssignExpr( new OrExpr( e.Get(), e2.Get() ) ); break;
-            case TOKxorass: NextToken(); e2 = ParseAssignExpr(); e = new CombinedAssignExpr( new XorExpr( e.Get(), e2.Get() ) ); break;
-            case TOKshlass: NextToken(); e2 = ParseAssignExpr(); e = new CombinedAssignExpr( new ShiftLeftExpr( e.Get(), e2.Get() ) ); break;
-            case TOKshrass: NextToken(); e2 = ParseAssignExpr(); e = new CombinedAssignExpr( new ShiftRightExpr( e.Get(), e2.Get() ) ); break;
-            case TOKushrass:NextToken(); e2 = ParseAssignExpr(); e = new CombinedAssignExpr( new UShiftRightExpr( e.Get(), e2.Get() ) ); break;
-            case TOKcatass: NextToken(); e2 = ParseAssignExpr(); e = new CombinedAssignExpr( new CatExpr( e.Get(), e2.Get() ) ); break;
+            case TOKassign: NextToken(); e2 = ParseAssignExpr(); e = new ( mArena ) AssignExpr( e.Get(), e2.Get() ); break;
+
+            case TOKaddass: NextToken(); e2 = ParseAssignExpr(); e = new ( mArena ) CombinedAssignExpr( new ( mArena ) AddExpr( e.Get(), e2.Get() ) ); break;
+            case TOKminass: NextToken(); e2 = ParseAssignExpr(); e = new ( mArena ) CombinedAssignExpr( new ( mArena ) MinExpr( e.Get(), e2.Get() ) ); break;
+            case TOKmulass: NextToken(); e2 = ParseAssignExpr(); e = new ( mArena ) CombinedAssignExpr( new ( mArena ) MulExpr( e.Get(), e2.Get() ) ); break;
+            case TOKdivass: NextToken(); e2 = ParseAssignExpr(); e = new ( mArena ) CombinedAssignExpr( new ( mArena ) DivExpr( e.Get(), e2.Get() ) ); break;
+            case TOKmodass: NextToken(); e2 = ParseAssignExpr(); e = new ( mArena ) CombinedAssignExpr( new ( mArena ) ModExpr( e.Get(), e2.Get() ) ); break;
+            //case TOKpowas: NextToken(); e2 = ParseAssignExpr(); e = new ( mArena ) CombinedAssignExpr( new ( mArena ) PowExpr( e.Get(), e2.Get() ) ); break;
+            case TOKandass: NextToken(); e2 = ParseAssignExpr(); e = new ( mArena ) CombinedAssignExpr( new ( mArena ) AndExpr( e.Get(), e2.Get() ) ); break;
+            case TOKorass:  NextToken(); e2 = ParseAssignExpr(); e = new ( mArena ) CombinedAssignExpr( new ( mArena ) OrExpr( e.Get(), e2.Get() ) ); break;
+            case TOKxorass: NextToken(); e2 = ParseAssignExpr(); e = new ( mArena ) CombinedAssignExpr( new ( mArena ) XorExpr( e.Get(), e2.Get() ) ); break;
+            case TOKshlass: NextToken(); e2 = ParseAssignExpr(); e = new ( mArena ) CombinedAssignExpr( new ( mArena ) ShiftLeftExpr( e.Get(), e2.Get() ) ); break;
+            case TOKshrass: NextToken(); e2 = ParseAssignExpr(); e = new ( mArena ) CombinedAssignExpr( new ( mArena ) ShiftRightExpr( e.Get(), e2.Get() ) ); break;
+            case TOKushrass:NextToken(); e2 = ParseAssignExpr(); e = new ( mArena ) CombinedAssignExpr( new ( mArena ) UShiftRightExpr( e.Get(), e2.Get() ) ); break;
+            case TOKcatass: NextToken(); e2 = ParseAssignExpr(); e = new ( mArena ) CombinedAssignExpr( new ( mArena ) CatExpr( e.Get(), e2.Get() ) ); break;
             default:
                 goto Done;
             }
@@ -91,18 +90,17 @@ Done:
 
     RefPtr<Expression> Parser::ParseConditionalExpr()
     {
-        RefPtr<Expression>  e;
+        RefPtr<Expression>  e = ParseOrOrExpr();
         RefPtr<Expression>  e2;
         RefPtr<Expression>  e3;
 
-        e = ParseOrOrExpr();
 
         if ( GetTokenCode() == TOKquestion )
         {
             e2 = ParseExpression();
             ReadToken( TOKcolon );
             e3 = ParseConditionalExpr();
-            e = new ConditionalExpr( e.Get(), e2.Get(), e3.Get() );
+            e = new ( mArena ) ConditionalExpr( e.Get(), e2.Get(), e3.Get() );
         }
 
         return e;
@@ -110,16 +108,15 @@ Done:
 
     RefPtr<Expression> Parser::ParseOrOrExpr()
     {
-        RefPtr<Expression>  e;
+        RefPtr<Expression>  e = ParseAndAndExpr();
         RefPtr<Expression>  e2;
 
-        e = ParseAndAndExpr();
 
         while ( GetTokenCode() == TOKoror )
         {
             NextToken();
             e2 = ParseAndAndExpr();
-            e = new OrOrExpr( e.Get(), e2.Get() );
+            e = new ( mArena ) OrOrExpr( e.Get(), e2.Get() );
         }
 
         return e;
@@ -127,16 +124,15 @@ Done:
 
     RefPtr<Expression> Parser::ParseAndAndExpr()
     {
-        RefPtr<Expression>  e;
+        RefPtr<Expression>  e = ParseOrExpr();
         RefPtr<Expression>  e2;
 
-        e = ParseOrExpr();
 
         while ( GetTokenCode() == TOKandand )
         {
             NextToken();
             e2 = ParseOrExpr();
-            e = new AndAndExpr( e.Get(), e2.Get() );
+            e = new ( mArena ) AndAndExpr( e.Get(), e2.Get() );
         }
 
         return e;
@@ -144,16 +140,15 @@ Done:
 
     RefPtr<Expression> Parser::ParseOrExpr()
     {
-        RefPtr<Expression>  e;
+        RefPtr<Expression>  e = ParseXorExpr();
         RefPtr<Expression>  e2;
 
-        e = ParseXorExpr();
 
         while ( GetTokenCode() == TOKor )
         {
             NextToken();
             e2 = ParseXorExpr();
-            e = new OrExpr( e.Get(), e2.Get() );
+            e = new ( mArena ) OrExpr( e.Get(), e2.Get() );
         }
 
         return e;
@@ -161,16 +156,15 @@ Done:
 
     RefPtr<Expression> Parser::ParseXorExpr()
     {
-        RefPtr<Expression>  e;
+        RefPtr<Expression>  e = ParseAndExpr();
         RefPtr<Expression>  e2;
 
-        e = ParseAndExpr();
 
         while ( GetTokenCode() == TOKxor )
         {
             NextToken();
             e2 = ParseAndExpr();
-            e = new XorExpr( e.Get(), e2.Get() );
+            e = new ( mArena ) XorExpr( e.Get(), e2.Get() );
         }
 
         return e;
@@ -190,7 +184,7 @@ Done:
             {
                 NextToken();
                 e2 = ParseEqualExpr();
-                e = new AndExpr( e.Get(), e2.Get() );
+                e = new ( mArena ) AndExpr( e.Get(), e2.Get() );
             }
         }
         else
@@ -201,7 +195,7 @@ Done:
             {
                 NextToken();
                 e2 = ParseCmpExpr();
-                e = new AndExpr( e.Get(), e2.Get() );
+                e = new ( mArena ) AndExpr( e.Get(), e2.Get() );
             }
         }
 
@@ -210,10 +204,9 @@ Done:
 
     RefPtr<Expression> Parser::ParseCmpExpr()
     {
-        RefPtr<Expression>  e;
+        RefPtr<Expression>  e = ParseShiftExpr();
         RefPtr<Expression>  e2;
 
-        e = ParseShiftExpr();
 
         for ( ; ; )
         {
@@ -225,13 +218,13 @@ Done:
             case TOKnotequal:
                 NextToken();
                 e2 = ParseShiftExpr();
-                e = new EqualExpr( opCode, e.Get(), e2.Get() );
+                e = new ( mArena ) EqualExpr( opCode, e.Get(), e2.Get() );
                 break;
 
             case TOKis:
                 NextToken();
                 e2 = ParseShiftExpr();
-                e = new IdentityExpr( TOKidentity, e.Get(), e2.Get() );
+                e = new ( mArena ) IdentityExpr( TOKidentity, e.Get(), e2.Get() );
                 break;
 
             case TOKnot:
@@ -240,7 +233,7 @@ Done:
                 NextToken();
                 NextToken();
                 e2 = ParseShiftExpr();
-                e = new IdentityExpr( TOKnotidentity, e.Get(), e2.Get() );
+                e = new ( mArena ) IdentityExpr( TOKnotidentity, e.Get(), e2.Get() );
                 break;
 
             case TOKlt:
@@ -259,13 +252,13 @@ Done:
                 e2 = ParseShiftExpr();
                 // D front end only makes CmpExp, and their RelExp seems deprecated
                 // it's the other way around here
-                e = new RelExpr( opCode, e.Get(), e2.Get() );
+                e = new ( mArena ) RelExpr( opCode, e.Get(), e2.Get() );
                 break;
 
             case TOKin:
                 NextToken();
                 e2 = ParseShiftExpr();
-                e = new InExpr( e.Get(), e2.Get() );
+                e = new ( mArena ) InExpr( e.Get(), e2.Get() );
                 break;
 
             default:
@@ -279,10 +272,9 @@ Done:
 
     RefPtr<Expression> Parser::ParseEqualExpr()
     {
-        RefPtr<Expression>  e;
+        RefPtr<Expression>  e = ParseRelExpr();
         RefPtr<Expression>  e2;
 
-        e = ParseRelExpr();
 
         for ( ; ; )
         {
@@ -294,7 +286,7 @@ Done:
             case TOKnotequal:
                 NextToken();
                 e2 = ParseRelExpr();
-                e = new EqualExpr( opCode, e.Get(), e2.Get() );
+                e = new ( mArena ) EqualExpr( opCode, e.Get(), e2.Get() );
                 break;
 
             case TOKidentity:
@@ -304,7 +296,7 @@ Done:
                     opCode = TOKidentity;
                 NextToken();
                 e2 = ParseRelExpr();
-                e = new IdentityExpr( opCode, e.Get(), e2.Get() );
+                e = new ( mArena ) IdentityExpr( opCode, e.Get(), e2.Get() );
                 break;
 
             case TOKnot:
@@ -313,7 +305,7 @@ Done:
                 NextToken();
                 NextToken();
                 e2 = ParseRelExpr();
-                e = new IdentityExpr( TOKnotidentity, e.Get(), e2.Get() );
+                e = new ( mArena ) IdentityExpr( TOKnotidentity, e.Get(), e2.Get() );
                 break;
 
             default:
@@ -327,10 +319,9 @@ Done:
 
     RefPtr<Expression> Parser::ParseRelExpr()
     {
-        RefPtr<Expression>  e;
+        RefPtr<Expression>  e = ParseShiftExpr();
         RefPtr<Expression>  e2;
 
-        e = ParseShiftExpr();
 
         for ( ; ; )
         {
@@ -352,13 +343,13 @@ Done:
             case TOKue:
                 NextToken();
                 e2 = ParseShiftExpr();
-                e = new RelExpr( opCode, e.Get(), e2.Get() );
+                e = new ( mArena ) RelExpr( opCode, e.Get(), e2.Get() );
                 break;
 
             case TOKin:
                 NextToken();
                 e2 = ParseShiftExpr();
-                e = new InExpr( e.Get(), e2.Get() );
+                e = new ( mArena ) InExpr( e.Get(), e2.Get() );
                 break;
 
             default:
@@ -372,10 +363,9 @@ Done:
 
     RefPtr<Expression> Parser::ParseShiftExpr()
     {
-        RefPtr<Expression>  e;
+        RefPtr<Expression>  e = ParseAddExpr();
         RefPtr<Expression>  e2;
 
-        e = ParseAddExpr();
 
         for ( ; ; )
         {
@@ -384,19 +374,19 @@ Done:
             case TOKshl:
                 NextToken();
                 e2 = ParseAddExpr();
-                e = new ShiftLeftExpr( e.Get(), e2.Get() );
+                e = new ( mArena ) ShiftLeftExpr( e.Get(), e2.Get() );
                 break;
 
             case TOKshr:
                 NextToken();
                 e2 = ParseAddExpr();
-                e = new ShiftRightExpr( e.Get(), e2.Get() );
+                e = new ( mArena ) ShiftRightExpr( e.Get(), e2.Get() );
                 break;
 
             case TOKushr:
                 NextToken();
                 e2 = ParseAddExpr();
-                e = new UShiftRightExpr( e.Get(), e2.Get() );
+                e = new ( mArena ) UShiftRightExpr( e.Get(), e2.Get() );
                 break;
 
             default:
@@ -410,10 +400,9 @@ Done:
 
     RefPtr<Expression> Parser::ParseAddExpr()
     {
-        RefPtr<Expression>  e;
+        RefPtr<Expression>  e = ParseMulExpr();
         RefPtr<Expression>  e2;
 
-        e = ParseMulExpr();
 
         for ( ; ; )
         {
@@ -422,19 +411,19 @@ Done:
             case TOKadd:
                 NextToken();
                 e2 = ParseMulExpr();
-                e = new AddExpr( e.Get(), e2.Get() );
+                e = new ( mArena ) AddExpr( e.Get(), e2.Get() );
                 break;
 
             case TOKmin:
                 NextToken();
                 e2 = ParseMulExpr();
-                e = new MinExpr( e.Get(), e2.Get() );
+                e = new ( mArena ) MinExpr( e.Get(), e2.Get() );
                 break;
 
             case TOKtilde:
                 NextToken();
                 e2 = ParseMulExpr();
-                e = new CatExpr( e.Get(), e2.Get() );
+                e = new ( mArena ) CatExpr( e.Get(), e2.Get() );
                 break;
 
             default:
@@ -448,10 +437,9 @@ Done:
 
     RefPtr<Expression> Parser::ParseMulExpr()
     {
-        RefPtr<Expression>  e;
+        RefPtr<Expression>  e = ParseUnaryExpr();
         RefPtr<Expression>  e2;
 
-        e = ParseUnaryExpr();
 
         for ( ; ; )
         {
@@ -460,25 +448,25 @@ Done:
             case TOKmul:
                 NextToken();
                 e2 = ParseUnaryExpr();
-                e = new MulExpr( e.Get(), e2.Get() );
+                e = new ( mArena ) MulExpr( e.Get(), e2.Get() );
                 break;
 
             case TOKdiv:
                 NextToken();
                 e2 = ParseUnaryExpr();
-                e = new DivExpr( e.Get(), e2.Get() );
+                e = new ( mArena ) DivExpr( e.Get(), e2.Get() );
                 break;
 
             case TOKmod:
                 NextToken();
                 e2 = ParseUnaryExpr();
-                e = new ModExpr( e.Get(), e2.Get() );
+                e = new ( mArena ) ModExpr( e.Get(), e2.Get() );
                 break;
 
             case TOKpow:
                 NextToken();
                 e2 = ParseUnaryExpr();
-                e = new PowExpr( e.Get(), e2.Get() );
+                e = new ( mArena ) PowExpr( e.Get(), e2.Get() );
                 break;
 
             default:
@@ -500,51 +488,51 @@ Done:
         case TOKand:
             NextToken();
             e = ParseUnaryExpr();
-            e = new AddressOfExpr( e.Get() );
+            e = new ( mArena ) AddressOfExpr( e.Get() );
             break;
 
         case TOKplusplus:
             NextToken();
             e = ParseUnaryExpr();
-            e2 = new IntExpr( 1, mTypeEnv->GetType( Tint32 ) );
-            e = new CombinedAssignExpr( new AddExpr( e.Get(), e2.Get() ) );
+            e2 = new ( mArena ) IntExpr( 1, mTypeEnv->GetType( Tint32 ) );
+            e = new ( mArena ) CombinedAssignExpr( new ( mArena ) AddExpr( e.Get(), e2.Get() ) );
             break;
 
         case TOKminusminus:
             NextToken();
             e = ParseUnaryExpr();
-            e2 = new IntExpr( 1, mTypeEnv->GetType( Tint32 ) );
-            e = new CombinedAssignExpr( new MinExpr( e.Get(), e2.Get() ) );
+            e2 = new ( mArena ) IntExpr( 1, mTypeEnv->GetType( Tint32 ) );
+            e = new ( mArena ) CombinedAssignExpr( new ( mArena ) MinExpr( e.Get(), e2.Get() ) );
             break;
 
         case TOKmul:
             NextToken();
             e = ParseUnaryExpr();
-            e = new PointerExpr( e.Get() );
+            e = new ( mArena ) PointerExpr( e.Get() );
             break;
 
         case TOKmin:
             NextToken();
             e = ParseUnaryExpr();
-            e = new NegateExpr( e.Get() );
+            e = new ( mArena ) NegateExpr( e.Get() );
             break;
 
         case TOKadd:
             NextToken();
             e = ParseUnaryExpr();
-            e = new UnaryAddExpr( e.Get() );
+            e = new ( mArena ) UnaryAddExpr( e.Get() );
             break;
 
         case TOKnot:
             NextToken();
             e = ParseUnaryExpr();
-            e = new NotExpr( e.Get() );
+            e = new ( mArena ) NotExpr( e.Get() );
             break;
 
         case TOKtilde:
             NextToken();
             e = ParseUnaryExpr();
-            e = new BitNotExpr( e.Get() );
+            e = new ( mArena ) BitNotExpr( e.Get() );
             break;
 
         case TOKnew:
@@ -554,7 +542,7 @@ Done:
         case TOKdelete:
             NextToken();
             e = ParseUnaryExpr();
-            e = new DeleteExpr( e.Get() );
+            e = new ( mArena ) DeleteExpr( e.Get() );
             break;
 
         case TOKcast:
@@ -596,14 +584,14 @@ Done:
                 {
                     NextToken();
                     e = ParseUnaryExpr();
-                    e = new CastExpr( e.Get(), flags );
+                    e = new ( mArena ) CastExpr( e.Get(), flags );
                 }
                 else
                 {
                     RefPtr<Type>    type = ParseType();
                     ReadToken( TOKrparen );
                     e = ParseUnaryExpr();
-                    e = new CastExpr( e.Get(), type.Get() );
+                    e = new ( mArena ) CastExpr( e.Get(), type.Get() );
                 }
                 break;
             }
@@ -637,7 +625,7 @@ Done:
                     NextToken();
                     if ( (GetTokenCode() == TOKnot) && (PeekTokenCode( 1 ) != TOKis) )
                     {
-                        RefPtr<TemplateInstancePart>    instance = new TemplateInstancePart( id );
+                        RefPtr<TemplateInstancePart>    instance = new ( mArena ) TemplateInstancePart( id );
                         const wchar_t*  startPtr = mScanner->GetToken().TextStartPtr;
                         NextToken();
 
@@ -650,11 +638,11 @@ Done:
                         const wchar_t*  endPtr = mScanner->GetToken().TextStartPtr;
                         instance->ArgumentString = mScanner->GetNameTable()->AddString( startPtr, (endPtr - startPtr) );
 
-                        e = new DotTemplateInstanceExpr( e.Get(), instance.Get() );
+                        e = new ( mArena ) DotTemplateInstanceExpr( e.Get(), instance.Get() );
                     }
                     else
                     {
-                        e = new DotExpr( e.Get(), id );
+                        e = new ( mArena ) DotExpr( e.Get(), id );
                     }
                 }
                 else
@@ -664,14 +652,14 @@ Done:
             case TOKplusplus:
             case TOKminusminus:
                 {
-                    RefPtr<Expression>  e2 = new IntExpr( 1, mTypeEnv->GetType( Tint32 ) );
+                    RefPtr<Expression>  e2 = new ( mArena ) IntExpr( 1, mTypeEnv->GetType( Tint32 ) );
                     RefPtr<CombinableBinExpr>   e3;
                     if ( token->Code == TOKplusplus )
-                        e3 = new AddExpr( e, e2 );
+                        e3 = new ( mArena ) AddExpr( e, e2 );
                     else
-                        e3 = new MinExpr( e, e2 );
-                    e = new CombinedAssignExpr( e3, true );
-                    //e = new PostExpr( e.Get(), token->Code );
+                        e3 = new ( mArena ) MinExpr( e, e2 );
+                    e = new ( mArena ) CombinedAssignExpr( e3, true );
+                    //e = new ( mArena ) PostExpr( e.Get(), token->Code );
                     NextToken();
                 }
                 break;
@@ -679,7 +667,7 @@ Done:
             case TOKlparen:
                 {
                     RefPtr<ExpressionList>  args = ParseCallArguments();
-                    e = new CallExpr( e.Get(), args.Get() );
+                    e = new ( mArena ) CallExpr( e.Get(), args.Get() );
                 }
                 break;
 
@@ -690,7 +678,7 @@ Done:
                 
                 if ( GetTokenCode() == TOKrbracket )
                 {
-                    e = new SliceExpr( e.Get(), NULL, NULL );
+                    e = new ( mArena ) SliceExpr( e.Get(), NULL, NULL );
                 }
                 else
                 {
@@ -701,11 +689,11 @@ Done:
                         NextToken();
 
                         RefPtr<Expression>  limit = ParseAssignExpr();
-                        e = new SliceExpr( e.Get(), index.Get(), limit.Get() );
+                        e = new ( mArena ) SliceExpr( e.Get(), index.Get(), limit.Get() );
                     }
                     else
                     {
-                        RefPtr<ExpressionList>  args = new ExpressionList();
+                        RefPtr<ExpressionList>  args = new ( mArena ) ExpressionList();
 
                         args->List.push_back( index );
 
@@ -718,7 +706,7 @@ Done:
                             args->List.push_back( arg );
                         }
 
-                        e = new IndexExpr( e.Get(), args.Get() );
+                        e = new ( mArena ) IndexExpr( e.Get(), args.Get() );
                     }
                 }
 
@@ -737,7 +725,7 @@ Done:
 
     RefPtr<ExpressionList> Parser::ParseCallArguments()
     {
-        RefPtr<ExpressionList>  args = new ExpressionList();
+        RefPtr<ExpressionList>  args = new ( mArena ) ExpressionList();
 
         NextToken();
 
@@ -766,67 +754,67 @@ Done:
         switch ( token->Code )
         {
         case TOKint32v:
-            e = new IntExpr( token->UInt64Value, mTypeEnv->GetType( Tint32 ) );
+            e = new ( mArena ) IntExpr( token->UInt64Value, mTypeEnv->GetType( Tint32 ) );
             NextToken();
             break;
 
         case TOKuns32v:
-            e = new IntExpr( token->UInt64Value, mTypeEnv->GetType( Tuns32 ) );
+            e = new ( mArena ) IntExpr( token->UInt64Value, mTypeEnv->GetType( Tuns32 ) );
             NextToken();
             break;
 
         case TOKint64v:
-            e = new IntExpr( token->UInt64Value, mTypeEnv->GetType( Tint64 ) );
+            e = new ( mArena ) IntExpr( token->UInt64Value, mTypeEnv->GetType( Tint64 ) );
             NextToken();
             break;
 
         case TOKuns64v:
-            e = new IntExpr( token->UInt64Value, mTypeEnv->GetType( Tuns64 ) );
+            e = new ( mArena ) IntExpr( token->UInt64Value, mTypeEnv->GetType( Tuns64 ) );
             NextToken();
             break;
 
         case TOKfloat32v:
-            e = new RealExpr( token->Float80Value, mTypeEnv->GetType( Tfloat32 ) );
+            e = new ( mArena ) RealExpr( token->Float80Value, mTypeEnv->GetType( Tfloat32 ) );
             NextToken();
             break;
 
         case TOKfloat64v:
-            e = new RealExpr( token->Float80Value, mTypeEnv->GetType( Tfloat64 ) );
+            e = new ( mArena ) RealExpr( token->Float80Value, mTypeEnv->GetType( Tfloat64 ) );
             NextToken();
             break;
 
         case TOKfloat80v:
-            e = new RealExpr( token->Float80Value, mTypeEnv->GetType( Tfloat80 ) );
+            e = new ( mArena ) RealExpr( token->Float80Value, mTypeEnv->GetType( Tfloat80 ) );
             NextToken();
             break;
 
         case TOKimaginary32v:
-            e = new RealExpr( token->Float80Value, mTypeEnv->GetType( Timaginary32 ) );
+            e = new ( mArena ) RealExpr( token->Float80Value, mTypeEnv->GetType( Timaginary32 ) );
             NextToken();
             break;
 
         case TOKimaginary64v:
-            e = new RealExpr( token->Float80Value, mTypeEnv->GetType( Timaginary64 ) );
+            e = new ( mArena ) RealExpr( token->Float80Value, mTypeEnv->GetType( Timaginary64 ) );
             NextToken();
             break;
 
         case TOKimaginary80v:
-            e = new RealExpr( token->Float80Value, mTypeEnv->GetType( Timaginary80 ) );
+            e = new ( mArena ) RealExpr( token->Float80Value, mTypeEnv->GetType( Timaginary80 ) );
             NextToken();
             break;
 
         case TOKcharv:
-            e = new IntExpr( token->UInt64Value, mTypeEnv->GetType( Tchar ) );
+            e = new ( mArena ) IntExpr( token->UInt64Value, mTypeEnv->GetType( Tchar ) );
             NextToken();
             break;
 
         case TOKwcharv:
-            e = new IntExpr( token->UInt64Value, mTypeEnv->GetType( Twchar ) );
+            e = new ( mArena ) IntExpr( token->UInt64Value, mTypeEnv->GetType( Twchar ) );
             NextToken();
             break;
 
         case TOKdcharv:
-            e = new IntExpr( token->UInt64Value, mTypeEnv->GetType( Tdchar ) );
+            e = new ( mArena ) IntExpr( token->UInt64Value, mTypeEnv->GetType( Tdchar ) );
             NextToken();
             break;
 
@@ -835,35 +823,35 @@ Done:
         case TOKwstring:
         case TOKdstring:
             // TODO: combine strings next to each other
-            e = new StringExpr( token->Utf16Str, token->Code != TOKstring );
+            e = new ( mArena ) StringExpr( token->Utf16Str, token->Code != TOKstring );
             NextToken();
             break;
 
         case TOKtrue:
-            e = new IntExpr( 1, mTypeEnv->GetType( Tbool ) );
+            e = new ( mArena ) IntExpr( 1, mTypeEnv->GetType( Tbool ) );
             NextToken();
             break;
 
         case TOKfalse:
-            e = new IntExpr( 0, mTypeEnv->GetType( Tbool ) );
+            e = new ( mArena ) IntExpr( 0, mTypeEnv->GetType( Tbool ) );
             NextToken();
             break;
 
         case TOKnull:
-            e = new NullExpr();
+            e = new ( mArena ) NullExpr();
             NextToken();
             break;
 
         case TOKdollar:
             if ( mBracketCount == 0 )
                 throw 16;
-            e = new DollarExpr();
+            e = new ( mArena ) DollarExpr();
             NextToken();
             break;
 
         case TOKdot:
 #if defined( KEEP_GLOBAL_SCOPE_EXPRESSION )
-            e = new IdExpr( NULL );
+            e = new ( mArena ) IdExpr( NULL );
             // don't eat the dot, because we want PostExpr to handle it
 #else
             NextToken();
@@ -874,12 +862,12 @@ Done:
             break;
 
         case TOKthis:
-            e = new ThisExpr();
+            e = new ( mArena ) ThisExpr();
             NextToken();
             break;
 
         case TOKsuper:
-            e = new SuperExpr();
+            e = new ( mArena ) SuperExpr();
             NextToken();
             break;
 
@@ -892,7 +880,7 @@ Lidentifier:
                 NextToken();
                 if ( (GetTokenCode() == TOKnot) && (PeekTokenCode( 1 ) != TOKis) )
                 {
-                    RefPtr<TemplateInstancePart>    instance = new TemplateInstancePart( id );
+                    RefPtr<TemplateInstancePart>    instance = new ( mArena ) TemplateInstancePart( id );
                     const wchar_t*  startPtr = mScanner->GetToken().TextStartPtr;
                     NextToken();
 
@@ -905,11 +893,11 @@ Lidentifier:
                     const wchar_t*  endPtr = mScanner->GetToken().TextStartPtr;
                     instance->ArgumentString = mScanner->GetNameTable()->AddString( startPtr, (endPtr - startPtr) );
 
-                    e = new ScopeExpr( instance.Get() );
+                    e = new ( mArena ) ScopeExpr( instance.Get() );
                 }
                 else
                 {
-                    e = new IdExpr( id );
+                    e = new ( mArena ) IdExpr( id );
                 }
             }
             break;
@@ -924,7 +912,7 @@ Lidentifier:
         case TOKtypeof:
             {
                 RefPtr<TypeQualified>   t = ParseTypeof();
-                e = new TypeExpr( t.Get() );
+                e = new ( mArena ) TypeExpr( t.Get() );
             }
             break;
 
@@ -934,7 +922,7 @@ Lidentifier:
                 ReadToken( TOKlparen );
                 RefPtr<Type>    t = ParseType();
                 ReadToken( TOKrparen );
-                e = new TypeExpr( t );
+                e = new ( mArena ) TypeExpr( t );
             }
             break;
 
@@ -952,7 +940,7 @@ Lidentifier:
                     obj = ParseAssignExpr().Get();
                 }
                 ReadToken( TOKrparen );
-                e = new TypeidExpr( obj.Get() );
+                e = new ( mArena ) TypeidExpr( obj.Get() );
             }
             break;
 
@@ -967,7 +955,7 @@ Lidentifier:
         case TOKlbracket:
             {
                 RefPtr<ExpressionList>  keys;
-                RefPtr<ExpressionList>  values = new ExpressionList();
+                RefPtr<ExpressionList>  values = new ( mArena ) ExpressionList();
 
                 NextToken();
 
@@ -979,7 +967,7 @@ Lidentifier:
                     {
                         NextToken();
                         if ( keys.Get() == NULL )
-                            keys = new ExpressionList();
+                            keys = new ( mArena ) ExpressionList();
                         keys->List.push_back( expr );
                         expr = ParseAssignExpr();
                     }
@@ -999,9 +987,9 @@ Lidentifier:
                 ReadToken( TOKrbracket );
 
                 if ( keys.Get() != NULL )
-                    e = new AssocArrayLiteralExpr( keys.Get(), values.Get() );
+                    e = new ( mArena ) AssocArrayLiteralExpr( keys.Get(), values.Get() );
                 else
-                    e = new ArrayLiteralExpr( values.Get() );
+                    e = new ( mArena ) ArrayLiteralExpr( values.Get() );
             }
             break;
 
@@ -1034,8 +1022,8 @@ Lidentifier:
                 Match( TOKdot );
                 if ( GetTokenCode() != TOKidentifier )
                     throw 26;
-                RefPtr<TypeExpr>    typeExpr = new TypeExpr( type.Get() );
-                RefPtr<DotExpr>     dotExpr = new DotExpr( typeExpr.Get(), GetToken().Utf16Str );
+                RefPtr<TypeExpr>    typeExpr = new ( mArena ) TypeExpr( type.Get() );
+                RefPtr<DotExpr>     dotExpr = new ( mArena ) DotExpr( typeExpr.Get(), GetToken().Utf16Str );
                 e = dotExpr.Get();
                 NextToken();
             }
@@ -1066,12 +1054,12 @@ Lidentifier:
 
         if ( GetTokenCode() == TOKreturn )
         {
-            t = new TypeReturn();
+            t = new ( mArena ) TypeReturn();
         }
         else
         {
             RefPtr<Expression>  e = ParseExpression();
-            t = new TypeTypeof( e.Get() );
+            t = new ( mArena ) TypeTypeof( e.Get() );
         }
 
         ReadToken( TOKrparen );
@@ -22,6 +22,7 @@ namespace MagoEE
     class ObjectList;
     struct Utf16String;
     class ParameterList;
+    class ObjectArena;
 
 
     class Parser
@@ -35,11 +36,13 @@ namespace MagoEE
 
         Scanner*        mScanner;
         ITypeEnv*       mTypeEnv;
+        ObjectArena*    mArena;
         uint32_t        mDVer;
         int             mBracketCount;
 
     public:
-        Parser( Scanner* scanner, ITypeEnv* typeEnv );
+        // The nodes of the tree are allocated in arena, if it isn't NULL.
+        Parser( Scanner* scanner, ITypeEnv* typeEnv, ObjectArena* arena );
 
         RefPtr<Expression> ParseExpression();
         RefPtr<Expression> ParseCommaExpr();
@@ -560,7 +560,7 @@ Done:
             break;
 
         case TOKdot:
-            tid = new TypeIdentifier( mScanner->GetNameTable()->GetEmpty() );
+            tid = new ( mArena ) TypeIdentifier( mScanner->GetNameTable()->GetEmpty() );
             tid = ParseTypeName( tid.Get() );
             type.Attach( tid.Detach() );
             break;
@@ -630,8 +630,14 @@ Done:
             switch ( GetTokenCode() )
             {
             case TOKmul:
-                type2 = new TypePointer( type2.Get(), ptrSize );
-                NextToken();
+                {
+                    RefPtr<Type>    newType;
+                    HRESULT hr = mTypeEnv->NewPointer( type2, newType.Ref() );
+                    if ( FAILED( hr ) )
+                        throw 90;
+                    NextToken();
+                    type2 = newType;
+                }
                 break;
 
             case TOKlbracket:
@@ -663,11 +669,11 @@ Done:
                     {
                         NextToken();
                         RefPtr<Expression>  e2 = ParseAssignExpr();
-                        type2 = new TypeSlice( type2.Get(), e.Get(), e2.Get() );
+                        type2 = new ( mArena ) TypeSlice( type2.Get(), e.Get(), e2.Get() );
                     }
                     else
                     {
-                        type2 = new TypeSArrayUnresolved( type2.Get(), e.Get() );
+                        type2 = new ( mArena ) TypeSArrayUnresolved( type2.Get(), e.Get() );
                     }
                     mBracketCount--;
                     Match( TOKrbracket );
@@ -727,18 +733,18 @@ Done:
                         NextToken();
                     }
 
-                    RefPtr<TypeFunction>    funcType = new TypeFunction( params.Get(), type2.Get(), varArgs );
+                    RefPtr<TypeFunction>    funcType = new ( mArena ) TypeFunction( params.Get(), type2.Get(), varArgs );
                     funcType->SetPure( ispure );
                     funcType->SetNoThrow( isnothrow );
                     funcType->SetProperty( isproperty );
                     funcType->SetTrust( trust );
                     if ( tokCode == TOKdelegate )
                     {
-                        RefPtr<TypePointer> ptrType = new TypePointer( funcType, ptrSize );
-                        type2 = new TypeDelegate( ptrType );
+                        RefPtr<TypePointer> ptrType = new ( mArena ) TypePointer( funcType, ptrSize );
+                        type2 = new ( mArena ) TypeDelegate( ptrType );
                     }
                     else
-                        type2 = new TypePointer( funcType.Get(), ptrSize );  // pointer to function
+                        type2 = new ( mArena ) TypePointer( funcType.Get(), ptrSize );  // pointer to function
                 }
                 break;
 
@@ -781,13 +787,13 @@ Done:
             if ( GetTokenCode() != TOKnot )
             {
                 if ( qualified == NULL )
-                    qualified = new TypeIdentifier( id );
+                    qualified = new ( mArena ) TypeIdentifier( id );
                 else
-                    qualified->Parts.push_back( new IdPart( id ) );
+                    qualified->Parts.push_back( new ( mArena ) IdPart( id ) );
             }
             else
             {
-                RefPtr<TemplateInstancePart>    instance = new TemplateInstancePart( id );
+                RefPtr<TemplateInstancePart>    instance = new ( mArena ) TemplateInstancePart( id );
                 const wchar_t*  startPtr = mScanner->GetToken().TextStartPtr;
                 NextToken();
 
@@ -801,7 +807,7 @@ Done:
                 instance->ArgumentString = mScanner->GetNameTable()->AddString( startPtr, (endPtr - startPtr) );
 
                 if ( qualified == NULL )
-                    qualified = new TypeInstance( instance.Get() );
+                    qualified = new ( mArena ) TypeInstance( instance.Get() );
                 else
                     qualified->Parts.push_back( instance.Get() );
             }
@@ -817,13 +823,13 @@ Done:
 
     RefPtr<ObjectList>      Parser::ParseTemplateArg()
     {
-        RefPtr<ObjectList>  tiArgs = new ObjectList();
+        RefPtr<ObjectList>  tiArgs = new ( mArena ) ObjectList();
         RefPtr<Type>        type;
 
         switch ( GetTokenCode() )
         {
         case TOKidentifier:
-            type = new TypeIdentifier( GetToken().Utf16Str );
+            type = new ( mArena ) TypeIdentifier( GetToken().Utf16Str );
             tiArgs->List.push_back( type.Get() );
             NextToken();
             break;
@@ -871,7 +877,7 @@ Done:
 
     RefPtr<ObjectList>      Parser::ParseTemplateArgList()
     {
-        RefPtr<ObjectList>  tiArgs = new ObjectList();
+        RefPtr<ObjectList>  tiArgs = new ( mArena ) ObjectList();
         RefPtr<Type>        type;
 
         if ( GetTokenCode() != TOKlparen )
@@ -935,7 +941,7 @@ Done:
 
     RefPtr<ParameterList>   Parser::ParseParams( int& varArgs )
     {
-        RefPtr<ParameterList>   params = new ParameterList();
+        RefPtr<ParameterList>   params = new ( mArena ) ParameterList();
 
         varArgs = 0;    // TODO: why not bool?
         Match( TOKlparen );
@@ -1023,12 +1029,12 @@ LDefault:
                             //error("variadic argument cannot be out or ref");
                             throw 24;
                         varArgs = 2;
-                        param = new Parameter( storageClass, type.Get() );
+                        param = new ( mArena ) Parameter( storageClass, type.Get() );
                         params->List.push_back( param );
                         NextToken();
                         goto Done;
                     }
-                    param = new Parameter( storageClass, type.Get() );
+                    param = new ( mArena ) Parameter( storageClass, type.Get() );
                     params->List.push_back( param );
                     if ( GetTokenCode() == TOKcomma )
                     {
@@ -48,6 +48,20 @@ namespace MagoEE
         return false;
     }
 
+    bool PropertyBase::UsesParentAddress()
+    {
+        return false;
+    }
+
+    bool PropertyBase::GetValue( Type* parentType, Address parentAddr, DataValue& result )
+    {
+        UNREFERENCED_PARAMETER( parentAddr );
+        UNREFERENCED_PARAMETER( parentType );
+        UNREFERENCED_PARAMETER( result );
+        _ASSERT( false );
+        return false;
+    }
+
 
     //------------------------------------------------------------------------
     //  Size for all
@@ -745,6 +759,20 @@ namespace MagoEE
         return parentDecl->GetAddress( result.Addr );
     }
 
+    bool PropertySArrayPtr::UsesParentAddress()
+    {
+        return true;
+    }
+
+    bool PropertySArrayPtr::GetValue( Type* parentType, Address parentAddr, DataValue& result )
+    {
+        if ( (parentType == NULL) || !parentType->IsSArray() )
+            return false;
+
+        result.Addr = parentAddr;
+        return true;
+    }
+
 
     //------------------------------------------------------------------------
     //  DArray
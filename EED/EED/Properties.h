@@ -26,6 +26,10 @@ namespace MagoEE
         virtual bool GetValue( Type* parentType, Declaration* parentDecl, DataValue& result );
 
         virtual bool GetValue( Type* parentType, Declaration* parentDecl, const DataValue& parentVal , DataValue& result );
+
+        virtual bool UsesParentAddress();
+
+        virtual bool GetValue( Type* parentType, Address parentAddr, DataValue& result );
     };
 
 
@@ -193,6 +197,8 @@ namespace MagoEE
     public:
         virtual bool GetType( ITypeEnv* typeEnv, Type* parentType, Declaration* parentDecl, Type*& type );
         virtual bool GetValue( Type* parentType, Declaration* parentDecl, DataValue& result );
+        virtual bool UsesParentAddress();
+        virtual bool GetValue( Type* parentType, Address parentAddr, DataValue& result );
     };
 
 
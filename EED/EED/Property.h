@@ -23,5 +23,7 @@ namespace MagoEE
         virtual bool UsesParentValue() = 0;
         virtual bool GetValue( Type* parentType, Declaration* parentDecl, DataValue& result ) = 0;
         virtual bool GetValue( Type* parentType, Declaration* parentDecl, const DataValue& parentVal , DataValue& result ) = 0;
+        virtual bool UsesParentAddress() = 0;
+        virtual bool GetValue( Type* parentType, Address parentAddr, DataValue& result ) = 0;
     };
 }
@@ -0,0 +1,487 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#include "Common.h"
+#include "EED.h"
+#include "ReadPlan.h"
+#include "Type.h"
+
+#include <algorithm>
+
+
+namespace MagoEE
+{
+    //------------------------------------------------------------------------
+    //  ReadPlan
+    //------------------------------------------------------------------------
+
+    ReadPlan::ReadPlan( uint32_t maxGap, uint32_t maxSize )
+        :   mMaxGap( maxGap ),
+            mMaxSize( maxSize )
+    {
+    }
+
+    void ReadPlan::Plan( const MemoryRead* reads, uint32_t count )
+    {
+        mRanges.clear();
+        mOrder.clear();
+
+        for ( uint32_t i = 0; i < count; i++ )
+        {
+            // nothing to read for these
+            if ( reads[i].Size > 0 )
+                mOrder.push_back( std::make_pair( reads[i].Addr, i ) );
+        }
+
+        std::sort( mOrder.begin(), mOrder.end() );
+
+        for ( uint32_t i = 0; i < mOrder.size(); i++ )
+        {
+            const MemoryRead&   read = reads[mOrder[i].second];
+
+            if ( !mRanges.empty() )
+            {
+                Range&      range = mRanges.back();
+                uint64_t    rangeEnd = range.Addr + range.Size;
+                uint64_t    readEnd = read.Addr + read.Size;
+                uint64_t    newEnd = std::max( rangeEnd, readEnd );
+
+                if ( (read.Addr <= rangeEnd + mMaxGap)
+                    && (newEnd - range.Addr <= mMaxSize) )
+                {
+                    range.Size = (uint32_t) (newEnd - range.Addr);
+                    range.Count++;
+                    continue;
+                }
+            }
+
+            Range   range = { read.Addr, read.Size, i, 1 };
+            mRanges.push_back( range );
+        }
+    }
+
+    uint32_t ReadPlan::GetRangeCount() const
+    {
+        return (uint32_t) mRanges.size();
+    }
+
+    const ReadPlan::Range& ReadPlan::GetRange( uint32_t index ) const
+    {
+        _ASSERT( index < mRanges.size() );
+        return mRanges[index];
+    }
+
+    uint32_t ReadPlan::GetReadIndex( uint32_t position ) const
+    {
+        _ASSERT( position < mOrder.size() );
+        return mOrder[position].second;
+    }
+
+    void ReadPlan::Scatter( uint32_t rangeIndex, const uint8_t* buffer, uint32_t sizeRead, MemoryRead* reads ) const
+    {
+        const Range&    range = GetRange( rangeIndex );
+
+        for ( uint32_t i = range.First; i < range.First + range.Count; i++ )
+        {
+            MemoryRead& read = reads[mOrder[i].second];
+            uint32_t    offset = (uint32_t) (read.Addr - range.Addr);
+            uint32_t    size = 0;
+
+            if ( sizeRead > offset )
+                size = std::min( read.Size, sizeRead - offset );
+
+            memcpy( read.Buffer, buffer + offset, size );
+            read.SizeRead = size;
+        }
+    }
+
+    HRESULT ReadPlan::Read( IMemoryReader* reader, MemoryRead* reads, uint32_t count )
+    {
+        _ASSERT( reader != NULL );
+        if ( (reads == NULL) && (count > 0) )
+            return E_INVALIDARG;
+
+        for ( uint32_t i = 0; i < count; i++ )
+            reads[i].SizeRead = 0;
+
+        Plan( reads, count );
+
+        for ( uint32_t i = 0; i < mRanges.size(); i++ )
+        {
+            HRESULT         hr = S_OK;
+            const Range&    range = mRanges[i];
+            uint32_t        sizeRead = 0;
+
+            if ( range.Count == 1 )
+            {
+                MemoryRead& read = reads[mOrder[range.First].second];
+
+                hr = reader->ReadMemory( read.Addr, read.Size, read.SizeRead, read.Buffer );
+                if ( FAILED( hr ) )
+                    read.SizeRead = 0;
+                continue;
+            }
+
+            if ( mBuffer.size() < range.Size )
+                mBuffer.resize( range.Size );
+
+            hr = reader->ReadMemory( range.Addr, range.Size, sizeRead, &mBuffer[0] );
+            if ( FAILED( hr ) )
+                sizeRead = 0;
+
+            Scatter( i, &mBuffer[0], sizeRead, reads );
+
+            if ( sizeRead >= range.Size )
+                continue;
+
+            for ( uint32_t j = range.First; j < range.First + range.Count; j++ )
+            {
+                MemoryRead& read = reads[mOrder[j].second];
+
+                if ( read.SizeRead == read.Size )
+                    continue;
+
+                hr = reader->ReadMemory( read.Addr, read.Size, read.SizeRead, read.Buffer );
+                if ( FAILED( hr ) )
+                    read.SizeRead = 0;
+            }
+        }
+
+        return S_OK;
+    }
+
+    HRESULT ReadPlan::Read( IValueBinder* binder, MemoryRead* reads, uint32_t count )
+    {
+        _ASSERT( binder != NULL );
+
+        BinderMemoryReader  reader( binder );
+
+        return Read( &reader, reads, count );
+    }
+
+
+    //------------------------------------------------------------------------
+    //  BinderMemoryReader
+    //------------------------------------------------------------------------
+
+    BinderMemoryReader::BinderMemoryReader( IValueBinder* binder )
+        :   mBinder( binder )
+    {
+    }
+
+    HRESULT BinderMemoryReader::ReadMemory( Address addr, uint32_t sizeToRead, uint32_t& sizeRead, uint8_t* buffer )
+    {
+        return mBinder->ReadMemory( addr, sizeToRead, sizeRead, buffer );
+    }
+
+
+    //------------------------------------------------------------------------
+    //  Layouts
+    //------------------------------------------------------------------------
+
+    bool HasRawValue( Type* type )
+    {
+        _ASSERT( type != NULL );
+
+        return type->IsScalar()
+            || type->IsDArray()
+            || type->IsAArray()
+            || type->IsDelegate();
+    }
+
+    void AddStructReads( Type* type, Address addr, std::vector<MemoryRead>& reads )
+    {
+        _ASSERT( type->AsTypeStruct() != NULL );
+
+        RefPtr<Declaration>             decl = type->GetDeclaration();
+        RefPtr<IEnumDeclarationMembers> members;
+        uint32_t                        size = type->GetSize();
+
+        // a struct that isn't too big is read whole, because that's what
+        // the pieces for its members would be merged into anyway
+        if ( (type->AsTypeStruct()->GetUdtKind() != Udt_Class) 
+            && (size > 0) && (size <= ReadPlan::DefaultMaxSize) )
+        {
+            MemoryRead  read = { addr, size, NULL, 0 };
+            reads.push_back( read );
+            return;
+        }
+
+        if ( (decl == NULL) || !decl->EnumMembers( members.Ref() ) )
+            return;
+
+        for ( ; ; )
+        {
+            RefPtr<Declaration> member;
+            RefPtr<Type>        memberType;
+            int                 offset = 0;
+
+            if ( !members->Next( member.Ref() ) )
+                break;
+            if ( member->IsBaseClass() || member->IsStaticField() )
+                continue;
+            if ( !member->GetType( memberType.Ref() ) || !member->GetOffset( offset ) )
+                continue;
+
+            Address     memberAddr = addr + offset;
+
+            if ( memberType->AsTypeStruct() != NULL )
+            {
+                AddStructReads( memberType, memberAddr, reads );
+            }
+            else if ( HasRawValue( memberType )
+                || (memberType->IsSArray() && memberType->AsTypeSArray()->GetElement()->IsChar()) )
+            {
+                MemoryRead  read = { memberAddr, memberType->GetSize(), NULL, 0 };
+                reads.push_back( read );
+            }
+        }
+    }
+
+    void AddArrayReads( Type* elemType, Address addr, uint32_t count, std::vector<MemoryRead>& reads )
+    {
+        _ASSERT( elemType != NULL );
+
+        uint64_t    size = (uint64_t) elemType->GetSize() * count;
+
+        if ( (size == 0) || (size > ReadPlan::DefaultMaxSize) )
+            return;
+
+        MemoryRead  read = { addr, (uint32_t) size, NULL, 0 };
+        reads.push_back( read );
+    }
+
+
+    //------------------------------------------------------------------------
+    //  PrefetchBinder
+    //------------------------------------------------------------------------
+
+    PrefetchBinder::PrefetchBinder( IValueBinder* binder )
+        :   mBinder( binder )
+    {
+        _ASSERT( binder != NULL );
+    }
+
+    HRESULT PrefetchBinder::Prefetch( const MemoryRead* reads, uint32_t count )
+    {
+        HRESULT                 hr = S_OK;
+        ReadPlan                plan;
+        std::vector<MemoryRead> missing;
+
+        for ( uint32_t i = 0; i < count; i++ )
+        {
+            if ( !Contains( reads[i].Addr, reads[i].Size ) )
+                missing.push_back( reads[i] );
+        }
+
+        if ( missing.empty() )
+            return S_OK;
+
+        plan.Plan( &missing[0], (uint32_t) missing.size() );
+        if ( plan.GetRangeCount() == 0 )
+            return S_OK;
+
+        // one block for each range, read all at once into the end of mBytes
+        std::vector<MemoryRead> ranges( plan.GetRangeCount() );
+        size_t                  firstBlock = mBlocks.size();
+        size_t                  totalSize = mBytes.size();
+
+        for ( uint32_t i = 0; i < ranges.size(); i++ )
+        {
+            const ReadPlan::Range&  range = plan.GetRange( i );
+            Block                   block = { range.Addr, range.Size, (uint32_t) totalSize };
+
+            mBlocks.push_back( block );
+            totalSize += range.Size;
+        }
+
+        mBytes.resize( totalSize );
+
+        for ( uint32_t i = 0; i < ranges.size(); i++ )
+        {
+            Block&  block = mBlocks[firstBlock + i];
+
+            ranges[i].Addr = block.Addr;
+            ranges[i].Size = block.Size;
+            ranges[i].Buffer = &mBytes[block.Offset];
+            ranges[i].SizeRead = 0;
+        }
+
+        hr = mBinder->ReadMemory( &ranges[0], (uint32_t) ranges.size() );
+        if ( FAILED( hr ) )
+        {
+            mBlocks.resize( firstBlock );
+            return hr;
+        }
+
+        // only what was read is good
+        for ( uint32_t i = 0; i < ranges.size(); i++ )
+        {
+            mBlocks[firstBlock + i].Size = ranges[i].SizeRead;
+        }
+
+        return S_OK;
+    }
+
+    bool PrefetchBinder::Contains( Address addr, uint32_t size )
+    {
+        return Find( addr, size ) != NULL;
+    }
+
+    void PrefetchBinder::Clear()
+    {
+        mBlocks.clear();
+        mBytes.clear();
+    }
+
+    const uint8_t* PrefetchBinder::Find( Address addr, uint32_t size )
+    {
+        for ( size_t i = 0; i < mBlocks.size(); i++ )
+        {
+            const Block&    block = mBlocks[i];
+
+            if ( (addr >= block.Addr)
+                && (addr - block.Addr <= block.Size)
+                && (size <= block.Size - (addr - block.Addr)) )
+                return &mBytes[block.Offset] + (addr - block.Addr);
+        }
+
+        return NULL;
+    }
+
+    HRESULT PrefetchBinder::FindObject( const wchar_t* name, Declaration*& decl )
+    {
+        return mBinder->FindObject( name, decl );
+    }
+
+    HRESULT PrefetchBinder::GetThis( Declaration*& decl )
+    {
+        return mBinder->GetThis( decl );
+    }
+
+    HRESULT PrefetchBinder::GetSuper( Declaration*& decl )
+    {
+        return mBinder->GetSuper( decl );
+    }
+
+    HRESULT PrefetchBinder::GetReturnType( Type*& type )
+    {
+        return mBinder->GetReturnType( type );
+    }
+
+    HRESULT PrefetchBinder::GetAddress( Declaration* decl, Address& addr )
+    {
+        return mBinder->GetAddress( decl, addr );
+    }
+
+    HRESULT PrefetchBinder::GetValue( Declaration* decl, DataValue& value )
+    {
+        RefPtr<Type>    type;
+        Address         addr = 0;
+
+        // a variable in memory that was read with the rest
+        if ( !mBlocks.empty()
+            && decl->IsVar()
+            && decl->GetType( type.Ref() )
+            && HasRawValue( type )
+            && SUCCEEDED( mBinder->GetAddress( decl, addr ) ) )
+        {
+            const uint8_t*  bytes = Find( addr, type->GetSize() );
+
+            if ( bytes != NULL )
+                return mBinder->FromRawValue( bytes, type, value );
+        }
+
+        return mBinder->GetValue( decl, value );
+    }
+
+    HRESULT PrefetchBinder::GetValue( Address addr, Type* type, DataValue& value )
+    {
+        if ( HasRawValue( type ) )
+        {
+            const uint8_t*  bytes = Find( addr, type->GetSize() );
+
+            if ( bytes != NULL )
+                return mBinder->FromRawValue( bytes, type, value );
+        }
+
+        return mBinder->GetValue( addr, type, value );
+    }
+
+    HRESULT PrefetchBinder::GetValue( Address aArrayAddr, const DataObject& key, Address& valueAddr )
+    {
+        return mBinder->GetValue( aArrayAddr, key, valueAddr );
+    }
+
+    int PrefetchBinder::GetAAVersion()
+    {
+        return mBinder->GetAAVersion();
+    }
+
+    HRESULT PrefetchBinder::SetValue( Declaration* decl, const DataValue& value )
+    {
+        Clear();
+        return mBinder->SetValue( decl, value );
+    }
+
+    HRESULT PrefetchBinder::SetValue( Address addr, Type* type, const DataValue& value )
+    {
+        Clear();
+        return mBinder->SetValue( addr, type, value );
+    }
+
+    HRESULT PrefetchBinder::ReadMemory( Address addr, uint32_t sizeToRead, uint32_t& sizeRead, uint8_t* buffer )
+    {
+        const uint8_t*  bytes = Find( addr, sizeToRead );
+
+        if ( bytes == NULL )
+            return mBinder->ReadMemory( addr, sizeToRead, sizeRead, buffer );
+
+        memcpy( buffer, bytes, sizeToRead );
+        sizeRead = sizeToRead;
+        return S_OK;
+    }
+
+    HRESULT PrefetchBinder::ReadMemory( MemoryRead* reads, uint32_t count )
+    {
+        std::vector<MemoryRead> missing;
+        std::vector<uint32_t>   missingIndexes;
+
+        for ( uint32_t i = 0; i < count; i++ )
+        {
+            const uint8_t*  bytes = Find( reads[i].Addr, reads[i].Size );
+
+            if ( bytes != NULL )
+            {
+                memcpy( reads[i].Buffer, bytes, reads[i].Size );
+                reads[i].SizeRead = reads[i].Size;
+            }
+            else
+            {
+                missing.push_back( reads[i] );
+                missingIndexes.push_back( i );
+            }
+        }
+
+        if ( missing.empty() )
+            return S_OK;
+
+        HRESULT hr = mBinder->ReadMemory( &missing[0], (uint32_t) missing.size() );
+        if ( FAILED( hr ) )
+            return hr;
+
+        for ( uint32_t i = 0; i < missing.size(); i++ )
+            reads[missingIndexes[i]].SizeRead = missing[i].SizeRead;
+
+        return S_OK;
+    }
+
+    HRESULT PrefetchBinder::FromRawValue( const uint8_t* buffer, Type* type, DataValue& value )
+    {
+        return mBinder->FromRawValue( buffer, type, value );
+    }
+}
@@ -0,0 +1,152 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+
+namespace MagoEE
+{
+    // Reads one block of the target for a ReadPlan. sizeRead is how much of
+    // the block was read from its start; a short read isn't a failure.
+
+    class IMemoryReader
+    {
+    public:
+        virtual HRESULT ReadMemory( Address addr, uint32_t sizeToRead, uint32_t& sizeRead, uint8_t* buffer ) = 0;
+    };
+
+    // Reads blocks with a binder's ReadMemory.
+
+    class BinderMemoryReader : public IMemoryReader
+    {
+        IValueBinder*   mBinder;
+
+    public:
+        BinderMemoryReader( IValueBinder* binder );
+
+        virtual HRESULT ReadMemory( Address addr, uint32_t sizeToRead, uint32_t& sizeRead, uint8_t* buffer );
+    };
+
+
+    // Works out the fewest reads of the target that cover a list of pieces
+    // of memory. Pieces that are close together are read as one range, so
+    // that the members of a struct or a run of array elements take one or
+    // two reads instead of one each.
+
+    class ReadPlan
+    {
+    public:
+        struct Range
+        {
+            Address     Addr;
+            uint32_t    Size;
+            uint32_t    First;      // position of its first piece in address order
+            uint32_t    Count;
+        };
+
+        // a gap bigger than this costs more to read than another read does
+        static const uint32_t   DefaultMaxGap = 256;
+        // ranges aren't merged past this size
+        static const uint32_t   DefaultMaxSize = 64 * 1024;
+
+    private:
+        uint32_t                mMaxGap;
+        uint32_t                mMaxSize;
+        std::vector<Range>      mRanges;
+        // the pieces' addresses and indexes, in address order
+        std::vector< std::pair<Address, uint32_t> > mOrder;
+        std::vector<uint8_t>    mBuffer;    // for ranges of more than one piece
+
+    public:
+        ReadPlan( uint32_t maxGap = DefaultMaxGap, uint32_t maxSize = DefaultMaxSize );
+
+        void Plan( const MemoryRead* reads, uint32_t count );
+
+        uint32_t GetRangeCount() const;
+        const Range& GetRange( uint32_t index ) const;
+        // the index of the piece at a position in address order
+        uint32_t GetReadIndex( uint32_t position ) const;
+
+        // Copies what was read of a range out to its pieces, and sets how
+        // much of each one was read.
+        void Scatter( uint32_t rangeIndex, const uint8_t* buffer, uint32_t sizeRead, MemoryRead* reads ) const;
+
+        // Plans the pieces and reads each range with the reader. If a range
+        // comes back short, the pieces it didn't cover are read on their own,
+        // so that a hole in the middle of a range doesn't take the readable
+        // pieces past it with it.
+        HRESULT Read( IMemoryReader* reader, MemoryRead* reads, uint32_t count );
+        // The same, reading with the binder's ReadMemory for one block.
+        HRESULT Read( IValueBinder* binder, MemoryRead* reads, uint32_t count );
+    };
+
+
+    // Whether a binder has a value to get for an object of this type,
+    // rather than only an address.
+    bool HasRawValue( Type* type );
+
+    // Adds a piece for the struct at addr. A class, or a struct too big to
+    // read at once, gets a piece for each member that has a value and for
+    // the members of the structs in it. A static array of chars is added
+    // whole, because it's shown as a string.
+    void AddStructReads( Type* type, Address addr, std::vector<MemoryRead>& reads );
+
+    // Adds a piece for count elements of an array starting at addr.
+    void AddArrayReads( Type* elemType, Address addr, uint32_t count, std::vector<MemoryRead>& reads );
+
+
+    // A binder that answers reads of the memory it has prefetched, and
+    // passes everything else on to the binder it wraps. It's meant to live
+    // only as long as one formatting or enumeration of children, so it's
+    // never out of date; even so, assigning through it drops what it has.
+
+    class PrefetchBinder : public IValueBinder
+    {
+        struct Block
+        {
+            Address     Addr;
+            uint32_t    Size;
+            uint32_t    Offset;     // in mBytes
+        };
+
+        IValueBinder*           mBinder;
+        std::vector<Block>      mBlocks;
+        std::vector<uint8_t>    mBytes;
+
+    public:
+        PrefetchBinder( IValueBinder* binder );
+
+        // Reads what the pieces cover that isn't already here. Only their
+        // addresses and sizes are used.
+        HRESULT Prefetch( const MemoryRead* reads, uint32_t count );
+        bool Contains( Address addr, uint32_t size );
+        void Clear();
+
+        virtual HRESULT FindObject( const wchar_t* name, Declaration*& decl );
+
+        virtual HRESULT GetThis( Declaration*& decl );
+        virtual HRESULT GetSuper( Declaration*& decl );
+        virtual HRESULT GetReturnType( Type*& type );
+
+        virtual HRESULT GetAddress( Declaration* decl, Address& addr );
+
+        virtual HRESULT GetValue( Declaration* decl, DataValue& value );
+        virtual HRESULT GetValue( Address addr, Type* type, DataValue& value );
+        virtual HRESULT GetValue( Address aArrayAddr, const DataObject& key, Address& valueAddr );
+        virtual int GetAAVersion();
+
+        virtual HRESULT SetValue( Declaration* decl, const DataValue& value );
+        virtual HRESULT SetValue( Address addr, Type* type, const DataValue& value );
+
+        virtual HRESULT ReadMemory( Address addr, uint32_t sizeToRead, uint32_t& sizeRead, uint8_t* buffer );
+        virtual HRESULT ReadMemory( MemoryRead* reads, uint32_t count );
+        virtual HRESULT FromRawValue( const uint8_t* buffer, Type* type, DataValue& value );
+
+    private:
+        const uint8_t* Find( Address addr, uint32_t size );
+    };
+}
@@ -444,6 +444,10 @@ namespace MagoEE
 
     bool TypeBasic::Equals( Type* other )
     {
+        // the type environment makes each of these once
+        if ( other == this )
+            return true;
+
         if ( other->IsBasic() )
             return other->Ty == Ty;
 
@@ -605,6 +609,9 @@ namespace MagoEE
 
     bool TypePointer::Equals( Type* other )
     {
+        if ( other == this )
+            return true;
+
         if ( other->Ty != Tpointer )
             return false;
 
@@ -623,6 +630,10 @@ namespace MagoEE
         if ( resolvedNext == NULL )
             return NULL;
 
+        // nothing to resolve, and types don't change once they're made
+        if ( resolvedNext == Next )
+            return this;
+
         RefPtr<Type>    type = new TypePointer( resolvedNext, mPtrSize );
         type->Mod = Mod;
         return type;
@@ -673,6 +684,9 @@ namespace MagoEE
 
     bool TypeReference::Equals( Type* other )
     {
+        if ( other == this )
+            return true;
+
         if ( other->Ty != Treference )
             return false;
 
@@ -690,6 +704,10 @@ namespace MagoEE
         if ( resolvedNext == NULL )
             return NULL;
 
+        // nothing to resolve, and types don't change once they're made
+        if ( resolvedNext == Next )
+            return this;
+
         RefPtr<Type>    type = new TypeReference( resolvedNext, mPtrSize );
         type->Mod = Mod;
         return type;
@@ -740,6 +758,9 @@ namespace MagoEE
 
     bool TypeDArray::Equals( Type* other )
     {
+        if ( other == this )
+            return true;
+
         if ( other->Ty != Tarray )
             return false;
 
@@ -758,6 +779,10 @@ namespace MagoEE
         if ( resolvedNext == NULL )
             return NULL;
 
+        // nothing to resolve, and types don't change once they're made
+        if ( resolvedNext == Next )
+            return this;
+
         RefPtr<Type>    type = new TypeDArray( resolvedNext, mLenType, mPtrType );
         type->Mod = Mod;
         return type;
@@ -799,6 +824,9 @@ namespace MagoEE
 
     bool TypeAArray::Equals( Type* other )
     {
+        if ( other == this )
+            return true;
+
         if ( other->Ty != Taarray )
             return false;
 
@@ -826,6 +854,9 @@ namespace MagoEE
         if ( resolvedIndex == NULL )
             return NULL;
 
+        if ( (resolvedNext == Next) && (resolvedIndex == Index) )
+            return this;
+
         RefPtr<Type>    type = new TypeAArray( resolvedNext, resolvedIndex, mSize );
         type->Mod = Mod;
         return type;
@@ -875,6 +906,9 @@ namespace MagoEE
 
     bool TypeSArray::Equals( Type* other )
     {
+        if ( other == this )
+            return true;
+
         if ( other->Ty != Tsarray )
             return false;
 
@@ -906,6 +940,10 @@ namespace MagoEE
         if ( resolvedNext == NULL )
             return NULL;
 
+        // nothing to resolve, and types don't change once they're made
+        if ( resolvedNext == Next )
+            return this;
+
         RefPtr<Type>    type = new TypeSArray( resolvedNext, Length );
         type->Mod = Mod;
         return type;
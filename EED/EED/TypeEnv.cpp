@@ -39,6 +39,7 @@ namespace MagoEE
             RefPtr<Type>    type = new TypeBasic( ty );
             
             mBasic[ty] = type;
+            mCanonical.insert( type.Get() );
         }
 
         memset( mAlias, 0, sizeof mAlias );
@@ -59,21 +60,24 @@ namespace MagoEE
             return false;
         }
 
+        DerivedKey  voidPtrKey = { Tpointer, GetType( Tvoid ), NULL, 0 };
+
         mVoidPtr = new TypePointer( GetType( Tvoid ), mPtrSize );
+        AddDerived( voidPtrKey, mVoidPtr );
 
         return true;
     }
 
     void TypeEnv::AddRef()
     {
-        mRefCount++;
+        InterlockedIncrement( &mRefCount );
     }
 
     void TypeEnv::Release()
     {
-        mRefCount--;
-        _ASSERT( mRefCount >= 0 );
-        if ( mRefCount == 0 )
+        long    newRef = InterlockedDecrement( &mRefCount );
+        _ASSERT( newRef >= 0 );
+        if ( newRef == 0 )
         {
             delete this;
         }
@@ -102,25 +106,57 @@ namespace MagoEE
 
     HRESULT TypeEnv::NewPointer( Type* pointed, Type*& pointer )
     {
-        pointer = new TypePointer( pointed, mPtrSize );
+        DerivedKey  key = { Tpointer, pointed, NULL, 0 };
+        GuardedArea guard( mDerivedGuard );
+
+        pointer = FindDerived( key );
+        if ( pointer == NULL )
+        {
+            pointer = new TypePointer( pointed, mPtrSize );
+            AddDerived( key, pointer );
+        }
+
         pointer->AddRef();
         return S_OK;
     }
 
     HRESULT TypeEnv::NewReference( Type* pointed, Type*& pointer )
     {
-        pointer = new TypeReference( pointed, mPtrSize );
+        DerivedKey  key = { Treference, pointed, NULL, 0 };
+        GuardedArea guard( mDerivedGuard );
+
+        pointer = FindDerived( key );
+        if ( pointer == NULL )
+        {
+            pointer = new TypeReference( pointed, mPtrSize );
+            AddDerived( key, pointer );
+        }
+
         pointer->AddRef();
         return S_OK;
     }
 
     HRESULT TypeEnv::NewDArray( Type* elem, Type*& type )
     {
-        // TODO: don't allocate these every time
-        RefPtr<Type>    lenType = GetType( mPtrSize == 8 ? Tuns64 : Tuns32 );
-        RefPtr<Type>    ptrType = new TypePointer( elem, mPtrSize );
+        HRESULT         hr = S_OK;
+        DerivedKey      key = { Tarray, elem, NULL, 0 };
+        GuardedArea     guard( mDerivedGuard );
+
+        type = FindDerived( key );
+        if ( type == NULL )
+        {
+            RefPtr<Type>    lenType = GetType( mPtrSize == 8 ? Tuns64 : Tuns32 );
+            RefPtr<Type>    ptrType;
+
+            // the lock can be entered again by the same thread
+            hr = NewPointer( elem, ptrType.Ref() );
+            if ( FAILED( hr ) )
+                return hr;
+
+            type = new TypeDArray( elem, lenType, ptrType );
+            AddDerived( key, type );
+        }
 
-        type = new TypeDArray( elem, lenType, ptrType );
         type->AddRef();
         return S_OK;
     }
@@ -132,14 +168,32 @@ namespace MagoEE
         if ( ptrType == NULL )
             return E_OUTOFMEMORY;
 
-        type = new TypeAArray( elem, key, ptrType->GetSize() );
+        DerivedKey  derivedKey = { Taarray, elem, key, 0 };
+        GuardedArea guard( mDerivedGuard );
+
+        type = FindDerived( derivedKey );
+        if ( type == NULL )
+        {
+            type = new TypeAArray( elem, key, ptrType->GetSize() );
+            AddDerived( derivedKey, type );
+        }
+
         type->AddRef();
         return S_OK;
     }
 
     HRESULT TypeEnv::NewSArray( Type* elem, uint32_t length, Type*& type )
     {
-        type = new TypeSArray( elem, length );
+        DerivedKey  key = { Tsarray, elem, NULL, length };
+        GuardedArea guard( mDerivedGuard );
+
+        type = FindDerived( key );
+        if ( type == NULL )
+        {
+            type = new TypeSArray( elem, length );
+            AddDerived( key, type );
+        }
+
         type->AddRef();
         return S_OK;
     }
@@ -193,4 +247,45 @@ namespace MagoEE
         type->AddRef();
         return S_OK;
     }
+
+    bool TypeEnv::DerivedKey::operator<( const DerivedKey& other ) const
+    {
+        if ( Ty != other.Ty )
+            return Ty < other.Ty;
+        if ( Next != other.Next )
+            return Next < other.Next;
+        if ( Index != other.Index )
+            return Index < other.Index;
+        return Length < other.Length;
+    }
+
+    bool TypeEnv::IsCanonical( Type* type )
+    {
+        return mCanonical.find( type ) != mCanonical.end();
+    }
+
+    Type* TypeEnv::FindDerived( const DerivedKey& key )
+    {
+        DerivedMap::iterator    it = mDerived.find( key );
+
+        if ( it == mDerived.end() )
+            return NULL;
+
+        return it->second.Get();
+    }
+
+    void TypeEnv::AddDerived( const DerivedKey& key, Type* type )
+    {
+        // Parts that aren't kept here are often made fresh for each use, like 
+        // the const copy of a basic type, or they come from symbols. Keeping 
+        // types made from them would grow the table without bound, or keep 
+        // the symbol store alive through its own type environment.
+        if ( !IsCanonical( key.Next ) )
+            return;
+        if ( (key.Index != NULL) && !IsCanonical( key.Index ) )
+            return;
+
+        mDerived[key] = type;
+        mCanonical.insert( type );
+    }
 }
@@ -18,13 +18,35 @@ namespace MagoEE
     enum ENUMTY;
 
 
+    // Pointers, references, and arrays are made once for each combination of 
+    // their parts, so that an expression that names the same type many times 
+    // makes one object. Only types made from this environment's own basic 
+    // types and derived types are kept. Types made from symbols, like structs, 
+    // aren't, because they refer back to the symbol store that owns this 
+    // environment.
+
     class TypeEnv : public ITypeEnv
     {
+        struct DerivedKey
+        {
+            ENUMTY      Ty;
+            Type*       Next;
+            Type*       Index;
+            uint32_t    Length;
+
+            bool operator<( const DerivedKey& other ) const;
+        };
+
+        typedef std::map< DerivedKey, RefPtr<Type> >  DerivedMap;
+
         long            mRefCount;
         RefPtr<Type>    mBasic[TMAX];
         RefPtr<Type>    mVoidPtr;
         ENUMTY          mAlias[ALIASTMAX];
         int             mPtrSize;
+        DerivedMap      mDerived;
+        std::set<Type*> mCanonical;
+        Guard           mDerivedGuard;
 
     public:
         TypeEnv( int pointerSize );
@@ -50,5 +72,10 @@ namespace MagoEE
         virtual HRESULT NewParams( ParameterList*& paramList );
         virtual HRESULT NewFunction( Type* returnType, ParameterList* params, int varArgs, Type*& type );
         virtual HRESULT NewDelegate( Type* funcType, Type*& type );
+
+    private:
+        bool IsCanonical( Type* type );
+        Type* FindDerived( const DerivedKey& key );
+        void AddDerived( const DerivedKey& key, Type* type );
     };
 }
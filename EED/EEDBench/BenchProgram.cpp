@@ -0,0 +1,566 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#include "Common.h"
+#include "BenchProgram.h"
+
+using namespace MagoEE;
+
+
+namespace EEDBench
+{
+    const Address   MemBase = 0x10000;
+    const uint32_t  MemSize = 0x1000;
+    const Address   HeapBase = 0x1000000;
+
+    const uint32_t  OffsetA = 0x00;
+    const uint32_t  OffsetB = 0x04;
+    const uint32_t  OffsetI = 0x08;
+    const uint32_t  OffsetD = 0x10;
+    const uint32_t  OffsetP = 0x18;
+    const uint32_t  OffsetPP = 0x1C;
+    const uint32_t  OffsetArr = 0x20;
+    const uint32_t  OffsetStr = 0x28;
+    const uint32_t  OffsetSA = 0x40;
+    const uint32_t  OffsetInts = 0x100;
+    const uint32_t  OffsetChars = 0x200;
+
+
+    //------------------------------------------------------------------------
+    //  BenchVar
+    //------------------------------------------------------------------------
+
+    BenchVar::BenchVar( const wchar_t* name, Type* type, Address addr )
+        :   mRefCount( 0 ),
+            mName( name ),
+            mType( type ),
+            mAddr( addr )
+    {
+    }
+
+    void BenchVar::AddRef()
+    {
+        InterlockedIncrement( &mRefCount );
+    }
+
+    void BenchVar::Release()
+    {
+        long    newRef = InterlockedDecrement( &mRefCount );
+        _ASSERT( newRef >= 0 );
+        if ( newRef == 0 )
+        {
+            delete this;
+        }
+    }
+
+    const wchar_t* BenchVar::GetName()
+    {
+        return mName.c_str();
+    }
+
+    bool BenchVar::GetType( Type*& type )
+    {
+        type = mType;
+        type->AddRef();
+        return true;
+    }
+
+    bool BenchVar::GetAddress( Address& addr )
+    {
+        addr = mAddr;
+        return true;
+    }
+
+    bool BenchVar::GetOffset( int& offset )
+    {
+        UNREFERENCED_PARAMETER( offset );
+        return false;
+    }
+
+    bool BenchVar::GetSize( uint32_t& size )
+    {
+        size = mType->GetSize();
+        return true;
+    }
+
+    bool BenchVar::GetBackingTy( ENUMTY& ty )
+    {
+        UNREFERENCED_PARAMETER( ty );
+        return false;
+    }
+
+    bool BenchVar::GetUdtKind( UdtKind& kind )
+    {
+        UNREFERENCED_PARAMETER( kind );
+        return false;
+    }
+
+    bool BenchVar::GetBaseClassOffset( Declaration* baseClass, int& offset )
+    {
+        UNREFERENCED_PARAMETER( baseClass );
+        UNREFERENCED_PARAMETER( offset );
+        return false;
+    }
+
+    bool BenchVar::IsField()
+    {
+        return false;
+    }
+
+    bool BenchVar::IsStaticField()
+    {
+        return false;
+    }
+
+    bool BenchVar::IsVar()
+    {
+        return true;
+    }
+
+    bool BenchVar::IsConstant()
+    {
+        return false;
+    }
+
+    bool BenchVar::IsType()
+    {
+        return false;
+    }
+
+    bool BenchVar::IsBaseClass()
+    {
+        return false;
+    }
+
+    HRESULT BenchVar::FindObject( const wchar_t* name, Declaration*& decl )
+    {
+        UNREFERENCED_PARAMETER( name );
+        UNREFERENCED_PARAMETER( decl );
+        return E_NOTIMPL;
+    }
+
+    bool BenchVar::EnumMembers( IEnumDeclarationMembers*& members )
+    {
+        UNREFERENCED_PARAMETER( members );
+        return false;
+    }
+
+    HRESULT BenchVar::FindObjectByValue( uint64_t intVal, Declaration*& decl )
+    {
+        UNREFERENCED_PARAMETER( intVal );
+        UNREFERENCED_PARAMETER( decl );
+        return E_NOTIMPL;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  BenchProgram
+    //------------------------------------------------------------------------
+
+    BenchProgram::BenchProgram()
+        :   mMem( MemSize ),
+            mReadCount( 0 ),
+            mAALookup( PtrSize )
+    {
+    }
+
+    HRESULT BenchProgram::Init( ITypeEnv* typeEnv )
+    {
+        HRESULT         hr = S_OK;
+        Type*           intType = typeEnv->GetType( Tint32 );
+        RefPtr<Type>    ptrType;
+        RefPtr<Type>    ptrPtrType;
+        RefPtr<Type>    arrayType;
+        RefPtr<Type>    sarrayType;
+        RefPtr<Type>    stringType;
+
+        hr = typeEnv->NewPointer( intType, ptrType.Ref() );
+        if ( FAILED( hr ) )
+            return hr;
+        hr = typeEnv->NewPointer( ptrType, ptrPtrType.Ref() );
+        if ( FAILED( hr ) )
+            return hr;
+        hr = typeEnv->NewDArray( intType, arrayType.Ref() );
+        if ( FAILED( hr ) )
+            return hr;
+        hr = typeEnv->NewSArray( intType, 8, sarrayType.Ref() );
+        if ( FAILED( hr ) )
+            return hr;
+        hr = typeEnv->NewDArray( typeEnv->GetType( Tchar ), stringType.Ref() );
+        if ( FAILED( hr ) )
+            return hr;
+
+        int32_t     a = 42;
+        int32_t     b = 5;
+        uint32_t    i = 0;
+        double      d = 2.25;
+        uint32_t    p = (uint32_t) MemBase + OffsetInts;
+        uint32_t    pp = (uint32_t) MemBase + OffsetP;
+        uint32_t    arr[2] = { 8, (uint32_t) MemBase + OffsetInts };
+        uint32_t    str[2] = { 5, (uint32_t) MemBase + OffsetChars };
+        int32_t     ints[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+
+        Write( OffsetA, &a, sizeof a );
+        Write( OffsetB, &b, sizeof b );
+        Write( OffsetI, &i, sizeof i );
+        Write( OffsetD, &d, sizeof d );
+        Write( OffsetP, &p, sizeof p );
+        Write( OffsetPP, &pp, sizeof pp );
+        Write( OffsetArr, arr, sizeof arr );
+        Write( OffsetStr, str, sizeof str );
+        Write( OffsetSA, ints, sizeof ints );
+        Write( OffsetInts, ints, sizeof ints );
+        Write( OffsetChars, "hello", 5 );
+
+        AddVar( L"a", intType, OffsetA );
+        AddVar( L"b", intType, OffsetB );
+        AddVar( L"i", typeEnv->GetType( Tuns32 ), OffsetI );
+        AddVar( L"d", typeEnv->GetType( Tfloat64 ), OffsetD );
+        AddVar( L"p", ptrType, OffsetP );
+        AddVar( L"pp", ptrPtrType, OffsetPP );
+        AddVar( L"arr", arrayType, OffsetArr );
+        AddVar( L"str", stringType, OffsetStr );
+        AddVar( L"sa", sarrayType, OffsetSA );
+
+        return S_OK;
+    }
+
+    void BenchProgram::SetLoopCounter( uint32_t value )
+    {
+        Write( OffsetI, &value, sizeof value );
+    }
+
+    // the final mix of MurmurHash2, which druntime's open addressing AA runs
+    // every hash through
+    static uint32_t MixHash( uint32_t h )
+    {
+        h ^= h >> 13;
+        h *= 0x5bd1e995;
+        h ^= h >> 15;
+        return h;
+    }
+
+    HRESULT BenchProgram::AddAArray( 
+        ITypeEnv* typeEnv, 
+        const wchar_t* name, 
+        int aaVersion, 
+        uint32_t bucketCount, 
+        uint32_t length )
+    {
+        HRESULT         hr = S_OK;
+        Type*           intType = typeEnv->GetType( Tint32 );
+        RefPtr<Type>    aaType;
+
+        _ASSERT( (aaVersion == 0) || (aaVersion == 1) );
+        _ASSERT( bucketCount > 0 );
+
+        hr = typeEnv->NewAArray( intType, intType, aaType.Ref() );
+        if ( FAILED( hr ) )
+            return hr;
+
+        Address     varAddr = AllocHeap( PtrSize );
+        Address     bbAddr = AllocHeap( sizeof( BB32_V1 ) );
+        uint32_t    bbPtr = (uint32_t) bbAddr;
+
+        memcpy( GetMem( varAddr, PtrSize ), &bbPtr, PtrSize );
+
+        if ( aaVersion == 1 )
+        {
+            const uint32_t  HashFilledMark = 0x80000000;
+
+            _ASSERT( (bucketCount & (bucketCount - 1)) == 0 );
+            _ASSERT( length < bucketCount );
+
+            Address     bucketsAddr = AllocHeap( bucketCount * sizeof( Bucket32 ) );
+            uint32_t    firstUsed = bucketCount;
+            BB32_V1     bb = { 0 };
+
+            for ( uint32_t i = 0; i < length; i++ )
+            {
+                int32_t     entry[2] = { (int32_t) i, (int32_t) i * 10 };
+                Address     entryAddr = AllocHeap( sizeof entry );
+                uint32_t    hash = (MixHash( i ) & (HashFilledMark - 1)) | HashFilledMark;
+                uint32_t    index = hash & (bucketCount - 1);
+                Bucket32*   bucket = NULL;
+
+                memcpy( GetMem( entryAddr, sizeof entry ), entry, sizeof entry );
+
+                // the same probing that druntime does
+                for ( uint32_t j = 1; ; j++ )
+                {
+                    bucket = (Bucket32*) GetMem( bucketsAddr + index * sizeof( Bucket32 ), sizeof( Bucket32 ) );
+                    if ( bucket->hash == 0 )
+                        break;
+                    index = (index + j) & (bucketCount - 1);
+                }
+
+                bucket->hash = hash;
+                bucket->entry = (uint32_t) entryAddr;
+                firstUsed = std::min( firstUsed, index );
+            }
+
+            bb.buckets.length = bucketCount;
+            bb.buckets.ptr = (uint32_t) bucketsAddr;
+            bb.used = length;
+            bb.firstUsed = firstUsed;
+            bb.keysz = sizeof( int32_t );
+            bb.valsz = sizeof( int32_t );
+            bb.valoff = sizeof( int32_t );
+            memcpy( GetMem( bbAddr, sizeof bb ), &bb, sizeof bb );
+        }
+        else
+        {
+            _ASSERT( (bucketCount & (bucketCount - 1)) != 0 );
+
+            Address     bucketsAddr = AllocHeap( bucketCount * PtrSize );
+            BB32        bb = { 0 };
+
+            for ( uint32_t i = 0; i < length; i++ )
+            {
+                // an int's hash is itself
+                Address     bucketAddr = bucketsAddr + (i % bucketCount) * PtrSize;
+                Address     nodeAddr = AllocHeap( 4 * sizeof( uint32_t ) );
+                uint32_t    nodePtr = (uint32_t) nodeAddr;
+                uint32_t    node[4] = { 0, i, i, i * 10 };   // next, hash, key, value
+
+                // new nodes go at the head of the chain
+                memcpy( &node[0], GetMem( bucketAddr, PtrSize ), PtrSize );
+                memcpy( GetMem( nodeAddr, sizeof node ), node, sizeof node );
+                memcpy( GetMem( bucketAddr, PtrSize ), &nodePtr, PtrSize );
+            }
+
+            bb.b.length = bucketCount;
+            bb.b.ptr = (uint32_t) bucketsAddr;
+            bb.nodes = length;
+            memcpy( GetMem( bbAddr, sizeof bb ), &bb, sizeof bb );
+        }
+
+        RefPtr<Declaration> decl = new BenchVar( name, aaType, varAddr );
+
+        if ( decl == NULL )
+            return E_OUTOFMEMORY;
+
+        mVars[name] = decl;
+        return S_OK;
+    }
+
+    Address BenchProgram::AddBlock( const void* data, uint32_t size )
+    {
+        Address     addr = AllocHeap( size );
+
+        memcpy( GetMem( addr, size ), data, size );
+        return addr;
+    }
+
+    uint64_t BenchProgram::GetReadCount()
+    {
+        return mReadCount;
+    }
+
+    void BenchProgram::Write( uint32_t offset, const void* data, uint32_t size )
+    {
+        _ASSERT( offset + size <= mMem.size() );
+        memcpy( &mMem[offset], data, size );
+    }
+
+    HRESULT BenchProgram::AddVar( const wchar_t* name, Type* type, uint32_t offset )
+    {
+        RefPtr<Declaration> decl = new BenchVar( name, type, MemBase + offset );
+
+        if ( decl == NULL )
+            return E_OUTOFMEMORY;
+
+        mVars[name] = decl;
+        return S_OK;
+    }
+
+    uint8_t* BenchProgram::GetMem( Address addr, uint32_t size )
+    {
+        if ( (addr >= HeapBase) && (addr - HeapBase <= mHeap.size()) 
+            && (size <= mHeap.size() - (addr - HeapBase)) )
+            return &mHeap[(size_t) (addr - HeapBase)];
+
+        if ( (addr < MemBase) || (addr - MemBase > mMem.size()) 
+            || (size > mMem.size() - (addr - MemBase)) )
+            return NULL;
+
+        return &mMem[(size_t) (addr - MemBase)];
+    }
+
+    // Allocates zeroed memory in the heap, 16-byte aligned like the GC's.
+    Address BenchProgram::AllocHeap( uint32_t size )
+    {
+        size_t  offset = mHeap.size();
+
+        mHeap.resize( offset + ((size + 15) & ~15) );
+        return HeapBase + offset;
+    }
+
+    HRESULT BenchProgram::FindObject( const wchar_t* name, Declaration*& decl )
+    {
+        VarMap::iterator    it = mVars.find( name );
+
+        if ( it == mVars.end() )
+            return E_MAGOEE_SYMBOL_NOT_FOUND;
+
+        decl = it->second;
+        decl->AddRef();
+        return S_OK;
+    }
+
+    HRESULT BenchProgram::GetThis( Declaration*& decl )
+    {
+        UNREFERENCED_PARAMETER( decl );
+        return E_MAGOEE_SYMBOL_NOT_FOUND;
+    }
+
+    HRESULT BenchProgram::GetSuper( Declaration*& decl )
+    {
+        UNREFERENCED_PARAMETER( decl );
+        return E_MAGOEE_SYMBOL_NOT_FOUND;
+    }
+
+    HRESULT BenchProgram::GetReturnType( Type*& type )
+    {
+        UNREFERENCED_PARAMETER( type );
+        return E_MAGOEE_SYMBOL_NOT_FOUND;
+    }
+
+    HRESULT BenchProgram::GetAddress( Declaration* decl, Address& addr )
+    {
+        if ( !decl->GetAddress( addr ) )
+            return E_FAIL;
+
+        return S_OK;
+    }
+
+    HRESULT BenchProgram::GetValue( Declaration* decl, DataValue& value )
+    {
+        Address         addr = 0;
+        RefPtr<Type>    type;
+
+        if ( !decl->GetAddress( addr ) || !decl->GetType( type.Ref() ) )
+            return E_FAIL;
+
+        return GetValue( addr, type, value );
+    }
+
+    HRESULT BenchProgram::GetValue( Address addr, Type* type, DataValue& value )
+    {
+        mReadCount++;
+
+        const uint8_t*  mem = GetMem( addr, type->GetSize() );
+
+        if ( mem == NULL )
+            return E_FAIL;
+
+        return FromRawValue( mem, type, value );
+    }
+
+    HRESULT BenchProgram::FromRawValue( const uint8_t* mem, Type* type, DataValue& value )
+    {
+        uint32_t        size = type->GetSize();
+
+        memset( &value, 0, sizeof value );
+
+        if ( type->IsPointer() || type->IsAArray() )
+        {
+            uint32_t    ptr = 0;
+            memcpy( &ptr, mem, sizeof ptr );
+            value.Addr = ptr;
+        }
+        else if ( type->IsDArray() )
+        {
+            uint32_t    array[2] = { 0 };
+            memcpy( array, mem, sizeof array );
+            value.Array.Length = array[0];
+            value.Array.Addr = array[1];
+        }
+        else if ( type->IsFloatingPoint() )
+        {
+            if ( size == sizeof( double ) )
+            {
+                double  d = 0;
+                memcpy( &d, mem, sizeof d );
+                value.Float80Value.FromDouble( d );
+            }
+            else if ( size == sizeof( float ) )
+            {
+                float   f = 0;
+                memcpy( &f, mem, sizeof f );
+                value.Float80Value.FromFloat( f );
+            }
+            else
+                return E_FAIL;
+        }
+        else if ( type->IsIntegral() )
+        {
+            uint64_t    u = 0;
+            memcpy( &u, mem, size );
+
+            if ( type->IsSigned() && (size < sizeof u) )
+            {
+                int     shift = (sizeof u - size) * 8;
+                value.Int64Value = ((int64_t) (u << shift)) >> shift;
+            }
+            else
+                value.UInt64Value = u;
+        }
+        // the rest, like static arrays, have nothing to load
+
+        return S_OK;
+    }
+
+    HRESULT BenchProgram::GetValue( Address aArrayAddr, const DataObject& key, Address& valueAddr )
+    {
+        // there are arrays of both layouts, so it's worked out for each one
+        int     aaVersion = -1;
+
+        return mAALookup.FindValue( this, aArrayAddr, aaVersion, key, valueAddr );
+    }
+
+    int BenchProgram::GetAAVersion()
+    {
+        return -1;
+    }
+
+    HRESULT BenchProgram::SetValue( Declaration* decl, const DataValue& value )
+    {
+        UNREFERENCED_PARAMETER( decl );
+        UNREFERENCED_PARAMETER( value );
+        return E_NOTIMPL;
+    }
+
+    HRESULT BenchProgram::SetValue( Address addr, Type* type, const DataValue& value )
+    {
+        UNREFERENCED_PARAMETER( addr );
+        UNREFERENCED_PARAMETER( type );
+        UNREFERENCED_PARAMETER( value );
+        return E_NOTIMPL;
+    }
+
+    HRESULT BenchProgram::ReadMemory( Address addr, uint32_t sizeToRead, uint32_t& sizeRead, uint8_t* buffer )
+    {
+        const uint8_t*  mem = GetMem( addr, sizeToRead );
+
+        mReadCount++;
+        sizeRead = 0;
+
+        if ( mem == NULL )
+            return E_FAIL;
+
+        memcpy( buffer, mem, sizeToRead );
+        sizeRead = sizeToRead;
+        return S_OK;
+    }
+
+    HRESULT BenchProgram::ReadMemory( MemoryRead* reads, uint32_t count )
+    {
+        ReadPlan    plan;
+        return plan.Read( this, reads, count );
+    }
+}
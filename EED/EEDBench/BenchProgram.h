@@ -0,0 +1,129 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+
+namespace EEDBench
+{
+    class BenchVar : public MagoEE::Declaration
+    {
+        long                    mRefCount;
+        std::wstring            mName;
+        RefPtr<MagoEE::Type>    mType;
+        MagoEE::Address         mAddr;
+
+    public:
+        BenchVar( const wchar_t* name, MagoEE::Type* type, MagoEE::Address addr );
+
+        virtual void AddRef();
+        virtual void Release();
+
+        virtual const wchar_t* GetName();
+
+        virtual bool GetType( MagoEE::Type*& type );
+        virtual bool GetAddress( MagoEE::Address& addr );
+        virtual bool GetOffset( int& offset );
+        virtual bool GetSize( uint32_t& size );
+        virtual bool GetBackingTy( MagoEE::ENUMTY& ty );
+        virtual bool GetUdtKind( MagoEE::UdtKind& kind );
+        virtual bool GetBaseClassOffset( MagoEE::Declaration* baseClass, int& offset );
+
+        virtual bool IsField();
+        virtual bool IsStaticField();
+        virtual bool IsVar();
+        virtual bool IsConstant();
+        virtual bool IsType();
+        virtual bool IsBaseClass();
+
+        virtual HRESULT FindObject( const wchar_t* name, MagoEE::Declaration*& decl );
+        virtual bool EnumMembers( MagoEE::IEnumDeclarationMembers*& members );
+        virtual HRESULT FindObjectByValue( uint64_t intVal, MagoEE::Declaration*& decl );
+    };
+
+
+    // A made up 32-bit program for the EED to bind to and evaluate in. It's 
+    // a block of memory with a few variables of common types in it, so that 
+    // what's timed is the EED and not a debuggee.
+    //
+    //  a, b    int             42, 5
+    //  i       uint            a loop counter, starting at 0
+    //  d       double          2.25
+    //  p       int*            ints
+    //  pp      int**           &p
+    //  arr     int[]           ints[0 .. 8]
+    //  sa      int[8]          1 to 8
+    //  str     char[]          "hello"
+    //
+    // Associative arrays can be added too. They're laid out the way druntime
+    // lays them out, in a heap after the variables.
+
+    class BenchProgram : public MagoEE::IValueBinder
+    {
+        typedef std::map< std::wstring, RefPtr<MagoEE::Declaration> > VarMap;
+
+        std::vector<uint8_t>    mMem;
+        std::vector<uint8_t>    mHeap;
+        VarMap                  mVars;
+        uint64_t                mReadCount;
+        MagoEE::AArrayLookup    mAALookup;
+
+    public:
+        static const int PtrSize = 4;
+
+        BenchProgram();
+
+        HRESULT Init( MagoEE::ITypeEnv* typeEnv );
+
+        void SetLoopCounter( uint32_t value );
+
+        // Adds an int[int] variable with the keys 0 to length - 1, each 
+        // mapped to ten times itself. aaVersion 0 is the chained layout from 
+        // before dmd 2.067, and 1 is the open addressing one after it. 
+        // bucketCount has to be a power of 2 for 1, and shouldn't be for 0, 
+        // so that the layout can be told apart. Keys are looked up with the 
+        // EED's AArrayLookup, as the debug engine does.
+        HRESULT AddAArray( 
+            MagoEE::ITypeEnv* typeEnv, 
+            const wchar_t* name, 
+            int aaVersion, 
+            uint32_t bucketCount, 
+            uint32_t length );
+
+        // Copies a block of data into the heap, and returns its address.
+        MagoEE::Address AddBlock( const void* data, uint32_t size );
+
+        // how many times memory was read, by value or by block
+        uint64_t GetReadCount();
+
+        virtual HRESULT FindObject( const wchar_t* name, MagoEE::Declaration*& decl );
+
+        virtual HRESULT GetThis( MagoEE::Declaration*& decl );
+        virtual HRESULT GetSuper( MagoEE::Declaration*& decl );
+        virtual HRESULT GetReturnType( MagoEE::Type*& type );
+
+        virtual HRESULT GetAddress( MagoEE::Declaration* decl, MagoEE::Address& addr );
+
+        virtual HRESULT GetValue( MagoEE::Declaration* decl, MagoEE::DataValue& value );
+        virtual HRESULT GetValue( MagoEE::Address addr, MagoEE::Type* type, MagoEE::DataValue& value );
+        virtual HRESULT GetValue( MagoEE::Address aArrayAddr, const MagoEE::DataObject& key, MagoEE::Address& valueAddr );
+        virtual int GetAAVersion();
+
+        virtual HRESULT SetValue( MagoEE::Declaration* decl, const MagoEE::DataValue& value );
+        virtual HRESULT SetValue( MagoEE::Address addr, MagoEE::Type* type, const MagoEE::DataValue& value );
+
+        virtual HRESULT ReadMemory( MagoEE::Address addr, uint32_t sizeToRead, uint32_t& sizeRead, uint8_t* buffer );
+        virtual HRESULT ReadMemory( MagoEE::MemoryRead* reads, uint32_t count );
+        virtual HRESULT FromRawValue( const uint8_t* buffer, MagoEE::Type* type, MagoEE::DataValue& value );
+
+    private:
+        void Write( uint32_t offset, const void* data, uint32_t size );
+        HRESULT AddVar( const wchar_t* name, MagoEE::Type* type, uint32_t offset );
+        uint8_t* GetMem( MagoEE::Address addr, uint32_t size );
+        MagoEE::Address AllocHeap( uint32_t size );
+    };
+}
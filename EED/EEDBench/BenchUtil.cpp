@@ -0,0 +1,80 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#include "Common.h"
+#include "BenchUtil.h"
+
+
+static uint64_t gAllocCount = 0;
+static uint64_t gAllocBytes = 0;
+
+
+void* operator new( size_t size )
+{
+    gAllocCount++;
+    gAllocBytes += size;
+
+    void*   p = malloc( (size == 0) ? 1 : size );
+
+    if ( p == NULL )
+        throw std::bad_alloc();
+
+    return p;
+}
+
+void* operator new[]( size_t size )
+{
+    return operator new( size );
+}
+
+void operator delete( void* p )
+{
+    free( p );
+}
+
+void operator delete[]( void* p )
+{
+    free( p );
+}
+
+
+using namespace MagoBench;
+
+
+namespace EEDBench
+{
+    uint64_t GetAllocCount()
+    {
+        return gAllocCount;
+    }
+
+    uint64_t GetAllocBytes()
+    {
+        return gAllocBytes;
+    }
+
+    void PrintResult(
+        const char* fixture,
+        const char* scenario,
+        Samples& samples,
+        uint64_t wallTicks,
+        uint64_t hits,
+        uint64_t allocs,
+        uint64_t bytes,
+        uint64_t reads )
+    {
+        JsonLine    line( "result" );
+        double      count = (double) samples.GetCount();
+
+        AddResultFields( line, fixture, scenario, 1, samples, wallTicks, hits );
+        line.Add( "allocs_per_op", (count > 0) ? (double) allocs / count : 0.0 );
+        line.Add( "bytes_per_op", (count > 0) ? (double) bytes / count : 0.0 );
+        line.Add( "reads_per_op", (count > 0) ? (double) reads / count : 0.0 );
+        line.Add( "peak_rss_bytes", GetPeakWorkingSet() );
+        line.Print();
+    }
+}
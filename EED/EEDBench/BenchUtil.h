@@ -0,0 +1,33 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+#include <BenchCommon.h>
+
+
+namespace EEDBench
+{
+    // Every allocation through operator new in the process, the EED's 
+    // included, since this program replaces the global operators. The 
+    // counters aren't synchronized, so they're only good on one thread.
+    uint64_t GetAllocCount();
+    uint64_t GetAllocBytes();
+
+    // Prints a result line for a scenario. allocs and bytes are what the 
+    // whole run allocated, and reads are how many times it read the 
+    // program's memory; they're all reported per operation.
+    void PrintResult(
+        const char* fixture,
+        const char* scenario,
+        MagoBench::Samples& samples,
+        uint64_t wallTicks,
+        uint64_t hits,
+        uint64_t allocs,
+        uint64_t bytes,
+        uint64_t reads );
+}
@@ -0,0 +1,669 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+// EEDBench : times the expression evaluator over sets of typical watch and
+// breakpoint condition expressions, and prints one JSON object per line for
+// each result.
+//
+//  EEDBench [options]
+//
+// Options:
+//  -iterations N   times each expression set is run in each scenario (1000)
+//  -aaiterations N times each associative array is expanded in each 
+//                  scenario (10)
+//
+// EEDCheck checks the results of the parts of the EED that are timed here.
+
+#include "Common.h"
+#include "BenchProgram.h"
+#include "BenchUtil.h"
+
+using namespace MagoEE;
+using namespace MagoBench;
+using namespace EEDBench;
+
+
+namespace EEDBench
+{
+    struct Options
+    {
+        uint32_t        Iterations;
+        uint32_t        AAIterations;
+    };
+
+    // what a watch window refresh asks for
+    const wchar_t*  gWatchTexts[] = 
+    {
+        L"a", 
+        L"b", 
+        L"d", 
+        L"p", 
+        L"*p", 
+        L"pp", 
+        L"**pp", 
+        L"arr", 
+        L"arr.length", 
+        L"arr.ptr", 
+        L"arr[3]", 
+        L"arr[a % 8]", 
+        L"arr[1 .. 4]", 
+        L"sa", 
+        L"sa[2] * a", 
+        L"sa.length", 
+        L"&sa[3]", 
+        L"str", 
+        L"str[0]", 
+        L"a + b * 2 - 7", 
+        L"(a + b) * (a - b)", 
+        L"d * 3.5 + a", 
+        L"cast(double) a / b", 
+        L"cast(ubyte) a", 
+        L"cast(uint) -a", 
+        L"~a ^ b", 
+        L"&a", 
+        L"*&a", 
+        L"p[1] + p[2]", 
+        L"cast(short*) p", 
+        L"cast(void*) p", 
+        L"*(cast(int*) p + 2)", 
+        L"cast(int[]*) &arr", 
+        L"(*cast(int[]*) &arr)[2]", 
+        L"cast(char[]) str", 
+        L"a > b", 
+        L"a == 42 && b != 0", 
+    };
+
+    // what a conditional breakpoint or a tracepoint in a loop asks for
+    const wchar_t*  gConditionTexts[] = 
+    {
+        L"i == 500", 
+        L"i > 100 && a == 42", 
+        L"i % 64 == 0", 
+        L"(i & 0xff) == b", 
+        L"p[i % 8] == 3", 
+        L"sa[i % 8] + a > 47", 
+        L"arr.length > 4 && arr[2] == 3", 
+        L"str[0] == 'h'", 
+        L"d * i > 1000.0", 
+        L"*pp != null && **pp == 1", 
+    };
+
+    struct ExprSet
+    {
+        const char*         Name;
+        const wchar_t**     Texts;
+        size_t              Count;
+    };
+
+    const ExprSet   gExprSets[] = 
+    {
+        { "watches",    gWatchTexts,        _countof( gWatchTexts ) },
+        { "conditions", gConditionTexts,    _countof( gConditionTexts ) },
+    };
+
+    // associative arrays as big as druntime grows them for their lengths: 
+    // a prime number of buckets for the chained layout, and a power of 2 
+    // that's kept under 4/5 full for the open addressing one
+    struct AArraySet
+    {
+        const char*         Name;
+        const wchar_t*      VarName;
+        int                 AAVersion;
+        uint32_t            BucketCount;
+        uint32_t            Length;
+    };
+
+    const AArraySet gAArraySets[] = 
+    {
+        { "aa_chained_1543",    L"chained1543",     0,  1543,       1543 },
+        { "aa_chained_24593",   L"chained24593",    0,  24593,      24593 },
+        { "aa_chained_98317",   L"chained98317",    0,  98317,      98317 },
+        { "aa_open_1024",       L"open1024",        1,  1024,       512 },
+        { "aa_open_16384",      L"open16384",       1,  16384,      8192 },
+        { "aa_open_131072",     L"open131072",      1,  131072,     65536 },
+        { "aa_open_full_16384", L"openfull16384",   1,  16384,      13107 },
+    };
+
+    // how many children a watch window shows at once
+    const uint32_t  AArrayPageSize = 100;
+
+    enum Scenario
+    {
+        Scenario_Parse,
+        Scenario_ParseBind,
+        Scenario_ParseBindEval,
+    };
+
+    struct BenchEnv
+    {
+        RefPtr<ITypeEnv>    TypeEnv;
+        RefPtr<NameTable>   StrTable;
+        BenchProgram        Program;
+    };
+
+
+    static uint64_t GetTimerOverhead()
+    {
+        Samples samples;
+
+        for ( int i = 0; i < 1000; i++ )
+        {
+            uint64_t    start = GetTicks();
+            samples.Add( GetTicks() - start );
+        }
+
+        return samples.GetPercentile( 50 );
+    }
+
+    static void PrintError( const char* fixture, const wchar_t* text, HRESULT hr )
+    {
+        JsonLine    line( "error" );
+
+        line.Add( "fixture", fixture );
+        line.Add( "expr", text );
+        line.Add( "hresult", (uint32_t) hr );
+        line.Print();
+    }
+
+    // Does what a debugger does with the text of an expression, up to the
+    // step that the scenario stops at.
+    static HRESULT RunExpr( Scenario scenario, const wchar_t* text, BenchEnv& env )
+    {
+        HRESULT                 hr = S_OK;
+        RefPtr<IEEDParsedExpr>  expr;
+        EvalOptions             options = { 0 };
+        EvalResult              result = { 0 };
+
+        hr = ParseText( text, env.TypeEnv, env.StrTable, expr.Ref() );
+        if ( FAILED( hr ) || (scenario == Scenario_Parse) )
+            return hr;
+
+        hr = expr->Bind( options, &env.Program );
+        if ( FAILED( hr ) || (scenario == Scenario_ParseBind) )
+            return hr;
+
+        return expr->Evaluate( options, &env.Program, result );
+    }
+
+
+    //------------------------------------------------------------------------
+    //  Runs
+    //------------------------------------------------------------------------
+
+    // Each iteration goes through the whole set, with the loop counter moved
+    // along, the way it is when a breakpoint is hit over and over.
+    static void RunScenario( 
+        const ExprSet& set, 
+        const std::vector<bool>& usable, 
+        const char* name, 
+        Scenario scenario, 
+        BenchEnv& env, 
+        const Options& options )
+    {
+        Samples     samples;
+        uint64_t    hits = 0;
+
+        samples.Reserve( set.Count * options.Iterations );
+
+        uint64_t    allocStart = GetAllocCount();
+        uint64_t    byteStart = GetAllocBytes();
+        uint64_t    readStart = env.Program.GetReadCount();
+        uint64_t    wallStart = GetTicks();
+
+        for ( uint32_t i = 0; i < options.Iterations; i++ )
+        {
+            env.Program.SetLoopCounter( i );
+
+            for ( size_t j = 0; j < set.Count; j++ )
+            {
+                if ( !usable[j] )
+                    continue;
+
+                uint64_t    start = GetTicks();
+                HRESULT     hr = RunExpr( scenario, set.Texts[j], env );
+
+                samples.Add( GetTicks() - start );
+                if ( hr == S_OK )
+                    hits++;
+            }
+        }
+
+        uint64_t    wallTicks = GetTicks() - wallStart;
+        uint64_t    allocs = GetAllocCount() - allocStart;
+        uint64_t    bytes = GetAllocBytes() - byteStart;
+        uint64_t    reads = env.Program.GetReadCount() - readStart;
+
+        PrintResult( set.Name, name, samples, wallTicks, hits, allocs, bytes, reads );
+    }
+
+    // Binds each expression once, then only evaluates it, the way a condition
+    // is evaluated each time its breakpoint is hit.
+    static void RunEvalScenario( 
+        const ExprSet& set, 
+        const std::vector<bool>& usable, 
+        BenchEnv& env, 
+        const Options& options )
+    {
+        Samples     samples;
+        uint64_t    hits = 0;
+        EvalOptions evalOptions = { 0 };
+        std::vector< RefPtr<IEEDParsedExpr> >   exprs( set.Count );
+
+        for ( size_t j = 0; j < set.Count; j++ )
+        {
+            if ( !usable[j] )
+                continue;
+
+            HRESULT hr = ParseText( set.Texts[j], env.TypeEnv, env.StrTable, exprs[j].Ref() );
+            if ( SUCCEEDED( hr ) )
+                hr = exprs[j]->Bind( evalOptions, &env.Program );
+            if ( FAILED( hr ) )
+                exprs[j].Attach( NULL );
+        }
+
+        samples.Reserve( set.Count * options.Iterations );
+
+        uint64_t    allocStart = GetAllocCount();
+        uint64_t    byteStart = GetAllocBytes();
+        uint64_t    readStart = env.Program.GetReadCount();
+        uint64_t    wallStart = GetTicks();
+
+        for ( uint32_t i = 0; i < options.Iterations; i++ )
+        {
+            env.Program.SetLoopCounter( i );
+
+            for ( size_t j = 0; j < set.Count; j++ )
+            {
+                if ( exprs[j] == NULL )
+                    continue;
+
+                EvalResult  result = { 0 };
+                uint64_t    start = GetTicks();
+                HRESULT     hr = exprs[j]->Evaluate( evalOptions, &env.Program, result );
+
+                samples.Add( GetTicks() - start );
+                if ( hr == S_OK )
+                    hits++;
+            }
+        }
+
+        uint64_t    wallTicks = GetTicks() - wallStart;
+        uint64_t    allocs = GetAllocCount() - allocStart;
+        uint64_t    bytes = GetAllocBytes() - byteStart;
+        uint64_t    reads = env.Program.GetReadCount() - readStart;
+
+        PrintResult( set.Name, "eval", samples, wallTicks, hits, allocs, bytes, reads );
+    }
+
+    static void RunExprSet( const ExprSet& set, BenchEnv& env, const Options& options )
+    {
+        std::vector<bool>   usable( set.Count );
+        uint32_t            usableCount = 0;
+
+        // leave out what doesn't evaluate, so that every scenario times the 
+        // same expressions all the way through
+        for ( size_t i = 0; i < set.Count; i++ )
+        {
+            HRESULT hr = RunExpr( Scenario_ParseBindEval, set.Texts[i], env );
+
+            if ( hr == S_OK )
+            {
+                usable[i] = true;
+                usableCount++;
+            }
+            else
+                PrintError( set.Name, set.Texts[i], hr );
+        }
+
+        JsonLine    fixtureLine( "fixture" );
+
+        fixtureLine.Add( "fixture", set.Name );
+        fixtureLine.Add( "exprs", usableCount );
+        fixtureLine.Add( "timer_overhead_ns", TicksToNanoseconds( GetTimerOverhead() ) );
+        fixtureLine.Print();
+
+        RunScenario( set, usable, "parse", Scenario_Parse, env, options );
+        RunScenario( set, usable, "parse_bind", Scenario_ParseBind, env, options );
+        RunScenario( set, usable, "parse_bind_eval", Scenario_ParseBindEval, env, options );
+        RunEvalScenario( set, usable, env, options );
+    }
+
+    enum AArrayScenario
+    {
+        AArray_Expand,
+        AArray_PageMiddle,
+        AArray_Repage,
+        AArray_All,
+    };
+
+    // Evaluates the next count children, or as many as are left.
+    static HRESULT EvaluateChildren( IEEDEnumValues* enumerator, uint32_t count )
+    {
+        EvalOptions options = { 0 };
+
+        count = std::min( count, enumerator->GetCount() - enumerator->GetIndex() );
+
+        for ( uint32_t i = 0; i < count; i++ )
+        {
+            EvalResult      result = { 0 };
+            std::wstring    name;
+            std::wstring    fullName;
+
+            HRESULT hr = enumerator->EvaluateNext( options, result, name, fullName );
+            if ( FAILED( hr ) )
+                return hr;
+        }
+
+        return S_OK;
+    }
+
+    // Does what a watch window does with an associative array when it's 
+    // expanded, or scrolled through.
+    static HRESULT RunAArrayOp( 
+        AArrayScenario scenario, 
+        const AArraySet& set, 
+        const DataObject& parentVal, 
+        IEEDEnumValues* repageEnum, 
+        BenchEnv& env )
+    {
+        HRESULT                 hr = S_OK;
+        RefPtr<IEEDEnumValues>  enumerator;
+
+        if ( scenario == AArray_Repage )
+        {
+            // the same children were shown before, so it's been through them
+            enumerator = repageEnum;
+            enumerator->Reset();
+        }
+        else
+        {
+            hr = EnumValueChildren( 
+                &env.Program, 
+                set.VarName, 
+                parentVal, 
+                env.TypeEnv, 
+                env.StrTable, 
+                enumerator.Ref() );
+            if ( FAILED( hr ) )
+                return hr;
+        }
+
+        if ( scenario == AArray_All )
+            return EvaluateChildren( enumerator, enumerator->GetCount() );
+
+        if ( scenario != AArray_Expand )
+        {
+            hr = enumerator->Skip( enumerator->GetCount() / 2 );
+            if ( FAILED( hr ) )
+                return hr;
+        }
+
+        return EvaluateChildren( enumerator, AArrayPageSize );
+    }
+
+    static void RunAArrayScenario( 
+        const AArraySet& set, 
+        const char* name, 
+        AArrayScenario scenario, 
+        const DataObject& parentVal, 
+        IEEDEnumValues* repageEnum, 
+        BenchEnv& env, 
+        const Options& options )
+    {
+        Samples     samples;
+        uint64_t    hits = 0;
+
+        samples.Reserve( options.AAIterations );
+
+        uint64_t    allocStart = GetAllocCount();
+        uint64_t    byteStart = GetAllocBytes();
+        uint64_t    readStart = env.Program.GetReadCount();
+        uint64_t    wallStart = GetTicks();
+
+        for ( uint32_t i = 0; i < options.AAIterations; i++ )
+        {
+            uint64_t    start = GetTicks();
+            HRESULT     hr = RunAArrayOp( scenario, set, parentVal, repageEnum, env );
+
+            samples.Add( GetTicks() - start );
+            if ( hr == S_OK )
+                hits++;
+        }
+
+        uint64_t    wallTicks = GetTicks() - wallStart;
+        uint64_t    allocs = GetAllocCount() - allocStart;
+        uint64_t    bytes = GetAllocBytes() - byteStart;
+        uint64_t    reads = env.Program.GetReadCount() - readStart;
+
+        PrintResult( set.Name, name, samples, wallTicks, hits, allocs, bytes, reads );
+    }
+
+    // Looks up a key that moves along with the loop counter, the way a 
+    // condition on an element of an associative array does each time it's 
+    // tested. A key that's there has to come back with ten times itself, 
+    // and one that isn't has to come back as a null pointer.
+    static void RunAArrayLookup( 
+        const AArraySet& set, 
+        const char* name, 
+        const wchar_t* text, 
+        bool present, 
+        BenchEnv& env, 
+        const Options& options )
+    {
+        HRESULT                 hr = S_OK;
+        Samples                 samples;
+        uint64_t                hits = 0;
+        EvalOptions             evalOptions = { 0 };
+        RefPtr<IEEDParsedExpr>  expr;
+
+        hr = ParseText( text, env.TypeEnv, env.StrTable, expr.Ref() );
+        if ( SUCCEEDED( hr ) )
+            hr = expr->Bind( evalOptions, &env.Program );
+        if ( FAILED( hr ) )
+        {
+            PrintError( set.Name, text, hr );
+            return;
+        }
+
+        samples.Reserve( options.Iterations );
+
+        uint64_t    allocStart = GetAllocCount();
+        uint64_t    byteStart = GetAllocBytes();
+        uint64_t    readStart = env.Program.GetReadCount();
+        uint64_t    wallStart = GetTicks();
+
+        for ( uint32_t i = 0; i < options.Iterations; i++ )
+        {
+            uint32_t    key = i % set.Length;
+
+            env.Program.SetLoopCounter( key );
+
+            EvalResult  result = { 0 };
+            uint64_t    start = GetTicks();
+
+            hr = expr->Evaluate( evalOptions, &env.Program, result );
+
+            samples.Add( GetTicks() - start );
+            if ( hr != S_OK )
+                continue;
+
+            if ( present ? (result.ObjVal.Value.Int64Value == (int64_t) key * 10) 
+                : (result.ObjVal.Value.Addr == 0) )
+                hits++;
+        }
+
+        uint64_t    wallTicks = GetTicks() - wallStart;
+        uint64_t    allocs = GetAllocCount() - allocStart;
+        uint64_t    bytes = GetAllocBytes() - byteStart;
+        uint64_t    reads = env.Program.GetReadCount() - readStart;
+
+        PrintResult( set.Name, name, samples, wallTicks, hits, allocs, bytes, reads );
+    }
+
+    static void RunAArraySet( const AArraySet& set, BenchEnv& env, const Options& options )
+    {
+        HRESULT                 hr = S_OK;
+        RefPtr<IEEDParsedExpr>  expr;
+        RefPtr<IEEDEnumValues>  repageEnum;
+        EvalOptions             evalOptions = { 0 };
+        EvalResult              result = { 0 };
+
+        hr = env.Program.AddAArray( env.TypeEnv, set.VarName, set.AAVersion, set.BucketCount, set.Length );
+        if ( SUCCEEDED( hr ) )
+            hr = ParseText( set.VarName, env.TypeEnv, env.StrTable, expr.Ref() );
+        if ( SUCCEEDED( hr ) )
+            hr = expr->Bind( evalOptions, &env.Program );
+        if ( SUCCEEDED( hr ) )
+            hr = expr->Evaluate( evalOptions, &env.Program, result );
+        if ( SUCCEEDED( hr ) )
+            hr = EnumValueChildren( 
+                &env.Program, 
+                set.VarName, 
+                result.ObjVal, 
+                env.TypeEnv, 
+                env.StrTable, 
+                repageEnum.Ref() );
+        // go through the page once, the way the first time it's shown does
+        if ( SUCCEEDED( hr ) )
+            hr = repageEnum->Skip( repageEnum->GetCount() / 2 );
+        if ( SUCCEEDED( hr ) )
+            hr = EvaluateChildren( repageEnum, AArrayPageSize );
+
+        if ( FAILED( hr ) )
+        {
+            PrintError( set.Name, set.VarName, hr );
+            return;
+        }
+
+        JsonLine    fixtureLine( "fixture" );
+
+        fixtureLine.Add( "fixture", set.Name );
+        fixtureLine.Add( "aa_version", (uint32_t) set.AAVersion );
+        fixtureLine.Add( "buckets", set.BucketCount );
+        fixtureLine.Add( "length", set.Length );
+        fixtureLine.Add( "timer_overhead_ns", TicksToNanoseconds( GetTimerOverhead() ) );
+        fixtureLine.Print();
+
+        RunAArrayScenario( set, "expand", AArray_Expand, result.ObjVal, repageEnum, env, options );
+        RunAArrayScenario( set, "page_middle", AArray_PageMiddle, result.ObjVal, repageEnum, env, options );
+        RunAArrayScenario( set, "repage_middle", AArray_Repage, result.ObjVal, repageEnum, env, options );
+        RunAArrayScenario( set, "expand_all", AArray_All, result.ObjVal, repageEnum, env, options );
+
+        // keys run from 0 to the length, so this is above any of them
+        std::wstring    hitText = std::wstring( set.VarName ) + L"[i]";
+        std::wstring    missText = L"(i + 0x40000000) in " + std::wstring( set.VarName );
+
+        RunAArrayLookup( set, "lookup", hitText.c_str(), true, env, options );
+        RunAArrayLookup( set, "lookup_miss", missText.c_str(), false, env, options );
+    }
+
+    static HRESULT InitEnv( BenchEnv& env )
+    {
+        HRESULT     hr = S_OK;
+
+        hr = MakeTypeEnv( BenchProgram::PtrSize, env.TypeEnv.Ref() );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = MakeNameTable( env.StrTable.Ref() );
+        if ( FAILED( hr ) )
+            return hr;
+
+        return env.Program.Init( env.TypeEnv );
+    }
+
+    static HRESULT Run( const Options& options )
+    {
+        HRESULT     hr = S_OK;
+        BenchEnv    env;
+
+        hr = InitEnv( env );
+        if ( FAILED( hr ) )
+            return hr;
+
+        for ( size_t i = 0; i < _countof( gExprSets ); i++ )
+        {
+            RunExprSet( gExprSets[i], env, options );
+        }
+
+        for ( size_t i = 0; i < _countof( gAArraySets ); i++ )
+        {
+            RunAArraySet( gAArraySets[i], env, options );
+        }
+
+        return S_OK;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  Command line
+    //------------------------------------------------------------------------
+
+    static void PrintUsage()
+    {
+        fprintf( stderr,
+            "Usage:\n"
+            "  EEDBench [options]\n"
+            "\n"
+            "Options:\n"
+            "  -iterations N   times each expression set is run (1000)\n"
+            "  -aaiterations N times each associative array is expanded (10)\n" );
+    }
+
+    static bool ParseOptions( int argc, wchar_t* argv[], int first, Options& options )
+    {
+        memset( &options, 0, sizeof options );
+        options.Iterations = 1000;
+        options.AAIterations = 10;
+
+        for ( int i = first; i < argc; i += 2 )
+        {
+            const wchar_t*  name = argv[i];
+            uint32_t        value = 0;
+
+            if ( (i + 1) >= argc )
+                return false;
+
+            value = wcstoul( argv[i + 1], NULL, 10 );
+
+            if ( wcscmp( name, L"-iterations" ) == 0 )       options.Iterations = std::max<uint32_t>( value, 1 );
+            else if ( wcscmp( name, L"-aaiterations" ) == 0 ) options.AAIterations = std::max<uint32_t>( value, 1 );
+            else
+                return false;
+        }
+
+        return true;
+    }
+}
+
+
+int wmain( int argc, wchar_t* argv[] )
+{
+    Options     options;
+    HRESULT     hr = S_OK;
+
+    if ( !ParseOptions( argc, argv, 1, options ) )
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    hr = MagoEE::Init();
+    if ( SUCCEEDED( hr ) )
+    {
+        hr = Run( options );
+        MagoEE::Uninit();
+    }
+
+    if ( FAILED( hr ) )
+    {
+        fprintf( stderr, "EEDBench failed: %08x\n", hr );
+        return 1;
+    }
+
+    return 0;
+}
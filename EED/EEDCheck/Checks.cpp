@@ -0,0 +1,781 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#include "Common.h"
+#include "Checks.h"
+#include "..\EEDBench\BenchProgram.h"
+#include <BenchCommon.h>
+#include "..\EED\Scanner.h"
+#include "..\EED\Parser.h"
+#include "..\EED\Expression.h"
+#include "..\EED\Bytecode.h"
+
+using namespace MagoEE;
+using namespace MagoBench;
+using namespace EEDBench;
+
+
+namespace EEDCheck
+{
+    //------------------------------------------------------------------------
+    //  CheckResults
+    //------------------------------------------------------------------------
+
+    CheckResults::CheckResults( const char* name )
+        :   mName( name ),
+            mCases( 0 ),
+            mFailures( 0 )
+    {
+    }
+
+    bool CheckResults::Expect( bool passed, const char* caseName )
+    {
+        mCases++;
+
+        if ( !passed )
+        {
+            mFailures++;
+            fprintf( stderr, "%s: %s failed\n", mName, caseName );
+        }
+
+        return passed;
+    }
+
+    uint32_t CheckResults::GetFailures() const
+    {
+        return mFailures;
+    }
+
+    void CheckResults::Print()
+    {
+        printf( "%-10s %5u cases %5u failed\n", mName, mCases, mFailures );
+    }
+
+
+    //------------------------------------------------------------------------
+    //  ReadPlan
+    //------------------------------------------------------------------------
+
+    // Memory from Base to Limit, with a hole that can't be read. Reads stop
+    // at the hole or the limit, and the blocks that were asked for are kept.
+    class CheckMemoryReader : public IMemoryReader
+    {
+    public:
+        static const Address    Base = 0x10000;
+        static const Address    Limit = 0x11000;
+
+        struct Block
+        {
+            Address     Addr;
+            uint32_t    Size;
+        };
+
+    private:
+        Address                 mHoleStart;
+        Address                 mHoleEnd;
+        std::vector<Block>      mBlocks;
+
+    public:
+        CheckMemoryReader()
+            :   mHoleStart( 0 ),
+                mHoleEnd( 0 )
+        {
+        }
+
+        void SetHole( Address start, Address end )
+        {
+            mHoleStart = start;
+            mHoleEnd = end;
+        }
+
+        static uint8_t GetByte( Address addr )
+        {
+            return (uint8_t) (addr * 7 + (addr >> 8));
+        }
+
+        bool IsReadable( Address addr ) const
+        {
+            return (addr >= Base) && (addr < Limit)
+                && ((addr < mHoleStart) || (addr >= mHoleEnd));
+        }
+
+        const std::vector<Block>& GetBlocks() const
+        {
+            return mBlocks;
+        }
+
+        void ClearBlocks()
+        {
+            mBlocks.clear();
+        }
+
+        virtual HRESULT ReadMemory( Address addr, uint32_t sizeToRead, uint32_t& sizeRead, uint8_t* buffer )
+        {
+            Block   block = { addr, sizeToRead };
+
+            mBlocks.push_back( block );
+
+            for ( sizeRead = 0; sizeRead < sizeToRead; sizeRead++ )
+            {
+                if ( !IsReadable( addr + sizeRead ) )
+                    break;
+
+                buffer[sizeRead] = GetByte( addr + sizeRead );
+            }
+
+            if ( (sizeRead == 0) && (sizeToRead > 0) )
+                return HRESULT_FROM_WIN32( ERROR_PARTIAL_COPY );
+
+            return S_OK;
+        }
+    };
+
+    // The pieces for a check, with a buffer each.
+    class CheckReads
+    {
+        std::vector<MemoryRead>             mReads;
+        std::vector< std::vector<uint8_t> > mBuffers;
+
+    public:
+        void Add( Address addr, uint32_t size )
+        {
+            MemoryRead  read = { addr, size, NULL, 0 };
+
+            mReads.push_back( read );
+            mBuffers.push_back( std::vector<uint8_t>( size + 1 ) );
+        }
+
+        MemoryRead* Get()
+        {
+            for ( size_t i = 0; i < mReads.size(); i++ )
+                mReads[i].Buffer = &mBuffers[i][0];
+
+            return &mReads[0];
+        }
+
+        uint32_t GetCount() const
+        {
+            return (uint32_t) mReads.size();
+        }
+
+        // Whether the piece has sizeRead bytes and they're the right ones.
+        bool IsRead( uint32_t index, uint32_t sizeRead ) const
+        {
+            const MemoryRead&   read = mReads[index];
+
+            if ( read.SizeRead != sizeRead )
+                return false;
+
+            for ( uint32_t i = 0; i < sizeRead; i++ )
+            {
+                if ( read.Buffer[i] != CheckMemoryReader::GetByte( read.Addr + i ) )
+                    return false;
+            }
+
+            return true;
+        }
+    };
+
+    static bool HasBlock( const CheckMemoryReader& reader, uint32_t index, Address addr, uint32_t size )
+    {
+        const std::vector<CheckMemoryReader::Block>&  blocks = reader.GetBlocks();
+
+        return (index < blocks.size()) 
+            && (blocks[index].Addr == addr) 
+            && (blocks[index].Size == size);
+    }
+
+    HRESULT CheckReadPlan()
+    {
+        const Address       Base = CheckMemoryReader::Base;
+        const uint32_t      MaxGap = 16;
+        const uint32_t      MaxSize = 256;
+        CheckResults        results( "read_plan" );
+
+        // close pieces, given out of order and overlapping, take one read
+        {
+            CheckMemoryReader   reader;
+            ReadPlan            plan( MaxGap, MaxSize );
+            CheckReads          reads;
+
+            reads.Add( Base + 0x24, 4 );
+            reads.Add( Base, 8 );
+            reads.Add( Base + 4, 8 );
+            reads.Add( Base + 0x10, 0 );
+            // as far past the end of the ones before it as a gap can be
+            reads.Add( Base + 0xC + MaxGap, 4 );
+
+            results.Expect( plan.Read( &reader, reads.Get(), reads.GetCount() ) == S_OK, "merge" );
+            results.Expect( plan.GetRangeCount() == 1, "merge: ranges" );
+            results.Expect( reader.GetBlocks().size() == 1, "merge: reads" );
+            results.Expect( HasBlock( reader, 0, Base, 0x28 ), "merge: block" );
+            results.Expect( reads.IsRead( 0, 4 ) && reads.IsRead( 1, 8 ) && reads.IsRead( 2, 8 ), "merge: pieces" );
+            results.Expect( reads.IsRead( 3, 0 ) && reads.IsRead( 4, 4 ), "merge: empty piece" );
+        }
+
+        // a gap bigger than the most allowed starts another range
+        {
+            CheckMemoryReader   reader;
+            ReadPlan            plan( MaxGap, MaxSize );
+            CheckReads          reads;
+
+            reads.Add( Base, 4 );
+            reads.Add( Base + 4 + MaxGap + 1, 4 );
+
+            results.Expect( plan.Read( &reader, reads.Get(), reads.GetCount() ) == S_OK, "gap" );
+            results.Expect( plan.GetRangeCount() == 2, "gap: ranges" );
+            results.Expect( HasBlock( reader, 0, Base, 4 ) && HasBlock( reader, 1, Base + 4 + MaxGap + 1, 4 ), "gap: blocks" );
+            results.Expect( reads.IsRead( 0, 4 ) && reads.IsRead( 1, 4 ), "gap: pieces" );
+        }
+
+        // a range doesn't grow past the most allowed size
+        {
+            CheckMemoryReader   reader;
+            ReadPlan            plan( MaxGap, MaxSize );
+            CheckReads          reads;
+
+            reads.Add( Base, MaxSize - 8 );
+            reads.Add( Base + MaxSize - 8, 8 );
+            reads.Add( Base + MaxSize, 8 );
+
+            results.Expect( plan.Read( &reader, reads.Get(), reads.GetCount() ) == S_OK, "max size" );
+            results.Expect( plan.GetRangeCount() == 2, "max size: ranges" );
+            results.Expect( HasBlock( reader, 0, Base, MaxSize ) && HasBlock( reader, 1, Base + MaxSize, 8 ), "max size: blocks" );
+            results.Expect( reads.IsRead( 0, MaxSize - 8 ) && reads.IsRead( 1, 8 ) && reads.IsRead( 2, 8 ), "max size: pieces" );
+        }
+
+        // a hole in a range: the range comes back short, and the pieces it 
+        // didn't cover are read again on their own
+        {
+            CheckMemoryReader   reader;
+            ReadPlan            plan( MaxGap, MaxSize );
+            CheckReads          reads;
+
+            reader.SetHole( Base + 0x10, Base + 0x20 );
+            reads.Add( Base, 8 );
+            reads.Add( Base + 0xC, 8 );
+            reads.Add( Base + 0x18, 4 );
+            reads.Add( Base + 0x20, 8 );
+
+            results.Expect( plan.Read( &reader, reads.Get(), reads.GetCount() ) == S_OK, "short read" );
+            results.Expect( plan.GetRangeCount() == 1, "short read: ranges" );
+            results.Expect( reader.GetBlocks().size() == 4, "short read: reads" );
+            results.Expect( HasBlock( reader, 0, Base, 0x28 ), "short read: range block" );
+            results.Expect( HasBlock( reader, 1, Base + 0xC, 8 )
+                && HasBlock( reader, 2, Base + 0x18, 4 )
+                && HasBlock( reader, 3, Base + 0x20, 8 ), "short read: piece blocks" );
+            results.Expect( reads.IsRead( 0, 8 ), "short read: before the hole" );
+            results.Expect( reads.IsRead( 1, 4 ), "short read: into the hole" );
+            results.Expect( reads.IsRead( 2, 0 ), "short read: in the hole" );
+            results.Expect( reads.IsRead( 3, 8 ), "short read: past the hole" );
+        }
+
+        // a piece on its own that runs off the end is read as far as it can be
+        {
+            CheckMemoryReader   reader;
+            ReadPlan            plan( MaxGap, MaxSize );
+            CheckReads          reads;
+
+            reads.Add( CheckMemoryReader::Limit - 4, 8 );
+            reads.Add( CheckMemoryReader::Limit + MaxGap + 8, 4 );
+
+            results.Expect( plan.Read( &reader, reads.Get(), reads.GetCount() ) == S_OK, "end" );
+            results.Expect( reader.GetBlocks().size() == 2, "end: reads" );
+            results.Expect( reads.IsRead( 0, 4 ), "end: partly readable" );
+            results.Expect( reads.IsRead( 1, 0 ), "end: unreadable" );
+        }
+
+        // the plan is reused from one read to the next
+        {
+            CheckMemoryReader   reader;
+            ReadPlan            plan( MaxGap, MaxSize );
+            CheckReads          first;
+            CheckReads          second;
+
+            first.Add( Base, 4 );
+            first.Add( Base + 8, 4 );
+            second.Add( Base + 0x100, 2 );
+            second.Add( Base + 0x104, 2 );
+
+            plan.Read( &reader, first.Get(), first.GetCount() );
+            reader.ClearBlocks();
+
+            results.Expect( plan.Read( &reader, second.Get(), second.GetCount() ) == S_OK, "reuse" );
+            results.Expect( (plan.GetRangeCount() == 1) && HasBlock( reader, 0, Base + 0x100, 6 ), "reuse: block" );
+            results.Expect( second.IsRead( 0, 2 ) && second.IsRead( 1, 2 ), "reuse: pieces" );
+        }
+
+        results.Print();
+
+        return results.GetFailures() == 0 ? S_OK : E_FAIL;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  Bytecode
+    //------------------------------------------------------------------------
+
+    // Each of these has to compile, even if parts of it are still walked, so
+    // that there's code to compare.
+    const wchar_t*  gBytecodeTexts[] = 
+    {
+        // promotions
+        L"cast(byte) -a + cast(ubyte) b", 
+        L"cast(short) -a * cast(ushort) 3", 
+        L"cast(ubyte) 0xff + 1", 
+        L"cast(byte) 0x80 + cast(byte) 0x80", 
+        L"cast(ushort) -1 + a", 
+        L"cast(long) -a + b", 
+        L"cast(ulong) a * i", 
+        L"-a / 5", 
+        L"-a % 5", 
+        L"cast(uint) -a / 5", 
+        L"~cast(ubyte) a", 
+        L"-i", 
+        L"+cast(short) -a", 
+        // signed and unsigned compares
+        L"-1 < cast(uint) 1", 
+        L"-a < i", 
+        L"cast(uint) -a > b", 
+        L"a < cast(ulong) b", 
+        L"cast(byte) -1 == 0xff", 
+        L"cast(ubyte) -1 == 255", 
+        L"cast(int) -1 >= cast(uint) 0", 
+        L"cast(short) -1 < cast(ushort) 1", 
+        L"i != -1", 
+        // shifts
+        L"a << 3", 
+        L"-a >> 2", 
+        L"-a >>> 2", 
+        L"cast(ubyte) 0x80 >> 3", 
+        L"cast(byte) -128 >>> 1", 
+        L"cast(short) -2 >>> 1", 
+        L"1 << 31", 
+        L"cast(long) 1 << 40", 
+        L"a << i % 32", 
+        L"i >> 1 | a", 
+        L"(i ^ a) & 0xf", 
+        // pointers
+        L"p + 3 - p", 
+        L"&sa[5] - &sa[1]", 
+        L"cast(short*) (p + 3) - cast(short*) p", 
+        L"p - 2", 
+        L"2 + p", 
+        L"*(p + i % 8)", 
+        L"p < p + 1", 
+        L"p == *pp", 
+        L"&sa[i % 8] - &sa[0]", 
+        // casts
+        L"cast(bool) a", 
+        L"cast(bool) p", 
+        L"cast(bool) (i & 1)", 
+        L"cast(ulong) -a", 
+        L"cast(byte) 300", 
+        L"cast(int*) a", 
+        L"cast(uint) p", 
+        L"cast(ushort) -1", 
+        L"cast(char) (a + 0x100)", 
+        L"cast(long) cast(uint) -a", 
+        // $ in indexes
+        L"arr[$ - 1] + a", 
+        L"sa[$ - 2] * 2", 
+        L"str[$ - 1] == 'o'", 
+        L"arr[$ / 2] + arr[0]", 
+        L"sa[$ - 1 - i % 8] + 1", 
+        // the rest
+        L"!a || b", 
+        L"i % 3 == 0 && a > 1", 
+        L"(a > i) + (b < i)", 
+        L"sa[2] * a - arr[1]", 
+        L"**pp + 1", 
+        L"d * i > 1000.0 || i == 3", 
+    };
+
+    // the loop counter's values that each expression is evaluated with
+    const uint32_t  gBytecodeCounters[] = { 0, 1, 7, 33, 500, 0xffffffff };
+
+    static HRESULT BindExpr( 
+        const wchar_t* text, 
+        ITypeEnv* typeEnv, 
+        NameTable* strTable, 
+        IValueBinder* binder, 
+        ObjectArena* arena, 
+        RefPtr<Expression>& expr )
+    {
+        HRESULT     hr = S_OK;
+        Scanner     scanner( text, wcslen( text ), strTable );
+        Parser      parser( &scanner, typeEnv, arena );
+        EvalData    evalData = { 0 };
+
+        try
+        {
+            scanner.NextToken();
+            expr = parser.ParseExpression();
+
+            if ( scanner.GetToken().Code != TOKeof )
+                return E_MAGOEE_SYNTAX_ERROR;
+        }
+        catch ( int errCode )
+        {
+            UNREFERENCED_PARAMETER( errCode );
+            return E_MAGOEE_SYNTAX_ERROR;
+        }
+
+        evalData.TypeEnv = typeEnv;
+
+        hr = expr->Semantic( evalData, typeEnv, binder );
+        if ( FAILED( hr ) )
+            return hr;
+
+        return S_OK;
+    }
+
+    static bool IsSameResult( HRESULT hrCode, const DataObject& code, HRESULT hrTree, const DataObject& tree )
+    {
+        if ( hrCode != hrTree )
+            return false;
+        if ( FAILED( hrCode ) )
+            return true;
+
+        if ( (code._Type == NULL) || (tree._Type == NULL) )
+            return code._Type == tree._Type;
+
+        return code._Type->Equals( tree._Type )
+            && (code.Addr == tree.Addr)
+            && (memcmp( &code.Value, &tree.Value, sizeof code.Value ) == 0);
+    }
+
+    HRESULT CheckBytecode( ITypeEnv* typeEnv, NameTable* strTable, BenchProgram& program )
+    {
+        CheckResults    results( "bytecode" );
+        std::string     caseName;
+
+        for ( size_t i = 0; i < _countof( gBytecodeTexts ); i++ )
+        {
+            HRESULT             hr = S_OK;
+            RefPtr<ObjectArena> arena = new ObjectArena();
+            RefPtr<Expression>  expr;
+            BytecodeCompiler    compiler( typeEnv );
+            Bytecode*           rawCode = NULL;
+            UniquePtr<Bytecode> code;
+
+            caseName = ToUtf8( gBytecodeTexts[i] );
+
+            hr = BindExpr( gBytecodeTexts[i], typeEnv, strTable, &program, arena, expr );
+            if ( !results.Expect( hr == S_OK, (caseName + ": bind").c_str() ) )
+                continue;
+
+            hr = compiler.Compile( expr, rawCode );
+            if ( !results.Expect( hr == S_OK, (caseName + ": compile").c_str() ) )
+                continue;
+
+            code.Attach( rawCode );
+
+            for ( size_t j = 0; j < _countof( gBytecodeCounters ); j++ )
+            {
+                EvalData    evalData = { 0 };
+                DataObject  codeObj = { 0 };
+                DataObject  treeObj = { 0 };
+                HRESULT     hrCode = S_OK;
+                HRESULT     hrTree = S_OK;
+                char        counter[32] = "";
+
+                evalData.TypeEnv = typeEnv;
+                program.SetLoopCounter( gBytecodeCounters[j] );
+
+                hrCode = code->Run( evalData, &program, codeObj );
+                hrTree = expr->Evaluate( EvalMode_Value, evalData, &program, treeObj );
+
+                sprintf_s( counter, ": i = %u", gBytecodeCounters[j] );
+
+                results.Expect( IsSameResult( hrCode, codeObj, hrTree, treeObj ), (caseName + counter).c_str() );
+            }
+        }
+
+        program.SetLoopCounter( 0 );
+        results.Print();
+
+        return results.GetFailures() == 0 ? S_OK : E_FAIL;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  Associative array key hashes
+    //------------------------------------------------------------------------
+
+    // Hashes keys with an AArrayLookup for each pointer width, and compares
+    // the hashes with what druntime gives.
+    class KeyHashChecker
+    {
+        CheckResults&   mResults;
+        BenchProgram&   mProgram;
+        AArrayLookup    mLookup32;
+        AArrayLookup    mLookup64;
+
+    public:
+        KeyHashChecker( CheckResults& results, BenchProgram& program )
+            :   mResults( results ),
+                mProgram( program ),
+                mLookup32( 4 ),
+                mLookup64( 8 )
+        {
+        }
+
+        void Check( 
+            const char* name, 
+            Type* type, 
+            Address addr, 
+            const DataValue& value, 
+            Address keyTypeInfo, 
+            uint64_t hash32, 
+            uint64_t hash64 )
+        {
+            DataObject  key = { 0 };
+            uint64_t    hash = 0;
+            HRESULT     hr = S_OK;
+            std::string caseName( name );
+
+            key._Type = type;
+            key.Addr = addr;
+            key.Value = value;
+
+            hr = mLookup32.GetKeyHash( &mProgram, key, keyTypeInfo, hash );
+            mResults.Expect( (hr == S_OK) && (hash == hash32), (caseName + ": 32-bit").c_str() );
+
+            hr = mLookup64.GetKeyHash( &mProgram, key, keyTypeInfo, hash );
+            mResults.Expect( (hr == S_OK) && (hash == hash64), (caseName + ": 64-bit").c_str() );
+        }
+
+        void CheckValue( const char* name, Type* type, const DataValue& value, uint64_t hash32, uint64_t hash64 )
+        {
+            Check( name, type, 0, value, 0, hash32, hash64 );
+        }
+
+        void CheckInt( const char* name, Type* type, int64_t n, uint64_t hash32, uint64_t hash64 )
+        {
+            DataValue   value = { 0 };
+
+            value.Int64Value = n;
+            CheckValue( name, type, value, hash32, hash64 );
+        }
+
+        void CheckArray( 
+            const char* name, 
+            Type* type, 
+            const void* elems, 
+            uint32_t length, 
+            uint64_t hash32, 
+            uint64_t hash64 )
+        {
+            uint32_t    size = length * type->AsTypeNext()->GetNext()->GetSize();
+            DataValue   value = { 0 };
+
+            value.Array.Length = length;
+            value.Array.Addr = mProgram.AddBlock( elems, size );
+            CheckValue( name, type, value, hash32, hash64 );
+        }
+
+        // for static arrays and structs
+        void CheckObject( 
+            const char* name, 
+            Type* type, 
+            const void* data, 
+            Address keyTypeInfo, 
+            uint64_t hash32, 
+            uint64_t hash64 )
+        {
+            DataValue   value = { 0 };
+            Address     addr = mProgram.AddBlock( data, type->GetSize() );
+
+            Check( name, type, addr, value, keyTypeInfo, hash32, hash64 );
+        }
+    };
+
+    // The hashes were worked out apart from the EED, from druntime's hashOf
+    // in rt/util/hash.d and the getHash methods of the TypeInfo classes, as
+    // they were up to the open addressing layout. A struct S5 or S7 is that
+    // many bytes, without a toHash.
+    HRESULT CheckKeyHashes( ITypeEnv* typeEnv, BenchProgram& program )
+    {
+        HRESULT         hr = S_OK;
+        CheckResults    results( "key_hash" );
+        KeyHashChecker  checker( results, program );
+        DataValue       value = { 0 };
+        RefPtr<Type>    ptrType;
+        RefPtr<Type>    delegateType;
+        RefPtr<Type>    funcType;
+        RefPtr<ParameterList>   params;
+        RefPtr<Declaration>     s5Decl;
+        RefPtr<Declaration>     s7Decl;
+        RefPtr<Type>    s5Type;
+        RefPtr<Type>    s7Type;
+        RefPtr<Type>    bytes5Type;
+        RefPtr<Type>    bytes7Type;
+        RefPtr<Type>    charArrayType;
+        RefPtr<Type>    wcharArrayType;
+        RefPtr<Type>    intArrayType;
+        RefPtr<Type>    s5ArrayType;
+        RefPtr<Type>    int3Type;
+        RefPtr<Type>    short2Type;
+        RefPtr<Type>    s5x2Type;
+
+        // the basic types
+
+        checker.CheckInt( "byte -5", typeEnv->GetType( Tint8 ), -5, 0xfffffffb, 0xfffffffffffffffb );
+        checker.CheckInt( "ubyte 200", typeEnv->GetType( Tuns8 ), 200, 0xc8, 0xc8 );
+        checker.CheckInt( "short -300", typeEnv->GetType( Tint16 ), -300, 0xfffffed4, 0xfffffffffffffed4 );
+        checker.CheckInt( "ushort 60000", typeEnv->GetType( Tuns16 ), 60000, 0xea60, 0xea60 );
+        checker.CheckInt( "int -7", typeEnv->GetType( Tint32 ), -7, 0xfffffff9, 0xfffffff9 );
+        checker.CheckInt( "uint 0xdeadbeef", typeEnv->GetType( Tuns32 ), 0xdeadbeef, 0xdeadbeef, 0xdeadbeef );
+        checker.CheckInt( "long 0x0123456789abcdef", typeEnv->GetType( Tint64 ), 0x0123456789abcdefLL, 0x24baf957, 0x45d13242b8aab093ULL );
+        checker.CheckInt( "long -1", typeEnv->GetType( Tint64 ), -1, 0xf36cd681, 0x51961384ebc6abceULL );
+        checker.CheckInt( "ulong 0xfedcba9876543210", typeEnv->GetType( Tuns64 ), 0xfedcba9876543210LL, 0xd434af1f, 0xa930bf7d6ee023b6ULL );
+        checker.CheckInt( "bool true", typeEnv->GetType( Tbool ), 1, 1, 1 );
+        checker.CheckInt( "char 'A'", typeEnv->GetType( Tchar ), 'A', 0x41, 0x41 );
+        checker.CheckInt( "wchar 0x263a", typeEnv->GetType( Twchar ), 0x263a, 0x263a, 0x263a );
+        checker.CheckInt( "dchar 0x1f600", typeEnv->GetType( Tdchar ), 0x1f600, 0x1f600, 0x1f600 );
+
+        value.Float80Value.FromFloat( 1.5f );
+        checker.CheckValue( "float 1.5", typeEnv->GetType( Tfloat32 ), value, 0x3fc00000, 0x3fc00000 );
+        value.Float80Value.FromFloat( -0.0f );
+        checker.CheckValue( "float -0.0", typeEnv->GetType( Tfloat32 ), value, 0x80000000, 0x80000000 );
+        value.Float80Value.FromFloat( -2.5f );
+        checker.CheckValue( "ifloat -2.5", typeEnv->GetType( Timaginary32 ), value, 0xc0200000, 0xc0200000 );
+        value.Float80Value.FromDouble( 2.25 );
+        checker.CheckValue( "double 2.25", typeEnv->GetType( Tfloat64 ), value, 0x1c2ba046, 0x02815843842c2246ULL );
+        value.Float80Value.FromDouble( -0.5 );
+        checker.CheckValue( "idouble -0.5", typeEnv->GetType( Timaginary64 ), value, 0x3b61ab01, 0x0551e55b8f62af01ULL );
+        value.Float80Value.FromDouble( 1.0 );
+        checker.CheckValue( "real 1.0", typeEnv->GetType( Tfloat80 ), value, 0x1b935f8a, 0x721c172d50ed612dULL );
+        value.Float80Value.FromDouble( -3.0 );
+        checker.CheckValue( "ireal -3.0", typeEnv->GetType( Timaginary80 ), value, 0xa1bd059d, 0xc329d31ab14c689eULL );
+
+        value.Complex80Value.RealPart.FromFloat( 1.5f );
+        value.Complex80Value.ImaginaryPart.FromFloat( -2.0f );
+        checker.CheckValue( "cfloat 1.5 - 2i", typeEnv->GetType( Tcomplex32 ), value, 0x02775818, 0x3ac6efd38735030aULL );
+        value.Complex80Value.RealPart.FromDouble( 2.25 );
+        value.Complex80Value.ImaginaryPart.FromDouble( 0.5 );
+        checker.CheckValue( "cdouble 2.25 + 0.5i", typeEnv->GetType( Tcomplex64 ), value, 0x6dc26863, 0x678c91e57a833cf8ULL );
+        value.Complex80Value.RealPart.FromDouble( 1.0 );
+        value.Complex80Value.ImaginaryPart.FromDouble( -1.0 );
+        checker.CheckValue( "creal 1 - 1i", typeEnv->GetType( Tcomplex80 ), value, 0x050902fc, 0x5be3d52c999396caULL );
+
+        // pointers and delegates
+
+        hr = typeEnv->NewPointer( typeEnv->GetType( Tint32 ), ptrType.Ref() );
+        if ( FAILED( hr ) )
+            return hr;
+
+        memset( &value, 0, sizeof value );
+        value.Addr = 0x12345678;
+        checker.CheckValue( "pointer", ptrType, value, 0x12345678, 0x12345678 );
+
+        hr = typeEnv->NewParams( params.Ref() );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = typeEnv->NewFunction( typeEnv->GetType( Tvoid ), params, 0, funcType.Ref() );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = typeEnv->NewDelegate( funcType, delegateType.Ref() );
+        if ( FAILED( hr ) )
+            return hr;
+
+        memset( &value, 0, sizeof value );
+        value.Delegate.ContextAddr = 0x1000;
+        value.Delegate.FuncAddr = 0x401000;
+        checker.CheckValue( "delegate", delegateType, value, 0x489c40f6, 0x007f29d87794cbd1ULL );
+
+        // structs
+
+        hr = typeEnv->NewSArray( typeEnv->GetType( Tuns8 ), 5, bytes5Type.Ref() );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = typeEnv->NewSArray( typeEnv->GetType( Tuns8 ), 7, bytes7Type.Ref() );
+        if ( FAILED( hr ) )
+            return hr;
+
+        s5Decl = new BenchVar( L"S5", bytes5Type, 0 );
+        s7Decl = new BenchVar( L"S7", bytes7Type, 0 );
+
+        hr = typeEnv->NewStruct( s5Decl, s5Type.Ref() );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = typeEnv->NewStruct( s7Decl, s7Type.Ref() );
+        if ( FAILED( hr ) )
+            return hr;
+
+        // a TypeInfo_Struct without toHash or opCmp, for either pointer width
+        const uint8_t   typeInfo[128] = { 0 };
+        Address         typeInfoAddr = program.AddBlock( typeInfo, sizeof typeInfo );
+
+        const uint8_t   s5[] = { 1, 2, 3, 4, 5 };
+        const uint8_t   s7[] = { 0x10, 0x20, 0x30, 0x40, 0x50, 0x60, 0x70 };
+
+        checker.CheckObject( "S5", s5Type, s5, typeInfoAddr, 0xba4562bc, 0x68da7a96d5cc201cULL );
+        checker.CheckObject( "S7", s7Type, s7, typeInfoAddr, 0xfdcd21ed, 0x1f9a0cf022e5265aULL );
+
+        // dynamic arrays
+
+        hr = typeEnv->NewDArray( typeEnv->GetType( Tchar ), charArrayType.Ref() );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = typeEnv->NewDArray( typeEnv->GetType( Twchar ), wcharArrayType.Ref() );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = typeEnv->NewDArray( typeEnv->GetType( Tint32 ), intArrayType.Ref() );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = typeEnv->NewDArray( s5Type, s5ArrayType.Ref() );
+        if ( FAILED( hr ) )
+            return hr;
+
+        const char      hello[] = "hello";
+        const char      fox[] = "the quick brown fox jumps over the lazy dog";
+        const uint16_t  hi[] = { 'h', 'i', '!' };
+        const int32_t   ints[] = { 1, 2, 3 };
+        const uint8_t   s5s[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+
+        checker.CheckArray( "char[] hello", charArrayType, hello, 5, 0x00198126, 0x00198126 );
+        checker.CheckArray( "char[] fox", charArrayType, fox, 43, 0x9e74390f, 0xad672b509e74390fULL );
+        checker.CheckArray( "wchar[] hi!", wcharArrayType, hi, 3, 0x4f1aa0b5, 0x819931720a018383ULL );
+        checker.CheckArray( "int[] 1 2 3", intArrayType, ints, 3, 0xcdd7a389, 0x66057670dd871bb7ULL );
+        // druntime hashes as many bytes as there are elements
+        checker.CheckArray( "S5[] 2", s5ArrayType, s5s, 2, 0x18387553, 0x001400eaa0387553ULL );
+
+        // static arrays, whose hashes are the sums of their elements'
+
+        hr = typeEnv->NewSArray( typeEnv->GetType( Tint32 ), 3, int3Type.Ref() );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = typeEnv->NewSArray( typeEnv->GetType( Tint16 ), 2, short2Type.Ref() );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = typeEnv->NewSArray( s5Type, 2, s5x2Type.Ref() );
+        if ( FAILED( hr ) )
+            return hr;
+
+        const int32_t   int3[] = { 1, -2, 3 };
+        const int16_t   short2[] = { -1, 2 };
+
+        checker.CheckObject( "int[3] 1 -2 3", int3Type, int3, 0, 0x00000002, 0x0000000100000002ULL );
+        checker.CheckObject( "short[2] -1 2", short2Type, short2, 0, 0x00000001, 0x00000001 );
+        checker.CheckObject( "S5[2]", s5x2Type, s5s, 0, 0x9b5fd013, 0x8043785d8d4f522bULL );
+
+        results.Print();
+
+        return results.GetFailures() == 0 ? S_OK : E_FAIL;
+    }
+}
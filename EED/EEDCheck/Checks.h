@@ -0,0 +1,50 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+
+namespace EEDBench
+{
+    class BenchProgram;
+}
+
+
+namespace EEDCheck
+{
+    // Counts the cases of a check, and reports the ones that fail.
+    class CheckResults
+    {
+        const char*     mName;
+        uint32_t        mCases;
+        uint32_t        mFailures;
+
+    public:
+        CheckResults( const char* name );
+
+        // Counts a case, and prints its name if it failed.
+        bool Expect( bool passed, const char* caseName );
+
+        uint32_t GetFailures() const;
+
+        // Prints a line for the check with how many cases failed.
+        void Print();
+    };
+
+    // Checks how ReadPlan merges pieces into ranges, keeps gaps apart, and
+    // reads the pieces of a range that comes back short on their own.
+    HRESULT CheckReadPlan();
+
+    // Checks that each expression's compiled code gives the same type,
+    // address, and value bytes as walking its tree, for a few values of the
+    // loop counter.
+    HRESULT CheckBytecode( MagoEE::ITypeEnv* typeEnv, MagoEE::NameTable* strTable, EEDBench::BenchProgram& program );
+
+    // Checks the hashes of associative array keys of each kind against
+    // what druntime gives for them, for 32-bit and 64-bit programs.
+    HRESULT CheckKeyHashes( MagoEE::ITypeEnv* typeEnv, EEDBench::BenchProgram& program );
+}
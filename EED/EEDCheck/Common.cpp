@@ -0,0 +1,8 @@
+// Common.cpp : source file that includes just the standard includes
+// EEDCheck.pch will be the pre-compiled header
+// Common.obj will contain the pre-compiled type information
+
+#include "Common.h"
+
+// TODO: reference any additional headers you need in STDAFX.H
+// and not in this file
@@ -0,0 +1,46 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+// stdafx.h : include file for standard system include files,
+// or project specific include files that are used frequently, but
+// are changed infrequently
+//
+
+#pragma once
+
+#include "targetver.h"
+
+#define WIN32_LEAN_AND_MEAN             // Exclude rarely-used stuff from Windows headers
+
+// C
+#include <stdio.h>
+#include <stdlib.h>
+#include <crtdbg.h>
+#include <inttypes.h>
+
+// STL
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+// Windows
+#include <windows.h>
+
+// Magus
+#include <SmartPtr.h>
+
+// EED project
+#include "..\Real\Real.h"
+#include "..\Real\Complex.h"
+#include "..\EED\EED.h"
+
+// Windows declarations that I don't want
+#undef max
+#undef min
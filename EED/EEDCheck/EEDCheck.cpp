@@ -0,0 +1,108 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+// EEDCheck : checks the results of the parts of the EED that EEDBench times,
+// against made-up memory and the same made-up program. It prints a line for
+// each check, names each case that fails on stderr, and exits with 1 if any
+// case fails.
+//
+//  EEDCheck
+
+#include "Common.h"
+#include "Checks.h"
+#include "..\EEDBench\BenchProgram.h"
+
+using namespace MagoEE;
+using namespace EEDBench;
+using namespace EEDCheck;
+
+
+namespace EEDCheck
+{
+    struct CheckEnv
+    {
+        RefPtr<ITypeEnv>    TypeEnv;
+        RefPtr<NameTable>   StrTable;
+        BenchProgram        Program;
+    };
+
+    static HRESULT InitEnv( CheckEnv& env )
+    {
+        HRESULT     hr = S_OK;
+
+        hr = MakeTypeEnv( BenchProgram::PtrSize, env.TypeEnv.Ref() );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hr = MakeNameTable( env.StrTable.Ref() );
+        if ( FAILED( hr ) )
+            return hr;
+
+        return env.Program.Init( env.TypeEnv );
+    }
+
+    // Runs every check, even after one fails, so that they're all reported.
+    static HRESULT RunChecks()
+    {
+        HRESULT     hr = S_OK;
+        HRESULT     hrCheck = S_OK;
+        CheckEnv    env;
+
+        hr = InitEnv( env );
+        if ( FAILED( hr ) )
+            return hr;
+
+        hrCheck = CheckReadPlan();
+        if ( FAILED( hrCheck ) )
+            hr = hrCheck;
+
+        hrCheck = CheckBytecode( env.TypeEnv, env.StrTable, env.Program );
+        if ( FAILED( hrCheck ) )
+            hr = hrCheck;
+
+        hrCheck = CheckKeyHashes( env.TypeEnv, env.Program );
+        if ( FAILED( hrCheck ) )
+            hr = hrCheck;
+
+        return hr;
+    }
+}
+
+
+int wmain( int argc, wchar_t* argv[] )
+{
+    UNREFERENCED_PARAMETER( argv );
+
+    HRESULT     hr = S_OK;
+
+    if ( argc > 1 )
+    {
+        fprintf( stderr, "Usage:\n  EEDCheck\n" );
+        return 2;
+    }
+
+    hr = MagoEE::Init();
+    if ( SUCCEEDED( hr ) )
+    {
+        hr = RunChecks();
+        MagoEE::Uninit();
+    }
+
+    if ( hr == E_FAIL )
+    {
+        fprintf( stderr, "EEDCheck: some checks failed\n" );
+        return 1;
+    }
+
+    if ( FAILED( hr ) )
+    {
+        fprintf( stderr, "EEDCheck failed: %08x\n", hr );
+        return 1;
+    }
+
+    return 0;
+}
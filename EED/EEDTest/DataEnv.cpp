@@ -176,12 +176,28 @@ bool DataEnv::GetArrayLength( MagoEE::dlength_t& length )
     return false;
 }
 
+HRESULT DataEnv::ReadMemory( MagoEE::Address address, uint32_t sizeToRead, uint32_t& sizeRead, uint8_t* buffer )
+{
+    sizeRead = 0;
+
+    // only what's been allocated can be read
+    if ( address >= mAllocSize )
+        return HRESULT_FROM_WIN32( ERROR_PARTIAL_COPY );
+
+    sizeRead = sizeToRead;
+    if ( (address + sizeToRead) > mAllocSize )
+        sizeRead = (uint32_t) (mAllocSize - address);
+
+    memcpy( buffer, mBuf.Get() + address, sizeRead );
+    return S_OK;
+}
+
 uint64_t DataEnv::ReadInt( MagoEE::Address address, size_t size, bool isSigned )
 {
     return ReadInt( mBuf.Get(), address, size, isSigned );
 }
 
-uint64_t DataEnv::ReadInt( uint8_t* srcBuf, MagoEE::Address address, size_t size, bool isSigned )
+uint64_t DataEnv::ReadInt( const uint8_t* srcBuf, MagoEE::Address address, size_t size, bool isSigned )
 {
     union Integer
     {
@@ -231,7 +247,7 @@ Real10 DataEnv::ReadFloat( MagoEE::Address address, MagoEE::Type* type )
     return ReadFloat( mBuf.Get(), address, type );
 }
 
-Real10 DataEnv::ReadFloat( uint8_t* srcBuf, MagoEE::Address address, MagoEE::Type* type )
+Real10 DataEnv::ReadFloat( const uint8_t* srcBuf, MagoEE::Address address, MagoEE::Type* type )
 {
     union Float
     {
@@ -320,6 +336,14 @@ HRESULT DataEnvBinder::GetReturnType( MagoEE::Type*& type )
     return E_NOTIMPL;
 }
 
+HRESULT DataEnvBinder::GetAddress( MagoEE::Declaration* decl, MagoEE::Address& addr )
+{
+    if ( !decl->GetAddress( addr ) )
+        return E_FAIL;
+
+    return S_OK;
+}
+
 
 HRESULT DataEnvBinder::GetValue( MagoEE::Declaration* decl, MagoEE::DataValue& value )
 {
@@ -384,5 +408,58 @@ HRESULT DataEnvBinder::SetValue( MagoEE::Address addr, MagoEE::Type* type, const
 
 HRESULT DataEnvBinder::ReadMemory( MagoEE::Address addr, uint32_t sizeToRead, uint32_t& sizeRead, uint8_t* buffer )
 {
-    return E_NOTIMPL;
+    return mDataEnv->ReadMemory( addr, sizeToRead, sizeRead, buffer );
+}
+
+HRESULT DataEnvBinder::ReadMemory( MagoEE::MemoryRead* reads, uint32_t count )
+{
+    MagoEE::ReadPlan    plan;
+
+    return plan.Read( this, reads, count );
+}
+
+HRESULT DataEnvBinder::FromRawValue( const uint8_t* buffer, MagoEE::Type* type, MagoEE::DataValue& value )
+{
+    _ASSERT( type != NULL );
+
+    const size_t    size = type->GetSize();
+
+    memset( &value, 0, sizeof value );
+
+    if ( type->IsPointer() || type->IsAArray() )
+    {
+        value.Addr = DataEnv::ReadInt( buffer, 0, size, false );
+    }
+    else if ( type->IsIntegral() )
+    {
+        value.UInt64Value = DataEnv::ReadInt( buffer, 0, size, type->IsSigned() );
+    }
+    else if ( type->IsReal() || type->IsImaginary() )
+    {
+        value.Float80Value = DataEnv::ReadFloat( buffer, 0, type );
+    }
+    else if ( type->IsComplex() )
+    {
+        value.Complex80Value.RealPart = DataEnv::ReadFloat( buffer, 0, type );
+        value.Complex80Value.ImaginaryPart = DataEnv::ReadFloat( buffer, size / 2, type );
+    }
+    else if ( type->IsDArray() )
+    {
+        const size_t LengthSize = type->AsTypeDArray()->GetLengthType()->GetSize();
+        const size_t AddressSize = type->AsTypeDArray()->GetPointerType()->GetSize();
+
+        value.Array.Length = (MagoEE::dlength_t) DataEnv::ReadInt( buffer, 0, LengthSize, false );
+        value.Array.Addr = DataEnv::ReadInt( buffer, LengthSize, AddressSize, false );
+    }
+    else if ( type->IsDelegate() )
+    {
+        const size_t AddressSize = size / 2;
+
+        value.Delegate.ContextAddr = DataEnv::ReadInt( buffer, 0, AddressSize, false );
+        value.Delegate.FuncAddr = DataEnv::ReadInt( buffer, AddressSize, AddressSize, false );
+    }
+    else
+        return E_FAIL;
+
+    return S_OK;
 }
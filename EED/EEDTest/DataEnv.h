@@ -32,9 +32,10 @@ public:
     virtual RefPtr<MagoEE::Declaration> GetThis();
     virtual RefPtr<MagoEE::Declaration> GetSuper();
     virtual bool GetArrayLength( MagoEE::dlength_t& length );
+    virtual HRESULT ReadMemory( MagoEE::Address address, uint32_t sizeToRead, uint32_t& sizeRead, uint8_t* buffer );
 
-    static uint64_t ReadInt( uint8_t* srcBuf, MagoEE::Address addr, size_t size, bool isSigned );
-    static Real10 ReadFloat( uint8_t* srcBuf, MagoEE::Address addr, MagoEE::Type* type );
+    static uint64_t ReadInt( const uint8_t* srcBuf, MagoEE::Address addr, size_t size, bool isSigned );
+    static Real10 ReadFloat( const uint8_t* srcBuf, MagoEE::Address addr, MagoEE::Type* type );
 
 private:
     std::shared_ptr<DataObj> GetValue( MagoEE::Address address, MagoEE::Type* type, MagoEE::Declaration* decl );
@@ -58,6 +59,8 @@ public:
     virtual HRESULT GetSuper( MagoEE::Declaration*& decl );
     virtual HRESULT GetReturnType( MagoEE::Type*& type );
 
+    virtual HRESULT GetAddress( MagoEE::Declaration* decl, MagoEE::Address& addr );
+
     virtual HRESULT GetValue( MagoEE::Declaration* decl, MagoEE::DataValue& value );
     virtual HRESULT GetValue( MagoEE::Address addr, MagoEE::Type* type, MagoEE::DataValue& value );
     virtual HRESULT GetValue( MagoEE::Address aArrayAddr, const MagoEE::DataObject& key, MagoEE::Address& valueAddr );
@@ -67,4 +70,6 @@ public:
     virtual HRESULT SetValue( MagoEE::Address addr, MagoEE::Type* type, const MagoEE::DataValue& value );
 
     virtual HRESULT ReadMemory( MagoEE::Address addr, uint32_t sizeToRead, uint32_t& sizeRead, uint8_t* buffer );
+    virtual HRESULT ReadMemory( MagoEE::MemoryRead* reads, uint32_t count );
+    virtual HRESULT FromRawValue( const uint8_t* buffer, MagoEE::Type* type, MagoEE::DataValue& value );
 };
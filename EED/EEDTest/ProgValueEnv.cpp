@@ -527,6 +527,13 @@ bool ProgramValueEnv::GetArrayLength( MagoEE::dlength_t& length )
     return false;
 }
 
+HRESULT ProgramValueEnv::ReadMemory( MagoEE::Address address, uint32_t sizeToRead, uint32_t& sizeRead, uint8_t* buffer )
+{
+    uint32_t    lenUnreadable = 0;
+
+    return mExec->ReadMemory( mProc, (Address) address, sizeToRead, sizeRead, lenUnreadable, buffer );
+}
+
 HRESULT ProgramValueEnv::LoadSymbols( DWORD64 loadAddr )
 {
     HRESULT hr = S_OK;
@@ -57,6 +57,7 @@ public:
     virtual RefPtr<MagoEE::Declaration> GetThis();
     virtual RefPtr<MagoEE::Declaration> GetSuper();
     virtual bool GetArrayLength( MagoEE::dlength_t& length );
+    virtual HRESULT ReadMemory( MagoEE::Address address, uint32_t sizeToRead, uint32_t& sizeRead, uint8_t* buffer );
 
     static MagoEE::ENUMTY GetBasicTy( DWORD diaBaseTypeId, DWORD size );
 
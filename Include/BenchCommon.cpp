@@ -0,0 +1,283 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+// Compiled by each benchmark program without its precompiled header, so it
+// includes what it needs itself.
+
+#define WIN32_LEAN_AND_MEAN
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <windows.h>
+#include <psapi.h>
+
+#undef max
+#undef min
+
+#include "BenchCommon.h"
+
+
+namespace MagoBench
+{
+    uint64_t GetTicks()
+    {
+        LARGE_INTEGER   count = { 0 };
+
+        QueryPerformanceCounter( &count );
+        return count.QuadPart;
+    }
+
+    double TicksToNanoseconds( uint64_t ticks )
+    {
+        static LARGE_INTEGER    freq = { 0 };
+
+        if ( freq.QuadPart == 0 )
+            QueryPerformanceFrequency( &freq );
+
+        return (double) ticks * 1e9 / (double) freq.QuadPart;
+    }
+
+    uint64_t GetPeakWorkingSet()
+    {
+        PROCESS_MEMORY_COUNTERS counters = { 0 };
+
+        if ( !GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof counters ) )
+            return 0;
+
+        return counters.PeakWorkingSetSize;
+    }
+
+    uint64_t GetWorkingSet()
+    {
+        PROCESS_MEMORY_COUNTERS counters = { 0 };
+
+        if ( !GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof counters ) )
+            return 0;
+
+        return counters.WorkingSetSize;
+    }
+
+    std::string ToUtf8( const wchar_t* str )
+    {
+        int                 len = WideCharToMultiByte( CP_UTF8, 0, str, -1, NULL, 0, NULL, NULL );
+        std::vector<char>   utf8( std::max( len, 1 ) );
+
+        WideCharToMultiByte( CP_UTF8, 0, str, -1, &utf8[0], utf8.size(), NULL, NULL );
+        return std::string( &utf8[0] );
+    }
+
+    std::wstring ToWide( const char* str )
+    {
+        int                     len = MultiByteToWideChar( CP_UTF8, 0, str, -1, NULL, 0 );
+        std::vector<wchar_t>    wide( std::max( len, 1 ) );
+
+        MultiByteToWideChar( CP_UTF8, 0, str, -1, &wide[0], wide.size() );
+        return std::wstring( &wide[0] );
+    }
+
+
+    //------------------------------------------------------------------------
+    //  Samples
+    //------------------------------------------------------------------------
+
+    Samples::Samples()
+        :   mSorted( true )
+    {
+    }
+
+    void Samples::Reserve( size_t count )
+    {
+        mTicks.reserve( count );
+    }
+
+    void Samples::Add( uint64_t ticks )
+    {
+        mTicks.push_back( ticks );
+        mSorted = false;
+    }
+
+    void Samples::Append( const Samples& other )
+    {
+        mTicks.insert( mTicks.end(), other.mTicks.begin(), other.mTicks.end() );
+        mSorted = false;
+    }
+
+    size_t Samples::GetCount() const
+    {
+        return mTicks.size();
+    }
+
+    uint64_t Samples::GetTotal() const
+    {
+        uint64_t    total = 0;
+
+        for ( size_t i = 0; i < mTicks.size(); i++ )
+            total += mTicks[i];
+
+        return total;
+    }
+
+    uint64_t Samples::GetPercentile( double p )
+    {
+        if ( mTicks.size() == 0 )
+            return 0;
+
+        if ( !mSorted )
+        {
+            std::sort( mTicks.begin(), mTicks.end() );
+            mSorted = true;
+        }
+
+        // nearest rank
+        size_t  rank = (size_t) ((p / 100.0) * mTicks.size() + 0.5);
+
+        if ( rank > 0 )
+            rank--;
+        if ( rank >= mTicks.size() )
+            rank = mTicks.size() - 1;
+
+        return mTicks[rank];
+    }
+
+    uint64_t Samples::GetMax()
+    {
+        return GetPercentile( 100.0 );
+    }
+
+
+    //------------------------------------------------------------------------
+    //  JsonLine
+    //------------------------------------------------------------------------
+
+    JsonLine::JsonLine( const char* record )
+    {
+        mText = "{";
+        Add( "record", record );
+    }
+
+    void JsonLine::AddKey( const char* key )
+    {
+        if ( mText.size() > 1 )
+            mText += ",";
+
+        AddString( key );
+        mText += ":";
+    }
+
+    void JsonLine::AddString( const char* value )
+    {
+        mText += "\"";
+
+        for ( const char* p = value; *p != '\0'; p++ )
+        {
+            char    buf[8] = "";
+
+            switch ( *p )
+            {
+            case '"':   mText += "\\\""; break;
+            case '\\':  mText += "\\\\"; break;
+            default:
+                if ( (unsigned char) *p < 0x20 )
+                {
+                    sprintf_s( buf, _countof( buf ), "\\u%04x", (unsigned char) *p );
+                    mText += buf;
+                }
+                else
+                    mText += *p;
+                break;
+            }
+        }
+
+        mText += "\"";
+    }
+
+    void JsonLine::Add( const char* key, const char* value )
+    {
+        AddKey( key );
+        AddString( value );
+    }
+
+    void JsonLine::Add( const char* key, const wchar_t* value )
+    {
+        Add( key, ToUtf8( value ).c_str() );
+    }
+
+    void JsonLine::Add( const char* key, uint64_t value )
+    {
+        char    buf[32] = "";
+
+        sprintf_s( buf, _countof( buf ), "%" PRIu64, value );
+        AddKey( key );
+        mText += buf;
+    }
+
+    void JsonLine::Add( const char* key, uint32_t value )
+    {
+        Add( key, (uint64_t) value );
+    }
+
+    void JsonLine::Add( const char* key, double value )
+    {
+        char    buf[64] = "";
+
+        sprintf_s( buf, _countof( buf ), "%.1f", value );
+        AddKey( key );
+        mText += buf;
+    }
+
+    void JsonLine::Print()
+    {
+        printf( "%s}\n", mText.c_str() );
+        fflush( stdout );
+    }
+
+
+    void AddResultFields(
+        JsonLine& line,
+        const char* fixture,
+        const char* scenario,
+        uint32_t threadCount,
+        Samples& samples,
+        uint64_t wallTicks,
+        uint64_t hits )
+    {
+        double      wallNs = TicksToNanoseconds( wallTicks );
+        double      count = (double) samples.GetCount();
+
+        line.Add( "fixture", fixture );
+        line.Add( "scenario", scenario );
+        line.Add( "threads", threadCount );
+        line.Add( "ops", (uint64_t) samples.GetCount() );
+        line.Add( "hits", hits );
+        line.Add( "mean_ns", (count > 0) ? TicksToNanoseconds( samples.GetTotal() ) / count : 0.0 );
+        line.Add( "p50_ns", TicksToNanoseconds( samples.GetPercentile( 50 ) ) );
+        line.Add( "p90_ns", TicksToNanoseconds( samples.GetPercentile( 90 ) ) );
+        line.Add( "p99_ns", TicksToNanoseconds( samples.GetPercentile( 99 ) ) );
+        line.Add( "max_ns", TicksToNanoseconds( samples.GetMax() ) );
+        line.Add( "ops_per_sec", (wallNs > 0) ? count * 1e9 / wallNs : 0.0 );
+    }
+
+    void PrintResult(
+        const char* fixture,
+        const char* scenario,
+        uint32_t threadCount,
+        Samples& samples,
+        uint64_t wallTicks,
+        uint64_t hits )
+    {
+        JsonLine    line( "result" );
+
+        AddResultFields( line, fixture, scenario, threadCount, samples, wallTicks, hits );
+        line.Add( "peak_rss_bytes", GetPeakWorkingSet() );
+        line.Print();
+    }
+}
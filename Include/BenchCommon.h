@@ -0,0 +1,92 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+// What the benchmark programs have in common: the timer, the samples of a
+// scenario, and the JSON lines that they print. Each program compiles
+// BenchCommon.cpp itself.
+
+
+namespace MagoBench
+{
+    // performance counter ticks
+    uint64_t GetTicks();
+    double TicksToNanoseconds( uint64_t ticks );
+
+    uint64_t GetPeakWorkingSet();
+    uint64_t GetWorkingSet();
+
+    std::string ToUtf8( const wchar_t* str );
+    std::wstring ToWide( const char* str );
+
+    // The latencies of the operations of a scenario. Each operation is timed
+    // on its own, so the percentiles include the cost of reading the counter,
+    // which is reported with each fixture.
+    class Samples
+    {
+        std::vector<uint64_t>   mTicks;
+        bool                    mSorted;
+
+    public:
+        Samples();
+
+        void Reserve( size_t count );
+        void Add( uint64_t ticks );
+        void Append( const Samples& other );
+
+        size_t GetCount() const;
+        uint64_t GetTotal() const;
+        // p is from 0 to 100
+        uint64_t GetPercentile( double p );
+        uint64_t GetMax();
+    };
+
+    // Builds one line of JSON with a flat object.
+    class JsonLine
+    {
+        std::string     mText;
+
+    public:
+        JsonLine( const char* record );
+
+        void Add( const char* key, const char* value );
+        void Add( const char* key, const wchar_t* value );
+        void Add( const char* key, uint64_t value );
+        void Add( const char* key, uint32_t value );
+        void Add( const char* key, double value );
+
+        void Print();
+
+    private:
+        void AddKey( const char* key );
+        void AddString( const char* value );
+    };
+
+    // Adds the fields of a result line for a scenario, up to its throughput.
+    // wallTicks is the time the whole run took, which is what the throughput
+    // is based on; for threaded runs it's less than the sum of the samples.
+    // A program with counters of its own adds them after these, and then
+    // the peak working set.
+    void AddResultFields(
+        JsonLine& line,
+        const char* fixture,
+        const char* scenario,
+        uint32_t threadCount,
+        Samples& samples,
+        uint64_t wallTicks,
+        uint64_t hits );
+
+    // Prints a result line for a scenario, with the peak working set.
+    void PrintResult(
+        const char* fixture,
+        const char* scenario,
+        uint32_t threadCount,
+        Samples& samples,
+        uint64_t wallTicks,
+        uint64_t hits );
+}